@@ -20,6 +20,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2018-01-26     armink       the first version
+ * 2026-10-18                  增加异步擦写接口 spi_flash1_async
+ * 2026-10-18                  增加 sector 布局接口 spi_flash1_geometry ，擦除时按擦除计划选用块擦除和整片擦除
  */
 
 #include <fal.h>
@@ -36,9 +38,34 @@ static int init(void);
 static int read(long offset, uint8_t *buf, size_t size);
 static int write(long offset, const uint8_t *buf, size_t size);
 static int erase(long offset, size_t size);
+static int erase_start(long offset, size_t size);
+static int write_start(long offset, const uint8_t *buf, size_t size);
+static int busy(void);
+static int wait_ready(void);
+static void init_geometry(void);
+static void add_block(uint32_t size, uint8_t cmd);
+static sfud_err erase_cmd(const struct BSP_FLASH_ERASE_STEP *step);
+static size_t make_cmd(uint8_t *cmd, uint8_t opcode, uint32_t addr);
+
+
+struct block_eraser
+{
+    uint32_t size;
+    uint8_t  cmd;
+};
+
+/* 块擦除的尺寸和指令，从大到小。 W25Q 等常见的 SPI NOR 均支持，芯片不支持时删去对应项。
+   若 flash 支持 SFDP 且已经开启 SFUD_USING_SFDP ，则改用 SFDP 中的擦除指令 */
+static const struct block_eraser default_eraser[] = 
+{
+    {64 * 1024, 0xD8},
+    {32 * 1024, 0x52},
+};
 
 
 static sfud_flash *sfud_spi_flash1;
+static struct BSP_FLASH_GEOMETRY flash_geometry;
+static uint8_t block_cmd[BSP_FLASH_MAX_BLOCK];
 /* 若 flash 支持 SFDP 且已经开启 SFUD_USING_SFDP ，则 len 和 blk_size 不填或填错都无问题，
    这两个参数都会被读到的 SFDP 更新 */
 struct fal_flash_dev spi_flash1 = 
@@ -77,6 +104,7 @@ static int init(void)
     /* update the flash chip information */
     spi_flash1.blk_size = sfud_spi_flash1->chip.erase_gran;
     spi_flash1.len = sfud_spi_flash1->chip.capacity;
+    init_geometry();
 
     return 0;
 }
@@ -109,16 +137,265 @@ static int write(long offset, const uint8_t *buf, size_t size)
 
 static int erase(long offset, size_t size)
 {
+    struct BSP_FLASH_ERASE_STEP step;
+    uint32_t addr = spi_flash1.addr + offset;
+    uint32_t end  = addr + size;
+
     assert(sfud_dev);
     assert(sfud_dev->init_ok);
-    BSP_Printf("[FAL SFUD] erase addr: 0x%.8X, size: %d\r\n", spi_flash1.addr + offset, size);
-    if (sfud_erase(sfud_spi_flash1, spi_flash1.addr + offset, size) != SFUD_SUCCESS)
+    BSP_Printf("[FAL SFUD] erase addr: 0x%.8X, size: %d\r\n", addr, size);
+
+    /* 按擦除计划逐步擦除，对齐且足够长的范围使用块擦除，整个 flash 使用整片擦除 */
+    for (; addr < end; addr = step.offset + step.size)
     {
-        return -1;
+        if (BSP_Flash_PlanErase(&flash_geometry, addr, end, &step) != 0
+        ||  erase_cmd(&step) != SFUD_SUCCESS
+        ||  wait_ready() != 0)
+        {
+            return -1;
+        }
     }
 
     return size;
 }
 
+
+/**
+ * @brief  获取 flash 的 sector 布局
+ * @note   由 bsp_flash.c 的 BSP_Flash_GetGeometry 提供给 bootloader ，初始化之前为 NULL
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *spi_flash1_geometry(void)
+{
+    if (flash_geometry.region_num == 0)
+        return NULL;
+
+    return &flash_geometry;
+}
+
+
+/* 异步擦写接口，由 bsp_flash.c 的 BSP_Flash_GetAsync 提供给 bootloader */
+const struct BSP_FLASH_ASYNC spi_flash1_async = 
+{
+    .erase_start = erase_start,
+    .write_start = write_start,
+    .busy        = busy,
+};
+
+
+/**
+ * @brief  启动擦除计划的一步
+ * @note   只发送写使能和擦除指令，不等待擦除完成，由 busy 查询
+ * @param[in]  offset: 偏移地址
+ * @param[in]  size: 剩余的擦除长度，单位 byte
+ * @retval <= 0: 失败。其他: 从 offset 到这一步结束的长度，单位 byte
+ */
+static int erase_start(long offset, size_t size)
+{
+    struct BSP_FLASH_ERASE_STEP step;
+    uint32_t addr = spi_flash1.addr + offset;
+
+    if (BSP_Flash_PlanErase(&flash_geometry, addr, addr + size, &step) != 0
+    ||  erase_cmd(&step) != SFUD_SUCCESS)
+    {
+        return -1;
+    }
+
+    return step.offset + step.size - addr;
+}
+
+
+/**
+ * @brief  启动一页的编程
+ * @note   只发送写使能和页编程指令，不等待编程完成，由 busy 查询。
+ *         不是按页编程的 flash 按阻塞方式写入全部数据
+ * @param[in]  offset: 偏移地址
+ * @param[in]  buf: 数据池
+ * @param[in]  size: 剩余的数据长度，单位 byte
+ * @retval <= 0: 失败。其他: 本次编程的数据长度，单位 byte
+ */
+static int write_start(long offset, const uint8_t *buf, size_t size)
+{
+    static uint8_t cmd_data[5 + SFUD_WRITE_MAX_PAGE_SIZE];
+    size_t   cmd_size, data_size;
+    sfud_err result;
+    uint8_t  wren = SFUD_CMD_WRITE_ENABLE;
+    uint32_t addr = spi_flash1.addr + offset;
+    const sfud_spi *spi = &sfud_spi_flash1->spi;
+
+    if ((sfud_spi_flash1->chip.write_mode & SFUD_WM_PAGE_256B) == 0)
+    {
+        return write(offset, buf, size);
+    }
+
+    /* 不跨越页边界 */
+    data_size = SFUD_WRITE_MAX_PAGE_SIZE - (addr % SFUD_WRITE_MAX_PAGE_SIZE);
+    if (data_size > size)
+        data_size = size;
+
+    cmd_size = make_cmd(cmd_data, SFUD_CMD_PAGE_PROGRAM, addr);
+    memcpy(&cmd_data[cmd_size], buf, data_size);
+
+    if (spi->lock)
+        spi->lock(spi);
+
+    result = spi->wr(spi, &wren, 1, NULL, 0);
+    if (result == SFUD_SUCCESS)
+        result = spi->wr(spi, cmd_data, cmd_size + data_size, NULL, 0);
+
+    if (spi->unlock)
+        spi->unlock(spi);
+
+    if (result != SFUD_SUCCESS)
+    {
+        return -1;
+    }
+
+    return data_size;
+}
+
+
+/**
+ * @brief  上一次启动的擦写是否未完成
+ * @note   读取状态寄存器的 BUSY 位
+ * @retval 1: 未完成 0: 已完成 -1: 读取失败
+ */
+static int busy(void)
+{
+    uint8_t status;
+
+    if (sfud_read_status(sfud_spi_flash1, &status) != SFUD_SUCCESS)
+    {
+        return -1;
+    }
+
+    return (status & SFUD_STATUS_REGISTER_BUSY) ? 1 : 0;
+}
+
+
+/**
+ * @brief  等待上一次启动的擦写完成
+ * @note   按 SFUD 的重试次数和间隔查询
+ * @retval 0: 已完成 -1: 超时或读取失败
+ */
+static int wait_ready(void)
+{
+    int    state;
+    size_t retry_times = sfud_spi_flash1->retry.times;
+
+    while ((state = busy()) == 1 && retry_times--)
+    {
+        if (sfud_spi_flash1->retry.delay)
+            sfud_spi_flash1->retry.delay();
+    }
+
+    return (state == 0) ? 0 : -1;
+}
+
+
+/**
+ * @brief  初始化 flash 的 sector 布局
+ * @note   1. sector 为 SFUD 的擦除粒度，可整片擦除，只在擦除范围为整个 flash 时使用
+ *         2. 块擦除优先取 SFDP 中的擦除指令，否则取 default_eraser
+ * @retval None
+ */
+static void init_geometry(void)
+{
+    memset(&flash_geometry, 0, sizeof(flash_geometry));
+    flash_geometry.addr                  = 0;
+    flash_geometry.region_num            = 1;
+    flash_geometry.region[0].sector_size = sfud_spi_flash1->chip.erase_gran;
+    flash_geometry.region[0].sector_num  = sfud_spi_flash1->chip.capacity / sfud_spi_flash1->chip.erase_gran;
+    flash_geometry.is_chip_erase         = true;
+
+#ifdef SFUD_USING_SFDP
+    if (sfud_spi_flash1->sfdp.available)
+    {
+        /* SFDP 的擦除指令按尺寸从小到大排列 */
+        for (int i = SFUD_SFDP_ERASE_TYPE_MAX_NUM - 1; i >= 0; i--)
+            add_block(sfud_spi_flash1->sfdp.eraser[i].size, sfud_spi_flash1->sfdp.eraser[i].cmd);
+        return;
+    }
+#endif
+
+    for (uint8_t i = 0; i < sizeof(default_eraser) / sizeof(default_eraser[0]); i++)
+        add_block(default_eraser[i].size, default_eraser[i].cmd);
+}
+
+
+/**
+ * @brief  向 sector 布局添加一种块擦除
+ * @note   按添加的顺序排列，不大于 sector 或不是 sector 整数倍的忽略
+ * @param[in]  size: 块擦除的尺寸，单位 byte
+ * @param[in]  cmd: 块擦除的指令
+ * @retval None
+ */
+static void add_block(uint32_t size, uint8_t cmd)
+{
+    uint32_t gran = flash_geometry.region[0].sector_size;
+
+    if (size <= gran || (size % gran) || flash_geometry.block_num >= BSP_FLASH_MAX_BLOCK)
+        return;
+
+    flash_geometry.block_size[flash_geometry.block_num] = size;
+    block_cmd[flash_geometry.block_num++] = cmd;
+}
+
+
+/**
+ * @brief  发送擦除计划中一步的擦除指令
+ * @note   只发送写使能和擦除指令，不等待擦除完成
+ * @param[in]  step: 擦除计划的一步
+ * @retval SFUD 的错误码
+ */
+static sfud_err erase_cmd(const struct BSP_FLASH_ERASE_STEP *step)
+{
+    size_t   cmd_size = 1;
+    uint8_t  cmd[5] = {SFUD_CMD_ERASE_CHIP};
+    sfud_err result;
+    uint8_t  wren = SFUD_CMD_WRITE_ENABLE;
+    const sfud_spi *spi = &sfud_spi_flash1->spi;
+
+    if (step->block >= 0)
+        cmd_size = make_cmd(cmd, block_cmd[step->block], step->offset);
+    else if (step->block == BSP_FLASH_ERASE_SECTOR)
+        cmd_size = make_cmd(cmd, sfud_spi_flash1->chip.erase_gran_cmd, step->offset);
+
+    if (spi->lock)
+        spi->lock(spi);
+
+    result = spi->wr(spi, &wren, 1, NULL, 0);
+    if (result == SFUD_SUCCESS)
+        result = spi->wr(spi, cmd, cmd_size, NULL, 0);
+
+    if (spi->unlock)
+        spi->unlock(spi);
+
+    return result;
+}
+
+
+/**
+ * @brief  组合指令和地址
+ * @note   地址按 flash 当前的 3 或 4 字节地址模式
+ * @param[out]  cmd: 指令缓存，至少 5 byte
+ * @param[in]   opcode: 指令
+ * @param[in]   addr: 地址
+ * @retval 指令和地址的总长度，单位 byte
+ */
+static size_t make_cmd(uint8_t *cmd, uint8_t opcode, uint32_t addr)
+{
+    size_t len = 0;
+
+    cmd[len++] = opcode;
+    if (sfud_spi_flash1->addr_in_4_byte)
+        cmd[len++] = (uint8_t)(addr >> 24);
+    cmd[len++] = (uint8_t)(addr >> 16);
+    cmd[len++] = (uint8_t)(addr >> 8);
+    cmd[len++] = (uint8_t)(addr);
+
+    return len;
+}
+
 #endif /* FAL_USING_SFUD_PORT */
 
@@ -49,6 +49,7 @@
 #endif
 #include "bsp_uart_drv_port.h"
 #include "bsp_timer.h"
+#include "bsp_flash.h"
 #if (IS_ENABLE_SPI_FLASH == 0)
 #include "bsp_flash_drv.h"
 #endif
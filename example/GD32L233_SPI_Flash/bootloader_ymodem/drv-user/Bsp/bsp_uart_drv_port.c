@@ -32,6 +32,7 @@
  * Change Logs:
  * Version  Date           Author       Notes
  * v1.0     2024-01-08     wade任       the first version
+ * v1.1     2026-10-18                  增加波特率的查询和切换
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -40,10 +41,16 @@
 #include "bsp_common.h"
 
 
+/* Private define ------------------------------------------------------------*/
+#define UART_BAUD_MAX_ERROR     20          /* 允许的波特率误差，单位 ‰ */
+
+
 /* Private variables ---------------------------------------------------------*/
 struct UART_STRUCT uart1;
 struct UART_STRUCT *uart = &uart1;
 
+static uint32_t _baudrate = 115200U;        /* 当前的波特率，初始值与 bsp_usart1_usart_config 一致 */
+
 
 /* Exported functions ---------------------------------------------------------*/
 /**
@@ -213,6 +220,79 @@ inline uint32_t BSP_UART_Port_GetDmaCounter(struct UART_STRUCT *uart)
     return dma_transfer_number_get(DMA_CH0);
 }
 
+/**
+ * @brief  获取 UART 当前的波特率
+ * @note   
+ * @param[in]  id: 串口 ID
+ * @retval 波特率
+ */
+uint32_t BSP_UART_GetBaudRate(BSP_UART_ID  id)
+{
+    return _baudrate;
+}
+
+/**
+ * @brief  查询 UART 是否支持指定的波特率
+ * @note   按 CK_USART1 和 usart_baudrate_set 的分频规则计算，分频值超出范围或误差超过 UART_BAUD_MAX_ERROR 时不支持
+ * @param[in]  id: 串口 ID
+ * @param[in]  baudrate: 波特率
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_CheckBaudRate(BSP_UART_ID  id, uint32_t baudrate)
+{
+    uint32_t uclk = rcu_clock_freq_get(CK_USART1);
+    uint32_t udiv, actual, diff;
+
+    if (baudrate == 0)
+        return BSP_UART_ERR_NOT_SUPPORT;
+
+    if (USART_CTL0(COM_USART1) & USART_CTL0_OVSMOD)
+    {
+        /* 8 倍过采样时 USART_BAUD 只保留了 3 位小数 */
+        udiv = (((2U * uclk) + baudrate / 2U) / baudrate) & ~1U;
+        actual = (udiv < 16U) ? 0 : (2U * uclk) / udiv;
+    }
+    else
+    {
+        udiv = (uclk + baudrate / 2U) / baudrate;
+        actual = (udiv < 16U) ? 0 : uclk / udiv;
+    }
+
+    if (actual == 0 || udiv > 0xFFFFU)
+        return BSP_UART_ERR_NOT_SUPPORT;
+
+    diff = (actual > baudrate) ? (actual - baudrate) : (baudrate - actual);
+    if ((uint64_t)diff * 1000U > (uint64_t)baudrate * UART_BAUD_MAX_ERROR)
+        return BSP_UART_ERR_NOT_SUPPORT;
+
+    return BSP_UART_ERR_OK;
+}
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   bsp_usart1_send_string 以阻塞方式发送，调用时已发送完毕，关闭 USART 改写 USART_BAUD 后重新开启
+ * @param[in]  id: 串口 ID
+ * @param[in]  baudrate: 波特率
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_SetBaudRate(BSP_UART_ID  id, uint32_t baudrate)
+{
+    if (uart->is_init == false)
+        return BSP_UART_ERR_NO_INIT;
+
+    if (BSP_UART_CheckBaudRate(id, baudrate) != BSP_UART_ERR_OK)
+        return BSP_UART_ERR_NOT_SUPPORT;
+
+    usart_disable(COM_USART1);
+    usart_baudrate_set(COM_USART1, baudrate);
+    usart_enable(COM_USART1);
+    _baudrate = baudrate;
+
+    BSP_Printf("[ %s ] baudrate: %d\r\n", __func__, baudrate);
+
+    return BSP_UART_ERR_OK;
+}
+
 
 /**
  * @brief  将 DMA 缓存池的 UART 数据搬运到用户数据池中
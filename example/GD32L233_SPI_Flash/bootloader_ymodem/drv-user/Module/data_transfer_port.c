@@ -29,26 +29,27 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.1
+ * Version:         v1.0.2
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-23     Dino         the first version
  * 2022-12-04     Dino         增加断帧检测
+ * 2026-10-18                  UART 的实现以 DT_Port_Ops 提供
  */
 
 /* Includes ------------------------------------------------------------------*/
 #include "data_transfer_port.h"
 
 
-/* Private variables ---------------------------------------------------------*/
-#if (DT_ENABLE_BROKEN_FRAME_DETECT)
-static bool _is_timeout;
-static struct BSP_TIMER _timer_frame_detect;
-
-
-/* Private function prototypes -----------------------------------------------*/
-static void _Timeout_FrameDetect(void *user_data);
-#endif
+/* Exported variables ---------------------------------------------------------*/
+/* UART 接口的操作表，DT_Init 未指定操作表时使用 */
+const struct DT_OPS DT_Port_Ops = 
+{
+    .Init  = DT_Port_Init,
+    .Send  = DT_Port_SendData,
+    .Poll  = DT_Port_IsRecvData,
+    .Clear = DT_Port_ClearRecvBuff,
+};
 
 
 /* Exported functions ---------------------------------------------------------*/
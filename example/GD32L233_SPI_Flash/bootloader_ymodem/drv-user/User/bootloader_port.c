@@ -32,24 +32,53 @@
  * Change Logs:
  * Version  Date           Author       Notes
  * v1.0     2023-12-10     Dino         the first version
+ * v1.1     2026-10-18                  1. 增加 YModem-G 流式接收的处理
+ * v1.2     2026-10-18                  1. 增加滑动窗口协议的接收处理
+ * v1.3     2026-10-18                  1. 增加 YModem 扩展数据帧的接收处理
+ * v1.4     2026-10-18                  1. 固件分包不再复制到 _fw_sub_pkg_data ，直接引用协议接收缓存中的数据
+ *                                      2. 流式接收未处理的数据不在缓存首地址时，交由其他处理前先移至首地址
+ * v1.5     2026-10-18                  1. 已协商断点续传时，在固件包头所在数据帧的应答中填入续传位置
+ * v1.6     2026-10-18                  1. 增加波特率协商，通过 BSP_UART 查询和切换 UART1 的波特率
+ * v1.7     2026-10-18                  1. 启用帧解析器时， YModem 同样由 PP_StreamHandler 逐帧取出
+ * v1.8     2026-10-18                  1. 可同时监听多个数据接口，锁定第一个开始会话的接口
  */
 
 /* Includes ------------------------------------------------------------------*/
 #include "bootloader.h"
 
 
+/* Private define ------------------------------------------------------------*/
+#define DATA_IF_IDLE_TIME               1000        /* 锁定接口后，收到第一个数据包前接口空闲多久解除锁定，单位 ms */
+
+
 /* Private variables ---------------------------------------------------------*/
+/* 同时监听主机数据的接口，可增加其他 UART 、 RS-485 等接口，每个接口使用独立的接收缓存。
+ * 操作表为 NULL 时使用 data_transfer_port.c 的 UART 实现 */
+static const struct
+{
+    uint32_t            if_id;
+    const struct DT_OPS *ops;
+
+} _data_if_cfg[] = 
+{
+    { BSP_UART1, NULL },
+};
+
+#define DATA_IF_NUM                     (sizeof(_data_if_cfg) / sizeof(_data_if_cfg[0]))
+
 static bool     _is_first_pkg;                              /* 是否为第一个收到的数据包 */
 static bool     _is_firmware_head;                          /* 是否为固件包头的标志位 */
-static uint16_t _dev_rx_len;                                /* 指示缓存区接收到的数据量，单位 byte */
-static uint8_t  _dev_rx_buff[PP_MSG_BUFF_SIZE + 16];        /* 设备底层数据接收缓存区 */
-static uint8_t  _fw_sub_pkg_data[PP_FIRMWARE_PKG_SIZE];     /* 暂存固件包体 */
-static uint16_t _fw_sub_pkg_len;                            /* 记录固件包体大小，包含两个字节的数据长度 */
+static uint16_t _dev_rx_len[DATA_IF_NUM];                   /* 指示各接口缓存区接收到的数据量，单位 byte */
+static uint8_t  _dev_rx_buff[DATA_IF_NUM][PP_MSG_BUFF_SIZE + 16];   /* 各接口的设备底层数据接收缓存区 */
+static uint8_t  _poll_index;                                /* 未锁定接口时，轮询到的接口 */
+static volatile bool _is_if_idle;                           /* 锁定的接口已空闲 DATA_IF_IDLE_TIME */
 static uint32_t _stack_addr;                                /* APP 栈顶地址 */
 static uint32_t _reset_handler;                             /* APP reset handler 地址 */
 
 static struct BSP_TIMER         _timer_wait_data;           /* 检测主机数据下发超时的 timer */
-static struct DATA_TRANSFER     _data_if;                   /* 数据传输的接口 */
+static struct BSP_TIMER         _timer_if_idle;             /* 检测锁定的接口是否空闲的 timer */
+static struct DATA_TRANSFER     _data_if[DATA_IF_NUM];      /* 数据传输的接口 */
+static struct DATA_TRANSFER     *_active_if;                /* 锁定的接口， NULL: 未锁定 */
 #if (ENABLE_FACTORY_FIRMWARE_BUTTON)
 static struct BSP_TIMER         _timer_key;                 /* 用于按键扫描的 timer */
 static struct BSP_KEY           _recovery_key;              /* 用于恢复出厂固件的按键 */  
@@ -63,6 +92,9 @@ extern void                 Bootloader_SetCommStatus    (COMM_STATUS status,
                                                          uint16_t data_len);
 extern PP_CMD_EXE_RESULT    Bootloader_GetExeResult     (void);
 extern PP_CMD_ERR_CODE      Bootloader_GetExeErrCode    (void);
+#if (ENABLE_RESUME_TRANSFER)
+extern uint32_t             Bootloader_GetResumeOffset  (void);
+#endif
 
 
 /* Private function prototypes -----------------------------------------------*/
@@ -72,7 +104,15 @@ static void     _PP_SetReplyData                (PP_CMD cmd,
                                                  uint8_t *data, 
                                                  uint16_t *data_len);
 static void     _Timer_HostDataTimeoutCallback  (void *user_data);
+static void     _Timer_IFIdleCallback           (void *user_data);
+static struct DATA_TRANSFER *_DataIF_Select     (void);
+static void     _DataIF_Lock                    (struct DATA_TRANSFER *xfer);
+static void     _DataIF_Release                 (void);
 static void     _UART_SendData                  (uint8_t *data, uint16_t len, uint32_t timeout);
+#if (ENABLE_BAUD_NEGOTIATION)
+static bool     _UART_CheckBaudRate             (uint32_t baudrate);
+static void     _UART_SetBaudRate               (uint32_t baudrate);
+#endif
 #if (ENABLE_FACTORY_FIRMWARE_BUTTON)
 static uint8_t  _Key_GetLevel                   (void);
 static void     _Key_EventCallback              (uint8_t id, KEY_EVENT  event);
@@ -112,8 +152,28 @@ void Bootloader_Port_Init(void)
 #endif
 
     /* 软件初始化 */
-    DT_Init(&_data_if, BSP_UART1, _dev_rx_buff, &_dev_rx_len, PP_MSG_BUFF_SIZE + 16);
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        DT_Init(&_data_if[i], 
+                _data_if_cfg[i].if_id, 
+                _data_if_cfg[i].ops, 
+                _dev_rx_buff[i], 
+                &_dev_rx_len[i], 
+                PP_MSG_BUFF_SIZE + 16);
+    }
+    BSP_Timer_Init( &_timer_if_idle, 
+                    _Timer_IFIdleCallback, 
+                    DATA_IF_IDLE_TIME, 
+                    1, 
+                    TIMER_TYPE_HARDWARE);
+    _active_if = NULL;
     PP_Init(_UART_SendData, NULL, _PP_DataPackageProcess, _PP_SetReplyData);
+#if (ENABLE_BAUD_NEGOTIATION)
+    PP_BaudInit(BSP_UART_GetBaudRate((BSP_UART_ID)_data_if_cfg[0].if_id), _UART_CheckBaudRate, _UART_SetBaudRate);
+#endif
+#if (ENABLE_WINDOW_PROTOCOL)
+    PW_Init(_UART_SendData, _PP_DataPackageProcess, _PP_SetReplyData);
+#endif
     
     _is_first_pkg     = false;
     _is_firmware_head = false;
@@ -127,19 +187,72 @@ void Bootloader_Port_Init(void)
  */
 void Bootloader_Port_HostDataProcess(void)
 {
+    struct DATA_TRANSFER *xfer = _DataIF_Select();
+    uint8_t  *rx_buff = xfer->rx_buff;
+    uint16_t *rx_len  = xfer->rx_len;
+#if (IS_ENABLE_STREAM_HANDLER)
+    /* PP_StreamHandler 按读取位置移除数据，未处理的数据从该偏移开始 */
+    uint16_t  offset  = PP_StreamOffset(rx_buff, rx_len);
+#endif
+
+#if (ENABLE_WINDOW_PROTOCOL)
+    /* 滑动窗口协议的数据帧也是连续下发的，会话期间或收到其帧头时，由 PW_StreamHandler 按帧长从缓存中逐帧取出 */
+#if (IS_ENABLE_STREAM_HANDLER)
+    if (PW_IsActive() || (*rx_len > offset && rx_buff[offset] == PW_SOF))
+#else
+    if (PW_IsActive() || (*rx_len && rx_buff[0] == PW_SOF))
+#endif
+    {
+        static uint16_t pw_last_len;
+
+    #if (IS_ENABLE_STREAM_HANDLER)
+        if (offset)
+            PP_StreamRewind(rx_buff, rx_len);
+    #endif
+
+    #if (WAIT_HOST_DATA_MAX_TIME)
+        if (*rx_len > pw_last_len)
+            BSP_Timer_Restart(&_timer_wait_data);
+    #endif
+        PW_StreamHandler(rx_buff, rx_len);
+        pw_last_len = *rx_len;
+        return;
+    }
+#endif
+
+#if (IS_ENABLE_STREAM_HANDLER)
+    /* YModem-G 的数据帧是连续下发的，无法依靠断帧检测分帧，改由协议析构层按帧长从缓存中逐帧取出，
+     * 启用帧解析器时 YModem 也由此逐帧取出，最后一个校验字节到达即可处理，不再等待断帧检测 */
+    if (PP_IsStreamMode())
+    {
+        static uint16_t last_len;
+
+    #if (WAIT_HOST_DATA_MAX_TIME)
+        if (*rx_len > last_len)
+            BSP_Timer_Restart(&_timer_wait_data);
+    #endif
+        PP_StreamHandler(rx_buff, rx_len);
+        last_len = *rx_len;
+        return;
+    }
+
+    if (offset)
+        PP_StreamRewind(rx_buff, rx_len);
+#endif
+
     /* 轮询方式，防止应用阻塞 */
-    if (DT_PollingReceive(&_data_if) == DT_RESULT_RECV_FRAME_DATA)
+    if (DT_PollingReceive(xfer) == DT_RESULT_RECV_FRAME_DATA)
     {
     #if (WAIT_HOST_DATA_MAX_TIME)
         BSP_Timer_Restart(&_timer_wait_data);
     #endif
 
         /* 调用协议析构层的处理函数并将接收到的一帧数据导入 */
-        if (PP_Handler(_dev_rx_buff, _dev_rx_len) != PP_ERR_OK)
+        if (PP_Handler(rx_buff, *rx_len) != PP_ERR_OK)
         {
-            BSP_Printf("uart recv len: %d\r\n", _dev_rx_len);
+            BSP_Printf("uart recv len: %d\r\n", *rx_len);
         }
-        _dev_rx_len = 0;
+        *rx_len = 0;
     }
     else
         PP_Handler(NULL, 0);
@@ -155,6 +268,7 @@ void Bootloader_Port_Reset(void)
 {
     _is_first_pkg     = false;
     _is_firmware_head = false;
+    _DataIF_Release();
 }
 
 
@@ -244,6 +358,9 @@ static void _PP_DataPackageProcess(PP_CMD cmd, uint8_t *data, uint16_t data_len)
     {
         case PP_CMD_SOH:
         case PP_CMD_STX:
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        case PP_CMD_STX_EXT:
+    #endif
         {
         #if (WAIT_HOST_DATA_MAX_TIME && USING_IS_NEED_UPDATE_PROJECT == USING_HOST_CMD_UPDATE)
             /* 重置 timer 为等待主机下发固件包的定时器 */
@@ -264,21 +381,18 @@ static void _PP_DataPackageProcess(PP_CMD cmd, uint8_t *data, uint16_t data_len)
                 return;
             }
 
-            /* data_len 不能大于 sizeof(_fw_sub_pkg_data) */
-            /* 为了减少判断，这里假定 data_len 不大于 sizeof(_fw_sub_pkg_data) */
-            _fw_sub_pkg_len = data_len;
-            memcpy(&_fw_sub_pkg_data[0], &data[0], _fw_sub_pkg_len);
-            BSP_Printf("_fw_sub_pkg_len: %d\r\n", _fw_sub_pkg_len);
+            /* data 指向协议的接收缓存，协议在本帧处理完毕前不会移除或覆盖该帧，因此无须复制 */
+            BSP_Printf("sub pkg len: %d\r\n", data_len);
 
             /* 第一个数据帧，包含文件名和文件大小等信息 */
             if (_is_first_pkg == false)
             {
                 _is_first_pkg   = true;
-                char *file_name = (char *)&_fw_sub_pkg_data[0];
-                char *file_size = (char *)&_fw_sub_pkg_data[strlen(file_name) + 1];
+                char *file_name = (char *)&data[0];
+                char *file_size = (char *)&data[strlen(file_name) + 1];
                 BSP_Printf("file name: %s\r\n", file_name);
                 BSP_Printf("file size: %d\r\n", atol(file_size));
-                Bootloader_SetCommStatus(COMM_STATUS_FILE_INFO, &_fw_sub_pkg_data[0], _fw_sub_pkg_len);
+                Bootloader_SetCommStatus(COMM_STATUS_FILE_INFO, &data[0], data_len);
                 return;
             }
             
@@ -286,11 +400,11 @@ static void _PP_DataPackageProcess(PP_CMD cmd, uint8_t *data, uint16_t data_len)
             if (_is_firmware_head == false)
             {
                 _is_firmware_head = true;
-                Bootloader_SetCommStatus(COMM_STATUS_FIRMWARE_HEAD, &_fw_sub_pkg_data[0], FPK_HEAD_SIZE);
+                Bootloader_SetCommStatus(COMM_STATUS_FIRMWARE_HEAD, &data[0], FPK_HEAD_SIZE);
             }
             /* 固件包体 */
             else
-                Bootloader_SetCommStatus(COMM_STATUS_FIRMWARE_PKG, &_fw_sub_pkg_data[0], _fw_sub_pkg_len);
+                Bootloader_SetCommStatus(COMM_STATUS_FIRMWARE_PKG, &data[0], data_len);
             break;
         }
         case PP_CMD_EOT:
@@ -321,7 +435,7 @@ static void _PP_DataPackageProcess(PP_CMD cmd, uint8_t *data, uint16_t data_len)
  * @note   根据当前执行的指令和执行情况，发送对应数据
  * @param[in]   cmd: 正在执行的指令
  * @param[out]  cmd_exe_result: 指令执行结果
- * @param[out]  data: 需要响应的数据
+ * @param[out]  data: 需要响应的数据，协议没有需要响应的数据时为 NULL
  * @param[out]  data_len: 需要响应的数据长度，单位 byte
  * @retval None
  */
@@ -335,6 +449,20 @@ static void _PP_SetReplyData(PP_CMD cmd,
     if (*cmd_exe_result == PP_RESULT_CANCEL
     ||  *cmd_exe_result == PP_RESULT_FAILED)
         BSP_Printf("cmd_exe_err_code: %.2X\r\n", Bootloader_GetExeErrCode());
+
+#if (ENABLE_RESUME_TRANSFER)
+    /* 固件包头所在的数据帧，填入续传位置，高字节在前 */
+    if (data && data_len && *cmd_exe_result == PP_RESULT_OK)
+    {
+        uint32_t offset = Bootloader_GetResumeOffset();
+
+        data[0]   = (uint8_t)(offset >> 24);
+        data[1]   = (uint8_t)(offset >> 16);
+        data[2]   = (uint8_t)(offset >> 8);
+        data[3]   = (uint8_t)(offset);
+        *data_len = 4;
+    }
+#endif
 }
 
 
@@ -350,6 +478,113 @@ static void _Timer_HostDataTimeoutCallback(void *user_data)
 }
 
 
+/**
+ * @brief  锁定的接口空闲超时回调函数
+ * @note   在主循环的 _DataIF_Select 中处理
+ * @param[in]  user_data: 用户数据
+ * @retval None
+ */
+static void _Timer_IFIdleCallback(void *user_data)
+{
+    _is_if_idle = true;
+}
+
+
+/**
+ * @brief  选择本次处理的数据接口
+ * @note   1. 未锁定时从上次的位置开始轮询各接口，锁定第一个收到数据的接口，会话期间只处理该接口
+ *         2. 锁定期间其他接口收到的数据直接丢弃
+ *         3. 收到第一个数据包前锁定的接口空闲超过 DATA_IF_IDLE_TIME ，视为干扰或主机放弃，解除锁定
+ * @retval 本次处理的数据接口
+ */
+static struct DATA_TRANSFER *_DataIF_Select(void)
+{
+    static uint16_t last_len;
+    struct DATA_TRANSFER *xfer;
+
+    /* 只有一个接口时无须仲裁 */
+    if (DATA_IF_NUM == 1)
+        return &_data_if[0];
+
+    if (_active_if && _is_if_idle && _is_first_pkg == false)
+        _DataIF_Release();
+
+    if (_active_if)
+    {
+        for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+        {
+            if (&_data_if[i] != _active_if && _dev_rx_len[i])
+                DT_ClearBuff(&_data_if[i]);
+        }
+
+        /* 接收的数据量有变化即视为接口活跃 */
+        if (*_active_if->rx_len != last_len)
+        {
+            last_len    = *_active_if->rx_len;
+            _is_if_idle = false;
+            BSP_Timer_Restart(&_timer_if_idle);
+        }
+        return _active_if;
+    }
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        xfer        = &_data_if[_poll_index];
+        _poll_index = (_poll_index + 1) % DATA_IF_NUM;
+
+        if (*xfer->rx_len)
+        {
+            _DataIF_Lock(xfer);
+            last_len = *xfer->rx_len;
+            return xfer;
+        }
+    }
+
+    return &_data_if[_poll_index];
+}
+
+
+/**
+ * @brief  锁定数据接口
+ * @note   丢弃其他接口已收到的数据
+ * @param[in]  xfer: 要锁定的数据接口
+ * @retval None
+ */
+static void _DataIF_Lock(struct DATA_TRANSFER *xfer)
+{
+    _active_if  = xfer;
+    _is_if_idle = false;
+    BSP_Timer_Restart(&_timer_if_idle);
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        if (&_data_if[i] != xfer)
+            DT_ClearBuff(&_data_if[i]);
+    }
+
+    BSP_Printf("data interface locked: 0x%X\r\n", xfer->if_id);
+}
+
+
+/**
+ * @brief  解除数据接口的锁定
+ * @note   丢弃锁定的接口中未处理的数据，之后重新轮询所有接口
+ * @retval None
+ */
+static void _DataIF_Release(void)
+{
+    if (_active_if == NULL)
+        return;
+
+    BSP_Timer_Pause(&_timer_if_idle);
+    DT_ClearBuff(_active_if);
+    _active_if  = NULL;
+    _is_if_idle = false;
+
+    BSP_Printf("data interface released\r\n");
+}
+
+
 /**
  * @brief  用于发送数据的接口
  * @note   
@@ -360,8 +595,58 @@ static void _Timer_HostDataTimeoutCallback(void *user_data)
  */
 static void _UART_SendData(uint8_t *data, uint16_t len, uint32_t timeout)
 {
-    DT_Send(&_data_if, data, len);
+    /* 未锁定接口时（如等待主机握手），向所有接口发送 */
+    if (_active_if)
+    {
+        DT_Send(_active_if, data, len);
+        return;
+    }
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+        DT_Send(&_data_if[i], data, len);
+}
+
+
+#if (ENABLE_BAUD_NEGOTIATION)
+/**
+ * @brief  查询 UART 是否支持指定的波特率
+ * @note   未锁定接口时，需所有接口都支持
+ * @param[in]  baudrate: 波特率
+ * @retval true: 支持 | false: 不支持
+ */
+static bool _UART_CheckBaudRate(uint32_t baudrate)
+{
+    if (_active_if)
+        return (BSP_UART_CheckBaudRate((BSP_UART_ID)_active_if->if_id, baudrate) == BSP_UART_ERR_OK);
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        if (BSP_UART_CheckBaudRate((BSP_UART_ID)_data_if[i].if_id, baudrate) != BSP_UART_ERR_OK)
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   未锁定接口时（如会话结束后恢复原波特率），切换所有接口
+ * @param[in]  baudrate: 波特率
+ * @retval None
+ */
+static void _UART_SetBaudRate(uint32_t baudrate)
+{
+    if (_active_if)
+    {
+        BSP_UART_SetBaudRate((BSP_UART_ID)_active_if->if_id, baudrate);
+        return;
+    }
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+        BSP_UART_SetBaudRate((BSP_UART_ID)_data_if[i].if_id, baudrate);
 }
+#endif
 
 
 #if (ENABLE_FACTORY_FIRMWARE_BUTTON)
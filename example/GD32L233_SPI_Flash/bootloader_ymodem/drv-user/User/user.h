@@ -49,6 +49,7 @@
 #define ENABLE_ASSERT                       0                   /* 是否使能函数入口参数检查 */
 #define ENABLE_DEBUG_PRINT                  0                   /* 是否使能调试信息打印 */
 #define EANBLE_PRINTF_USING_RTT             0                   /* BSP_Print 函数是否使用 SEGGER RTT 作为输出端口 */
+#define ENABLE_PERF_STATS                   0                   /* 是否使能各执行流程和固件操作的耗时统计，依赖 perf_counter */
 
 #define USING_RTOS_TYPE                     RTOS_USING_NONE
 #define SEGGER_RTT_PRINTF_TERMINAL          0                   /* SEGGER RTT 的打印端口 */
@@ -0,0 +1,718 @@
+/**
+ * \file            bootloader_port.c
+ * \brief           communication and protocol part of the bootloader
+ */
+
+/*
+ * Copyright (c) 2023 Dino Haw
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Author:          Dino Haw <347341799@qq.com>
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2023-12-10     Dino         the first version
+ * v1.1     2026-10-18                  1. Linux 主机仿真工程的移植
+ * v1.2     2026-10-18                  1. 执行流程切换时输出 trace
+ * v1.3     2026-10-18                  1. 跳转至 APP 前将耗时统计输出至 trace
+ * v1.4     2026-10-18                  1. 增加 YModem-G 流式接收的处理
+ * v1.5     2026-10-18                  1. 增加滑动窗口协议的接收处理
+ * v1.6     2026-10-18                  1. 增加 YModem 扩展数据帧的接收处理
+ * v1.7     2026-10-18                  1. 固件分包不再复制到 _fw_sub_pkg_data ，直接引用协议接收缓存中的数据
+ *                                      2. 流式接收未处理的数据不在缓存首地址时，交由其他处理前先移至首地址
+ * v1.8     2026-10-18                  1. 已协商断点续传时，在固件包头所在数据帧的应答中填入续传位置
+ * v1.9     2026-10-18                  1. 增加波特率协商，通过 BSP_UART 查询和切换 UART1 的波特率
+ * v1.10    2026-10-18                  1. 启用帧解析器时， YModem 同样由 PP_StreamHandler 逐帧取出
+ * v1.11    2026-10-18                  1. 可同时监听多个数据接口，锁定第一个开始会话的接口
+ *                                      2. 增加仿真的 UART2 作为第二个数据接口
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bootloader.h"
+
+
+/* Private define ------------------------------------------------------------*/
+#define DATA_IF_IDLE_TIME               1000        /* 锁定接口后，收到第一个数据包前接口空闲多久解除锁定，单位 ms */
+
+
+/* Private variables ---------------------------------------------------------*/
+/* 同时监听主机数据的接口，可增加其他 UART 、 RS-485 等接口，每个接口使用独立的接收缓存。
+ * 操作表为 NULL 时使用 data_transfer_port.c 的 UART 实现 */
+static const struct
+{
+    uint32_t            if_id;
+    const struct DT_OPS *ops;
+
+} _data_if_cfg[] = 
+{
+    { BSP_UART1, NULL },
+#if (BSP_USING_UART2)
+    { BSP_UART2, NULL },
+#endif
+};
+
+#define DATA_IF_NUM                     (sizeof(_data_if_cfg) / sizeof(_data_if_cfg[0]))
+
+/* 执行流程的名称，用于 trace */
+static const char *const _exe_flow_name[] = 
+{
+    [EXE_FLOW_NOTHING]                  = "NOTHING",
+    [EXE_FLOW_ACCIDENT_UPDATE]          = "ACCIDENT_UPDATE",
+    [EXE_FLOW_NEED_HOST_SEND_FIRMWARE]  = "NEED_HOST_SEND_FIRMWARE",
+    [EXE_FLOW_FIND_RUNNING_FIRMWARE]    = "FIND_RUNNING_FIRMWARE",
+    [EXE_FLOW_WAIT_FIRMWARE]            = "WAIT_FIRMWARE",
+    [EXE_FLOW_VERIFY_FIRMWARE_HEAD]     = "VERIFY_FIRMWARE_HEAD",
+    [EXE_FLOW_ERASE_OLD_FIRMWARE]       = "ERASE_OLD_FIRMWARE",
+    [EXE_FLOW_ERASE_OLD_FIRMWARE_DONE]  = "ERASE_OLD_FIRMWARE_DONE",
+    [EXE_FLOW_WRITE_FIRMWARE_HEAD]      = "WRITE_FIRMWARE_HEAD",
+    [EXE_FLOW_WRITE_FIRMWARE_HEAD_DONE] = "WRITE_FIRMWARE_HEAD_DONE",
+    [EXE_FLOW_VERIFY_FIRMWARE_PKG]      = "VERIFY_FIRMWARE_PKG",
+    [EXE_FLOW_WRITE_NEW_FIRMWARE]       = "WRITE_NEW_FIRMWARE",
+    [EXE_FLOW_WRITE_NEW_FIRMWARE_DONE]  = "WRITE_NEW_FIRMWARE_DONE",
+    [EXE_FLOW_UPDATE_FIRMWARE]          = "UPDATE_FIRMWARE",
+    [EXE_FLOW_VERIFY_FIRMWARE]          = "VERIFY_FIRMWARE",
+    [EXE_FLOW_VERIFY_FIRMWARE_DONE]     = "VERIFY_FIRMWARE_DONE",
+    [EXE_FLOW_ERASE_APP]                = "ERASE_APP",
+    [EXE_FLOW_UPDATE_TO_APP]            = "UPDATE_TO_APP",
+    [EXE_FLOW_VERIFY_APP]               = "VERIFY_APP",
+    [EXE_FLOW_UPDATE_TO_APP_DONE]       = "UPDATE_TO_APP_DONE",
+    [EXE_FLOW_ERASE_DOWNLOAD]           = "ERASE_DOWNLOAD",
+    [EXE_FLOW_ERASE_DOWNLOAD_DONE]      = "ERASE_DOWNLOAD_DONE",
+    [EXE_FLOW_JUMP_TO_APP]              = "JUMP_TO_APP",
+    [EXE_FLOW_RECOVERY]                 = "RECOVERY",
+    [EXE_FLOW_FAILED]                   = "FAILED",
+};
+
+static bool     _is_first_pkg;                              /* 是否为第一个收到的数据包 */
+static bool     _is_firmware_head;                          /* 是否为固件包头的标志位 */
+static uint16_t _dev_rx_len[DATA_IF_NUM];                   /* 指示各接口缓存区接收到的数据量，单位 byte */
+static uint8_t  _dev_rx_buff[DATA_IF_NUM][PP_MSG_BUFF_SIZE + 16];   /* 各接口的设备底层数据接收缓存区 */
+static uint8_t  _poll_index;                                /* 未锁定接口时，轮询到的接口 */
+static volatile bool _is_if_idle;                           /* 锁定的接口已空闲 DATA_IF_IDLE_TIME */
+static uint32_t _stack_addr;                                /* APP 栈顶地址 */
+static uint32_t _reset_handler;                             /* APP reset handler 地址 */
+
+static struct BSP_TIMER         _timer_wait_data;           /* 检测主机数据下发超时的 timer */
+static struct BSP_TIMER         _timer_if_idle;             /* 检测锁定的接口是否空闲的 timer */
+static struct DATA_TRANSFER     _data_if[DATA_IF_NUM];      /* 数据传输的接口 */
+static struct DATA_TRANSFER     *_active_if;                /* 锁定的接口， NULL: 未锁定 */
+#if (ENABLE_FACTORY_FIRMWARE_BUTTON)
+static struct BSP_TIMER         _timer_key;                 /* 用于按键扫描的 timer */
+static struct BSP_KEY           _recovery_key;              /* 用于恢复出厂固件的按键 */  
+#endif
+
+
+/* Extern function prototypes ------------------------------------------------*/
+extern bool                 Bootloader_IntoRecovryMode  (void);
+extern void                 Bootloader_SetCommStatus    (COMM_STATUS status, 
+                                                         uint8_t *data, 
+                                                         uint16_t data_len);
+extern PP_CMD_EXE_RESULT    Bootloader_GetExeResult     (void);
+extern PP_CMD_ERR_CODE      Bootloader_GetExeErrCode    (void);
+#if (ENABLE_RESUME_TRANSFER)
+extern uint32_t             Bootloader_GetResumeOffset  (void);
+#endif
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void     _PP_DataPackageProcess          (PP_CMD cmd, uint8_t *data, uint16_t data_len);
+static void     _PP_SetReplyData                (PP_CMD cmd, 
+                                                 PP_CMD_EXE_RESULT *cmd_exe_result, 
+                                                 uint8_t *data, 
+                                                 uint16_t *data_len);
+static void     _Timer_HostDataTimeoutCallback  (void *user_data);
+static void     _Timer_IFIdleCallback           (void *user_data);
+static struct DATA_TRANSFER *_DataIF_Select     (void);
+static void     _DataIF_Lock                    (struct DATA_TRANSFER *xfer);
+static void     _DataIF_Release                 (void);
+static void     _UART_SendData                  (uint8_t *data, uint16_t len, uint32_t timeout);
+#if (ENABLE_BAUD_NEGOTIATION)
+static bool     _UART_CheckBaudRate             (uint32_t baudrate);
+static void     _UART_SetBaudRate               (uint32_t baudrate);
+#endif
+#if (ENABLE_FACTORY_FIRMWARE_BUTTON)
+static uint8_t  _Key_GetLevel                   (void);
+static void     _Key_EventCallback              (uint8_t id, KEY_EVENT  event);
+static void     _Timer_ScanKeyCallback          (void *user_data);
+#endif
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  通讯与协议相关初始化
+ * @note   
+ * @retval None
+ */
+void Bootloader_Port_Init(void)
+{
+#if (WAIT_HOST_DATA_MAX_TIME)
+    /* 初始状态为等待主机是否下发数据的定时器 */
+    BSP_Timer_Init( &_timer_wait_data,
+                    _Timer_HostDataTimeoutCallback,
+                    WAIT_HOST_DATA_MAX_TIME,
+                    TIMER_RUN_FOREVER,
+                    TIMER_TYPE_HARDWARE);
+    BSP_Timer_Start(&_timer_wait_data);
+#endif
+
+#if (ENABLE_FACTORY_FIRMWARE_BUTTON)
+    BSP_Key_Init(&_recovery_key, 0, _Key_GetLevel, FACTORY_FIRMWARE_BUTTON_PRESS);
+    BSP_Key_Register(&_recovery_key, KEY_LONG_PRESS, _Key_EventCallback);
+    BSP_Key_Start(&_recovery_key);
+    
+    BSP_Timer_Init( &_timer_key, 
+                    _Timer_ScanKeyCallback, 
+                    2,
+                    TIMER_RUN_FOREVER, 
+                    TIMER_TYPE_HARDWARE);
+    BSP_Timer_Start(&_timer_key);
+#endif
+
+    /* 软件初始化 */
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        DT_Init(&_data_if[i], 
+                _data_if_cfg[i].if_id, 
+                _data_if_cfg[i].ops, 
+                _dev_rx_buff[i], 
+                &_dev_rx_len[i], 
+                PP_MSG_BUFF_SIZE + 16);
+    }
+    BSP_Timer_Init( &_timer_if_idle, 
+                    _Timer_IFIdleCallback, 
+                    DATA_IF_IDLE_TIME, 
+                    1, 
+                    TIMER_TYPE_HARDWARE);
+    _active_if = NULL;
+    PP_Init(_UART_SendData, NULL, _PP_DataPackageProcess, _PP_SetReplyData);
+#if (ENABLE_BAUD_NEGOTIATION)
+    PP_BaudInit(BSP_UART_GetBaudRate((BSP_UART_ID)_data_if_cfg[0].if_id), _UART_CheckBaudRate, _UART_SetBaudRate);
+#endif
+#if (ENABLE_WINDOW_PROTOCOL)
+    PW_Init(_UART_SendData, _PP_DataPackageProcess, _PP_SetReplyData);
+#endif
+    
+    BSP_Printf("FLASH_SECTOR_TOTAL: %d\r\n", FLASH_SECTOR_TOTAL);
+    
+    _is_first_pkg     = false;
+    _is_firmware_head = false;
+}
+
+
+/**
+ * @brief  主机数据接收处理函数
+ * @note   
+ * @retval None
+ */
+void Bootloader_Port_HostDataProcess(void)
+{
+    struct DATA_TRANSFER *xfer = _DataIF_Select();
+    uint8_t  *rx_buff = xfer->rx_buff;
+    uint16_t *rx_len  = xfer->rx_len;
+#if (IS_ENABLE_STREAM_HANDLER)
+    /* PP_StreamHandler 按读取位置移除数据，未处理的数据从该偏移开始 */
+    uint16_t  offset  = PP_StreamOffset(rx_buff, rx_len);
+#endif
+
+#if (ENABLE_WINDOW_PROTOCOL)
+    /* 滑动窗口协议的数据帧也是连续下发的，会话期间或收到其帧头时，由 PW_StreamHandler 按帧长从缓存中逐帧取出 */
+#if (IS_ENABLE_STREAM_HANDLER)
+    if (PW_IsActive() || (*rx_len > offset && rx_buff[offset] == PW_SOF))
+#else
+    if (PW_IsActive() || (*rx_len && rx_buff[0] == PW_SOF))
+#endif
+    {
+        static uint16_t pw_last_len;
+
+    #if (IS_ENABLE_STREAM_HANDLER)
+        if (offset)
+            PP_StreamRewind(rx_buff, rx_len);
+    #endif
+
+    #if (WAIT_HOST_DATA_MAX_TIME)
+        if (*rx_len > pw_last_len)
+            BSP_Timer_Restart(&_timer_wait_data);
+    #endif
+        PW_StreamHandler(rx_buff, rx_len);
+        pw_last_len = *rx_len;
+        return;
+    }
+#endif
+
+#if (IS_ENABLE_STREAM_HANDLER)
+    /* YModem-G 的数据帧是连续下发的，无法依靠断帧检测分帧，改由协议析构层按帧长从缓存中逐帧取出，
+     * 启用帧解析器时 YModem 也由此逐帧取出，最后一个校验字节到达即可处理，不再等待断帧检测 */
+    if (PP_IsStreamMode())
+    {
+        static uint16_t last_len;
+
+    #if (WAIT_HOST_DATA_MAX_TIME)
+        if (*rx_len > last_len)
+            BSP_Timer_Restart(&_timer_wait_data);
+    #endif
+        PP_StreamHandler(rx_buff, rx_len);
+        last_len = *rx_len;
+        return;
+    }
+
+    if (offset)
+        PP_StreamRewind(rx_buff, rx_len);
+#endif
+
+    /* 轮询方式，防止应用阻塞 */
+    if (DT_PollingReceive(xfer) == DT_RESULT_RECV_FRAME_DATA)
+    {
+    #if (WAIT_HOST_DATA_MAX_TIME)
+        BSP_Timer_Restart(&_timer_wait_data);
+    #endif
+
+        /* 调用协议析构层的处理函数并将接收到的一帧数据导入 */
+        if (PP_Handler(rx_buff, *rx_len) != PP_ERR_OK)
+        {
+            BSP_Printf("uart recv len: %d\r\n", *rx_len);
+        }
+        *rx_len = 0;
+    }
+    else
+        PP_Handler(NULL, 0);
+}
+
+
+/**
+ * @brief  复位函数
+ * @note   
+ * @retval None
+ */
+void Bootloader_Port_Reset(void)
+{
+    _is_first_pkg     = false;
+    _is_firmware_head = false;
+    _DataIF_Release();
+}
+
+
+/**
+ * @brief  跳转至APP的处理函数
+ * @note   主机仿真无法真正运行 APP ，打印 APP 的栈顶和复位地址后停止仿真外设并退出，退出码为 0
+ * @retval None
+ */
+__NO_RETURN
+void Bootloader_Port_JumpToAPP(void)
+{
+    _stack_addr    = *(volatile uint32_t *)APP_ADDRESS;
+    _reset_handler = *(volatile uint32_t *)(APP_ADDRESS + 4);
+
+    BSP_Printf("jump to APP, MSP: 0x%.8X, reset handler: 0x%.8X\r\n", _stack_addr, _reset_handler);
+
+#if (ENABLE_PERF_STATS)
+    /* 主机仿真的 tick 即 ns */
+    for (uint8_t i = 0; i < PERF_FUNC_NUM; i++)
+    {
+        const struct PERF_ITEM *item = &perf_stats.func[i];
+
+        HOST_Trace("perf %s count=%u total_us=%llu max_us=%u", perf_func_name[i], item->count,
+                   (unsigned long long)(item->total / 1000), item->max / 1000);
+    }
+#endif
+
+    HOST_Exit(0);
+}
+
+
+/**
+ * @brief  系统复位重启
+ * @note   
+ * @retval None
+ */
+void Bootloader_Port_SystemReset(void)
+{
+    HAL_NVIC_SystemReset();
+}
+
+
+/**
+ * @brief  执行流程切换时的回调
+ * @note   输出至 trace ，供基准测试统计各流程的耗时
+ * @param[in]  old_flow: 切换前的流程
+ * @param[in]  new_flow: 切换后的流程
+ * @retval None
+ */
+void Bootloader_ExeFlowCallback(BOOT_EXE_FLOW old_flow, BOOT_EXE_FLOW new_flow)
+{
+    (void)old_flow;
+    HOST_Trace("flow %s", _exe_flow_name[new_flow]);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  负责接收协议解析出来的数据
+ * @note   通过协议的指令包，设置程序的执行流程
+ * @param[in]  cmd: 接收到的指令
+ * @param[in]  data: 接收到的参数
+ * @param[in]  data_len: 接收到的参数长度，单位 byte
+ * @retval None
+ */
+static void _PP_DataPackageProcess(PP_CMD cmd, uint8_t *data, uint16_t data_len)
+{
+    static bool is_eot = false;
+
+    Bootloader_SetCommStatus(COMM_STATUS_RECV_DATA, NULL, 0);
+
+    switch (cmd)
+    {
+        case PP_CMD_SOH:
+        case PP_CMD_STX:
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        case PP_CMD_STX_EXT:
+    #endif
+        {
+        #if (WAIT_HOST_DATA_MAX_TIME && USING_IS_NEED_UPDATE_PROJECT == USING_HOST_CMD_UPDATE)
+            /* 重置 timer 为等待主机下发固件包的定时器 */
+            BSP_Timer_Pause(&_timer_wait_data);
+            BSP_Timer_Init( &_timer_wait_data, 
+                            _Timer_HostDataTimeoutCallback, 
+                            (60 * 1000), 
+                            TIMER_RUN_FOREVER, 
+                            TIMER_TYPE_HARDWARE);
+            BSP_Timer_Start(&_timer_wait_data);
+        #endif
+            
+            /* 最后一个 SOH 空数据帧 */
+            if (is_eot && cmd == PP_CMD_SOH)
+            {
+                is_eot = false;
+                Bootloader_SetCommStatus(COMM_STATUS_FILE_DONE, NULL, 0);
+                return;
+            }
+
+            /* data 指向协议的接收缓存，协议在本帧处理完毕前不会移除或覆盖该帧，因此无须复制 */
+            BSP_Printf("sub pkg len: %d\r\n", data_len);
+
+            /* 第一个数据帧，包含文件名和文件大小等信息 */
+            if (_is_first_pkg == false)
+            {
+                _is_first_pkg   = true;
+                char *file_name = (char *)&data[0];
+                char *file_size = (char *)&data[strlen(file_name) + 1];
+                BSP_Printf("file name: %s\r\n", file_name);
+                BSP_Printf("file size: %d\r\n", atol(file_size));
+                Bootloader_SetCommStatus(COMM_STATUS_FILE_INFO, &data[0], data_len);
+                return;
+            }
+            
+            /* 固件包头，单独处理 */
+            if (_is_firmware_head == false)
+            {
+                _is_firmware_head = true;
+                Bootloader_SetCommStatus(COMM_STATUS_FIRMWARE_HEAD, &data[0], FPK_HEAD_SIZE);
+            }
+            /* 固件包体 */
+            else
+                Bootloader_SetCommStatus(COMM_STATUS_FIRMWARE_PKG, &data[0], data_len);
+            break;
+        }
+        case PP_CMD_EOT:
+        {
+            is_eot = true;
+            Bootloader_SetCommStatus(COMM_STATUS_START_UPDATE, NULL, 0);
+            break;
+        }
+        case PP_CMD_CAN:
+        {
+            is_eot            = false;
+            _is_first_pkg     = false;
+            _is_firmware_head = false;
+            Bootloader_SetCommStatus(COMM_STATUS_CANCEL, NULL, 0);
+            break;
+        }
+        default:
+        {
+            Bootloader_SetCommStatus(COMM_STATUS_UNKNOWN, NULL, 0);
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief  回复指令的执行情况，协议会自动组包
+ * @note   根据当前执行的指令和执行情况，发送对应数据
+ * @param[in]   cmd: 正在执行的指令
+ * @param[out]  cmd_exe_result: 指令执行结果
+ * @param[out]  data: 需要响应的数据，协议没有需要响应的数据时为 NULL
+ * @param[out]  data_len: 需要响应的数据长度，单位 byte
+ * @retval None
+ */
+static void _PP_SetReplyData(PP_CMD cmd, 
+                             PP_CMD_EXE_RESULT *cmd_exe_result, 
+                             uint8_t *data, 
+                             uint16_t *data_len)
+{
+    *cmd_exe_result = Bootloader_GetExeResult();
+    
+    if (*cmd_exe_result == PP_RESULT_CANCEL
+    ||  *cmd_exe_result == PP_RESULT_FAILED)
+        BSP_Printf("cmd_exe_err_code: %.2X\r\n", Bootloader_GetExeErrCode());
+
+#if (ENABLE_RESUME_TRANSFER)
+    /* 固件包头所在的数据帧，填入续传位置，高字节在前 */
+    if (data && data_len && *cmd_exe_result == PP_RESULT_OK)
+    {
+        uint32_t offset = Bootloader_GetResumeOffset();
+
+        data[0]   = (uint8_t)(offset >> 24);
+        data[1]   = (uint8_t)(offset >> 16);
+        data[2]   = (uint8_t)(offset >> 8);
+        data[3]   = (uint8_t)(offset);
+        *data_len = 4;
+    }
+#endif
+}
+
+
+/**
+ * @brief  等待主机数据超时回调函数
+ * @note   
+ * @param[in]  user_data: 用户数据
+ * @retval None
+ */
+static void _Timer_HostDataTimeoutCallback(void *user_data)
+{
+    Bootloader_SetCommStatus(COMM_STATUS_RECV_TIMEOUT, NULL, 0);
+}
+
+
+/**
+ * @brief  锁定的接口空闲超时回调函数
+ * @note   在主循环的 _DataIF_Select 中处理
+ * @param[in]  user_data: 用户数据
+ * @retval None
+ */
+static void _Timer_IFIdleCallback(void *user_data)
+{
+    _is_if_idle = true;
+}
+
+
+/**
+ * @brief  选择本次处理的数据接口
+ * @note   1. 未锁定时从上次的位置开始轮询各接口，锁定第一个收到数据的接口，会话期间只处理该接口
+ *         2. 锁定期间其他接口收到的数据直接丢弃
+ *         3. 收到第一个数据包前锁定的接口空闲超过 DATA_IF_IDLE_TIME ，视为干扰或主机放弃，解除锁定
+ * @retval 本次处理的数据接口
+ */
+static struct DATA_TRANSFER *_DataIF_Select(void)
+{
+    static uint16_t last_len;
+    struct DATA_TRANSFER *xfer;
+
+    /* 只有一个接口时无须仲裁 */
+    if (DATA_IF_NUM == 1)
+        return &_data_if[0];
+
+    if (_active_if && _is_if_idle && _is_first_pkg == false)
+        _DataIF_Release();
+
+    if (_active_if)
+    {
+        for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+        {
+            if (&_data_if[i] != _active_if && _dev_rx_len[i])
+                DT_ClearBuff(&_data_if[i]);
+        }
+
+        /* 接收的数据量有变化即视为接口活跃 */
+        if (*_active_if->rx_len != last_len)
+        {
+            last_len    = *_active_if->rx_len;
+            _is_if_idle = false;
+            BSP_Timer_Restart(&_timer_if_idle);
+        }
+        return _active_if;
+    }
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        xfer        = &_data_if[_poll_index];
+        _poll_index = (_poll_index + 1) % DATA_IF_NUM;
+
+        if (*xfer->rx_len)
+        {
+            _DataIF_Lock(xfer);
+            last_len = *xfer->rx_len;
+            return xfer;
+        }
+    }
+
+    return &_data_if[_poll_index];
+}
+
+
+/**
+ * @brief  锁定数据接口
+ * @note   丢弃其他接口已收到的数据
+ * @param[in]  xfer: 要锁定的数据接口
+ * @retval None
+ */
+static void _DataIF_Lock(struct DATA_TRANSFER *xfer)
+{
+    _active_if  = xfer;
+    _is_if_idle = false;
+    BSP_Timer_Restart(&_timer_if_idle);
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        if (&_data_if[i] != xfer)
+            DT_ClearBuff(&_data_if[i]);
+    }
+
+    BSP_Printf("data interface locked: 0x%X\r\n", xfer->if_id);
+}
+
+
+/**
+ * @brief  解除数据接口的锁定
+ * @note   丢弃锁定的接口中未处理的数据，之后重新轮询所有接口
+ * @retval None
+ */
+static void _DataIF_Release(void)
+{
+    if (_active_if == NULL)
+        return;
+
+    BSP_Timer_Pause(&_timer_if_idle);
+    DT_ClearBuff(_active_if);
+    _active_if  = NULL;
+    _is_if_idle = false;
+
+    BSP_Printf("data interface released\r\n");
+}
+
+
+/**
+ * @brief  用于发送数据的接口
+ * @note   
+ * @param[in]  data: 要发送的数据
+ * @param[in]  len: 要发送的数据长度
+ * @param[in]  timeout: 超时时间，单位 ms
+ * @retval None
+ */
+static void _UART_SendData(uint8_t *data, uint16_t len, uint32_t timeout)
+{
+    /* 未锁定接口时（如等待主机握手），向所有接口发送 */
+    if (_active_if)
+    {
+        DT_Send(_active_if, data, len);
+        return;
+    }
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+        DT_Send(&_data_if[i], data, len);
+}
+
+
+#if (ENABLE_BAUD_NEGOTIATION)
+/**
+ * @brief  查询 UART 是否支持指定的波特率
+ * @note   未锁定接口时，需所有接口都支持
+ * @param[in]  baudrate: 波特率
+ * @retval true: 支持 | false: 不支持
+ */
+static bool _UART_CheckBaudRate(uint32_t baudrate)
+{
+    if (_active_if)
+        return (BSP_UART_CheckBaudRate((BSP_UART_ID)_active_if->if_id, baudrate) == BSP_UART_ERR_OK);
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+    {
+        if (BSP_UART_CheckBaudRate((BSP_UART_ID)_data_if[i].if_id, baudrate) != BSP_UART_ERR_OK)
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   未锁定接口时（如会话结束后恢复原波特率），切换所有接口
+ * @param[in]  baudrate: 波特率
+ * @retval None
+ */
+static void _UART_SetBaudRate(uint32_t baudrate)
+{
+    if (_active_if)
+    {
+        BSP_UART_SetBaudRate((BSP_UART_ID)_active_if->if_id, baudrate);
+        return;
+    }
+
+    for (uint8_t i = 0; i < DATA_IF_NUM; i++)
+        BSP_UART_SetBaudRate((BSP_UART_ID)_data_if[i].if_id, baudrate);
+}
+#endif
+
+
+#if (ENABLE_FACTORY_FIRMWARE_BUTTON)
+/**
+ * @brief  按键的事件处理
+ * @note   
+ * @param[in]  id: 按键的 ID
+ * @param[in]  event: 按键的事件
+ * @retval None
+ */
+static void _Key_EventCallback(uint8_t id, KEY_EVENT  event)
+{
+    BSP_Printf("[ key ] You just press the button[%d], event: %d\r\n\r\n", id, event);
+    
+    if (event == KEY_LONG_PRESS)
+    {
+        Bootloader_IntoRecovryMode();
+    }
+}
+
+
+/**
+ * @brief  读取按键的电平值
+ * @note   
+ * @retval 电平值
+ */
+static uint8_t _Key_GetLevel(void)
+{
+    return HAL_GPIO_ReadPin(USER_BTN_GPIO_Port, USER_BTN_Pin);
+}
+
+
+/**
+ * @brief  扫描按键的任务
+ * @note   
+ * @param[in]  user_data: 用户数据
+ * @retval None
+ */
+static void _Timer_ScanKeyCallback(void *user_data)
+{
+    BSP_Key_Handler(2);
+}
+#endif  /* #if (ENABLE_FACTORY_FIRMWARE_BUTTON) */
+
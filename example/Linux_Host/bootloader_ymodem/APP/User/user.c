@@ -0,0 +1,82 @@
+/**
+ * \file            user.c
+ * \brief           user application
+ */
+
+/*
+ * Copyright (c) 2023 Dino Haw
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Author:          Dino Haw <347341799@qq.com>
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2023-12-10     Dino         the first version
+ * v1.1     2026-10-18                  1. Linux 主机仿真工程，去掉 LED 闪烁
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "user.h"
+#include "bootloader.h"
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  外设初始化前的一些处理
+ * @note   执行到此处，主机仿真的时钟线程已启动
+ * @retval None
+ */
+void System_Init(void)
+{
+    
+}
+
+
+/**
+ * @brief  应用初始化
+ * @note   此时外设已初始化完毕
+ * @retval None
+ */
+void APP_Init(void)
+{
+    /* 主机仿真时 BSP_Printf 输出至标准输出， UART1 仅作为与上位机通讯的接口 */
+    BSP_UART_Init( BSP_UART1 );
+
+    BSP_Board_Init();
+
+    Bootloader_Init();
+}
+
+
+/**
+ * @brief  应用运行
+ * @note   APP_Running 本身就在一个 while(1) 内
+ * @retval None
+ */
+void APP_Running(void)
+{
+    while(1)
+    {
+        Bootloader_Loop();
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef __BSP_UART_STM32_H__
+#define __BSP_UART_STM32_H__
+
+#include "bsp_common.h"
+
+/* 主机仿真时， BSP_Printf 由 bsp_uart_host.c 实现，输出至标准输出 */
+#if (ENABLE_DEBUG_PRINT == 0)
+    #define BSP_Printf(...)
+#endif
+
+
+#if (BSP_USING_UART1)
+extern UART_HandleTypeDef huart1;
+#endif
+#if (BSP_USING_UART2)
+extern UART_HandleTypeDef huart2;
+#endif
+
+/* 配置项 */
+#define UART1_HANDLE                    huart1
+#define UART2_HANDLE                    huart2
+
+#endif
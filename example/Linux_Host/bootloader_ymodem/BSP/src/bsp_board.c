@@ -0,0 +1,14 @@
+#include "bsp_board.h"
+
+
+/**
+ * @brief  板卡初始化
+ * @note   用于从 APP 复位进入 bootloader 时需要对某些 GPIO 进行初始化的操作
+ * @retval None
+ */
+void BSP_Board_Init(void)
+{
+    
+}
+
+
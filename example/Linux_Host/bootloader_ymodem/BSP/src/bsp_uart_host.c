@@ -0,0 +1,343 @@
+/**
+ * \file            bsp_uart_host.c
+ * \brief           portable file of the UART driver for the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  1. 增加波特率的查询和切换
+ * v1.2     2026-10-18                  1. 增加 UART2
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bsp_uart.h"
+
+
+/* Private define ------------------------------------------------------------*/
+#define UART_CLOCK_FREQ                 72000000U   /* 仿真的 UART 外设时钟，同 STM32F1 的 PCLK2 */
+#define UART_BAUD_MAX_ERROR             20          /* 实际波特率允许的最大误差，单位 ‰ */
+
+
+/* Private variables ---------------------------------------------------------*/
+static UART_Callback_t  _UART_RxCallback;
+static UART_Callback_t  _UART_RxIdleCallback;
+static UART_Callback_t  _UART_DMA_RxCallback;
+static UART_Callback_t  _UART_DMA_TxCallback;
+
+
+#if (BSP_USING_UART1)
+UART_CREATE(1);
+#endif
+#if (BSP_USING_UART2)
+UART_CREATE(2);
+#endif
+
+struct UART_STRUCT *_uart_group[] = 
+{
+#if (BSP_USING_UART1)
+    &UART(1),
+#endif   
+#if (BSP_USING_UART2)
+    &UART(2),
+#endif   
+};
+
+static const uint8_t _uart_qty = sizeof(_uart_group) / sizeof(struct UART_STRUCT *); 
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  UART 的初始化
+ * @note   仿真 UART 的 PTY 已在 main.c 中创建
+ * @param[in]  uart: UART 对象
+ * @param[in]  rx_callback: 接收单字节数据中断的回调函数
+ * @param[in]  rx_idle_callback: 空闲中断的回调函数
+ * @param[in]  dma_rx_callback: DMA 接收中断的回调函数
+ * @param[in]  dma_tx_callback: DMA 发送完成的回调函数
+ * @retval None
+ */
+void BSP_UART_Port_Init( struct UART_STRUCT *uart, 
+                         UART_Callback_t rx_callback, 
+                         UART_Callback_t rx_idle_callback, 
+                         UART_Callback_t dma_rx_callback, 
+                         UART_Callback_t dma_tx_callback)
+{
+    _UART_RxCallback     = rx_callback;
+    _UART_RxIdleCallback = rx_idle_callback;
+    _UART_DMA_RxCallback = dma_rx_callback;
+    _UART_DMA_TxCallback = dma_tx_callback;
+    
+    switch (uart->id)
+    {
+    #if (BSP_USING_UART1)
+        case BSP_UART1:     uart->handle = UART1_HANDLE; break;
+    #endif
+    #if (BSP_USING_UART2)
+        case BSP_UART2:     uart->handle = UART2_HANDLE; break;
+    #endif
+        default: break;
+    }
+
+    BSP_Printf("-----------------------------\r\n");
+    BSP_Printf("[ %s ]\r\n", __func__);
+    BSP_Printf("id: %d\r\n", uart->id);
+    BSP_Printf("pty: %s\r\n", uart->handle.Instance->name);
+    BSP_Printf("-----------------------------\r\n\r\n");
+}
+
+
+/**
+ * @brief  UART 等待接收数据的信号锁
+ * @note   主机仿真不使用 RTOS
+ * @param[in]  uart: UART 对象
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_RxLock(struct UART_STRUCT *uart)
+{
+    return BSP_UART_ERR_OK;
+}
+
+
+/**
+ * @brief  UART 接收到数据发出的信号锁
+ * @note   主机仿真不使用 RTOS
+ * @param[in]  uart: UART 对象
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_RxUnlock(struct UART_STRUCT *uart)
+{
+    return BSP_UART_ERR_OK;
+}
+
+
+/**
+ * @brief  UART 发送锁
+ * @note   主机仿真不使用 RTOS
+ * @param[in]  uart: UART 对象
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_TxLock(struct UART_STRUCT *uart)
+{
+    return BSP_UART_ERR_OK;
+}
+
+
+/**
+ * @brief  UART 发送完毕解锁
+ * @note   主机仿真不使用 RTOS
+ * @param[in]  uart: UART 对象
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_TxUnlock(struct UART_STRUCT *uart)
+{  
+    return BSP_UART_ERR_OK;
+}
+
+
+/**
+ * @brief  使能 UART 接收数据
+ * @note   
+ * @param[in]  uart: UART 对象
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_EnableReceive(struct UART_STRUCT *uart)
+{
+    uart->old_pos = 0;
+
+    return (BSP_UART_ERR)HAL_UART_Receive_DMA(&uart->handle, (uint8_t *)uart->rx_buff, uart->rx_buff_max_len);
+}
+
+
+/**
+ * @brief  禁止 UART 接收数据
+ * @note   
+ * @param[in]  uart: UART 对象
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_DisableReceive(struct UART_STRUCT *uart)
+{
+    return (BSP_UART_ERR)HAL_UART_DMAPause(&uart->handle);
+}
+
+
+/**
+ * @brief  控制 UART 发送一帧数据
+ * @note   主机仿真均以阻塞方式发送
+ * @param[in]  uart: UART 对象
+ * @param[in]  data: 要发送的数据
+ * @param[in]  len: 要发送的数据长度，单位 byte。最大长度: 65535 byte
+ * @param[in]  timeout: 最大处理超时时间，单位 ms。最大指定时间: 65535 ms
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_Send(struct UART_STRUCT *uart, const uint8_t *data, uint16_t len, uint16_t timeout)
+{
+    return (BSP_UART_ERR)HAL_UART_Transmit(&uart->handle, data, len, timeout ? timeout : HAL_MAX_DELAY);
+}
+
+
+#if (ENABLE_DEBUG_PRINT && EANBLE_PRINTF_USING_RTT == 0)
+/**
+ * @brief  同 printf
+ * @note   主机仿真时输出至标准输出，不占用 UART ，可在中断中使用
+ * @param[in]  fmt: 格式化字符
+ * @param[in]  ...: 不定长参数
+ * @retval None
+ */
+void BSP_Printf(const char *fmt, ...)
+{
+    if (host_cfg.quiet) {
+        return;
+    }
+
+    va_list args;
+    
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+#endif
+
+
+/**
+ * @brief  查询 UART 是否支持指定的波特率
+ * @note   按 16 倍过采样的 STM32 UART 计算，分频值超出范围或实际波特率误差超过 UART_BAUD_MAX_ERROR 时不支持
+ * @param[in]  uart: UART 对象
+ * @param[in]  baudrate: 波特率
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_CheckBaudRate(struct UART_STRUCT *uart, uint32_t baudrate)
+{
+    if (baudrate == 0) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+
+    uint32_t div = (UART_CLOCK_FREQ + baudrate / 2) / baudrate;
+    if (div < 16 || div > 0xFFFF) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+
+    uint32_t actual = UART_CLOCK_FREQ / div;
+    uint32_t diff   = (actual > baudrate) ? (actual - baudrate) : (baudrate - actual);
+    if ((uint64_t)diff * 1000 > (uint64_t)baudrate * UART_BAUD_MAX_ERROR) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+    
+    return BSP_UART_ERR_OK;
+}
+
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   主机仿真以阻塞方式发送，调用时已无正在发送的数据
+ * @param[in]  uart: UART 对象
+ * @param[in]  baudrate: 波特率，需先经 BSP_UART_Port_CheckBaudRate 确认
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_SetBaudRate(struct UART_STRUCT *uart, uint32_t baudrate)
+{
+    uart->handle.Init.BaudRate = baudrate;
+    
+    return (BSP_UART_ERR)HAL_UART_Init(&uart->handle);
+}
+
+
+/**
+ * @brief  从 UART 获取一个字节的数据
+ * @note   主机仿真仅使用 DMA 接收，不会调用
+ * @param[in]  uart: UART 对象
+ * @retval UART 数据
+ */
+uint32_t BSP_UART_Port_GetOneByte(struct UART_STRUCT *uart)
+{
+    return 0;
+}
+
+
+/**
+ * @brief  获取 DMA 当前的计数
+ * @note   
+ * @param[in]  uart: UART 对象
+ * @retval 计数值
+ */
+uint32_t BSP_UART_Port_GetDmaCounter(struct UART_STRUCT *uart)
+{
+    return __HAL_DMA_GET_COUNTER(uart->handle.hdmarx);
+}
+
+
+/**
+ * @brief  通过 UART ID 获取 UART 对象
+ * @note   
+ * @param[in]  id: 串口 ID
+ * @retval NULL: 无效的 ID。非 NULL: UART 对象
+ */
+struct UART_STRUCT *BSP_UART_Port_GetHandle(BSP_UART_ID id)
+{
+    for (uint8_t i = 0; i < _uart_qty; i++)
+    {
+        if (_uart_group[i]->id == id) {
+            return _uart_group[i];
+        }
+    }
+    
+    return NULL;
+}
+
+
+/* Callback functions ---------------------------------------------------------*/
+/* 以下 3 个函数均是 host_hal.c 中 UART 相关的中断函数的回调函数 */
+/* UART DMA 接收半满中断 */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    struct UART_STRUCT *uart = (struct UART_STRUCT *)huart;
+    
+    if (_UART_DMA_RxCallback) {
+        _UART_DMA_RxCallback(uart);
+    }
+}
+
+/* UART DMA 接收全满中断 */
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    struct UART_STRUCT *uart = (struct UART_STRUCT *)huart;
+    
+    if (_UART_DMA_RxCallback) {
+        _UART_DMA_RxCallback(uart);
+    }
+}
+
+/* UART 空闲中断 */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    struct UART_STRUCT *uart = (struct UART_STRUCT *)huart;
+    
+    if (_UART_RxIdleCallback) {
+        _UART_RxIdleCallback(uart);
+    }
+}
@@ -0,0 +1,502 @@
+/**
+ * \file            fal_host_flash.c
+ * \brief           onchip flash operate interface of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  1. 按器件模型的编程单元写入、按 sector 擦除
+ *                                      2. 增加 SPI flash 模式下的 FAL 片内 flash 设备
+ * v1.2     2026-10-18                  增加 caps 接口，按模型支持的快速编程方式写入
+ * v1.3     2026-10-18                  增加 async 接口，以中断方式擦除一个 sector 或编程一行
+ * v1.4     2026-10-18                  增加 geometry 接口，按模型给出 sector 布局
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bsp_common.h"
+#if (IS_ENABLE_SPI_FLASH)
+#include <fal.h>
+#endif
+
+/**
+ * 注意：
+ *    bsp_flash.c 以 read 、 write 、 erase 这三个名称声明片内 flash 的操作接口，在主机上会和 libc 的 read 、 write 冲突。
+ *    因此 Makefile 在编译本文件和 bsp_flash.c 时通过 -Dread=onchip_read 等宏定义统一改名，函数原型保持和 fal_stm32f1_flash.c 一致。
+ *    片内 flash 的 sector 布局和编程单元由 host_flash.c 的器件模型决定，可用 -m 参数切换。
+ */
+
+
+/* Private define ------------------------------------------------------------*/
+#define ASYNC_PROGRAM_SIZE      256     /* async 接口一次启动编程的数据量，由编程完成中断逐个单元接续 */
+
+
+/* Extern function prototypes ------------------------------------------------*/
+extern void Firmware_OperateCallback(uint16_t progress);
+
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t prepare_unit(uint32_t addr, const uint8_t *buf, size_t size, uint32_t *type_program, uint64_t *write_data);
+static int      erase_start(long offset, size_t size);
+static int      write_start(long offset, const uint8_t *buf, size_t size);
+static int      busy(void);
+
+
+#if (IS_ENABLE_SPI_FLASH)
+static int init(void);
+int read(long offset, uint8_t *buf, size_t size);
+int write(long offset, const uint8_t *buf, size_t size);
+int erase(long offset, size_t size);
+
+
+/* Exported variables ---------------------------------------------------------*/
+/* 擦除粒度填最小的 sector ，实际按 sector 擦除 */
+const struct fal_flash_dev stm32_onchip_flash = 
+{ 
+    .name       = FAL_ONCHIP_FLASH_DEV_NAME,
+    .addr       = FLASH_BASE,
+    .len        = ONCHIP_FLASH_SIZE,
+    .blk_size   = FLASH_PAGE_SIZE,
+    .ops        = {init, read, write, erase},
+    .write_gran = 32,
+};
+#endif
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  读取 flash 的数据
+ * @note   先等待中断方式的擦写结束，再按模型的读取带宽计时
+ * @param[in]   offset: 偏移地址
+ * @param[out]  buf: 数据缓存池
+ * @param[in]   size: 数据长度，单位 byte
+ * @retval 读到的数据长度，单位 byte
+ */
+int read(long offset, uint8_t *buf, size_t size)
+{
+#if (IS_ENABLE_SPI_FLASH)
+    uint32_t addr = stm32_onchip_flash.addr + offset;
+#else
+    uint32_t addr = offset;
+#endif
+    int64_t time_us;
+
+    if ((addr + size) > ONCHIP_FLASH_END_ADDRESS)
+    {
+        BSP_Printf("ERROR: read outrange flash size! addr is (0x%.8X)\r\n", addr + size);
+        return -1;
+    }
+
+    /* 擦写期间读取 flash 会停顿至擦写结束 */
+    FLASH_WaitForLastOperation(FLASH_TIMEOUT_VALUE);
+
+    time_us = HOST_Flash_Read(&host_onchip_flash, addr - FLASH_BASE, buf, size);
+    if (time_us < 0)
+        return -1;
+    HOST_Flash_Wait(time_us);
+
+    return size;
+}
+
+
+/**
+ * @brief  获取 flash 的编程能力
+ * @note   由模型决定：最小写入单位为字或双字，支持快速编程的模型再给出行或并行双字的 burst_unit
+ * @retval flash 的编程能力
+ */
+const struct BSP_FLASH_CAPS *caps(void)
+{
+    static struct BSP_FLASH_CAPS flash_caps;
+    const struct HOST_FLASH_MODEL *model = host_onchip_flash.model;
+
+    /* STM32L4 等只能按双字编程 */
+    flash_caps.min_unit   = (model->program_unit > sizeof(uint32_t)) ? sizeof(uint64_t) : sizeof(uint32_t);
+    flash_caps.burst_unit = flash_caps.min_unit;
+    flash_caps.mode       = BSP_FLASH_PROGRAM_NORMAL;
+
+    if (model->burst_unit > sizeof(uint64_t))
+    {
+        flash_caps.burst_unit = model->burst_unit;
+        flash_caps.mode       = BSP_FLASH_PROGRAM_FAST_ROW;
+    }
+    else if (model->burst_unit > flash_caps.min_unit)
+    {
+        flash_caps.burst_unit = model->burst_unit;
+        flash_caps.mode       = BSP_FLASH_PROGRAM_PARALLEL;
+    }
+
+    return &flash_caps;
+}
+
+
+/**
+ * @brief  获取 flash 的异步擦写接口
+ * @note   以中断方式每次擦除一个 sector 或编程一个单元，由 FLASH_FLAG_BSY 判断是否完成
+ * @retval flash 的异步擦写接口
+ */
+const struct BSP_FLASH_ASYNC *async(void)
+{
+    static const struct BSP_FLASH_ASYNC flash_async = 
+    {
+        .erase_start = erase_start,
+        .write_start = write_start,
+        .busy        = busy,
+    };
+
+    return &flash_async;
+}
+
+
+/**
+ * @brief  获取 flash 的 sector 布局
+ * @note   由模型决定，只取镜像使用的 ONCHIP_FLASH_SIZE 。没有块擦除，整片擦除会擦掉 bootloader ，不使用
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *geometry(void)
+{
+    static struct BSP_FLASH_GEOMETRY flash_geometry;
+    uint32_t size = 0;
+    const struct HOST_FLASH_MODEL *model = host_onchip_flash.model;
+
+    if (flash_geometry.region_num)
+        return &flash_geometry;
+
+    flash_geometry.addr = FLASH_BASE;
+    for (uint8_t i = 0; i < model->region_num && i < BSP_FLASH_MAX_REGION && size < ONCHIP_FLASH_SIZE; i++)
+    {
+        struct BSP_FLASH_REGION *region = &flash_geometry.region[flash_geometry.region_num++];
+
+        region->sector_size = model->region[i].sector_size;
+        region->sector_num  = model->region[i].sector_num;
+        if (size + region->sector_size * region->sector_num > ONCHIP_FLASH_SIZE)
+            region->sector_num = (ONCHIP_FLASH_SIZE - size) / region->sector_size;
+        size += region->sector_size * region->sector_num;
+    }
+
+    return &flash_geometry;
+}
+
+
+/**
+ * @brief  写入 flash
+ * @note   1. 地址按 burst_unit 对齐且剩余数据足够时，按 caps 的方式快速编程一行或并行编程一个双字
+ *         2. 其余按字或双字写入（取决于模型的编程单元），不足的部分以 0xFF 补齐
+ * @param[in]  offset: 偏移地址 
+ * @param[in]  buf: 数据池
+ * @param[in]  size: 数据长度，单位 byte
+ * @retval -1: 失败。其他: 写入的数据长度，单位 byte
+ */
+int write(long offset, const uint8_t *buf, size_t size)
+{
+    int8_t   status = 0;
+    size_t   byte_step = 0;
+    uint16_t byte_num = 0;
+    uint32_t type_program = 0;
+    uint64_t write_data = 0;
+    const uint8_t *src = NULL;
+#if (IS_ENABLE_SPI_FLASH)
+    uint32_t addr = stm32_onchip_flash.addr + offset;
+#else
+    uint32_t addr = offset;
+#endif
+    
+    if ((addr + size) > ONCHIP_FLASH_END_ADDRESS)
+    {
+        BSP_Printf("ERROR: write outrange flash size! addr is (0x%.8X)\r\n", addr + size);
+        return -1;
+    }
+    
+    if (size < 1)
+    {
+        return -1;
+    }
+
+    HAL_FLASH_Unlock();
+    
+    for (byte_step = 0; byte_step < size; byte_step += byte_num, addr += byte_num)
+    {
+        byte_num = prepare_unit(addr, &buf[byte_step], size - byte_step, &type_program, &write_data);
+        src      = (byte_num > sizeof(uint64_t)) ? &buf[byte_step] : (const uint8_t *)&write_data;
+
+        if (HAL_FLASH_Program(type_program, addr, write_data) != HAL_OK)
+        {
+            status = -1;
+            break;
+        }
+
+        /* Check the written value */
+        if (memcmp((const void *)(uintptr_t)addr, src, byte_num) != 0)
+        {
+            BSP_Printf("ERROR: write data != read data\r\n");
+            status = -1;
+            break;
+        }
+    }
+
+    HAL_FLASH_Lock();
+    
+    if (status)
+    {
+        return status;
+    }
+
+    return size;
+}
+
+
+/**
+ * @brief  擦除 flash
+ * @note   1. 按 sector 擦除，每擦除一个 sector 回调一次进度，使 bootloader 在擦除期间仍可处理主机数据
+ *         2. 擦除范围未与 sector 对齐时，会连带擦除范围外的数据，此时给出警告
+ * @param[in]   offset: 偏移地址 
+ * @param[in]   size: 数据长度，单位 byte
+ * @retval -2: 擦除失败。 -1: 超过 flash 大小。其他: 擦除的数据长度，单位 byte
+ */
+int erase(long offset, size_t size)
+{
+    uint32_t PageError = 0;
+    uint32_t progress = 0;
+    uint32_t sector_offset = 0;
+    uint32_t sector_size = 0;
+    HAL_StatusTypeDef status = HAL_OK;
+    FLASH_EraseInitTypeDef pEraseInit;
+#if (IS_ENABLE_SPI_FLASH)
+    uint32_t addr = stm32_onchip_flash.addr + offset;
+#else
+    uint32_t addr = offset;
+#endif
+    uint32_t end_addr = addr + size;
+
+    if (end_addr > ONCHIP_FLASH_END_ADDRESS || size == 0)
+    {
+        BSP_Printf("ERROR: erase outrange flash size! addr is (0x%.8X)\r\n", end_addr);
+        return -1;
+    }
+
+    /* 获取起始地址所在的 sector */
+    HOST_Flash_GetSector(&host_onchip_flash, addr - FLASH_BASE, &sector_offset, &sector_size);
+
+    if ((sector_offset + FLASH_BASE) != addr)
+    {
+        BSP_Printf("WARNING: erase start 0x%.8X is not sector aligned, 0x%.8X ~ 0x%.8X will be erased too\r\n",
+                   addr, sector_offset + FLASH_BASE, addr);
+    }
+
+    HAL_FLASH_Unlock();
+    
+    pEraseInit.TypeErase   = FLASH_TYPEERASE_PAGES;
+    pEraseInit.PageAddress = sector_offset + FLASH_BASE;
+    pEraseInit.Banks       = FLASH_BANK_1;
+    pEraseInit.NbPages     = 1;
+
+    while (pEraseInit.PageAddress < end_addr)
+    {
+        HOST_Flash_GetSector(&host_onchip_flash, pEraseInit.PageAddress - FLASH_BASE, &sector_offset, &sector_size);
+
+        status = HAL_FLASHEx_Erase(&pEraseInit, &PageError);
+        if (status != HAL_OK)
+            break;
+        
+        pEraseInit.PageAddress += sector_size;
+
+        progress += (uint64_t)10000 * sector_size / size;
+        Firmware_OperateCallback(progress);
+    }
+
+    HAL_FLASH_Lock();
+    
+    if (status != HAL_OK)
+    {
+        return -2;
+    }
+
+    if (pEraseInit.PageAddress != end_addr)
+    {
+        BSP_Printf("WARNING: erase end 0x%.8X is not sector aligned, 0x%.8X ~ 0x%.8X will be erased too\r\n",
+                   end_addr, end_addr, pEraseInit.PageAddress);
+    }
+
+    return size;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  准备一个编程单元的数据
+ * @note   1. 地址按 burst_unit 对齐且剩余数据足够时，按 caps 的方式快速编程一行或并行编程一个双字
+ *         2. 其余按字或双字写入（取决于模型的编程单元），不足的部分以 0xFF 补齐
+ * @param[in]   addr: 写入的地址
+ * @param[in]   buf: 数据池
+ * @param[in]   size: 剩余的数据长度，单位 byte
+ * @param[out]  type_program: 编程方式
+ * @param[out]  write_data: 编程的数据，行编程时为数据的地址
+ * @retval 编程单元的长度，单位 byte
+ */
+static uint16_t prepare_unit(uint32_t addr, const uint8_t *buf, size_t size, uint32_t *type_program, uint64_t *write_data)
+{
+    uint16_t byte_num;
+    const struct BSP_FLASH_CAPS *flash_caps = caps();
+
+    if (flash_caps->mode != BSP_FLASH_PROGRAM_NORMAL
+    &&  (addr % flash_caps->burst_unit) == 0
+    &&  size >= flash_caps->burst_unit)
+    {
+        byte_num = flash_caps->burst_unit;
+    }
+    else
+    {
+        byte_num = flash_caps->min_unit;
+    }
+
+    if (byte_num > sizeof(uint64_t))
+    {
+        /* 行编程直接传入数据的地址 */
+        *type_program = FLASH_TYPEPROGRAM_FAST;
+        *write_data   = (uintptr_t)buf;
+    }
+    else
+    {
+        *type_program = (byte_num == sizeof(uint64_t)) ? FLASH_TYPEPROGRAM_DOUBLEWORD : FLASH_TYPEPROGRAM_WORD;
+        *write_data   = 0xFFFFFFFFFFFFFFFF;
+        memcpy(write_data, buf, size < byte_num ? size : byte_num);
+    }
+
+    return byte_num;
+}
+
+
+/**
+ * @brief  以中断方式擦除 offset 所在的 sector
+ * @note   
+ * @param[in]  offset: 偏移地址
+ * @param[in]  size: 剩余的擦除长度，单位 byte
+ * @retval <= 0: 失败。其他: 从 offset 到该 sector 结束的长度，单位 byte
+ */
+static int erase_start(long offset, size_t size)
+{
+    uint32_t sector_offset = 0;
+    uint32_t sector_size = 0;
+    HAL_StatusTypeDef status;
+    FLASH_EraseInitTypeDef pEraseInit;
+#if (IS_ENABLE_SPI_FLASH)
+    uint32_t addr = stm32_onchip_flash.addr + offset;
+#else
+    uint32_t addr = offset;
+#endif
+
+    if ((addr + size) > ONCHIP_FLASH_END_ADDRESS || size == 0
+    ||  HOST_Flash_GetSector(&host_onchip_flash, addr - FLASH_BASE, &sector_offset, &sector_size) < 0)
+    {
+        BSP_Printf("ERROR: erase outrange flash size! addr is (0x%.8X)\r\n", addr + size);
+        return -1;
+    }
+
+    pEraseInit.TypeErase   = FLASH_TYPEERASE_PAGES;
+    pEraseInit.PageAddress = sector_offset + FLASH_BASE;
+    pEraseInit.Banks       = FLASH_BANK_1;
+    pEraseInit.NbPages     = 1;
+
+    HAL_FLASH_Unlock();
+    status = HAL_FLASHEx_Erase_IT(&pEraseInit);
+    HAL_FLASH_Lock();
+
+    if (status != HAL_OK)
+        return -1;
+
+    return sector_offset + sector_size - (addr - FLASH_BASE);
+}
+
+
+/**
+ * @brief  以中断方式编程一行
+ * @note   1. 从 offset 编程至 ASYNC_PROGRAM_SIZE 对齐的边界，单元的选择与 write 相同，各单元在编程完成中断中接续
+ *         2. 不回读校验，由 bootloader 的写入检查负责
+ * @param[in]  offset: 偏移地址
+ * @param[in]  buf: 数据池
+ * @param[in]  size: 剩余的数据长度，单位 byte
+ * @retval <= 0: 失败。其他: 本次编程的数据长度，单位 byte
+ */
+static int write_start(long offset, const uint8_t *buf, size_t size)
+{
+    uint16_t byte_num;
+    uint32_t type_program;
+    uint64_t write_data;
+    size_t   byte_step;
+    HAL_StatusTypeDef status = HAL_OK;
+#if (IS_ENABLE_SPI_FLASH)
+    uint32_t addr = stm32_onchip_flash.addr + offset;
+#else
+    uint32_t addr = offset;
+#endif
+
+    if ((addr + size) > ONCHIP_FLASH_END_ADDRESS || size == 0)
+    {
+        BSP_Printf("ERROR: write outrange flash size! addr is (0x%.8X)\r\n", addr + size);
+        return -1;
+    }
+
+    if (size > ASYNC_PROGRAM_SIZE - (addr % ASYNC_PROGRAM_SIZE))
+        size = ASYNC_PROGRAM_SIZE - (addr % ASYNC_PROGRAM_SIZE);
+
+    HAL_FLASH_Unlock();
+    for (byte_step = 0; byte_step < size && status == HAL_OK; byte_step += byte_num, addr += byte_num)
+    {
+        byte_num = prepare_unit(addr, &buf[byte_step], size - byte_step, &type_program, &write_data);
+        status   = HAL_FLASH_Program_IT(type_program, addr, write_data);
+    }
+    HAL_FLASH_Lock();
+
+    if (status != HAL_OK)
+        return -1;
+
+    return size;
+}
+
+
+/**
+ * @brief  上一次以中断方式启动的擦写是否未完成
+ * @note   
+ * @retval 1: 未完成 0: 已完成
+ */
+static int busy(void)
+{
+    return __HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY) ? 1 : 0;
+}
+
+
+#if (IS_ENABLE_SPI_FLASH)
+/**
+ * @brief  FAL 片内 flash 设备的初始化
+ * @note   镜像已由 main.c 的 MX_FLASH_Init 映射
+ * @retval 0
+ */
+static int init(void)
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,744 @@
+/**
+ * \file            bootloader_config.h
+ * \brief           bootloader configuration
+ */
+
+/*
+ * Copyright (c) 2022 Dino Haw
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Author:          Dino Haw <347341799@qq.com>
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2022-11-23     Dino         the first version
+ * v1.1     2022-12-04     Dino         1. 增加一个记录版本的机制，可选写在 APP 分区
+ *                                      2. 增加长按按键恢复出厂固件的选项
+ *                                      3. 将 flash 的擦除粒度配置移至 user_config.h 
+ *                                      4. 增加是否判断固件包超过分区大小的选项
+ * v1.2     2022-12-07     Dino         1. 增加 ONCHIP_FLASH_ONCE_WRITE_BYTE 配置项
+ * v1.3     2022-12-08     Dino         1. 增加固件包可放置在 SPI flash 的功能
+ *                                      2. 增加 ENABLE_FACTORY_UPDATE_TO_APP 配置项
+ * v1.4     2022-12-21     Dino         1. 增加 SPI_FLASH_SIZE 配置项
+ * v1.5     2023-12-14     Dino         1. 更新注释说明
+ *                                      2. 增加 FIRMWARE_HEAD_DATA 配置项
+ *                                      3. 增加 USING_CUSTOM_UPDATE_FLAG 配置项
+ * v1.6     2026-10-18                  1. Linux 主机仿真工程的配置
+ * v1.7     2026-10-18                  1. ONCHIP_FLASH_ONCE_WRITE_BYTE 改为 8 ，兼容 STM32L4 等按双字编程的模型
+ *                                      2. 增加 HOST_USING_SPI_FLASH 配置项
+ * v1.8     2026-10-18                  1. 分区方案可由 Makefile 的 PART 定义的 HOST_PART_PROJECT 选择
+ * v1.9     2026-10-18                  1. 增加 ENABLE_YMODEM_G 配置项
+ * v1.10    2026-10-18                  1. 增加 ENABLE_WINDOW_PROTOCOL 配置项
+ * v1.11    2026-10-18                  1. 增加 ENABLE_YMODEM_EXT_FRAME 配置项
+ * v1.12    2026-10-18                  1. 增加 ENABLE_WRITE_BEHIND 配置项
+ * v1.13    2026-10-18                  1. 增加 ENABLE_DECOMPRESS 配置项
+ * v1.14    2026-10-18                  1. 增加 ENABLE_DELTA_UPDATE 配置项
+ * v1.15    2026-10-18                  1. 增加 ENABLE_RESUME_TRANSFER 配置项
+ * v1.16    2026-10-18                  1. 增加 ENABLE_INCREMENTAL_UPDATE 配置项
+ * v1.17    2026-10-18                  1. 增加 ENABLE_BAUD_NEGOTIATION 配置项
+ * v1.18    2026-10-18                  1. 增加 CRC_SLICE_NUM 和 ENABLE_CRC32_HARDWARE 配置项
+ * v1.19    2026-10-18                  1. 增加 ENABLE_FRAME_PARSER 配置项
+ * v1.20    2026-10-18                  1. 增加 ENABLE_STREAM_VERIFY 配置项
+ * v1.21    2026-10-18                  1. 增加 USING_APP_WRITE_CHECK_PROJECT 配置项
+ * v1.22    2026-10-18                  1. 增加 ENABLE_ERASE_AHEAD 配置项
+ * v1.23    2026-10-18                  1. 增加 ENABLE_ERASE_STATE 配置项
+ * v1.24    2026-10-18                  1. 增加 ENABLE_ASYNC_FLASH 配置项
+ * v1.25    2026-10-18                  1. 增加 YMODEM_G_FRAME_WRITE_TIME 配置项，写入跟不上时第 0 帧改按 YModem 传输
+ */
+
+/**
+ * OTA 组件的开放配置选项
+ */
+#include "bootloader_define.h"
+
+/**
+ * 【选择分区方案】
+ * 解释: 
+ *    APP:      可运行的固件区域
+ *    download: 用于更新固件时的固件临时存放区域
+ *    factory:  用于存放可在紧急情况下恢复的固件使用区域
+ *    ONE_PART_PROJECT:     单分区方案（ APP ）
+ *    DOUBLE_PART_PROJECT:  双分区方案（ APP + download ）
+ *    TRIPLE_PART_PROJECT:  三分区方案（ APP + download + factory ）
+ * 选项: 
+ *    ONE_PART_PROJECT      或 0
+ *    DOUBLE_PART_PROJECT   或 1
+ *    TRIPLE_PART_PROJECT   或 2
+ * 主机仿真: 
+ *    可由 Makefile 的 PART=ONE/DOUBLE/TRIPLE 定义 HOST_PART_PROJECT ，用于基准测试比较各方案
+ */
+#ifdef HOST_PART_PROJECT
+#define USING_PART_PROJECT                  HOST_PART_PROJECT
+#else
+#define USING_PART_PROJECT                  TRIPLE_PART_PROJECT
+#endif
+
+
+/**
+ * 【 flash 相关配置项】
+ * 说明: 
+ *    配置各个分区的大小
+ * 注意事项: 
+ *    ！！！片内 Flash 需进行页对齐， 分区首地址必须是 Flash 的 每个独立 page 或 sector 的首地址，否则固件无法运行！！！
+ *    ！！！放置在 SPI Flash 的分区至少需要最小擦写粒度的整数倍为单位进行对齐，建议以 sector 的整数倍为单位进行对齐！！！
+ */
+#define ONCHIP_FLASH_SIZE                   (512 * 1024)            /* 片上 flash 容量，单位: byte */
+#define BOOTLOADER_SIZE                     (32 * 1024)             /* 预留给 bootloader 的空间，单位: byte（最小需要大于本工程编译后的大小） */
+#define APP_PART_SIZE                       (128 * 1024)            /* 预留给 APP 分区的空间，单位: byte（注意页对齐） */
+#define DOWNLOAD_PART_SIZE                  (APP_PART_SIZE)         /* 预留给 download 分区的空间，单位: byte（注意页对齐，不使用时，写0） */
+#define FACTORY_PART_SIZE                   (APP_PART_SIZE)         /* 预留给 factory 分区的空间，单位: byte（注意页对齐，不使用时，写0） */
+
+
+/**
+ * 【源固件头数据】
+ * 说明：
+ *    1. 源固件的头数据一般是指 bin 文件的头数据，用于判断 APP 分区是否已经存在固件
+ *    2. FIRMWARE_HEAD_DATA 表示源固件的头数据 和 FIRMWARE_HEAD_DATA_MASK 进行 & 运算后得到的数据
+ *       - 假设源固件的头数据为 0x20013238 ， FIRMWARE_HEAD_DATA_MASK 为 0x2FF00000 ， FIRMWARE_HEAD_DATA 为 0x20000000
+ *       - 则 0x20013238 & 0x2FF00000 = 0x20000000
+ *       - 很明显， FIRMWARE_HEAD_DATA_MASK 有效位为 1 的部分就是想用于判断的部分，为 0 的部分则表示不关心其值
+ *       - 如果还不理解，自行查找掩码相关的知识
+ * 解释: 
+ *    FIRMWARE_HEAD_DATA: 源固件的头数据（确保是能一次读到的数据长度）
+ *    FIRMWARE_HEAD_DATA_MASK: 源固件的头数据的掩码
+ */
+#define FIRMWARE_HEAD_DATA                   0x20000000
+#define FIRMWARE_HEAD_DATA_MASK              0x2FF00000
+
+
+/**
+ * 【选择是否启用解密组件】
+ * 说明: 
+ *    - 若固件包有加密，则必须启用。若固件包无加密，可按需选择是否启用
+ *    - AES256_KEY 必须等于 32 字节， AES256_IV 必须等于 16 字节
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_DECRYPT                      1
+    #if (ENABLE_DECRYPT)
+    #define AES256_KEY                      "0123456789ABCDEF0123456789ABCDEF"  /* 必须等于 32 字节 */
+    #define AES256_IV                       "0123456789ABCDEF"                  /* 必须等于 16 字节 */
+    #endif
+
+
+/**
+ * 【选择是否启用解压组件】
+ * 说明: 
+ *    - 若固件包有压缩，则必须启用。若固件包无压缩，可按需选择是否启用
+ *    - 压缩格式为 LZSS （与 heatshrink 的位流相同），解压时边接收边写入 APP 分区，
+ *      download/factory 分区中存放的仍是压缩后的固件包
+ *    - DECOMPRESS_WINDOW_BITS 为解压窗口的位数，窗口大小为 2^n byte ，占用同等大小的 RAM ，
+ *      打包时选择的窗口不能大于该值，窗口越大压缩率越高，取值范围 8 ~ 12
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_DECOMPRESS                   1
+    #if (ENABLE_DECOMPRESS)
+    #define DECOMPRESS_WINDOW_BITS          10
+    #endif
+
+
+/**
+ * 【选择是否启用差分升级】
+ * 说明: 
+ *    - 差分固件包的包体是基于 APP 分区当前固件（基础固件）的补丁，可按需再压缩和加密
+ *    - 接收时读取 APP 分区的基础固件，边还原边写入 download/factory 分区，存放的是还原后不加密、不压缩的固件包，
+ *      之后的校验和更新与普通固件包相同。注意固件以明文存放，放置在片外 flash 时需评估风险
+ *    - 补丁头记录了基础固件的大小和 CRC32 ，与 APP 分区不一致时取消更新
+ *    - 仅多分区方案有效，单分区方案接收时 APP 分区已擦除，无法还原
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_DELTA_UPDATE                 1
+
+
+/**
+ * 【选择是否启用断点续传】
+ * 说明: 
+ *    - 固件包写入 download 分区期间，写入位置每越过分区内一个 4 Kbyte 对齐的地址，在进度记录中追加一条记录（固件包头的 CRC32 、
+ *      该地址之前的包体数据量和 CRC32 中间值），传输中断或设备掉电后，主机重新下发同一个固件包时，设备校验已写入的数据，
+ *      只擦除记录位置之后已写入的数据，并告知主机从记录的位置继续发送
+ *    - 主机需在第 0 帧请求断点续传（ YModem 的 "RESUME" ），未请求时按新的固件包重新接收
+ *    - 进度记录占用 download 分区末尾的 RESUME_JOURNAL_SIZE byte ，需为 flash 擦除粒度的整数倍，固件包不能超过剩余的空间
+ *    - download 分区所在 flash 的擦除粒度需不大于 4 Kbyte ，且 4 Kbyte 为其整数倍
+ *    - 仅多分区方案下发至 download 分区的固件包有效，差分固件包在接收时还原，无法续传
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_RESUME_TRANSFER              1
+    #if (ENABLE_RESUME_TRANSFER)
+    #define RESUME_JOURNAL_SIZE             4096
+    #endif
+
+
+/**
+ * 【选择是否启用 APP 分区的增量写入】
+ * 说明: 
+ *    - 固件更新至 APP 分区前，先将固件包读取、解密、解压一遍，按 INCREMENTAL_ERASE_UNIT 分块与 APP 分区的现有数据比较，
+ *      只擦除和写入有差异的块，相同的块保持不变，适用于小版本更新或恢复出厂固件等大部分数据不变的场景
+ *    - APP 分区的首个块总是擦除和重写，其首地址数据仍在校验通过后最后写入
+ *    - INCREMENTAL_ERASE_UNIT 需为 APP 分区所在 flash 的擦除粒度（或其整数倍），APP 分区内的擦除粒度需统一，
+ *      APP_PART_SIZE 需为其整数倍。 STM32F4 等 sector 大小不一的 flash 不适用
+ *    - 仅多分区方案有效
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_INCREMENTAL_UPDATE           1
+    #if (ENABLE_INCREMENTAL_UPDATE)
+    #define INCREMENTAL_ERASE_UNIT          FLASH_PAGE_SIZE
+    #endif
+
+
+/**
+ * 【选择是否在接收时计算固件包的 CRC32 】
+ * 说明: 
+ *    - 主机下发的固件包写入 flash 时，同时累加包体（还原后写入 APP 分区时为源固件）的 CRC32 ，接收完成后直接与包头中的
+ *      CRC32 比较，不再将整个固件包从分区中读出校验，固件包放在 SPI flash 时可省去一次完整的读取
+ *    - 固件包从 download/factory 分区更新至 APP 分区时，同样累加解密、解压后的源固件的 CRC32 ，校验 APP 时不再读取整个 APP 分区，
+ *      写入 flash 的数据由 USING_APP_WRITE_CHECK_PROJECT 的写入检查确认
+ *    - STREAM_VERIFY_READ_BACK 为 1 时，校验前读回最后一次写入的数据，确认与写入时的 CRC32 一致
+ *    - 写入过程中出现非顺序的写入（如重新开始写入或擦除了该分区）时，仍读取整个固件包校验
+ *    - 取舍: 省去的是 download/factory 分区的完整读回，校验只能发现最后一次写入的错误。 SPI flash 没有写入检查，
+ *      分区中间的一次编程失败会通过校验，随后擦除 APP 分区，直至校验 APP 时才发现，双分区方案此时已没有可运行的固件。
+ *      flash 写入可靠或以速度优先时才启用
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_STREAM_VERIFY                1
+    #if (ENABLE_STREAM_VERIFY)
+    #define STREAM_VERIFY_READ_BACK         1
+    #endif
+
+
+/**
+ * 【选择固件写入 APP 分区后的检查方案】
+ * 说明: 
+ *    - 固件更新至 APP 分区（单分区方案为主机下发至 APP 分区）时，每次写入 flash 后将刚写入的数据读回，
+ *      与 RAM 中的数据逐字节比较，不一致时本次更新失败。比较只需读取，比读出后计算 CRC32 快
+ *    - ENABLE_STREAM_VERIFY 为 1 时，校验 APP 不再读取整个 APP 分区，写入 flash 的结果只由本检查确认
+ *    - 每次检查都要读回刚写入的数据，增加更新至 APP 的耗时。 ENABLE_STREAM_VERIFY 为 1 时应选择 SAMPLE 或 FULL ，
+ *      否则写入 APP 分区的错误不会被发现
+ * 解释: 
+ *    APP_WRITE_CHECK_NONE  : 不检查，只以 flash 写入函数的返回值判断
+ *    APP_WRITE_CHECK_SAMPLE: 从首次写入开始，每 APP_WRITE_CHECK_SAMPLE_NUM 次写入检查一次
+ *    APP_WRITE_CHECK_FULL  : 每次写入都检查
+ * 选项: USING_APP_WRITE_CHECK_PROJECT
+ *    APP_WRITE_CHECK_NONE      或 0
+ *    APP_WRITE_CHECK_SAMPLE    或 1
+ *    APP_WRITE_CHECK_FULL      或 2
+ */
+#define USING_APP_WRITE_CHECK_PROJECT       APP_WRITE_CHECK_FULL
+    #if (USING_APP_WRITE_CHECK_PROJECT == APP_WRITE_CHECK_SAMPLE)
+    #define APP_WRITE_CHECK_SAMPLE_NUM      4
+    #endif
+
+
+/**
+ * 【选择是否在接收固件包时擦除分区】
+ * 说明: 
+ *    - 收到固件包头后不再先擦除整个固件占用的范围，而是按 FPK_LEAST_HANDLE_BYTE 分块，写入前才擦除写入位置所在的块，
+ *      其余的块在等待主机数据时逐块擦除，擦除与通讯并行进行。已是擦除状态的块不再擦除
+ *    - 多分区方案收到文件信息（ YModem 的第 0 帧或窗口协议的 START ）时，按文件大小预先擦除 download 分区，
+ *      APP 也可在跳转至 bootloader 前调用 Bootloader_PrepareFirmware 预告固件包的大小。
+ *      download 分区有未接收完毕的进度记录或主机请求断点续传时不预先擦除。固件包指定存放在 factory 分区时，
+ *      download 分区已预先擦除的部分不会恢复
+ *    - 移植文件的 geometry 接口提供 sector 布局时，每个块按擦除计划对齐到实际的 sector 或块擦除，STM32F4 等 sector 大于
+ *      FPK_LEAST_HANDLE_BYTE 的 flash 每个 sector 只擦除一次。分区首尾需在 sector 边界上，分区末尾的记录不能与固件共用 sector ，
+ *      FM_Init 按 sector 布局检查并打印警告
+ *    - 移植文件不提供 sector 布局时，固件包所在 flash 的擦除粒度不能大于 FPK_LEAST_HANDLE_BYTE ，否则擦除一个块会连带擦除已写入的数据
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_ERASE_AHEAD                  1
+
+/**
+ * 【选择是否在 flash 中记录各分区的擦除状态】
+ * 说明: 
+ *    - 在片内 flash 末尾的 ERASE_STATE_SIZE byte 中追加记录 APP 、 download 和 factory 分区中可能有数据的范围，
+ *      擦除或检查为空后记录为擦除状态，写入前先将写入位置至分区末尾记录为有数据。启动后按记录判断分区是否为空，
+ *      只擦除有数据的范围，无须再读取整个分区。记录写满后擦除，重写各分区最后的记录
+ *    - ERASE_STATE_SIZE 需为片内 flash 擦除粒度的整数倍，不能与片内的分区重叠。启用 SPI flash 时记录区同样位于片内 flash 末尾，
+ *      即 fal_cfg.h 分区表中的 FAL_PART_ERASE_STATE
+ *    - ENABLE_ERASE_STATE_VERIFY 为 1 时，上次运行中有未结束的写入或不完整的记录（写入期间复位或掉电）的，
+ *      本次启动不使用记录，各分区按原方式读取检查，检查或擦除后重新记录
+ *    - 各分区只能由 bootloader 写入， APP 也会写入这些分区时不能启用。分区末尾的记录（断点续传的进度记录等）不在此列，每次仍读取检查
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_ERASE_STATE                  1
+    #if (ENABLE_ERASE_STATE)
+    #define ERASE_STATE_SIZE                4096
+    #define ENABLE_ERASE_STATE_VERIFY       1
+    #endif
+
+/**
+ * 【选择是否启用异步的 flash 操作】
+ * 说明: 
+ *    - flash 的擦除和写入排队后即返回，由 Bootloader_Loop 逐步推进，擦写期间仍可处理主机数据。读取时只等待与读取范围重叠的擦写，
+ *      擦写未完成时各流程返回 FM_ERR_BUSY ，下次循环再次执行
+ *    - 移植文件的 async 接口提供 flash 的异步擦写时（ SFUD 的 SPI flash 、由中断或忙标志驱动的片内 flash ），每次只启动一个 sector 的擦除
+ *      或一页的编程；返回 NULL 的移植文件仍按阻塞方式每次执行一步。代码在同一 bank 中运行的片内 flash 擦写期间 CPU 取指会停顿，应返回 NULL
+ *    - ASYNC_FLASH_BUFF_SIZE 为排队中的写入数据的缓存，需为 1024 的整数倍，不小于 4096 ，一次写入最多占用其 1/4
+ *    - 启用 USING_APP_WRITE_CHECK_PROJECT 时，写入检查在数据写入完成后执行，比较写入前后数据的 CRC32
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_ASYNC_FLASH                  1
+    #if (ENABLE_ASYNC_FLASH)
+    #define ASYNC_FLASH_BUFF_SIZE           16384
+    #endif
+
+
+/**
+ * 【片内 flash 一次写入的最小字节数】
+ * 说明：
+ *    - 每个 MCU 内部 flash 单次可以写入的最小字节数有所不同，因此提供本选项用于配置，单位是 byte
+ *    - 该值的大小由内部 flash 的操作接口决定，默认是 4 byte ，不能随意配置，需要清楚本选项意味着什么
+ *    - 主机仿真可用 -m 切换为 STM32L4 等只能按双字编程的模型，因此取各模型中最大的 8 byte
+ */
+#define ONCHIP_FLASH_ONCE_WRITE_BYTE        8
+
+
+/**
+ * 【选择 bootloader 检测是否需要固件更新的方案】
+ * 说明：
+ *    本组件的机制是设备上电时首先运行 bootloader ，因此 bootloader 需要有一个获取是否需要进行固件更新的方法
+ * 解释：
+ *    USING_HOST_CMD_UPDATE:     通过主机指令控制进入固件更新模式，此方式会在上电后等待一段时间，以确认是否需要进行固件更新，
+ *                               等待时间通过 WAIT_HOST_DATA_MAX_TIME 进行配置
+ *    USING_APP_SET_FLAG_UPDATE: 通过在 APP 中设置标志位， bootloader 启动时会通过读取该标志位以判断是否需要进行固件更新
+ * 
+ * 选项：
+ *    USING_HOST_CMD_UPDATE      或 0
+ *    USING_APP_SET_FLAG_UPDATE  或 1
+ * 注意事项：
+ *    ！！！ Linux 主机仿真工程只能选择 USING_HOST_CMD_UPDATE ，固件更新标志变量的定址存放依赖 ARM 编译器！！！
+ */
+#define USING_IS_NEED_UPDATE_PROJECT        USING_HOST_CMD_UPDATE
+    #define WAIT_HOST_DATA_MAX_TIME         (10 * 1000)     /* 设置等待主机数据的最大等待时间，单位 ms
+                                                             * 超过这个时间没有收到主机的数据， bootloader 会尝试跳转至 APP
+                                                             * 若设为 0 ，则表示就算主机掉线，也不尝试跳转至 APP
+                                                             */
+
+
+/**
+ * 【选择是否支持 YModem-G 流式传输】
+ * 说明：
+ *    1. YModem-G 的数据帧由主机连续下发，设备不逐帧应答，省去每帧的应答往返和断帧检测的等待时间
+ *    2. 设备先以字符 'G' 握手，发送 YMODEM_G_HANDSHAKE_TIMES 次仍无响应，则改以字符 'C' 按 YModem 传输
+ *    3. YModem-G 没有重传机制，数据帧校验失败或写入 flash 失败时，设备发送 CAN 取消本次传输
+ *    4. 固件包头所在的数据帧会触发分区擦除，设备处理完该帧后回复 ACK ，主机需等待该 ACK 后再连续下发
+ * 注意事项：
+ *    1. YModem-G 没有流控， flash 的写入跟不上通信速率时，积压的数据帧会使接收缓存溢出。设备在第 0 帧按当前波特率、固件大小和
+ *       YMODEM_G_FRAME_WRITE_TIME 估算传输结束时积压的数据量，接收缓存（ YMODEM_G_BUFF_FRAME_NUM 个数据帧）放不下时，
+ *       第 0 帧回复 ACK ，改按 YModem 逐帧应答传输
+ *    2. YMODEM_G_FRAME_WRITE_TIME 按 flash 数据手册的最大编程和擦除时间估算，偏小会导致传输被取消，偏大只会更多地改按 YModem 传输
+ *    3. 未启用 ENABLE_BAUD_NEGOTIATION 时设备不知道当前波特率，只在接收缓存能放下整个固件包时按 YModem-G 传输
+ */
+#define ENABLE_YMODEM_G                     1
+    #if (ENABLE_YMODEM_G)
+    #define YMODEM_G_HANDSHAKE_TIMES        2               /* 以 'G' 握手的次数，每秒 1 次 */
+    #define YMODEM_G_BUFF_FRAME_NUM         8               /* 接收缓存可暂存的数据帧数量，每帧 1029 byte */
+    #define YMODEM_G_FRAME_WRITE_TIME       38000           /* 写入一个 1024 byte 数据帧的最长耗时，含分摊的擦除时间，单位 us ，按 stm32f1 模型 */
+    #endif
+
+
+/**
+ * 【选择是否启用 YModem 的帧解析器】
+ * 说明：
+ *    0: 禁用，YModem 以 UART 空闲中断和 BROKEN_FRAME_INTERVAL_TIME 的断帧检测分帧（ YModem-G 除外），每帧需多等待一个断帧间隔
+ *    1: 启用，接收中断将数据放入接收缓存后，由帧解析器按帧头确定帧长、逐段计算校验值，
+ *       最后一个校验字节到达时即取出一帧交由协议析构层处理，不再等待断帧检测，帧结构见 protocol_frame.h
+ * 注意事项：
+ *    1. 不是帧头的数据逐字节丢弃，数据帧头以正反序列号排除乱码，正反序列号错误的帧不应答 NAK ，由主机超时重发
+ *    2. 校验值在主循环中随接收逐段计算，不会延长接收中断的处理时间
+ */
+#define ENABLE_FRAME_PARSER                 1
+
+
+/**
+ * 【选择是否支持滑动窗口传输协议】
+ * 说明：
+ *    1. 与 YModem 并存的可选协议，主机以 PW_SOF 开头的 START 帧代替 YModem 的第 0 帧即进入该协议，帧结构和流程见 protocol_window.h
+ *    2. 主机可连续发送 WINDOW_PROTOCOL_FRAME_NUM 个未确认的数据帧，设备按序处理完每一帧后回复累积确认，
+ *       并附带已收到的乱序帧位图（选择确认），出错或缺帧时只需重发该帧
+ *    3. 设备未处理完的数据帧不会被确认，主机发送速度受窗口大小限制，不会像 YModem-G 一样因 flash 写入慢而溢出
+ * 注意事项：
+ *    WINDOW_PROTOCOL_FRAME_NUM 取值 1 ~ 32 ，占用的 RAM 约为 (2 * WINDOW_PROTOCOL_FRAME_NUM + 1) * 1 Kbyte ，
+ *    即接收缓存 (WINDOW_PROTOCOL_FRAME_NUM + 1) 帧和乱序缓存 WINDOW_PROTOCOL_FRAME_NUM 帧
+ */
+#define ENABLE_WINDOW_PROTOCOL              1
+    #if (ENABLE_WINDOW_PROTOCOL)
+    #define WINDOW_PROTOCOL_FRAME_NUM       8               /* 窗口大小，即未确认的数据帧最多的数量 */
+    #endif
+
+
+/**
+ * 【选择是否支持 YModem 的扩展数据帧】
+ * 说明：
+ *    1. 扩展数据帧的帧头为 YMODEM_STX_EXT ，数据长度为 YMODEM_EXT_DATA_LEN ，以 CRC32 校验，帧结构见 protocol_parser.h
+ *    2. 主机在第 0 帧的文件大小之后附加 "EXT=<数据长度>" 请求使用扩展数据帧，长度与 YMODEM_EXT_DATA_LEN 一致时，
+ *       设备在第 0 帧之后以字符 'E' 代替 'C' 或 'G' 握手，主机随后以扩展数据帧发送固件包体，否则仍按 1024 byte 的 STX 数据帧发送
+ *    3. YMODEM_EXT_DATA_LEN 与 FPK_LEAST_HANDLE_BYTE 一致时，一个数据帧即为一次 flash 写入的单位，应答次数降为原来的 1/4
+ * 注意事项：
+ *    YMODEM_EXT_DATA_LEN 须为 1024 的整数倍且能整除 FPK_LEAST_HANDLE_BYTE ，
+ *    接收缓存需增加约 YMODEM_EXT_DATA_LEN - 1024 byte 的 RAM
+ */
+#define ENABLE_YMODEM_EXT_FRAME             1
+    #if (ENABLE_YMODEM_EXT_FRAME)
+    #define YMODEM_EXT_DATA_LEN             4096            /* 扩展数据帧的数据长度，单位 byte */
+    #endif
+
+
+/**
+ * 【选择是否启用固件写入的后台队列】
+ * 说明：
+ *    0: 禁用，固件分包写入 flash 后才应答主机，主机发送下一帧与设备写入 flash 交替进行
+ *    1: 启用，固件分包通过校验并复制至队列的空闲块后即应答主机，在主循环中逐块写入 flash ，
+ *       主机发送后续数据帧与设备写入 flash 同时进行
+ * 注意事项：
+ *    1. 队列有 WRITE_BEHIND_BLOCK_NUM 个块，每块 FPK_LEAST_HANDLE_BYTE byte ，多个固件分包合并为一块写入，
+ *       需占用 WRITE_BEHIND_BLOCK_NUM * FPK_LEAST_HANDLE_BYTE byte 的 RAM
+ *    2. 队列已满时，等待最早的块写入完成后再应答
+ *    3. 后台写入失败时，在下一个数据帧或 EOT 的应答中取消传输
+ */
+#define ENABLE_WRITE_BEHIND                 1
+    #if (ENABLE_WRITE_BEHIND)
+    #define WRITE_BEHIND_BLOCK_NUM          2               /* 队列的块数，至少为 2 */
+    #endif
+
+
+/**
+ * 【选择是否启用波特率协商】
+ * 说明：
+ *    1. 主机收到握手字符后，可在第 0 帧之前发送波特率请求，按优先顺序列出想要使用的波特率，帧结构和流程见 protocol_parser.h
+ *    2. 设备选择其中第一个不超过 BAUD_NEGOTIATION_MAX_RATE 且 UART 时钟能够产生（误差不超过 2%）的波特率，
+ *       以原波特率应答后双方同时切换，再由主机发送探测帧、设备原样回送以确认线路可用
+ *    3. 探测帧或第 0 帧在 BAUD_NEGOTIATION_TIMEOUT 内未收到时，设备恢复原波特率并重新发送握手字符，
+ *       主机同样恢复原波特率，可改用更低的波特率再次请求
+ *    4. 每次开始接收固件时（ PP_CONFIG_RESET ）恢复为 UART 初始化时的波特率
+ * 注意事项：
+ *    切换波特率依赖 UART 移植文件的 BSP_UART_Port_CheckBaudRate 和 BSP_UART_Port_SetBaudRate ，
+ *    需确认 USB 转串口芯片和线缆支持所请求的波特率
+ */
+#define ENABLE_BAUD_NEGOTIATION             1
+    #if (ENABLE_BAUD_NEGOTIATION)
+    #define BAUD_NEGOTIATION_MAX_RATE       2000000         /* 允许切换的最高波特率 */
+    #define BAUD_NEGOTIATION_TIMEOUT        1000            /* 等待探测帧和第 0 帧的超时时间，单位 ms */
+    #endif
+
+
+/**
+ * 【CRC 的计算方式】
+ * 说明：
+ *    1. 数据帧的 CRC16 和固件包的 CRC32 均以 ROM 中的常量表查表计算，见 crc_engine.h
+ *    2. CRC_SLICE_NUM 为每次查表处理的字节数，越大越快，计算表占用的 ROM 越多：
+ *       1: 逐字节查表，计算表共 1.5 Kbyte
+ *       4: 按字读取，每次处理 4 byte ，计算表共 6 Kbyte
+ *       8: 每次处理 8 byte ，计算表共 12 Kbyte
+ *    3. ENABLE_CRC32_HARDWARE 为 1 时，CRC32 由 STM32 的 CRC 外设计算（需 Cortex-M3 及以上内核的 __RBIT 指令），
+ *       首尾不足一个字的部分仍查表计算， CRC16 不使用外设
+ * 注意事项：
+ *    bootloader 的空间紧张时，选择较小的 CRC_SLICE_NUM ，非 STM32 的芯片不能启用 ENABLE_CRC32_HARDWARE
+ */
+#define CRC_SLICE_NUM                       8
+#define ENABLE_CRC32_HARDWARE               0
+
+
+/**
+ * 【固件更新标志变量存放的内存地址】
+ * 说明: 
+ *    1. 若不需要使用固件更新标志变量，无视本宏即可
+ *    2. 固件标志位变量将作为 bootloader 和 APP 之间的沟通桥梁
+ * 注意事项: 
+ *    ！！！如果 USING_IS_NEED_UPDATE_PROJECT 设为 USING_APP_SET_FLAG_UPDATE ，必须确定本宏所指的内存地址是有效的！！！
+ */
+#define FIRMWARE_UPDATE_VAR_ADDR            0x20000000      /* 一定要和 APP 保持一致 */
+
+
+/**
+ * 【选择是否使用按键恢复出厂固件的选项】
+ * 说明: 
+ *    1. 使用本选项的前提是三分区方案，本选项能起效的前提是正确配置了按键且 factory 分区有可用的固件
+ *    2. 选择使用按键恢复出厂固件时，需要配置按键的引脚，如使用的按键和本案例不同，则需要自己配置和初始化 GPIO
+ *    3. 本选项仅在设备运行 bootloader 时，可通过按键恢复出厂固件，若设备运行着 APP ，则本选项是无法起效的，因此需要 APP 也同步配置
+ *    4. 本选项和通过指令恢复出厂固件的方式不冲突，可以同时使用，也可以不启用本选项
+ *    5. 当无 factory 或 factory 无可用固件时，强行恢复出厂固件，将会触发 FACTORY_NO_FIRMWARE_SOLUTION 选项
+ * 选项：
+ *    ENABLE_FACTORY_FIRMWARE_BUTTON 选项: 
+ *        0: 不启用长按按键恢复出厂固件
+ *        1: 启用
+ *    FACTORY_FIRMWARE_BUTTON_PRESS 选项: 
+ *        KEY_PRESS_LOW:  表示按键按下时 MCU 检测到的为低电平
+ *        KEY_PRESS_HIGH: 表示按键按下时 MCU 检测到的为高电平
+ *    FACTORY_FIRMWARE_BUTTON_TIME 选项: 
+ *        按键长按的持续时间，单位 ms ，不能大于 65535
+ */ 
+#if (USING_PART_PROJECT == TRIPLE_PART_PROJECT)
+#define ENABLE_FACTORY_FIRMWARE_BUTTON      0
+#define FACTORY_FIRMWARE_BUTTON_PRESS       KEY_PRESS_LOW
+#endif
+#define FACTORY_FIRMWARE_BUTTON_TIME        3000
+
+
+/**
+ * 【选择通过 bootloader 将固件包下载至 factory 分区时是否更新至 APP 的选项】
+ * 说明: 
+ *    通过 bootloader 将固件包下载至 factory 分区时是否自动更新至 APP ，若不启用，则 bootloader 会在固件包下载至 factory 
+ *    分区并校验成功后尝试跳转至 APP 分区，若 APP 分区无可用的固件或校验失败，将会根据 FACTORY_NO_FIRMWARE_SOLUTION 选项
+ *    执行对应的方案
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */ 
+#define ENABLE_FACTORY_UPDATE_TO_APP        0
+
+
+/**
+ * 【选择是否判断固件包超过分区大小的选项】
+ * 说明: 
+ *    当启用判断时，若有特殊处理，需自行修改代码，位于 bootloader.c 的 Bootloader_Loop 函数 的 EXE_FLOW_VERIFY_FIRMWARE_HEAD 流程。
+ *    否则，默认固件更新失败，按其它配置选项执行跳转至 APP 的操作
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */ 
+#define ENABLE_CHECK_FIRMWARE_SIZE          1
+
+
+/**
+ * 【选择自动更新固件的处理方案】
+ * 说明: 
+ *    1. 建议 VERSION_WRITE_TO_APP 选项，详情看下方说明
+ *    2. 在固件更新过程中设备异常断电或重启后，选择是否自动更新已下载好的固件以及自动更新的处理方案
+ *    3. 该选项的执行优先级低于上位机更新的方式，这意味着除非上位机超时未发送数据，否则将会优先执行上位机的固件更新
+ * 解释: 
+ *    
+ *    DO_NOT_AUTO_UPDATE:           不需要自动更新，不希望有这种断电恢复固件的机制
+ *    ERASE_DOWNLOAD_PART_PROJECT:  更新完成后擦除 download 分区。设备上电时会通过检测 download 分区有无可用固件
+ *                                  以此判断是否需要自动更新固件
+ *                                  * 选择此方案后，将无法选择是否在上电后对 APP 的固件进行安规校验( USING_APP_SAFETY_CHECK_PROJECT )。
+ *                                    因为 APP 固件安规校验的数据来源是 download 分区的固件包
+ *    MODIFY_DOWNLOAD_PART_PROJECT: 更新完成后修改 download 分区的固件表头的版本信息。设备上电时会对比 download 分区固件包头记录的新旧版本，
+ *                                  若新旧版本不一致，则开始自动更新固件
+ *                                  * 此种方式需要修改 download 分区的数据，有以下优劣势：
+ *                                    1. 优势：上电时可校验 APP 分区的固件数据正确性和完整性，以提高 APP 固件有损坏或遭篡改时的安全性，甚至
+ *                                             可以将固件恢复正常，有效提高系统的安全等级
+ *                                    2. 劣势：需要对表头所在的 flash sector 擦除后再重新写入，这意味着每次更新都会擦除同个 sector 两次。
+ *                                             倘若 flash 的最小擦除粒度比较大，该方式是无法实现的。如 STM32 的 F4 系列，其 sector0 是
+ *                                             16 Kbyte ，这意味着你至少要开辟一个 16 Kbyte 的空间来存放。相对于 VERSION_WRITE_TO_APP 
+ *                                             选项，开销实在过大，因此推荐选择 VERSION_WRITE_TO_APP                                   
+ *    VERSION_WRITE_TO_APP:         更新完成后将新的固件版本写进 APP 分区的尾部，占用 16 byte ，设备上电时会对比 download 分区固件包头
+ *                                  记录的版本和 APP 存放的版本，若两个版本不一致，则开始自动更新固件
+ *                                  * 此种方式有以下优劣势：
+ *                                    1. 优势：上电时可校验 APP 分区的固件数据正确性和完整性，以提高 APP 固件有损坏或遭篡改时的安全性，甚至
+ *                                             可以将固件恢复正常，有效提高系统的安全等级
+ *                                    2. 劣势：需要占用 APP 分区尾部 16 byte 的空间，因此 APP 固件不能写到这个区域
+ * 选项: 
+ *    DO_NOT_AUTO_UPDATE            或 0
+ *    ERASE_DOWNLOAD_PART_PROJECT   或 1
+ *    MODIFY_DOWNLOAD_PART_PROJECT  或 2
+ *    VERSION_WRITE_TO_APP          或 3
+ */
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+#define USING_AUTO_UPDATE_PROJECT           VERSION_WRITE_TO_APP
+#endif
+
+
+/**
+ * 【片内 Flash 放置固件包所在 sector 的擦除粒度】
+ * 说明: 
+ *    USING_AUTO_UPDATE_PROJECT = MODIFY_DOWNLOAD_PART_PROJECT 时，需要给出固件包所在 sector 的擦除粒度，单位是 byte
+ */
+#if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT)
+#define ONCHIP_FLASH_ERASE_GRANULARITY      FLASH_PAGE_SIZE
+#endif
+
+
+/**
+ * 【选择是否在上电后对 APP 的固件进行安规校验 及 APP 固件检查有问题时的操作方案】
+ * 说明: 
+ *    1. USING_AUTO_UPDATE_PROJECT 为 MODIFY_DOWNLOAD_PART_PROJECT 选项时，本配置才会起效
+ *    2. 部分产品对固件的完整性有安规等级要求，本组件支持 APP 固件的数据完整性检查，通过配置以选择是否启用
+ *    3. 当启用时，通过配置 USING_APP_SAFETY_PROJECT 可选择 APP 固件检查有问题时的操作方案
+ * 解释: 
+ *    DO_NOT_CHECK      : 不校验 APP 固件，即不启用
+ *    CHECK_UNLESS_EMPTY: 校验 APP 固件，但不具备校验条件时不校验，确保能运行 APP 而不至于等在 bootloader 中。若 APP 固件校验错误，
+ *                        将会自动把可用和正确的固件更新至 APP 
+ *                        * 不具备校验 APP 固件的条件是： download 分区和 factory 分区均无可用固件包
+ *    AUTO_UPDATE_APP   : APP 固件校验错误后自动将可用和正确的固件更新至 APP
+ *                        * 需要注意的是，当选择了本选项，意味着你十分重视 APP 的数据完整性，也就是说，当 APP 固件校验不通过或
+ *                          无法校验时，若 download 分区和 factory 分区均无可用固件包，则会停留在 bootloader 中，不会跳转至 APP ，
+ *                          即便 APP 存在固件
+ *                        * 需要特别声明的是，有一种情况会导致 APP 无法被执行，那便是通过烧录器将固件烧录进 MCU 的 flash 中，
+ *                          因为此时不是通过正常的固件更新程序执行， download 分区和 factory 分区均无可用固件包， APP 固件无法进行
+ *                          完整性校验，建议采用正常的固件更新流程，即由 bootloader 处理固件更新，或选择 CHECK_UNLESS_EMPTY 选项
+ *                        * 此处的自动更新和 USING_AUTO_UPDATE_PROJECT 不同，本选项仅在 APP 固件校验不通过时才会
+ *                          自动更新，而 USING_AUTO_UPDATE_PROJECT 则是无视本选项进行固件自动更新 
+ *    DO_NOT_DO_ANYTHING: APP 固件校验错误后不要做任何操作，停在 bootloader 即可，即便 download 分区或 factory 分区有可用的固件包
+ *                        * 需要注意的是， DO_NOT_DO_ANYTHING 这个选项并不能阻止 APP 分区为空时且 USING_AUTO_UPDATE_PROJECT 启用了
+ *                          自动更新的情况， DO_NOT_DO_ANYTHING 只能阻止 APP 分区不为空且校验不通过的情况，要阻止自动更新，需要修改
+ *                          上方的 USING_AUTO_UPDATE_PROJECT 为 DO_NOT_AUTO_UPDATE 选项
+ * 选项:  USING_APP_SAFETY_PROJECT
+ *    DO_NOT_CHECK          或 0
+ *    CHECK_UNLESS_EMPTY    或 1
+ *    AUTO_UPDATE_APP       或 2
+ *    DO_NOT_DO_ANYTHING    或 3
+ */
+#if (USING_PART_PROJECT > ONE_PART_PROJECT &&   \
+     (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT || USING_AUTO_UPDATE_PROJECT == VERSION_WRITE_TO_APP))
+#define USING_APP_SAFETY_CHECK_PROJECT      CHECK_UNLESS_EMPTY
+#endif
+
+
+/**
+ * 【选择是否可以使用 factory 分区的固件包】
+ * 说明: 
+ *    当启用自动更新或校验 APP 固件完整性时，若 APP 固件不可用，且 download 分区没有可用的固件时，倘若有 factory 分区，
+ *    且 factory 分区有可用的固件，是否将 factory 的固件更新至 APP 中
+ * 选项: 
+ *    0: 不使用
+ *    1: 使用
+ */
+#if (USING_PART_PROJECT == TRIPLE_PART_PROJECT && \
+     (USING_APP_SAFETY_CHECK_PROJECT == CHECK_UNLESS_EMPTY || USING_APP_SAFETY_CHECK_PROJECT == AUTO_UPDATE_APP))
+#define ENABLE_USE_FACTORY_FIRWARE          1
+#endif
+
+
+/**
+ * 【选择当需要恢复出厂固件时，若 factory 分区无固件或固件校验有问题时的解决方案】
+ * 解释：
+ *    JUMP_TO_APP:           尝试跳转至 APP
+ *    WAIT_FOR_NEW_FIRMWARE: 等待上位机发送新的固件包
+ * 选项：
+ *    JUMP_TO_APP            或 0
+ *    WAIT_FOR_NEW_FIRMWARE  或 1
+ */
+#if (USING_PART_PROJECT == TRIPLE_PART_PROJECT)
+#define FACTORY_NO_FIRMWARE_SOLUTION        JUMP_TO_APP          
+#endif
+
+
+/**
+ * 【选择是否自动纠正固件包中的分区名】
+ * 说明: 
+ *    1. 该选项是为了修正误操作而将分区名写错的情况，是一种能最大程度保证固件更新正常的挽救措施
+ *    2. 单分区方案下，无论本功能是否启用，固件包指定的其它分区名都会被修正为 APP 分区，使其可以正常更新
+ *    3. 多分区方案下，启用后，固件包指定为 APP 分区时将会被修正为 download 分区，使其可以正常更新
+ *    4. 多分区方案下，若不启用，固件包指定为 APP 分区时将会报错，并标记为更新失败
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+#define ENABLE_AUTO_CORRECT_PART             1
+#endif
+
+
+/**
+ * 【主机仿真使用 SPI Flash】
+ * 说明: 
+ *    1. 启用后 download 和 factory 分区放在仿真的 SPI NOR flash 内，经 FAL 和 SFUD 访问，用于评估外挂 flash 的更新耗时
+ *    2. 由 Makefile 的 SPI_FLASH=1 定义，也可在此直接修改
+ * 选项: 
+ *    0: 禁用
+ *    1: 启用
+ */
+#ifndef HOST_USING_SPI_FLASH
+#define HOST_USING_SPI_FLASH                0
+#endif
+
+
+/**
+ * 【选择分区的存放位置】
+ * 说明: 
+ *    1. 当选择启用 SPI Flash 存放固件时，需要指定 download 和 factory 分区的存放位置
+ *    2. 本工程使用了 FAL 库，用于管理 flash 的分区。（仅在启用 SPI Flash 时）
+ *    3. 更多 FAL 的内容，详见:  https://github.com/RT-Thread-packages/fal
+ *    4. 本工程同时还使用了 SFUD 库，因此可自动兼容不同厂家和不同容量的 SPI Flash 
+ *    5. SPI Flash 的底层接口移植文件是 sfud_port.c ，实现内部 API 即可
+ *    6. 若使用的 SPI Flash 不支持 SFDP ，则需要修改 sfdu_flash_def.h 文件
+ *    7. 修改、移植方式和更多内容，详见:  https://github.com/armink/SFUD
+ *    8. SFDP 是 JEDEC （固态技术协会）制定的串行 Flash 功能的参数表标准
+ * 解释: 
+ *    STORE_IN_ONCHIP_FLASH : 片内 Flash
+ *    STORE_IN_SPI_FLASH    : SPI Flash
+ * 注意事项: 
+ *    ！！！务必不能强制将 APP 分区设置在 SPI Flash 内。否则，固件将无法运行！！！
+ * 选项: 
+ *    STORE_IN_ONCHIP_FLASH 或 0
+ *    STORE_IN_SPI_FLASH    或 1
+ */
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+#if (HOST_USING_SPI_FLASH)
+#define DOWNLOAD_PART_LOCATION              STORE_IN_SPI_FLASH
+#else
+#define DOWNLOAD_PART_LOCATION              STORE_IN_ONCHIP_FLASH
+#endif
+#if (USING_PART_PROJECT == TRIPLE_PART_PROJECT)
+#if (HOST_USING_SPI_FLASH)
+#define FACTORY_PART_LOCATION               STORE_IN_SPI_FLASH
+#else
+#define FACTORY_PART_LOCATION               STORE_IN_ONCHIP_FLASH
+#endif
+#endif
+
+/* 不要修改 IS_ENABLE_SPI_FLASH 的值 */
+#if (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH || FACTORY_PART_LOCATION == STORE_IN_SPI_FLASH)
+#define IS_ENABLE_SPI_FLASH                 1
+#endif
+#endif  /* #if (USING_PART_PROJECT > ONE_PART_PROJECT) */
+
+
+/**
+ * 【SPI Flash 放置固件包所在 sector 的擦除粒度】
+ * 说明: 
+ *    1. 启用了 SPI Flash 时，需要给出固件包所在 sector 的擦除粒度，单位是 byte
+ *    2. 若 flash 支持 SFDP 且已经开启 SFUD_USING_SFDP ，则 SPI_FLASH_ERASE_GRANULARITY 不填或填错都无问题，
+ *       该值会被读到的 SFDP 更新 
+ */
+#if (IS_ENABLE_SPI_FLASH)
+#define SPI_FLASH_SIZE                      (16 * 1024 * 1024)
+#define SPI_FLASH_ERASE_GRANULARITY         4096
+#endif
+
+
+/**
+ * 【使用自定义的固件更新标志位】
+ * 说明: 
+ *    1. 若需要采用其他方式沟通 bootloader 和 APP （一般有外部的非易失性存储器，如 EEPROM ），删掉注释即可
+ *    2. 若开启，需要自己实现 Bootloader_GetUpdateFlag 和 Bootloader_SetUpdateFlag 函数，
+ *       这两个均是 weak 函数
+ */
+// #define USING_CUSTOM_UPDATE_FLAG
+
@@ -0,0 +1,405 @@
+/**
+ * \file            crc_bench.c
+ * \brief           correctness check and throughput of the CRC engine variants
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ */
+
+
+/**
+ * CRC 计算方式的校验和基准测试：
+ *    1. 以 CRC_SLICE_NUM = 8 、 ENABLE_CRC32_HARDWARE = 1 编译 crc_engine.c ，三种查表方式和 CRC 外设的路径均参与对比，
+ *       CRC 外设由软件模拟（按位计算、不反转、复位值 0xFFFFFFFF ，与 STM32 的 CRC 外设一致）
+ *    2. 以 crcLib.c 按位计算的 crc16_xmodem 和 crc32 为基准，对随机的起始地址（含非对齐）、长度和分段方式逐一比对，
+ *       任一结果不一致时返回 1 。 crcLib.c 的长度为 16 bit 且不能分段计算，测量时改用相同算法的 _Bitwise16 和 _Bitwise32
+ *    3. 对每个 -s 指定的数据长度，测量各方式的吞吐量。模拟的 CRC 外设比按位计算还慢，不参与测量
+ * 主机上的吞吐量只用于比较各方式的相对快慢， MCU 上的实际耗时可启用 ENABLE_PERF_STATS 查看 CRC32 一项。
+ *
+ * 例:
+ *    ./build/crc_bench
+ *    ./build/crc_bench -s 1K,4K,64K -n 100000 -f csv
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include "crcLib.h"
+
+/* 模拟的 CRC 外设，须在包含 crc_engine.c 之前定义 */
+static uint32_t     _HW_Write           (uint32_t dr, uint32_t word);
+static uint32_t     _RBit               (uint32_t value);
+static uint32_t     _hw_dr;
+
+#define CRC_SLICE_NUM                   8
+#define ENABLE_CRC32_HARDWARE           1
+#define CRC_HW_INIT()                   ((void)0)
+#define CRC_HW_RESET()                  (_hw_dr = 0xFFFFFFFF)
+#define CRC_HW_WRITE(word)              (_hw_dr = _HW_Write(_hw_dr, (word)))
+#define CRC_HW_READ()                   (_hw_dr)
+#define CRC_HW_RBIT(value)              _RBit(value)
+#include "crc_engine.c"
+
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_LIST_MAX                  8
+#define BENCH_BUFF_SIZE                 (64 * 1024 + 8)
+#define BENCH_CHECK_MAX_LEN             (8 * 1024)
+#define BENCH_MIN_TIME_NS               (200 * 1000 * 1000ULL)
+
+
+/* Private typedef -----------------------------------------------------------*/
+struct BENCH_VARIANT
+{
+    const char *name;
+    uint16_t  (*crc16)(uint16_t crc, const uint8_t *data, uint32_t len);
+    uint32_t  (*crc32)(uint32_t crc, const uint8_t *data, uint32_t len);
+};
+
+
+/* Private variables ---------------------------------------------------------*/
+static uint16_t     _Bitwise16          (uint16_t crc, const uint8_t *data, uint32_t len);
+static uint32_t     _Bitwise32          (uint32_t crc, const uint8_t *data, uint32_t len);
+
+static const struct BENCH_VARIANT _variant[] = 
+{
+    { "bitwise",    _Bitwise16,     _Bitwise32 },
+    { "slice1",     CRC16_Slice1,   CRC32_Slice1 },
+    { "slice4",     CRC16_Slice4,   CRC32_Slice4 },
+    { "slice8",     CRC16_Slice8,   CRC32_Slice8 },
+};
+
+static uint8_t _buff[BENCH_BUFF_SIZE];
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void         _Usage              (const char *name);
+static uint32_t     _ParseList          (const char *str, uint32_t *list, uint32_t max);
+static uint32_t     _Random             (void);
+static uint64_t     _NowNs              (void);
+static uint32_t     _Check              (uint32_t times);
+static double       _Measure            (const struct BENCH_VARIANT *variant, bool is_crc32, const uint8_t *data, uint32_t len);
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t size[BENCH_LIST_MAX] = { 1024, 64 * 1024 };
+    uint32_t size_num = 2;
+    uint32_t times    = 20000;
+    bool     is_csv   = false;
+    int      opt;
+
+    while ((opt = getopt(argc, argv, "s:n:f:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                size_num = _ParseList(optarg, size, BENCH_LIST_MAX);
+                break;
+            case 'n':
+                times = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                is_csv = (strcmp(optarg, "csv") == 0);
+                break;
+            default:
+                _Usage(argv[0]);
+                return (opt == 'h') ? 0 : 2;
+        }
+    }
+
+    for (uint32_t i = 0; i < size_num; i++)
+    {
+        if (size[i] == 0 || size[i] > BENCH_BUFF_SIZE - 8)
+        {
+            fprintf(stderr, "size %u out of range (1 ~ %u)\n", size[i], BENCH_BUFF_SIZE - 8);
+            return 2;
+        }
+    }
+
+    for (uint32_t i = 0; i < BENCH_BUFF_SIZE; i++)
+        _buff[i] = (uint8_t)_Random();
+
+    uint32_t fails = _Check(times);
+    fprintf(stderr, "check: %u cases, %u mismatches\n", times, fails);
+    if (fails)
+        return 1;
+
+    if (is_csv)
+        printf("crc,variant,size,mb_per_s\n");
+    else
+        printf("%-6s %-10s %10s %10s\n", "crc", "variant", "size", "MB/s");
+
+    for (uint32_t i = 0; i < size_num; i++)
+    {
+        for (uint32_t crc = 0; crc < 2; crc++)
+        {
+            for (uint32_t v = 0; v < sizeof(_variant) / sizeof(_variant[0]); v++)
+            {
+                /* 从 +1 的地址开始，包含非对齐的首尾 */
+                double speed = _Measure(&_variant[v], crc, &_buff[1], size[i]);
+
+                if (is_csv)
+                    printf("%s,%s,%u,%.1f\n", crc ? "crc32" : "crc16", _variant[v].name, size[i], speed);
+                else
+                    printf("%-6s %-10s %10u %10.1f\n", crc ? "crc32" : "crc16", _variant[v].name, size[i], speed);
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+static void _Usage(const char *name)
+{
+    fprintf(stderr, 
+            "usage: %s [options]\n"
+            "  -s SIZES        data lengths to measure, K suffix allowed (default: 1K,64K)\n"
+            "  -n TIMES        random cases to check against the bitwise CRC (default: 20000)\n"
+            "  -f text|csv     output format (default: text)\n",
+            name);
+}
+
+
+/**
+ * @brief  解析以逗号分隔的长度列表
+ * @note   
+ * @param[in]   str: 如 "1K,64K"
+ * @param[out]  list: 解析结果
+ * @param[in]   max: list 的容量
+ * @retval 解析出的数量
+ */
+static uint32_t _ParseList(const char *str, uint32_t *list, uint32_t max)
+{
+    uint32_t num = 0;
+    char *end;
+
+    while (*str && num < max)
+    {
+        uint32_t value = strtoul(str, &end, 0);
+
+        if (*end == 'K' || *end == 'k')
+        {
+            value *= 1024;
+            end++;
+        }
+        list[num++] = value;
+
+        str = (*end == ',') ? end + 1 : end;
+        if (end == str && *str != '\0')
+            break;
+    }
+
+    return num;
+}
+
+
+/**
+ * @brief  固定种子的伪随机数
+ * @note   
+ * @retval 随机数
+ */
+static uint32_t _Random(void)
+{
+    static uint32_t seed = 0x12345678;
+
+    seed = seed * 1103515245 + 12345;
+
+    return (seed >> 8);
+}
+
+
+static uint64_t _NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+/**
+ * @brief  以按位计算的结果为基准，校验各种计算方式
+ * @note   每个用例随机选择起始地址、长度和分段位置，对比一次计算和分两段逐步计算的结果，
+ *         CRC32_StepCalc 按 ENABLE_CRC32_HARDWARE 使用模拟的 CRC 外设
+ * @param[in]  times: 用例数
+ * @retval 不一致的用例数
+ */
+static uint32_t _Check(uint32_t times)
+{
+    uint32_t fails = 0;
+
+    for (uint32_t i = 0; i < times; i++)
+    {
+        uint32_t offset = _Random() % 8;
+        uint32_t len    = _Random() % (BENCH_CHECK_MAX_LEN + 1);
+        uint32_t split  = len ? _Random() % (len + 1) : 0;
+        const uint8_t *data = &_buff[offset];
+
+        uint16_t ref16 = crc16_xmodem((uint8_t *)data, len);
+        uint32_t ref32 = crc32((uint8_t *)data, len);
+        bool     is_ok = true;
+
+        for (uint32_t v = 0; v < sizeof(_variant) / sizeof(_variant[0]); v++)
+        {
+            uint16_t crc16 = _variant[v].crc16(_variant[v].crc16(0, data, split), &data[split], len - split);
+            uint32_t crc32 = _variant[v].crc32(_variant[v].crc32(CRC32_INIT_VALUE, data, split), &data[split], len - split);
+
+            if (crc16 != ref16 || (crc32 ^ 0xFFFFFFFF) != ref32)
+            {
+                fprintf(stderr, "mismatch: %s offset %u len %u split %u\n", _variant[v].name, offset, len, split);
+                is_ok = false;
+            }
+        }
+
+        if (CRC16_XModem(data, len) != ref16 || CRC32_Calc(data, len) != ref32
+        ||  (CRC32_StepCalc(CRC32_StepCalc(CRC32_INIT_VALUE, data, split), &data[split], len - split) ^ 0xFFFFFFFF) != ref32)
+        {
+            fprintf(stderr, "mismatch: hardware offset %u len %u split %u\n", offset, len, split);
+            is_ok = false;
+        }
+
+        if (is_ok == false)
+            fails++;
+    }
+
+    return fails;
+}
+
+
+/**
+ * @brief  测量一种计算方式的吞吐量
+ * @note   重复计算至累计耗时不少于 BENCH_MIN_TIME_NS
+ * @param[in]  variant: 计算方式
+ * @param[in]  is_crc32: true: CRC32 。 false: CRC16
+ * @param[in]  data: 数据源
+ * @param[in]  len: 数据大小 byte
+ * @retval 吞吐量，单位 MByte/s
+ */
+static double _Measure(const struct BENCH_VARIANT *variant, bool is_crc32, const uint8_t *data, uint32_t len)
+{
+    volatile uint32_t sink = 0;
+    uint64_t bytes = 0;
+    uint64_t start = _NowNs();
+    uint64_t elapsed;
+
+    do
+    {
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (is_crc32)
+                sink ^= variant->crc32(CRC32_INIT_VALUE, data, len);
+            else
+                sink ^= variant->crc16(0, data, len);
+        }
+        bytes  += 16ULL * len;
+        elapsed = _NowNs() - start;
+
+    } while (elapsed < BENCH_MIN_TIME_NS);
+
+    (void)sink;
+
+    return (double)bytes * 1e9 / (double)elapsed / (1024.0 * 1024.0);
+}
+
+
+/**
+ * @brief  按位计算 CRC16-XMODEM
+ * @note   与 crcLib.c 的 crc16_xmodem 相同，可分段计算
+ */
+static uint16_t _Bitwise16(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ CRC16_POLYNOMIAL : (crc << 1);
+    }
+
+    return crc;
+}
+
+
+/**
+ * @brief  按位计算 CRC32
+ * @note   与 crcLib.c 的 crc32 相同，返回未异或 0xFFFFFFFF 的中间值，可分段计算
+ */
+static uint32_t _Bitwise32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    while (len--)
+    {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : (crc >> 1);
+    }
+
+    return crc;
+}
+
+
+/**
+ * @brief  模拟 CRC 外设写入一个字
+ * @note   按位计算，高位在前，不反转，与 STM32 的 CRC 外设一致
+ * @param[in]  dr: 写入前的 DR
+ * @param[in]  word: 写入的字
+ * @retval 写入后的 DR
+ */
+static uint32_t _HW_Write(uint32_t dr, uint32_t word)
+{
+    dr ^= word;
+    for (uint8_t i = 0; i < 32; i++)
+        dr = (dr & 0x80000000) ? (dr << 1) ^ CRC32_POLYNOMIAL : (dr << 1);
+
+    return dr;
+}
+
+
+/**
+ * @brief  按位反转，对应 Cortex-M 的 __RBIT
+ */
+static uint32_t _RBit(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+
+    return result;
+}
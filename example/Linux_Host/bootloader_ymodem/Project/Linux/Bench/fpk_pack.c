@@ -0,0 +1,478 @@
+/**
+ * \file            fpk_pack.c
+ * \brief           fpk firmware package builder for the host benchmark
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 LZSS 压缩，与 bootloader 的 _Decompress_Write 对应
+ * v1.2     2026-10-18                  增加差分，与 bootloader 的 _Patch_Write 对应
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "aes.h"
+#include "fpk_pack.h"
+
+
+/* Private define ------------------------------------------------------------*/
+#define DIFF_HASH_BITS          16
+#define DIFF_CHAIN_MAX          32          /* 每个位置最多比较的候选数 */
+#define DIFF_EXTEND_STOP        64          /* 延伸时连续这么多 byte 没有改善即停止 */
+#define DIFF_SCORE_MIN          16          /* 匹配数减不匹配数不小于该值才使用 diff */
+
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t _crc32_table[256];
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void     _CRC32_Init     (void);
+static void     _PutU32         (uint8_t *p, uint32_t value);
+static uint32_t _Compress       (const uint8_t *raw, uint32_t raw_size, uint8_t window_bits, uint8_t lookahead_bits, uint8_t *out);
+static void     _PutBits        (uint8_t *out, uint32_t *bit_posit, uint32_t value, uint8_t bit_num);
+static uint32_t _Diff           (const uint8_t *base, uint32_t base_size, const uint8_t *raw, uint32_t raw_size, uint8_t *out);
+static uint32_t _DiffHash       (const uint8_t *p);
+static uint32_t _DiffExtend     (const uint8_t *base, uint32_t base_size, uint32_t b, 
+                                 const uint8_t *raw, uint32_t raw_size, uint32_t n, int32_t *score);
+static uint32_t _DiffRecord     (uint8_t *out, const uint8_t *base, const uint8_t *raw, uint32_t n, uint32_t b, 
+                                 uint32_t diff_len, uint32_t extra_len, int32_t seek);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  分段计算 CRC32
+ * @note   首段 crc 传入 0 ，结果可直接作为下一段的 crc 传入
+ * @param[in]  crc: 上一段的结果
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval CRC32 值
+ */
+uint32_t FPK_CRC32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    if (_crc32_table[1] == 0)
+        _CRC32_Init();
+
+    crc ^= 0xFFFFFFFF;
+    for (uint32_t i = 0; i < len; i++)
+        crc = _crc32_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+
+/**
+ * @brief  生成 fpk 固件包
+ * @note   返回的缓存由调用者 free
+ * @param[in]   cfg: 打包参数
+ * @param[in]   raw: 源固件
+ * @param[in]   raw_size: 源固件大小，单位 byte
+ * @param[out]  fpk_size: fpk 文件大小，单位 byte
+ * @retval fpk 文件的内容，失败时为 NULL
+ */
+uint8_t *FPK_Pack(const struct FPK_PACK_CONFIG *cfg, const uint8_t *raw, uint32_t raw_size, uint32_t *fpk_size)
+{
+    uint8_t *fpk, *head, *body;
+    uint8_t *comp = NULL;
+    uint8_t *patch = NULL;
+    uint32_t body_size = raw_size;
+    uint32_t pkg_size;
+    uint32_t raw_crc = FPK_CRC32(0, raw, raw_size);
+    struct AES_ctx aes_ctx;
+
+    if (cfg->head_size < FPK_PACK_HEAD_SIZE)
+        return NULL;
+
+    if (cfg->is_delta)
+    {
+        if (cfg->base == NULL)
+            return NULL;
+
+        /* 每条记录的 diff 至少 DIFF_SCORE_MIN byte ，另有补丁头和最后一条记录 */
+        patch = malloc(8 + raw_size + 12 * (raw_size / DIFF_SCORE_MIN + 2));
+        if (patch == NULL)
+            return NULL;
+        body_size = _Diff(cfg->base, cfg->base_size, raw, raw_size, patch);
+        raw = patch;
+    }
+
+    if (cfg->is_compress)
+    {
+        if (cfg->window_bits < 4 || cfg->window_bits > 15
+        ||  cfg->lookahead_bits < 1 || cfg->lookahead_bits >= cfg->window_bits)
+        {
+            free(patch);
+            return NULL;
+        }
+
+        /* 最坏情况下每个字节按 9 bit 的字面量输出 */
+        comp = malloc(body_size + body_size / 8 + 1);
+        if (comp == NULL)
+        {
+            free(patch);
+            return NULL;
+        }
+        body_size = _Compress(raw, body_size, cfg->window_bits, cfg->lookahead_bits, comp);
+        raw = comp;
+    }
+
+    pkg_size = body_size;
+    if (cfg->is_encrypt)
+        pkg_size = (body_size + AES_BLOCKLEN - 1) / AES_BLOCKLEN * AES_BLOCKLEN;
+
+    fpk = calloc(1, cfg->head_size + pkg_size);
+    if (fpk == NULL)
+    {
+        free(comp);
+        free(patch);
+        return NULL;
+    }
+
+    head = fpk;
+    body = fpk + cfg->head_size;
+    memcpy(body, raw, body_size);
+    free(comp);
+    free(patch);
+
+    if (cfg->is_encrypt)
+    {
+        AES_init_ctx_iv(&aes_ctx, cfg->key, cfg->iv);
+        AES_CBC_encrypt_buffer(&aes_ctx, body, pkg_size);
+    }
+
+    /* 表头，布局与 struct FPK_HEAD 一致 */
+    memcpy(&head[0], "fpk", 4);
+    head[5] = cfg->is_encrypt ? 0x01 : 0x00;
+    head[6] = (cfg->is_compress ? 0x01 : 0x00) | (cfg->is_delta ? 0x02 : 0x00);
+    head[7] = cfg->is_compress ? (cfg->window_bits << 4) | cfg->lookahead_bits : 0x00;
+    memcpy(&head[8],  cfg->old_ver, sizeof(cfg->old_ver));
+    memcpy(&head[24], cfg->new_ver, sizeof(cfg->new_ver));
+    if (cfg->user_string)
+        strncpy((char *)&head[40], cfg->user_string, FPK_PACK_NAME_SIZE);
+    strncpy((char *)&head[56], cfg->part_name, FPK_PACK_NAME_SIZE);
+    _PutU32(&head[72], raw_size);
+    _PutU32(&head[76], pkg_size);
+    _PutU32(&head[80], cfg->timestamp);
+    _PutU32(&head[84], raw_crc);
+    _PutU32(&head[88], FPK_CRC32(0, body, pkg_size));
+    _PutU32(&head[92], FPK_CRC32(0, head, FPK_PACK_HEAD_SIZE - 4));
+
+    *fpk_size = cfg->head_size + pkg_size;
+
+    return fpk;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  CRC32 计算表初始化
+ * @note   反射多项式 0xEDB88320 ，即 0x04C11DB7
+ * @retval None
+ */
+static void _CRC32_Init(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (uint8_t j = 0; j < 8; j++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : (crc >> 1);
+        _crc32_table[i] = crc;
+    }
+}
+
+
+/**
+ * @brief  按小端写入 32 位数据
+ * @note   
+ * @param[out] p: 目标地址
+ * @param[in]  value: 数据
+ * @retval None
+ */
+static void _PutU32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+
+/**
+ * @brief  LZSS 压缩
+ * @note   1. 位流与 heatshrink 相同，按 MSB 在前输出：
+ *            - 1 + 8 bit 字面量
+ *            - 0 + window_bits 的回溯距离（值 + 1） + lookahead_bits 的长度（值 + 1）
+ *         2. 贪心匹配，在窗口内逐个位置比较，回溯比字面量更短时才使用
+ *         3. 最后一个字节不足 8 bit 的部分补 0 ，解压出 raw_size 的数据后即停止，无须结束标志
+ * @param[in]   raw: 源数据
+ * @param[in]   raw_size: 源数据大小，单位 byte
+ * @param[in]   window_bits: 窗口的位数
+ * @param[in]   lookahead_bits: 回溯长度的位数
+ * @param[out]  out: 压缩数据，容量不小于 raw_size + raw_size / 8 + 1
+ * @retval 压缩数据的大小，单位 byte
+ */
+static uint32_t _Compress(const uint8_t *raw, uint32_t raw_size, uint8_t window_bits, uint8_t lookahead_bits, uint8_t *out)
+{
+    uint32_t bit_posit = 0;
+    uint32_t window    = 1 << window_bits;
+    uint32_t max_len   = 1 << lookahead_bits;
+    uint32_t ref_bits  = 1 + window_bits + lookahead_bits;
+
+    memset(out, 0, raw_size + raw_size / 8 + 1);
+
+    for (uint32_t i = 0; i < raw_size; )
+    {
+        uint32_t best_len  = 0;
+        uint32_t best_dist = 0;
+        uint32_t limit     = (raw_size - i < max_len) ? raw_size - i : max_len;
+
+        for (uint32_t dist = 1; dist <= window && dist <= i; dist++)
+        {
+            uint32_t len = 0;
+
+            /* 允许与当前位置重叠，与解压逐字节复制的行为一致 */
+            while (len < limit && raw[i - dist + len] == raw[i + len])
+                len++;
+
+            if (len > best_len)
+            {
+                best_len  = len;
+                best_dist = dist;
+                if (len == limit)
+                    break;
+            }
+        }
+
+        if (best_len * 9 > ref_bits)
+        {
+            _PutBits(out, &bit_posit, 0, 1);
+            _PutBits(out, &bit_posit, best_dist - 1, window_bits);
+            _PutBits(out, &bit_posit, best_len - 1, lookahead_bits);
+            i += best_len;
+        }
+        else
+        {
+            _PutBits(out, &bit_posit, 1, 1);
+            _PutBits(out, &bit_posit, raw[i], 8);
+            i++;
+        }
+    }
+
+    return (bit_posit + 7) / 8;
+}
+
+
+/**
+ * @brief  按 MSB 在前写入若干位
+ * @note   out 需预先清零
+ * @param[out]    out: 输出缓存
+ * @param[in,out]  bit_posit: 已写入的位数
+ * @param[in]     value: 数据
+ * @param[in]     bit_num: 位数
+ * @retval None
+ */
+static void _PutBits(uint8_t *out, uint32_t *bit_posit, uint32_t value, uint8_t bit_num)
+{
+    while (bit_num--)
+    {
+        if ((value >> bit_num) & 1)
+            out[*bit_posit / 8] |= 0x80 >> (*bit_posit % 8);
+        (*bit_posit)++;
+    }
+}
+
+
+/**
+ * @brief  生成补丁
+ * @note   1. 格式与 bsdiff 相同，见 bootloader 的 struct PATCH_DECODER ，多字节数据均为小端
+ *         2. 以 4 byte 的哈希链在 base 中查找候选位置，优先尝试与上一段匹配相同的偏移，
+ *            向后延伸时允许少量不同的字节，匹配数减不匹配数最大处即为匹配的长度
+ *         3. 匹配的部分按 diff 输出，大部分为 0 ，需再压缩才能减小固件包
+ * @param[in]   base: 基础固件
+ * @param[in]   base_size: 基础固件大小，单位 byte
+ * @param[in]   raw: 新的源固件
+ * @param[in]   raw_size: 新的源固件大小，单位 byte
+ * @param[out]  out: 补丁，容量不小于 8 + raw_size + 12 * (raw_size / DIFF_SCORE_MIN + 2)
+ * @retval 补丁的大小，单位 byte
+ */
+static uint32_t _Diff(const uint8_t *base, uint32_t base_size, const uint8_t *raw, uint32_t raw_size, uint8_t *out)
+{
+    int32_t  *hash_head = malloc(sizeof(int32_t) << DIFF_HASH_BITS);
+    int32_t  *hash_prev = malloc(sizeof(int32_t) * (base_size + 1));
+    uint32_t out_size = 8;
+    uint32_t pend_n = 0, pend_b = 0, pend_len = 0;      /* 尚未输出的匹配 */
+    uint32_t n = 0;
+
+    _PutU32(&out[0], base_size);
+    _PutU32(&out[4], FPK_CRC32(0, base, base_size));
+
+    memset(hash_head, 0xFF, sizeof(int32_t) << DIFF_HASH_BITS);
+    for (uint32_t b = 0; b + 4 <= base_size; b++)
+    {
+        uint32_t h = _DiffHash(&base[b]);
+        hash_prev[b] = hash_head[h];
+        hash_head[h] = b;
+    }
+
+    while (n < raw_size)
+    {
+        int32_t  best_score = 0, score;
+        uint32_t best_b = 0, best_len = 0, len;
+        uint32_t same_b = pend_b + (n - pend_n);
+        int32_t  cand = -1;
+
+        /* 与上一段匹配相同的偏移，源固件中插入或修改少量数据时最常见 */
+        if (same_b < base_size)
+        {
+            len = _DiffExtend(base, base_size, same_b, raw, raw_size, n, &score);
+            if (score > best_score)
+            {
+                best_score = score;
+                best_b     = same_b;
+                best_len   = len;
+            }
+        }
+
+        if (n + 4 <= raw_size)
+            cand = hash_head[_DiffHash(&raw[n])];
+
+        for (uint32_t i = 0; cand >= 0 && i < DIFF_CHAIN_MAX; i++, cand = hash_prev[cand])
+        {
+            if ((uint32_t)cand == same_b || memcmp(&base[cand], &raw[n], 4))
+                continue;
+
+            len = _DiffExtend(base, base_size, cand, raw, raw_size, n, &score);
+            if (score > best_score)
+            {
+                best_score = score;
+                best_b     = cand;
+                best_len   = len;
+            }
+        }
+
+        if (best_score < DIFF_SCORE_MIN)
+        {
+            n++;
+            continue;
+        }
+
+        /* 输出上一段匹配，其后至本次匹配之间的数据为 extra */
+        out_size += _DiffRecord(&out[out_size], base, raw, pend_n, pend_b, pend_len, 
+                                n - (pend_n + pend_len), (int32_t)(best_b - (pend_b + pend_len)));
+        pend_n   = n;
+        pend_b   = best_b;
+        pend_len = best_len;
+        n       += best_len;
+    }
+
+    out_size += _DiffRecord(&out[out_size], base, raw, pend_n, pend_b, pend_len, raw_size - (pend_n + pend_len), 0);
+
+    free(hash_head);
+    free(hash_prev);
+
+    return out_size;
+}
+
+
+/**
+ * @brief  4 byte 数据的哈希值
+ * @note   
+ * @param[in]  p: 数据
+ * @retval 哈希值，共 DIFF_HASH_BITS 位
+ */
+static uint32_t _DiffHash(const uint8_t *p)
+{
+    uint32_t key = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+
+    return (key * 2654435761U) >> (32 - DIFF_HASH_BITS);
+}
+
+
+/**
+ * @brief  从 base 和 raw 的某个位置向后延伸匹配
+ * @note   相同的字节加 1 分，不同的减 1 分，连续 DIFF_EXTEND_STOP byte 没有更高的分数即停止
+ * @param[in]   base: 基础固件
+ * @param[in]   base_size: 基础固件大小，单位 byte
+ * @param[in]   b: base 的位置
+ * @param[in]   raw: 新的源固件
+ * @param[in]   raw_size: 新的源固件大小，单位 byte
+ * @param[in]   n: raw 的位置
+ * @param[out]  score: 最高的分数
+ * @retval 取得最高分数时的长度，单位 byte
+ */
+static uint32_t _DiffExtend(const uint8_t *base, uint32_t base_size, uint32_t b, 
+                            const uint8_t *raw, uint32_t raw_size, uint32_t n, int32_t *score)
+{
+    int32_t  cur = 0, best = 0;
+    uint32_t best_len = 0;
+
+    for (uint32_t i = 0; b + i < base_size && n + i < raw_size; i++)
+    {
+        cur += (base[b + i] == raw[n + i]) ? 1 : -1;
+        if (cur > best)
+        {
+            best     = cur;
+            best_len = i + 1;
+        }
+        else if (i + 1 - best_len >= DIFF_EXTEND_STOP)
+            break;
+    }
+
+    *score = best;
+    return best_len;
+}
+
+
+/**
+ * @brief  输出一条补丁记录
+ * @note   
+ * @param[out]  out: 输出的位置
+ * @param[in]   base: 基础固件
+ * @param[in]   raw: 新的源固件
+ * @param[in]   n: diff 在 raw 中的起始位置， extra 紧随其后
+ * @param[in]   b: diff 在 base 中的起始位置
+ * @param[in]   diff_len: diff 的长度，单位 byte
+ * @param[in]   extra_len: extra 的长度，单位 byte
+ * @param[in]   seek: 之后 base 读取位置的偏移
+ * @retval 记录的大小，单位 byte
+ */
+static uint32_t _DiffRecord(uint8_t *out, const uint8_t *base, const uint8_t *raw, uint32_t n, uint32_t b, 
+                            uint32_t diff_len, uint32_t extra_len, int32_t seek)
+{
+    _PutU32(&out[0], diff_len);
+    _PutU32(&out[4], extra_len);
+    _PutU32(&out[8], (uint32_t)seek);
+
+    for (uint32_t i = 0; i < diff_len; i++)
+        out[12 + i] = raw[n + i] - base[b + i];
+    memcpy(&out[12 + diff_len], &raw[n + diff_len], extra_len);
+
+    return 12 + diff_len + extra_len;
+}
@@ -0,0 +1,81 @@
+/**
+ * \file            fpk_pack.h
+ * \brief           fpk firmware package builder for the host benchmark
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 LZSS 压缩选项
+ * v1.2     2026-10-18                  增加差分选项
+ */
+
+#ifndef __FPK_PACK_H__
+#define __FPK_PACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * 按 bootloader 的 struct FPK_HEAD 生成 fpk 固件包，供基准测试使用：
+ *    1. 表头 96 byte ，补 0 至 head_size 后紧跟包体，与上位机打包工具选择 1024 byte 表头时一致
+ *    2. 加密为 AES-256-CBC ，包体补 0 至 16 byte 的整数倍
+ *    3. CRC32 与 bootloader 相同（多项式 0x04C11DB7 ，反射，初值和结果异或 0xFFFFFFFF ）
+ *    4. 压缩为 LZSS （与 heatshrink 的位流相同），先压缩后加密， config[2] 为 0x01 ， config[3] 高 4 位为
+ *       窗口位数、低 4 位为长度位数， raw_size 和 raw_crc 仍为源固件的值
+ *    5. 差分的补丁格式与 bootloader 的 _Patch_Write 对应，先差分再压缩、加密， config[2] 的 bit1 置 1
+ *    6. config[2] 的 bit0 表示压缩、 bit1 表示差分，可同时置 1
+ */
+
+#define FPK_PACK_HEAD_SIZE          96
+#define FPK_PACK_VERSION_SIZE       16
+#define FPK_PACK_NAME_SIZE          16
+
+struct FPK_PACK_CONFIG
+{
+    bool            is_encrypt;                     /* 是否加密包体 */
+    bool            is_compress;                    /* 是否压缩包体 */
+    uint8_t         window_bits;                    /* 压缩窗口的位数，不能大于 bootloader 的 DECOMPRESS_WINDOW_BITS */
+    uint8_t         lookahead_bits;                 /* 回溯长度的位数，小于 window_bits */
+    bool            is_delta;                       /* 是否生成相对 base 的差分固件包 */
+    const uint8_t  *base;                           /* 基础固件，即设备 APP 分区中正在运行的固件 */
+    uint32_t        base_size;                      /* 基础固件的大小，单位 byte */
+    const uint8_t  *key;                            /* AES256 key ， 32 byte */
+    const uint8_t  *iv;                             /* AES256 iv ， 16 byte */
+    uint8_t         old_ver[4];                     /* 旧版本，如 {1, 0, 0, 0} 即 V1.0.0.0 */
+    uint8_t         new_ver[4];                     /* 新版本 */
+    const char     *user_string;                    /* 用户自定义的字符水印，最多 16 byte */
+    const char     *part_name;                      /* 固件包存放的分区名 */
+    uint32_t        timestamp;                      /* 打包时的 unix 时间戳 */
+    uint16_t        head_size;                      /* 表头在文件中占用的大小，单位 byte ，不小于 96 */
+};
+
+uint32_t    FPK_CRC32       (uint32_t crc, const uint8_t *data, uint32_t len);
+uint8_t *   FPK_Pack        (const struct FPK_PACK_CONFIG *cfg, const uint8_t *raw, uint32_t raw_size, uint32_t *fpk_size);
+
+#endif
@@ -0,0 +1,524 @@
+/**
+ * \file            frame_fuzz.c
+ * \brief           randomly fragmented stream test of the incremental frame parser
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ */
+
+
+/**
+ * 帧解析器的随机分片测试：
+ *    1. 随机生成 SOH 、 STX 、扩展数据帧、 EOT 、连续的 CAN 、波特率请求和探测帧组成的字节流，
+ *       其间夹杂不含帧头字节的乱码、正反序列号不符的假帧头、 num 无效的波特率请求和出错的探测帧，部分数据帧的校验值被改错
+ *    2. 每个字节流按随机的分片长度（ 1 byte 至数个整帧）逐片放入接收缓存，每放入一片即按 PP_StreamHandler 的方式调用 PF_Parse ，
+ *       取出的帧与生成的帧逐一比对位置、长度和校验结果，乱码须逐字节丢弃，完整的帧须在最后一个字节放入的当次取出
+ *    3. 连续的 CAN 可能被分片拆成多帧，只要求其总长一致
+ *    任一结果不一致时输出首个错误并返回 1 。扩展数据帧和协商阶段的帧按 bootloader_config.h 的配置参与测试。
+ *
+ * 例:
+ *    ./build/frame_fuzz
+ *    ./build/frame_fuzz -n 20000 -m 16 -r 1
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "protocol_frame.h"
+
+#if (ENABLE_FRAME_PARSER)
+
+/* Private define ------------------------------------------------------------*/
+#define FUZZ_ITEM_MAX_LEN               (YMODEM_FRAME_MAX_LEN + 16)
+#define FUZZ_FRAME_MAX_NUM              256
+
+
+/* Private typedef -----------------------------------------------------------*/
+struct FUZZ_FRAME
+{
+    uint32_t    offset;             /* 在字节流中的位置 */
+    uint16_t    len;                /* 帧长 */
+    uint8_t     header;             /* 帧头 */
+    bool        is_crc_ok;          /* 校验值是否正确 */
+};
+
+struct FUZZ_STREAM
+{
+    uint8_t            *data;
+    uint32_t            len;
+    struct FUZZ_FRAME   frame[FUZZ_FRAME_MAX_NUM];
+    uint32_t            frame_num;
+    uint32_t            garbage;    /* 乱码的字节数 */
+};
+
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t     _seed = 0x12345678;
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void         _Usage              (const char *name);
+static uint32_t     _Random             (void);
+static uint8_t      _RandomGarbage      (void);
+static void         _Build              (struct FUZZ_STREAM *stream, uint32_t frame_num);
+static void         _AddFrame           (struct FUZZ_STREAM *stream, uint8_t header, bool is_crc_ok);
+static void         _AddGarbage         (struct FUZZ_STREAM *stream);
+static bool         _Feed               (const struct FUZZ_STREAM *stream, uint32_t max_chunk);
+
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t chunk[] = { 1, 3, 17, 64, 512, 1029, YMODEM_FRAME_MAX_LEN * 3 };
+    struct FUZZ_STREAM stream;
+    uint32_t streams   = 2000;
+    uint32_t frame_num = 32;
+    uint64_t bytes     = 0;
+    uint64_t frames    = 0;
+    uint64_t garbage   = 0;
+    int      opt;
+
+    while ((opt = getopt(argc, argv, "n:m:r:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                streams = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                frame_num = strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                _seed = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                _Usage(argv[0]);
+                return (opt == 'h') ? 0 : 2;
+        }
+    }
+
+    if (frame_num == 0 || frame_num > FUZZ_FRAME_MAX_NUM / 2)
+    {
+        fprintf(stderr, "frames per stream out of range (1 ~ %u)\n", FUZZ_FRAME_MAX_NUM / 2);
+        return 2;
+    }
+
+    /* 每个帧之前最多一段乱码 */
+    stream.data = malloc((size_t)frame_num * 2 * FUZZ_ITEM_MAX_LEN);
+    if (stream.data == NULL)
+        return 2;
+
+    for (uint32_t i = 0; i < streams; i++)
+    {
+        _Build(&stream, frame_num);
+
+        /* 同一字节流以不同的分片方式各解析一次，结果须一致 */
+        for (uint32_t c = 0; c < sizeof(chunk) / sizeof(chunk[0]); c++)
+        {
+            if (_Feed(&stream, chunk[c]) == false)
+            {
+                fprintf(stderr, "stream %u (seed 0x%08X), max chunk %u: failed\n", i, _seed, chunk[c]);
+                free(stream.data);
+                return 1;
+            }
+            bytes += stream.len;
+        }
+        frames  += stream.frame_num;
+        garbage += stream.garbage;
+    }
+
+    printf("streams: %u, frames: %llu, garbage: %llu bytes, parsed: %llu bytes, no mismatch\n",
+           streams, (unsigned long long)frames, (unsigned long long)garbage, (unsigned long long)bytes);
+
+    free(stream.data);
+    return 0;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+static void _Usage(const char *name)
+{
+    fprintf(stderr, 
+            "usage: %s [options]\n"
+            "  -n STREAMS      random byte streams to generate (default: 2000)\n"
+            "  -m FRAMES       frames per stream (default: 32)\n"
+            "  -r SEED         random seed (default: 0x12345678)\n",
+            name);
+}
+
+
+/**
+ * @brief  伪随机数
+ * @note   种子可由 -r 指定，出错时输出当前种子
+ * @retval 随机数
+ */
+static uint32_t _Random(void)
+{
+    _seed = _seed * 1103515245 + 12345;
+
+    return (_seed >> 8);
+}
+
+
+/**
+ * @brief  不是任何帧头的随机字节
+ * @note   乱码中不含帧头，其解析结果才是确定的
+ * @retval 随机字节
+ */
+static uint8_t _RandomGarbage(void)
+{
+    for (;;)
+    {
+        uint8_t value = (uint8_t)_Random();
+
+        switch (value)
+        {
+            case YMODEM_SOH:
+            case YMODEM_STX:
+            case YMODEM_STX_EXT:
+            case YMODEM_EOT:
+            case YMODEM_CAN:
+            case YMODEM_BAUD:
+            case YMODEM_PROBE:
+                continue;
+            default:
+                return value;
+        }
+    }
+}
+
+
+/**
+ * @brief  生成一个随机的字节流
+ * @note   以一个帧结尾，不会遗留未解析完的乱码
+ * @param[out] stream: 字节流和其中的帧
+ * @param[in]  frame_num: 帧的数量
+ * @retval None
+ */
+static void _Build(struct FUZZ_STREAM *stream, uint32_t frame_num)
+{
+    static const uint8_t header[] = 
+    {
+        YMODEM_SOH, YMODEM_STX, YMODEM_EOT, YMODEM_CAN,
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        YMODEM_STX_EXT,
+    #endif
+    #if (ENABLE_BAUD_NEGOTIATION)
+        YMODEM_BAUD, YMODEM_PROBE,
+    #endif
+    };
+
+    stream->len       = 0;
+    stream->frame_num = 0;
+    stream->garbage   = 0;
+
+    while (stream->frame_num < frame_num)
+    {
+        uint8_t h = header[_Random() % sizeof(header)];
+
+        if (_Random() % 4 == 0)
+            _AddGarbage(stream);
+
+        /* 相邻的 CAN 会合并为一帧 */
+        if (h == YMODEM_CAN && stream->frame_num
+        &&  stream->frame[stream->frame_num - 1].offset + stream->frame[stream->frame_num - 1].len == stream->len
+        &&  stream->frame[stream->frame_num - 1].header == YMODEM_CAN)
+            h = YMODEM_EOT;
+
+        _AddFrame(stream, h, (_Random() % 8) != 0);
+    }
+}
+
+
+/**
+ * @brief  在字节流末尾添加一个帧
+ * @note   
+ * @param[out] stream: 字节流
+ * @param[in]  header: 帧头
+ * @param[in]  is_crc_ok: 校验值是否正确，为 false 时改错帧中的一个字节（探测帧除外）
+ * @retval None
+ */
+static void _AddFrame(struct FUZZ_STREAM *stream, uint8_t header, bool is_crc_ok)
+{
+    uint8_t  *p = &stream->data[stream->len];
+    uint16_t  len;
+    uint16_t  crc_start = 3;
+    uint16_t  crc_end;
+
+    p[0] = header;
+    switch (header)
+    {
+        case YMODEM_EOT: len = 1;  crc_end = 0;  break;
+        case YMODEM_CAN:
+        {
+            len = 1 + _Random() % 3;
+            memset(p, YMODEM_CAN, len);
+            crc_end = 0;
+            break;
+        }
+    #if (ENABLE_BAUD_NEGOTIATION)
+        case YMODEM_PROBE:
+        {
+            static const uint8_t probe[YMODEM_PROBE_LEN] = YMODEM_PROBE_FRAME;
+
+            memcpy(p, probe, YMODEM_PROBE_LEN);
+            len     = YMODEM_PROBE_LEN;
+            crc_end = 0;
+            break;
+        }
+        case YMODEM_BAUD:
+        {
+            uint8_t num = 1 + _Random() % YMODEM_BAUD_MAX_NUM;
+
+            p[1] = num;
+            for (uint16_t i = 0; i < 4 * num; i++)
+                p[2 + i] = (uint8_t)_Random();
+            len       = YMODEM_BAUD_REQ_LEN(num);
+            crc_start = 1;
+            crc_end   = 2 + 4 * num;
+            break;
+        }
+    #endif
+        default:
+        {
+            uint16_t data_len = (header == YMODEM_SOH) ? YMODEM_SOH_DATA_LEN : YMODEM_STX_DATA_LEN;
+
+        #if (ENABLE_YMODEM_EXT_FRAME)
+            if (header == YMODEM_STX_EXT)
+                data_len = YMODEM_EXT_DATA_LEN;
+        #endif
+            p[1] = (uint8_t)_Random();
+            p[2] = ~p[1];
+            for (uint16_t i = 0; i < data_len; i++)
+                p[3 + i] = (uint8_t)_Random();
+            crc_end = 3 + data_len;
+            len     = crc_end + 2;
+            break;
+        }
+    }
+
+    if (crc_end)
+    {
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        if (header == YMODEM_STX_EXT)
+        {
+            uint32_t crc = CRC32_Calc(&p[crc_start], crc_end - crc_start);
+
+            p[crc_end]     = (uint8_t)(crc >> 24);
+            p[crc_end + 1] = (uint8_t)(crc >> 16);
+            p[crc_end + 2] = (uint8_t)(crc >> 8);
+            p[crc_end + 3] = (uint8_t)(crc);
+            len = crc_end + 4;
+        }
+        else
+    #endif
+        {
+            uint16_t crc = CRC16_XModem(&p[crc_start], crc_end - crc_start);
+
+            p[crc_end]     = (uint8_t)(crc >> 8);
+            p[crc_end + 1] = (uint8_t)(crc);
+        }
+
+        /* 改错数据或校验值中的一个字节，不改动决定帧长的字段 */
+        if (is_crc_ok == false)
+        {
+            uint16_t pos = crc_start + 1 + _Random() % (len - crc_start - 1);
+            p[pos] ^= (uint8_t)(1 + _Random() % 255);
+        }
+    }
+    else
+        is_crc_ok = true;
+
+    stream->frame[stream->frame_num].offset    = stream->len;
+    stream->frame[stream->frame_num].len       = len;
+    stream->frame[stream->frame_num].header    = header;
+    stream->frame[stream->frame_num].is_crc_ok = is_crc_ok;
+    stream->frame_num++;
+    stream->len += len;
+}
+
+
+/**
+ * @brief  在字节流末尾添加一段乱码
+ * @note   随机选择纯乱码、正反序列号不符的假帧头、 num 无效的波特率请求、出错的探测帧，都应被逐字节丢弃
+ * @param[out] stream: 字节流
+ * @retval None
+ */
+static void _AddGarbage(struct FUZZ_STREAM *stream)
+{
+    uint8_t  *p   = &stream->data[stream->len];
+    uint16_t  len = 0;
+
+    switch (_Random() % 4)
+    {
+        case 0:
+        {
+            /* 正反序列号不符的假帧头 */
+            p[len++] = (_Random() & 1) ? YMODEM_SOH : YMODEM_STX;
+            p[len]   = _RandomGarbage();
+            do { p[len + 1] = _RandomGarbage(); } while (p[len + 1] == (uint8_t)~p[len]);
+            len += 2;
+            break;
+        }
+    #if (ENABLE_BAUD_NEGOTIATION)
+        case 1:
+        {
+            /* num 为 0 或超出 YMODEM_BAUD_MAX_NUM 的波特率请求 */
+            p[len++] = YMODEM_BAUD;
+            do { p[len] = _RandomGarbage(); } while (p[len] >= 1 && p[len] <= YMODEM_BAUD_MAX_NUM);
+            len++;
+            break;
+        }
+        case 2:
+        {
+            /* 中途出错的探测帧，探测帧的内容不含帧头 */
+            static const uint8_t probe[YMODEM_PROBE_LEN] = YMODEM_PROBE_FRAME;
+            uint16_t err = 1 + _Random() % (YMODEM_PROBE_LEN - 1);
+
+            memcpy(p, probe, err);
+            len = err;
+            do { p[len] = _RandomGarbage(); } while (p[len] == probe[err]);
+            len++;
+            break;
+        }
+    #endif
+        default: break;
+    }
+
+    for (uint32_t n = _Random() % 16; n; n--)
+        p[len++] = _RandomGarbage();
+
+    stream->len     += len;
+    stream->garbage += len;
+}
+
+
+/**
+ * @brief  按随机分片将字节流放入接收缓存并解析
+ * @note   移除帧和乱码的方式与 PP_StreamHandler 相同
+ * @param[in]  stream: 字节流
+ * @param[in]  max_chunk: 分片的最大长度
+ * @retval true: 与生成的帧一致 | false: 不一致
+ */
+static bool _Feed(const struct FUZZ_STREAM *stream, uint32_t max_chunk)
+{
+    static uint8_t    rx_buff[PP_MSG_BUFF_SIZE + FUZZ_ITEM_MAX_LEN * 4];
+    struct PF_PARSER  pf;
+    uint32_t          rx_len   = 0;
+    uint32_t          fed      = 0;         /* 已放入接收缓存的长度 */
+    uint32_t          consumed = 0;         /* 接收缓存头部在字节流中的位置 */
+    uint32_t          index    = 0;         /* 期望的下一帧 */
+    uint16_t          can_left = 0;         /* 连续的 CAN 被拆开后剩余的长度 */
+
+    PF_Init(&pf, PF_ACCEPT_YMODEM | PF_ACCEPT_EXT | PF_ACCEPT_BAUD | PF_ACCEPT_PROBE);
+
+    while (fed < stream->len)
+    {
+        uint32_t chunk = 1 + _Random() % max_chunk;
+
+        if (chunk > stream->len - fed)
+            chunk = stream->len - fed;
+        if (rx_len + chunk > sizeof(rx_buff))
+            chunk = sizeof(rx_buff) - rx_len;
+        memcpy(&rx_buff[rx_len], &stream->data[fed], chunk);
+        rx_len += chunk;
+        fed    += chunk;
+
+        for (;;)
+        {
+            const struct FUZZ_FRAME *frame = (index < stream->frame_num) ? &stream->frame[index] : NULL;
+            uint16_t   out_len = 0;
+            PF_RESULT  result  = PF_Parse(&pf, rx_buff, rx_len, &out_len);
+
+            if (result == PF_RESULT_NONE)
+            {
+                /* 帧已完整却未取出 */
+                if (frame && consumed == frame->offset && frame->offset + frame->len <= fed)
+                {
+                    fprintf(stderr, "frame %u (%.2X, %u bytes at %u) complete but not parsed\n", 
+                            index, frame->header, frame->len, frame->offset);
+                    return false;
+                }
+                break;
+            }
+
+            if (result == PF_RESULT_GARBAGE)
+            {
+                if (out_len != 1 || (frame && consumed >= frame->offset))
+                {
+                    fprintf(stderr, "frame %u (%.2X at %u) dropped as garbage\n", 
+                            index, frame ? frame->header : 0, consumed);
+                    return false;
+                }
+            }
+            else
+            {
+                uint16_t expect_len = can_left ? can_left : (frame ? frame->len : 0);
+
+                if (frame == NULL || consumed != frame->offset + (frame->len - expect_len) 
+                ||  rx_buff[0] != frame->header || pf.is_crc_ok != frame->is_crc_ok
+                ||  (frame->header == YMODEM_CAN ? out_len > expect_len : out_len != expect_len))
+                {
+                    fprintf(stderr, "frame %u: got %.2X, %u bytes at %u, crc %d; expect %.2X, %u bytes at %u, crc %d\n",
+                            index, rx_buff[0], out_len, consumed, pf.is_crc_ok, 
+                            frame ? frame->header : 0, expect_len, frame ? frame->offset : 0, frame ? frame->is_crc_ok : 0);
+                    return false;
+                }
+
+                can_left = expect_len - out_len;
+                if (can_left == 0)
+                    index++;
+            }
+
+            consumed += out_len;
+            rx_len   -= out_len;
+            memmove(&rx_buff[0], &rx_buff[out_len], rx_len);
+        }
+    }
+
+    if (index != stream->frame_num || rx_len)
+    {
+        fprintf(stderr, "parsed %u of %u frames, %u bytes left\n", index, stream->frame_num, rx_len);
+        return false;
+    }
+    return true;
+}
+
+#else
+
+int main(void)
+{
+    fprintf(stderr, "ENABLE_FRAME_PARSER is 0 in bootloader_config.h, nothing to test\n");
+    return 0;
+}
+
+#endif  /* #if (ENABLE_FRAME_PARSER) */
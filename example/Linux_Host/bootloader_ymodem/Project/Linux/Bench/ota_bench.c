@@ -0,0 +1,1158 @@
+/**
+ * \file            ota_bench.c
+ * \brief           end-to-end OTA benchmark of the host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 bootloader 耗时统计（ perf ）的解析和输出
+ * v1.2     2026-10-18                  增加 -g 选项，可按 YModem-G 发送
+ * v1.3     2026-10-18                  增加 -P 选项，可按滑动窗口协议发送；增加 -n 选项，模拟线路干扰
+ * v1.4     2026-10-18                  增加 -X 选项，可请求 YModem 扩展数据帧
+ * v1.5     2026-10-18                  增加 -z 选项，可压缩固件包；增加 -r 选项，设置源固件中可压缩部分的比例
+ * v1.6     2026-10-18                  增加 -D 选项，先安装基础固件，再测量差分升级
+ * v1.7     2026-10-18                  增加 -R 选项，传输中断后断点续传
+ * v1.8     2026-10-18                  增加 -U 选项，先安装基础固件，再下发原位修改后的完整固件包
+ * v1.9     2026-10-18                  增加 -N 选项，协商 YModem 传输的波特率；增加 -B 选项，设置仿真线路的波特率上限
+ * v1.10    2026-10-18                  增加 -u 选项，选择上位机连接的仿真 UART
+ */
+
+
+/**
+ * 端到端 OTA 基准测试：
+ *    1. 生成指定大小的源固件，按 bootloader 的 fpk 格式打包，可选加密和压缩
+ *    2. 以空白的 flash 镜像启动主机仿真 mota_host ，并开启 trace
+ *    3. 通过 PTY 以 YModem-1K 、 YModem-G 或滑动窗口协议下发固件包，直至 bootloader 跳转至 APP
+ *    4. 解析 trace ，得到各执行流程的耗时、 UART 和 flash 的统计
+ * 对每个 -p 指定的 bootloader 变体、每种固件大小、是否加密、是否压缩、波特率、协议和是否使能 YModem-G 的组合各运行一次，结果输出为 JSON 或 CSV 。
+ * -g 只对 YModem 有效。 -n 按概率破坏数据帧中的一个字节，两种协议使用相同的随机数种子，可直接比较重发的代价。
+ * -X 同样只对 YModem 有效，列出的每个扩展数据帧长度各运行一次， 0 表示不请求，需 bootloader 启用 ENABLE_YMODEM_EXT_FRAME 且长度一致才会使用。
+ * -z 1 需 bootloader 启用 ENABLE_DECOMPRESS 。源固件默认是伪随机数，几乎不可压缩，可用 -r 将每 256 byte 中
+ * 指定比例的部分改为 0xFF 填充，模拟固件中的空白和对齐填充。
+ * -D 需 bootloader 启用 ENABLE_DELTA_UPDATE 且为多分区方案。每次测量前先以不限速的 YModem 安装基础固件（不计入结果），
+ * 再保留 flash 镜像下发差分固件包。新固件按比例修改基础固件中的 256 byte 块（每块 8 byte ），并在中间插入 32 byte 。
+ * 补丁中匹配的部分几乎全为 0 ，通常与 -z 1 一起使用。
+ * -R 只对 YModem 有效，需 bootloader 启用 ENABLE_RESUME_TRANSFER 且为多分区方案。先下发固件包，发送至指定比例时
+ * 强行结束主机仿真，模拟传输中断和掉电，再保留 flash 镜像重新下发并请求断点续传，结果为第二次的运行，不可与 -D 同时使用。
+ * -U 与 -D 相同地先安装基础固件，新固件只按比例原位修改 256 byte 块、不插入数据，以完整的固件包下发，模拟小版本更新，
+ * 用于测量 ENABLE_INCREMENTAL_UPDATE 跳过的擦写。不可与 -D 、 -R 同时使用。
+ * -N 只对 YModem 有效，需 bootloader 启用 ENABLE_BAUD_NEGOTIATION 。以 -b 的波特率握手，按优先顺序请求列出的波特率，
+ * 协商成功后以新波特率传输。 -B 传给主机仿真，线路超过该波特率时数据出错，用于测量协商失败后回落的代价。
+ *
+ * 例:
+ *    ./build/ota_bench -p TRIPLE=build/mota_host -s 16K,64K -e 0,1 -b 115200,0 -g 0,1 -f csv
+ *    ./build/ota_bench -s 64K -b 115200 -P ymodem,window -n 0.02 -f csv
+ *    ./build/ota_bench -s 64K -b 115200,921600 -X 0,4096 -f csv
+ *    ./build/ota_bench -s 64K -b 115200 -e 0,1 -z 0,1 -r 50 -f csv
+ *    ./build/ota_bench -s 64K -b 115200 -z 1 -D 10 -f csv
+ *    ./build/ota_bench -s 256K -b 115200 -R 90 -f csv
+ *    ./build/ota_bench -s 96K -b 115200 -U 5 -f csv
+ *    ./build/ota_bench -s 96K -b 115200 -N 2000000,921600 -B 921600 -f csv
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "fpk_pack.h"
+#include "ymodem_send.h"
+#include "window_send.h"
+
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_VARIANT_MAX               8
+#define BENCH_LIST_MAX                  16
+#define BENCH_FLOW_MAX                  32
+#define BENCH_PERF_MAX                  16
+
+#define BENCH_PROTOCOL_YMODEM           0
+#define BENCH_PROTOCOL_WINDOW           1
+
+/* 与 bootloader_config.h 中的 WINDOW_PROTOCOL_FRAME_NUM 无关，实际窗口取两者的较小值 */
+#define BENCH_WINDOW_SIZE               WINDOW_MAX_FRAME_NUM
+
+/* 与 bootloader_config.h 中的 AES256_KEY 和 AES256_IV 保持一致 */
+#define BENCH_AES256_KEY                "0123456789ABCDEF0123456789ABCDEF"
+#define BENCH_AES256_IV                 "0123456789ABCDEF"
+
+/* 压缩窗口不能大于 bootloader_config.h 中的 DECOMPRESS_WINDOW_BITS */
+#define BENCH_LZ_WINDOW_BITS            10
+#define BENCH_LZ_LOOKAHEAD_BITS         4
+
+/* 差分升级时新固件的修改方式 */
+#define BENCH_DELTA_BLOCK_SIZE          256
+#define BENCH_DELTA_CHANGE_SIZE         8           /* 被修改的块中修改的字节数 */
+#define BENCH_DELTA_INSERT_SIZE         32          /* 在中间插入的字节数，末尾截去相同的字节数，大小不变 */
+
+/* 源固件的中断向量表，需能通过 bootloader 跳转前的栈顶检查 */
+#define BENCH_APP_STACK_TOP             0x20005000
+#define BENCH_APP_RESET_HANDLER         0x08008101
+
+/* 报告中单独列出的执行流程，其余流程（等待数据、 *_DONE 等）合计为 wait */
+static const char *const _report_flow[] = 
+{
+    "VERIFY_FIRMWARE_HEAD",
+    "ERASE_OLD_FIRMWARE",
+    "WRITE_NEW_FIRMWARE",
+    "VERIFY_FIRMWARE",
+    "ERASE_APP",
+    "UPDATE_TO_APP",
+    "VERIFY_APP",
+};
+#define BENCH_REPORT_FLOW_NUM           (sizeof(_report_flow) / sizeof(_report_flow[0]))
+
+
+/* Private typedef -----------------------------------------------------------*/
+struct BENCH_VARIANT
+{
+    const char     *label;
+    const char     *path;
+};
+
+struct BENCH_RESULT
+{
+    bool            is_ok;
+    const char     *error;
+    uint32_t        fpk_size;
+    uint64_t        total_ns;                       /* 收到第一个 'C' 至进入 JUMP_TO_APP */
+    uint64_t        jump_ns;                        /* 进入 JUMP_TO_APP 的时刻 */
+    uint64_t        transfer_ns;                    /* YModem 会话的耗时 */
+    uint32_t        frames;
+    uint32_t        retries;
+    bool            is_ymodem_g;                    /* 实际按 YModem-G 传输 */
+    uint32_t        ext_len;                        /* 实际使用的扩展数据帧长度， 0: 未使用 */
+    uint32_t        protocol;                       /* BENCH_PROTOCOL_* */
+    uint32_t        corrupted;                      /* 被 -n 破坏的数据帧数 */
+    uint32_t        naks;                           /* 滑动窗口协议收到的 NAK 数 */
+    uint32_t        window;                         /* 滑动窗口协议实际的窗口大小 */
+    uint32_t        resume_offset;                  /* 断点续传跳过的包体长度 */
+    uint32_t        nego_baud;                      /* 协商后的波特率， 0: 未切换 */
+    uint32_t        baud_fails;                     /* 协商失败、回落至原波特率的次数 */
+    uint32_t        flow_num;
+    const char     *flow_name[BENCH_FLOW_MAX];
+    uint64_t        flow_ns[BENCH_FLOW_MAX];
+    uint64_t        uart_rx;
+    uint64_t        uart_tx;
+    uint32_t        flash_erase;
+    uint64_t        flash_erase_us;
+    uint32_t        flash_program;
+    uint64_t        flash_program_us;
+    uint64_t        flash_read_us;
+    uint32_t        flash_violation;
+    uint32_t        perf_num;                       /* bootloader 的耗时统计，需启用 ENABLE_PERF_STATS */
+    char            perf_name[BENCH_PERF_MAX][32];
+    uint32_t        perf_count[BENCH_PERF_MAX];
+    uint64_t        perf_total_us[BENCH_PERF_MAX];
+    uint32_t        perf_max_us[BENCH_PERF_MAX];
+};
+
+struct BENCH_CONFIG
+{
+    struct BENCH_VARIANT variant[BENCH_VARIANT_MAX];
+    uint32_t        variant_num;
+    uint32_t        size[BENCH_LIST_MAX];
+    uint32_t        size_num;
+    uint32_t        encrypt[BENCH_LIST_MAX];
+    uint32_t        encrypt_num;
+    uint32_t        compress[BENCH_LIST_MAX];
+    uint32_t        compress_num;
+    uint32_t        fill_percent;                   /* 源固件中 0xFF 填充的比例 */
+    uint32_t        delta_percent;                  /* 差分升级时被修改的块的比例， 0: 下发完整的固件包 */
+    uint32_t        resume_percent;                 /* 断点续传前中断的位置占固件包的比例， 0: 不中断 */
+    uint32_t        modify_percent;                 /* 安装基础固件后下发的完整固件包中被修改的块的比例， 0: 不安装基础固件 */
+    uint32_t        baud[BENCH_LIST_MAX];
+    uint32_t        baud_num;
+    uint32_t        nego_baud[YMODEM_BAUD_MAX_NUM]; /* YModem 协商的波特率，按优先顺序排列 */
+    uint32_t        nego_num;
+    uint32_t        line_baud;                      /* 仿真线路的波特率上限， 0: 不限 */
+    uint32_t        uart;                           /* 上位机连接的仿真 UART ， 1 或 2 */
+    uint32_t        ymodem_g[BENCH_LIST_MAX];
+    uint32_t        ymodem_g_num;
+    uint32_t        ext_len[BENCH_LIST_MAX];
+    uint32_t        ext_num;
+    uint32_t        protocol[BENCH_LIST_MAX];
+    uint32_t        protocol_num;
+    double          noise;
+    const char     *model;
+    uint32_t        time_scale;
+    uint32_t        timeout_s;
+    bool            is_warm;
+    bool            is_csv;
+    const char     *out_file;
+    char            work_dir[256];
+};
+
+
+/* Private variables ---------------------------------------------------------*/
+static struct BENCH_CONFIG _cfg = 
+{
+    .model      = "stm32f1",
+    .uart       = 1,
+    .time_scale = 100,
+    .timeout_s  = 300,
+};
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void         _Usage              (const char *name);
+static uint32_t     _ParseList          (const char *str, uint32_t *list, uint32_t max, bool is_size);
+static uint32_t     _ParseProtocol      (const char *str, uint32_t *list, uint32_t max);
+static uint8_t *    _MakeRaw            (uint32_t raw_size);
+static uint8_t *    _MakeDeltaRaw       (const uint8_t *base, uint32_t raw_size, uint32_t percent, bool is_insert);
+static uint8_t *    _MakeFirmware       (const uint8_t *raw, uint32_t raw_size, const uint8_t *base, 
+                                         bool is_encrypt, bool is_compress, uint32_t *fpk_size);
+static void         _WorkPath           (char *buff, size_t size, const char *name);
+static int          _RunOnce            (const struct BENCH_VARIANT *variant, uint32_t baud, uint32_t protocol, bool enable_g,
+                                         uint32_t ext_len, const uint8_t *fpk, uint32_t fpk_size, bool is_keep_flash, 
+                                         uint32_t drop_size, struct BENCH_RESULT *result);
+static int          _RunResume          (const struct BENCH_VARIANT *variant, uint32_t baud, uint32_t protocol, bool enable_g,
+                                         uint32_t ext_len, const uint8_t *fpk, uint32_t fpk_size, struct BENCH_RESULT *result);
+static int          _RunDelta           (const struct BENCH_VARIANT *variant, uint32_t baud, uint32_t protocol, bool enable_g,
+                                         uint32_t ext_len, const uint8_t *base_fpk, uint32_t base_fpk_size, 
+                                         const uint8_t *fpk, uint32_t fpk_size, struct BENCH_RESULT *result);
+static void         _ParseTrace         (const char *file, struct BENCH_RESULT *result);
+static uint64_t     _FlowTime           (const struct BENCH_RESULT *result, const char *name);
+static void         _Report             (FILE *fp, bool is_first, const struct BENCH_VARIANT *variant, uint32_t size,
+                                         uint32_t is_encrypt, uint32_t is_compress, uint32_t baud, const struct BENCH_RESULT *result);
+
+
+/* Exported functions ---------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+    int   opt;
+    FILE *out = stdout;
+    bool  is_first = true;
+    const char *work_dir = NULL;
+    const char *list;
+
+    _cfg.size_num    = _ParseList("16K,64K", _cfg.size, BENCH_LIST_MAX, true);
+    _cfg.encrypt_num = _ParseList("0", _cfg.encrypt, BENCH_LIST_MAX, false);
+    _cfg.compress_num = _ParseList("0", _cfg.compress, BENCH_LIST_MAX, false);
+    _cfg.baud_num    = _ParseList("0", _cfg.baud, BENCH_LIST_MAX, false);
+    _cfg.ymodem_g_num = _ParseList("0", _cfg.ymodem_g, BENCH_LIST_MAX, false);
+    _cfg.ext_num     = _ParseList("0", _cfg.ext_len, BENCH_LIST_MAX, true);
+    _cfg.protocol_num = _ParseProtocol("ymodem", _cfg.protocol, BENCH_LIST_MAX);
+
+    while ((opt = getopt(argc, argv, "p:s:e:z:r:D:R:U:b:N:B:u:g:X:P:n:m:t:x:wf:o:d:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+            {
+                char *eq = strchr(optarg, '=');
+                if (_cfg.variant_num >= BENCH_VARIANT_MAX)
+                    break;
+                if (eq)
+                {
+                    *eq = '\0';
+                    _cfg.variant[_cfg.variant_num].label = optarg;
+                    _cfg.variant[_cfg.variant_num].path  = eq + 1;
+                }
+                else
+                {
+                    _cfg.variant[_cfg.variant_num].label = optarg;
+                    _cfg.variant[_cfg.variant_num].path  = optarg;
+                }
+                _cfg.variant_num++;
+                break;
+            }
+            case 's': _cfg.size_num    = _ParseList(optarg, _cfg.size, BENCH_LIST_MAX, true);       break;
+            case 'e': _cfg.encrypt_num = _ParseList(optarg, _cfg.encrypt, BENCH_LIST_MAX, false);   break;
+            case 'z': _cfg.compress_num = _ParseList(optarg, _cfg.compress, BENCH_LIST_MAX, false); break;
+            case 'r': _cfg.fill_percent = strtoul(optarg, NULL, 0);                                 break;
+            case 'D': _cfg.delta_percent = strtoul(optarg, NULL, 0);                                break;
+            case 'R': _cfg.resume_percent = strtoul(optarg, NULL, 0);                               break;
+            case 'U': _cfg.modify_percent = strtoul(optarg, NULL, 0);                               break;
+            case 'b': _cfg.baud_num    = _ParseList(optarg, _cfg.baud, BENCH_LIST_MAX, false);      break;
+            case 'N': _cfg.nego_num    = _ParseList(optarg, _cfg.nego_baud, YMODEM_BAUD_MAX_NUM, false); break;
+            case 'B': _cfg.line_baud   = strtoul(optarg, NULL, 0);                                  break;
+            case 'u': _cfg.uart        = strtoul(optarg, NULL, 0);                                  break;
+            case 'g': _cfg.ymodem_g_num = _ParseList(optarg, _cfg.ymodem_g, BENCH_LIST_MAX, false); break;
+            case 'X': _cfg.ext_num     = _ParseList(optarg, _cfg.ext_len, BENCH_LIST_MAX, true);    break;
+            case 'P': _cfg.protocol_num = _ParseProtocol(optarg, _cfg.protocol, BENCH_LIST_MAX);    break;
+            case 'n': _cfg.noise       = strtod(optarg, NULL);                                      break;
+            case 'm': _cfg.model       = optarg;                                                    break;
+            case 't': _cfg.time_scale  = strtoul(optarg, NULL, 0);                                  break;
+            case 'x': _cfg.timeout_s   = strtoul(optarg, NULL, 0);                                  break;
+            case 'w': _cfg.is_warm     = true;                                                      break;
+            case 'f': _cfg.is_csv      = (strcmp(optarg, "csv") == 0);                              break;
+            case 'o': _cfg.out_file    = optarg;                                                    break;
+            case 'd': work_dir         = optarg;                                                    break;
+            default : _Usage(argv[0]);                                                              return EXIT_FAILURE;
+        }
+    }
+
+    if (_cfg.protocol_num == 0 || _cfg.resume_percent >= 100 || (_cfg.resume_percent && _cfg.delta_percent)
+    ||  (_cfg.modify_percent && (_cfg.delta_percent || _cfg.resume_percent))
+    ||  (_cfg.uart != 1 && _cfg.uart != 2))
+    {
+        _Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* 扩展数据帧需长于 1024 byte 的 STX 数据帧 */
+    for (uint32_t i = 0; i < _cfg.ext_num; i++)
+    {
+        if (_cfg.ext_len[i] && (_cfg.ext_len[i] <= 1024 || _cfg.ext_len[i] > YMODEM_EXT_MAX_LEN))
+        {
+            fprintf(stderr, "invalid extended frame length: %u\n", _cfg.ext_len[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (_cfg.variant_num == 0)
+    {
+        _cfg.variant[0].label = "default";
+        _cfg.variant[0].path  = "build/mota_host";
+        _cfg.variant_num = 1;
+    }
+
+    if (work_dir)
+    {
+        snprintf(_cfg.work_dir, sizeof(_cfg.work_dir), "%s", work_dir);
+        mkdir(_cfg.work_dir, 0755);
+    }
+    else
+    {
+        snprintf(_cfg.work_dir, sizeof(_cfg.work_dir), "/tmp/ota_bench.XXXXXX");
+        if (mkdtemp(_cfg.work_dir) == NULL)
+        {
+            perror("mkdtemp");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (_cfg.out_file)
+    {
+        out = fopen(_cfg.out_file, "w");
+        if (out == NULL)
+        {
+            perror(_cfg.out_file);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* 主机仿真退出后 PTY 关闭，写入时不能因 SIGPIPE 终止 */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (_cfg.is_csv)
+    {
+        fprintf(out, "variant,size,encrypt,baud,model,time_scale,result,fpk_size,total_ms,transfer_ms,throughput_Bps");
+        for (uint32_t i = 0; i < BENCH_REPORT_FLOW_NUM; i++)
+            fprintf(out, ",%s_ms", _report_flow[i]);
+        fprintf(out, ",wait_ms,frames,retries,ymodem_g,uart_rx,uart_tx,flash_erase,flash_erase_ms,"
+                     "flash_program,flash_program_ms,flash_read_ms,flash_violation,"
+                     "protocol,noise,corrupted,naks,window,ext,compress,delta,resume,modify,nego_baud,baud_fails\n");
+    }
+    else
+        fprintf(out, "[\n");
+
+    for (uint32_t v = 0; v < _cfg.variant_num; v++)
+    {
+        for (uint32_t s = 0; s < _cfg.size_num; s++)
+        {
+            for (uint32_t e = 0; e < _cfg.encrypt_num * _cfg.compress_num; e++)
+            {
+                uint32_t fpk_size, base_fpk_size = 0;
+                uint32_t is_encrypt  = _cfg.encrypt[e / _cfg.compress_num];
+                uint32_t is_compress = _cfg.compress[e % _cfg.compress_num];
+                uint8_t *raw = _MakeRaw(_cfg.size[s]);
+                uint8_t *fpk, *base_fpk = NULL;
+
+                /* 差分升级时基础固件按完整的固件包安装，新固件按相对基础固件的差分固件包下发 */
+                if (_cfg.delta_percent)
+                {
+                    uint8_t *new_raw = _MakeDeltaRaw(raw, _cfg.size[s], _cfg.delta_percent, true);
+
+                    base_fpk = _MakeFirmware(raw, _cfg.size[s], NULL, false, false, &base_fpk_size);
+                    fpk = _MakeFirmware(new_raw, _cfg.size[s], raw, is_encrypt, is_compress, &fpk_size);
+                    free(new_raw);
+                }
+                /* 小版本更新时基础固件同样先安装，新固件按完整的固件包下发 */
+                else if (_cfg.modify_percent)
+                {
+                    uint8_t *new_raw = _MakeDeltaRaw(raw, _cfg.size[s], _cfg.modify_percent, false);
+
+                    base_fpk = _MakeFirmware(raw, _cfg.size[s], NULL, false, false, &base_fpk_size);
+                    fpk = _MakeFirmware(new_raw, _cfg.size[s], NULL, is_encrypt, is_compress, &fpk_size);
+                    free(new_raw);
+                }
+                else
+                    fpk = _MakeFirmware(raw, _cfg.size[s], NULL, is_encrypt, is_compress, &fpk_size);
+                free(raw);
+
+                if (fpk == NULL || ((_cfg.delta_percent || _cfg.modify_percent) && base_fpk == NULL))
+                {
+                    fprintf(stderr, "[ota_bench] failed to make firmware package\n");
+                    return EXIT_FAILURE;
+                }
+
+                for (uint32_t b = 0; b < _cfg.baud_num; b++)
+                {
+                    for (uint32_t p = 0; p < _cfg.protocol_num; p++)
+                    {
+                        /* -g 和 -X 只对 YModem 有效，两者的组合各运行一次 */
+                        bool     is_ymodem = (_cfg.protocol[p] == BENCH_PROTOCOL_YMODEM);
+                        uint32_t g_num = is_ymodem ? _cfg.ymodem_g_num : 1;
+                        uint32_t x_num = is_ymodem ? _cfg.ext_num : 1;
+
+                        for (uint32_t i = 0; i < g_num * x_num; i++)
+                        {
+                            struct BENCH_RESULT result;
+                            bool     enable_g = is_ymodem && _cfg.ymodem_g[i / x_num];
+                            uint32_t ext_len  = is_ymodem ? _cfg.ext_len[i % x_num] : 0;
+
+                            fprintf(stderr, "[ota_bench] %s size=%u encrypt=%u compress=%u baud=%u protocol=%s ymodem_g=%u ext=%u ...\n",
+                                    _cfg.variant[v].label, _cfg.size[s], is_encrypt, is_compress, _cfg.baud[b],
+                                    is_ymodem ? "ymodem" : "window", enable_g, ext_len);
+
+                            /* 预热：先完整跑一次不计入结果，使系统缓存等处于稳定状态 */
+                            if (_cfg.is_warm && base_fpk)
+                                _RunDelta(&_cfg.variant[v], _cfg.baud[b], _cfg.protocol[p], enable_g, ext_len, 
+                                          base_fpk, base_fpk_size, fpk, fpk_size, &result);
+                            else if (_cfg.is_warm)
+                                _RunOnce(&_cfg.variant[v], _cfg.baud[b], _cfg.protocol[p], enable_g, ext_len, fpk, fpk_size, false, 0, &result);
+
+                            if (base_fpk)
+                                _RunDelta(&_cfg.variant[v], _cfg.baud[b], _cfg.protocol[p], enable_g, ext_len, 
+                                          base_fpk, base_fpk_size, fpk, fpk_size, &result);
+                            else if (_cfg.resume_percent && is_ymodem)
+                                _RunResume(&_cfg.variant[v], _cfg.baud[b], _cfg.protocol[p], enable_g, ext_len, fpk, fpk_size, &result);
+                            else
+                                _RunOnce(&_cfg.variant[v], _cfg.baud[b], _cfg.protocol[p], enable_g, ext_len, fpk, fpk_size, false, 0, &result);
+                            _Report(out, is_first, &_cfg.variant[v], _cfg.size[s], is_encrypt, is_compress, _cfg.baud[b], &result);
+                            is_first = false;
+
+                            fprintf(stderr, "[ota_bench]   %s%s%s, total %.1f ms, frames %u, retries %u, corrupted %u, resume %u, "
+                                            "baud %u (fails %u)\n",
+                                    result.is_ok ? "ok" : result.error, result.is_ymodem_g ? " (YModem-G)" : "",
+                                    result.ext_len ? " (ext)" : "", result.total_ns / 1e6, result.frames,
+                                    result.retries, result.corrupted, result.resume_offset, result.nego_baud, result.baud_fails);
+                        }
+                    }
+                }
+
+                free(fpk);
+                free(base_fpk);
+            }
+        }
+    }
+
+    if (_cfg.is_csv == false)
+        fprintf(out, "\n]\n");
+
+    if (out != stdout)
+        fclose(out);
+
+    return EXIT_SUCCESS;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  打印使用说明
+ * @note   
+ * @param[in]  name: 程序名
+ * @retval None
+ */
+static void _Usage(const char *name)
+{
+    fprintf(stderr, 
+            "usage: %s [options]\n"
+            "  -p LABEL=PATH   bootloader variant to run, may be repeated (default: build/mota_host)\n"
+            "  -s SIZES        raw firmware sizes, K/M suffix allowed (default: 16K,64K)\n"
+            "  -e 0,1          package without / with AES256 encryption (default: 0)\n"
+            "  -z 0,1          package without / with LZSS compression (default: 0)\n"
+            "  -r PERCENT      share of each 256 bytes of the raw firmware filled with 0xFF (default: 0)\n"
+            "  -D PERCENT      install a base firmware first, then send a delta package changing this share\n"
+            "                  of its 256-byte blocks, 0 = full package (default: 0)\n"
+            "  -U PERCENT      install a base firmware first, then send a full package changing this share\n"
+            "                  of its 256-byte blocks in place, 0 = no base firmware (default: 0)\n"
+            "  -R PERCENT      cut the link and kill the host at this share of the package, then resend\n"
+            "                  with resume requested and report the second run, ymodem only (default: 0)\n"
+            "  -b BAUDS        simulated UART baud rates, 0 = unlimited (default: 0)\n"
+            "  -N BAUDS        baud rates to negotiate before frame 0, highest priority first, ymodem only (default: none)\n"
+            "  -B BAUD         highest baud rate the simulated line carries, 0 = any (default: 0)\n"
+            "  -u 1|2          simulated UART the sender connects to, the other one stays idle (default: 1)\n"
+            "  -g 0,1          send as YModem-1K / accept the YModem-G handshake (default: 0)\n"
+            "  -X LENS         YModem extended frame lengths to request, 0 = none, K suffix allowed (default: 0)\n"
+            "  -P PROTOCOLS    ymodem,window: transfer protocols to run, -g applies to ymodem only (default: ymodem)\n"
+            "  -n RATE         probability of corrupting one byte of each data frame (default: 0)\n"
+            "  -m MODEL        on-chip flash model passed to the host (default: stm32f1)\n"
+            "  -t SCALE        flash timing scale in %% (default: 100)\n"
+            "  -x SECONDS      timeout of one run (default: 300)\n"
+            "  -w              run each case once unmeasured before measuring\n"
+            "  -f json|csv     output format (default: json)\n"
+            "  -o FILE         output file (default: stdout)\n"
+            "  -d DIR          work directory for flash images and traces (default: mkdtemp)\n",
+            name);
+}
+
+
+/**
+ * @brief  解析以逗号分隔的数值列表
+ * @note   
+ * @param[in]   str: 如 "16K,64K,1M"
+ * @param[out]  list: 解析结果
+ * @param[in]   max: list 的容量
+ * @param[in]   is_size: 是否允许 K/M 后缀
+ * @retval 解析出的数量
+ */
+static uint32_t _ParseList(const char *str, uint32_t *list, uint32_t max, bool is_size)
+{
+    uint32_t num = 0;
+    char *end;
+
+    while (*str && num < max)
+    {
+        uint32_t value = strtoul(str, &end, 0);
+
+        if (is_size && (*end == 'K' || *end == 'k'))
+        {
+            value *= 1024;
+            end++;
+        }
+        else if (is_size && (*end == 'M' || *end == 'm'))
+        {
+            value *= 1024 * 1024;
+            end++;
+        }
+        list[num++] = value;
+
+        str = (*end == ',') ? end + 1 : end;
+        if (end == str && *str != '\0')
+            break;
+    }
+
+    return num;
+}
+
+
+/**
+ * @brief  解析以逗号分隔的协议列表
+ * @note   
+ * @param[in]   str: 如 "ymodem,window"
+ * @param[out]  list: 解析结果， BENCH_PROTOCOL_*
+ * @param[in]   max: list 的容量
+ * @retval 解析出的数量，含未知的协议名时返回 0
+ */
+static uint32_t _ParseProtocol(const char *str, uint32_t *list, uint32_t max)
+{
+    uint32_t num = 0;
+
+    while (*str && num < max)
+    {
+        size_t len = strcspn(str, ",");
+
+        if (len == 6 && strncmp(str, "ymodem", len) == 0)
+            list[num++] = BENCH_PROTOCOL_YMODEM;
+        else if (len == 6 && strncmp(str, "window", len) == 0)
+            list[num++] = BENCH_PROTOCOL_WINDOW;
+        else
+            return 0;
+
+        str += len;
+        if (*str == ',')
+            str++;
+    }
+
+    return num;
+}
+
+
+/**
+ * @brief  生成源固件
+ * @note   源固件的内容由固定种子的伪随机数生成，每次运行都相同，每 256 byte 的末尾按 -r 的比例填充 0xFF
+ * @param[in]  raw_size: 源固件大小，单位 byte
+ * @retval 源固件，由调用者 free
+ */
+static uint8_t *_MakeRaw(uint32_t raw_size)
+{
+    uint8_t *raw = malloc(raw_size);
+    uint32_t seed = 0x12345678 ^ raw_size;
+
+    for (uint32_t i = 0; i < raw_size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        raw[i] = seed >> 16;
+        if ((i % 256) >= 256 - 256 * _cfg.fill_percent / 100)
+            raw[i] = 0xFF;
+    }
+
+    if (raw_size >= 8)
+    {
+        uint32_t vector[2] = { BENCH_APP_STACK_TOP, BENCH_APP_RESET_HANDLER };
+        memcpy(raw, vector, sizeof(vector));
+    }
+
+    return raw;
+}
+
+
+/**
+ * @brief  按 -D 或 -U 的比例修改基础固件，生成新的源固件
+ * @note   1. 按比例选中的 256 byte 块中，修改随机位置的 BENCH_DELTA_CHANGE_SIZE byte ，中断向量表保持不变
+ *         2. is_insert 时在中间插入 BENCH_DELTA_INSERT_SIZE byte ，之后的数据整体后移，末尾截去相同的字节数
+ * @param[in]  base: 基础固件
+ * @param[in]  raw_size: 基础固件大小，单位 byte ，新的源固件大小相同
+ * @param[in]  percent: 被修改的块的比例，单位 %
+ * @param[in]  is_insert: 是否在中间插入数据
+ * @retval 新的源固件，由调用者 free
+ */
+static uint8_t *_MakeDeltaRaw(const uint8_t *base, uint32_t raw_size, uint32_t percent, bool is_insert)
+{
+    uint8_t *raw = malloc(raw_size);
+    uint32_t seed = 0x9E3779B9 ^ raw_size;
+    uint32_t middle = raw_size / 2;
+
+    memcpy(raw, base, raw_size);
+
+    for (uint32_t block = 0; block < raw_size / BENCH_DELTA_BLOCK_SIZE; block++)
+    {
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 100 >= percent)
+            continue;
+
+        for (uint32_t i = 0; i < BENCH_DELTA_CHANGE_SIZE; i++)
+        {
+            uint32_t posit;
+
+            seed  = seed * 1103515245 + 12345;
+            posit = block * BENCH_DELTA_BLOCK_SIZE + (seed >> 16) % BENCH_DELTA_BLOCK_SIZE;
+            if (posit >= 8)
+                raw[posit] ^= (seed >> 8) | 0x01;
+        }
+    }
+
+    if (is_insert && middle >= 8 && raw_size - middle > BENCH_DELTA_INSERT_SIZE)
+    {
+        memmove(&raw[middle + BENCH_DELTA_INSERT_SIZE], &raw[middle], raw_size - middle - BENCH_DELTA_INSERT_SIZE);
+        for (uint32_t i = 0; i < BENCH_DELTA_INSERT_SIZE; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            raw[middle + i] = seed >> 16;
+        }
+    }
+
+    return raw;
+}
+
+
+/**
+ * @brief  生成固件包
+ * @note   
+ * @param[in]   raw: 源固件
+ * @param[in]   raw_size: 源固件大小，单位 byte
+ * @param[in]   base: 基础固件，大小与源固件相同， NULL: 生成完整的固件包
+ * @param[in]   is_encrypt: 是否加密
+ * @param[in]   is_compress: 是否压缩
+ * @param[out]  fpk_size: 固件包大小，单位 byte
+ * @retval 固件包，由调用者 free
+ */
+static uint8_t *_MakeFirmware(const uint8_t *raw, uint32_t raw_size, const uint8_t *base, 
+                              bool is_encrypt, bool is_compress, uint32_t *fpk_size)
+{
+    struct FPK_PACK_CONFIG pack = 
+    {
+        .is_encrypt  = is_encrypt,
+        .is_compress = is_compress,
+        .window_bits = BENCH_LZ_WINDOW_BITS,
+        .lookahead_bits = BENCH_LZ_LOOKAHEAD_BITS,
+        .is_delta    = (base != NULL),
+        .base        = base,
+        .base_size   = raw_size,
+        .key         = (const uint8_t *)BENCH_AES256_KEY,
+        .iv          = (const uint8_t *)BENCH_AES256_IV,
+        .new_ver     = {1, 0, 0, 0},
+        .user_string = "ota_bench",
+        .part_name   = "download",
+        .timestamp   = (uint32_t)time(NULL),
+        .head_size   = 1024,
+    };
+
+    return FPK_Pack(&pack, raw, raw_size, fpk_size);
+}
+
+
+/**
+ * @brief  拼接工作目录下的文件路径
+ * @note   
+ * @param[out]  buff: 路径
+ * @param[in]   size: buff 的大小
+ * @param[in]   name: 文件名
+ * @retval None
+ */
+static void _WorkPath(char *buff, size_t size, const char *name)
+{
+    snprintf(buff, size, "%s/%s", _cfg.work_dir, name);
+}
+
+
+/**
+ * @brief  完整运行一次升级
+ * @note   除 is_keep_flash 外，每次都从空白的 flash 开始
+ * @param[in]   variant: bootloader 变体
+ * @param[in]   baud: 仿真的波特率
+ * @param[in]   protocol: BENCH_PROTOCOL_*
+ * @param[in]   enable_g: 是否接受 YModem-G 的握手
+ * @param[in]   ext_len: 请求的 YModem 扩展数据帧长度， 0: 不请求
+ * @param[in]   fpk: 固件包
+ * @param[in]   fpk_size: 固件包大小，单位 byte
+ * @param[in]   is_keep_flash: 是否保留上一次运行后的 flash 镜像
+ * @param[in]   drop_size: YModem 发送的数据达到该长度后强行结束主机仿真， 0: 不中断
+ * @param[out]  result: 运行结果
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _RunOnce(const struct BENCH_VARIANT *variant, uint32_t baud, uint32_t protocol, bool enable_g,
+                    uint32_t ext_len, const uint8_t *fpk, uint32_t fpk_size, bool is_keep_flash, 
+                    uint32_t drop_size, struct BENCH_RESULT *result)
+{
+    char flash[300], flash_wear[310], spi_flash[300], spi_flash_wear[310];
+    char trace[300], link[300], link2[300], log[300];
+    char baud_str[16], line_str[16], scale_str[16];
+    struct YMODEM_SENDER ys = { .timeout_ms = 3000, .max_retry = 10, .enable_g = enable_g,
+                                .ext_len = ext_len, .noise = _cfg.noise, .seed = 1,
+                                .resume = (_cfg.resume_percent != 0), .drop_size = drop_size,
+                                .baud_num = _cfg.nego_num };
+    /* 重发超时需覆盖窗口内约 3 帧的传输时间 */
+    struct WINDOW_SENDER ws = { .timeout_ms = 3000, .max_retry = 10, .window = BENCH_WINDOW_SIZE,
+                                .rto_ms = 500 + (baud ? 3 * (WINDOW_FRAME_FIXED_LEN + WINDOW_DATA_LEN) * 10 * 1000 / baud : 0),
+                                .noise = _cfg.noise, .seed = 1 };
+    struct termios tio;
+    pid_t    pid;
+    int      status = 0;
+    uint64_t deadline;
+    uint64_t start_ns;
+    YMODEM_SEND_RESULT send_result;
+
+    memset(result, 0, sizeof(*result));
+    result->fpk_size = fpk_size;
+    result->protocol = protocol;
+    memcpy(ys.baud, _cfg.nego_baud, sizeof(ys.baud));
+
+    _WorkPath(flash, sizeof(flash), "flash.bin");
+    _WorkPath(spi_flash, sizeof(spi_flash), "spi_flash.bin");
+    _WorkPath(trace, sizeof(trace), "trace.log");
+    _WorkPath(link, sizeof(link), "uart");
+    _WorkPath(link2, sizeof(link2), "uart2");
+    _WorkPath(log, sizeof(log), "host.log");
+    snprintf(flash_wear, sizeof(flash_wear), "%s.wear", flash);
+    snprintf(spi_flash_wear, sizeof(spi_flash_wear), "%s.wear", spi_flash);
+    snprintf(baud_str, sizeof(baud_str), "%u", baud);
+    snprintf(line_str, sizeof(line_str), "%u", _cfg.line_baud);
+    snprintf(scale_str, sizeof(scale_str), "%u", _cfg.time_scale);
+
+    if (is_keep_flash == false)
+    {
+        unlink(flash);
+        unlink(flash_wear);
+        unlink(spi_flash);
+        unlink(spi_flash_wear);
+    }
+    unlink(trace);
+    unlink(link);
+    unlink(link2);
+
+    pid = fork();
+    if (pid < 0)
+    {
+        result->error = "fork failed";
+        return -1;
+    }
+    if (pid == 0)
+    {
+        int fd = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0)
+        {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execl(variant->path, variant->path, "-f", flash, "-s", spi_flash, "-m", _cfg.model,
+              "-t", scale_str, "-b", baud_str, "-B", line_str, "-T", trace, "-l", link, "-L", link2, "-q", (char *)NULL);
+        _exit(127);
+    }
+
+    /* 等待 PTY 的符号链接出现 */
+    deadline = YModem_Now() + 5000000000ULL;
+    while ((ys.fd = open((_cfg.uart == 2) ? link2 : link, O_RDWR | O_NOCTTY)) < 0 && YModem_Now() < deadline)
+        usleep(10000);
+
+    if (ys.fd < 0)
+    {
+        result->error = "uart link not found";
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        return -1;
+    }
+
+    tcgetattr(ys.fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(ys.fd, TCSANOW, &tio);
+
+    if (protocol == BENCH_PROTOCOL_WINDOW)
+    {
+        ws.fd = ys.fd;
+        send_result = Window_Send(&ws, "ota_bench.fpk", fpk, fpk_size);
+        result->frames    = ws.frames;
+        result->retries   = ws.retries;
+        result->corrupted = ws.corrupted;
+        result->naks      = ws.naks;
+        result->window    = ws.window_used;
+        result->transfer_ns = ws.done_ns ? ws.done_ns - ws.start_ns : 0;
+        start_ns = ws.start_ns;
+    }
+    else
+    {
+        send_result = YModem_Send(&ys, "ota_bench.fpk", fpk, fpk_size);
+        result->frames    = ys.frames;
+        result->retries   = ys.retries;
+        result->corrupted = ys.corrupted;
+        result->is_ymodem_g = ys.is_g;
+        result->ext_len     = ys.is_ext ? ys.ext_len : 0;
+        result->transfer_ns = ys.done_ns ? ys.done_ns - ys.start_ns : 0;
+        result->resume_offset = ys.resume_offset;
+        result->nego_baud     = ys.baudrate;
+        result->baud_fails    = ys.baud_fails;
+        start_ns = ys.start_ns;
+    }
+
+    /* 传输失败（如 YModem-G 被 CAN 取消）或中断时 bootloader 不会跳转，无需等到超时，
+       中断时 SIGKILL 即模拟掉电， flash 镜像中保留已写入的数据 */
+    if (send_result != YMODEM_SEND_OK)
+    {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+    }
+
+    /* 等待 bootloader 完成更新并跳转，即主机仿真退出 */
+    deadline = YModem_Now() + (uint64_t)_cfg.timeout_s * 1000000000ULL;
+    while (waitpid(pid, &status, WNOHANG) == 0)
+    {
+        if (YModem_Now() >= deadline)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            result->error = "timeout";
+            break;
+        }
+        usleep(1000);
+    }
+    close(ys.fd);
+
+    /* trace 的时刻与 YModem_Now 同为 CLOCK_MONOTONIC ，可直接相减 */
+    _ParseTrace(trace, result);
+    if (start_ns && result->jump_ns > start_ns)
+        result->total_ns = result->jump_ns - start_ns;
+
+    if (result->error == NULL)
+    {
+        if (send_result == YMODEM_SEND_CANCEL)
+            result->error = (protocol == BENCH_PROTOCOL_WINDOW) ? "window canceled" : "ymodem canceled";
+        else if (send_result == YMODEM_SEND_DROP)
+            result->error = "dropped";
+        else if (send_result != YMODEM_SEND_OK)
+            result->error = (protocol == BENCH_PROTOCOL_WINDOW) ? "window failed" : "ymodem failed";
+        else if (WIFEXITED(status) == 0 || WEXITSTATUS(status) != 0)
+            result->error = "host exit with error";
+        else if (result->total_ns == 0)
+            result->error = "no jump to APP";
+    }
+    result->is_ok = (result->error == NULL);
+
+    return result->is_ok ? 0 : -1;
+}
+
+
+/**
+ * @brief  先安装基础固件，再运行一次差分升级或小版本更新
+ * @note   基础固件以不限速的 YModem-1K 下发，不计入结果
+ * @param[in]   variant: bootloader 变体
+ * @param[in]   baud: 仿真的波特率
+ * @param[in]   protocol: BENCH_PROTOCOL_*
+ * @param[in]   enable_g: 是否接受 YModem-G 的握手
+ * @param[in]   ext_len: 请求的 YModem 扩展数据帧长度， 0: 不请求
+ * @param[in]   base_fpk: 基础固件的固件包
+ * @param[in]   base_fpk_size: 基础固件的固件包大小，单位 byte
+ * @param[in]   fpk: 差分固件包或新固件的完整固件包
+ * @param[in]   fpk_size: fpk 的大小，单位 byte
+ * @param[out]  result: 第二次的运行结果
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _RunDelta(const struct BENCH_VARIANT *variant, uint32_t baud, uint32_t protocol, bool enable_g,
+                     uint32_t ext_len, const uint8_t *base_fpk, uint32_t base_fpk_size, 
+                     const uint8_t *fpk, uint32_t fpk_size, struct BENCH_RESULT *result)
+{
+    if (_RunOnce(variant, 0, BENCH_PROTOCOL_YMODEM, false, 0, base_fpk, base_fpk_size, false, 0, result) < 0)
+    {
+        result->error = "base install failed";
+        result->fpk_size = fpk_size;
+        return -1;
+    }
+
+    return _RunOnce(variant, baud, protocol, enable_g, ext_len, fpk, fpk_size, true, 0, result);
+}
+
+
+/**
+ * @brief  中断一次传输，再断点续传
+ * @note   两次使用相同的参数，第一次发送至 -R 的比例时强行结束主机仿真，第二次保留 flash 镜像
+ * @param[in]   variant: bootloader 变体
+ * @param[in]   baud: 仿真的波特率
+ * @param[in]   protocol: BENCH_PROTOCOL_*
+ * @param[in]   enable_g: 是否接受 YModem-G 的握手
+ * @param[in]   ext_len: 请求的 YModem 扩展数据帧长度， 0: 不请求
+ * @param[in]   fpk: 固件包
+ * @param[in]   fpk_size: 固件包大小，单位 byte
+ * @param[out]  result: 断点续传的运行结果
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _RunResume(const struct BENCH_VARIANT *variant, uint32_t baud, uint32_t protocol, bool enable_g,
+                      uint32_t ext_len, const uint8_t *fpk, uint32_t fpk_size, struct BENCH_RESULT *result)
+{
+    uint32_t drop_size = (uint64_t)fpk_size * _cfg.resume_percent / 100;
+
+    _RunOnce(variant, baud, protocol, enable_g, ext_len, fpk, fpk_size, false, drop_size ? drop_size : 1, result);
+    if (result->error == NULL || strcmp(result->error, "dropped") != 0)
+    {
+        result->error = "drop failed";
+        result->is_ok = false;
+        return -1;
+    }
+
+    return _RunOnce(variant, baud, protocol, enable_g, ext_len, fpk, fpk_size, true, 0, result);
+}
+
+
+/**
+ * @brief  解析 trace
+ * @note   每个执行流程的耗时为其事件到下一事件的时间，同名流程累加。
+ * @param[in]   file: trace 文件
+ * @param[out]  result: 运行结果
+ * @retval None
+ */
+static void _ParseTrace(const char *file, struct BENCH_RESULT *result)
+{
+    static char names[BENCH_FLOW_MAX][32];
+    char     line[512];
+    char     event[32], arg[32];
+    int      cur = -1;
+    uint64_t ts, last_ts = 0;
+    FILE    *fp = fopen(file, "r");
+
+    if (fp == NULL)
+        return;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        unsigned long long ts_ll;
+
+        arg[0] = '\0';
+        if (sscanf(line, "%llu %31s %31s", &ts_ll, event, arg) < 2)
+            continue;
+        ts = ts_ll;
+
+        /* 上一个执行流程在本事件处结束 */
+        if (cur >= 0 && (strcmp(event, "flow") == 0 || strcmp(event, "start") == 0 || strcmp(event, "exit") == 0))
+        {
+            result->flow_ns[cur] += ts - last_ts;
+            cur = -1;
+        }
+
+        if (strcmp(event, "flow") == 0)
+        {
+            uint32_t i;
+
+            for (i = 0; i < result->flow_num; i++)
+            {
+                if (strcmp(result->flow_name[i], arg) == 0)
+                    break;
+            }
+            if (i == result->flow_num && i < BENCH_FLOW_MAX)
+            {
+                snprintf(names[i], sizeof(names[i]), "%s", arg);
+                result->flow_name[i] = names[i];
+                result->flow_num++;
+            }
+            if (i < BENCH_FLOW_MAX)
+            {
+                cur = i;
+                last_ts = ts;
+            }
+
+            if (strcmp(arg, "JUMP_TO_APP") == 0)
+                result->jump_ns = ts;
+        }
+        else if (strcmp(event, "uart") == 0)
+        {
+            unsigned long long rx = 0, tx = 0;
+
+            sscanf(line, "%*u %*s %*s rx=%llu tx=%llu", &rx, &tx);
+            result->uart_rx += rx;
+            result->uart_tx += tx;
+        }
+        else if (strcmp(event, "flash") == 0)
+        {
+            unsigned int erase = 0, program = 0, violation = 0;
+            unsigned long long erase_us = 0, program_bytes = 0, program_us = 0, read_bytes = 0, read_us = 0;
+
+            sscanf(line, "%*u %*s %*s erase=%u erase_us=%llu program=%u program_bytes=%llu program_us=%llu "
+                         "read_bytes=%llu read_us=%llu violation=%u",
+                   &erase, &erase_us, &program, &program_bytes, &program_us, &read_bytes, &read_us, &violation);
+            result->flash_erase      += erase;
+            result->flash_erase_us   += erase_us;
+            result->flash_program    += program;
+            result->flash_program_us += program_us;
+            result->flash_read_us    += read_us;
+            result->flash_violation  += violation;
+        }
+        else if (strcmp(event, "perf") == 0 && result->perf_num < BENCH_PERF_MAX)
+        {
+            uint32_t i = result->perf_num;
+            unsigned int count = 0, max_us = 0;
+            unsigned long long total_us = 0;
+
+            sscanf(line, "%*u %*s %*s count=%u total_us=%llu max_us=%u", &count, &total_us, &max_us);
+            snprintf(result->perf_name[i], sizeof(result->perf_name[i]), "%s", arg);
+            result->perf_count[i]    = count;
+            result->perf_total_us[i] = total_us;
+            result->perf_max_us[i]   = max_us;
+            result->perf_num++;
+        }
+    }
+    fclose(fp);
+}
+
+
+/**
+ * @brief  获取某个执行流程的累计耗时
+ * @note   
+ * @param[in]  result: 运行结果
+ * @param[in]  name: 执行流程的名称
+ * @retval 单位 ns
+ */
+static uint64_t _FlowTime(const struct BENCH_RESULT *result, const char *name)
+{
+    for (uint32_t i = 0; i < result->flow_num; i++)
+    {
+        if (strcmp(result->flow_name[i], name) == 0)
+            return result->flow_ns[i];
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief  输出一次运行的结果
+ * @note   
+ * @param[in]  fp: 输出文件
+ * @param[in]  is_first: 是否为第一条，用于 JSON 的分隔符
+ * @param[in]  variant: bootloader 变体
+ * @param[in]  size: 源固件大小，单位 byte
+ * @param[in]  is_encrypt: 是否加密
+ * @param[in]  is_compress: 是否压缩
+ * @param[in]  baud: 仿真的波特率
+ * @param[in]  result: 运行结果
+ * @retval None
+ */
+static void _Report(FILE *fp, bool is_first, const struct BENCH_VARIANT *variant, uint32_t size,
+                    uint32_t is_encrypt, uint32_t is_compress, uint32_t baud, const struct BENCH_RESULT *result)
+{
+    uint64_t report_ns = 0;
+    uint64_t wait_ns;
+    double   throughput = result->total_ns ? size / (result->total_ns / 1e9) : 0;
+
+    for (uint32_t i = 0; i < BENCH_REPORT_FLOW_NUM; i++)
+        report_ns += _FlowTime(result, _report_flow[i]);
+    wait_ns = (result->total_ns > report_ns) ? result->total_ns - report_ns : 0;
+
+    if (_cfg.is_csv)
+    {
+        fprintf(fp, "%s,%u,%u,%u,%s,%u,%s,%u,%.3f,%.3f,%.0f",
+                variant->label, size, is_encrypt, baud, _cfg.model, _cfg.time_scale,
+                result->is_ok ? "ok" : result->error, result->fpk_size,
+                result->total_ns / 1e6, result->transfer_ns / 1e6, throughput);
+        for (uint32_t i = 0; i < BENCH_REPORT_FLOW_NUM; i++)
+            fprintf(fp, ",%.3f", _FlowTime(result, _report_flow[i]) / 1e6);
+        fprintf(fp, ",%.3f,%u,%u,%u,%llu,%llu,%u,%.3f,%u,%.3f,%.3f,%u,%s,%g,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+                wait_ns / 1e6, result->frames, result->retries, result->is_ymodem_g,
+                (unsigned long long)result->uart_rx, (unsigned long long)result->uart_tx,
+                result->flash_erase, result->flash_erase_us / 1e3,
+                result->flash_program, result->flash_program_us / 1e3,
+                result->flash_read_us / 1e3, result->flash_violation,
+                result->protocol == BENCH_PROTOCOL_WINDOW ? "window" : "ymodem", _cfg.noise,
+                result->corrupted, result->naks, result->window, result->ext_len, is_compress, _cfg.delta_percent,
+                result->resume_offset, _cfg.modify_percent, result->nego_baud, result->baud_fails);
+        return;
+    }
+
+    fprintf(fp, "%s  {\n", is_first ? "" : ",\n");
+    fprintf(fp, "    \"variant\": \"%s\", \"size\": %u, \"encrypt\": %u, \"compress\": %u, \"delta\": %u, \"modify\": %u, \"baud\": %u,\n",
+            variant->label, size, is_encrypt, is_compress, _cfg.delta_percent, _cfg.modify_percent, baud);
+    fprintf(fp, "    \"model\": \"%s\", \"time_scale\": %u, \"result\": \"%s\", \"fpk_size\": %u,\n",
+            _cfg.model, _cfg.time_scale, result->is_ok ? "ok" : result->error, result->fpk_size);
+    fprintf(fp, "    \"total_ms\": %.3f, \"transfer_ms\": %.3f, \"throughput_Bps\": %.0f,\n",
+            result->total_ns / 1e6, result->transfer_ns / 1e6, throughput);
+    fprintf(fp, "    \"stages_ms\": {");
+    for (uint32_t i = 0; i < BENCH_REPORT_FLOW_NUM; i++)
+        fprintf(fp, "\"%s\": %.3f, ", _report_flow[i], _FlowTime(result, _report_flow[i]) / 1e6);
+    fprintf(fp, "\"wait\": %.3f},\n", wait_ns / 1e6);
+    fprintf(fp, "    \"flows_ms\": {");
+    for (uint32_t i = 0; i < result->flow_num; i++)
+        fprintf(fp, "%s\"%s\": %.3f", i ? ", " : "", result->flow_name[i], result->flow_ns[i] / 1e6);
+    fprintf(fp, "},\n");
+    fprintf(fp, "    \"perf\": {");
+    for (uint32_t i = 0; i < result->perf_num; i++)
+        fprintf(fp, "%s\"%s\": {\"count\": %u, \"total_ms\": %.3f, \"max_us\": %u}", i ? ", " : "",
+                result->perf_name[i], result->perf_count[i], result->perf_total_us[i] / 1e3, result->perf_max_us[i]);
+    fprintf(fp, "},\n");
+    fprintf(fp, "    \"ymodem\": {\"frames\": %u, \"retries\": %u, \"ymodem_g\": %s, \"ext\": %u, \"resume\": %u, "
+                "\"nego_baud\": %u, \"baud_fails\": %u},\n",
+            result->frames, result->retries, result->is_ymodem_g ? "true" : "false", result->ext_len,
+            result->resume_offset, result->nego_baud, result->baud_fails);
+    fprintf(fp, "    \"transfer\": {\"protocol\": \"%s\", \"noise\": %g, \"corrupted\": %u, \"naks\": %u, \"window\": %u},\n",
+            result->protocol == BENCH_PROTOCOL_WINDOW ? "window" : "ymodem", _cfg.noise,
+            result->corrupted, result->naks, result->window);
+    fprintf(fp, "    \"uart\": {\"rx\": %llu, \"tx\": %llu},\n",
+            (unsigned long long)result->uart_rx, (unsigned long long)result->uart_tx);
+    fprintf(fp, "    \"flash\": {\"erase\": %u, \"erase_ms\": %.3f, \"program\": %u, \"program_ms\": %.3f, "
+                "\"read_ms\": %.3f, \"violation\": %u}\n",
+            result->flash_erase, result->flash_erase_us / 1e3, result->flash_program, 
+            result->flash_program_us / 1e3, result->flash_read_us / 1e3, result->flash_violation);
+    fprintf(fp, "  }");
+}
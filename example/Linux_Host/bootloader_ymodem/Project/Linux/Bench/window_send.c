@@ -0,0 +1,463 @@
+/**
+ * \file            window_send.c
+ * \brief           sliding window protocol sender for the host benchmark
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include "window_send.h"
+
+
+/* Private typedef -----------------------------------------------------------*/
+/* 设备回复的一帧 */
+struct WINDOW_REPLY
+{
+    uint8_t     type;
+    uint16_t    seq;
+    uint16_t    len;
+    uint8_t     payload[16];
+};
+
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t      _rx_buff[256];              /* 设备回复的接收缓存 */
+static uint16_t     _rx_len;
+
+
+/* Private function prototypes -----------------------------------------------*/
+static bool                 _WaitHandshake  (struct WINDOW_SENDER *ws);
+static bool                 _ReadReply      (struct WINDOW_SENDER *ws, uint32_t timeout_ms, struct WINDOW_REPLY *reply);
+static bool                 _ParseReply     (struct WINDOW_REPLY *reply);
+static int                  _SendFrame      (struct WINDOW_SENDER *ws, uint8_t type, uint16_t seq,
+                                             const uint8_t *payload, uint16_t len, bool is_noise);
+static int                  _SendData       (struct WINDOW_SENDER *ws, const uint8_t *data, uint32_t size, uint32_t seq);
+static int                  _WriteAll       (int fd, const uint8_t *data, uint32_t len);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  按滑动窗口协议发送一个文件
+ * @note   阻塞至发送完成或失败，数据帧按 1024 byte 切分，最后一帧与 YModem 相同补 0x1A
+ * @param[in]  ws: 发送对象
+ * @param[in]  file_name: 文件名
+ * @param[in]  data: 文件内容
+ * @param[in]  size: 文件大小，单位 byte
+ * @retval YMODEM_SEND_RESULT
+ */
+YMODEM_SEND_RESULT Window_Send(struct WINDOW_SENDER *ws, const char *file_name, const uint8_t *data, uint32_t size)
+{
+    uint8_t  info[128] = {0};
+    uint8_t  retry;
+    uint8_t  window;
+    uint32_t total = (size + WINDOW_DATA_LEN - 1) / WINDOW_DATA_LEN;
+    uint32_t base  = 0;
+    uint32_t next  = 0;
+    uint64_t deadline;
+    bool    *acked;
+    bool     is_ready = false;
+    struct WINDOW_REPLY reply;
+    YMODEM_SEND_RESULT result = YMODEM_SEND_TIMEOUT;
+
+    ws->frames      = 0;
+    ws->retries     = 0;
+    ws->naks        = 0;
+    ws->timeouts    = 0;
+    ws->corrupted   = 0;
+    ws->window_used = 0;
+    _rx_len = 0;
+
+    if (_WaitHandshake(ws) == false)
+        return YMODEM_SEND_TIMEOUT;
+    ws->start_ns = YModem_Now();
+
+    /* START ：文件名和文件大小，与 YModem 的第 0 帧相同 */
+    snprintf((char *)info, sizeof(info) - 16, "%s", file_name);
+    snprintf((char *)&info[strlen((char *)info) + 1], 16, "%u", size);
+    for (retry = 0; retry <= ws->max_retry && is_ready == false; retry++)
+    {
+        if (_SendFrame(ws, WINDOW_TYPE_START, 0, info, sizeof(info), false) != 0)
+            return YMODEM_SEND_IO_ERR;
+
+        /* 设备处理文件信息期间会定时回复 ACK */
+        while (_ReadReply(ws, ws->timeout_ms, &reply))
+        {
+            if (reply.type == WINDOW_TYPE_READY && reply.len >= 3)
+            {
+                is_ready = true;
+                window   = reply.payload[0];
+                break;
+            }
+            if (reply.type == WINDOW_TYPE_ABORT)
+                return YMODEM_SEND_CANCEL;
+        }
+    }
+    if (is_ready == false)
+        return YMODEM_SEND_TIMEOUT;
+
+    if (window > ws->window)
+        window = ws->window;
+    if (window > WINDOW_MAX_FRAME_NUM)
+        window = WINDOW_MAX_FRAME_NUM;
+    if (window == 0)
+        window = 1;
+    ws->window_used = window;
+
+    acked = calloc(total ? total : 1, sizeof(bool));
+    if (acked == NULL)
+        return YMODEM_SEND_IO_ERR;
+
+    /* 数据帧 */
+    retry    = 0;
+    deadline = YModem_Now() + (uint64_t)ws->rto_ms * 1000000;
+    while (base < total)
+    {
+        uint64_t now;
+
+        /* 窗口未满，继续发送新的帧 */
+        if (next < total && next - base < window)
+        {
+            if (_SendData(ws, data, size, next) != 0)
+            {
+                result = YMODEM_SEND_IO_ERR;
+                goto __exit;
+            }
+            next++;
+
+            /* 不等待，处理已到达的应答 */
+            if (_ReadReply(ws, 0, &reply) == false)
+                continue;
+        }
+        else
+        {
+            now = YModem_Now();
+            if (now >= deadline || _ReadReply(ws, (deadline - now) / 1000000 + 1, &reply) == false)
+            {
+                /* 超时没有任何应答，重发最早未确认的帧 */
+                uint32_t seq = base;
+                while (seq < next && acked[seq])
+                    seq++;
+
+                if (++retry > ws->max_retry)
+                    goto __exit;
+
+                ws->timeouts++;
+                ws->retries++;
+                if (seq < next)
+                {
+                    if (_SendData(ws, data, size, seq) != 0)
+                    {
+                        result = YMODEM_SEND_IO_ERR;
+                        goto __exit;
+                    }
+                }
+                deadline = YModem_Now() + (uint64_t)ws->rto_ms * 1000000;
+                continue;
+            }
+        }
+
+        /* 任何应答都说明设备仍在处理，推迟超时重发 */
+        retry    = 0;
+        deadline = YModem_Now() + (uint64_t)ws->rto_ms * 1000000;
+
+        if (reply.type == WINDOW_TYPE_ABORT)
+        {
+            result = YMODEM_SEND_CANCEL;
+            goto __exit;
+        }
+
+        if (reply.type == WINDOW_TYPE_ACK)
+        {
+            /* 16 bit 序号按 base 展开 */
+            uint32_t cum = base + (uint16_t)(reply.seq - (uint16_t)base);
+            uint32_t sack = 0;
+
+            if (cum > next)
+                continue;
+
+            while (base < cum)
+                acked[base++] = true;
+
+            if (reply.len >= 4)
+                sack = reply.payload[0] | (reply.payload[1] << 8) | (reply.payload[2] << 16) | ((uint32_t)reply.payload[3] << 24);
+            for (uint32_t n = 0; n < 32 && cum + 1 + n < next; n++)
+            {
+                if (sack & (1UL << n))
+                    acked[cum + 1 + n] = true;
+            }
+        }
+        else if (reply.type == WINDOW_TYPE_NAK)
+        {
+            uint32_t seq = base + (uint16_t)(reply.seq - (uint16_t)base);
+
+            ws->naks++;
+            if (seq < next && acked[seq] == false)
+            {
+                ws->retries++;
+                if (_SendData(ws, data, size, seq) != 0)
+                {
+                    result = YMODEM_SEND_IO_ERR;
+                    goto __exit;
+                }
+            }
+        }
+    }
+
+    /* END ， seq 为数据帧总数，设备处理 EOT 和空的 SOH 期间会定时回复 ACK */
+    for (retry = 0; retry <= ws->max_retry; retry++)
+    {
+        if (_SendFrame(ws, WINDOW_TYPE_END, total, NULL, 0, false) != 0)
+        {
+            result = YMODEM_SEND_IO_ERR;
+            goto __exit;
+        }
+
+        while (_ReadReply(ws, ws->timeout_ms, &reply))
+        {
+            if (reply.type == WINDOW_TYPE_FINISH)
+            {
+                ws->done_ns = YModem_Now();
+                result = YMODEM_SEND_OK;
+                goto __exit;
+            }
+            if (reply.type == WINDOW_TYPE_ABORT)
+            {
+                result = YMODEM_SEND_CANCEL;
+                goto __exit;
+            }
+        }
+    }
+
+__exit:
+    free(acked);
+    return result;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  等待接收方的握手字符
+ * @note   'C' 或 'G' 均可
+ * @param[in]  ws: 发送对象
+ * @retval true: 收到。 false: 超时
+ */
+static bool _WaitHandshake(struct WINDOW_SENDER *ws)
+{
+    uint64_t deadline = YModem_Now() + (uint64_t)ws->timeout_ms * 1000000;
+    struct pollfd pfd = { .fd = ws->fd, .events = POLLIN };
+
+    while (YModem_Now() < deadline)
+    {
+        uint8_t ch;
+
+        if (poll(&pfd, 1, ws->timeout_ms) <= 0 || (pfd.revents & POLLIN) == 0)
+            continue;
+        if (read(ws->fd, &ch, 1) == 1 && (ch == YMODEM_C || ch == YMODEM_G))
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief  读取设备回复的一帧
+ * @note   跳过帧头前的数据（如残留的握手字符）和校验错误的帧
+ * @param[in]   ws: 发送对象
+ * @param[in]   timeout_ms: 超时时间，单位 ms ， 0: 只处理已到达的数据
+ * @param[out]  reply: 收到的帧
+ * @retval true: 收到。 false: 超时或出错
+ */
+static bool _ReadReply(struct WINDOW_SENDER *ws, uint32_t timeout_ms, struct WINDOW_REPLY *reply)
+{
+    uint64_t deadline = YModem_Now() + (uint64_t)timeout_ms * 1000000;
+    struct pollfd pfd = { .fd = ws->fd, .events = POLLIN };
+
+    while (1)
+    {
+        uint64_t now;
+        ssize_t  n;
+
+        if (_ParseReply(reply))
+            return true;
+
+        now = YModem_Now();
+        if (poll(&pfd, 1, now < deadline ? (deadline - now) / 1000000 + 1 : 0) <= 0 || (pfd.revents & POLLIN) == 0)
+            return false;
+
+        n = read(ws->fd, &_rx_buff[_rx_len], sizeof(_rx_buff) - _rx_len);
+        if (n <= 0)
+            return false;
+        _rx_len += n;
+    }
+}
+
+
+/**
+ * @brief  从接收缓存中解析一帧
+ * @note
+ * @param[out]  reply: 解析出的帧
+ * @retval true: 成功。 false: 数据不足
+ */
+static bool _ParseReply(struct WINDOW_REPLY *reply)
+{
+    while (_rx_len)
+    {
+        uint16_t len, frame_len, crc;
+        uint16_t skip = 1;
+
+        if (_rx_buff[0] == WINDOW_SOF)
+        {
+            if (_rx_len < WINDOW_HEAD_LEN)
+                return false;
+
+            len = _rx_buff[4] | (_rx_buff[5] << 8);
+            if (len <= sizeof(reply->payload))
+            {
+                frame_len = WINDOW_FRAME_FIXED_LEN + len;
+                if (_rx_len < frame_len)
+                    return false;
+
+                crc = YModem_CRC16(&_rx_buff[1], WINDOW_HEAD_LEN - 1 + len);
+                if (crc == (_rx_buff[frame_len - 2] | (_rx_buff[frame_len - 1] << 8)))
+                {
+                    reply->type = _rx_buff[1];
+                    reply->seq  = _rx_buff[2] | (_rx_buff[3] << 8);
+                    reply->len  = len;
+                    memcpy(reply->payload, &_rx_buff[WINDOW_HEAD_LEN], len);
+                    skip = frame_len;
+                }
+            }
+        }
+
+        _rx_len -= skip;
+        memmove(&_rx_buff[0], &_rx_buff[skip], _rx_len);
+        if (skip > 1)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief  发送一帧
+ * @note   is_noise 为 true 时，按 noise 的概率破坏数据中的一个字节
+ * @param[in]  ws: 发送对象
+ * @param[in]  type: 帧类型
+ * @param[in]  seq: 序号，只取低 16 bit
+ * @param[in]  payload: 数据，可为 NULL
+ * @param[in]  len: 数据长度，单位 byte
+ * @param[in]  is_noise: 是否模拟线路干扰
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _SendFrame(struct WINDOW_SENDER *ws, uint8_t type, uint16_t seq,
+                      const uint8_t *payload, uint16_t len, bool is_noise)
+{
+    uint8_t  frame[WINDOW_FRAME_FIXED_LEN + WINDOW_DATA_LEN];
+    uint16_t crc;
+
+    frame[0] = WINDOW_SOF;
+    frame[1] = type;
+    frame[2] = seq;
+    frame[3] = seq >> 8;
+    frame[4] = len;
+    frame[5] = len >> 8;
+    if (len)
+        memcpy(&frame[WINDOW_HEAD_LEN], payload, len);
+    crc = YModem_CRC16(&frame[1], WINDOW_HEAD_LEN - 1 + len);
+    frame[WINDOW_HEAD_LEN + len]     = crc;
+    frame[WINDOW_HEAD_LEN + len + 1] = crc >> 8;
+
+    if (is_noise && len && ws->noise > 0 && rand_r(&ws->seed) < ws->noise * RAND_MAX)
+    {
+        frame[WINDOW_HEAD_LEN + rand_r(&ws->seed) % len] ^= 0xFF;
+        ws->corrupted++;
+    }
+
+    ws->frames++;
+    return _WriteAll(ws->fd, frame, WINDOW_FRAME_FIXED_LEN + len);
+}
+
+
+/**
+ * @brief  发送一个数据帧
+ * @note   数据按 1024 byte 切分，不足时补 0x1A
+ * @param[in]  ws: 发送对象
+ * @param[in]  data: 文件内容
+ * @param[in]  size: 文件大小，单位 byte
+ * @param[in]  seq: 数据帧序号
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _SendData(struct WINDOW_SENDER *ws, const uint8_t *data, uint32_t size, uint32_t seq)
+{
+    uint32_t posit = seq * WINDOW_DATA_LEN;
+    uint32_t len   = (size - posit) < WINDOW_DATA_LEN ? (size - posit) : WINDOW_DATA_LEN;
+    uint8_t  payload[WINDOW_DATA_LEN];
+
+    memcpy(payload, &data[posit], len);
+    memset(&payload[len], YMODEM_PAD, WINDOW_DATA_LEN - len);
+
+    return _SendFrame(ws, WINDOW_TYPE_DATA, seq, payload, WINDOW_DATA_LEN, true);
+}
+
+
+/**
+ * @brief  写入全部数据
+ * @note
+ * @param[in]  fd: 文件描述符
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _WriteAll(int fd, const uint8_t *data, uint32_t len)
+{
+    while (len)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1;
+        }
+        data += n;
+        len  -= n;
+    }
+
+    return 0;
+}
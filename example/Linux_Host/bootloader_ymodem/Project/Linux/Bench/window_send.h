@@ -0,0 +1,90 @@
+/**
+ * \file            window_send.h
+ * \brief           sliding window protocol sender for the host benchmark
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ */
+
+#ifndef __WINDOW_SEND_H__
+#define __WINDOW_SEND_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ymodem_send.h"
+
+/**
+ * 滑动窗口协议的发送流程，帧结构与 bootloader 的 protocol_window.h 相同：
+ *    等待 'C' 或 'G' -> START （与 YModem 第 0 帧相同的文件信息） -> READY （设备的窗口大小）
+ *    -> 连续发送 DATA ，未确认的帧不超过窗口大小，收到 ACK 后窗口前移，按 SACK 位图跳过已收到的帧
+ *    -> 收到 NAK 立即重发该帧， rto_ms 内没有任何应答时重发最早未确认的帧
+ *    -> 全部确认后发送 END -> FINISH
+ *    收到 ABORT 即结束
+ */
+
+#define WINDOW_SOF                  0xA5
+#define WINDOW_TYPE_START           0x01
+#define WINDOW_TYPE_DATA            0x02
+#define WINDOW_TYPE_END             0x03
+#define WINDOW_TYPE_ACK             0x06
+#define WINDOW_TYPE_NAK             0x15
+#define WINDOW_TYPE_ABORT           0x18
+#define WINDOW_TYPE_READY           0x81
+#define WINDOW_TYPE_FINISH          0x83
+
+#define WINDOW_HEAD_LEN             6
+#define WINDOW_FRAME_FIXED_LEN      8
+#define WINDOW_DATA_LEN             1024
+#define WINDOW_MAX_FRAME_NUM        32
+
+struct WINDOW_SENDER
+{
+    int         fd;                             /* 已打开的串口或 PTY */
+    uint32_t    timeout_ms;                     /* 握手、 START 和 END 等待应答的超时时间，单位 ms */
+    uint32_t    rto_ms;                         /* 数据帧的重发超时，单位 ms ，需大于设备的 PW_KEEPALIVE_TIME 和一帧的传输时间 */
+    uint8_t     max_retry;                      /* 连续超时的最多次数 */
+    uint8_t     window;                         /* 主机的窗口大小，实际取与设备 READY 中的较小值 */
+    double      noise;                          /* 每个数据帧被破坏一个字节的概率，模拟线路干扰 */
+    unsigned    seed;                           /* noise 的随机数种子 */
+
+    /* 统计 */
+    uint8_t     window_used;                    /* 实际的窗口大小 */
+    uint32_t    frames;                         /* 发送的帧数，包含重发 */
+    uint32_t    retries;                        /* 重发的数据帧数 */
+    uint32_t    naks;                           /* 收到的 NAK 数 */
+    uint32_t    timeouts;                       /* 超时重发的次数 */
+    uint32_t    corrupted;                      /* 被 noise 破坏的数据帧数 */
+    uint64_t    start_ns;                       /* 收到第一个 'C' 或 'G' 的时刻 */
+    uint64_t    done_ns;                        /* 收到 FINISH 的时刻 */
+};
+
+YMODEM_SEND_RESULT  Window_Send     (struct WINDOW_SENDER *ws, const char *file_name, const uint8_t *data, uint32_t size);
+
+#endif
@@ -0,0 +1,803 @@
+/**
+ * \file            ymodem_send.c
+ * \brief           YModem-1K sender for the host benchmark
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 YModem-G 的发送流程
+ * v1.2     2026-10-18                  增加模拟线路干扰的 noise
+ * v1.3     2026-10-18                  增加扩展数据帧的协商和发送
+ * v1.4     2026-10-18                  增加断点续传的协商，可在指定位置中断发送
+ * v1.5     2026-10-18                  增加波特率的协商
+ * v1.6     2026-10-18                  YModem-G 的接收方应答第 0 帧时改按 YModem 发送
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "ymodem_send.h"
+
+
+/* Private variables ---------------------------------------------------------*/
+/* termios 的波特率常量与数值的对应关系 */
+static const struct
+{
+    speed_t     speed;
+    uint32_t    baudrate;
+
+} _speed_table[] = 
+{
+    { B9600,    9600    }, { B19200,   19200   }, { B38400,   38400   }, { B57600,   57600   },
+    { B115200,  115200  }, { B230400,  230400  }, { B460800,  460800  }, { B500000,  500000  },
+    { B576000,  576000  }, { B921600,  921600  }, { B1000000, 1000000 }, { B1152000, 1152000 },
+    { B1500000, 1500000 }, { B2000000, 2000000 }, { B2500000, 2500000 }, { B3000000, 3000000 },
+    { B3500000, 3500000 }, { B4000000, 4000000 },
+};
+
+static const uint8_t _probe[YMODEM_PROBE_LEN] = { YMODEM_PROBE, 0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC };
+
+
+/* Private function prototypes -----------------------------------------------*/
+static YMODEM_SEND_RESULT   _SendFile       (struct YMODEM_SENDER *ys, const char *file_name, const uint8_t *data, uint32_t size);
+static int                  _NegotiateBaud  (struct YMODEM_SENDER *ys, uint32_t origin, uint8_t hs_ch);
+static int                  _ReadBaudReply  (struct YMODEM_SENDER *ys, uint32_t *baudrate);
+static bool                 _Probe          (struct YMODEM_SENDER *ys);
+static uint32_t             _GetBaudRate    (int fd);
+static int                  _SetBaudRate    (int fd, uint32_t baudrate);
+static int                  _ReadByte       (struct YMODEM_SENDER *ys, uint32_t timeout_ms);
+static bool                 _WaitByte       (struct YMODEM_SENDER *ys, uint8_t expect);
+static int                  _WaitHandshake  (struct YMODEM_SENDER *ys);
+static int                  _WaitStart      (struct YMODEM_SENDER *ys, uint8_t hs_ch);
+static YMODEM_SEND_RESULT   _ReadResume     (struct YMODEM_SENDER *ys, uint32_t size);
+static uint16_t             _BuildFrame     (uint8_t *frame, uint8_t seq, const uint8_t *data, uint32_t len, uint16_t frame_size);
+static YMODEM_SEND_RESULT   _SendFrame      (struct YMODEM_SENDER *ys, uint8_t seq, const uint8_t *data, 
+                                             uint32_t len, uint16_t frame_size, uint8_t wait_ch);
+static int                  _WriteFrame     (struct YMODEM_SENDER *ys, const uint8_t *frame, uint16_t frame_len);
+static int                  _WriteAll       (int fd, const uint8_t *data, uint32_t len);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  计算 YModem 的 CRC16
+ * @note   CRC16/XMODEM ，多项式 0x1021 ，初值 0
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval CRC16 值
+ */
+uint16_t YModem_CRC16(const uint8_t *data, uint32_t len)
+{
+    uint16_t crc = 0;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t j = 0; j < 8; j++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+
+    return crc;
+}
+
+
+/**
+ * @brief  计算扩展数据帧的 CRC32
+ * @note   CRC-32 ，多项式 0xEDB88320 （反射），初值和结果异或值均为 0xFFFFFFFF ，与 bootloader 的 crc32() 相同
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval CRC32 值
+ */
+uint32_t YModem_CRC32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t j = 0; j < 8; j++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : (crc >> 1);
+    }
+
+    return ~crc;
+}
+
+
+/**
+ * @brief  发送一个文件
+ * @note   阻塞至发送完成或失败，协商过波特率时恢复串口原来的波特率
+ * @param[in]  ys: 发送对象
+ * @param[in]  file_name: 文件名
+ * @param[in]  data: 文件内容
+ * @param[in]  size: 文件大小，单位 byte
+ * @retval YMODEM_SEND_RESULT
+ */
+YMODEM_SEND_RESULT YModem_Send(struct YMODEM_SENDER *ys, const char *file_name, const uint8_t *data, uint32_t size)
+{
+    uint32_t origin = _GetBaudRate(ys->fd);
+    YMODEM_SEND_RESULT result;
+
+    ys->baudrate   = 0;
+    ys->baud_fails = 0;
+    result = _SendFile(ys, file_name, data, size);
+
+    if (ys->baudrate && origin)
+    {
+        tcdrain(ys->fd);
+        _SetBaudRate(ys->fd, origin);
+    }
+
+    return result;
+}
+
+
+/**
+ * @brief  获取当前时刻
+ * @note   与主机仿真的 trace 同为 CLOCK_MONOTONIC
+ * @retval 单位 ns
+ */
+uint64_t YModem_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  发送一个文件
+ * @note   
+ * @param[in]  ys: 发送对象
+ * @param[in]  file_name: 文件名
+ * @param[in]  data: 文件内容
+ * @param[in]  size: 文件大小，单位 byte
+ * @retval YMODEM_SEND_RESULT
+ */
+static YMODEM_SEND_RESULT _SendFile(struct YMODEM_SENDER *ys, const char *file_name, const uint8_t *data, uint32_t size)
+{
+    uint8_t  info[128] = {0};
+    uint8_t  seq = 1;
+    uint8_t  retry;
+    uint8_t  hs_ch;
+    uint16_t frame_size = 1024;
+    uint32_t posit;
+    YMODEM_SEND_RESULT result;
+
+    ys->frames    = 0;
+    ys->retries   = 0;
+    ys->corrupted = 0;
+    ys->is_g      = false;
+    ys->is_ext    = false;
+    ys->resume_offset = 0;
+
+    /* 等待接收方的 'C' 或 'G' */
+    int ch = _WaitHandshake(ys);
+    if (ch < 0)
+        return YMODEM_SEND_TIMEOUT;
+    ys->start_ns = YModem_Now();
+    ys->is_g     = (ch == YMODEM_G);
+    hs_ch        = (uint8_t)ch;
+
+    /* 第 0 帧之前协商波特率 */
+    if (ys->baud_num && _NegotiateBaud(ys, _GetBaudRate(ys->fd), hs_ch) != 0)
+        return YMODEM_SEND_TIMEOUT;
+
+    /* 第 0 帧：文件名、文件大小、扩展数据帧和断点续传的请求， YModem-G 以 'G' 代替 ACK 、 'C' */
+    snprintf((char *)info, sizeof(info) - 48, "%s", file_name);
+    uint32_t info_len = strlen((char *)info) + 1;
+    snprintf((char *)&info[info_len], 16, "%u", size);
+    info_len += strlen((char *)&info[info_len]) + 1;
+    if (ys->ext_len)
+        snprintf((char *)&info[info_len], 16, "EXT=%u", ys->ext_len);
+    if (ys->resume)
+    {
+        info_len += strlen((char *)&info[info_len]);
+        snprintf((char *)&info[info_len], 16, "%sRESUME", ys->ext_len ? " " : "");
+    }
+
+    if (ys->is_g)
+    {
+        uint8_t  frame[3 + 128 + 2];
+        uint16_t frame_len = _BuildFrame(frame, 0, info, sizeof(info), 128);
+
+        ys->frames++;
+        if (_WriteAll(ys->fd, frame, frame_len) != 0)
+            return YMODEM_SEND_IO_ERR;
+    }
+    else
+    {
+        result = _SendFrame(ys, 0, info, sizeof(info), 128, 0);
+        if (result != YMODEM_SEND_OK)
+            return result;
+    }
+
+    ch = _WaitStart(ys, hs_ch);
+    if (ch < 0)
+        return YMODEM_SEND_TIMEOUT;
+    ys->is_ext = (ch == YMODEM_E);
+
+    /* 接收方已改按 YModem 传输，结束传输时同样以 'C' 握手 */
+    if (ys->is_g == false)
+        hs_ch = YMODEM_C;
+
+    /* 数据帧， YModem-G 只等待第 1 帧（固件包头）的 ACK ，其余连续发送 */
+    for (posit = 0; posit < size; posit += frame_size, seq++)
+    {
+        if (ys->drop_size && posit >= ys->drop_size)
+            return YMODEM_SEND_DROP;
+
+        /* 固件包头所在的第 1 帧固定为 STX 数据帧 */
+        frame_size = (ys->is_ext && posit) ? ys->ext_len : 1024;
+        uint32_t len = (size - posit) < frame_size ? (size - posit) : frame_size;
+
+        if (ys->is_g && posit)
+        {
+            uint8_t  frame[3 + YMODEM_EXT_MAX_LEN + 4];
+            uint16_t frame_len = _BuildFrame(frame, seq, &data[posit], len, frame_size);
+
+            ys->frames++;
+            if (_WriteFrame(ys, frame, frame_len) != 0)
+                return YMODEM_SEND_IO_ERR;
+            if (_ReadByte(ys, 0) == YMODEM_CAN)
+                return YMODEM_SEND_CANCEL;
+            continue;
+        }
+
+        result = _SendFrame(ys, seq, &data[posit], len, frame_size, 0);
+        if (result != YMODEM_SEND_OK)
+            return result;
+
+        /* 第 1 帧的 ACK 之后是续传位置，跳过接收方已写入的包体 */
+        if (posit == 0 && ys->resume)
+        {
+            result = _ReadResume(ys, size - len);
+            if (result != YMODEM_SEND_OK)
+                return result;
+            posit += ys->resume_offset;
+        }
+    }
+
+    /* 结束传输：第一个 EOT 应答 NAK ，第二个 EOT 应答 ACK 和 'C' */
+    for (retry = 0; retry <= ys->max_retry; retry++)
+    {
+        uint8_t eot = YMODEM_EOT;
+
+        if (_WriteAll(ys->fd, &eot, 1) != 0)
+            return YMODEM_SEND_IO_ERR;
+
+        do
+        {
+            ch = _ReadByte(ys, ys->timeout_ms);
+        } while (ch == YMODEM_C || ch == YMODEM_G || ch == YMODEM_E);
+
+        if (ch == YMODEM_ACK)
+            break;
+        if (ch == YMODEM_CAN)
+            return YMODEM_SEND_CANCEL;
+    }
+    if (retry > ys->max_retry)
+        return YMODEM_SEND_TIMEOUT;
+
+    if (_WaitByte(ys, hs_ch) == false)
+        return YMODEM_SEND_TIMEOUT;
+
+    /* 空的第 0 帧，结束会话 */
+    memset(info, 0, sizeof(info));
+    result = _SendFrame(ys, 0, info, sizeof(info), 128, 0);
+    ys->done_ns = YModem_Now();
+
+    return result;
+}
+
+
+/**
+ * @brief  协商波特率
+ * @note   依次请求 baud 中剩余的波特率，直至协商成功、接收方选择不切换或不支持
+ * @param[in]  ys: 发送对象
+ * @param[in]  origin: 串口当前的波特率
+ * @param[in]  hs_ch: 会话开始时的握手字符
+ * @retval 0: 以 ys->baudrate 或原波特率继续发送。 -1: 恢复原波特率后没有等到握手字符
+ */
+static int _NegotiateBaud(struct YMODEM_SENDER *ys, uint32_t origin, uint8_t hs_ch)
+{
+    uint8_t start = 0;
+
+    while (start < ys->baud_num)
+    {
+        uint8_t  req[4 + 4 * YMODEM_BAUD_MAX_NUM];
+        uint8_t  num = ys->baud_num - start;
+        uint8_t  retry;
+        uint16_t crc;
+        uint32_t baudrate;
+
+        if (num > YMODEM_BAUD_MAX_NUM)
+            num = YMODEM_BAUD_MAX_NUM;
+
+        req[0] = YMODEM_BAUD;
+        req[1] = num;
+        for (uint8_t i = 0; i < num; i++)
+        {
+            req[2 + 4 * i]     = ys->baud[start + i] >> 24;
+            req[2 + 4 * i + 1] = ys->baud[start + i] >> 16;
+            req[2 + 4 * i + 2] = ys->baud[start + i] >> 8;
+            req[2 + 4 * i + 3] = ys->baud[start + i];
+        }
+        crc = YModem_CRC16(&req[1], 1 + 4 * num);
+        req[2 + 4 * num] = crc >> 8;
+        req[3 + 4 * num] = crc;
+
+        if (_WriteAll(ys->fd, req, 4 + 4 * num) != 0)
+            return -1;
+
+        /* 没有应答或应答有误时视为不支持，以原波特率继续 */
+        if (_ReadBaudReply(ys, &baudrate) != 0 || baudrate == 0 || baudrate == origin)
+            return 0;
+
+        /* 接收方在应答发送完毕后才切换，稍作等待再发送探测帧 */
+        if (_SetBaudRate(ys->fd, baudrate) == 0)
+        {
+            usleep(2000);
+            if (_Probe(ys))
+            {
+                ys->baudrate = baudrate;
+                return 0;
+            }
+        }
+
+        /* 探测失败，恢复原波特率，接收方超时后同样恢复并重新发送握手字符 */
+        ys->baud_fails++;
+        _SetBaudRate(ys->fd, origin);
+        tcflush(ys->fd, TCIOFLUSH);
+
+        for (retry = 0; retry < 3 && _WaitByte(ys, hs_ch) == false; retry++);
+        if (retry == 3)
+            return -1;
+
+        /* 去掉失败的及优先级更高的波特率 */
+        while (start < ys->baud_num && ys->baud[start] != baudrate)
+            start++;
+        start++;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief  读取波特率协商的应答
+ * @note   跳过应答前可能残留的握手字符
+ * @param[in]  ys: 发送对象
+ * @param[out] baudrate: 接收方选择的波特率
+ * @retval 0: 成功。 -1: 超时或应答有误
+ */
+static int _ReadBaudReply(struct YMODEM_SENDER *ys, uint32_t *baudrate)
+{
+    uint8_t reply[YMODEM_BAUD_REPLY_LEN];
+    int     ch;
+
+    do
+    {
+        ch = _ReadByte(ys, ys->timeout_ms);
+    } while (ch == YMODEM_C || ch == YMODEM_G);
+
+    if (ch != YMODEM_BAUD)
+        return -1;
+
+    reply[0] = ch;
+    for (uint8_t i = 1; i < YMODEM_BAUD_REPLY_LEN; i++)
+    {
+        ch = _ReadByte(ys, ys->timeout_ms);
+        if (ch < 0)
+            return -1;
+        reply[i] = ch;
+    }
+
+    if (YModem_CRC16(&reply[1], 4) != (((uint16_t)reply[5] << 8) | reply[6]))
+        return -1;
+
+    *baudrate = ((uint32_t)reply[1] << 24) | ((uint32_t)reply[2] << 16) | ((uint32_t)reply[3] << 8) | reply[4];
+
+    return 0;
+}
+
+
+/**
+ * @brief  在新波特率下发送探测帧
+ * @note   接收方按断帧间隔（ 100 ms ）取出一帧数据后才回送，因此每次等待 400 ms ，最多发送 2 次，期间收到的乱码均丢弃
+ * @param[in]  ys: 发送对象
+ * @retval true: 收到原样的回送。 false: 失败
+ */
+static bool _Probe(struct YMODEM_SENDER *ys)
+{
+    uint8_t buff[YMODEM_PROBE_LEN];
+
+    for (uint8_t retry = 0; retry < 2; retry++)
+    {
+        uint64_t deadline = YModem_Now() + 400000000ULL;
+        uint8_t  len = 0;
+
+        if (_WriteAll(ys->fd, _probe, YMODEM_PROBE_LEN) != 0)
+            return false;
+
+        while (YModem_Now() < deadline)
+        {
+            int ch = _ReadByte(ys, 10);
+            if (ch < 0)
+                continue;
+
+            /* 滑动比较最近收到的 YMODEM_PROBE_LEN byte */
+            if (len == YMODEM_PROBE_LEN)
+            {
+                memmove(buff, &buff[1], YMODEM_PROBE_LEN - 1);
+                len--;
+            }
+            buff[len++] = ch;
+            if (len == YMODEM_PROBE_LEN && memcmp(buff, _probe, YMODEM_PROBE_LEN) == 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief  获取串口的波特率
+ * @note   
+ * @param[in]  fd: 文件描述符
+ * @retval 波特率， 0: 不在 _speed_table 中
+ */
+static uint32_t _GetBaudRate(int fd)
+{
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) != 0)
+        return 0;
+
+    for (size_t i = 0; i < sizeof(_speed_table) / sizeof(_speed_table[0]); i++)
+    {
+        if (_speed_table[i].speed == cfgetospeed(&tio))
+            return _speed_table[i].baudrate;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief  设置串口的波特率
+ * @note   
+ * @param[in]  fd: 文件描述符
+ * @param[in]  baudrate: 波特率，需在 _speed_table 中
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _SetBaudRate(int fd, uint32_t baudrate)
+{
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) != 0)
+        return -1;
+
+    for (size_t i = 0; i < sizeof(_speed_table) / sizeof(_speed_table[0]); i++)
+    {
+        if (_speed_table[i].baudrate == baudrate)
+        {
+            cfsetspeed(&tio, _speed_table[i].speed);
+            return tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief  读取一个字节
+ * @note   
+ * @param[in]  ys: 发送对象
+ * @param[in]  timeout_ms: 超时时间，单位 ms
+ * @retval 读到的字节， -1: 超时或出错
+ */
+static int _ReadByte(struct YMODEM_SENDER *ys, uint32_t timeout_ms)
+{
+    uint8_t ch;
+    struct pollfd pfd = { .fd = ys->fd, .events = POLLIN };
+
+    if (poll(&pfd, 1, timeout_ms) <= 0 || (pfd.revents & POLLIN) == 0)
+        return -1;
+
+    if (read(ys->fd, &ch, 1) != 1)
+        return -1;
+
+    return ch;
+}
+
+
+/**
+ * @brief  等待指定的字节
+ * @note   忽略期间收到的其他字节
+ * @param[in]  ys: 发送对象
+ * @param[in]  expect: 期望的字节
+ * @retval true: 收到。 false: 超时
+ */
+static bool _WaitByte(struct YMODEM_SENDER *ys, uint8_t expect)
+{
+    uint64_t deadline = YModem_Now() + (uint64_t)ys->timeout_ms * 1000000;
+
+    while (YModem_Now() < deadline)
+    {
+        if (_ReadByte(ys, ys->timeout_ms) == expect)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief  等待接收方的握手字符
+ * @note   未使能 YModem-G 时忽略 'G'
+ * @param[in]  ys: 发送对象
+ * @retval YMODEM_C 或 YMODEM_G ， -1: 超时
+ */
+static int _WaitHandshake(struct YMODEM_SENDER *ys)
+{
+    uint64_t deadline = YModem_Now() + (uint64_t)ys->timeout_ms * 1000000;
+
+    while (YModem_Now() < deadline)
+    {
+        int ch = _ReadByte(ys, ys->timeout_ms);
+        if (ch == YMODEM_C || (ch == YMODEM_G && ys->enable_g))
+            return ch;
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief  等待第 0 帧之后的握手字符
+ * @note   1. 请求了扩展数据帧时，接收方以 'E' 表示接受
+ *         2. YModem-G 的接收方不应答第 0 帧，收到 ACK 说明其 flash 写入跟不上，之后改按 YModem 发送，清除 ys->is_g
+ * @param[in]  ys: 发送对象
+ * @param[in]  hs_ch: 会话开始时的握手字符
+ * @retval hs_ch 、 YMODEM_C 或 YMODEM_E ， -1: 超时
+ */
+static int _WaitStart(struct YMODEM_SENDER *ys, uint8_t hs_ch)
+{
+    uint64_t deadline = YModem_Now() + (uint64_t)ys->timeout_ms * 1000000;
+
+    while (YModem_Now() < deadline)
+    {
+        int ch = _ReadByte(ys, ys->timeout_ms);
+        if (ch == YMODEM_ACK && ys->is_g)
+        {
+            ys->is_g = false;
+            hs_ch    = YMODEM_C;
+            continue;
+        }
+        if (ch == hs_ch || (ch == YMODEM_E && ys->ext_len))
+            return ch;
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief  读取断点续传的应答
+ * @note   超时视为接收方不支持断点续传，从头发送
+ * @param[in]  ys: 发送对象
+ * @param[in]  size: 第 1 帧之后的文件长度，单位 byte
+ * @retval YMODEM_SEND_RESULT
+ */
+static YMODEM_SEND_RESULT _ReadResume(struct YMODEM_SENDER *ys, uint32_t size)
+{
+    uint8_t reply[YMODEM_RESUME_REPLY_LEN];
+    int     ch;
+
+    do
+    {
+        ch = _ReadByte(ys, ys->timeout_ms);
+    } while (ch == YMODEM_C || ch == YMODEM_G || ch == YMODEM_E);
+
+    if (ch < 0)
+        return YMODEM_SEND_OK;
+    if (ch == YMODEM_CAN)
+        return YMODEM_SEND_CANCEL;
+    if (ch != YMODEM_RESUME)
+        return YMODEM_SEND_IO_ERR;
+
+    reply[0] = ch;
+    for (uint8_t i = 1; i < YMODEM_RESUME_REPLY_LEN; i++)
+    {
+        ch = _ReadByte(ys, ys->timeout_ms);
+        if (ch < 0)
+            return YMODEM_SEND_TIMEOUT;
+        reply[i] = ch;
+    }
+
+    if (YModem_CRC16(&reply[1], 4) != (((uint16_t)reply[5] << 8) | reply[6]))
+        return YMODEM_SEND_IO_ERR;
+
+    ys->resume_offset = ((uint32_t)reply[1] << 24) | ((uint32_t)reply[2] << 16) | ((uint32_t)reply[3] << 8) | reply[4];
+    if (ys->resume_offset > size)
+        return YMODEM_SEND_IO_ERR;
+
+    return YMODEM_SEND_OK;
+}
+
+
+/**
+ * @brief  组一帧数据
+ * @note   128 和 1024 byte 的数据帧以 CRC16 校验，扩展数据帧以 CRC32 校验，均为高字节在前
+ * @param[out] frame: 帧缓存，至少 3 + frame_size + 4 byte
+ * @param[in]  seq: 帧序号
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，不足 frame_size 时补 0x1A
+ * @param[in]  frame_size: 128 、 1024 或扩展数据帧的长度
+ * @retval 帧长度，单位 byte
+ */
+static uint16_t _BuildFrame(uint8_t *frame, uint8_t seq, const uint8_t *data, uint32_t len, uint16_t frame_size)
+{
+    frame[1] = seq;
+    frame[2] = ~seq;
+    memcpy(&frame[3], data, len);
+    memset(&frame[3 + len], YMODEM_PAD, frame_size - len);
+
+    if (frame_size != 128 && frame_size != 1024)
+    {
+        uint32_t crc = YModem_CRC32(&frame[3], frame_size);
+
+        frame[0] = YMODEM_STX_EXT;
+        frame[3 + frame_size]     = crc >> 24;
+        frame[3 + frame_size + 1] = crc >> 16;
+        frame[3 + frame_size + 2] = crc >> 8;
+        frame[3 + frame_size + 3] = crc;
+        return 3 + frame_size + 4;
+    }
+
+    uint16_t crc = YModem_CRC16(&frame[3], frame_size);
+
+    frame[0] = (frame_size == 1024) ? YMODEM_STX : YMODEM_SOH;
+    frame[3 + frame_size]     = crc >> 8;
+    frame[3 + frame_size + 1] = crc;
+
+    return 3 + frame_size + 2;
+}
+
+
+/**
+ * @brief  发送一帧并等待 ACK
+ * @note   收到 NAK 或超时时重发
+ * @param[in]  ys: 发送对象
+ * @param[in]  seq: 帧序号
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，不足 frame_size 时补 0x1A
+ * @param[in]  frame_size: 128 、 1024 或扩展数据帧的长度
+ * @param[in]  wait_ch: ACK 后还需等待的字符， 0: 不等待
+ * @retval YMODEM_SEND_RESULT
+ */
+static YMODEM_SEND_RESULT _SendFrame(struct YMODEM_SENDER *ys, uint8_t seq, const uint8_t *data, 
+                                     uint32_t len, uint16_t frame_size, uint8_t wait_ch)
+{
+    uint8_t  frame[3 + YMODEM_EXT_MAX_LEN + 4];
+    uint16_t frame_len = _BuildFrame(frame, seq, data, len, frame_size);
+
+    for (uint8_t retry = 0; retry <= ys->max_retry; retry++)
+    {
+        int ch;
+
+        if (retry)
+            ys->retries++;
+        ys->frames++;
+
+        if (_WriteFrame(ys, frame, frame_len) != 0)
+            return YMODEM_SEND_IO_ERR;
+
+        /* 跳过 ACK 前可能残留的 'C' 、 'G' 或 'E' */
+        do
+        {
+            ch = _ReadByte(ys, ys->timeout_ms);
+        } while (ch == YMODEM_C || ch == YMODEM_G || ch == YMODEM_E);
+
+        if (ch == YMODEM_ACK)
+        {
+            if (wait_ch && _WaitByte(ys, wait_ch) == false)
+                return YMODEM_SEND_TIMEOUT;
+            return YMODEM_SEND_OK;
+        }
+        if (ch == YMODEM_CAN)
+            return YMODEM_SEND_CANCEL;
+    }
+
+    return YMODEM_SEND_TIMEOUT;
+}
+
+
+/**
+ * @brief  发送一帧
+ * @note   数据帧按 noise 的概率破坏其中一个字节，原帧保持不变，供重发使用
+ * @param[in]  ys: 发送对象
+ * @param[in]  frame: 帧数据
+ * @param[in]  frame_len: 帧长度，单位 byte
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _WriteFrame(struct YMODEM_SENDER *ys, const uint8_t *frame, uint16_t frame_len)
+{
+    uint8_t buff[3 + YMODEM_EXT_MAX_LEN + 4];
+
+    if ((frame[0] == YMODEM_STX || frame[0] == YMODEM_STX_EXT) 
+    &&  ys->noise > 0 && rand_r(&ys->seed) < ys->noise * RAND_MAX)
+    {
+        uint16_t data_len = frame_len - ((frame[0] == YMODEM_STX) ? 5 : 7);
+
+        memcpy(buff, frame, frame_len);
+        buff[3 + rand_r(&ys->seed) % data_len] ^= 0xFF;
+        ys->corrupted++;
+        return _WriteAll(ys->fd, buff, frame_len);
+    }
+
+    return _WriteAll(ys->fd, frame, frame_len);
+}
+
+
+/**
+ * @brief  写入全部数据
+ * @note   
+ * @param[in]  fd: 文件描述符
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval 0: 成功。 -1: 失败
+ */
+static int _WriteAll(int fd, const uint8_t *data, uint32_t len)
+{
+    while (len)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1;
+        }
+        data += n;
+        len  -= n;
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file            ymodem_send.h
+ * \brief           YModem-1K sender for the host benchmark
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 YModem-G 的发送流程
+ * v1.2     2026-10-18                  增加模拟线路干扰的 noise
+ * v1.3     2026-10-18                  增加扩展数据帧的协商和发送
+ * v1.4     2026-10-18                  增加断点续传的协商，可在指定位置中断发送
+ * v1.5     2026-10-18                  增加波特率的协商
+ */
+
+#ifndef __YMODEM_SEND_H__
+#define __YMODEM_SEND_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * 与 YModem_Sender 上位机相同的发送流程：
+ *    等待 'C' -> 第 0 帧（文件名和大小） -> ACK 、 'C' -> 1024 byte 数据帧 ... -> EOT -> NAK -> EOT -> ACK 、 'C' -> 空的第 0 帧 -> ACK
+ *
+ * 使能 YModem-G 且接收方以 'G' 握手时：
+ *    等待 'G' -> 第 0 帧 -> 'G' -> 第 1 帧（固件包头，触发擦除） -> ACK -> 其余数据帧连续发送，不等应答 ... -> EOT -> NAK -> EOT -> ACK 、 'G' -> 空的第 0 帧 -> ACK
+ *    连续发送期间收到 CAN 即结束
+ *
+ * ext_len 不为 0 时，第 0 帧的文件大小之后附加 "EXT=<ext_len>" 请求使用扩展数据帧，接收方以 'E' 代替第 0 帧之后的 'C' 或 'G' 时，
+ * 第 1 帧（固件包头）仍为 1024 byte 的 STX 数据帧，其余数据帧均为 ext_len byte 、以 CRC32 校验的扩展数据帧
+ *
+ * resume 为 true 时，第 0 帧再附加 "RESUME" 请求断点续传（与 "EXT=" 以空格分隔），接收方在第 1 帧的 ACK 之后应答
+ *    'R' 、 offset (4) 、 crc16 (2) ，均为高字节在前，之后从文件中第 1 帧之后偏移 offset 的位置继续发送，序列号照常递增。
+ *    超时没有收到应答时视为接收方不支持，从头发送
+ * drop_size 不为 0 时，已发送的文件数据达到 drop_size 后不再发送，返回 YMODEM_SEND_DROP ，模拟传输中断
+ *
+ * baud_num 不为 0 时，收到握手字符后、发送第 0 帧之前按优先顺序请求 baud 中的波特率：
+ *    'B' 、 num 、 baudrate (4 * num) 、 crc16 (2) -> 应答 'B' 、 baudrate (4) 、 crc16 (2) ，均为高字节在前
+ *    应答的波特率不同于当前波特率时切换串口的波特率，发送探测帧，收到原样的回送后以新波特率发送第 0 帧，不再等待握手字符。
+ *    没有收到回送时恢复原波特率，等待接收方重新发送握手字符，再请求剩余的、优先级更低的波特率。
+ *    没有收到应答时视为接收方不支持，以原波特率发送。发送结束后恢复原波特率
+ */
+
+#define YMODEM_SOH                  0x01
+#define YMODEM_STX                  0x02
+#define YMODEM_EOT                  0x04
+#define YMODEM_ACK                  0x06
+#define YMODEM_NAK                  0x15
+#define YMODEM_CAN                  0x18
+#define YMODEM_C                    0x43
+#define YMODEM_G                    0x47
+#define YMODEM_PAD                  0x1A
+#define YMODEM_STX_EXT              0x03
+#define YMODEM_E                    0x45
+#define YMODEM_EXT_MAX_LEN          8192
+#define YMODEM_RESUME               0x52
+#define YMODEM_RESUME_REPLY_LEN     7
+#define YMODEM_BAUD                 0x42
+#define YMODEM_BAUD_MAX_NUM         8
+#define YMODEM_BAUD_REPLY_LEN       7
+#define YMODEM_PROBE                0x50
+#define YMODEM_PROBE_LEN            9
+
+typedef enum
+{
+    YMODEM_SEND_OK          =  0,
+    YMODEM_SEND_TIMEOUT     = -1,               /* 等待应答超时或重发次数用尽 */
+    YMODEM_SEND_CANCEL      = -2,               /* 接收方取消 */
+    YMODEM_SEND_IO_ERR      = -3,
+    YMODEM_SEND_DROP        = -4,               /* 已按 drop_size 中断发送 */
+
+} YMODEM_SEND_RESULT;
+
+struct YMODEM_SENDER
+{
+    int         fd;                             /* 已打开的串口或 PTY */
+    uint32_t    timeout_ms;                     /* 等待应答的超时时间，单位 ms */
+    uint8_t     max_retry;                      /* 每帧最多的重发次数 */
+    bool        enable_g;                       /* 接受接收方的 'G' 握手 */
+    bool        is_g;                           /* 本次按 YModem-G 发送 */
+    uint16_t    ext_len;                        /* 请求的扩展数据帧长度，不超过 YMODEM_EXT_MAX_LEN ， 0: 不请求 */
+    bool        is_ext;                         /* 接收方接受了扩展数据帧 */
+    double      noise;                          /* 每个数据帧被破坏一个字节的概率，模拟线路干扰 */
+    unsigned    seed;                           /* noise 的随机数种子 */
+    bool        resume;                         /* 请求断点续传 */
+    uint32_t    drop_size;                      /* 发送的文件数据达到该长度后中断， 0: 不中断 */
+    uint32_t    resume_offset;                  /* 接收方应答的续传位置，即跳过的包体长度 */
+    uint32_t    baud[YMODEM_BAUD_MAX_NUM];      /* 请求的波特率，按优先顺序排列 */
+    uint8_t     baud_num;                       /* 请求的波特率数量， 0: 不协商 */
+    uint32_t    baudrate;                       /* 协商后传输使用的波特率， 0: 未切换 */
+    uint8_t     baud_fails;                     /* 探测帧没有回送、恢复原波特率的次数 */
+
+    /* 统计 */
+    uint32_t    frames;                         /* 发送的帧数，包含重发 */
+    uint32_t    retries;                        /* 重发次数 */
+    uint32_t    corrupted;                      /* 被 noise 破坏的数据帧数 */
+    uint64_t    start_ns;                       /* 收到第一个 'C' 或 'G' 的时刻 */
+    uint64_t    done_ns;                        /* 结束帧被应答的时刻 */
+};
+
+uint16_t            YModem_CRC16    (const uint8_t *data, uint32_t len);
+uint32_t            YModem_CRC32    (const uint8_t *data, uint32_t len);
+YMODEM_SEND_RESULT  YModem_Send     (struct YMODEM_SENDER *ys, const char *file_name, const uint8_t *data, uint32_t size);
+uint64_t            YModem_Now      (void);
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * \file            cmsis_compiler.h
+ * \brief           CMSIS compiler macros for the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ */
+
+#ifndef __CMSIS_COMPILER_H__
+#define __CMSIS_COMPILER_H__
+
+#include <stdint.h>
+
+/* 仅提供 bootloader 、 BSP 和 perf_counter 用到的部分 */
+#ifndef   __ASM
+  #define __ASM                                 __asm
+#endif
+#ifndef   __INLINE
+  #define __INLINE                              inline
+#endif
+#ifndef   __STATIC_INLINE
+  #define __STATIC_INLINE                       static inline
+#endif
+#ifndef   __STATIC_FORCEINLINE
+  #define __STATIC_FORCEINLINE                  __attribute__((always_inline)) static inline
+#endif
+#ifndef   __NO_RETURN
+  #define __NO_RETURN                           __attribute__((__noreturn__))
+#endif
+#ifndef   __USED
+  #define __USED                                __attribute__((used))
+#endif
+#ifndef   __WEAK
+  #define __WEAK                                __attribute__((weak))
+#endif
+#ifndef   __PACKED
+  #define __PACKED                              __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __PACKED_STRUCT
+  #define __PACKED_STRUCT                       struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __PACKED_UNION
+  #define __PACKED_UNION                        union __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __ALIGNED
+  #define __ALIGNED(x)                          __attribute__((aligned(x)))
+#endif
+#ifndef   __NOP
+  #define __NOP()                               __ASM volatile ("nop")
+#endif
+
+/**
+ * 中断开关的仿真，由 host_hal.c 实现
+ * 主机仿真中的“中断”是时钟线程和 UART 接收线程，关中断即持有这两个线程共用的中断锁
+ */
+uint32_t    __get_PRIMASK   (void);
+void        __set_PRIMASK   (uint32_t priMask);
+void        __disable_irq   (void);
+void        __enable_irq    (void);
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * \file            host_flash.h
+ * \brief           flash device model of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 HOST_Flash_Deadline ，供异步擦写计算忙的结束时刻
+ */
+
+#ifndef __HOST_FLASH_H__
+#define __HOST_FLASH_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * flash 器件模型：
+ *    1. 每个 sector （或页）的擦除时间、每个编程单元和快速编程一次的编程时间以及读取带宽，用于让仿真的更新耗时接近真实硬件
+ *    2. 每个 sector 的擦除计数，保存在镜像文件旁的 .wear 文件中，系统复位后继续累计
+ *    3. 只能对已擦除的位编程的规则，违反时按器件的行为报错或只清除位，并计数
+ *    4. 预设的模型对应 example 中的芯片，可用 HOST_Flash_FindModel 按名称获取
+ * 片内 flash 由 host_hal.c 的 HAL_FLASH_* 接口使用， SPI NOR 由 host_hal.c 的 SPI 接口以 JEDEC 指令的方式使用
+ */
+
+#define HOST_FLASH_MAX_REGION               4           /* 一个模型最多的 sector 尺寸种类 */
+
+/* 对未擦除的单元编程时的规则 */
+typedef enum
+{
+    HOST_FLASH_RULE_ERASED_ONLY = 0,    /* 编程单元必须为擦除状态（写全 0 除外），否则报错且不写入，如 STM32F1 、 STM32L4 */
+    HOST_FLASH_RULE_BIT_CLEAR,          /* 只能把 1 写成 0 ，不报错，如 STM32F4 、 SPI NOR */
+
+} HOST_FLASH_RULE;
+
+/* 相同尺寸的一组连续 sector */
+struct HOST_FLASH_REGION
+{
+    uint32_t sector_size;               /* sector 尺寸，单位 byte */
+    uint32_t sector_num;                /* sector 数量 */
+    uint32_t erase_time_us;             /* 擦除一个 sector 的典型时间，单位 us */
+};
+
+struct HOST_FLASH_MODEL
+{
+    const char     *name;               /* 模型名称，用于命令行选择 */
+    const char     *desc;               /* 描述 */
+    uint32_t        size;               /* 容量，单位 byte ，等于各 region 之和 */
+    uint16_t        program_unit;       /* 一次编程的字节数，SPI NOR 为页尺寸 */
+    uint32_t        program_time_us;    /* 编程一个单元的典型时间，单位 us */
+    uint16_t        burst_unit;         /* 快速编程一次的字节数，如 STM32L4 的行， 0 表示不支持 */
+    uint32_t        burst_time_us;      /* 快速编程一次的典型时间，单位 us */
+    uint32_t        read_bandwidth;     /* 读取带宽，单位 byte/s ， SPI NOR 为总线带宽 */
+    uint32_t        endurance;          /* 每个 sector 的擦写寿命，单位 次 */
+    HOST_FLASH_RULE rule;
+    uint8_t         region_num;
+    struct HOST_FLASH_REGION region[HOST_FLASH_MAX_REGION];
+};
+
+/* 仿真 flash 的操作统计，时间均为模型时间，与时间缩放无关 */
+struct HOST_FLASH_STATS
+{
+    uint32_t erase_count;               /* 擦除的 sector 数 */
+    uint64_t erase_bytes;
+    uint64_t erase_time_us;
+    uint32_t program_count;             /* 编程的单元数 */
+    uint64_t program_bytes;
+    uint64_t program_time_us;
+    uint64_t read_bytes;
+    uint64_t read_time_us;
+    uint32_t rule_violation;            /* 对未擦除的位编程的次数 */
+};
+
+struct HOST_FLASH_DEV
+{
+    const char                     *name;
+    const struct HOST_FLASH_MODEL  *model;
+    uint8_t                        *mem;            /* 镜像文件的映射 */
+    uint32_t                        size;
+    uint32_t                        sector_total;
+    uint32_t                       *wear;           /* 每个 sector 的擦除计数 */
+    struct HOST_FLASH_STATS         stats;
+};
+
+/* 挂在 SPI 总线上的 NOR flash ，按 JEDEC 指令工作 */
+struct HOST_SPI_NOR
+{
+    struct HOST_FLASH_DEV   dev;
+    uint8_t                 jedec_id[3];
+    bool                    is_select;          /* 片选有效 */
+    bool                    is_wel;             /* 写使能锁存 */
+    uint8_t                 status;             /* 状态寄存器 1 */
+    uint64_t                busy_until;         /* 编程/擦除结束的时刻，单位 ns */
+    uint16_t                cmd_len;
+    uint32_t                rx_posit;           /* 读数据指令已输出的字节数 */
+    uint8_t                 cmd[4 + 256];       /* 指令 + 地址 + 页数据 */
+};
+
+const struct HOST_FLASH_MODEL * HOST_Flash_FindModel    (const char *name);
+const struct HOST_FLASH_MODEL * HOST_Flash_GetModel     (uint8_t index);
+int         HOST_Flash_Open         (struct HOST_FLASH_DEV *dev, const char *name, const struct HOST_FLASH_MODEL *model,
+                                     const char *file, uintptr_t addr, uint32_t size);
+void        HOST_Flash_Close        (struct HOST_FLASH_DEV *dev);
+int         HOST_Flash_GetSector    (const struct HOST_FLASH_DEV *dev, uint32_t offset, uint32_t *sector_offset, uint32_t *sector_size);
+int64_t     HOST_Flash_Read         (struct HOST_FLASH_DEV *dev, uint32_t offset, uint8_t *buf, uint32_t size);
+int64_t     HOST_Flash_Program      (struct HOST_FLASH_DEV *dev, uint32_t offset, const uint8_t *data, uint32_t size);
+int64_t     HOST_Flash_ProgramBurst (struct HOST_FLASH_DEV *dev, uint32_t offset, const uint8_t *data);
+int64_t     HOST_Flash_Erase        (struct HOST_FLASH_DEV *dev, uint32_t offset, uint32_t size, uint32_t erase_time_us);
+void        HOST_Flash_Wait         (uint64_t time_us);
+uint64_t    HOST_Flash_Now          (void);
+uint64_t    HOST_Flash_Deadline     (uint64_t begin, uint64_t time_us);
+void        HOST_Flash_PrintStats   (const struct HOST_FLASH_DEV *dev, FILE *stream);
+
+int         HOST_SpiNor_Open        (struct HOST_SPI_NOR *nor, const char *name,
+                                     const struct HOST_FLASH_MODEL *model, const char *file);
+void        HOST_SpiNor_Select      (struct HOST_SPI_NOR *nor, bool is_select);
+void        HOST_SpiNor_Transfer    (struct HOST_SPI_NOR *nor, const uint8_t *tx, uint8_t *rx, uint32_t len);
+
+#endif
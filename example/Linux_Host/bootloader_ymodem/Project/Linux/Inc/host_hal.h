@@ -0,0 +1,256 @@
+/**
+ * \file            host_hal.h
+ * \brief           minimal HAL of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  1. flash 改由 host_flash.c 的器件模型实现
+ *                                      2. 增加挂载 SPI NOR flash 的 SPI 和 GPIO 接口
+ * v1.2     2026-10-18                  1. 增加 UART 波特率的仿真
+ *                                      2. 增加供基准测试解析的 trace 输出
+ * v1.3     2026-10-18                  1. 增加 HAL_UART_Init ，波特率可在运行中切换，收发速率按当前波特率限制
+ *                                      2. 增加线路的仿真，波特率超过线路上限或与上位机不一致时数据出错
+ * v1.4     2026-10-18                  1. 增加 flash 的中断方式擦写、忙标志和 FLASH_WaitForLastOperation
+ */
+
+#ifndef __HOST_HAL_H__
+#define __HOST_HAL_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "cmsis_compiler.h"
+#include "host_flash.h"
+
+/**
+ * 主机仿真用一个 1 ms 周期的时钟线程模拟 SysTick 中断，用一个线程模拟 UART 的 DMA 接收和空闲中断，
+ * flash 则是 mmap 到 FLASH_BASE 的镜像文件，因此 bootloader 可以直接按地址读取 flash 。
+ * 片内 flash 和 SPI NOR flash 的擦写耗时、擦写规则由 host_flash.c 的器件模型决定。
+ * 这里只实现 bootloader 用到的那一小部分 HAL 接口，接口名称和语义尽量与 STM32 HAL 库保持一致。
+ */
+
+#define HOST_UART_IDLE_TIME_MS              1           /* 收到数据后多久没有新数据视为发生空闲中断，单位 ms */
+
+typedef enum
+{
+    HAL_OK       = 0x00U,
+    HAL_ERROR    = 0x01U,
+    HAL_BUSY     = 0x02U,
+    HAL_TIMEOUT  = 0x03U
+
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY                       0xFFFFFFFFU
+
+/* 主机仿真的运行参数，由 main.c 解析命令行得到 */
+struct HOST_CONFIG
+{
+    const char *flash_file;             /* flash 镜像文件路径 */
+    const char *flash_model;            /* 片内 flash 的器件模型名称 */
+    const char *spi_flash_file;         /* SPI flash 镜像文件路径 */
+    const char *spi_flash_model;        /* SPI flash 的器件模型名称 */
+    uint32_t    time_scale;             /* flash 耗时的缩放，单位 % ， 0: 不等待只统计， 100: 与真实器件相同 */
+    const char *uart_link;              /* UART1 所用 PTY 从设备的符号链接路径，可为 NULL */
+    const char *uart2_link;             /* UART2 所用 PTY 从设备的符号链接路径，可为 NULL */
+    uint32_t    baudrate;               /* 仿真的 UART 初始波特率，按 10 bit/byte 限制收发速率， 0: 不限速 */
+    uint32_t    line_baudrate;          /* 线路能传输的最高波特率，超过或与上位机 PTY 的波特率不一致时数据出错， 0: 不仿真 */
+    const char *trace_file;             /* trace 输出文件，可为 NULL */
+    bool        quiet;                  /* 关闭 BSP_Printf 的输出 */
+    int         argc;                   /* 用于系统复位时重新执行本程序 */
+    char      **argv;
+};
+
+extern struct HOST_CONFIG host_cfg;
+
+
+/* flash --------------------------------------------------------------------*/
+#define FLASH_TYPEPROGRAM_HALFWORD          0x01U
+#define FLASH_TYPEPROGRAM_WORD              0x02U
+#define FLASH_TYPEPROGRAM_DOUBLEWORD        0x03U
+#define FLASH_TYPEPROGRAM_FAST              0x04U       /* 与 STM32L4 相同， Data 为一行数据的地址 */
+
+#define FLASH_TYPEERASE_PAGES               0x00U
+#define FLASH_TYPEERASE_MASSERASE           0x02U
+#define FLASH_BANK_1                        1U
+
+#define FLASH_FLAG_BSY                      0x01U       /* 擦写进行中 */
+#define FLASH_TIMEOUT_VALUE                 50000U      /* 单位 ms */
+#define __HAL_FLASH_GET_FLAG(__FLAG__)      HOST_FLASH_GetFlag(__FLAG__)
+
+/* 主机仿真的“页”即器件模型的擦除单元，对于 sector 尺寸不一的器件， NbPages 是从 PageAddress 起的连续 sector 数 */
+typedef struct
+{
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+
+} FLASH_EraseInitTypeDef;
+
+extern struct HOST_FLASH_DEV host_onchip_flash;
+
+HAL_StatusTypeDef   HOST_FLASH_Init         (const char *file, const struct HOST_FLASH_MODEL *model, uint32_t base, uint32_t size);
+HAL_StatusTypeDef   HAL_FLASH_Unlock        (void);
+HAL_StatusTypeDef   HAL_FLASH_Lock          (void);
+HAL_StatusTypeDef   HAL_FLASH_Program       (uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef   HAL_FLASH_Program_IT    (uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef   HAL_FLASHEx_Erase       (FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+HAL_StatusTypeDef   HAL_FLASHEx_Erase_IT    (FLASH_EraseInitTypeDef *pEraseInit);
+HAL_StatusTypeDef   FLASH_WaitForLastOperation  (uint32_t Timeout);
+uint32_t            HOST_FLASH_GetFlag      (uint32_t Flag);
+
+
+/* UART ---------------------------------------------------------------------*/
+typedef struct __DMA_HandleTypeDef
+{
+    void               *Parent;
+    volatile uint32_t   CNDTR;          /* DMA 剩余的传输数量，循环模式下到 0 后重装 */
+
+} DMA_HandleTypeDef;
+
+/* 仿真 UART 的“寄存器”，即 PTY 及其接收线程 */
+typedef struct
+{
+    int                 fd;             /* PTY 主设备 */
+    char                name[64];       /* PTY 从设备路径 */
+    const char         *link;           /* 指向从设备的符号链接 */
+    pthread_t           rx_thread;
+    volatile bool       rx_enable;      /* DMA 接收已启动 */
+    struct __UART_HandleTypeDef *rx_huart;  /* 启动 DMA 接收时登记的句柄，回调时传回 */
+    uint8_t            *rx_buff;        /* DMA 循环接收的目标缓存 */
+    uint16_t            rx_size;
+    uint16_t            rx_pos;
+    volatile uint32_t   baudrate;       /* 当前的波特率，由 HAL_UART_Init 设置 */
+    uint64_t            rx_line_free;   /* 按波特率，接收线空闲的时刻，单位 ns */
+    uint64_t            rx_bytes;
+    uint64_t            tx_bytes;
+
+} USART_TypeDef;
+
+typedef struct
+{
+    uint32_t            BaudRate;
+
+} UART_InitTypeDef;
+
+typedef struct __UART_HandleTypeDef
+{
+    USART_TypeDef      *Instance;
+    UART_InitTypeDef    Init;
+    DMA_HandleTypeDef  *hdmarx;
+    DMA_HandleTypeDef  *hdmatx;
+    volatile uint32_t   ErrorCode;
+
+} UART_HandleTypeDef;
+
+extern USART_TypeDef    host_usart1;
+extern USART_TypeDef    host_usart2;
+#define USART1          (&host_usart1)
+#define USART2          (&host_usart2)
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)   ((__HANDLE__)->CNDTR)
+
+HAL_StatusTypeDef   HOST_UART_Open              (UART_HandleTypeDef *huart, const char *link);
+HAL_StatusTypeDef   HAL_UART_Init               (UART_HandleTypeDef *huart);
+HAL_StatusTypeDef   HAL_UART_Transmit           (UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef   HAL_UART_Receive_DMA        (UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef   HAL_UART_DMAPause           (UART_HandleTypeDef *huart);
+void                HAL_UART_RxHalfCpltCallback (UART_HandleTypeDef *huart);
+void                HAL_UART_RxCpltCallback     (UART_HandleTypeDef *huart);
+void                HAL_UARTEx_RxEventCallback  (UART_HandleTypeDef *huart, uint16_t Size);
+
+
+/* GPIO and SPI -------------------------------------------------------------*/
+typedef enum
+{
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+
+} GPIO_PinState;
+
+typedef struct
+{
+    volatile uint32_t   ODR;
+
+} GPIO_TypeDef;
+
+/* 仿真 SPI 的“寄存器”，总线上挂一片 SPI NOR flash ，片选由 GPIO 控制 */
+typedef struct
+{
+    struct HOST_SPI_NOR nor;
+    GPIO_TypeDef       *cs_port;
+    uint16_t            cs_pin;
+
+} SPI_TypeDef;
+
+typedef struct
+{
+    SPI_TypeDef        *Instance;
+
+} SPI_HandleTypeDef;
+
+extern GPIO_TypeDef     host_gpiob;
+extern SPI_TypeDef      host_spi2;
+#define GPIOB           (&host_gpiob)
+#define SPI2            (&host_spi2)
+#define GPIO_PIN_12     ((uint16_t)0x1000)
+
+HAL_StatusTypeDef   HOST_SPI_Open               (SPI_HandleTypeDef *hspi, const char *file, const struct HOST_FLASH_MODEL *model,
+                                                 GPIO_TypeDef *cs_port, uint16_t cs_pin);
+void                HAL_GPIO_WritePin           (GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+HAL_StatusTypeDef   HAL_SPI_Transmit            (SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef   HAL_SPI_Receive             (SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+
+/* system -------------------------------------------------------------------*/
+HAL_StatusTypeDef   HAL_Init                (void);
+HAL_StatusTypeDef   HAL_DeInit              (void);
+void                HAL_IncTick             (void);
+uint32_t            HAL_GetTick             (void);
+void                HAL_Delay               (uint32_t Delay);
+__NO_RETURN
+void                HAL_NVIC_SystemReset    (void);
+__NO_RETURN
+void                HOST_Exit               (int code);
+void                SysTick_Handler         (void);
+
+/**
+ * trace 每行为 "<CLOCK_MONOTONIC ns> <事件> [参数]" ，系统复位后追加写入同一文件，事件有:
+ *    start                                         仿真开始
+ *    flow <名称>                                   进入 bootloader 的执行流程
+ *    uart <名称> rx=<byte> tx=<byte>               UART 的收发数据量
+ *    flash <名称> erase=<sector> erase_us=<us> ... flash 的操作统计，见 host_flash.h
+ *    perf <名称> count=<次> total_us=<us> max_us=<us> 跳转至 APP 前输出的耗时统计，见 perf_stats.h
+ *    exit <退出码>                                 仿真结束
+ */
+void                HOST_Trace              (const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * \file            main.h
+ * \brief           header for main.c of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  sector 数量由 flash 器件模型决定，增加 SPI flash 的句柄
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "host_hal.h"
+
+/* 仿真的片内 flash ，默认对应 STM32F103xE ，每页 2 Kbyte ，实际的 sector 布局由 -m 选择的器件模型决定 */
+#define FLASH_BASE                          0x08000000UL
+#define FLASH_PAGE_SIZE                     0x800U
+#define FLASH_SECTOR_TOTAL                  (host_onchip_flash.sector_total)
+
+/* SPI flash 的片选 */
+#define FLASH_CS_Pin                        GPIO_PIN_12
+#define FLASH_CS_GPIO_Port                  GPIOB
+
+/* 仿真外设的句柄 */
+extern UART_HandleTypeDef huart1;
+extern UART_HandleTypeDef huart2;
+extern SPI_HandleTypeDef  hspi2;
+
+#endif
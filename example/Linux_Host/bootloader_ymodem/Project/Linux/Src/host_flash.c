@@ -0,0 +1,910 @@
+/**
+ * \file            host_flash.c
+ * \brief           flash device model of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 HOST_Flash_Deadline ，供异步擦写计算忙的结束时刻
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "host_hal.h"
+#include "host_flash.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+#define _KB                     (1024U)
+#define _MB                     (1024U * 1024U)
+
+/* SPI NOR 的 JEDEC 指令 */
+#define NOR_CMD_WRITE_STATUS    0x01
+#define NOR_CMD_PAGE_PROGRAM    0x02
+#define NOR_CMD_READ_DATA       0x03
+#define NOR_CMD_WRITE_DISABLE   0x04
+#define NOR_CMD_READ_STATUS     0x05
+#define NOR_CMD_WRITE_ENABLE    0x06
+#define NOR_CMD_FAST_READ       0x0B
+#define NOR_CMD_ERASE_4K        0x20
+#define NOR_CMD_ERASE_32K       0x52
+#define NOR_CMD_READ_SFDP       0x5A
+#define NOR_CMD_ERASE_CHIP      0x60
+#define NOR_CMD_ENABLE_RESET    0x66
+#define NOR_CMD_MANUFACTURER_ID 0x90
+#define NOR_CMD_RESET           0x99
+#define NOR_CMD_JEDEC_ID        0x9F
+#define NOR_CMD_ERASE_CHIP_2    0xC7
+#define NOR_CMD_ERASE_64K       0xD8
+
+#define NOR_STATUS_BUSY         0x01
+#define NOR_STATUS_WEL          0x02
+
+/* W25Q128JV 块擦除和整片擦除的典型时间，单位 us */
+#define NOR_ERASE_32K_TIME_US   120000
+#define NOR_ERASE_64K_TIME_US   150000
+#define NOR_ERASE_CHIP_TIME_US  40000000
+
+
+/* Private variables ---------------------------------------------------------*/
+/* 典型时间取自各芯片数据手册 */
+static const struct HOST_FLASH_MODEL _model_table[] = 
+{
+    {
+        .name            = "stm32f1",
+        .desc            = "STM32F103xE, 2 Kbyte page, 16-bit programming",
+        .size            = 512 * _KB,
+        .program_unit    = 2,
+        .program_time_us = 53,
+        .read_bandwidth  = 96 * _MB,
+        .endurance       = 10000,
+        .rule            = HOST_FLASH_RULE_ERASED_ONLY,
+        .region_num      = 1,
+        .region          = { {2 * _KB, 256, 20000} },
+    },
+    {
+        .name            = "stm32f407",
+        .desc            = "STM32F407xG, 16/64/128 Kbyte sector, x32 programming",
+        .size            = 1024 * _KB,
+        .program_unit    = 4,
+        .program_time_us = 16,
+        .read_bandwidth  = 112 * _MB,
+        .endurance       = 10000,
+        .rule            = HOST_FLASH_RULE_BIT_CLEAR,
+        .region_num      = 3,
+        .region          = { {16 * _KB, 4, 250000}, {64 * _KB, 1, 550000}, {128 * _KB, 7, 1000000} },
+    },
+    {
+        .name            = "stm32f407x64",
+        .desc            = "STM32F407xG with VPP, 16/64/128 Kbyte sector, x64 programming",
+        .size            = 1024 * _KB,
+        .program_unit    = 4,
+        .program_time_us = 16,
+        .burst_unit      = 8,
+        .burst_time_us   = 16,
+        .read_bandwidth  = 112 * _MB,
+        .endurance       = 10000,
+        .rule            = HOST_FLASH_RULE_BIT_CLEAR,
+        .region_num      = 3,
+        .region          = { {16 * _KB, 4, 250000}, {64 * _KB, 1, 550000}, {128 * _KB, 7, 1000000} },
+    },
+    {
+        .name            = "stm32l4",
+        .desc            = "STM32L4xx, 2 Kbyte page, 64-bit programming, 256 byte fast row programming",
+        .size            = 512 * _KB,
+        .program_unit    = 8,
+        .program_time_us = 82,
+        .burst_unit      = 256,
+        .burst_time_us   = 1910,
+        .read_bandwidth  = 128 * _MB,
+        .endurance       = 10000,
+        .rule            = HOST_FLASH_RULE_ERASED_ONLY,
+        .region_num      = 1,
+        .region          = { {2 * _KB, 256, 22000} },
+    },
+    {
+        .name            = "w25q128",
+        .desc            = "W25Q128JV SPI NOR, 4 Kbyte sector, 256 byte page, 18 MHz SPI",
+        .size            = 16 * _MB,
+        .program_unit    = 256,
+        .program_time_us = 700,
+        .read_bandwidth  = 18000000 / 8,
+        .endurance       = 100000,
+        .rule            = HOST_FLASH_RULE_BIT_CLEAR,
+        .region_num      = 1,
+        .region          = { {4 * _KB, 4096, 45000} },
+    },
+};
+
+static uint64_t _wait_deadline;         /* 模型时间折算后，本线程应阻塞到的时刻，单位 ns */
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void *   _Flash_Map          (const char *file, uintptr_t addr, uint32_t size, uint8_t fill);
+static int64_t  _Flash_Program      (struct HOST_FLASH_DEV *dev, uint32_t offset, const uint8_t *data, uint32_t size,
+                                     uint32_t unit_num, uint32_t unit_time_us);
+static uint64_t _Flash_ScaleTime    (uint64_t time_us);
+static uint32_t _SpiNor_Address     (const struct HOST_SPI_NOR *nor);
+static void     _SpiNor_Execute     (struct HOST_SPI_NOR *nor);
+static bool     _SpiNor_IsBusy      (struct HOST_SPI_NOR *nor);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  按名称查找预设的 flash 模型
+ * @note   
+ * @param[in]  name: 模型名称
+ * @retval flash 模型，找不到时为 NULL
+ */
+const struct HOST_FLASH_MODEL *HOST_Flash_FindModel(const char *name)
+{
+    for (uint8_t i = 0; i < sizeof(_model_table) / sizeof(_model_table[0]); i++)
+    {
+        if (strcmp(_model_table[i].name, name) == 0)
+            return &_model_table[i];
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief  按序号获取预设的 flash 模型
+ * @note   用于列出所有模型
+ * @param[in]  index: 序号
+ * @retval flash 模型，超出范围时为 NULL
+ */
+const struct HOST_FLASH_MODEL *HOST_Flash_GetModel(uint8_t index)
+{
+    if (index >= sizeof(_model_table) / sizeof(_model_table[0]))
+        return NULL;
+
+    return &_model_table[index];
+}
+
+
+/**
+ * @brief  打开一个仿真 flash
+ * @note   镜像文件不存在时会新建并填充为擦除状态 (0xFF) ，擦除计数保存在 <file>.wear
+ * @param[out] dev: flash 对象
+ * @param[in]  name: flash 名称，用于打印
+ * @param[in]  model: flash 模型
+ * @param[in]  file: 镜像文件路径
+ * @param[in]  addr: 映射的地址， 0 表示由系统分配
+ * @param[in]  size: 使用的容量，单位 byte ， 0 表示模型的容量
+ * @retval 0: 成功。 -1: 失败
+ */
+int HOST_Flash_Open(struct HOST_FLASH_DEV *dev, const char *name, const struct HOST_FLASH_MODEL *model,
+                    const char *file, uintptr_t addr, uint32_t size)
+{
+    char wear_file[256];
+    uint32_t sector_offset = 0, sector_size = 0;
+
+    memset(dev, 0, sizeof(struct HOST_FLASH_DEV));
+
+    if (size == 0)
+        size = model->size;
+
+    dev->name  = name;
+    dev->model = model;
+    dev->size  = size;
+
+    if (size > model->size)
+    {
+        fprintf(stderr, "%s: %u bytes exceed the %s model (%u bytes)\n", name, size, model->name, model->size);
+        return -1;
+    }
+
+    /* 容量须落在 sector 边界上 */
+    for (uint32_t offset = 0; offset < size; offset = sector_offset + sector_size)
+    {
+        HOST_Flash_GetSector(dev, offset, &sector_offset, &sector_size);
+        dev->sector_total++;
+    }
+    if (sector_offset + sector_size != size)
+    {
+        fprintf(stderr, "%s: %u bytes is not on a %s sector boundary\n", name, size, model->name);
+        return -1;
+    }
+
+    dev->mem = _Flash_Map(file, addr, size, 0xFF);
+    if (dev->mem == NULL)
+        return -1;
+
+    snprintf(wear_file, sizeof(wear_file), "%s.wear", file);
+    dev->wear = _Flash_Map(wear_file, 0, dev->sector_total * sizeof(uint32_t), 0x00);
+    if (dev->wear == NULL)
+    {
+        munmap(dev->mem, size);
+        dev->mem = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief  关闭仿真 flash
+ * @note   数据同步至镜像文件
+ * @param[in]  dev: flash 对象
+ * @retval None
+ */
+void HOST_Flash_Close(struct HOST_FLASH_DEV *dev)
+{
+    if (dev->mem)
+    {
+        msync(dev->mem, dev->size, MS_SYNC);
+        munmap(dev->mem, dev->size);
+        dev->mem = NULL;
+    }
+    if (dev->wear)
+    {
+        msync(dev->wear, dev->sector_total * sizeof(uint32_t), MS_SYNC);
+        munmap(dev->wear, dev->sector_total * sizeof(uint32_t));
+        dev->wear = NULL;
+    }
+}
+
+
+/**
+ * @brief  获取地址所在的 sector
+ * @note   
+ * @param[in]   dev: flash 对象
+ * @param[in]   offset: flash 内的偏移地址
+ * @param[out]  sector_offset: sector 的起始偏移地址
+ * @param[out]  sector_size: sector 的尺寸，单位 byte
+ * @retval sector 的序号， -1: 超出 flash 容量
+ */
+int HOST_Flash_GetSector(const struct HOST_FLASH_DEV *dev, uint32_t offset, uint32_t *sector_offset, uint32_t *sector_size)
+{
+    int index = 0;
+    uint32_t region_offset = 0;
+    const struct HOST_FLASH_REGION *region;
+
+    for (uint8_t i = 0; i < dev->model->region_num; i++)
+    {
+        region = &dev->model->region[i];
+        if (offset < region_offset + region->sector_size * region->sector_num)
+        {
+            index         += (offset - region_offset) / region->sector_size;
+            *sector_size   = region->sector_size;
+            *sector_offset = region_offset + ((offset - region_offset) / region->sector_size) * region->sector_size;
+            return index;
+        }
+        index         += region->sector_num;
+        region_offset += region->sector_size * region->sector_num;
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief  读取 flash
+ * @note   按读取带宽计时。片内 flash 被直接按地址读取时不经过本函数，不计时
+ * @param[in]   dev: flash 对象
+ * @param[in]   offset: 偏移地址
+ * @param[out]  buf: 数据缓存
+ * @param[in]   size: 读取的大小，单位 byte
+ * @retval 模型耗时，单位 us 。 -1: 超出 flash 容量
+ */
+int64_t HOST_Flash_Read(struct HOST_FLASH_DEV *dev, uint32_t offset, uint8_t *buf, uint32_t size)
+{
+    uint64_t time_us = 0;
+
+    if ((uint64_t)offset + size > dev->size)
+        return -1;
+
+    memcpy(buf, &dev->mem[offset], size);
+
+    if (dev->model->read_bandwidth)
+        time_us = (uint64_t)size * 1000000 / dev->model->read_bandwidth;
+
+    dev->stats.read_bytes   += size;
+    dev->stats.read_time_us += time_us;
+
+    return time_us;
+}
+
+
+/**
+ * @brief  编程 flash
+ * @note   1. program_unit 不大于 8 byte 的片内 flash ，地址和大小须按编程单元对齐，每个单元计一次编程时间
+ *         2. SPI NOR 一次页编程不能跨页，只计一次编程时间
+ *         3. 对未擦除的位编程时， HOST_FLASH_RULE_ERASED_ONLY 的器件报错且不写入当前及之后的单元，
+ *            HOST_FLASH_RULE_BIT_CLEAR 的器件只能将 1 写为 0
+ * @param[in]  dev: flash 对象
+ * @param[in]  offset: 偏移地址
+ * @param[in]  data: 写入的数据
+ * @param[in]  size: 写入的大小，单位 byte
+ * @retval 模型耗时，单位 us 。 -1: 参数错误。 -2: 对未擦除的单元编程
+ */
+int64_t HOST_Flash_Program(struct HOST_FLASH_DEV *dev, uint32_t offset, const uint8_t *data, uint32_t size)
+{
+    uint32_t unit_num;
+    const uint16_t unit = dev->model->program_unit;
+
+    if (size == 0 || (uint64_t)offset + size > dev->size)
+        return -1;
+
+    if (unit <= 8)
+    {
+        if ((offset % unit) || (size % unit))
+            return -1;
+        unit_num = size / unit;
+    }
+    else
+    {
+        if ((offset / unit) != ((offset + size - 1) / unit))
+            return -1;
+        unit_num = 1;
+    }
+
+    return _Flash_Program(dev, offset, data, size, unit_num, dev->model->program_time_us);
+}
+
+
+/**
+ * @brief  以快速编程的方式编程一次 flash
+ * @note   1. 地址须按 burst_unit 对齐，大小固定为 burst_unit ，只计一次快速编程的时间
+ *         2. 与逐个单元编程相同，其中的每个编程单元都须为擦除状态
+ * @param[in]  dev: flash 对象
+ * @param[in]  offset: 偏移地址
+ * @param[in]  data: 写入的数据，长度为 burst_unit
+ * @retval 模型耗时，单位 us 。 -1: 参数错误或模型不支持快速编程。 -2: 对未擦除的单元编程
+ */
+int64_t HOST_Flash_ProgramBurst(struct HOST_FLASH_DEV *dev, uint32_t offset, const uint8_t *data)
+{
+    const uint16_t unit = dev->model->burst_unit;
+
+    if (unit == 0 || (offset % unit) || (uint64_t)offset + unit > dev->size)
+        return -1;
+
+    return _Flash_Program(dev, offset, data, unit, 1, dev->model->burst_time_us);
+}
+
+
+/**
+ * @brief  擦除 flash
+ * @note   范围须落在 sector 边界上。每擦除一个 sector ，其擦除计数加 1
+ * @param[in]  dev: flash 对象
+ * @param[in]  offset: 偏移地址
+ * @param[in]  size: 擦除的大小，单位 byte
+ * @param[in]  erase_time_us: 本次擦除的耗时，单位 us 。 0 表示按模型中每个 sector 的擦除时间累加
+ * @retval 模型耗时，单位 us 。 -1: 参数错误
+ */
+int64_t HOST_Flash_Erase(struct HOST_FLASH_DEV *dev, uint32_t offset, uint32_t size, uint32_t erase_time_us)
+{
+    int index;
+    uint64_t time_us = 0;
+    uint32_t sector_offset, sector_size, sector_time_us;
+
+    if (size == 0 || (uint64_t)offset + size > dev->size)
+        return -1;
+
+    if (HOST_Flash_GetSector(dev, offset, &sector_offset, &sector_size) < 0
+    ||  sector_offset != offset
+    ||  HOST_Flash_GetSector(dev, offset + size - 1, &sector_offset, &sector_size) < 0
+    ||  sector_offset + sector_size != offset + size)
+    {
+        return -1;
+    }
+
+    for (uint32_t posit = offset; posit < offset + size; posit += sector_size)
+    {
+        index = HOST_Flash_GetSector(dev, posit, &sector_offset, &sector_size);
+        sector_time_us = 0;
+        for (uint8_t i = 0; i < dev->model->region_num; i++)
+        {
+            if (dev->model->region[i].sector_size == sector_size)
+                sector_time_us = dev->model->region[i].erase_time_us;
+        }
+        memset(&dev->mem[posit], 0xFF, sector_size);
+
+        if (++dev->wear[index] == dev->model->endurance + 1)
+            fprintf(stderr, "%s: sector %d at 0x%.8X exceeds %u erase cycles\n", dev->name, index, posit, dev->model->endurance);
+
+        time_us += sector_time_us;
+        dev->stats.erase_count++;
+    }
+
+    if (erase_time_us)
+        time_us = erase_time_us;
+
+    dev->stats.erase_bytes   += size;
+    dev->stats.erase_time_us += time_us;
+
+    return time_us;
+}
+
+
+/**
+ * @brief  阻塞等待一段模型时间
+ * @note   1. 按 host_cfg.time_scale 缩放，为 0 时不等待，只统计
+ *         2. 不足 1 ms 的等待先累计，避免频繁的短睡眠使总耗时失真
+ * @param[in]  time_us: 模型时间，单位 us
+ * @retval None
+ */
+void HOST_Flash_Wait(uint64_t time_us)
+{
+    uint64_t now;
+    struct timespec ts;
+
+    if (host_cfg.time_scale == 0 || time_us == 0)
+        return;
+
+    now = HOST_Flash_Now();
+    if (_wait_deadline < now)
+        _wait_deadline = now;
+
+    _wait_deadline += (uint64_t)_Flash_ScaleTime(time_us) * 1000;
+    if (_wait_deadline - now < 1000000)
+        return;
+
+    ts.tv_sec  = _wait_deadline / 1000000000;
+    ts.tv_nsec = _wait_deadline % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+
+/**
+ * @brief  获取当前时刻
+ * @note   
+ * @retval 单调时钟，单位 ns
+ */
+uint64_t HOST_Flash_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/**
+ * @brief  获取一段模型时间之后的时刻
+ * @note   1. 用于异步擦写，擦写期间本线程不阻塞，按 host_cfg.time_scale 缩放
+ *         2. 从本线程累计的等待结束之后算起，与 HOST_Flash_Wait 的时间线一致
+ * @param[in]  begin: 最早的开始时刻，单调时钟，单位 ns ，用于接在上一次擦写之后
+ * @param[in]  time_us: 模型时间，单位 us
+ * @retval 单调时钟，单位 ns
+ */
+uint64_t HOST_Flash_Deadline(uint64_t begin, uint64_t time_us)
+{
+    uint64_t now = HOST_Flash_Now();
+
+    if (_wait_deadline > now)
+        now = _wait_deadline;
+    if (begin > now)
+        now = begin;
+
+    return now + (uint64_t)_Flash_ScaleTime(time_us) * 1000;
+}
+
+
+/**
+ * @brief  打印 flash 的操作统计
+ * @note   
+ * @param[in]  dev: flash 对象
+ * @param[in]  stream: 输出流
+ * @retval None
+ */
+void HOST_Flash_PrintStats(const struct HOST_FLASH_DEV *dev, FILE *stream)
+{
+    uint32_t max_wear = 0;
+    const struct HOST_FLASH_STATS *stats = &dev->stats;
+
+    if (dev->wear == NULL)
+        return;
+
+    for (uint32_t i = 0; i < dev->sector_total; i++)
+    {
+        if (dev->wear[i] > max_wear)
+            max_wear = dev->wear[i];
+    }
+
+    fprintf(stream, "[%s] %s\n", dev->name, dev->model->desc);
+    fprintf(stream, "  erase   : %u sectors, %llu bytes, %.3f ms\n", stats->erase_count,
+            (unsigned long long)stats->erase_bytes, stats->erase_time_us / 1000.0);
+    fprintf(stream, "  program : %u units, %llu bytes, %.3f ms\n", stats->program_count,
+            (unsigned long long)stats->program_bytes, stats->program_time_us / 1000.0);
+    fprintf(stream, "  read    : %llu bytes, %.3f ms\n",
+            (unsigned long long)stats->read_bytes, stats->read_time_us / 1000.0);
+    fprintf(stream, "  rule violation: %u, max sector wear: %u/%u\n", stats->rule_violation, max_wear, dev->model->endurance);
+}
+
+
+/**
+ * @brief  打开一个 SPI NOR flash
+ * @note   JEDEC ID 按 Winbond W25Q 系列生成，容量编码为 log2(容量)
+ * @param[out] nor: SPI NOR 对象
+ * @param[in]  name: flash 名称
+ * @param[in]  model: flash 模型
+ * @param[in]  file: 镜像文件路径
+ * @retval 0: 成功。 -1: 失败
+ */
+int HOST_SpiNor_Open(struct HOST_SPI_NOR *nor, const char *name, const struct HOST_FLASH_MODEL *model, const char *file)
+{
+    memset(nor, 0, sizeof(struct HOST_SPI_NOR));
+
+    if (HOST_Flash_Open(&nor->dev, name, model, file, 0, 0) != 0)
+        return -1;
+
+    nor->jedec_id[0] = 0xEF;
+    nor->jedec_id[1] = 0x40;
+    nor->jedec_id[2] = __builtin_ctz(model->size);
+
+    return 0;
+}
+
+
+/**
+ * @brief  片选
+ * @note   片选释放时执行写使能、编程、擦除等指令
+ * @param[in]  nor: SPI NOR 对象
+ * @param[in]  is_select: true: 片选有效
+ * @retval None
+ */
+void HOST_SpiNor_Select(struct HOST_SPI_NOR *nor, bool is_select)
+{
+    if (is_select)
+    {
+        nor->cmd_len  = 0;
+        nor->rx_posit = 0;
+    }
+    else if (nor->is_select && nor->cmd_len)
+    {
+        _SpiNor_Execute(nor);
+    }
+
+    nor->is_select = is_select;
+}
+
+
+/**
+ * @brief  在 SPI 总线上传输数据
+ * @note   tx 为 NULL 时发送 dummy 字节， rx 为 NULL 时丢弃收到的数据。按总线带宽计时
+ * @param[in]   nor: SPI NOR 对象
+ * @param[in]   tx: 发送的数据
+ * @param[out]  rx: 接收的数据
+ * @param[in]   len: 传输的字节数
+ * @retval None
+ */
+void HOST_SpiNor_Transfer(struct HOST_SPI_NOR *nor, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    int64_t  time_us;
+    uint32_t addr;
+
+    if (nor->is_select == false)
+        return;
+
+    if (tx)
+    {
+        uint32_t copy_len = sizeof(nor->cmd) - nor->cmd_len;
+        if (copy_len > len)
+            copy_len = len;
+        memcpy(&nor->cmd[nor->cmd_len], tx, copy_len);
+        nor->cmd_len += copy_len;
+        HOST_Flash_Wait((uint64_t)len * 1000000 / nor->dev.model->read_bandwidth);
+    }
+
+    if (rx == NULL || nor->cmd_len == 0)
+        return;
+
+    switch (nor->cmd[0])
+    {
+        case NOR_CMD_READ_DATA:
+        case NOR_CMD_FAST_READ:
+        {
+            addr = _SpiNor_Address(nor) + nor->rx_posit;
+            if (addr + len > nor->dev.size)
+            {
+                memset(rx, 0xFF, len);
+                break;
+            }
+            time_us = HOST_Flash_Read(&nor->dev, addr, rx, len);
+            HOST_Flash_Wait(time_us);
+            break;
+        }
+        case NOR_CMD_READ_STATUS:
+        {
+            nor->status &= ~(NOR_STATUS_BUSY | NOR_STATUS_WEL);
+            if (_SpiNor_IsBusy(nor))
+                nor->status |= NOR_STATUS_BUSY;
+            if (nor->is_wel)
+                nor->status |= NOR_STATUS_WEL;
+            memset(rx, nor->status, len);
+            break;
+        }
+        case NOR_CMD_JEDEC_ID:
+        {
+            for (uint32_t i = 0; i < len; i++)
+                rx[i] = (nor->rx_posit + i < sizeof(nor->jedec_id)) ? nor->jedec_id[nor->rx_posit + i] : 0xFF;
+            break;
+        }
+        case NOR_CMD_MANUFACTURER_ID:
+        {
+            for (uint32_t i = 0; i < len; i++)
+                rx[i] = ((nor->rx_posit + i) % 2) ? (nor->jedec_id[2] - 1) : nor->jedec_id[0];
+            break;
+        }
+        /* 不提供 SFDP 表，驱动将使用自带的芯片信息表 */
+        case NOR_CMD_READ_SFDP:
+        default:
+        {
+            memset(rx, 0xFF, len);
+            break;
+        }
+    }
+
+    nor->rx_posit += len;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  映射镜像文件
+ * @note   文件不存在或尺寸不符时重建，并填充 fill
+ * @param[in]  file: 文件路径
+ * @param[in]  addr: 映射的地址， 0 表示由系统分配
+ * @param[in]  size: 文件尺寸，单位 byte
+ * @param[in]  fill: 新建文件的填充值
+ * @retval 映射的地址，失败时为 NULL
+ */
+static void *_Flash_Map(const char *file, uintptr_t addr, uint32_t size, uint8_t fill)
+{
+    struct stat st;
+    bool is_new = false;
+    void *mem;
+
+    int fd = open(file, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "open %s failed: %s\n", file, strerror(errno));
+        return NULL;
+    }
+
+    fstat(fd, &st);
+    if (st.st_size != size)
+    {
+        if (st.st_size != 0)
+            fprintf(stderr, "%s is %ld bytes, recreated as %u bytes\n", file, (long)st.st_size, size);
+
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0)
+        {
+            fprintf(stderr, "resize %s failed: %s\n", file, strerror(errno));
+            close(fd);
+            return NULL;
+        }
+        is_new = true;
+    }
+
+    mem = mmap((void *)addr, size, PROT_READ | PROT_WRITE, MAP_SHARED | (addr ? MAP_FIXED_NOREPLACE : 0), fd, 0);
+    close(fd);
+
+    if (mem == MAP_FAILED || (addr && mem != (void *)addr))
+    {
+        fprintf(stderr, "map %s at 0x%.8lX failed\n", file, (unsigned long)addr);
+        if (mem != MAP_FAILED)
+            munmap(mem, size);
+        return NULL;
+    }
+
+    if (is_new)
+        memset(mem, fill, size);
+
+    return mem;
+}
+
+
+/**
+ * @brief  按器件的规则写入数据并累计编程的统计
+ * @note   HOST_FLASH_RULE_ERASED_ONLY 的器件按 program_unit 逐个检查是否为擦除状态，出错时只累计已写入的单元
+ * @param[in]  dev: flash 对象
+ * @param[in]  offset: 偏移地址，已由调用者检查
+ * @param[in]  data: 写入的数据
+ * @param[in]  size: 写入的大小，单位 byte
+ * @param[in]  unit_num: 本次编程计时的次数
+ * @param[in]  unit_time_us: 每次编程的时间，单位 us
+ * @retval 模型耗时，单位 us 。 -2: 对未擦除的单元编程
+ */
+static int64_t _Flash_Program(struct HOST_FLASH_DEV *dev, uint32_t offset, const uint8_t *data, uint32_t size,
+                              uint32_t unit_num, uint32_t unit_time_us)
+{
+    const uint16_t unit = dev->model->program_unit;
+
+    if (dev->model->rule == HOST_FLASH_RULE_ERASED_ONLY)
+    {
+        for (uint32_t i = 0; i < size; i += unit)
+        {
+            bool is_erased = true, is_zero = true;
+
+            for (uint16_t j = 0; j < unit; j++)
+            {
+                is_erased &= (dev->mem[offset + i + j] == 0xFF);
+                is_zero   &= (data[i + j] == 0x00);
+            }
+
+            if (is_erased == false && is_zero == false)
+            {
+                dev->stats.rule_violation++;
+                /* 快速编程整体失败，逐个单元编程时只累计已写入的单元 */
+                unit_num = (unit_num == 1) ? 0 : i / unit;
+                dev->stats.program_count   += unit_num;
+                dev->stats.program_bytes   += (unit_num ? i : 0);
+                dev->stats.program_time_us += (uint64_t)unit_num * unit_time_us;
+                return -2;
+            }
+            memcpy(&dev->mem[offset + i], &data[i], unit);
+        }
+    }
+    else
+    {
+        bool is_violation = false;
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            is_violation |= ((data[i] & ~dev->mem[offset + i]) != 0);
+            dev->mem[offset + i] &= data[i];
+        }
+
+        if (is_violation)
+            dev->stats.rule_violation++;
+    }
+
+    dev->stats.program_count   += unit_num;
+    dev->stats.program_bytes   += size;
+    dev->stats.program_time_us += (uint64_t)unit_num * unit_time_us;
+
+    return (int64_t)unit_num * unit_time_us;
+}
+
+
+/**
+ * @brief  将模型时间按 host_cfg.time_scale 缩放
+ * @note   
+ * @param[in]  time_us: 模型时间，单位 us
+ * @retval 缩放后的时间，单位 us
+ */
+static uint64_t _Flash_ScaleTime(uint64_t time_us)
+{
+    return time_us * host_cfg.time_scale / 100;
+}
+
+
+/**
+ * @brief  取出指令中的 24 位地址
+ * @note   
+ * @param[in]  nor: SPI NOR 对象
+ * @retval 地址
+ */
+static uint32_t _SpiNor_Address(const struct HOST_SPI_NOR *nor)
+{
+    if (nor->cmd_len < 4)
+        return 0;
+
+    return ((uint32_t)nor->cmd[1] << 16) | ((uint32_t)nor->cmd[2] << 8) | nor->cmd[3];
+}
+
+
+/**
+ * @brief  执行片选期间收到的写类指令
+ * @note   忙时忽略写类指令；编程和擦除需要先写使能，执行后清除写使能
+ * @param[in]  nor: SPI NOR 对象
+ * @retval None
+ */
+static void _SpiNor_Execute(struct HOST_SPI_NOR *nor)
+{
+    int64_t  time_us = -1;
+    uint32_t addr = _SpiNor_Address(nor);
+    const uint32_t page = nor->dev.model->program_unit;
+
+    if (_SpiNor_IsBusy(nor))
+        return;
+
+    switch (nor->cmd[0])
+    {
+        case NOR_CMD_WRITE_ENABLE:  nor->is_wel = true;  return;
+        case NOR_CMD_WRITE_DISABLE: nor->is_wel = false; return;
+        case NOR_CMD_RESET:         nor->is_wel = false; return;
+        case NOR_CMD_WRITE_STATUS:
+        {
+            if (nor->is_wel && nor->cmd_len > 1)
+                nor->status = nor->cmd[1] & ~(NOR_STATUS_BUSY | NOR_STATUS_WEL);
+            nor->is_wel = false;
+            return;
+        }
+        case NOR_CMD_PAGE_PROGRAM:
+        {
+            if (nor->is_wel == false || nor->cmd_len <= 4 || addr >= nor->dev.size)
+                break;
+
+            /* 超出页尾的数据回卷到页首 */
+            uint32_t len  = nor->cmd_len - 4;
+            uint32_t head = page - (addr % page);
+            if (head > len)
+                head = len;
+            time_us = HOST_Flash_Program(&nor->dev, addr, &nor->cmd[4], head);
+            if (len > head)
+                HOST_Flash_Program(&nor->dev, addr - (addr % page), &nor->cmd[4 + head], len - head);
+            break;
+        }
+        case NOR_CMD_ERASE_4K:
+        case NOR_CMD_ERASE_32K:
+        case NOR_CMD_ERASE_64K:
+        {
+            uint32_t size = 4 * _KB, erase_time = 0;
+
+            if (nor->cmd[0] == NOR_CMD_ERASE_32K)
+                size = 32 * _KB, erase_time = NOR_ERASE_32K_TIME_US;
+            else if (nor->cmd[0] == NOR_CMD_ERASE_64K)
+                size = 64 * _KB, erase_time = NOR_ERASE_64K_TIME_US;
+
+            if (nor->is_wel && addr < nor->dev.size)
+                time_us = HOST_Flash_Erase(&nor->dev, addr - (addr % size), size, erase_time);
+            break;
+        }
+        case NOR_CMD_ERASE_CHIP:
+        case NOR_CMD_ERASE_CHIP_2:
+        {
+            if (nor->is_wel)
+                time_us = HOST_Flash_Erase(&nor->dev, 0, nor->dev.size, NOR_ERASE_CHIP_TIME_US);
+            break;
+        }
+        default: return;
+    }
+
+    nor->is_wel = false;
+    if (time_us > 0)
+        nor->busy_until = HOST_Flash_Now() + (uint64_t)_Flash_ScaleTime(time_us) * 1000;
+}
+
+
+/**
+ * @brief  是否正在编程或擦除
+ * @note   
+ * @param[in]  nor: SPI NOR 对象
+ * @retval true: 忙
+ */
+static bool _SpiNor_IsBusy(struct HOST_SPI_NOR *nor)
+{
+    return (nor->busy_until && HOST_Flash_Now() < nor->busy_until);
+}
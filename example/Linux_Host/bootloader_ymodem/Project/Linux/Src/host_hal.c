@@ -0,0 +1,1197 @@
+/**
+ * \file            host_hal.c
+ * \brief           minimal HAL of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  1. flash 改由 host_flash.c 的器件模型实现，按模型计时
+ *                                      2. 增加挂载 SPI NOR flash 的 SPI 和 GPIO 接口
+ * v1.2     2026-10-18                  1. 增加 UART 波特率的仿真
+ *                                      2. 增加供基准测试解析的 trace 输出
+ * v1.3     2026-10-18                  1. 实现 perf_counter 的时间基准
+ * v1.4     2026-10-18                  1. 增加 HAL_UART_Init ，收发速率按 UART 当前的波特率限制
+ *                                      2. 增加线路的仿真，波特率超过线路上限或与上位机 PTY 的波特率不一致时数据出错
+ * v1.5     2026-10-18                  1. 增加 USART2
+ * v1.6     2026-10-18                  1. 增加 flash 的中断方式擦写和忙标志，擦写期间本线程不阻塞
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include "main.h"
+#include "perf_counter.h"
+
+
+/* Exported variables ---------------------------------------------------------*/
+USART_TypeDef           host_usart1 = { .fd = -1 };
+USART_TypeDef           host_usart2 = { .fd = -1 };
+GPIO_TypeDef            host_gpiob  = { .ODR = 0xFFFF };
+SPI_TypeDef             host_spi2;
+struct HOST_FLASH_DEV   host_onchip_flash;
+
+
+/* Private variables ---------------------------------------------------------*/
+static pthread_mutex_t      _irq_lock = PTHREAD_MUTEX_INITIALIZER;  /* 中断锁，持有即为关中断 */
+static __thread uint32_t    _primask;                               /* 本线程是否已关中断 */
+
+static volatile bool        _is_running;
+static volatile uint32_t    _tick;
+static pthread_t            _systick_thread;
+
+static uint32_t             _flash_base;
+static bool                 _is_flash_unlock;
+static uint64_t             _flash_busy_until;                      /* 中断方式的擦写结束的时刻，单位 ns */
+
+static FILE                *_trace;
+static pthread_mutex_t      _trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static USART_TypeDef       *_usart_group[] = { &host_usart1, &host_usart2 };
+
+/* termios 的波特率常量与数值的对应关系 */
+static const struct
+{
+    speed_t     speed;
+    uint32_t    baudrate;
+
+} _uart_speed[] = 
+{
+    { B9600,    9600    }, { B19200,   19200   }, { B38400,   38400   }, { B57600,   57600   },
+    { B115200,  115200  }, { B230400,  230400  }, { B460800,  460800  }, { B500000,  500000  },
+    { B576000,  576000  }, { B921600,  921600  }, { B1000000, 1000000 }, { B1152000, 1152000 },
+    { B1500000, 1500000 }, { B2000000, 2000000 }, { B2500000, 2500000 }, { B3000000, 3000000 },
+    { B3500000, 3500000 }, { B4000000, 4000000 },
+};
+static SPI_TypeDef         *_spi_group[]   = { &host_spi2 };
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void    *_SysTick_Thread     (void *arg);
+static void    *_UART_RxThread      (void *arg);
+static void     _UART_DmaReceive    (USART_TypeDef *usart, const uint8_t *data, size_t len);
+static void     _UART_IdleEvent     (USART_TypeDef *usart);
+static uint64_t _UART_ByteTime      (const USART_TypeDef *usart, size_t len);
+static bool     _UART_IsLineError   (USART_TypeDef *usart);
+static void     _UART_LineNoise     (uint8_t *data, size_t len);
+static void     _SleepUntil         (uint64_t time_ns);
+static void     _Flash_TraceStats   (const struct HOST_FLASH_DEV *dev);
+static int64_t  _Flash_Program     (uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+static int64_t  _Flash_Erase       (FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  读取中断屏蔽状态
+ * @note
+ * @retval 0: 未关中断。 1: 已关中断
+ */
+uint32_t __get_PRIMASK(void)
+{
+    return _primask;
+}
+
+
+/**
+ * @brief  设置中断屏蔽状态
+ * @note
+ * @param[in]  priMask: 0: 开中断。非 0: 关中断
+ * @retval None
+ */
+void __set_PRIMASK(uint32_t priMask)
+{
+    if (priMask)
+        __disable_irq();
+    else
+        __enable_irq();
+}
+
+
+/**
+ * @brief  关中断
+ * @note   持有中断锁后，时钟线程和 UART 接收线程均无法进入“中断”
+ * @retval None
+ */
+void __disable_irq(void)
+{
+    if (_primask == 0)
+    {
+        pthread_mutex_lock(&_irq_lock);
+        _primask = 1;
+    }
+}
+
+
+/**
+ * @brief  开中断
+ * @note
+ * @retval None
+ */
+void __enable_irq(void)
+{
+    if (_primask)
+    {
+        _primask = 0;
+        pthread_mutex_unlock(&_irq_lock);
+    }
+}
+
+
+/**
+ * @brief  HAL 初始化，启动模拟 SysTick 的时钟线程
+ * @note
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_Init(void)
+{
+    if (host_cfg.trace_file && _trace == NULL)
+    {
+        _trace = fopen(host_cfg.trace_file, "a");
+        if (_trace == NULL)
+            fprintf(stderr, "open trace %s failed: %s\n", host_cfg.trace_file, strerror(errno));
+        else
+            setvbuf(_trace, NULL, _IOLBF, 0);
+    }
+    HOST_Trace("start");
+
+    _is_running = true;
+
+    if (pthread_create(&_systick_thread, NULL, _SysTick_Thread, NULL) != 0)
+    {
+        _is_running = false;
+        return HAL_ERROR;
+    }
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  停止所有仿真外设
+ * @note   不能在“中断”中调用
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_DeInit(void)
+{
+    if (_is_running == false)
+        return HAL_OK;
+
+    /* 确保“中断”线程能够退出 */
+    __enable_irq();
+    _is_running = false;
+    pthread_join(_systick_thread, NULL);
+
+    for (uint8_t i = 0; i < sizeof(_usart_group) / sizeof(_usart_group[0]); i++)
+    {
+        USART_TypeDef *usart = _usart_group[i];
+        if (usart->fd < 0)
+            continue;
+
+        pthread_join(usart->rx_thread, NULL);
+        HOST_Trace("uart %s rx=%llu tx=%llu", usart->name,
+                   (unsigned long long)usart->rx_bytes, (unsigned long long)usart->tx_bytes);
+        close(usart->fd);
+        usart->fd = -1;
+        if (usart->link)
+            unlink(usart->link);
+    }
+
+    for (uint8_t i = 0; i < sizeof(_spi_group) / sizeof(_spi_group[0]); i++)
+    {
+        if (_spi_group[i]->nor.dev.mem == NULL)
+            continue;
+        HOST_Flash_PrintStats(&_spi_group[i]->nor.dev, stderr);
+        _Flash_TraceStats(&_spi_group[i]->nor.dev);
+        HOST_Flash_Close(&_spi_group[i]->nor.dev);
+    }
+
+    if (host_onchip_flash.mem)
+    {
+        HOST_Flash_PrintStats(&host_onchip_flash, stderr);
+        _Flash_TraceStats(&host_onchip_flash);
+        HOST_Flash_Close(&host_onchip_flash);
+    }
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  tick 计数加 1
+ * @note   由 SysTick_Handler 调用
+ * @retval None
+ */
+void HAL_IncTick(void)
+{
+    _tick++;
+}
+
+
+/**
+ * @brief  获取 tick 计数
+ * @note
+ * @retval tick 计数，单位 ms
+ */
+uint32_t HAL_GetTick(void)
+{
+    return _tick;
+}
+
+
+/**
+ * @brief  阻塞延时
+ * @note
+ * @param[in]  Delay: 延时时间，单位 ms
+ * @retval None
+ */
+void HAL_Delay(uint32_t Delay)
+{
+    uint32_t tick_start = HAL_GetTick();
+
+    while ((HAL_GetTick() - tick_start) < Delay)
+    {
+        usleep(100);
+    }
+}
+
+
+/**
+ * @brief  系统复位
+ * @note   停止仿真外设后以相同的参数重新执行本程序， flash 镜像保持不变
+ * @retval None
+ */
+void HAL_NVIC_SystemReset(void)
+{
+    HAL_DeInit();
+    fflush(stdout);
+
+    execv("/proc/self/exe", host_cfg.argv);
+
+    fprintf(stderr, "system reset failed: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * @brief  停止仿真外设并退出
+ * @note
+ * @param[in]  code: 进程退出码
+ * @retval None
+ */
+void HOST_Exit(int code)
+{
+    HAL_DeInit();
+    HOST_Trace("exit %d", code);
+    fflush(stdout);
+    exit(code);
+}
+
+
+/**
+ * @brief  输出一行 trace
+ * @note   未指定 trace 文件时不输出，可在任意线程调用
+ * @param[in]  fmt: 事件及参数的格式
+ * @retval None
+ */
+void HOST_Trace(const char *fmt, ...)
+{
+    va_list args;
+
+    if (_trace == NULL)
+        return;
+
+    pthread_mutex_lock(&_trace_lock);
+    fprintf(_trace, "%llu ", (unsigned long long)HOST_Flash_Now());
+    va_start(args, fmt);
+    vfprintf(_trace, fmt, args);
+    va_end(args);
+    fputc('\n', _trace);
+    pthread_mutex_unlock(&_trace_lock);
+}
+
+
+/**
+ * @brief  初始化 perf_counter
+ * @note   主机仿真没有 SysTick 的计数器，以 CLOCK_MONOTONIC 作为时间基准，无须初始化
+ * @param[in]  bIsSysTickOccupied: 未使用
+ * @retval None
+ */
+void init_cycle_counter(bool bIsSysTickOccupied)
+{
+    (void)bIsSysTickOccupied;
+}
+
+
+/**
+ * @brief  获取 perf_counter 的 tick
+ * @note   主机仿真的 1 tick 为 1 ns
+ * @retval tick
+ */
+int64_t get_system_ticks(void)
+{
+    return (int64_t)HOST_Flash_Now();
+}
+
+
+/**
+ * @brief  tick 换算为 us
+ * @note   
+ * @param[in]  lTick: tick
+ * @retval us
+ */
+int64_t perfc_convert_ticks_to_us(int64_t lTick)
+{
+    return lTick / 1000;
+}
+
+
+/**
+ * @brief  将 flash 镜像文件映射到 flash 基地址
+ * @note   镜像文件不存在时会新建并填充为擦除状态 (0xFF)
+ * @param[in]  file: 镜像文件路径
+ * @param[in]  model: flash 器件模型
+ * @param[in]  base: flash 基地址
+ * @param[in]  size: flash 容量，单位 byte
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HOST_FLASH_Init(const char *file, const struct HOST_FLASH_MODEL *model, uint32_t base, uint32_t size)
+{
+    if (HOST_Flash_Open(&host_onchip_flash, "onchip_flash", model, file, base, size) != 0)
+        return HAL_ERROR;
+
+    _flash_base = base;
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  解锁 flash 控制寄存器
+ * @note
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    _is_flash_unlock = true;
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  锁定 flash 控制寄存器
+ * @note
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    _is_flash_unlock = false;
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  在指定地址写入半字、字、双字或快速编程一行
+ * @note   1. 写入的尺寸小于器件的编程单元时报错，如 STM32L4 只能按双字写入
+ *         2. 写入的尺寸大于编程单元时按多个编程单元计时，如 STM32F1 按字写入即两次半字编程
+ *         3. 写入的尺寸等于模型的 burst_unit 时按一次快速编程计时，如 STM32F407 外接 VPP 时的 x64 双字编程
+ *         4. FLASH_TYPEPROGRAM_FAST 时 Data 为 burst_unit 大小的数据的地址，模型不支持行编程时报错
+ *         5. 先等待中断方式的擦写结束，再阻塞至模型的编程时间结束
+ * @param[in]  TypeProgram: FLASH_TYPEPROGRAM_HALFWORD / WORD / DOUBLEWORD / FAST
+ * @param[in]  Address: 写入的地址
+ * @param[in]  Data: 写入的数据，或一行数据的地址
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    int64_t time_us;
+
+    FLASH_WaitForLastOperation(FLASH_TIMEOUT_VALUE);
+
+    time_us = _Flash_Program(TypeProgram, Address, Data);
+    if (time_us < 0)
+        return HAL_ERROR;
+
+    HOST_Flash_Wait(time_us);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  以中断方式写入半字、字、双字或快速编程一行
+ * @note   1. 数据立即写入镜像，之后 FLASH_FLAG_BSY 保持至模型的编程时间结束，期间本线程不阻塞
+ *         2. 忙期间再次调用时接在上一次编程之后，相当于在编程完成中断中启动下一个单元
+ * @param[in]  TypeProgram: FLASH_TYPEPROGRAM_HALFWORD / WORD / DOUBLEWORD / FAST
+ * @param[in]  Address: 写入的地址
+ * @param[in]  Data: 写入的数据，或一行数据的地址
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_FLASH_Program_IT(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    int64_t time_us;
+
+    time_us = _Flash_Program(TypeProgram, Address, Data);
+    if (time_us < 0)
+        return HAL_ERROR;
+
+    _flash_busy_until = HOST_Flash_Deadline(_flash_busy_until, time_us);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  按页擦除 flash
+ * @note   主机仿真的页即器件模型的 sector ，先等待中断方式的擦写结束，再阻塞至模型的擦除时间结束
+ * @param[in]   pEraseInit: 擦除参数
+ * @param[out]  PageError: 出错时的页地址
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    int64_t time_us;
+
+    FLASH_WaitForLastOperation(FLASH_TIMEOUT_VALUE);
+
+    time_us = _Flash_Erase(pEraseInit, PageError);
+    if (time_us < 0)
+        return HAL_ERROR;
+
+    HOST_Flash_Wait(time_us);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  以中断方式按页擦除 flash
+ * @note   数据立即擦除，之后 FLASH_FLAG_BSY 保持至模型的擦除时间结束，期间本线程不阻塞
+ * @param[in]  pEraseInit: 擦除参数
+ * @retval HAL Status ，上一次擦写未结束时为 HAL_BUSY
+ */
+HAL_StatusTypeDef HAL_FLASHEx_Erase_IT(FLASH_EraseInitTypeDef *pEraseInit)
+{
+    int64_t  time_us;
+    uint32_t PageError;
+
+    if (__HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY))
+        return HAL_BUSY;
+
+    time_us = _Flash_Erase(pEraseInit, &PageError);
+    if (time_us < 0)
+        return HAL_ERROR;
+
+    _flash_busy_until = HOST_Flash_Deadline(0, time_us);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  等待 flash 的擦写结束
+ * @note   CPU 访问正在擦写的 flash 时同样会停顿至擦写结束
+ * @param[in]  Timeout: 超时时间，单位 ms
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef FLASH_WaitForLastOperation(uint32_t Timeout)
+{
+    uint64_t now = HOST_Flash_Now();
+
+    if (_flash_busy_until <= now)
+        return HAL_OK;
+
+    if (_flash_busy_until - now > (uint64_t)Timeout * 1000000)
+        return HAL_TIMEOUT;
+
+    _SleepUntil(_flash_busy_until);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  获取 flash 的状态标志
+ * @note   仅支持 FLASH_FLAG_BSY
+ * @param[in]  Flag: 状态标志
+ * @retval 1: 标志置位 0: 标志清零
+ */
+uint32_t HOST_FLASH_GetFlag(uint32_t Flag)
+{
+    if (Flag == FLASH_FLAG_BSY)
+        return (HOST_Flash_Now() < _flash_busy_until);
+
+    return 0;
+}
+
+
+/**
+ * @brief  打开 SPI 总线上的 NOR flash
+ * @note   
+ * @param[in]  hspi: SPI 句柄
+ * @param[in]  file: flash 镜像文件路径
+ * @param[in]  model: flash 器件模型
+ * @param[in]  cs_port: 片选所在的 GPIO 端口
+ * @param[in]  cs_pin: 片选引脚
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HOST_SPI_Open(SPI_HandleTypeDef *hspi, const char *file, const struct HOST_FLASH_MODEL *model,
+                                GPIO_TypeDef *cs_port, uint16_t cs_pin)
+{
+    SPI_TypeDef *spi = hspi->Instance;
+
+    if (HOST_SpiNor_Open(&spi->nor, "spi_flash", model, file) != 0)
+        return HAL_ERROR;
+
+    spi->cs_port = cs_port;
+    spi->cs_pin  = cs_pin;
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  设置 GPIO 的输出电平
+ * @note   引脚若是 SPI flash 的片选，低电平选中
+ * @param[in]  GPIOx: GPIO 端口
+ * @param[in]  GPIO_Pin: 引脚
+ * @param[in]  PinState: 电平
+ * @retval None
+ */
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~GPIO_Pin;
+
+    for (uint8_t i = 0; i < sizeof(_spi_group) / sizeof(_spi_group[0]); i++)
+    {
+        SPI_TypeDef *spi = _spi_group[i];
+        if (spi->cs_port == GPIOx && (spi->cs_pin & GPIO_Pin))
+            HOST_SpiNor_Select(&spi->nor, PinState == GPIO_PIN_RESET);
+    }
+}
+
+
+/**
+ * @brief  SPI 发送
+ * @note   
+ * @param[in]  hspi: SPI 句柄
+ * @param[in]  pData: 发送的数据
+ * @param[in]  Size: 数据长度，单位 byte
+ * @param[in]  Timeout: 超时时间，单位 ms ，未使用
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    if (hspi->Instance->nor.dev.mem == NULL)
+        return HAL_ERROR;
+
+    HOST_SpiNor_Transfer(&hspi->Instance->nor, pData, NULL, Size);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  SPI 接收
+ * @note   
+ * @param[in]   hspi: SPI 句柄
+ * @param[out]  pData: 接收的数据
+ * @param[in]   Size: 数据长度，单位 byte
+ * @param[in]   Timeout: 超时时间，单位 ms ，未使用
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    if (hspi->Instance->nor.dev.mem == NULL)
+        return HAL_ERROR;
+
+    HOST_SpiNor_Transfer(&hspi->Instance->nor, NULL, pData, Size);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  为 UART 创建 PTY 并启动接收线程
+ * @note   上位机打开 PTY 的从设备即可与 bootloader 通讯
+ * @param[in]  huart: UART 句柄
+ * @param[in]  link: 指向从设备的符号链接路径，可为 NULL
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HOST_UART_Open(UART_HandleTypeDef *huart, const char *link)
+{
+    struct termios tio;
+    USART_TypeDef *usart = huart->Instance;
+
+    usart->fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (usart->fd < 0
+    ||  grantpt(usart->fd) != 0
+    ||  unlockpt(usart->fd) != 0
+    ||  ptsname_r(usart->fd, usart->name, sizeof(usart->name)) != 0)
+    {
+        fprintf(stderr, "create pty failed: %s\n", strerror(errno));
+        return HAL_ERROR;
+    }
+
+    /* 线路上传输的是二进制数据，必须是 raw 模式。 PTY 的波特率即上位机一端的波特率，初始与 UART 一致 */
+    tcgetattr(usart->fd, &tio);
+    cfmakeraw(&tio);
+    for (size_t i = 0; i < sizeof(_uart_speed) / sizeof(_uart_speed[0]); i++)
+    {
+        if (_uart_speed[i].baudrate == usart->baudrate)
+            cfsetspeed(&tio, _uart_speed[i].speed);
+    }
+    tcsetattr(usart->fd, TCSANOW, &tio);
+    fcntl(usart->fd, F_SETFL, fcntl(usart->fd, F_GETFL) | O_NONBLOCK);
+
+    if (link)
+    {
+        unlink(link);
+        if (symlink(usart->name, link) != 0)
+        {
+            fprintf(stderr, "symlink %s failed: %s\n", link, strerror(errno));
+            return HAL_ERROR;
+        }
+        usart->link = link;
+    }
+
+    if (pthread_create(&usart->rx_thread, NULL, _UART_RxThread, usart) != 0)
+        return HAL_ERROR;
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  按 huart->Init 配置 UART
+ * @note   仿真只使用其中的波特率，可在运行中调用以切换波特率，正在接收的数据按新的波特率计时
+ * @param[in]  huart: UART 句柄
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    if (huart->Init.BaudRate == 0)
+        return HAL_ERROR;
+
+    huart->Instance->baudrate = huart->Init.BaudRate;
+    HOST_Trace("baud %u", huart->Init.BaudRate);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  UART 阻塞发送
+ * @note   没有上位机连接 PTY 时，数据如同发到悬空的线路上，直接丢弃
+ * @param[in]  huart: UART 句柄
+ * @param[in]  pData: 要发送的数据
+ * @param[in]  Size: 数据长度，单位 byte
+ * @param[in]  Timeout: 超时时间，单位 ms
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    uint16_t sent = 0;
+    uint32_t tick_start = HAL_GetTick();
+    USART_TypeDef *usart = huart->Instance;
+    uint8_t  noise[256];
+    bool     is_line_err = _UART_IsLineError(usart);
+
+    while (sent < Size)
+    {
+        struct pollfd pfd = { .fd = usart->fd, .events = POLLOUT };
+        const uint8_t *data = &pData[sent];
+        uint16_t size = Size - sent;
+
+        if (poll(&pfd, 1, 1) > 0 && (pfd.revents & POLLHUP))
+            return HAL_OK;
+
+        /* 线路出错时，上位机收到的是乱码 */
+        if (is_line_err)
+        {
+            if (size > sizeof(noise))
+                size = sizeof(noise);
+            memcpy(noise, data, size);
+            _UART_LineNoise(noise, size);
+            data = noise;
+        }
+
+        ssize_t len = write(usart->fd, data, size);
+        if (len > 0)
+        {
+            sent += len;
+            usart->tx_bytes += len;
+            continue;
+        }
+
+        if (len < 0 && errno != EAGAIN && errno != EINTR)
+            return HAL_OK;
+
+        if ((HAL_GetTick() - tick_start) > Timeout)
+            return HAL_TIMEOUT;
+    }
+
+    /* 阻塞至按波特率发送完成 */
+    if (host_cfg.baudrate)
+        _SleepUntil(HOST_Flash_Now() + _UART_ByteTime(usart, Size));
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  启动 UART 的 DMA 循环接收
+ * @note
+ * @param[in]  huart: UART 句柄，接收回调时原样传回
+ * @param[in]  pData: DMA 循环接收的缓存
+ * @param[in]  Size: 缓存大小，单位 byte
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    USART_TypeDef *usart = huart->Instance;
+
+    if (pData == NULL || Size == 0 || huart->hdmarx == NULL)
+        return HAL_ERROR;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    usart->rx_huart      = huart;
+    usart->rx_buff       = pData;
+    usart->rx_size       = Size;
+    usart->rx_pos        = 0;
+    huart->hdmarx->CNDTR = Size;
+    usart->rx_enable     = true;
+
+    __set_PRIMASK(primask);
+
+    return HAL_OK;
+}
+
+
+/**
+ * @brief  暂停 UART 的 DMA 接收
+ * @note
+ * @param[in]  huart: UART 句柄
+ * @retval HAL Status
+ */
+HAL_StatusTypeDef HAL_UART_DMAPause(UART_HandleTypeDef *huart)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    huart->Instance->rx_enable = false;
+    __set_PRIMASK(primask);
+
+    return HAL_OK;
+}
+
+
+/* 以下回调由 BSP 的 UART 移植文件实现 */
+__WEAK void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__WEAK void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__WEAK void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    (void)huart;
+    (void)Size;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  模拟 SysTick 的时钟线程
+ * @note   以绝对时间推进，被“关中断”阻塞后会连续补上错过的 tick
+ * @param[in]  arg: 未使用
+ * @retval NULL
+ */
+static void *_SysTick_Thread(void *arg)
+{
+    struct timespec next;
+
+    (void)arg;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (_is_running)
+    {
+        next.tv_nsec += 1000000;
+        if (next.tv_nsec >= 1000000000)
+        {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        __disable_irq();
+        SysTick_Handler();
+        __enable_irq();
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief  模拟 UART 接收的线程
+ * @note   收到的数据按 DMA 循环模式写入接收缓存，超过 HOST_UART_IDLE_TIME_MS 没有新数据则产生空闲中断
+ * @param[in]  arg: USART_TypeDef 对象
+ * @retval NULL
+ */
+static void *_UART_RxThread(void *arg)
+{
+    uint8_t buff[256];
+    size_t  read_size = sizeof(buff);
+    bool    is_recv = false;
+    USART_TypeDef *usart = (USART_TypeDef *)arg;
+
+    while (_is_running)
+    {
+        struct pollfd pfd = { .fd = usart->fd, .events = POLLIN };
+
+        /* 限速时每次最多读取约 1 ms 的数据量，使 DMA 的半满、全满中断时刻与真实的串口接近，波特率可能在运行中切换 */
+        if (host_cfg.baudrate)
+        {
+            read_size = usart->baudrate / 10 / 1000;
+            if (read_size == 0)
+                read_size = 1;
+            else if (read_size > sizeof(buff))
+                read_size = sizeof(buff);
+        }
+
+        int ret = poll(&pfd, 1, is_recv ? HOST_UART_IDLE_TIME_MS : 10);
+
+        if (ret == 0)
+        {
+            if (is_recv)
+            {
+                is_recv = false;
+                _UART_IdleEvent(usart);
+            }
+            continue;
+        }
+        else if (ret < 0)
+            continue;
+
+        if (pfd.revents & POLLIN)
+        {
+            ssize_t len = read(usart->fd, buff, read_size);
+            if (len > 0)
+            {
+                /* 按波特率，等待这些数据在接收线上传输完成 */
+                if (host_cfg.baudrate)
+                {
+                    uint64_t now = HOST_Flash_Now();
+                    if (usart->rx_line_free < now)
+                        usart->rx_line_free = now;
+                    usart->rx_line_free += _UART_ByteTime(usart, len);
+                    _SleepUntil(usart->rx_line_free);
+                }
+                if (_UART_IsLineError(usart))
+                    _UART_LineNoise(buff, len);
+                usart->rx_bytes += len;
+                _UART_DmaReceive(usart, buff, len);
+                is_recv = true;
+                continue;
+            }
+        }
+
+        /* 上位机还未打开或已关闭 PTY */
+        if (pfd.revents & (POLLHUP | POLLERR))
+            usleep(10 * 1000);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief  按 DMA 循环模式将数据写入接收缓存
+ * @note   在“中断”中执行，半满和全满时调用对应的回调
+ * @param[in]  usart: USART_TypeDef 对象
+ * @param[in]  data: 收到的数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval None
+ */
+static void _UART_DmaReceive(USART_TypeDef *usart, const uint8_t *data, size_t len)
+{
+    __disable_irq();
+
+    for (size_t i = 0; i < len && usart->rx_enable; i++)
+    {
+        UART_HandleTypeDef *huart = usart->rx_huart;
+
+        usart->rx_buff[ usart->rx_pos++ ] = data[i];
+
+        if (usart->rx_pos >= usart->rx_size)
+        {
+            usart->rx_pos = 0;
+            huart->hdmarx->CNDTR = usart->rx_size;
+            HAL_UART_RxCpltCallback(huart);
+        }
+        else
+        {
+            huart->hdmarx->CNDTR = usart->rx_size - usart->rx_pos;
+            if (usart->rx_pos == usart->rx_size / 2)
+                HAL_UART_RxHalfCpltCallback(huart);
+        }
+    }
+
+    __enable_irq();
+}
+
+
+/**
+ * @brief  产生 UART 空闲中断
+ * @note
+ * @param[in]  usart: USART_TypeDef 对象
+ * @retval None
+ */
+static void _UART_IdleEvent(USART_TypeDef *usart)
+{
+    __disable_irq();
+
+    if (usart->rx_enable)
+    {
+        UART_HandleTypeDef *huart = usart->rx_huart;
+        HAL_UARTEx_RxEventCallback(huart, usart->rx_size - huart->hdmarx->CNDTR);
+    }
+
+    __enable_irq();
+}
+
+
+/**
+ * @brief  按 UART 当前的波特率计算传输时间
+ * @note   每 byte 按 1 起始位 + 8 数据位 + 1 停止位计算
+ * @param[in]  usart: USART_TypeDef 对象
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval 传输时间，单位 ns
+ */
+static uint64_t _UART_ByteTime(const USART_TypeDef *usart, size_t len)
+{
+    return (uint64_t)len * 10 * 1000000000 / usart->baudrate;
+}
+
+
+/**
+ * @brief  线路是否无法正确传输数据
+ * @note   UART 的波特率超过 -B 指定的线路上限，或与上位机在 PTY 上设置的波特率相差超过 3% 时出错
+ * @param[in]  usart: USART_TypeDef 对象
+ * @retval true: 出错 | false: 正常
+ */
+static bool _UART_IsLineError(USART_TypeDef *usart)
+{
+    struct termios tio;
+    uint32_t peer = 0;
+
+    if (host_cfg.line_baudrate == 0)
+        return false;
+
+    if (usart->baudrate > host_cfg.line_baudrate)
+        return true;
+
+    /* 主设备读到的是从设备，即上位机一端的配置 */
+    if (tcgetattr(usart->fd, &tio) != 0)
+        return false;
+
+    for (size_t i = 0; i < sizeof(_uart_speed) / sizeof(_uart_speed[0]); i++)
+    {
+        if (_uart_speed[i].speed == cfgetospeed(&tio))
+            peer = _uart_speed[i].baudrate;
+    }
+
+    if (peer == 0)
+        return true;
+
+    uint32_t diff = (peer > usart->baudrate) ? (peer - usart->baudrate) : (usart->baudrate - peer);
+    return ((uint64_t)diff * 100 > (uint64_t)peer * 3);
+}
+
+
+/**
+ * @brief  将数据替换为乱码
+ * @note   波特率不匹配时接收方采样到的是错位的比特，以伪随机数代替
+ * @param[in]  data: 数据
+ * @param[in]  len: 数据长度，单位 byte
+ * @retval None
+ */
+static void _UART_LineNoise(uint8_t *data, size_t len)
+{
+    static uint32_t seed = 0x12345678;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] ^= (uint8_t)(seed >> 16) | 0x01;
+    }
+}
+
+
+/**
+ * @brief  休眠至指定时刻
+ * @note   
+ * @param[in]  time_ns: CLOCK_MONOTONIC 时刻，单位 ns
+ * @retval None
+ */
+static void _SleepUntil(uint64_t time_ns)
+{
+    struct timespec ts = 
+    {
+        .tv_sec  = time_ns / 1000000000,
+        .tv_nsec = time_ns % 1000000000,
+    };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+
+/**
+ * @brief  输出 flash 的操作统计至 trace
+ * @note   时间均为模型时间
+ * @param[in]  dev: flash 对象
+ * @retval None
+ */
+static void _Flash_TraceStats(const struct HOST_FLASH_DEV *dev)
+{
+    const struct HOST_FLASH_STATS *stats = &dev->stats;
+
+    HOST_Trace("flash %s erase=%u erase_us=%llu program=%u program_bytes=%llu program_us=%llu "
+               "read_bytes=%llu read_us=%llu violation=%u",
+               dev->name,
+               stats->erase_count, (unsigned long long)stats->erase_time_us,
+               stats->program_count, (unsigned long long)stats->program_bytes, (unsigned long long)stats->program_time_us,
+               (unsigned long long)stats->read_bytes, (unsigned long long)stats->read_time_us,
+               stats->rule_violation);
+}
+
+
+/**
+ * @brief  按编程方式写入镜像
+ * @note   见 HAL_FLASH_Program 的说明
+ * @param[in]  TypeProgram: FLASH_TYPEPROGRAM_HALFWORD / WORD / DOUBLEWORD / FAST
+ * @param[in]  Address: 写入的地址
+ * @param[in]  Data: 写入的数据，或一行数据的地址
+ * @retval < 0: 失败。其他: 模型的编程时间，单位 us
+ */
+static int64_t _Flash_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint16_t size;
+    const uint8_t *data = (const uint8_t *)&Data;
+    const struct HOST_FLASH_MODEL *model = host_onchip_flash.model;
+
+    if (TypeProgram == FLASH_TYPEPROGRAM_HALFWORD)
+        size = 2;
+    else if (TypeProgram == FLASH_TYPEPROGRAM_WORD)
+        size = 4;
+    else if (TypeProgram == FLASH_TYPEPROGRAM_DOUBLEWORD)
+        size = 8;
+    else
+    {
+        size = model->burst_unit;
+        data = (const uint8_t *)(uintptr_t)Data;
+        if (size <= sizeof(uint64_t))
+            return -1;
+    }
+
+    if (_is_flash_unlock == false
+    ||  Address < _flash_base
+    ||  size < model->program_unit)
+    {
+        return -1;
+    }
+
+    if (size == model->burst_unit)
+        return HOST_Flash_ProgramBurst(&host_onchip_flash, Address - _flash_base, data);
+
+    return HOST_Flash_Program(&host_onchip_flash, Address - _flash_base, data, size);
+}
+
+
+/**
+ * @brief  按页擦除镜像
+ * @note   见 HAL_FLASHEx_Erase 的说明
+ * @param[in]   pEraseInit: 擦除参数
+ * @param[out]  PageError: 出错时的页地址
+ * @retval < 0: 失败。其他: 模型的擦除时间，单位 us
+ */
+static int64_t _Flash_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    int64_t  time_us, total_us = 0;
+    uint32_t sector_offset, sector_size;
+    uint32_t addr = pEraseInit->PageAddress;
+
+    *PageError = 0xFFFFFFFF;
+
+    if (_is_flash_unlock == false)
+        return -1;
+
+    if (pEraseInit->TypeErase == FLASH_TYPEERASE_MASSERASE)
+        return HOST_Flash_Erase(&host_onchip_flash, 0, host_onchip_flash.size, 0);
+
+    for (uint32_t i = 0; i < pEraseInit->NbPages; i++)
+    {
+        if (addr < _flash_base
+        ||  HOST_Flash_GetSector(&host_onchip_flash, addr - _flash_base, &sector_offset, &sector_size) < 0
+        ||  sector_offset != addr - _flash_base)
+        {
+            *PageError = addr;
+            return -1;
+        }
+
+        time_us = HOST_Flash_Erase(&host_onchip_flash, sector_offset, sector_size, 0);
+        if (time_us < 0)
+        {
+            *PageError = addr;
+            return -1;
+        }
+        total_us += time_us;
+
+        addr += sector_size;
+    }
+
+    return total_us;
+}
@@ -0,0 +1,257 @@
+/**
+ * \file            main.c
+ * \brief           entry of the Linux host simulation
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 -m 、 -t 、 -s 参数，选择 flash 器件模型和时间缩放
+ * v1.2     2026-10-18                  增加 -b 、 -T 参数，仿真 UART 波特率和输出 trace
+ * v1.3     2026-10-18                  增加 -B 参数，仿真线路能传输的最高波特率
+ * v1.4     2026-10-18                  增加 UART2 及 -L 参数，作为 bootloader 的第二个数据接口
+ * v1.5     2026-10-18                  不限速时初始波特率按 UART 能设置的最高波特率记录
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "main.h"
+#include "bootloader_config.h"
+
+
+/* Private define ------------------------------------------------------------*/
+#define UART_UNLIMITED_BAUDRATE     4500000U    /* 不限速时记录的波特率，即 72MHz 的 UART 时钟按 16 倍过采样的最高波特率 */
+
+
+/* Exported variables ---------------------------------------------------------*/
+struct HOST_CONFIG  host_cfg = 
+{
+    .flash_file      = "flash.bin",
+    .flash_model     = "stm32f1",
+    .spi_flash_file  = "spi_flash.bin",
+    .spi_flash_model = "w25q128",
+    .time_scale      = 100,
+    .uart_link       = NULL,
+    .uart2_link      = NULL,
+    .baudrate        = 0,
+    .line_baudrate   = 0,
+    .trace_file      = NULL,
+    .quiet           = false,
+};
+
+UART_HandleTypeDef  huart1;
+UART_HandleTypeDef  huart2;
+DMA_HandleTypeDef   hdma_usart1_rx;
+DMA_HandleTypeDef   hdma_usart2_rx;
+SPI_HandleTypeDef   hspi2;
+
+
+/* Extern function prototypes ------------------------------------------------*/
+extern void System_Init(void);
+extern void APP_Init(void);
+extern void APP_Running(void);
+
+
+/* Private function prototypes -----------------------------------------------*/
+static void _Usage              (const char *name);
+static void MX_FLASH_Init       (void);
+static void MX_USART1_UART_Init (void);
+static void MX_USART2_UART_Init (void);
+#if (IS_ENABLE_SPI_FLASH)
+static void MX_SPI2_Init        (void);
+#endif
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  主机仿真的入口
+ * @note   
+ * @param[in]  argc: 参数数量
+ * @param[in]  argv: 参数列表
+ * @retval 进程退出码
+ */
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    host_cfg.argc = argc;
+    host_cfg.argv = argv;
+
+    while ((opt = getopt(argc, argv, "f:m:s:t:l:L:b:B:T:qh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f': host_cfg.flash_file     = optarg;                         break;
+            case 'm': host_cfg.flash_model    = optarg;                         break;
+            case 's': host_cfg.spi_flash_file = optarg;                         break;
+            case 't': host_cfg.time_scale     = strtoul(optarg, NULL, 0);       break;
+            case 'l': host_cfg.uart_link      = optarg;                         break;
+            case 'L': host_cfg.uart2_link     = optarg;                         break;
+            case 'b': host_cfg.baudrate       = strtoul(optarg, NULL, 0);       break;
+            case 'B': host_cfg.line_baudrate  = strtoul(optarg, NULL, 0);       break;
+            case 'T': host_cfg.trace_file     = optarg;                         break;
+            case 'q': host_cfg.quiet          = true;                           break;
+            default : _Usage(argv[0]);                                          return EXIT_FAILURE;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    HAL_Init();
+    System_Init();
+    
+    MX_FLASH_Init();
+#if (IS_ENABLE_SPI_FLASH)
+    MX_SPI2_Init();
+#endif
+    MX_USART1_UART_Init();
+    MX_USART2_UART_Init();
+    
+    APP_Init();
+    APP_Running();
+
+    return EXIT_SUCCESS;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  打印使用说明
+ * @note   
+ * @param[in]  name: 程序名
+ * @retval None
+ */
+static void _Usage(const char *name)
+{
+    const struct HOST_FLASH_MODEL *model;
+
+    fprintf(stderr, "usage: %s [-f flash.bin] [-m model] [-s spi_flash.bin] [-t scale] [-l uart_link] [-L uart2_link] [-b baud] [-B line_baud] [-T trace] [-q]\n"
+                    "  -f  flash image file, created and erased if missing (default: flash.bin)\n"
+                    "  -m  onchip flash model (default: stm32f1)\n"
+                    "  -s  SPI flash image file, used when SPI flash is enabled (default: spi_flash.bin)\n"
+                    "  -t  flash timing scale in percent, 0 to count only, 100 for real device (default: 100)\n"
+                    "  -l  create a symlink to the UART1 pty, e.g. /tmp/mota_uart\n"
+                    "  -L  create a symlink to the UART2 pty, the bootloader listens on both UARTs\n"
+                    "  -b  simulated UART baud rate, 0 for unlimited (default: 0)\n"
+                    "  -B  highest baud rate the line carries, data is corrupted above it or when the\n"
+                    "      pty speed set by the sender differs from UART1, 0 to disable (default: 0)\n"
+                    "  -T  append timestamped events (flow, uart, flash stats) to a trace file\n"
+                    "  -q  quiet, disable BSP_Printf output\n"
+                    "flash models:\n", name);
+
+    for (uint8_t i = 0; (model = HOST_Flash_GetModel(i)) != NULL; i++)
+        fprintf(stderr, "  %-10s %s\n", model->name, model->desc);
+}
+
+
+/**
+ * @brief  按器件模型映射片内 flash 镜像
+ * @note   
+ * @retval None
+ */
+static void MX_FLASH_Init(void)
+{
+    const struct HOST_FLASH_MODEL *model = HOST_Flash_FindModel(host_cfg.flash_model);
+
+    if (model == NULL)
+    {
+        fprintf(stderr, "unknown flash model: %s\n", host_cfg.flash_model);
+        _Usage(host_cfg.argv[0]);
+        HOST_Exit(EXIT_FAILURE);
+    }
+
+    if (HOST_FLASH_Init(host_cfg.flash_file, model, FLASH_BASE, ONCHIP_FLASH_SIZE) != HAL_OK)
+        HOST_Exit(EXIT_FAILURE);
+}
+
+
+#if (IS_ENABLE_SPI_FLASH)
+/**
+ * @brief  SPI2 初始化，总线上挂一片 SPI NOR flash
+ * @note   
+ * @retval None
+ */
+static void MX_SPI2_Init(void)
+{
+    hspi2.Instance = SPI2;
+
+    if (HOST_SPI_Open(&hspi2, host_cfg.spi_flash_file, HOST_Flash_FindModel(host_cfg.spi_flash_model),
+                      FLASH_CS_GPIO_Port, FLASH_CS_Pin) != HAL_OK)
+    {
+        HOST_Exit(EXIT_FAILURE);
+    }
+
+    HAL_GPIO_WritePin(FLASH_CS_GPIO_Port, FLASH_CS_Pin, GPIO_PIN_SET);
+}
+#endif
+
+
+/**
+ * @brief  UART1 初始化，使用 DMA 循环接收
+ * @note   1. PTY 从设备路径输出至 stderr ，供上位机打开
+ *         2. 不限速时初始波特率按 UART_UNLIMITED_BAUDRATE 记录，供波特率协商和 YModem-G 估算积压的数据量使用
+ * @retval None
+ */
+static void MX_USART1_UART_Init(void)
+{
+    huart1.Instance = USART1;
+    huart1.Init.BaudRate = host_cfg.baudrate ? host_cfg.baudrate : UART_UNLIMITED_BAUDRATE;
+    huart1.hdmarx   = &hdma_usart1_rx;
+    huart1.hdmatx   = NULL;
+    hdma_usart1_rx.Parent = &huart1;
+
+    HAL_UART_Init(&huart1);
+    if (HOST_UART_Open(&huart1, host_cfg.uart_link) != HAL_OK)
+        HOST_Exit(EXIT_FAILURE);
+
+    fprintf(stderr, "UART1: %s\n", USART1->name);
+}
+
+
+/**
+ * @brief  UART2 初始化，使用 DMA 循环接收
+ * @note   作为 bootloader 的第二个数据接口，波特率与 UART1 相同
+ * @retval None
+ */
+static void MX_USART2_UART_Init(void)
+{
+    huart2.Instance = USART2;
+    huart2.Init.BaudRate = host_cfg.baudrate ? host_cfg.baudrate : UART_UNLIMITED_BAUDRATE;
+    huart2.hdmarx   = &hdma_usart2_rx;
+    huart2.hdmatx   = NULL;
+    hdma_usart2_rx.Parent = &huart2;
+
+    HAL_UART_Init(&huart2);
+    if (HOST_UART_Open(&huart2, host_cfg.uart2_link) != HAL_OK)
+        HOST_Exit(EXIT_FAILURE);
+
+    fprintf(stderr, "UART2: %s\n", USART2->name);
+}
@@ -29,11 +29,12 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.1
+ * Version:         v1.0.2
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-23     Dino         the first version
  * 2022-12-04     Dino         增加断帧检测
+ * 2026-10-18                  UART 的实现以 DT_Port_Ops 提供，断帧检测的状态改为每个接口独立
  */
 
 #ifndef __DATA_TRANSFER_PORT_H__
@@ -52,5 +53,7 @@ void    DT_Port_SendData        (struct DATA_TRANSFER *xfer, uint8_t *data, uint
 uint8_t DT_Port_IsRecvData      (struct DATA_TRANSFER *xfer);
 void    DT_Port_ClearRecvBuff   (struct DATA_TRANSFER *xfer);
 
+extern const struct DT_OPS DT_Port_Ops;
+
 #endif
 
@@ -0,0 +1,93 @@
+/**
+ * \file            protocol_frame.h
+ * \brief           incremental YModem frame parser
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.0
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ */
+
+#ifndef __PROTOCOL_FRAME_H__
+#define __PROTOCOL_FRAME_H__
+
+#include "protocol_parser.h"
+
+/**
+ * YModem 帧解析器，按帧头确定帧长，随接收逐段校验，最后一个校验字节到达时即得到完整的一帧，不依赖断帧检测的超时。
+ *
+ * 可识别的帧：
+ *    SOH / STX / STX_EXT 数据帧: | header | pkt_num | ~pkt_num | data | crc16 (2) / crc32 (4) |
+ *    EOT:                        | EOT |
+ *    CAN:                        | CAN | ... | ，连续的 CAN 视为一帧
+ *    波特率请求:                 | 'B' | num | baudrate (4 * num) | crc16 (2) |
+ *    探测帧:                     YMODEM_PROBE_FRAME
+ *    校验值均为高字节在前，帧结构见 protocol_parser.h
+ *
+ * 用法：
+ *    1. 接收缓存每次增加数据后，以缓存头部和当前长度调用 PF_Parse ，直至返回 PF_RESULT_NONE
+ *    2. 返回 PF_RESULT_FRAME 或 PF_RESULT_GARBAGE 时，使用者处理完后从缓存头部移除 out_len 个字节，再继续调用
+ *    3. 返回 PF_RESULT_NONE 时，缓存中已解析的数据不能移动或修改，解析器从上次的位置继续
+ *    4. 不是帧头的字节、正反序列号不符的数据帧头，均作为 PF_RESULT_GARBAGE 逐字节丢弃，以便在乱码之后重新同步
+ */
+
+/* 可识别的帧，由使用者按协议状态设置 struct PF_PARSER 的 accept */
+#define PF_ACCEPT_YMODEM            0x01        /* SOH STX EOT CAN */
+#define PF_ACCEPT_EXT               0x02        /* 扩展数据帧 */
+#define PF_ACCEPT_BAUD              0x04        /* 波特率请求 */
+#define PF_ACCEPT_PROBE             0x08        /* 探测帧 */
+
+typedef enum
+{
+    PF_RESULT_NONE = 0x00,          /* 还未收完一帧 */
+    PF_RESULT_FRAME,                /* 缓存头部 out_len 个字节为一个完整的帧，校验结果见 is_crc_ok */
+    PF_RESULT_GARBAGE,              /* 缓存头部 out_len 个字节不是帧，应丢弃 */
+
+} PF_RESULT;
+
+struct PF_PARSER
+{
+    uint8_t     accept;             /* 可识别的帧， PF_ACCEPT_* 的组合 */
+    bool        is_crc_ok;          /* 最近一个完整帧的校验是否正确，没有校验值的帧总为 true */
+    uint8_t     header;             /* 正在解析的帧头 */
+    uint16_t    pos;                /* 已解析的长度 */
+    uint16_t    frame_len;          /* 正在解析的帧长， 0: 还未确定 */
+    uint16_t    crc_start;          /* 校验范围的起始位置 */
+    uint16_t    crc_end;            /* 校验范围的结束位置，即校验值的位置 */
+    uint32_t    crc;                /* 已解析部分的校验值 */
+};
+
+
+#if (ENABLE_FRAME_PARSER)
+void        PF_Init         (struct PF_PARSER *pf, uint8_t accept);
+void        PF_Reset        (struct PF_PARSER *pf);
+PF_RESULT   PF_Parse        (struct PF_PARSER *pf, const uint8_t *data, uint16_t len, uint16_t *out_len);
+#endif
+
+#endif
@@ -48,9 +48,7 @@
 #endif
 #include "bsp_uart.h"
 #include "bsp_timer.h"
-#if (IS_ENABLE_SPI_FLASH == 0)
 #include "bsp_flash.h"
-#endif
 
 #define BSP_VERSION_MAIN                    (0x01U) /*!< [15:8] main version */
 #define BSP_VERSION_SUB                     (0x00U) /*!< [ 7:0] sub version */
@@ -29,7 +29,11 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.0.1
+ * Change Logs:
+ * Date           Author       Notes
+ * 2022-11-23     Dino         the first version
+ * 2026-10-18                  1. 收发经由接口的操作表，未指定时使用 data_transfer_port.c 的 UART 实现
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -39,6 +43,7 @@
 
 /* 数据传输层: 负责底层数据的收发，对上层提供初始化、发送、接收、是否接收到了一帧数据的接口 */
 /* 上层需指定接收数据用的缓冲区、缓冲区大小、用于指示缓冲区当前接收到数据的变量 */
+/* 每个传输控制块对应一个接口，多个接口可同时初始化，各自使用独立的接收缓冲区 */
 
 
 /* Exported functions ---------------------------------------------------------*/
@@ -47,13 +52,15 @@
  * @note   
  * @param[in]  xfer: 传输控制块对象
  * @param[in]  if_id: 传输接口 ID
+ * @param[in]  ops: 传输接口的操作表，为 NULL 时使用 DT_Port_Ops
  * @param[in]  buff: 用于接收数据的缓冲池，单位 byte
  * @param[in]  len: 指示接收到的数据长度，单位 byte
  * @param[in]  buff_size: 数据池最大容量，单位 byte
  * @retval None
  */
 void DT_Init(struct DATA_TRANSFER *xfer, 
-             uint8_t  if_id, 
+             uint32_t if_id, 
+             const struct DT_OPS *ops, 
              uint8_t  *buff, 
              uint16_t *len, 
              uint32_t buff_size)
@@ -61,11 +68,12 @@ void DT_Init(struct DATA_TRANSFER *xfer,
     ASSERT(xfer != NULL);
     
     xfer->if_id        = if_id;
+    xfer->ops          = ops ? ops : &DT_Port_Ops;
     xfer->rx_buff      = buff;
     xfer->rx_len       = len;
     xfer->rx_buff_size = buff_size;
   
-    DT_Port_Init(xfer);
+    xfer->ops->Init(xfer);
 }
 
 
@@ -79,7 +87,7 @@ void DT_Init(struct DATA_TRANSFER *xfer,
  */
 void DT_Send(struct DATA_TRANSFER *xfer, uint8_t *data, uint32_t len)
 {
-    DT_Port_SendData(xfer, data, len);
+    xfer->ops->Send(xfer, data, len);
 }
 
 
@@ -93,7 +101,7 @@ DT_RECV_DATA_RESULT  DT_PollingReceive(struct DATA_TRANSFER *xfer)
 {
     DT_RECV_DATA_RESULT  state = DT_RESULT_NO_DATA;
     
-    if (DT_Port_IsRecvData(xfer) == 0)
+    if (xfer->ops->Poll(xfer) == 0)
     {
         state = DT_RESULT_RECV_FRAME_DATA;
     }
@@ -110,7 +118,7 @@ DT_RECV_DATA_RESULT  DT_PollingReceive(struct DATA_TRANSFER *xfer)
  */
 inline void DT_ClearBuff(struct DATA_TRANSFER *xfer)
 {
-    DT_Port_ClearRecvBuff(xfer);
+    xfer->ops->Clear(xfer);
 }
 
 
@@ -29,24 +29,31 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.1
+ * Version:         v1.0.2
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-23     Dino         the first version
  * 2022-12-04     Dino         增加断帧检测
+ * 2026-10-18                  UART 的实现以 DT_Port_Ops 提供，断帧检测的状态改为每个接口独立
  */
 
 /* Includes ------------------------------------------------------------------*/
 #include "data_transfer_port.h"
 
 
-/* Private variables ---------------------------------------------------------*/
-#if (DT_ENABLE_BROKEN_FRAME_DETECT)
-static bool _is_timeout;
-static struct BSP_TIMER _timer_frame_detect;
+/* Exported variables ---------------------------------------------------------*/
+/* UART 接口的操作表，DT_Init 未指定操作表时使用 */
+const struct DT_OPS DT_Port_Ops = 
+{
+    .Init  = DT_Port_Init,
+    .Send  = DT_Port_SendData,
+    .Poll  = DT_Port_IsRecvData,
+    .Clear = DT_Port_ClearRecvBuff,
+};
 
 
 /* Private function prototypes -----------------------------------------------*/
+#if (DT_ENABLE_BROKEN_FRAME_DETECT)
 static void _Timeout_FrameDetect(void *user_data);
 #endif
 
@@ -68,11 +75,13 @@ void DT_Port_Init(struct DATA_TRANSFER *xfer)
                             xfer->rx_buff_size);
 
 #if (DT_ENABLE_BROKEN_FRAME_DETECT)
-    BSP_Timer_Init( &_timer_frame_detect, 
+    xfer->is_frame_timeout = false;
+    BSP_Timer_Init( &xfer->timer_frame_detect, 
                     _Timeout_FrameDetect, 
                     BROKEN_FRAME_INTERVAL_TIME, 
                     1, 
                     TIMER_TYPE_HARDWARE);   
+    BSP_Timer_LinkUserData(&xfer->timer_frame_detect, xfer);
 #endif    
 }
 
@@ -100,15 +109,14 @@ inline void DT_Port_SendData(struct DATA_TRANSFER *xfer, uint8_t *data, uint32_t
 inline uint8_t DT_Port_IsRecvData(struct DATA_TRANSFER *xfer)
 {
 #if (DT_ENABLE_BROKEN_FRAME_DETECT)
-    if (_is_timeout)
+    if (xfer->is_frame_timeout)
     {
-        _is_timeout = false;
+        xfer->is_frame_timeout = false;
         return BSP_UART_ERR_OK;
     }
     else if (BSP_UART_IsFrameEnd((BSP_UART_ID)xfer->if_id) == BSP_UART_ERR_OK)
     {
-        BSP_Timer_LinkUserData(&_timer_frame_detect, xfer);
-        BSP_Timer_Restart(&_timer_frame_detect);
+        BSP_Timer_Restart(&xfer->timer_frame_detect);
         return BSP_UART_ERR_NO_RECV_FRAME;
     }
     
@@ -128,7 +136,7 @@ inline uint8_t DT_Port_IsRecvData(struct DATA_TRANSFER *xfer)
 inline void DT_Port_ClearRecvBuff(struct DATA_TRANSFER *xfer)
 {
 #if (DT_ENABLE_BROKEN_FRAME_DETECT)
-    BSP_Timer_Pause(&_timer_frame_detect);
+    BSP_Timer_Pause(&xfer->timer_frame_detect);
 #endif
     BSP_UART_ClearUserBuff((BSP_UART_ID)xfer->if_id);
 }
@@ -139,12 +147,12 @@ inline void DT_Port_ClearRecvBuff(struct DATA_TRANSFER *xfer)
 /**
  * @brief  数据帧检测超时处理回调函数
  * @note   
- * @param[in]  user_data: 用户数据
+ * @param[in]  user_data: 超时的数据接口对象
  * @retval None
  */
 static void _Timeout_FrameDetect(void *user_data)
 {
-    _is_timeout = true;
+    ((struct DATA_TRANSFER *)user_data)->is_frame_timeout = true;
     BSP_Printf("frame detect clock time up!\r\n");
 }
 #endif
@@ -34,10 +34,26 @@
  * v1.0     2022-11-23     Dino         the first version
  * v1.1     2023-12-19     Dino         1. 修复单次解包失败而直接退出协议的问题
  *                                      2. 修复第一个为 STX 数据包时导致停发字符 C 的问题
+ * v1.2     2026-10-18                  1. 增加 YModem-G 的支持，数据帧连续下发，由 PP_StreamHandler 按帧长逐帧解析
+ * v1.3     2026-10-18                  1. 增加滑动窗口协议的配置转发，其会话期间不再发送握手字符
+ * v1.4     2026-10-18                  1. 增加 YModem 扩展数据帧，在第 0 帧协商，以 CRC32 校验
+ * v1.5     2026-10-18                  1. 流式接收改为移动读取位置移除已处理的数据，缓存为空时清空，空间不足一个最长的帧时才前移
+ * v1.6     2026-10-18                  1. 增加断点续传，在第 0 帧协商，固件包头所在数据帧的 ACK 之后应答续传位置
+ *                                      2. 第 0 帧的协商字段改为以空格分隔
+ * v1.7     2026-10-18                  1. 增加波特率协商，握手之后、第 0 帧之前切换至主机请求的波特率，以探测帧确认，超时恢复原波特率
+ * v1.8     2026-10-18                  1. 数据帧的 CRC16 和 CRC32 改用 crc_engine.c 的查表计算
+ * v1.9     2026-10-18                  1. 增加帧解析器，按帧结构逐段解析和校验，最后一个校验字节到达时即取出一帧，不再等待断帧检测
+ * v1.10    2026-10-18                  1. YModem-G 在第 0 帧估算 flash 的写入能否跟上通信速率，跟不上时回复 ACK ，改按 YModem 传输
  */
 
 /* Includes ------------------------------------------------------------------*/
 #include "protocol_parser.h"
+#if (ENABLE_WINDOW_PROTOCOL)
+#include "protocol_window.h"
+#endif
+#if (ENABLE_FRAME_PARSER)
+#include "protocol_frame.h"
+#endif
 
 
 /* Exported variables ---------------------------------------------------------*/
@@ -54,11 +70,42 @@ static YMODEM_EXE_FLOW          _exe_flow;              /* 记录协议的执行
 static union HOST_MESSAGE      *_host_msg;              /* 接收主机数据包的缓存池，称为主机消息 */
 static struct PP_DEV_TX_PKG     _dev_tx_pkg;            /* 用于存放设备上发数据组包的部分参数 */
 static struct BSP_TIMER         _timer_send_c;          /* 用于定时向主机发送数据的定时器 */
+#if (ENABLE_YMODEM_G)
+static volatile bool            _is_g_mode;             /* 以 'G' 握手，即按 YModem-G 传输 */
+static uint8_t                  _g_handshake_cnt;       /* 已发送 'G' 的次数 */
+static uint32_t                 _g_data_frame_cnt;      /* 本次传输已处理完的数据帧数 */
+#endif
+#if (IS_ENABLE_STREAM_HANDLER)
+static uint16_t                 _stream_frame_len;      /* 流式接收时，正在处理的数据帧长度 */
+static uint16_t                 _stream_head;           /* 流式接收时，接收缓存中已处理的数据长度，之后为未处理的数据 */
+static const uint8_t           *_stream_buff;           /* 流式接收时，_stream_head 对应的接收缓存 */
+#endif
+#if (ENABLE_FRAME_PARSER)
+static struct PF_PARSER         _frame_parser;          /* 流式接收时，逐段解析接收缓存的帧解析器 */
+#endif
+#if (ENABLE_YMODEM_EXT_FRAME)
+static bool                     _is_ext_mode;           /* 第 0 帧已协商使用扩展数据帧 */
+#endif
+#if (ENABLE_RESUME_TRANSFER)
+static bool                     _is_resume_mode;        /* 第 0 帧已协商断点续传，应答续传位置后清除 */
+#endif
+#if (ENABLE_BAUD_NEGOTIATION)
+static YMODEM_BAUD_STATE        _baud_state;            /* 波特率协商的状态 */
+static volatile bool            _is_baud_timeout;       /* 等待探测帧或第 0 帧超时，由主循环恢复原波特率 */
+static uint32_t                 _baud_origin;           /* UART 初始化时的波特率 */
+static uint32_t                 _baud_current;          /* 当前使用的波特率 */
+static struct BSP_TIMER         _timer_baud;            /* 波特率协商的超时定时器 */
+static uint8_t                  _baud_probe[YMODEM_PROBE_LEN] = YMODEM_PROBE_FRAME;
+#endif
 
 /* 协议析构层的回调函数，不建议修改 */
 static PP_Send_t                _PP_Send;               /* 数据发送接口 */
 static PP_PrepareCallback_t     _PP_Prepare;            /* 收到主机指令时的预备处理接口 */
 static PP_ReplyCallback_t       _PP_GetReplyInfo;       /* 正在执行指令时响应主机查询执行过程和结果的接口 */
+#if (ENABLE_BAUD_NEGOTIATION)
+static PP_BaudCheck_t           _PP_BaudCheck;          /* 查询 UART 是否支持某一波特率的接口 */
+static PP_BaudSet_t             _PP_BaudSet;            /* 切换 UART 波特率的接口 */
+#endif
 
 
 /* Private function prototypes -----------------------------------------------*/
@@ -68,6 +115,42 @@ static void                 _Host_CommandProcess     (void);
 static void                 _Timeout_Handler         (void *user_data);
 static PP_CMD_ERR_CODE      _Set_ExeFlow             (PP_CMD  cmd);
 static void                 _YModem_Reset            (void);
+static bool                 _Is_DataFrame            (uint8_t header);
+static bool                 _Frame_Verify            (uint8_t header, uint8_t *data, uint16_t data_len);
+#if (ENABLE_YMODEM_EXT_FRAME || ENABLE_RESUME_TRANSFER)
+static uint16_t             _YModem_FindTag          (const char *tag);
+#endif
+#if (ENABLE_YMODEM_EXT_FRAME)
+static bool                 _YModem_ExtNegotiate     (void);
+#endif
+#if (ENABLE_RESUME_TRANSFER)
+static bool                 _YModem_IsResumeFrame    (void);
+static void                 _YModem_ResumeReply      (void);
+#endif
+#if (ENABLE_YMODEM_G)
+static bool                 _YModem_G_IsKeepUp       (void);
+static void                 _YModem_G_Reply          (PP_CMD_EXE_RESULT result);
+static void                 _YModem_G_Abort          (bool is_notify);
+#endif
+#if (IS_ENABLE_STREAM_HANDLER)
+static void                 _Stream_Check            (const uint8_t *data, const uint16_t *len);
+static void                 _Stream_Remove           (uint8_t *data, uint16_t *len, uint16_t remove_len);
+static void                 _Stream_Compact          (uint8_t *data, uint16_t *len);
+#endif
+#if (ENABLE_FRAME_PARSER)
+static uint8_t              _Stream_Accept           (void);
+#endif
+#if (ENABLE_BAUD_NEGOTIATION)
+static bool                 _Baud_Handler            (uint8_t *data, uint16_t len);
+static void                 _Baud_Request            (uint8_t *data, uint16_t len);
+static void                 _Baud_Confirm            (void);
+static void                 _Baud_Poll               (void);
+static void                 _Baud_Switch             (uint32_t baudrate);
+static void                 _Baud_Timeout_Handler    (void *user_data);
+#if (ENABLE_YMODEM_G && !ENABLE_FRAME_PARSER)
+static uint16_t             _Baud_FrameLen           (uint8_t *data, uint16_t len);
+#endif
+#endif
 
 
 /* Exported functions ---------------------------------------------------------*/
@@ -112,17 +195,34 @@ PP_CMD_ERR_CODE  PP_Handler(uint8_t *data, uint16_t len)
 {
     PP_CMD_ERR_CODE  err_code;
 
+#if (ENABLE_BAUD_NEGOTIATION)
+    _Baud_Poll();
+#endif
+
     /* 有数据 */
     if (data && len && _is_enable_recv_cmd)
     {
+    #if (ENABLE_BAUD_NEGOTIATION)
+        /* 重发的探测帧可能与第 0 帧粘连在同一帧数据中，先去掉 */
+        while (_baud_state == YMODEM_BAUD_VERIFY && len > YMODEM_PROBE_LEN 
+        &&     memcmp(data, _baud_probe, YMODEM_PROBE_LEN) == 0)
+        {
+            data += YMODEM_PROBE_LEN;
+            len  -= YMODEM_PROBE_LEN;
+        }
+
+        /* 波特率请求和探测帧不交由业务层处理 */
+        if (_Baud_Handler(data, len))
+            return PP_ERR_OK;
+    #endif
+
         /* 暂存和格式化 */
         _dev_rx_data = data;
         _dev_rx_len  = len;
         _host_msg    = (union HOST_MESSAGE *)_dev_rx_data;
 
         /* 只有数据帧才做以下错误检查 */
-        if (_host_msg->pkg.header == YMODEM_SOH
-        ||  _host_msg->pkg.header == YMODEM_STX)
+        if (_Is_DataFrame(_host_msg->pkg.header))
         {
             /* 判断序列号是否符合顺序 */
             if (_host_msg->pkg.pkt_num != _ymodem_pkt_num)
@@ -151,18 +251,27 @@ PP_CMD_ERR_CODE  PP_Handler(uint8_t *data, uint16_t len)
 
             /* 获取协议帧中的数据字段长度 */
             uint16_t data_len;
+            uint16_t fixed_len = YMODEM_FRAME_FIXED_LEN;
             if (_host_msg->pkg.header == YMODEM_SOH)
                 data_len = YMODEM_SOH_DATA_LEN;
 
             else if (_host_msg->pkg.header == YMODEM_STX)
                 data_len = YMODEM_STX_DATA_LEN;
 
+        #if (ENABLE_YMODEM_EXT_FRAME)
+            else
+            {
+                data_len  = YMODEM_EXT_DATA_LEN;
+                fixed_len = YMODEM_EXT_FRAME_FIXED_LEN;
+            }
+        #endif
+
             /* 帧长度判断 */
             /* 奇怪的是， Xshell 在发送最后一个空 SOH 数据帧时会附加两个字节的 0x4F ，原因未知。
              * 为了处理这个问题，避免误判为数据帧长度有误，此处嵌套了“ ymodem_pkt_num != 0 ”的判断 */
             if (_ymodem_pkt_num != 0)
             {
-                if (_dev_rx_len != (data_len + YMODEM_FRAME_FIXED_LEN))
+                if (_dev_rx_len != (data_len + fixed_len))
                 {
                     BSP_Printf("error: _dev_rx_len: %d\r\n", _dev_rx_len);
                     err_code = PP_ERR_FRAME_LENGTH_ERR;
@@ -171,12 +280,8 @@ PP_CMD_ERR_CODE  PP_Handler(uint8_t *data, uint16_t len)
             }
 
             /* 校验数据是否正确 */
-            uint16_t crc16 = crc16_xmodem(_host_msg->pkg.data, data_len);
-            uint16_t raw_crc16 = (_host_msg->pkg.data[data_len] << 8) | _host_msg->pkg.data[data_len + 1];
-            if (crc16 != raw_crc16)
+            if (_Frame_Verify(_host_msg->pkg.header, _host_msg->pkg.data, data_len) == false)
             {
-                BSP_Printf("error: crc16: %.4X\r\n", crc16);
-                BSP_Printf("error: raw crc16: %.4X\r\n", raw_crc16);
                 err_code = PP_ERR_FRAME_VERIFY_ERR;
                 goto __error_exit;
             }
@@ -201,6 +306,15 @@ PP_CMD_ERR_CODE  PP_Handler(uint8_t *data, uint16_t len)
         return PP_ERR_OK;
 
     __error_exit:
+    #if (ENABLE_YMODEM_G)
+        /* YModem-G 没有重传机制，出错即取消传输，还未开始传输时只丢弃该帧 */
+        if (_is_g_mode)
+        {
+            if (_exe_flow != YMODEM_FLOW_NONE)
+                _YModem_G_Abort(true);
+            return err_code;
+        }
+    #endif
         _dev_tx_pkg.response = YMODEM_NAK;
         _PP_Send(&_dev_tx_pkg.response, 1, HAL_MAX_DELAY);
         return err_code;
@@ -236,7 +350,224 @@ void PP_Config(PP_CONFIG_PARA  para, void *value)
         if (_is_enable_recv_cmd == false)
             BSP_Timer_Pause(&_timer_send_c);
     }
+
+#if (ENABLE_WINDOW_PROTOCOL)
+    PW_Config(para, value);
+#endif
+}
+
+
+#if (IS_ENABLE_STREAM_HANDLER)
+/**
+ * @brief  YModem-G 流式接收的协议解析处理函数
+ * @note   1. 以 'G' 握手期间（启用帧解析器时为全程）替代 PP_Handler 被主程序循环调用，不依赖断帧检测，
+ *            按帧头确定帧长，逐帧取出缓存中的完整数据帧
+ *         2. 数据帧被业务层处理完毕后才从缓存中移除，处理期间收到的数据帧暂存于缓存中
+ *         3. 已处理的数据留在缓存头部，未处理的数据从 PP_StreamOffset 开始
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量，由接收中断累加
+ * @retval PP_CMD_ERR_CODE
+ */
+PP_CMD_ERR_CODE  PP_StreamHandler(uint8_t *data, uint16_t *len)
+{
+    uint16_t frame_len;
+#if (!ENABLE_FRAME_PARSER)
+    uint8_t  *frame;
+#endif
+
+#if (ENABLE_BAUD_NEGOTIATION)
+    _Baud_Poll();
+#endif
+
+    /* 业务层还在处理上一帧 */
+    if (_is_exe_cmd)
+        return PP_Handler(NULL, 0);
+
+    _Stream_Check(data, len);
+
+    /* 上一帧已处理完毕，从缓存中移除 */
+    if (_stream_frame_len)
+    {
+        _Stream_Remove(data, len, _stream_frame_len);
+        _stream_frame_len = 0;
+    }
+
+    if (*len == _stream_head)
+        return PP_ERR_OK;
+
+    /* 已取消传输，主机可能还在发送，全部丢弃 */
+    if (_exe_flow == YMODEM_FLOW_CANCEL)
+    {
+        _Stream_Remove(data, len, *len - _stream_head);
+    #if (ENABLE_FRAME_PARSER)
+        PF_Reset(&_frame_parser);
+    #endif
+        return PP_ERR_OK;
+    }
+
+#if (ENABLE_FRAME_PARSER)
+    /* 只解析上次之后新收到的数据，最后一个校验字节到达时即取出一帧，不是帧头的数据逐字节丢弃 */
+    _frame_parser.accept = _Stream_Accept();
+    for (;;)
+    {
+        PF_RESULT result = PF_Parse(&_frame_parser, &data[_stream_head], *len - _stream_head, &frame_len);
+        if (result == PF_RESULT_NONE)
+            return PP_ERR_OK;
+        if (result == PF_RESULT_FRAME)
+            break;
+        _Stream_Remove(data, len, frame_len);
+    }
+#else
+    frame = &data[_stream_head];
+
+#if (ENABLE_BAUD_NEGOTIATION)
+    /* 刚切换波特率，探测帧之前的数据是切换过程中产生的乱码 */
+    if (_baud_state == YMODEM_BAUD_PROBE && frame[0] != YMODEM_PROBE)
+    {
+        _Stream_Remove(data, len, 1);
+        return PP_ERR_OK;
+    }
+#endif
+
+    switch (frame[0])
+    {
+        case YMODEM_SOH: frame_len = YMODEM_SOH_FRAME_LEN;  break;
+        case YMODEM_STX: frame_len = YMODEM_STX_FRAME_LEN;  break;
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        case YMODEM_STX_EXT:
+        {
+            /* 未协商扩展数据帧时不是帧头 */
+            if (_is_ext_mode == false)
+            {
+                _Stream_Remove(data, len, 1);
+                return PP_ERR_OK;
+            }
+            frame_len = YMODEM_EXT_FRAME_LEN;
+            break;
+        }
+    #endif
+    #if (ENABLE_BAUD_NEGOTIATION)
+        case YMODEM_BAUD:
+        case YMODEM_PROBE:
+        {
+            /* 不在协商阶段时不是帧头 */
+            frame_len = _Baud_FrameLen(frame, *len - _stream_head);
+            if (frame_len == 0)
+            {
+                _Stream_Remove(data, len, 1);
+                return PP_ERR_OK;
+            }
+            break;
+        }
+    #endif
+        case YMODEM_EOT: frame_len = 1;                     break;
+        case YMODEM_CAN:
+        {
+            /* 连续的 CAN 视为一帧 */
+            for (frame_len = 1; frame_len < *len - _stream_head && frame[frame_len] == YMODEM_CAN; frame_len++) {}
+            break;
+        }
+        default:
+        {
+            /* 不是帧头，丢弃 */
+            _Stream_Remove(data, len, 1);
+            return PP_ERR_OK;
+        }
+    }
+
+    /* 还未收完一帧 */
+    if (*len - _stream_head < frame_len)
+        return PP_ERR_OK;
+#endif
+
+    _stream_frame_len = frame_len;
+    return PP_Handler(&data[_stream_head], frame_len);
+}
+
+
+/**
+ * @brief  获取流式接收时接收缓存中已处理的数据长度
+ * @note   未处理的数据从该偏移开始，其他按缓存首地址解析的处理（如滑动窗口协议）据此判断帧头
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量
+ * @retval 已处理的数据长度，单位 byte
+ */
+uint16_t PP_StreamOffset(const uint8_t *data, const uint16_t *len)
+{
+    _Stream_Check(data, len);
+    return _stream_head;
+}
+
+
+/**
+ * @brief  将流式接收未处理的数据移至缓存首地址
+ * @note   切换至按缓存首地址解析的处理（断帧检测、滑动窗口协议）前调用，已在首地址时直接返回
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量，由接收中断累加
+ * @retval None
+ */
+void PP_StreamRewind(uint8_t *data, uint16_t *len)
+{
+    _Stream_Check(data, len);
+    if (_stream_head)
+        _Stream_Compact(data, len);
+}
+
+
+/**
+ * @brief  是否处于流式接收模式
+ * @note   1. 为 true 时，应调用 PP_StreamHandler 代替断帧检测和 PP_Handler
+ *         2. 启用帧解析器时， YModem 和 YModem-G 均按帧结构逐帧取出，始终为 true
+ *         3. 第 0 帧改按 YModem 传输时，该帧从缓存中移除后才退出流式接收
+ * @retval true: 是 | false: 否
+ */
+bool PP_IsStreamMode(void)
+{
+#if (ENABLE_FRAME_PARSER)
+    return true;
+#else
+    return (_is_g_mode || _stream_frame_len);
+#endif
+}
+#endif  /* #if (IS_ENABLE_STREAM_HANDLER) */
+
+
+#if (ENABLE_RESUME_TRANSFER)
+/**
+ * @brief  是否已协商断点续传
+ * @note   第 0 帧协商，固件包头所在的数据帧应答后清除，业务层在处理固件包头时查询
+ * @retval true: 是 | false: 否
+ */
+bool PP_IsResumeMode(void)
+{
+    return _is_resume_mode;
+}
+#endif
+
+
+#if (ENABLE_BAUD_NEGOTIATION)
+/**
+ * @brief  波特率协商的初始化
+ * @note   在 PP_Init 之后调用，未调用时不响应主机的波特率请求
+ * @param[in]  baudrate: UART 初始化时的波特率，每次开始接收固件时恢复为该波特率
+ * @param[in]  Check: 查询 UART 是否支持某一波特率的接口
+ * @param[in]  Set: 切换 UART 波特率的接口，需等待正在发送的数据发送完毕后再切换
+ * @retval None
+ */
+void PP_BaudInit(uint32_t baudrate, PP_BaudCheck_t Check, PP_BaudSet_t Set)
+{
+    _baud_origin  = baudrate;
+    _baud_current = baudrate;
+    _PP_BaudCheck = Check;
+    _PP_BaudSet   = Set;
+
+    BSP_Timer_Init( &_timer_baud, 
+                    _Baud_Timeout_Handler, 
+                    BAUD_NEGOTIATION_TIMEOUT, 
+                    1, 
+                    TIMER_TYPE_HARDWARE);
 }
+#endif
 
 
 /* Private functions ---------------------------------------------------------*/
@@ -248,9 +579,28 @@ void PP_Config(PP_CONFIG_PARA  para, void *value)
 static void _Host_HeartBeatProcess(void)
 {
     static PP_CMD_EXE_RESULT  result;
+    uint8_t  *data     = NULL;
+    uint16_t  data_len = 0;
+
+#if (ENABLE_RESUME_TRANSFER)
+    /* 固件包头所在的数据帧，同时获取续传位置 */
+    if (_YModem_IsResumeFrame())
+    {
+        data = &_dev_tx_pkg.resume[1];
+        memset(data, 0, 4);
+    }
+#endif
 
     /* 获取处理结果 */
-    _PP_GetReplyInfo((PP_CMD)_host_msg->pkg.header, &result, NULL, NULL);
+    _PP_GetReplyInfo((PP_CMD)_host_msg->pkg.header, &result, data, &data_len);
+
+#if (ENABLE_YMODEM_G)
+    if (_is_g_mode)
+    {
+        _YModem_G_Reply(result);
+        return;
+    }
+#endif
 
     if (result == PP_RESULT_FAILED)
     {
@@ -270,6 +620,11 @@ static void _Host_HeartBeatProcess(void)
 
     _is_exe_cmd = false;
     _PP_Send(&_dev_tx_pkg.response, 1, HAL_MAX_DELAY);
+
+#if (ENABLE_RESUME_TRANSFER)
+    if (data && result == PP_RESULT_OK)
+        _YModem_ResumeReply();
+#endif
 }
 
 
@@ -288,6 +643,11 @@ static void _Host_CommandProcess(void)
     ||  _host_msg->pkg.header == YMODEM_STX)
         data_len = _dev_rx_len - YMODEM_FRAME_FIXED_LEN;
 
+#if (ENABLE_YMODEM_EXT_FRAME)
+    else if (_Is_DataFrame(_host_msg->pkg.header))
+        data_len = _dev_rx_len - YMODEM_EXT_FRAME_FIXED_LEN;
+#endif
+
     _PP_Prepare((PP_CMD)_host_msg->pkg.header, _host_msg->pkg.data, data_len);
 }
 
@@ -309,6 +669,23 @@ static PP_CMD_ERR_CODE  _Set_ExeFlow(PP_CMD  cmd)
             {
                 _exe_flow = YMODEM_FLOW_START;
                 _dev_tx_pkg.response = YMODEM_ACK;
+            #if (ENABLE_BAUD_NEGOTIATION)
+                _Baud_Confirm();
+            #endif
+            #if (ENABLE_YMODEM_EXT_FRAME)
+                _is_ext_mode = _YModem_ExtNegotiate();
+            #endif
+            #if (ENABLE_RESUME_TRANSFER)
+                _is_resume_mode = (_YModem_FindTag(YMODEM_RESUME_TAG) != 0);
+            #endif
+            #if (ENABLE_YMODEM_G)
+                /* flash 的写入跟不上时放弃 YModem-G ，第 0 帧回复 ACK 后继续定时发送 'C' ，按 YModem 传输 */
+                if (_is_g_mode)
+                    _is_g_mode = _YModem_G_IsKeepUp();
+                /* YModem-G 在第 0 帧处理完毕后立即回复 'G' ，不再定时发送，以免夹杂在连续的数据帧之间 */
+                if (_is_g_mode)
+                    BSP_Timer_Pause(&_timer_send_c);
+            #endif
             }
             /* 最后一个空的 SOH 数据帧 */
             else if (_exe_flow == YMODEM_FLOW_SECOND_EOT)
@@ -331,13 +708,42 @@ static PP_CMD_ERR_CODE  _Set_ExeFlow(PP_CMD  cmd)
         {
             /* 第一个是 STX 数据帧 */
             if (_exe_flow == YMODEM_FLOW_NONE)
+            {
                 _exe_flow = YMODEM_FLOW_START;
+            #if (ENABLE_BAUD_NEGOTIATION)
+                _Baud_Confirm();
+            #endif
+            #if (ENABLE_YMODEM_EXT_FRAME)
+                _is_ext_mode = _YModem_ExtNegotiate();
+            #endif
+            #if (ENABLE_RESUME_TRANSFER)
+                _is_resume_mode = (_YModem_FindTag(YMODEM_RESUME_TAG) != 0);
+            #endif
+            #if (ENABLE_YMODEM_G)
+                if (_is_g_mode)
+                    _is_g_mode = _YModem_G_IsKeepUp();
+                if (_is_g_mode)
+                    BSP_Timer_Pause(&_timer_send_c);
+            #endif
+            }
             else 
                 BSP_Timer_Pause(&_timer_send_c);
 
             _dev_tx_pkg.response = YMODEM_ACK;
             break;
         }
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        /* 扩展数据帧只用于固件包体，不会是第一个数据帧 */
+        case PP_CMD_STX_EXT:
+        {
+            if (_is_ext_mode == false)
+                return PP_ERR_EXE_FLOW_ERR;
+
+            BSP_Timer_Pause(&_timer_send_c);
+            _dev_tx_pkg.response = YMODEM_ACK;
+            break;
+        }
+    #endif
         case PP_CMD_EOT:
         {
             /* 第一个 EOT */
@@ -383,7 +789,192 @@ static void _YModem_Reset(void)
     _is_enable_recv_cmd = true;     /* 使能接收主机的指令包 */
     _ymodem_pkt_num     = 0;
     _exe_flow           = YMODEM_FLOW_NONE;
+#if (ENABLE_YMODEM_G)
+    _is_g_mode          = (YMODEM_G_HANDSHAKE_TIMES > 0);
+    _g_handshake_cnt    = 0;
+    _g_data_frame_cnt   = 0;
+#endif
+#if (IS_ENABLE_STREAM_HANDLER)
+    _stream_frame_len   = 0;
+    _stream_head        = 0;
+#endif
+#if (ENABLE_FRAME_PARSER)
+    PF_Init(&_frame_parser, PF_ACCEPT_YMODEM);
+#endif
+#if (ENABLE_YMODEM_EXT_FRAME)
+    _is_ext_mode        = false;
+#endif
+#if (ENABLE_RESUME_TRANSFER)
+    _is_resume_mode     = false;
+#endif
+#if (ENABLE_BAUD_NEGOTIATION)
+    _baud_state         = YMODEM_BAUD_IDLE;
+    _is_baud_timeout    = false;
+    BSP_Timer_Pause(&_timer_baud);
+    /* 上次传输协商过波特率，恢复原波特率以便主机重新握手 */
+    if (_PP_BaudSet && _baud_current != _baud_origin)
+        _Baud_Switch(_baud_origin);
+#endif
+}
+
+
+/**
+ * @brief  是否为数据帧
+ * @note   扩展数据帧仅在第 0 帧协商后才视为数据帧
+ * @param[in]  header: 帧头
+ * @retval true: 是 | false: 否
+ */
+static bool _Is_DataFrame(uint8_t header)
+{
+#if (ENABLE_YMODEM_EXT_FRAME)
+    if (header == YMODEM_STX_EXT)
+        return _is_ext_mode;
+#endif
+    return (header == YMODEM_SOH || header == YMODEM_STX);
+}
+
+
+/**
+ * @brief  校验数据帧
+ * @note   1. SOH 和 STX 数据帧以 CRC16 校验，扩展数据帧以 CRC32 校验，均为高字节在前
+ *         2. 启用帧解析器时，数据帧均由 PP_StreamHandler 取出，接收时已逐段校验，校验错误时才重新计算以输出校验值
+ * @param[in]  header: 帧头
+ * @param[in]  data: 数据字段，其后紧跟校验值
+ * @param[in]  data_len: 数据字段长度，单位 byte
+ * @retval true: 正确 | false: 错误
+ */
+static bool _Frame_Verify(uint8_t header, uint8_t *data, uint16_t data_len)
+{
+#if (ENABLE_FRAME_PARSER)
+    if (_frame_parser.is_crc_ok)
+        return true;
+#endif
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+    if (header == YMODEM_STX_EXT)
+    {
+        uint32_t crc = CRC32_Calc(data, data_len);
+        uint32_t raw_crc = ((uint32_t)data[data_len]     << 24) 
+                         | ((uint32_t)data[data_len + 1] << 16) 
+                         | ((uint32_t)data[data_len + 2] << 8) 
+                         |  (uint32_t)data[data_len + 3];
+        if (crc != raw_crc)
+        {
+            BSP_Printf("error: crc32: %.8X\r\n", crc);
+            BSP_Printf("error: raw crc32: %.8X\r\n", raw_crc);
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    uint16_t crc16 = CRC16_XModem(data, data_len);
+    uint16_t raw_crc16 = (data[data_len] << 8) | data[data_len + 1];
+    if (crc16 != raw_crc16)
+    {
+        BSP_Printf("error: crc16: %.4X\r\n", crc16);
+        BSP_Printf("error: raw crc16: %.4X\r\n", raw_crc16);
+        return false;
+    }
+    return true;
+}
+
+
+#if (ENABLE_YMODEM_EXT_FRAME || ENABLE_RESUME_TRANSFER)
+/**
+ * @brief  在第 0 帧中查找主机附加的协商字段
+ * @note   协商字段位于文件名和文件大小两个字符串之后，多个字段之间以空格分隔，如 "EXT=4096 RESUME"
+ * @param[in]  tag: 字段名
+ * @retval 字段名之后的数据在第 0 帧中的位置， 0: 没有该字段
+ */
+static uint16_t _YModem_FindTag(const char *tag)
+{
+    uint8_t  *data     = _host_msg->pkg.data;
+    uint16_t  data_len = (_host_msg->pkg.header == YMODEM_SOH) ? YMODEM_SOH_DATA_LEN : YMODEM_STX_DATA_LEN;
+    uint16_t  tag_len  = strlen(tag);
+    uint16_t  i = 0;
+
+    /* 跳过文件名和文件大小两个字符串 */
+    for (uint8_t n = 0; n < 2; n++)
+    {
+        while (i < data_len && data[i] != '\0')
+            i++;
+        i++;
+    }
+
+    while (i + tag_len < data_len && data[i] != '\0')
+    {
+        if (memcmp(&data[i], tag, tag_len) == 0)
+            return i + tag_len;
+
+        /* 跳至下一个字段 */
+        while (i < data_len && data[i] != ' ' && data[i] != '\0')
+            i++;
+        while (i < data_len && data[i] == ' ')
+            i++;
+    }
+    return 0;
 }
+#endif
+
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+/**
+ * @brief  协商是否使用扩展数据帧
+ * @note   在第 0 帧中查找 YMODEM_EXT_TAG ，其后的数据长度与 YMODEM_EXT_DATA_LEN 一致时接受
+ * @retval true: 使用扩展数据帧 | false: 仍使用 STX 数据帧
+ */
+static bool _YModem_ExtNegotiate(void)
+{
+    uint8_t  *data     = _host_msg->pkg.data;
+    uint16_t  data_len = (_host_msg->pkg.header == YMODEM_SOH) ? YMODEM_SOH_DATA_LEN : YMODEM_STX_DATA_LEN;
+    uint32_t  ext_len  = 0;
+    uint16_t  i = _YModem_FindTag(YMODEM_EXT_TAG);
+
+    if (i == 0)
+        return false;
+
+    for (; i < data_len && data[i] >= '0' && data[i] <= '9'; i++)
+        ext_len = ext_len * 10 + (data[i] - '0');
+
+    BSP_Printf("YModem ext frame: %d\r\n", ext_len);
+    return (ext_len == YMODEM_EXT_DATA_LEN);
+}
+#endif
+
+
+#if (ENABLE_RESUME_TRANSFER)
+/**
+ * @brief  是否为需要应答续传位置的数据帧
+ * @note   已协商断点续传时，固件包头所在的第 1 个数据帧
+ * @retval true: 是 | false: 否
+ */
+static bool _YModem_IsResumeFrame(void)
+{
+    return (_is_resume_mode
+        &&  _exe_flow == YMODEM_FLOW_START
+        &&  _host_msg->pkg.pkt_num == 1
+        &&  _Is_DataFrame(_host_msg->pkg.header));
+}
+
+
+/**
+ * @brief  向主机应答续传位置
+ * @note   在固件包头所在数据帧的 ACK 之后发送，续传位置已由业务层填入 _dev_tx_pkg.resume[1] ~ [4] ，
+ *         业务层没有填入时为 0 ，即从头发送
+ * @retval None
+ */
+static void _YModem_ResumeReply(void)
+{
+    uint16_t crc16 = CRC16_XModem(&_dev_tx_pkg.resume[1], 4);
+
+    _is_resume_mode = false;
+    _dev_tx_pkg.resume[0] = YMODEM_RESUME;
+    _dev_tx_pkg.resume[5] = (uint8_t)(crc16 >> 8);
+    _dev_tx_pkg.resume[6] = (uint8_t)(crc16);
+    _PP_Send(_dev_tx_pkg.resume, YMODEM_RESUME_REPLY_LEN, HAL_MAX_DELAY);
+}
+#endif
 
 
 /**
@@ -394,11 +985,465 @@ static void _YModem_Reset(void)
  */
 static void _Timeout_Handler(void *user_data)
 {
-    static uint8_t c[1] = {YMODEM_C};
+    static uint8_t c[1];
+
+    c[0] = YMODEM_C;
+
+#if (ENABLE_WINDOW_PROTOCOL)
+    /* 主机已按滑动窗口协议开始传输，握手字符会夹杂在其应答帧之间 */
+    if (PW_IsActive())
+        return;
+#endif
+
+#if (ENABLE_YMODEM_G)
+    /* 先以 'G' 握手，主机一直无响应，则认为其不支持 YModem-G ，改为 'C' */
+    if (_exe_flow == YMODEM_FLOW_NONE && _is_g_mode)
+    {
+        if (_g_handshake_cnt < YMODEM_G_HANDSHAKE_TIMES)
+            _g_handshake_cnt++;
+        else
+            _is_g_mode = false;
+    }
+    c[0] = _is_g_mode ? YMODEM_G : YMODEM_C;
+#endif
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+    /* 第 0 帧已协商使用扩展数据帧，以 'E' 代替 'C' 告知主机 */
+    if (_is_ext_mode && _exe_flow == YMODEM_FLOW_START)
+        c[0] = YMODEM_E;
+#endif
     _PP_Send(c, 1, HAL_MAX_DELAY);
 }
 
 
+#if (ENABLE_YMODEM_G)
+/**
+ * @brief  估算 flash 的写入能否跟上 YModem-G 的连续下发
+ * @note   1. 在第 0 帧按当前波特率、固件大小和 YMODEM_G_FRAME_WRITE_TIME 估算最后一帧到达时接收缓存中积压的数据量，
+ *            除去正在处理的一帧后，接收缓存放得下时才按 YModem-G 传输
+ *         2. 不知道当前波特率或固件大小时按最坏情况估算，即整个固件包都积压在接收缓存中
+ * @retval true: 跟得上 | false: 跟不上，改按 YModem 传输
+ */
+static bool _YModem_G_IsKeepUp(void)
+{
+    uint8_t  *data       = _host_msg->pkg.data;
+    uint16_t  data_len   = (_host_msg->pkg.header == YMODEM_SOH) ? YMODEM_SOH_DATA_LEN : YMODEM_STX_DATA_LEN;
+    uint32_t  file_size  = 0;
+    uint32_t  frame_num;
+    uint32_t  line_time  = 0;   /* 以当前波特率传输一个 STX 数据帧的耗时，单位 us */
+    uint32_t  backlog;
+    uint16_t  i = 0;
+
+    /* 第 0 帧的数据依次为文件名、 '\0' 、十进制的文件大小 */
+    while (i < data_len && data[i] != '\0')
+        i++;
+    for (i++; i < data_len && data[i] >= '0' && data[i] <= '9'; i++)
+        file_size = file_size * 10 + (data[i] - '0');
+
+#if (ENABLE_BAUD_NEGOTIATION)
+    if (_baud_current)
+        line_time = (uint32_t)((uint64_t)YMODEM_STX_FRAME_LEN * 10 * 1000000 / _baud_current);
+#endif
+
+    if (file_size && line_time >= YMODEM_G_FRAME_WRITE_TIME)
+        return true;
+
+    /* 每写入一帧的同时到达 line_time / YMODEM_G_FRAME_WRITE_TIME 帧，最后一帧到达时积压的帧数 */
+    frame_num = (file_size + YMODEM_STX_DATA_LEN - 1) / YMODEM_STX_DATA_LEN;
+    backlog   = (uint32_t)((uint64_t)frame_num * YMODEM_STX_FRAME_LEN
+                            * (YMODEM_G_FRAME_WRITE_TIME - line_time) / YMODEM_G_FRAME_WRITE_TIME);
+
+    BSP_Printf("YModem-G backlog: %d / %d\r\n", backlog, PP_MSG_BUFF_SIZE - YMODEM_FRAME_MAX_LEN);
+    return (file_size && backlog <= PP_MSG_BUFF_SIZE - YMODEM_FRAME_MAX_LEN);
+}
+
+
+/**
+ * @brief  YModem-G 对主机的回复
+ * @note   1. 数据帧不逐帧应答，仅第 0 帧回复 'G' （已协商扩展数据帧时为 'E' ）以开始传输，固件包头所在的第 1 帧回复 ACK 
+ *            （该帧会触发分区擦除，耗时较长，主机需等到 ACK 后再连续发送）
+ *         2. EOT 和最后一个空的 SOH 数据帧的应答与 YModem 相同
+ *         3. 没有重传机制，业务层处理失败即取消传输
+ * @param[in]  result: 业务层的处理结果
+ * @retval None
+ */
+static void _YModem_G_Reply(PP_CMD_EXE_RESULT result)
+{
+    static uint8_t g[1] = {YMODEM_G};
+#if (ENABLE_YMODEM_EXT_FRAME)
+    static uint8_t e[1] = {YMODEM_E};
+#endif
+
+    /* 业务层还在处理数据，暂时不回复主机 */
+    if (result == PP_RESULT_PROCESS)
+        return;
+
+    _is_exe_cmd = false;
+
+    if (result != PP_RESULT_OK)
+    {
+        /* PP_RESULT_CANCEL 时业务层已自行结束，无需再通知 */
+        _YModem_G_Abort(result == PP_RESULT_FAILED);
+        return;
+    }
+
+    if (_Is_DataFrame(_host_msg->pkg.header)
+    &&  _exe_flow != YMODEM_FLOW_SUCCESS)
+    {
+        _g_data_frame_cnt++;
+        if (_g_data_frame_cnt == 1)
+        {
+        #if (ENABLE_YMODEM_EXT_FRAME)
+            /* 已协商使用扩展数据帧，以 'E' 代替 'G' 告知主机 */
+            _PP_Send(_is_ext_mode ? e : g, 1, HAL_MAX_DELAY);
+        #else
+            _PP_Send(g, 1, HAL_MAX_DELAY);
+        #endif
+        }
+        else if (_g_data_frame_cnt == 2)
+        {
+            _PP_Send(&_dev_tx_pkg.response, 1, HAL_MAX_DELAY);
+        #if (ENABLE_RESUME_TRANSFER)
+            if (_YModem_IsResumeFrame())
+                _YModem_ResumeReply();
+        #endif
+        }
+        return;
+    }
+
+    _PP_Send(&_dev_tx_pkg.response, 1, HAL_MAX_DELAY);
+
+    /* 第二个 EOT 应答后立即发送 'G' ，主机随即发送最后一个空的 SOH 数据帧 */
+    if (_exe_flow == YMODEM_FLOW_SECOND_EOT)
+        _PP_Send(g, 1, HAL_MAX_DELAY);
+}
+
+
+/**
+ * @brief  取消 YModem-G 传输
+ * @note   向主机发送两个 CAN ，之后收到的数据全部丢弃，直至 PP_CONFIG_RESET
+ * @param[in]  is_notify: 是否以 PP_CMD_CAN 通知业务层
+ * @retval None
+ */
+static void _YModem_G_Abort(bool is_notify)
+{
+    static uint8_t can[2] = {YMODEM_CAN, YMODEM_CAN};
+
+    BSP_Printf("YModem-G abort\r\n");
+
+    _exe_flow   = YMODEM_FLOW_CANCEL;
+    _is_exe_cmd = false;
+    BSP_Timer_Pause(&_timer_send_c);
+    _PP_Send(can, 2, HAL_MAX_DELAY);
+
+    if (is_notify)
+        _PP_Prepare(PP_CMD_CAN, NULL, 0);
+}
+#endif  /* #if (ENABLE_YMODEM_G) */
+
+
+#if (IS_ENABLE_STREAM_HANDLER)
+/**
+ * @brief  确认 _stream_head 对应当前的接收缓存
+ * @note   换了数据接口或缓存已被清空时，从缓存首地址重新开始
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量
+ * @retval None
+ */
+static void _Stream_Check(const uint8_t *data, const uint16_t *len)
+{
+    if (data != _stream_buff || _stream_head > *len)
+    {
+        _stream_buff      = data;
+        _stream_head      = 0;
+        _stream_frame_len = 0;
+    }
+}
+
+
+/**
+ * @brief  从未处理的数据头部移除数据
+ * @note   1. 只后移读取位置，不搬移数据
+ *         2. 数据全部处理完时与接收中断互斥地清空缓存，从首地址重新接收
+ *         3. 缓存剩余的空间放不下一个最长的帧时才将未处理的数据前移，见 _Stream_Compact
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量，由接收中断累加
+ * @param[in]  remove_len: 要移除的长度，单位 byte
+ * @retval None
+ */
+static void _Stream_Remove(uint8_t *data, uint16_t *len, uint16_t remove_len)
+{
+    if (remove_len > *len - _stream_head)
+        remove_len = *len - _stream_head;
+    _stream_head += remove_len;
+
+    __IRQ_SAFE
+    {
+        if (*len == _stream_head)
+        {
+            *len         = 0;
+            _stream_head = 0;
+        }
+    }
+
+    if (_stream_head && *len + YMODEM_FRAME_MAX_LEN > PP_MSG_BUFF_SIZE)
+        _Stream_Compact(data, len);
+}
+
+
+/**
+ * @brief  将未处理的数据移至缓存首地址
+ * @note   接收中断只在 *len 之后追加数据，已收到的数据在开中断时搬移，
+ *         只有搬移期间追加的数据在关中断时搬移
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量，由接收中断累加
+ * @retval None
+ */
+static void _Stream_Compact(uint8_t *data, uint16_t *len)
+{
+    uint16_t end = *len;
+
+    memmove(&data[0], &data[_stream_head], end - _stream_head);
+
+    __IRQ_SAFE
+    {
+        memmove(&data[end - _stream_head], &data[end], *len - end);
+        *len -= _stream_head;
+    }
+    _stream_head = 0;
+}
+#endif
+
+
+#if (ENABLE_FRAME_PARSER)
+/**
+ * @brief  按协议状态确定帧解析器可识别的帧
+ * @note   与 _Is_DataFrame 和 _Baud_Handler 的判断一致：扩展数据帧在第 0 帧协商后才识别，
+ *         波特率请求只在第 0 帧之前识别，刚切换波特率时只识别探测帧，其之前的数据是切换过程中产生的乱码
+ * @retval PF_ACCEPT_* 的组合
+ */
+static uint8_t _Stream_Accept(void)
+{
+    uint8_t accept = PF_ACCEPT_YMODEM;
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+    if (_is_ext_mode)
+        accept |= PF_ACCEPT_EXT;
+#endif
+#if (ENABLE_BAUD_NEGOTIATION)
+    if (_PP_BaudSet && _exe_flow == YMODEM_FLOW_NONE)
+    {
+        if (_baud_state == YMODEM_BAUD_IDLE)
+            accept |= PF_ACCEPT_BAUD;
+        else if (_baud_state == YMODEM_BAUD_PROBE)
+            accept  = PF_ACCEPT_PROBE;
+        else
+            accept |= PF_ACCEPT_PROBE;
+    }
+#endif
+    return accept;
+}
+#endif
+
+
+#if (ENABLE_BAUD_NEGOTIATION)
+/**
+ * @brief  波特率协商阶段的数据处理
+ * @note   只在还未收到第 0 帧时处理，请求帧和探测帧的结构见 protocol_parser.h
+ * @param[in]  data: 收到的数据
+ * @param[in]  len: 数据长度
+ * @retval true: 已处理，不再交由业务层处理 | false: 不是协商阶段的数据
+ */
+static bool _Baud_Handler(uint8_t *data, uint16_t len)
+{
+    if (_PP_BaudSet == NULL || _exe_flow != YMODEM_FLOW_NONE)
+        return false;
+
+    switch (_baud_state)
+    {
+        case YMODEM_BAUD_IDLE:
+        {
+            if (data[0] != YMODEM_BAUD)
+                return false;
+
+            _Baud_Request(data, len);
+            return true;
+        }
+        case YMODEM_BAUD_PROBE:
+        {
+            /* 切换过程中可能产生乱码，在整帧数据中查找探测帧，其他数据均丢弃 */
+            for (uint16_t i = 0; i + YMODEM_PROBE_LEN <= len; i++)
+            {
+                if (memcmp(&data[i], _baud_probe, YMODEM_PROBE_LEN) == 0)
+                {
+                    _baud_state = YMODEM_BAUD_VERIFY;
+                    BSP_Timer_Restart(&_timer_baud);
+                    _PP_Send(_baud_probe, YMODEM_PROBE_LEN, HAL_MAX_DELAY);
+                    break;
+                }
+            }
+            return true;
+        }
+        /* 等待第 0 帧，重复的探测帧丢弃 */
+        default: return (data[0] == YMODEM_PROBE);
+    }
+}
+
+
+/**
+ * @brief  处理主机的波特率请求
+ * @note   选择第一个不超过 BAUD_NEGOTIATION_MAX_RATE 且 UART 支持的波特率，以原波特率应答后切换，
+ *         请求帧校验失败时不应答，由主机超时重发
+ * @param[in]  data: 请求帧
+ * @param[in]  len: 请求帧长度
+ * @retval None
+ */
+static void _Baud_Request(uint8_t *data, uint16_t len)
+{
+    uint8_t   num = (len > 1) ? data[1] : 0;
+    uint32_t  baudrate = 0;
+    uint16_t  crc16;
+
+    if (num == 0 || num > YMODEM_BAUD_MAX_NUM || len < YMODEM_BAUD_REQ_LEN(num))
+        return;
+
+    crc16 = CRC16_XModem(&data[1], 1 + 4 * num);
+    if (crc16 != ((data[2 + 4 * num] << 8) | data[3 + 4 * num]))
+    {
+        BSP_Printf("error: baudrate request crc16: %.4X\r\n", crc16);
+        return;
+    }
+
+    for (uint8_t i = 0; i < num; i++)
+    {
+        uint8_t  *p    = &data[2 + 4 * i];
+        uint32_t  rate = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+
+        if (rate && rate <= BAUD_NEGOTIATION_MAX_RATE
+        &&  (rate == _baud_current || _PP_BaudCheck(rate)))
+        {
+            baudrate = rate;
+            break;
+        }
+    }
+
+    _dev_tx_pkg.baud[0] = YMODEM_BAUD;
+    _dev_tx_pkg.baud[1] = (uint8_t)(baudrate >> 24);
+    _dev_tx_pkg.baud[2] = (uint8_t)(baudrate >> 16);
+    _dev_tx_pkg.baud[3] = (uint8_t)(baudrate >> 8);
+    _dev_tx_pkg.baud[4] = (uint8_t)(baudrate);
+    crc16 = CRC16_XModem(&_dev_tx_pkg.baud[1], 4);
+    _dev_tx_pkg.baud[5] = (uint8_t)(crc16 >> 8);
+    _dev_tx_pkg.baud[6] = (uint8_t)(crc16);
+    _PP_Send(_dev_tx_pkg.baud, YMODEM_BAUD_REPLY_LEN, HAL_MAX_DELAY);
+
+    BSP_Printf("YModem baudrate: %d -> %d\r\n", _baud_current, baudrate);
+
+    if (baudrate == 0 || baudrate == _baud_current)
+        return;
+
+    /* 协商期间不发送握手字符，以免夹杂在探测帧的回送中 */
+    BSP_Timer_Pause(&_timer_send_c);
+    _baud_state = YMODEM_BAUD_PROBE;
+    _Baud_Switch(baudrate);
+    BSP_Timer_Restart(&_timer_baud);
+}
+
+
+/**
+ * @brief  在新波特率下收到第 0 帧，协商完成
+ * @note   恢复握手字符的定时器， YModem-G 随后会再次暂停
+ * @retval None
+ */
+static void _Baud_Confirm(void)
+{
+    if (_baud_state == YMODEM_BAUD_IDLE)
+        return;
+
+    BSP_Timer_Pause(&_timer_baud);
+    _is_baud_timeout = false;
+    _baud_state      = YMODEM_BAUD_IDLE;
+    BSP_Timer_Start(&_timer_send_c);
+}
+
+
+/**
+ * @brief  波特率协商的超时处理
+ * @note   在主循环中执行，恢复原波特率并重新发送握手字符，主机可再次请求
+ * @retval None
+ */
+static void _Baud_Poll(void)
+{
+    if (_is_baud_timeout == false)
+        return;
+
+    _is_baud_timeout = false;
+    if (_baud_state == YMODEM_BAUD_IDLE)
+        return;
+
+    BSP_Printf("YModem baudrate negotiation timeout\r\n");
+    _baud_state = YMODEM_BAUD_IDLE;
+    _Baud_Switch(_baud_origin);
+    BSP_Timer_Restart(&_timer_send_c);
+}
+
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   
+ * @param[in]  baudrate: 波特率
+ * @retval None
+ */
+static void _Baud_Switch(uint32_t baudrate)
+{
+    _baud_current = baudrate;
+    _PP_BaudSet(baudrate);
+}
+
+
+/**
+ * @brief  波特率协商的超时回调函数
+ * @note   在中断中执行，切换波特率需等待发送完毕，交由主循环处理
+ * @param[in]  user_data: 用户数据
+ * @retval None
+ */
+static void _Baud_Timeout_Handler(void *user_data)
+{
+    _is_baud_timeout = true;
+}
+
+
+#if (ENABLE_YMODEM_G && !ENABLE_FRAME_PARSER)
+/**
+ * @brief  获取流式接收时协商阶段的帧长
+ * @note   请求帧需收到 num 后才能确定帧长，此前返回 2 以等待
+ * @param[in]  data: 接收数据的缓存，首字节为 YMODEM_BAUD 或 YMODEM_PROBE
+ * @param[in]  len: 缓存中的数据长度
+ * @retval 帧长， 0: 不在协商阶段或帧头无效
+ */
+static uint16_t _Baud_FrameLen(uint8_t *data, uint16_t len)
+{
+    if (_PP_BaudSet == NULL || _exe_flow != YMODEM_FLOW_NONE)
+        return 0;
+
+    if (data[0] == YMODEM_PROBE)
+        return (_baud_state == YMODEM_BAUD_IDLE) ? 0 : YMODEM_PROBE_LEN;
+
+    if (_baud_state != YMODEM_BAUD_IDLE)
+        return 0;
+
+    if (len < 2)
+        return 2;
+
+    if (data[1] == 0 || data[1] > YMODEM_BAUD_MAX_NUM)
+        return 0;
+
+    return YMODEM_BAUD_REQ_LEN(data[1]);
+}
+#endif
+#endif  /* #if (ENABLE_BAUD_NEGOTIATION) */
+
+
 
 
 
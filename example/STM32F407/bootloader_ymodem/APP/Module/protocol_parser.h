@@ -29,7 +29,17 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.0.5
+ * Change Logs:
+ * Date           Author       Notes
+ * 2022-11-23     Dino         the first version
+ * 2026-10-18                  增加 YModem-G 的支持
+ * 2026-10-18                  增加滑动窗口协议的帧长和接收缓存大小
+ * 2026-10-18                  增加 YModem 扩展数据帧的定义
+ * 2026-10-18                  增加 PP_StreamOffset 和 PP_StreamRewind ，流式接收按读取位置移除数据
+ * 2026-10-18                  增加断点续传的协商字段和应答的定义
+ * 2026-10-18                  增加波特率协商的请求、应答和探测帧的定义
+ * 2026-10-18                  增加 IS_ENABLE_STREAM_HANDLER ，帧解析器启用时同样逐帧取出数据帧
  */
 
 #ifndef __PROTOCOL_PARSER_H__
@@ -52,10 +62,78 @@
 #define YMODEM_SOH_FRAME_LEN        (YMODEM_FRAME_FIXED_LEN + YMODEM_SOH_DATA_LEN)
 #define YMODEM_STX_FRAME_LEN        (YMODEM_FRAME_FIXED_LEN + YMODEM_STX_DATA_LEN)
 #define YMODEM_C                    'C'
+#define YMODEM_G                    'G'
+
+/* YModem 扩展数据帧，第 0 帧协商后使用，用于发送固件包体：
+ *    | YMODEM_STX_EXT | pkt_num | ~pkt_num | data (YMODEM_EXT_DATA_LEN) | crc32 (4, 高字节在前) |
+ * 主机在第 0 帧的文件大小字符串之后附加 YMODEM_EXT_TAG 和十进制的数据长度，如 "EXT=4096" ，
+ * 设备接受时，第 0 帧之后的握手字符由 'C' 或 'G' 改为 YMODEM_E 。
+ * 固件包头所在的第 1 个数据帧仍使用 STX 数据帧，之后的数据帧均为扩展数据帧，最后一帧不足时以 0x1A 补齐 */
+#define YMODEM_STX_EXT              0x03
+#define YMODEM_E                    'E'
+#define YMODEM_EXT_TAG              "EXT="
+#define YMODEM_EXT_FRAME_FIXED_LEN  (7)
+#if (ENABLE_YMODEM_EXT_FRAME)
+#define YMODEM_EXT_FRAME_LEN        (YMODEM_EXT_FRAME_FIXED_LEN + YMODEM_EXT_DATA_LEN)
+#define YMODEM_FRAME_MAX_LEN        YMODEM_EXT_FRAME_LEN
+#else
+#define YMODEM_FRAME_MAX_LEN        YMODEM_STX_FRAME_LEN
+#endif
+
+/* 断点续传，第 0 帧协商：
+ * 主机在第 0 帧的文件大小字符串之后附加 YMODEM_RESUME_TAG ，与 YMODEM_EXT_TAG 等字段之间以空格分隔，如 "EXT=4096 RESUME" 。
+ * 设备在固件包头所在的第 1 个数据帧的 ACK 之后紧跟续传的应答：
+ *    | YMODEM_RESUME | offset (4, 高字节在前) | crc16 (2, offset 的 CRC16 ，高字节在前) |
+ * offset 为设备已写入的固件包体长度，主机从文件中第 1 个数据帧之后再偏移 offset 的位置继续发送，序列号照常递增，
+ * offset 为 0 即从头发送 */
+#define YMODEM_RESUME               'R'
+#define YMODEM_RESUME_TAG           "RESUME"
+#define YMODEM_RESUME_REPLY_LEN     (7)
+
+/* 波特率协商，主机收到握手字符后、发送第 0 帧之前进行：
+ *    主机请求： | YMODEM_BAUD | num | baudrate (4 * num, 高字节在前) | crc16 (2, num 和 baudrate 的 CRC16 ，高字节在前) |
+ *    设备应答： | YMODEM_BAUD | baudrate (4, 高字节在前) | crc16 (2, baudrate 的 CRC16 ，高字节在前) |
+ * 主机按优先顺序列出 num 个波特率，设备以原波特率应答所选的波特率，为 0 或与原波特率相同时不切换，主机直接发送第 0 帧。
+ * 否则应答后双方均切换至新波特率，主机发送探测帧，设备校验无误后原样回送：
+ *    | YMODEM_PROBE | 0x55 0xAA 0x00 0xFF 0x0F 0xF0 0x33 0xCC |
+ * 主机收到正确的回送后以新波特率发送第 0 帧，不再等待握手字符。设备在 BAUD_NEGOTIATION_TIMEOUT 内未收到探测帧或第 0 帧时
+ * 恢复原波特率并重新发送握手字符，主机未收到正确的回送时同样恢复原波特率，可去掉该波特率后再次请求 */
+#define YMODEM_BAUD                 'B'
+#define YMODEM_BAUD_MAX_NUM         (8)
+#define YMODEM_BAUD_REQ_LEN(num)    (4 + 4 * (num))
+#define YMODEM_BAUD_REPLY_LEN       (7)
+#define YMODEM_PROBE                'P'
+#define YMODEM_PROBE_LEN            (9)
+#define YMODEM_PROBE_FRAME          {YMODEM_PROBE, 0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC}
+
+/* 滑动窗口协议，帧结构和流程见 protocol_window.h */
+#define PW_FRAME_FIXED_LEN          (8)
+#define PW_DATA_MAX_LEN             YMODEM_STX_DATA_LEN
+#define PW_FRAME_MAX_LEN            (PW_FRAME_FIXED_LEN + PW_DATA_MAX_LEN)
 
 /* 协议包数据最大长度定义，因以下两个宏定义在 app.c 中也使用，因此不建议修改宏定义名称，更改宏定义内容即可 */
+/* YModem-G 时数据帧连续下发，接收缓存需暂存业务层处理期间收到的数据帧，且至少能容纳一个最长的数据帧 */
+#if (ENABLE_YMODEM_EXT_FRAME)
+#define PP_FIRMWARE_PKG_SIZE        YMODEM_EXT_DATA_LEN
+#else
 #define PP_FIRMWARE_PKG_SIZE        YMODEM_STX_DATA_LEN
-#define PP_MSG_BUFF_SIZE            YMODEM_STX_FRAME_LEN
+#endif
+#if (ENABLE_YMODEM_G)
+#define PP_YMODEM_BUFF_SIZE         (((YMODEM_STX_FRAME_LEN * YMODEM_G_BUFF_FRAME_NUM) > YMODEM_FRAME_MAX_LEN) ? \
+                                     (YMODEM_STX_FRAME_LEN * YMODEM_G_BUFF_FRAME_NUM) : YMODEM_FRAME_MAX_LEN)
+#else
+#define PP_YMODEM_BUFF_SIZE         YMODEM_FRAME_MAX_LEN
+#endif
+/* 滑动窗口协议的接收缓存需容纳一个窗口的数据帧，再多留一帧给重发的数据帧 */
+/* YModem-G 的数据帧连续下发，帧解析器不依赖断帧检测，两者均由 PP_StreamHandler 从接收缓存中逐帧取出 */
+#define IS_ENABLE_STREAM_HANDLER    (ENABLE_YMODEM_G || ENABLE_FRAME_PARSER)
+
+#if (ENABLE_WINDOW_PROTOCOL)
+#define PP_WINDOW_BUFF_SIZE         (PW_FRAME_MAX_LEN * (WINDOW_PROTOCOL_FRAME_NUM + 1))
+#define PP_MSG_BUFF_SIZE            ((PP_WINDOW_BUFF_SIZE > PP_YMODEM_BUFF_SIZE) ? PP_WINDOW_BUFF_SIZE : PP_YMODEM_BUFF_SIZE)
+#else
+#define PP_MSG_BUFF_SIZE            PP_YMODEM_BUFF_SIZE
+#endif
 
 typedef enum 
 {
@@ -70,6 +148,14 @@ typedef enum
 
 } YMODEM_EXE_FLOW;
 
+typedef enum 
+{
+    YMODEM_BAUD_IDLE = 0x00,        /* 未协商，或已在新波特率下收到第 0 帧 */
+    YMODEM_BAUD_PROBE,              /* 已切换波特率，等待探测帧 */
+    YMODEM_BAUD_VERIFY,             /* 已回送探测帧，等待第 0 帧 */
+
+} YMODEM_BAUD_STATE;
+
 #pragma pack(1)
 union HOST_MESSAGE
 {
@@ -136,6 +222,7 @@ typedef enum
     PP_CMD_NONE                 = 0x00,
     PP_CMD_SOH                  = YMODEM_SOH,
     PP_CMD_STX                  = YMODEM_STX,
+    PP_CMD_STX_EXT              = YMODEM_STX_EXT,
     PP_CMD_EOT                  = YMODEM_EOT,
     PP_CMD_CAN                  = YMODEM_CAN,
 
@@ -164,6 +251,12 @@ typedef enum
 struct PP_DEV_TX_PKG
 {
     uint8_t response;
+#if (ENABLE_RESUME_TRANSFER)
+    uint8_t resume[YMODEM_RESUME_REPLY_LEN];    /* 断点续传的应答 */
+#endif
+#if (ENABLE_BAUD_NEGOTIATION)
+    uint8_t baud[YMODEM_BAUD_REPLY_LEN];        /* 波特率协商的应答 */
+#endif
 };
 
 
@@ -172,6 +265,10 @@ typedef void (*PP_Send_t)(uint8_t *data, uint16_t len, uint32_t timeout);
 typedef void (*PP_HeartbeatCallback_t)(uint8_t *data, uint16_t *data_len);
 typedef void (*PP_PrepareCallback_t)(PP_CMD cmd, uint8_t *data, uint16_t data_len);
 typedef void (*PP_ReplyCallback_t)(PP_CMD cmd, PP_CMD_EXE_RESULT *cmd_exe_result, uint8_t *data, uint16_t *data_len);
+#if (ENABLE_BAUD_NEGOTIATION)
+typedef bool (*PP_BaudCheck_t)(uint32_t baudrate);
+typedef void (*PP_BaudSet_t)(uint32_t baudrate);
+#endif
 
 
 /* 函数定义 */
@@ -181,5 +278,17 @@ void PP_Init(PP_Send_t               Send,
              PP_ReplyCallback_t      Set_ResponseInfo);
 PP_CMD_ERR_CODE     PP_Handler  (uint8_t *data, uint16_t len);
 void                PP_Config   (PP_CONFIG_PARA  para, void *value);
+#if (IS_ENABLE_STREAM_HANDLER)
+PP_CMD_ERR_CODE     PP_StreamHandler    (uint8_t *data, uint16_t *len);
+bool                PP_IsStreamMode     (void);
+uint16_t            PP_StreamOffset     (const uint8_t *data, const uint16_t *len);
+void                PP_StreamRewind     (uint8_t *data, uint16_t *len);
+#endif
+#if (ENABLE_RESUME_TRANSFER)
+bool                PP_IsResumeMode     (void);
+#endif
+#if (ENABLE_BAUD_NEGOTIATION)
+void            PP_BaudInit         (uint32_t baudrate, PP_BaudCheck_t Check, PP_BaudSet_t Set);
+#endif
 
 #endif
@@ -43,6 +43,23 @@
  * v1.5     2023-12-14     Dino         1. 更新注释说明
  *                                      2. 增加 FIRMWARE_HEAD_DATA 配置项
  *                                      3. 增加 USING_CUSTOM_UPDATE_FLAG 配置项
+ * v1.6     2026-10-18                  1. 增加 ENABLE_YMODEM_G 配置项
+ * v1.7     2026-10-18                  1. 增加 ENABLE_WINDOW_PROTOCOL 配置项
+ * v1.8     2026-10-18                  1. 增加 ENABLE_YMODEM_EXT_FRAME 配置项
+ * v1.9     2026-10-18                  1. 增加 ENABLE_WRITE_BEHIND 配置项
+ * v1.10    2026-10-18                  1. 增加 ENABLE_DECOMPRESS 配置项
+ * v1.11    2026-10-18                  1. 增加 ENABLE_DELTA_UPDATE 配置项
+ * v1.12    2026-10-18                  1. 增加 ENABLE_RESUME_TRANSFER 配置项
+ * v1.13    2026-10-18                  1. 增加 ENABLE_INCREMENTAL_UPDATE 配置项
+ * v1.14    2026-10-18                  1. 增加 ENABLE_BAUD_NEGOTIATION 配置项
+ * v1.15    2026-10-18                  1. 增加 CRC_SLICE_NUM 和 ENABLE_CRC32_HARDWARE 配置项
+ * v1.16    2026-10-18                  1. 增加 ENABLE_FRAME_PARSER 配置项
+ * v1.17    2026-10-18                  1. 增加 ENABLE_STREAM_VERIFY 配置项
+ * v1.18    2026-10-18                  1. 增加 USING_APP_WRITE_CHECK_PROJECT 配置项
+ * v1.19    2026-10-18                  1. 增加 ENABLE_ERASE_AHEAD 配置项
+ * v1.20    2026-10-18                  1. 增加 ENABLE_ERASE_STATE 配置项
+ * v1.21    2026-10-18                  1. 增加 ENABLE_ASYNC_FLASH 配置项
+ * v1.22    2026-10-18                  1. 增加 YMODEM_G_FRAME_WRITE_TIME 配置项，写入跟不上时第 0 帧改按 YModem 传输
  */
 
 /**
@@ -115,6 +132,182 @@
     #endif
 
 
+/**
+ * 【选择是否启用解压组件】
+ * 说明: 
+ *    - 若固件包有压缩，则必须启用。若固件包无压缩，可按需选择是否启用
+ *    - 压缩格式为 LZSS （与 heatshrink 的位流相同），解压时边接收边写入 APP 分区，
+ *      download/factory 分区中存放的仍是压缩后的固件包
+ *    - DECOMPRESS_WINDOW_BITS 为解压窗口的位数，窗口大小为 2^n byte ，占用同等大小的 RAM ，
+ *      打包时选择的窗口不能大于该值，窗口越大压缩率越高，取值范围 8 ~ 12
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_DECOMPRESS                   0
+    #if (ENABLE_DECOMPRESS)
+    #define DECOMPRESS_WINDOW_BITS          10
+    #endif
+
+
+/**
+ * 【选择是否启用差分升级】
+ * 说明: 
+ *    - 差分固件包的包体是基于 APP 分区当前固件（基础固件）的补丁，可按需再压缩和加密
+ *    - 接收时读取 APP 分区的基础固件，边还原边写入 download/factory 分区，存放的是还原后不加密、不压缩的固件包，
+ *      之后的校验和更新与普通固件包相同。注意固件以明文存放，放置在片外 flash 时需评估风险
+ *    - 补丁头记录了基础固件的大小和 CRC32 ，与 APP 分区不一致时取消更新
+ *    - 仅多分区方案有效，单分区方案接收时 APP 分区已擦除，无法还原
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_DELTA_UPDATE                 0
+
+
+/**
+ * 【选择是否启用断点续传】
+ * 说明: 
+ *    - 固件包写入 download 分区期间，写入位置每越过分区内一个 4 Kbyte 对齐的地址，在进度记录中追加一条记录（固件包头的 CRC32 、
+ *      该地址之前的包体数据量和 CRC32 中间值），传输中断或设备掉电后，主机重新下发同一个固件包时，设备校验已写入的数据，
+ *      只擦除记录位置之后已写入的数据，并告知主机从记录的位置继续发送
+ *    - 主机需在第 0 帧请求断点续传（ YModem 的 "RESUME" ），未请求时按新的固件包重新接收
+ *    - 进度记录占用 download 分区末尾的 RESUME_JOURNAL_SIZE byte ，需为 flash 擦除粒度的整数倍，固件包不能超过剩余的空间
+ *    - download 分区所在 flash 的擦除粒度需不大于 4 Kbyte ，且 4 Kbyte 为其整数倍
+ *    - 仅多分区方案下发至 download 分区的固件包有效，差分固件包在接收时还原，无法续传
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_RESUME_TRANSFER              0
+    #if (ENABLE_RESUME_TRANSFER)
+    #define RESUME_JOURNAL_SIZE             4096
+    #endif
+
+
+/**
+ * 【选择是否启用 APP 分区的增量写入】
+ * 说明: 
+ *    - 固件更新至 APP 分区前，先将固件包读取、解密、解压一遍，按 INCREMENTAL_ERASE_UNIT 分块与 APP 分区的现有数据比较，
+ *      只擦除和写入有差异的块，相同的块保持不变，适用于小版本更新或恢复出厂固件等大部分数据不变的场景
+ *    - APP 分区的首个块总是擦除和重写，其首地址数据仍在校验通过后最后写入
+ *    - INCREMENTAL_ERASE_UNIT 需为 APP 分区所在 flash 的擦除粒度（或其整数倍），APP 分区内的擦除粒度需统一，
+ *      APP_PART_SIZE 需为其整数倍。 STM32F4 等 sector 大小不一的 flash 不适用
+ *    - 仅多分区方案有效
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_INCREMENTAL_UPDATE           0
+    #if (ENABLE_INCREMENTAL_UPDATE)
+    #define INCREMENTAL_ERASE_UNIT          FLASH_PAGE_SIZE
+    #endif
+
+
+/**
+ * 【选择是否在接收时计算固件包的 CRC32 】
+ * 说明: 
+ *    - 主机下发的固件包写入 flash 时，同时累加包体（还原后写入 APP 分区时为源固件）的 CRC32 ，接收完成后直接与包头中的
+ *      CRC32 比较，不再将整个固件包从分区中读出校验，固件包放在 SPI flash 时可省去一次完整的读取
+ *    - 固件包从 download/factory 分区更新至 APP 分区时，同样累加解密、解压后的源固件的 CRC32 ，校验 APP 时不再读取整个 APP 分区，
+ *      写入 flash 的数据由 USING_APP_WRITE_CHECK_PROJECT 的写入检查确认
+ *    - STREAM_VERIFY_READ_BACK 为 1 时，校验前读回最后一次写入的数据，确认与写入时的 CRC32 一致
+ *    - 写入过程中出现非顺序的写入（如重新开始写入或擦除了该分区）时，仍读取整个固件包校验
+ *    - 取舍: 省去的是 download/factory 分区的完整读回，校验只能发现最后一次写入的错误。 SPI flash 没有写入检查，
+ *      分区中间的一次编程失败会通过校验，随后擦除 APP 分区，直至校验 APP 时才发现，双分区方案此时已没有可运行的固件。
+ *      flash 写入可靠或以速度优先时才启用
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_STREAM_VERIFY                0
+    #if (ENABLE_STREAM_VERIFY)
+    #define STREAM_VERIFY_READ_BACK         1
+    #endif
+
+
+/**
+ * 【选择固件写入 APP 分区后的检查方案】
+ * 说明: 
+ *    - 固件更新至 APP 分区（单分区方案为主机下发至 APP 分区）时，每次写入 flash 后将刚写入的数据读回，
+ *      与 RAM 中的数据逐字节比较，不一致时本次更新失败。比较只需读取，比读出后计算 CRC32 快
+ *    - ENABLE_STREAM_VERIFY 为 1 时，校验 APP 不再读取整个 APP 分区，写入 flash 的结果只由本检查确认
+ *    - 每次检查都要读回刚写入的数据，增加更新至 APP 的耗时。 ENABLE_STREAM_VERIFY 为 1 时应选择 SAMPLE 或 FULL ，
+ *      否则写入 APP 分区的错误不会被发现
+ * 解释: 
+ *    APP_WRITE_CHECK_NONE  : 不检查，只以 flash 写入函数的返回值判断
+ *    APP_WRITE_CHECK_SAMPLE: 从首次写入开始，每 APP_WRITE_CHECK_SAMPLE_NUM 次写入检查一次
+ *    APP_WRITE_CHECK_FULL  : 每次写入都检查
+ * 选项: USING_APP_WRITE_CHECK_PROJECT
+ *    APP_WRITE_CHECK_NONE      或 0
+ *    APP_WRITE_CHECK_SAMPLE    或 1
+ *    APP_WRITE_CHECK_FULL      或 2
+ */
+#define USING_APP_WRITE_CHECK_PROJECT       APP_WRITE_CHECK_NONE
+    #if (USING_APP_WRITE_CHECK_PROJECT == APP_WRITE_CHECK_SAMPLE)
+    #define APP_WRITE_CHECK_SAMPLE_NUM      4
+    #endif
+
+
+/**
+ * 【选择是否在接收固件包时擦除分区】
+ * 说明: 
+ *    - 收到固件包头后不再先擦除整个固件占用的范围，而是按 FPK_LEAST_HANDLE_BYTE 分块，写入前才擦除写入位置所在的块，
+ *      其余的块在等待主机数据时逐块擦除，擦除与通讯并行进行。已是擦除状态的块不再擦除
+ *    - 多分区方案收到文件信息（ YModem 的第 0 帧或窗口协议的 START ）时，按文件大小预先擦除 download 分区，
+ *      APP 也可在跳转至 bootloader 前调用 Bootloader_PrepareFirmware 预告固件包的大小。
+ *      download 分区有未接收完毕的进度记录或主机请求断点续传时不预先擦除。固件包指定存放在 factory 分区时，
+ *      download 分区已预先擦除的部分不会恢复
+ *    - 移植文件的 geometry 接口提供 sector 布局时，每个块按擦除计划对齐到实际的 sector 或块擦除，STM32F4 等 sector 大于
+ *      FPK_LEAST_HANDLE_BYTE 的 flash 每个 sector 只擦除一次。分区首尾需在 sector 边界上，分区末尾的记录不能与固件共用 sector ，
+ *      FM_Init 按 sector 布局检查并打印警告
+ *    - 移植文件不提供 sector 布局时，固件包所在 flash 的擦除粒度不能大于 FPK_LEAST_HANDLE_BYTE ，否则擦除一个块会连带擦除已写入的数据
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_ERASE_AHEAD                  0
+
+/**
+ * 【选择是否在 flash 中记录各分区的擦除状态】
+ * 说明: 
+ *    - 在片内 flash 末尾的 ERASE_STATE_SIZE byte 中追加记录 APP 、 download 和 factory 分区中可能有数据的范围，
+ *      擦除或检查为空后记录为擦除状态，写入前先将写入位置至分区末尾记录为有数据。启动后按记录判断分区是否为空，
+ *      只擦除有数据的范围，无须再读取整个分区。记录写满后擦除，重写各分区最后的记录
+ *    - ERASE_STATE_SIZE 需为片内 flash 擦除粒度的整数倍，不能与片内的分区重叠。启用 SPI flash 时记录区同样位于片内 flash 末尾，
+ *      即 fal_cfg.h 分区表中的 FAL_PART_ERASE_STATE
+ *    - ENABLE_ERASE_STATE_VERIFY 为 1 时，上次运行中有未结束的写入或不完整的记录（写入期间复位或掉电）的，
+ *      本次启动不使用记录，各分区按原方式读取检查，检查或擦除后重新记录
+ *    - 各分区只能由 bootloader 写入， APP 也会写入这些分区时不能启用。分区末尾的记录（断点续传的进度记录等）不在此列，每次仍读取检查
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_ERASE_STATE                  0
+    #if (ENABLE_ERASE_STATE)
+    #define ERASE_STATE_SIZE                4096
+    #define ENABLE_ERASE_STATE_VERIFY       1
+    #endif
+
+/**
+ * 【选择是否启用异步的 flash 操作】
+ * 说明: 
+ *    - flash 的擦除和写入排队后即返回，由 Bootloader_Loop 逐步推进，擦写期间仍可处理主机数据。读取时只等待与读取范围重叠的擦写，
+ *      擦写未完成时各流程返回 FM_ERR_BUSY ，下次循环再次执行
+ *    - 移植文件的 async 接口提供 flash 的异步擦写时（ SFUD 的 SPI flash 、由中断或忙标志驱动的片内 flash ），每次只启动一个 sector 的擦除
+ *      或一页的编程；返回 NULL 的移植文件仍按阻塞方式每次执行一步。代码在同一 bank 中运行的片内 flash 擦写期间 CPU 取指会停顿，应返回 NULL
+ *    - ASYNC_FLASH_BUFF_SIZE 为排队中的写入数据的缓存，需为 1024 的整数倍，不小于 4096 ，一次写入最多占用其 1/4
+ *    - 启用 USING_APP_WRITE_CHECK_PROJECT 时，写入检查在数据写入完成后执行，比较写入前后数据的 CRC32
+ * 选项: 
+ *    0: 不启用
+ *    1: 启用
+ */
+#define ENABLE_ASYNC_FLASH                  0
+    #if (ENABLE_ASYNC_FLASH)
+    #define ASYNC_FLASH_BUFF_SIZE           8192
+    #endif
+
+
 /**
  * 【片内 flash 一次写入的最小字节数】
  * 说明：
@@ -144,6 +337,130 @@
                                                              */
 
 
+/**
+ * 【选择是否支持 YModem-G 流式传输】
+ * 说明：
+ *    1. YModem-G 的数据帧由主机连续下发，设备不逐帧应答，省去每帧的应答往返和断帧检测的等待时间
+ *    2. 设备先以字符 'G' 握手，发送 YMODEM_G_HANDSHAKE_TIMES 次仍无响应，则改以字符 'C' 按 YModem 传输
+ *    3. YModem-G 没有重传机制，数据帧校验失败或写入 flash 失败时，设备发送 CAN 取消本次传输
+ *    4. 固件包头所在的数据帧会触发分区擦除，设备处理完该帧后回复 ACK ，主机需等待该 ACK 后再连续下发
+ * 注意事项：
+ *    1. YModem-G 没有流控， flash 的写入跟不上通信速率时，积压的数据帧会使接收缓存溢出。设备在第 0 帧按当前波特率、固件大小和
+ *       YMODEM_G_FRAME_WRITE_TIME 估算传输结束时积压的数据量，接收缓存（ YMODEM_G_BUFF_FRAME_NUM 个数据帧）放不下时，
+ *       第 0 帧回复 ACK ，改按 YModem 逐帧应答传输
+ *    2. YMODEM_G_FRAME_WRITE_TIME 按 flash 数据手册的最大编程和擦除时间估算，偏小会导致传输被取消，偏大只会更多地改按 YModem 传输
+ *    3. 未启用 ENABLE_BAUD_NEGOTIATION 时设备不知道当前波特率，只在接收缓存能放下整个固件包时按 YModem-G 传输
+ */
+#define ENABLE_YMODEM_G                     0
+    #if (ENABLE_YMODEM_G)
+    #define YMODEM_G_HANDSHAKE_TIMES        3               /* 以 'G' 握手的次数，每秒 1 次 */
+    #define YMODEM_G_BUFF_FRAME_NUM         4               /* 接收缓存可暂存的数据帧数量，每帧 1029 byte */
+    #define YMODEM_G_FRAME_WRITE_TIME       42000           /* 写入一个 1024 byte 数据帧的最长耗时，含分摊的擦除时间，单位 us */
+    #endif
+
+
+/**
+ * 【选择是否启用 YModem 的帧解析器】
+ * 说明：
+ *    0: 禁用，YModem 以 UART 空闲中断和 BROKEN_FRAME_INTERVAL_TIME 的断帧检测分帧（ YModem-G 除外），每帧需多等待一个断帧间隔
+ *    1: 启用，接收中断将数据放入接收缓存后，由帧解析器按帧头确定帧长、逐段计算校验值，
+ *       最后一个校验字节到达时即取出一帧交由协议析构层处理，不再等待断帧检测，帧结构见 protocol_frame.h
+ * 注意事项：
+ *    1. 不是帧头的数据逐字节丢弃，数据帧头以正反序列号排除乱码，正反序列号错误的帧不应答 NAK ，由主机超时重发
+ *    2. 校验值在主循环中随接收逐段计算，不会延长接收中断的处理时间
+ */
+#define ENABLE_FRAME_PARSER                 0
+
+
+/**
+ * 【选择是否支持滑动窗口传输协议】
+ * 说明：
+ *    1. 与 YModem 并存的可选协议，主机以 PW_SOF 开头的 START 帧代替 YModem 的第 0 帧即进入该协议，帧结构和流程见 protocol_window.h
+ *    2. 主机可连续发送 WINDOW_PROTOCOL_FRAME_NUM 个未确认的数据帧，设备按序处理完每一帧后回复累积确认，
+ *       并附带已收到的乱序帧位图（选择确认），出错或缺帧时只需重发该帧
+ *    3. 设备未处理完的数据帧不会被确认，主机发送速度受窗口大小限制，不会像 YModem-G 一样因 flash 写入慢而溢出
+ * 注意事项：
+ *    WINDOW_PROTOCOL_FRAME_NUM 取值 1 ~ 32 ，占用的 RAM 约为 (2 * WINDOW_PROTOCOL_FRAME_NUM + 1) * 1 Kbyte ，
+ *    即接收缓存 (WINDOW_PROTOCOL_FRAME_NUM + 1) 帧和乱序缓存 WINDOW_PROTOCOL_FRAME_NUM 帧
+ */
+#define ENABLE_WINDOW_PROTOCOL              0
+    #if (ENABLE_WINDOW_PROTOCOL)
+    #define WINDOW_PROTOCOL_FRAME_NUM       4               /* 窗口大小，即未确认的数据帧最多的数量 */
+    #endif
+
+
+/**
+ * 【选择是否支持 YModem 的扩展数据帧】
+ * 说明：
+ *    1. 扩展数据帧的帧头为 YMODEM_STX_EXT ，数据长度为 YMODEM_EXT_DATA_LEN ，以 CRC32 校验，帧结构见 protocol_parser.h
+ *    2. 主机在第 0 帧的文件大小之后附加 "EXT=<数据长度>" 请求使用扩展数据帧，长度与 YMODEM_EXT_DATA_LEN 一致时，
+ *       设备在第 0 帧之后以字符 'E' 代替 'C' 或 'G' 握手，主机随后以扩展数据帧发送固件包体，否则仍按 1024 byte 的 STX 数据帧发送
+ *    3. YMODEM_EXT_DATA_LEN 与 FPK_LEAST_HANDLE_BYTE 一致时，一个数据帧即为一次 flash 写入的单位，应答次数降为原来的 1/4
+ * 注意事项：
+ *    YMODEM_EXT_DATA_LEN 须为 1024 的整数倍且能整除 FPK_LEAST_HANDLE_BYTE ，
+ *    接收缓存需增加约 YMODEM_EXT_DATA_LEN - 1024 byte 的 RAM
+ */
+#define ENABLE_YMODEM_EXT_FRAME             0
+    #if (ENABLE_YMODEM_EXT_FRAME)
+    #define YMODEM_EXT_DATA_LEN             4096            /* 扩展数据帧的数据长度，单位 byte */
+    #endif
+
+
+/**
+ * 【选择是否启用固件写入的后台队列】
+ * 说明：
+ *    0: 禁用，固件分包写入 flash 后才应答主机，主机发送下一帧与设备写入 flash 交替进行
+ *    1: 启用，固件分包通过校验并复制至队列的空闲块后即应答主机，在主循环中逐块写入 flash ，
+ *       主机发送后续数据帧与设备写入 flash 同时进行
+ * 注意事项：
+ *    1. 队列有 WRITE_BEHIND_BLOCK_NUM 个块，每块 FPK_LEAST_HANDLE_BYTE byte ，多个固件分包合并为一块写入，
+ *       需占用 WRITE_BEHIND_BLOCK_NUM * FPK_LEAST_HANDLE_BYTE byte 的 RAM
+ *    2. 队列已满时，等待最早的块写入完成后再应答
+ *    3. 后台写入失败时，在下一个数据帧或 EOT 的应答中取消传输
+ */
+#define ENABLE_WRITE_BEHIND                 0
+    #if (ENABLE_WRITE_BEHIND)
+    #define WRITE_BEHIND_BLOCK_NUM          2               /* 队列的块数，至少为 2 */
+    #endif
+
+
+/**
+ * 【选择是否启用波特率协商】
+ * 说明：
+ *    1. 主机收到握手字符后，可在第 0 帧之前发送波特率请求，按优先顺序列出想要使用的波特率，帧结构和流程见 protocol_parser.h
+ *    2. 设备选择其中第一个不超过 BAUD_NEGOTIATION_MAX_RATE 且 UART 时钟能够产生（误差不超过 2%）的波特率，
+ *       以原波特率应答后双方同时切换，再由主机发送探测帧、设备原样回送以确认线路可用
+ *    3. 探测帧或第 0 帧在 BAUD_NEGOTIATION_TIMEOUT 内未收到时，设备恢复原波特率并重新发送握手字符，
+ *       主机同样恢复原波特率，可改用更低的波特率再次请求
+ *    4. 每次开始接收固件时（ PP_CONFIG_RESET ）恢复为 UART 初始化时的波特率
+ * 注意事项：
+ *    切换波特率依赖 UART 移植文件的 BSP_UART_Port_CheckBaudRate 和 BSP_UART_Port_SetBaudRate ，
+ *    需确认 USB 转串口芯片和线缆支持所请求的波特率
+ */
+#define ENABLE_BAUD_NEGOTIATION             0
+    #if (ENABLE_BAUD_NEGOTIATION)
+    #define BAUD_NEGOTIATION_MAX_RATE       2000000         /* 允许切换的最高波特率 */
+    #define BAUD_NEGOTIATION_TIMEOUT        1000            /* 等待探测帧和第 0 帧的超时时间，单位 ms */
+    #endif
+
+
+/**
+ * 【CRC 的计算方式】
+ * 说明：
+ *    1. 数据帧的 CRC16 和固件包的 CRC32 均以 ROM 中的常量表查表计算，见 crc_engine.h
+ *    2. CRC_SLICE_NUM 为每次查表处理的字节数，越大越快，计算表占用的 ROM 越多：
+ *       1: 逐字节查表，计算表共 1.5 Kbyte
+ *       4: 按字读取，每次处理 4 byte ，计算表共 6 Kbyte
+ *       8: 每次处理 8 byte ，计算表共 12 Kbyte
+ *    3. ENABLE_CRC32_HARDWARE 为 1 时，CRC32 由 STM32 的 CRC 外设计算（需 Cortex-M3 及以上内核的 __RBIT 指令），
+ *       首尾不足一个字的部分仍查表计算， CRC16 不使用外设
+ * 注意事项：
+ *    bootloader 的空间紧张时，选择较小的 CRC_SLICE_NUM ，非 STM32 的芯片不能启用 ENABLE_CRC32_HARDWARE
+ */
+#define CRC_SLICE_NUM                       4
+#define ENABLE_CRC32_HARDWARE               0
+
+
 /**
  * 【固件更新标志变量存放的内存地址】
  * 说明: 
@@ -59,6 +59,21 @@ extern struct fal_flash_dev spi_flash1;
 /* ====================== Partition Configuration ========================== */
 
 #if (IS_ENABLE_SPI_FLASH && defined(FAL_PART_HAS_TABLE_CFG))
+#if (ENABLE_ERASE_STATE)
+/* 擦除状态的记录区，位于片内 flash 末尾 */
+#define FAL_PART_ERASE_STATE                                                \
+    {                                                                       \
+        .magic_word = FAL_PART_MAGIC_WORD,                                  \
+        .name       = ERASE_STATE_PART_NAME,                                \
+        .flash_name = FAL_ONCHIP_FLASH_DEV_NAME,                            \
+        .offset     = ONCHIP_FLASH_SIZE - ERASE_STATE_SIZE,                 \
+        .len        = ERASE_STATE_SIZE,                                     \
+        .reserved   = 0,                                                    \
+    },
+#else
+#define FAL_PART_ERASE_STATE
+#endif
+
 #if (USING_PART_PROJECT == DOUBLE_PART_PROJECT)
 /* 双分区方案 */
 #if (DOWNLOAD_PART_LOCATION == STORE_IN_ONCHIP_FLASH)
@@ -89,6 +104,7 @@ extern struct fal_flash_dev spi_flash1;
         .len        = DOWNLOAD_PART_SIZE,                                   \
         .reserved   = 0,                                                    \
     },                                                                      \
+    FAL_PART_ERASE_STATE                                                    \
 }
 #else
 /* 情形二： download 分区在 SPI flash */
@@ -118,6 +134,7 @@ extern struct fal_flash_dev spi_flash1;
         .len        = DOWNLOAD_PART_SIZE,                                   \
         .reserved   = 0,                                                    \
     },                                                                      \
+    FAL_PART_ERASE_STATE                                                    \
 }
 #endif  /* #if (DOWNLOAD_PART_LOCATION == STORE_IN_ONCHIP_FLASH) */
 #else
@@ -158,6 +175,7 @@ extern struct fal_flash_dev spi_flash1;
         .len        = FACTORY_PART_SIZE,                                    \
         .reserved   = 0,                                                    \
     },                                                                      \
+    FAL_PART_ERASE_STATE                                                    \
 }
 #elif (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH && FACTORY_PART_LOCATION == STORE_IN_ONCHIP_FLASH)
 /* 情形二： download 分区在 SPI flash， factory 分区在片内 */
@@ -195,6 +213,7 @@ extern struct fal_flash_dev spi_flash1;
         .len        = DOWNLOAD_PART_SIZE,                                   \
         .reserved   = 0,                                                    \
     },                                                                      \
+    FAL_PART_ERASE_STATE                                                    \
 }
 #elif (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH && FACTORY_PART_LOCATION == STORE_IN_SPI_FLASH)
 /* 情形三： download 分区和 factory 分区都在 SPI flash */
@@ -232,6 +251,7 @@ extern struct fal_flash_dev spi_flash1;
         .len        = FACTORY_PART_SIZE,                                    \
         .reserved   = 0,                                                    \
     },                                                                      \
+    FAL_PART_ERASE_STATE                                                    \
 }
 #endif
 #endif /* #if (USING_PART_PROJECT == DOUBLE_PART_PROJECT) */
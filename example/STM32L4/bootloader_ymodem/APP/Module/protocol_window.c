@@ -0,0 +1,646 @@
+/**
+ * \file            protocol_window.c
+ * \brief           sliding window protocol
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.2
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ * 2026-10-18                  数据帧长度改用 PW_DATA_MAX_LEN ，不随 YModem 扩展数据帧增大
+ * 2026-10-18                  CRC16 改用 crc_engine.c 的查表计算
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "protocol_window.h"
+
+#if (ENABLE_WINDOW_PROTOCOL)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+    PW_STATE_IDLE = 0x00,       /* 未建立会话，等待 START */
+    PW_STATE_TRANSFER,          /* 已回复 READY ，正在接收数据帧 */
+    PW_STATE_FINISH,            /* 已收到 END ，正在或已经回复 FINISH */
+    PW_STATE_ABORT,             /* 已取消传输，丢弃收到的数据，直至 PP_CONFIG_RESET */
+
+} PW_STATE;
+
+
+/* Private variables ---------------------------------------------------------*/
+static PW_STATE                 _state;                 /* 会话状态 */
+static bool                     _is_enable_recv_cmd;    /* 使能是否接收主机的指令包 */
+static PP_CMD                   _exe_cmd;               /* 正在由业务层处理的指令， PP_CMD_NONE: 无 */
+static int8_t                   _exe_slot;              /* 正在处理的数据帧所在的乱序缓存， -1: 在接收缓存中 */
+static uint16_t                 _stream_frame_len;      /* 正在处理的帧在接收缓存中的长度，处理完毕后移除 */
+static uint16_t                 _cum_seq;               /* 期望的下一个数据帧序号，即累积确认的序号 */
+static uint16_t                 _last_seq;              /* 最近收到的数据帧序号，用于推测校验出错的帧 */
+static uint32_t                 _nak_sent;              /* 已 NAK 的帧， bit n 对应 _cum_seq + n ，避免同一帧重复 NAK */
+static uint32_t                 _slot_valid;            /* 乱序缓存的有效位， bit n 对应 _slot_data[n] */
+static uint16_t                 _slot_len[WINDOW_PROTOCOL_FRAME_NUM];
+static uint8_t                  _slot_data[WINDOW_PROTOCOL_FRAME_NUM][PW_DATA_MAX_LEN];   /* 乱序缓存，序号为 seq 的数据帧存于 seq % 窗口大小 */
+static uint8_t                  _tx_buff[PW_FRAME_FIXED_LEN + 4];
+static volatile bool            _is_keepalive;          /* 业务层处理期间，到了重复 ACK 的时间 */
+static struct BSP_TIMER         _timer_keepalive;       /* 业务层处理期间重复 ACK 的定时器 */
+
+/* 与 YModem 共用的协议析构层回调函数 */
+static PP_Send_t                _PW_Send;               /* 数据发送接口 */
+static PP_PrepareCallback_t     _PW_Prepare;            /* 收到主机指令时的预备处理接口 */
+static PP_ReplyCallback_t       _PW_GetReplyInfo;       /* 查询业务层执行过程和结果的接口 */
+
+
+/* Private function prototypes -----------------------------------------------*/
+static PP_CMD_ERR_CODE      _Frame_Process          (uint8_t *data, uint16_t *len, uint16_t frame_len);
+static void                 _Exe_Command            (PP_CMD cmd, uint8_t *data, uint16_t data_len, uint16_t frame_len);
+static void                 _Exe_ResultProcess      (uint8_t *data, uint16_t *len);
+static void                 _Exe_NextSlot           (void);
+static void                 _Send_Frame             (uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len);
+static void                 _Send_Ack               (void);
+static void                 _Send_Nak               (uint16_t seq);
+static void                 _Abort                  (bool is_notify);
+static void                 _Session_Reset          (void);
+static void                 _Stream_Remove          (uint8_t *data, uint16_t *len, uint16_t remove_len);
+static void                 _Timer_KeepaliveHandler (void *user_data);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  滑动窗口协议的初始化
+ * @note   回调函数与 PP_Init 的相同
+ * @param[in]  Send: 底层数据发送接口
+ * @param[in]  PrepareCallback: 指令包的处理接口
+ * @param[in]  Set_ResponseInfo: 查询指令执行结果的处理接口
+ * @retval None
+ */
+void PW_Init(PP_Send_t               Send,
+             PP_PrepareCallback_t    PrepareCallback,
+             PP_ReplyCallback_t      Set_ResponseInfo)
+{
+    _PW_Send         = Send;
+    _PW_Prepare      = PrepareCallback;
+    _PW_GetReplyInfo = Set_ResponseInfo;
+
+    BSP_Timer_Init( &_timer_keepalive,
+                    _Timer_KeepaliveHandler,
+                    PW_KEEPALIVE_TIME,
+                    TIMER_RUN_FOREVER,
+                    TIMER_TYPE_HARDWARE);
+
+    _is_enable_recv_cmd = true;
+    _state = PW_STATE_IDLE;
+    _Session_Reset();
+}
+
+
+/**
+ * @brief  滑动窗口协议的解析处理函数
+ * @note   1. 会话期间（ PW_IsActive 为 true ）或缓存以 PW_SOF 开头时，替代断帧检测和 PP_Handler 被主程序循环调用
+ *         2. 按帧头中的长度逐帧取出缓存中的完整帧，按序的数据帧直接从接收缓存交给业务层，处理完毕后才移除
+ *         3. 超前的数据帧拷贝至乱序缓存，轮到时再交给业务层
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量，由接收中断累加
+ * @retval PP_CMD_ERR_CODE
+ */
+PP_CMD_ERR_CODE PW_StreamHandler(uint8_t *data, uint16_t *len)
+{
+    uint16_t i;
+    uint16_t payload_len;
+    uint16_t frame_len;
+    uint16_t crc16;
+    uint16_t raw_crc16;
+
+    /* 不接收主机的指令时，丢弃收到的数据 */
+    if (_is_enable_recv_cmd == false)
+    {
+        _Stream_Remove(data, len, *len);
+        return PP_ERR_OK;
+    }
+
+    /* 业务层还在处理上一条指令 */
+    if (_exe_cmd != PP_CMD_NONE)
+    {
+        _Exe_ResultProcess(data, len);
+        return PP_ERR_OK;
+    }
+
+    if (*len == 0)
+        return PP_ERR_OK;
+
+    /* 已取消传输，主机可能还在发送，全部丢弃 */
+    if (_state == PW_STATE_ABORT)
+    {
+        _Stream_Remove(data, len, *len);
+        return PP_ERR_OK;
+    }
+
+    /* 丢弃帧头前的数据 */
+    for (i = 0; i < *len && data[i] != PW_SOF; i++) {}
+    if (i)
+    {
+        _Stream_Remove(data, len, i);
+        return PP_ERR_OK;
+    }
+
+    /* 还未收完帧头 */
+    if (*len < PW_HEAD_LEN)
+        return PP_ERR_OK;
+
+    payload_len = data[4] | (data[5] << 8);
+    if (payload_len > PW_DATA_MAX_LEN)
+    {
+        /* 不是真正的帧头 */
+        _Stream_Remove(data, len, 1);
+        return PP_ERR_FRAME_LENGTH_ERR;
+    }
+
+    /* 还未收完一帧 */
+    frame_len = PW_FRAME_FIXED_LEN + payload_len;
+    if (*len < frame_len)
+        return PP_ERR_OK;
+
+    crc16     = CRC16_XModem(&data[1], PW_HEAD_LEN - 1 + payload_len);
+    raw_crc16 = data[frame_len - 2] | (data[frame_len - 1] << 8);
+    if (crc16 != raw_crc16)
+    {
+        BSP_Printf("error: window crc16: %.4X %.4X\r\n", crc16, raw_crc16);
+
+        /* 串口上的数据帧按序到达，出错的多半是最近收到的下一帧，超出窗口时不处理，由后续的缺帧检测或主机超时重发 */
+        if (_state == PW_STATE_TRANSFER && data[1] == PW_TYPE_DATA)
+        {
+            uint16_t seq = _last_seq + 1;
+            uint16_t d   = seq - _cum_seq;
+
+            if (d < WINDOW_PROTOCOL_FRAME_NUM
+            && (_slot_valid & (1UL << (seq % WINDOW_PROTOCOL_FRAME_NUM))) == 0)
+                _Send_Nak(seq);
+        }
+
+        /* 帧头可能是数据中的 PW_SOF ，只丢弃一个字节以重新同步 */
+        _Stream_Remove(data, len, 1);
+        return PP_ERR_FRAME_VERIFY_ERR;
+    }
+
+    return _Frame_Process(data, len, frame_len);
+}
+
+
+/**
+ * @brief  配置滑动窗口协议的参数
+ * @note   由 PP_Config 调用，参数含义与其相同
+ * @param[in]  para: 需要进行配置的选型或参数
+ * @param[in]  value: 对应的数据或值
+ * @retval None
+ */
+void PW_Config(PP_CONFIG_PARA  para, void *value)
+{
+    if (para == PP_CONFIG_RESET)
+    {
+        BSP_Timer_Pause(&_timer_keepalive);
+        _is_enable_recv_cmd = true;
+        _state = PW_STATE_IDLE;
+        _Session_Reset();
+    }
+    else if (para == PP_CONFIG_ENABLE_RECV_CMD)
+    {
+        uint8_t *enable = (uint8_t *)value;
+        _is_enable_recv_cmd = (bool)*enable;
+    }
+}
+
+
+/**
+ * @brief  是否处于滑动窗口协议的会话中
+ * @note   为 true 时，应调用 PW_StreamHandler 代替断帧检测和 PP_Handler ，且协议析构层不再发送握手字符
+ * @retval true: 是 | false: 否
+ */
+bool PW_IsActive(void)
+{
+    return (_state != PW_STATE_IDLE);
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  处理一个校验正确的帧
+ * @note   交给业务层的帧暂留在缓存中，其余的帧处理后立即移除
+ * @param[in]  data: 接收数据的缓存，以帧头开始
+ * @param[in]  len: 指示缓存中数据长度的变量
+ * @param[in]  frame_len: 帧长度，单位 byte
+ * @retval PP_CMD_ERR_CODE
+ */
+static PP_CMD_ERR_CODE _Frame_Process(uint8_t *data, uint16_t *len, uint16_t frame_len)
+{
+    uint8_t  type        = data[1];
+    uint16_t seq         = data[2] | (data[3] << 8);
+    uint16_t payload_len = frame_len - PW_FRAME_FIXED_LEN;
+    uint8_t *payload     = &data[PW_HEAD_LEN];
+    uint16_t d           = seq - _cum_seq;
+
+    switch (type)
+    {
+        case PW_TYPE_START:
+        {
+            if (_state == PW_STATE_IDLE)
+            {
+                BSP_Printf("window start, window: %d\r\n", WINDOW_PROTOCOL_FRAME_NUM);
+                _Session_Reset();
+                _state = PW_STATE_TRANSFER;
+                _Exe_Command(PP_CMD_SOH, payload, payload_len, frame_len);
+                return PP_ERR_OK;
+            }
+
+            _Stream_Remove(data, len, frame_len);
+
+            /* READY 丢失，主机重发了 START */
+            if (_state == PW_STATE_TRANSFER && _cum_seq == 0 && _slot_valid == 0)
+            {
+                uint8_t ready[3] = {WINDOW_PROTOCOL_FRAME_NUM, PW_DATA_MAX_LEN & 0xFF, PW_DATA_MAX_LEN >> 8};
+                _Send_Frame(PW_TYPE_READY, 0, ready, sizeof(ready));
+            }
+            return PP_ERR_DUPLICATE_FRAME;
+        }
+        case PW_TYPE_DATA:
+        {
+            if (_state != PW_STATE_TRANSFER)
+            {
+                _Stream_Remove(data, len, frame_len);
+                return PP_ERR_EXE_FLOW_ERR;
+            }
+
+            _last_seq = seq;
+
+            /* 按序的数据帧，直接从接收缓存交给业务层 */
+            if (d == 0)
+            {
+                _exe_slot = -1;
+                _Exe_Command(PP_CMD_STX, payload, payload_len, frame_len);
+                return PP_ERR_OK;
+            }
+
+            /* 窗口内超前的数据帧，暂存至乱序缓存，并请求重发缺少的帧 */
+            if (d < WINDOW_PROTOCOL_FRAME_NUM)
+            {
+                uint8_t slot = seq % WINDOW_PROTOCOL_FRAME_NUM;
+
+                if ((_slot_valid & (1UL << slot)) == 0)
+                {
+                    memcpy(&_slot_data[slot][0], payload, payload_len);
+                    _slot_len[slot] = payload_len;
+                    _slot_valid    |= (1UL << slot);
+                }
+                _Stream_Remove(data, len, frame_len);
+                _Send_Ack();
+                _Send_Nak(_cum_seq);
+                return PP_ERR_OMISSION_FRAME;
+            }
+
+            _Stream_Remove(data, len, frame_len);
+
+            /* 已确认过的数据帧，说明之前的 ACK 丢失了，重新确认 */
+            if (d >= 0x8000)
+            {
+                _Send_Ack();
+                return PP_ERR_DUPLICATE_FRAME;
+            }
+
+            /* 超出窗口，丢弃 */
+            return PP_ERR_OMISSION_FRAME;
+        }
+        case PW_TYPE_END:
+        {
+            _Stream_Remove(data, len, frame_len);
+
+            /* FINISH 丢失，主机重发了 END */
+            if (_state == PW_STATE_FINISH)
+            {
+                _Send_Frame(PW_TYPE_FINISH, seq, NULL, 0);
+                return PP_ERR_DUPLICATE_FRAME;
+            }
+            if (_state != PW_STATE_TRANSFER)
+                return PP_ERR_EXE_FLOW_ERR;
+
+            /* 还有数据帧未收到 */
+            if (d != 0)
+            {
+                _Send_Nak(_cum_seq);
+                return PP_ERR_OMISSION_FRAME;
+            }
+
+            BSP_Printf("window end, frames: %d\r\n", seq);
+            _Exe_Command(PP_CMD_EOT, NULL, 0, 0);
+            return PP_ERR_OK;
+        }
+        case PW_TYPE_ABORT:
+        {
+            _Stream_Remove(data, len, frame_len);
+
+            if (_state == PW_STATE_TRANSFER || _state == PW_STATE_FINISH)
+            {
+                BSP_Printf("window abort by host\r\n");
+                _state = PW_STATE_ABORT;
+                _PW_Prepare(PP_CMD_CAN, NULL, 0);
+            }
+            return PP_ERR_OK;
+        }
+        default:
+        {
+            _Stream_Remove(data, len, frame_len);
+            return PP_ERR_HEADER_ERR;
+        }
+    }
+}
+
+
+/**
+ * @brief  将指令交给业务层处理
+ * @note   之后每次调用 PW_StreamHandler 时查询处理结果，直至处理完毕
+ * @param[in]  cmd: 交给业务层的指令
+ * @param[in]  data: 指令的数据
+ * @param[in]  data_len: 数据长度，单位 byte
+ * @param[in]  frame_len: 该帧在接收缓存中的长度，处理完毕后移除， 0: 不在接收缓存中
+ * @retval None
+ */
+static void _Exe_Command(PP_CMD cmd, uint8_t *data, uint16_t data_len, uint16_t frame_len)
+{
+    _exe_cmd          = cmd;
+    _stream_frame_len = frame_len;
+    _is_keepalive     = false;
+    BSP_Timer_Restart(&_timer_keepalive);
+
+    _PW_Prepare(cmd, data, data_len);
+}
+
+
+/**
+ * @brief  查询业务层的处理结果并回复主机
+ * @note
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量
+ * @retval None
+ */
+static void _Exe_ResultProcess(uint8_t *data, uint16_t *len)
+{
+    static PP_CMD_EXE_RESULT  result;
+    PP_CMD  cmd = _exe_cmd;
+
+    _PW_GetReplyInfo(cmd, &result, NULL, NULL);
+
+    /* 业务层还在处理数据（如擦除分区），定时重复 ACK ，主机据此推迟超时重发 */
+    if (result == PP_RESULT_PROCESS)
+    {
+        if (_is_keepalive)
+        {
+            _is_keepalive = false;
+            _Send_Ack();
+        }
+        return;
+    }
+
+    BSP_Timer_Pause(&_timer_keepalive);
+    _exe_cmd = PP_CMD_NONE;
+
+    if (_stream_frame_len)
+    {
+        _Stream_Remove(data, len, _stream_frame_len);
+        _stream_frame_len = 0;
+    }
+
+    /* 数据帧处理失败，请求主机重发该帧 */
+    if (result == PP_RESULT_FAILED && cmd == PP_CMD_STX)
+    {
+        if (_exe_slot >= 0)
+            _slot_valid &= ~(1UL << _exe_slot);
+
+        _nak_sent &= ~1UL;
+        _Send_Nak(_cum_seq);
+        return;
+    }
+    if (result != PP_RESULT_OK)
+    {
+        /* PP_RESULT_CANCEL 时业务层已自行结束，无需再通知 */
+        _Abort(result == PP_RESULT_FAILED);
+        return;
+    }
+
+    switch (cmd)
+    {
+        case PP_CMD_SOH:
+        {
+            /* 文件信息 */
+            if (_state == PW_STATE_TRANSFER)
+            {
+                uint8_t ready[3] = {WINDOW_PROTOCOL_FRAME_NUM, PW_DATA_MAX_LEN & 0xFF, PW_DATA_MAX_LEN >> 8};
+                _Send_Frame(PW_TYPE_READY, 0, ready, sizeof(ready));
+            }
+            /* 与 YModem 最后一个空的 SOH 数据帧相同，表示文件传输完毕 */
+            else
+            {
+                _Send_Frame(PW_TYPE_FINISH, _cum_seq, NULL, 0);
+            }
+            break;
+        }
+        case PP_CMD_STX:
+        {
+            if (_exe_slot >= 0)
+                _slot_valid &= ~(1UL << _exe_slot);
+
+            _cum_seq++;
+            _nak_sent >>= 1;
+            _Send_Ack();
+            _Exe_NextSlot();
+            break;
+        }
+        case PP_CMD_EOT:
+        {
+            /* 业务层需再收到一个空的 SOH 才会开始更新固件 */
+            _state = PW_STATE_FINISH;
+            _Exe_Command(PP_CMD_SOH, NULL, 0, 0);
+            break;
+        }
+        default: break;
+    }
+}
+
+
+/**
+ * @brief  乱序缓存中有期望的下一帧时，将其交给业务层
+ * @note
+ * @retval None
+ */
+static void _Exe_NextSlot(void)
+{
+    uint8_t slot = _cum_seq % WINDOW_PROTOCOL_FRAME_NUM;
+
+    if (_slot_valid & (1UL << slot))
+    {
+        _exe_slot = slot;
+        _Exe_Command(PP_CMD_STX, &_slot_data[slot][0], _slot_len[slot], 0);
+    }
+}
+
+
+/**
+ * @brief  向主机发送一帧
+ * @note
+ * @param[in]  type: 帧类型
+ * @param[in]  seq: 序号
+ * @param[in]  payload: 数据，可为 NULL
+ * @param[in]  len: 数据长度，最多 4 byte
+ * @retval None
+ */
+static void _Send_Frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len)
+{
+    uint16_t crc16;
+
+    _tx_buff[0] = PW_SOF;
+    _tx_buff[1] = type;
+    _tx_buff[2] = seq & 0xFF;
+    _tx_buff[3] = seq >> 8;
+    _tx_buff[4] = len & 0xFF;
+    _tx_buff[5] = len >> 8;
+    if (len)
+        memcpy(&_tx_buff[PW_HEAD_LEN], payload, len);
+
+    crc16 = CRC16_XModem(&_tx_buff[1], PW_HEAD_LEN - 1 + len);
+    _tx_buff[PW_HEAD_LEN + len]     = crc16 & 0xFF;
+    _tx_buff[PW_HEAD_LEN + len + 1] = crc16 >> 8;
+
+    _PW_Send(_tx_buff, PW_FRAME_FIXED_LEN + len, HAL_MAX_DELAY);
+}
+
+
+/**
+ * @brief  回复 ACK
+ * @note   seq 为期望的下一帧，数据为乱序缓存中已收到的帧的位图， bit n 对应 seq + 1 + n
+ * @retval None
+ */
+static void _Send_Ack(void)
+{
+    uint32_t sack = 0;
+    uint8_t  bitmap[4];
+
+    for (uint8_t n = 0; n < WINDOW_PROTOCOL_FRAME_NUM - 1; n++)
+    {
+        if (_slot_valid & (1UL << ((uint16_t)(_cum_seq + 1 + n) % WINDOW_PROTOCOL_FRAME_NUM)))
+            sack |= (1UL << n);
+    }
+
+    bitmap[0] = sack;
+    bitmap[1] = sack >> 8;
+    bitmap[2] = sack >> 16;
+    bitmap[3] = sack >> 24;
+    _Send_Frame(PW_TYPE_ACK, _cum_seq, bitmap, sizeof(bitmap));
+}
+
+
+/**
+ * @brief  请求主机重发一帧
+ * @note   同一帧只请求一次，再丢失时由主机超时重发
+ * @param[in]  seq: 需要重发的帧序号
+ * @retval None
+ */
+static void _Send_Nak(uint16_t seq)
+{
+    uint16_t d = seq - _cum_seq;
+
+    if (d >= 32 || (_nak_sent & (1UL << d)))
+        return;
+
+    _nak_sent |= (1UL << d);
+    _Send_Frame(PW_TYPE_NAK, seq, NULL, 0);
+}
+
+
+/**
+ * @brief  取消传输
+ * @note   向主机发送 ABORT ，之后收到的数据全部丢弃，直至 PP_CONFIG_RESET
+ * @param[in]  is_notify: 是否以 PP_CMD_CAN 通知业务层
+ * @retval None
+ */
+static void _Abort(bool is_notify)
+{
+    BSP_Printf("window abort\r\n");
+
+    _state = PW_STATE_ABORT;
+    _Send_Frame(PW_TYPE_ABORT, _cum_seq, NULL, 0);
+
+    if (is_notify)
+        _PW_Prepare(PP_CMD_CAN, NULL, 0);
+}
+
+
+/**
+ * @brief  复位会话的序号和缓存
+ * @note
+ * @retval None
+ */
+static void _Session_Reset(void)
+{
+    _exe_cmd          = PP_CMD_NONE;
+    _exe_slot         = -1;
+    _stream_frame_len = 0;
+    _cum_seq          = 0;
+    _last_seq         = 0xFFFF;
+    _nak_sent         = 0;
+    _slot_valid       = 0;
+    _is_keepalive     = false;
+}
+
+
+/**
+ * @brief  从接收缓存的头部移除数据
+ * @note   其后的数据前移，与接收中断互斥
+ * @param[in]  data: 接收数据的缓存
+ * @param[in]  len: 指示缓存中数据长度的变量
+ * @param[in]  remove_len: 要移除的长度，单位 byte
+ * @retval None
+ */
+static void _Stream_Remove(uint8_t *data, uint16_t *len, uint16_t remove_len)
+{
+    __IRQ_SAFE
+    {
+        if (remove_len > *len)
+            remove_len = *len;
+        *len -= remove_len;
+        memmove(&data[0], &data[remove_len], *len);
+    }
+}
+
+
+/**
+ * @brief  重复 ACK 的定时器回调函数
+ * @note
+ * @param[in]  user_data: 用户数据
+ * @retval None
+ */
+static void _Timer_KeepaliveHandler(void *user_data)
+{
+    _is_keepalive = true;
+}
+
+#endif  /* #if (ENABLE_WINDOW_PROTOCOL) */
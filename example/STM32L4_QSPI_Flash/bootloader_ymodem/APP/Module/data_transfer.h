@@ -29,7 +29,12 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.0.1
+ * Change Logs:
+ * Date           Author       Notes
+ * 2022-11-23     Dino         the first version
+ * 2026-10-18                  1. 增加传输接口的操作表，可同时注册多个不同类型的接口
+ *                             2. 断帧检测的状态改为每个接口独立保存
  */
 
 #ifndef __DATA_TRANSFER_H__
@@ -46,18 +51,34 @@ typedef enum
     
 } DT_RECV_DATA_RESULT;
 
+struct DATA_TRANSFER;
+
+/* 传输接口的操作表，不同类型的接口（ UART 、 RS-485 、主机仿真的管道等）各自实现 */
+struct DT_OPS
+{
+    void    (*Init)     (struct DATA_TRANSFER *xfer);                               /* 初始化并开始接收 */
+    void    (*Send)     (struct DATA_TRANSFER *xfer, uint8_t *data, uint32_t len);  /* 发送数据 */
+    uint8_t (*Poll)     (struct DATA_TRANSFER *xfer);                               /* 返回 0 表示收到了一帧数据 */
+    void    (*Clear)    (struct DATA_TRANSFER *xfer);                               /* 清除接收缓存 */
+};
+
 struct DATA_TRANSFER
 {
-    uint8_t  if_id;
+    uint32_t if_id;
+    const struct DT_OPS *ops;
     
     uint8_t  *rx_buff;
     uint16_t *rx_len;
     uint32_t rx_buff_size;
+    
+    volatile bool    is_frame_timeout;          /* 断帧检测已超时 */
+    struct BSP_TIMER timer_frame_detect;        /* 断帧检测的 timer */
 };
 
 
 void DT_Init(struct DATA_TRANSFER *xfer, 
-             uint8_t  if_id, 
+             uint32_t if_id, 
+             const struct DT_OPS *ops, 
              uint8_t  *buff, 
              uint16_t *len, 
              uint32_t buff_size);
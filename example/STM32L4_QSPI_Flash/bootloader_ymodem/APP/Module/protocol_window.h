@@ -0,0 +1,84 @@
+/**
+ * \file            protocol_window.h
+ * \brief           sliding window protocol
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.0
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ */
+
+#ifndef __PROTOCOL_WINDOW_H__
+#define __PROTOCOL_WINDOW_H__
+
+#include "protocol_parser.h"
+
+/**
+ * 滑动窗口协议，与 YModem 共用协议析构层的回调函数（ PP_Init 的 Send 、 PrepareCallback 、 Set_ReplyInfo ），
+ * 业务层看到的指令仍是 PP_CMD_SOH （文件信息）、 PP_CMD_STX （固件数据）、 PP_CMD_EOT 和 PP_CMD_CAN 。
+ *
+ * 帧结构，多字节均为小端：
+ *    | SOF | type | seq (2) | len (2) | payload (len) | crc16 (2) |
+ *    crc16 为 CRC16/XMODEM ，从 type 计算至 payload 结束
+ *
+ * 流程：
+ *    1. 设备以 'C' 或 'G' 握手，主机发送 START （文件信息，与 YModem 的第 0 帧相同），设备回复 READY （窗口大小和最大数据长度）
+ *    2. 主机连续发送 DATA ，未被确认的数据帧最多为窗口大小，序号从 0 开始，按 16 bit 回绕
+ *    3. 设备按序号顺序交给业务层，每处理完一帧回复 ACK ，其 seq 为期望的下一帧（累积确认），
+ *       payload 为之后收到的乱序帧位图（选择确认）， bit n 对应 seq + 1 + n
+ *    4. 设备发现缺帧或帧校验错误时，对缺少的帧回复一次 NAK ，主机只重发该帧；主机超时未收到应答时重发最早未确认的帧
+ *    5. 业务层处理耗时较长（如擦除分区）时，设备每 PW_KEEPALIVE_TIME 重复回复 ACK ，主机据此推迟超时重发
+ *    6. 全部数据帧确认后主机发送 END ， seq 为数据帧总数，设备回复 FINISH
+ *    7. 任一方出错时发送 ABORT 结束会话
+ */
+
+#define PW_SOF                      0xA5
+
+#define PW_TYPE_START               0x01        /* 主机 -> 设备，文件信息 */
+#define PW_TYPE_DATA                0x02        /* 主机 -> 设备，固件数据 */
+#define PW_TYPE_END                 0x03        /* 主机 -> 设备，结束传输 */
+#define PW_TYPE_ACK                 0x06        /* 设备 -> 主机，累积确认和选择确认 */
+#define PW_TYPE_NAK                 0x15        /* 设备 -> 主机，请求重发一帧 */
+#define PW_TYPE_ABORT               0x18        /* 双向，取消传输 */
+#define PW_TYPE_READY               0x81        /* 设备 -> 主机， START 的应答 */
+#define PW_TYPE_FINISH              0x83        /* 设备 -> 主机， END 的应答 */
+
+#define PW_HEAD_LEN                 (6)
+#define PW_KEEPALIVE_TIME           (200)       /* 业务层处理期间重复 ACK 的周期，单位 ms */
+
+#if (ENABLE_WINDOW_PROTOCOL)
+void            PW_Init             (PP_Send_t               Send,
+                                     PP_PrepareCallback_t    PrepareCallback,
+                                     PP_ReplyCallback_t      Set_ResponseInfo);
+PP_CMD_ERR_CODE PW_StreamHandler    (uint8_t *data, uint16_t *len);
+void            PW_Config           (PP_CONFIG_PARA  para, void *value);
+bool            PW_IsActive         (void);
+#endif
+
+#endif
@@ -29,11 +29,14 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.1
+ * Version:         v1.0.3
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-23     Dino         the first version
  * 2022-12-08     Dino         增加固件包可放置在 SPI flash 的功能
+ * 2026-10-18                  增加片内 flash 编程能力的描述
+ * 2026-10-18                  增加 flash 异步擦写接口的描述
+ * 2026-10-18                  增加 flash 的 sector 布局和擦除计划
  */
 
 #ifndef __BSP_FLASH_H__
@@ -42,6 +45,66 @@
 #include "bsp_common.h"
 
 
+#define BSP_FLASH_MAX_REGION    6       /* 一个 flash 最多的 sector 布局段数，如双 bank 的 STM32F4 为 6 段 */
+#define BSP_FLASH_MAX_BLOCK     3       /* 一个 flash 最多的块擦除种类 */
+
+#define BSP_FLASH_ERASE_SECTOR  (-1)    /* 擦除计划的一步按 sector 擦除 */
+#define BSP_FLASH_ERASE_CHIP    (-2)    /* 擦除计划的一步为整片擦除 */
+
+
+/* 片内 flash 的编程方式 */
+typedef enum
+{
+    BSP_FLASH_PROGRAM_NORMAL = 0,       /* 只按最小写入单位编程，如 STM32F1 */
+    BSP_FLASH_PROGRAM_PARALLEL,         /* 按更宽的并行位数编程，如 STM32F4 外接 VPP 时的 x64 */
+    BSP_FLASH_PROGRAM_FAST_ROW,         /* 按行快速编程，如 STM32L4 、 GD32L23x 一次 32 个双字 */
+
+} BSP_FLASH_PROGRAM_MODE;
+
+/* 片内 flash 的编程能力，由 flash 的移植文件以 caps 接口提供 */
+struct BSP_FLASH_CAPS
+{
+    uint16_t min_unit;                  /* 最小写入单位，单位 byte */
+    uint16_t burst_unit;                /* 最优写入单位，地址对齐且足够长的数据按 mode 编程，单位 byte */
+    BSP_FLASH_PROGRAM_MODE mode;
+};
+
+/* flash 的异步擦写接口，由 flash 的移植文件提供。 offset 与移植文件 read/write/erase 的 offset 相同 */
+struct BSP_FLASH_ASYNC
+{
+    int (*erase_start)(long offset, size_t size);                       /* 启动 offset 所在 sector 或块的擦除，不超出 size 所在的 sector ，返回从 offset 到擦除结束的数据量， <= 0 为失败 */
+    int (*write_start)(long offset, const uint8_t *buf, size_t size);   /* 启动不超过 size 的一次编程，返回本次编程的数据量， <= 0 为失败 */
+    int (*busy)(void);                                                  /* 1: 上一次启动的擦写未完成 0: 已完成 < 0: 失败 */
+};
+
+
+/* 相同尺寸的一段连续 sector */
+struct BSP_FLASH_REGION
+{
+    uint32_t sector_size;               /* sector 尺寸，即最小擦除单位，单位 byte */
+    uint32_t sector_num;                /* sector 数量 */
+};
+
+/* flash 的 sector 布局和可用的擦除方式，由 flash 的移植文件以 geometry 接口提供。偏移地址从 flash 的起始地址算起 */
+struct BSP_FLASH_GEOMETRY
+{
+    uint32_t addr;                                      /* flash 的起始地址，用于换算按绝对地址访问的片内 flash 分区 */
+    uint8_t  region_num;
+    uint8_t  block_num;
+    bool     is_chip_erase;                             /* 是否可整片擦除。片内 flash 的整片擦除会擦掉 bootloader ，须为 false */
+    struct BSP_FLASH_REGION region[BSP_FLASH_MAX_REGION];   /* 从起始地址开始的各段 sector */
+    uint32_t block_size[BSP_FLASH_MAX_BLOCK];           /* 一次擦除多个 sector 的块擦除，从大到小，按自身尺寸对齐，如 SPI NOR 的 64K 、 32K */
+};
+
+/* 擦除计划的一步，由 BSP_Flash_PlanErase 给出 */
+struct BSP_FLASH_ERASE_STEP
+{
+    uint32_t offset;                    /* 擦除的起始偏移地址，已按擦除方式对齐 */
+    uint32_t size;                      /* 擦除的大小，单位 byte */
+    int8_t   block;                     /* 块擦除在 block_size 中的序号，或 BSP_FLASH_ERASE_SECTOR 、 BSP_FLASH_ERASE_CHIP */
+};
+
+
 struct BSP_FLASH
 {
     char name[MAX_NAME_LEN];
@@ -57,6 +120,12 @@ int                 BSP_Flash_Read      (const struct BSP_FLASH *part, uint32_t
 int                 BSP_Flash_Write     (const struct BSP_FLASH *part, uint32_t relative_addr, const uint8_t *buff, uint32_t size);
 int                 BSP_Flash_Erase     (const struct BSP_FLASH *part, uint32_t relative_addr, uint32_t size);
 struct BSP_FLASH *  BSP_Flash_GetHandle (const char *part_name);
+const struct BSP_FLASH_CAPS * BSP_Flash_GetCaps (void);
+const struct BSP_FLASH_ASYNC * BSP_Flash_GetAsync (const char *dev_name);
+const struct BSP_FLASH_GEOMETRY * BSP_Flash_GetGeometry (const char *dev_name);
+uint32_t            BSP_Flash_GetSize   (const struct BSP_FLASH_GEOMETRY *geometry);
+int                 BSP_Flash_GetSector (const struct BSP_FLASH_GEOMETRY *geometry, uint32_t offset, uint32_t *sector_offset, uint32_t *sector_size);
+int                 BSP_Flash_PlanErase (const struct BSP_FLASH_GEOMETRY *geometry, uint32_t offset, uint32_t end, struct BSP_FLASH_ERASE_STEP *step);
 
 #endif
 
@@ -101,6 +101,7 @@ typedef enum
     BSP_UART_ERR_NO_RECV_FRAME      = 0x08U,        /* 还未收到一帧完整的数据 */
     BSP_UART_ERR_NO_INIT            = 0x09U,        /* 使用的 UART 对象还未初始化 */
     BSP_UART_ERR_NAME_DUPLICATE     = 0x0AU,        /* UART 对象命名重复 */
+    BSP_UART_ERR_NOT_SUPPORT        = 0x0BU,        /* 时钟树无法产生所需的波特率 */
 
 } BSP_UART_ERR;
 
@@ -175,6 +176,9 @@ void            BSP_Printf                  (const char *fmt, ...);
 BSP_UART_ERR    BSP_UART_SetTxIndicate      (BSP_UART_ID  id, uint8_t (*TX_Complete)(struct UART_STRUCT *uart));
 BSP_UART_ERR    BSP_UART_ClearUserBuff      (BSP_UART_ID  id);
 BSP_UART_ERR    BSP_UART_IsFrameEnd         (BSP_UART_ID  id);
+uint32_t        BSP_UART_GetBaudRate        (BSP_UART_ID  id);
+BSP_UART_ERR    BSP_UART_CheckBaudRate      (BSP_UART_ID  id, uint32_t baudrate);
+BSP_UART_ERR    BSP_UART_SetBaudRate        (BSP_UART_ID  id, uint32_t baudrate);
 
 
 #endif
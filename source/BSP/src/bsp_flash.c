@@ -34,6 +34,9 @@
  * v1.0     2022-11-23     Dino         the first version
  * v1.1     2022-12-08     Dino         增加固件包可放置在 SPI flash 的功能
  * v1.2     2023-12-10     Dino         将 fal_onchip_flash.h 原型放在本文件声明
+ * v1.3     2026-10-18                  增加 BSP_Flash_GetCaps
+ * v1.4     2026-10-18                  增加 BSP_Flash_GetAsync
+ * v1.5     2026-10-18                  增加 flash 的 sector 布局和擦除计划
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -171,4 +174,179 @@ static void _Flash_Add(struct BSP_FLASH *part)
 #endif
 
 
+/* 片内 flash 的移植文件实现，与 FAL 片内 flash 设备共用 */
+extern const struct BSP_FLASH_CAPS *caps(void);
+extern const struct BSP_FLASH_ASYNC *async(void);
+extern const struct BSP_FLASH_GEOMETRY *geometry(void);
 
+#if (IS_ENABLE_SPI_FLASH && defined(FAL_USING_SFUD_PORT))
+/* SFUD 移植文件实现 */
+extern const struct BSP_FLASH_ASYNC spi_flash1_async;
+extern const struct BSP_FLASH_GEOMETRY *spi_flash1_geometry(void);
+#endif
+
+
+/**
+ * @brief  获取片内 flash 的编程能力
+ * @note   移植文件的 write 对按 burst_unit 对齐的数据以 mode 的方式编程，其余按 min_unit 编程
+ * @retval 片内 flash 的编程能力
+ */
+const struct BSP_FLASH_CAPS *BSP_Flash_GetCaps(void)
+{
+    return caps();
+}
+
+
+/**
+ * @brief  获取 flash 的异步擦写接口
+ * @note   移植文件不提供时返回 NULL ，此时 flash 只能按阻塞方式擦写
+ * @param[in]  dev_name: FAL 的 flash 设备名，未启用 SPI flash 时忽略
+ * @retval flash 的异步擦写接口
+ */
+const struct BSP_FLASH_ASYNC *BSP_Flash_GetAsync(const char *dev_name)
+{
+#if (IS_ENABLE_SPI_FLASH)
+    if (strcmp(dev_name, FAL_ONCHIP_FLASH_DEV_NAME) != 0)
+    {
+    #if defined(FAL_USING_SFUD_PORT)
+        if (strcmp(dev_name, FAL_SPI_FLASH_DEV_NAME) == 0)
+            return &spi_flash1_async;
+    #endif
+        return NULL;
+    }
+#else
+    (void)dev_name;
+#endif
+
+    return async();
+}
+
+
+/**
+ * @brief  获取 flash 的 sector 布局和可用的擦除方式
+ * @note   移植文件不提供时返回 NULL ，此时按 flash 均匀的擦除粒度处理
+ * @param[in]  dev_name: FAL 的 flash 设备名，未启用 SPI flash 时忽略
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *BSP_Flash_GetGeometry(const char *dev_name)
+{
+#if (IS_ENABLE_SPI_FLASH)
+    if (strcmp(dev_name, FAL_ONCHIP_FLASH_DEV_NAME) != 0)
+    {
+    #if defined(FAL_USING_SFUD_PORT)
+        if (strcmp(dev_name, FAL_SPI_FLASH_DEV_NAME) == 0)
+            return spi_flash1_geometry();
+    #endif
+        return NULL;
+    }
+#else
+    (void)dev_name;
+#endif
+
+    return geometry();
+}
+
+
+/**
+ * @brief  获取 flash 的容量
+ * @note   各段 sector 之和
+ * @param[in]  geometry: flash 的 sector 布局
+ * @retval flash 的容量，单位 byte
+ */
+uint32_t BSP_Flash_GetSize(const struct BSP_FLASH_GEOMETRY *geometry)
+{
+    uint32_t size = 0;
+
+    ASSERT(geometry != NULL);
+
+    for (uint8_t i = 0; i < geometry->region_num; i++)
+        size += geometry->region[i].sector_size * geometry->region[i].sector_num;
+
+    return size;
+}
+
+
+/**
+ * @brief  获取偏移地址所在的 sector
+ * @note   
+ * @param[in]   geometry: flash 的 sector 布局
+ * @param[in]   offset: 从 flash 起始地址算起的偏移地址
+ * @param[out]  sector_offset: sector 的起始偏移地址
+ * @param[out]  sector_size: sector 的尺寸，单位 byte
+ * @retval sector 的序号， -1: 超出 flash 容量
+ */
+int BSP_Flash_GetSector(const struct BSP_FLASH_GEOMETRY *geometry, uint32_t offset, uint32_t *sector_offset, uint32_t *sector_size)
+{
+    int index = 0;
+    uint32_t region_offset = 0;
+    const struct BSP_FLASH_REGION *region;
+
+    ASSERT(geometry != NULL);
+
+    for (uint8_t i = 0; i < geometry->region_num; i++)
+    {
+        region = &geometry->region[i];
+        if (offset < region_offset + region->sector_size * region->sector_num)
+        {
+            index         += (offset - region_offset) / region->sector_size;
+            *sector_size   = region->sector_size;
+            *sector_offset = region_offset + ((offset - region_offset) / region->sector_size) * region->sector_size;
+            return index;
+        }
+        index         += region->sector_num;
+        region_offset += region->sector_size * region->sector_num;
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief  计划擦除 [offset, end) 的下一步
+ * @note   1. 擦除的最小集合是与该范围相交的所有 sector ，每一步都不超出这个集合
+ *         2. 集合为整个 flash 且支持整片擦除时整片擦除，否则取起始地址对齐且能放入集合的最大块擦除，都不满足时擦除一个 sector
+ *         3. 循环调用，每次以 step->offset + step->size 作为下一步的 offset ，直至不小于 end
+ * @param[in]   geometry: flash 的 sector 布局
+ * @param[in]   offset: 擦除的起始偏移地址
+ * @param[in]   end: 擦除的结束偏移地址（不含）
+ * @param[out]  step: 下一步的擦除
+ * @retval 0: 成功。 -1: 范围为空或超出 flash 容量
+ */
+int BSP_Flash_PlanErase(const struct BSP_FLASH_GEOMETRY *geometry, uint32_t offset, uint32_t end, struct BSP_FLASH_ERASE_STEP *step)
+{
+    uint32_t begin, size;
+    uint32_t last, last_size;
+    uint32_t block;
+
+    if (end <= offset
+    ||  BSP_Flash_GetSector(geometry, offset, &begin, &size) < 0
+    ||  BSP_Flash_GetSector(geometry, end - 1, &last, &last_size) < 0)
+    {
+        return -1;
+    }
+
+    step->offset = begin;
+    step->size   = size;
+    step->block  = BSP_FLASH_ERASE_SECTOR;
+
+    end = last + last_size;
+    if (geometry->is_chip_erase && begin == 0 && end == BSP_Flash_GetSize(geometry))
+    {
+        step->size  = end;
+        step->block = BSP_FLASH_ERASE_CHIP;
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < geometry->block_num; i++)
+    {
+        block = geometry->block_size[i];
+        if (block > size && (begin % block) == 0 && end - begin >= block)
+        {
+            step->size  = block;
+            step->block = i;
+            break;
+        }
+    }
+
+    return 0;
+}
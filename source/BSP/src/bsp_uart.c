@@ -29,11 +29,12 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.1
+ * Version:         v1.0.2
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-23     Dino         the first version
  * 2022-12-04     Dino         优化中断开关
+ * 2026-10-18                  增加波特率的查询和切换接口
  */
 
 
@@ -53,6 +54,8 @@ extern BSP_UART_ERR         BSP_UART_Port_Send              (struct UART_STRUCT
 extern uint32_t             BSP_UART_Port_GetDmaCounter     (struct UART_STRUCT *uart);
 extern uint32_t             BSP_UART_Port_GetOneByte        (struct UART_STRUCT *uart);
 extern struct UART_STRUCT * BSP_UART_Port_GetHandle         (BSP_UART_ID  id);
+extern BSP_UART_ERR         BSP_UART_Port_CheckBaudRate     (struct UART_STRUCT *uart, uint32_t baudrate);
+extern BSP_UART_ERR         BSP_UART_Port_SetBaudRate       (struct UART_STRUCT *uart, uint32_t baudrate);
 
 /* 通讯锁 */
 //extern BSP_UART_ERR         BSP_UART_Port_LockInit          (struct UART_STRUCT *uart);
@@ -337,6 +340,75 @@ BSP_UART_ERR  BSP_UART_ClearUserBuff(BSP_UART_ID  id)
 }
 
 
+/**
+ * @brief  获取 UART 当前的波特率
+ * @note   
+ * @param[in]  id: 串口 ID
+ * @retval 波特率， 0: 无效的 ID
+ */
+uint32_t  BSP_UART_GetBaudRate(BSP_UART_ID  id)
+{
+    struct UART_STRUCT *uart = BSP_UART_Port_GetHandle(id);
+    
+    if (uart == NULL) {
+        return 0;
+    }
+    
+    return uart->handle.Init.BaudRate;
+}
+
+
+/**
+ * @brief  查询 UART 是否支持指定的波特率
+ * @note   由移植文件根据 UART 外设的时钟和分频规则判断，不会改变当前的波特率
+ * @param[in]  id: 串口 ID
+ * @param[in]  baudrate: 波特率
+ * @retval BSP_UART_ERR_OK: 支持。 BSP_UART_ERR_NOT_SUPPORT: 误差过大或超出分频范围
+ */
+BSP_UART_ERR  BSP_UART_CheckBaudRate(BSP_UART_ID  id, uint32_t baudrate)
+{
+    struct UART_STRUCT *uart = BSP_UART_Port_GetHandle(id);
+    
+    if (uart == NULL) {
+        return BSP_UART_ERR_NOT_FOUND;
+    }
+
+    if (baudrate == 0) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+    
+    return BSP_UART_Port_CheckBaudRate(uart, baudrate);
+}
+
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   1. 会等待正在发送的数据发送完毕后再切换，接收不会中断
+ *         2. 不能在中断中使用
+ * @param[in]  id: 串口 ID
+ * @param[in]  baudrate: 波特率
+ * @retval BSP_UART_ERR 
+ */
+BSP_UART_ERR  BSP_UART_SetBaudRate(BSP_UART_ID  id, uint32_t baudrate)
+{
+    struct UART_STRUCT *uart = BSP_UART_Port_GetHandle(id);
+    
+    if (uart == NULL) {
+        return BSP_UART_ERR_NOT_FOUND;
+    }
+
+    if (uart->is_init == false) {
+        return BSP_UART_ERR_NO_INIT;
+    }
+
+    if (BSP_UART_Port_CheckBaudRate(uart, baudrate) != BSP_UART_ERR_OK) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+    
+    return BSP_UART_Port_SetBaudRate(uart, baudrate);
+}
+
+
 /* Private functions ---------------------------------------------------------*/
 /**
  * @brief  将 DMA 缓存池的 UART 数据搬运到用户数据池中
@@ -34,6 +34,7 @@
  * v1.0     2022-11-23     Dino         the first version
  * v1.1     2022-12-04     Dino         增加 __HAL_UART_FLUSH_DRREGISTER
  * v1.2     2023-12-15     Dino         优化 UART
+ * v1.3     2026-10-18                  增加波特率的查询和切换，按 UART 外设的时钟和 BRR 分频规则判断
  */
 
 
@@ -41,6 +42,11 @@
 #include "bsp_uart.h"
 
 
+/* Private define ------------------------------------------------------------*/
+#define UART_BAUD_MAX_ERROR             20          /* 允许的波特率误差，单位 ‰ ，收发双方合计误差需小于约 4.5% */
+#define UART_BAUD_SWITCH_TIMEOUT        100         /* 切换波特率前等待发送完毕的超时时间，单位 ms */
+
+
 /* Private variables ---------------------------------------------------------*/
 #if (BSP_USING_UART2_RE)
 static volatile BSP_UART_ID _uart2_alter;
@@ -132,6 +138,8 @@ static uint32_t _UART_GetMask                   (uint32_t word_length, uint32_t
 static void     _UART_IntHandler                (struct UART_STRUCT *uart);
 static void     _UART_Alternate                 (struct UART_STRUCT *uart);
 static void     _UART_AlternateEnableDMAReceive (struct UART_STRUCT *uart);
+static uint32_t _UART_GetClock                  (struct UART_STRUCT *uart);
+static uint32_t _UART_CalcBRR                   (struct UART_STRUCT *uart, uint32_t baudrate, uint32_t *actual);
 
 
 /* Exported functions ---------------------------------------------------------*/
@@ -585,6 +593,68 @@ struct UART_STRUCT *BSP_UART_Port_GetHandle(BSP_UART_ID id)
 }
 
 
+/**
+ * @brief  查询 UART 是否支持指定的波特率
+ * @note   按 UART 外设的时钟计算 BRR ，分频值超出范围或实际波特率误差超过 UART_BAUD_MAX_ERROR 时不支持
+ * @param[in]  uart: UART 对象
+ * @param[in]  baudrate: 波特率
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_CheckBaudRate(struct UART_STRUCT *uart, uint32_t baudrate)
+{
+    uint32_t actual;
+
+    if (baudrate == 0 || _UART_CalcBRR(uart, baudrate, &actual) == 0) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+
+    uint32_t diff = (actual > baudrate) ? (actual - baudrate) : (baudrate - actual);
+    if ((uint64_t)diff * 1000 > (uint64_t)baudrate * UART_BAUD_MAX_ERROR) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+    
+    return BSP_UART_ERR_OK;
+}
+
+
+/**
+ * @brief  切换 UART 的波特率
+ * @note   1. 等待正在发送的数据（包括 DMA 和中断方式）发送完毕后，关闭 UART 改写 BRR 再重新开启，
+ *            DMA 接收和中断配置均保持不变
+ *         2. 依赖 HAL_GetTick 计算超时，不能在中断中使用
+ * @param[in]  uart: UART 对象
+ * @param[in]  baudrate: 波特率，需先经 BSP_UART_Port_CheckBaudRate 确认
+ * @retval BSP_UART_ERR
+ */
+BSP_UART_ERR  BSP_UART_Port_SetBaudRate(struct UART_STRUCT *uart, uint32_t baudrate)
+{
+    uint32_t actual;
+    uint32_t brr = _UART_CalcBRR(uart, baudrate, &actual);
+    uint32_t tick_start = HAL_GetTick();
+
+    if (brr == 0) {
+        return BSP_UART_ERR_NOT_SUPPORT;
+    }
+
+    while (uart->handle.gState != HAL_UART_STATE_READY
+    ||     __HAL_UART_GET_FLAG(&uart->handle, UART_FLAG_TC) == RESET)
+    {
+        if ((HAL_GetTick() - tick_start) > UART_BAUD_SWITCH_TIMEOUT) {
+            return BSP_UART_ERR_TIMEOUT;
+        }
+    }
+
+    __HAL_UART_DISABLE(&uart->handle);
+    uart->handle.Instance->BRR    = brr;
+    uart->handle.Init.BaudRate    = baudrate;
+    __HAL_UART_ENABLE(&uart->handle);
+    
+    BSP_Printf("[ %s ] id: %d, baudrate: %d (%d)\r\n", __func__, uart->id, baudrate, actual);
+    
+    return BSP_UART_ERR_OK;
+}
+
+
 /* Private functions ---------------------------------------------------------*/
 /**
  * @brief  UART 中断的集中处理
@@ -782,6 +852,64 @@ static uint32_t _UART_GetMask(uint32_t word_length, uint32_t parity)
 }
 
 
+/**
+ * @brief  获取 UART 外设的时钟频率
+ * @note   USART1 和 USART6 挂在 APB2 上，其余挂在 APB1 上。对于可选择 UART 时钟源的系列，按默认的 PCLK 计算
+ * @param[in]  uart: UART 对象
+ * @retval 时钟频率，单位 Hz
+ */
+static uint32_t _UART_GetClock(struct UART_STRUCT *uart)
+{
+#if defined(SOC_SERIES_STM32F0) || defined(SOC_SERIES_STM32G0)
+    return HAL_RCC_GetPCLK1Freq();
+#else
+#if defined(USART6)
+    if (uart->handle.Instance == USART1 || uart->handle.Instance == USART6)
+#else
+    if (uart->handle.Instance == USART1)
+#endif
+        return HAL_RCC_GetPCLK2Freq();
+
+    return HAL_RCC_GetPCLK1Freq();
+#endif
+}
+
+
+/**
+ * @brief  计算指定波特率的 BRR 寄存器值
+ * @note   16 倍过采样时 BRR = USARTDIV ， 8 倍过采样时 BRR[2:0] = USARTDIV[3:0] >> 1
+ * @param[in]  uart: UART 对象
+ * @param[in]  baudrate: 波特率
+ * @param[out] actual: 该 BRR 实际产生的波特率
+ * @retval BRR 寄存器值， 0: 超出分频范围
+ */
+static uint32_t _UART_CalcBRR(struct UART_STRUCT *uart, uint32_t baudrate, uint32_t *actual)
+{
+    uint32_t clock = _UART_GetClock(uart);
+    uint32_t div;
+
+#if defined(USART_CR1_OVER8)
+    if (READ_BIT(uart->handle.Instance->CR1, USART_CR1_OVER8))
+    {
+        /* BRR 只保留了 USARTDIV 的高 3 位小数 */
+        div = (uint32_t)(((uint64_t)clock * 2 + baudrate / 2) / baudrate) & ~1U;
+        if (div < 16 || div > 0xFFFF) {
+            return 0;
+        }
+        *actual = (uint32_t)((uint64_t)clock * 2 / div);
+        return (div & 0xFFF0U) | ((div & 0x000FU) >> 1);
+    }
+#endif
+
+    div = (clock + baudrate / 2) / baudrate;
+    if (div < 16 || div > 0xFFFF) {
+        return 0;
+    }
+    *actual = clock / div;
+    return div;
+}
+
+
 /* Callback functions ---------------------------------------------------------*/
 /* 以下 4 个函数均是 HAL 库 UART 相关的中断函数的回调函数 */
 /* UART DMA 接收半满中断 */
@@ -32,6 +32,8 @@
  * Change Logs:
  * Version  Date           Author       Notes
  * v1.0     2023-01-08     wade任       the first version
+ * v1.1     2026-10-18                  增加 caps 接口，按行对齐的数据以快速编程写入
+ * v1.2     2026-10-18                  增加 async 接口
  */
  
 /* Includes ------------------------------------------------------------------*/
@@ -79,8 +81,56 @@ int read(long offset, uint8_t *buf, size_t size)
 
 
 /**
- * @brief  
- * @note   
+ * @brief  获取 flash 的编程能力
+ * @note   按字编程，快速编程一次写入一行（ 32 个双字），所在的页须为擦除状态
+ * @retval flash 的编程能力
+ */
+const struct BSP_FLASH_CAPS *caps(void)
+{
+    static const struct BSP_FLASH_CAPS flash_caps = 
+    {
+        .min_unit   = sizeof(uint32_t),
+        .burst_unit = DOUBLE_WORDS_CNT_IN_ROW * sizeof(uint64_t),
+        .mode       = BSP_FLASH_PROGRAM_FAST_ROW,
+    };
+
+    return &flash_caps;
+}
+
+
+/**
+ * @brief  获取 flash 的异步擦写接口
+ * @note   GD32L23x 只有一个 bank ，擦写期间 CPU 从 flash 取指会停顿，按阻塞方式擦写。
+ *         若 bootloader 在 RAM 中运行或固件分区位于另一个 bank ，可由 flash 就绪中断或忙标志实现
+ * @retval NULL: 不支持异步擦写
+ */
+const struct BSP_FLASH_ASYNC *async(void)
+{
+    return NULL;
+}
+
+
+/**
+ * @brief  获取 flash 的 sector 布局
+ * @note   GD32L23x 按 FMC_PAGE_SIZE 的页擦除，没有块擦除。整片擦除会擦掉 bootloader ，不使用
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *geometry(void)
+{
+    static const struct BSP_FLASH_GEOMETRY flash_geometry = 
+    {
+        .addr       = FLASH_BASE,
+        .region_num = 1,
+        .region     = { {FMC_PAGE_SIZE, ONCHIP_FLASH_SIZE / FMC_PAGE_SIZE} },
+    };
+
+    return &flash_geometry;
+}
+
+
+/**
+ * @brief  向 flash 写入数据
+ * @note   按行对齐且剩余数据足够一行时快速编程，其余按字写入
  * @param[in]  offset: 偏移地址 
  * @param[in]  buf: 数据池
  * @param[in]  size: 数据长度，单位 byte
@@ -95,6 +145,8 @@ int write(long offset, const uint8_t *buf, size_t size)
     uint8_t byte_num = sizeof(uint32_t);
     uint32_t write_data = 0;
     uint32_t temp_data = 0;
+    static uint64_t row_buff[DOUBLE_WORDS_CNT_IN_ROW];
+    const struct BSP_FLASH_CAPS *flash_caps = caps();
 
 #if (IS_ENABLE_SPI_FLASH)
     uint32_t addr = gd32_onchip_flash.addr + offset;
@@ -118,6 +170,25 @@ int write(long offset, const uint8_t *buf, size_t size)
     FAL_PRINTF("write addr: 0x%.8x\r\n", addr);
     for (byte_step = 0; byte_step < size; )
     {
+        /* Cortex-M23 不支持非对齐访问，整行数据先复制到对齐的缓存再快速编程 */
+        if ((addr % flash_caps->burst_unit) == 0 && (size - byte_step) >= flash_caps->burst_unit)
+        {
+            memcpy(row_buff, buf, flash_caps->burst_unit);
+
+            ret = fmc_fast_program(addr, row_buff);
+            if (ret != FMC_READY || memcmp((const void *)addr, row_buff, flash_caps->burst_unit) != 0)
+            {
+                FAL_PRINTF("[D] %s: %d (%d)\r\n", __func__, ret, __LINE__);
+                status = -1;
+                goto __exit;
+            }
+
+            buf       += flash_caps->burst_unit;
+            byte_step += flash_caps->burst_unit;
+            addr      += flash_caps->burst_unit;
+            continue;
+        }
+
         if ((size - byte_step) < byte_num)         /* The number of bytes less than a WORD/half WORD */
         {
             for (index = 0; (size - byte_step) > 0; index++)
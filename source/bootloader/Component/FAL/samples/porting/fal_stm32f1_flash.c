@@ -29,7 +29,7 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.1.0
  */
  
 /* Includes ------------------------------------------------------------------*/
@@ -224,6 +224,54 @@ int read(long offset, uint8_t *buf, size_t size)
 }
 
 
+/**
+ * @brief  获取 flash 的编程能力
+ * @note   STM32F1 只能按半字编程，无快速编程方式，按字写入即两次半字编程
+ * @retval flash 的编程能力
+ */
+const struct BSP_FLASH_CAPS *caps(void)
+{
+    static const struct BSP_FLASH_CAPS flash_caps = 
+    {
+        .min_unit   = sizeof(uint32_t),
+        .burst_unit = sizeof(uint32_t),
+        .mode       = BSP_FLASH_PROGRAM_NORMAL,
+    };
+
+    return &flash_caps;
+}
+
+
+/**
+ * @brief  获取 flash 的异步擦写接口
+ * @note   STM32F1 只有一个 bank ，擦写期间 CPU 从 flash 取指会停顿，按阻塞方式擦写。
+ *         若 bootloader 在 RAM 中运行或固件分区位于另一个 bank ，可由 flash 就绪中断或忙标志实现
+ * @retval NULL: 不支持异步擦写
+ */
+const struct BSP_FLASH_ASYNC *async(void)
+{
+    return NULL;
+}
+
+
+/**
+ * @brief  获取 flash 的 sector 布局
+ * @note   STM32F1 按 FLASH_PAGE_SIZE 的页擦除，没有块擦除。整片擦除会擦掉 bootloader ，不使用
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *geometry(void)
+{
+    static const struct BSP_FLASH_GEOMETRY flash_geometry = 
+    {
+        .addr       = FLASH_BASE,
+        .region_num = 1,
+        .region     = { {FLASH_PAGE_SIZE, ONCHIP_FLASH_SIZE / FLASH_PAGE_SIZE} },
+    };
+
+    return &flash_geometry;
+}
+
+
 /**
  * @brief  
  * @note   
@@ -29,7 +29,7 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.1.0
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -39,6 +39,9 @@
 /* 是否使能了选项字的 DB1M bit */
 #define ENABLE_DB1M_BIT         0
 
+/* 是否以 x64 并行位数编程，需在 VPP 引脚外接 8 ~ 9 V 电源，双字对齐的数据按双字编程 */
+#define ENABLE_PROGRAM_X64      0
+
 /* Base address of the Flash sectors Bank 1 */
 #define ADDR_FLASH_SECTOR_0     ((uint32_t)0x08000000) /* Base @ of Sector 0, 16 Kbytes */
 #define ADDR_FLASH_SECTOR_1     ((uint32_t)0x08004000) /* Base @ of Sector 1, 16 Kbytes */
@@ -67,6 +70,14 @@
 #define ADDR_FLASH_SECTOR_22     ((uint32_t)0x081C0000) /* Base @ of Sector 10, 128 Kbytes */
 #define ADDR_FLASH_SECTOR_23     ((uint32_t)0x081E0000) /* Base @ of Sector 11, 128 Kbytes */
 
+/* 每个 bank 的容量和其中 128 Kbytes sector 的数量， 2 Mbytes 或使能 DB1M 的 1 Mbytes 为双 bank */
+#if (ONCHIP_FLASH_SIZE > 1024 * 1024 || ENABLE_DB1M_BIT)
+#define FLASH_BANK_BYTE         (ONCHIP_FLASH_SIZE / 2)
+#else
+#define FLASH_BANK_BYTE         (ONCHIP_FLASH_SIZE)
+#endif
+#define SECTOR_128K_NUM         ((FLASH_BANK_BYTE - 128 * 1024) / (128 * 1024))
+
 
 /* Extern function prototypes ------------------------------------------------*/
 extern void Firmware_OperateCallback(uint16_t progress);
@@ -115,8 +126,69 @@ int read(long offset, uint8_t *buf, size_t size)
 
 
 /**
- * @brief  
- * @note   
+ * @brief  获取 flash 的编程能力
+ * @note   按字编程， ENABLE_PROGRAM_X64 使能时双字对齐的数据以 x64 并行位数编程
+ * @retval flash 的编程能力
+ */
+const struct BSP_FLASH_CAPS *caps(void)
+{
+    static const struct BSP_FLASH_CAPS flash_caps = 
+    {
+        .min_unit   = sizeof(uint32_t),
+#if (ENABLE_PROGRAM_X64)
+        .burst_unit = sizeof(uint64_t),
+        .mode       = BSP_FLASH_PROGRAM_PARALLEL,
+#else
+        .burst_unit = sizeof(uint32_t),
+        .mode       = BSP_FLASH_PROGRAM_NORMAL,
+#endif
+    };
+
+    return &flash_caps;
+}
+
+
+/**
+ * @brief  获取 flash 的异步擦写接口
+ * @note   bootloader 与固件分区位于同一 bank ，擦写期间 CPU 从 flash 取指会停顿，按阻塞方式擦写。
+ *         若 bootloader 在 RAM 中运行或固件分区位于另一个 bank ，可由 flash 就绪中断或忙标志实现
+ * @retval NULL: 不支持异步擦写
+ */
+const struct BSP_FLASH_ASYNC *async(void)
+{
+    return NULL;
+}
+
+
+/**
+ * @brief  获取 flash 的 sector 布局
+ * @note   1. 每个 bank 依次为 4 个 16 Kbytes 、 1 个 64 Kbytes 和若干个 128 Kbytes 的 sector ，没有块擦除。
+ *            整片擦除会擦掉 bootloader ，不使用
+ *         2. 2 Mbytes 或使能 DB1M 的 1 Mbytes 为双 bank ，第二个 bank 重复第一个 bank 的布局
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *geometry(void)
+{
+    static const struct BSP_FLASH_GEOMETRY flash_geometry = 
+    {
+        .addr       = FLASH_BASE,
+#if (FLASH_BANK_BYTE < ONCHIP_FLASH_SIZE)
+        .region_num = 6,
+        .region     = { {16 * 1024, 4}, {64 * 1024, 1}, {128 * 1024, SECTOR_128K_NUM},
+                        {16 * 1024, 4}, {64 * 1024, 1}, {128 * 1024, SECTOR_128K_NUM} },
+#else
+        .region_num = 3,
+        .region     = { {16 * 1024, 4}, {64 * 1024, 1}, {128 * 1024, SECTOR_128K_NUM} },
+#endif
+    };
+
+    return &flash_geometry;
+}
+
+
+/**
+ * @brief  向 flash 写入数据
+ * @note   按字写入， ENABLE_PROGRAM_X64 使能时双字对齐的数据按双字写入，不足一个编程单元的部分以 0xFF 补齐
  * @param[in]  offset: 偏移地址 
  * @param[in]  buf: 数据池
  * @param[in]  size: 数据长度，单位 byte
@@ -142,28 +214,44 @@ int write(long offset, const uint8_t *buf, size_t size)
         return -1;
 
 #if 1
-    size_t   data_len = size * sizeof(uint32_t);
-    uint32_t *data = (uint32_t *)buf;
+    size_t   byte_step = 0;
+    uint8_t  byte_num = 0;
+    uint32_t type_program = 0;
+    uint64_t write_data = 0;
+    const struct BSP_FLASH_CAPS *flash_caps = caps();
     
     HAL_FLASH_Unlock();
 
-    for (uint32_t i = 0; 
-         (i < data_len) && (addr <= (end_addr - sizeof(uint32_t))); 
-         i++)
+    for (byte_step = 0; byte_step < size; byte_step += byte_num, addr += byte_num)
     {
         /* Device voltage range supposed to be [2.7V to 3.6V], the operation will
-           be done by word */
-        if (HAL_FLASH_Program(TYPEPROGRAM_WORD, addr, *(uint32_t *)(data + i)) == HAL_OK)
+           be done by word, or by double word if VPP is supplied */
+        if (flash_caps->mode == BSP_FLASH_PROGRAM_PARALLEL
+        &&  (addr % flash_caps->burst_unit) == 0
+        &&  (size - byte_step) >= flash_caps->burst_unit)
+        {
+            byte_num     = flash_caps->burst_unit;
+            type_program = FLASH_TYPEPROGRAM_DOUBLEWORD;
+        }
+        else
+        {
+            byte_num     = flash_caps->min_unit;
+            type_program = FLASH_TYPEPROGRAM_WORD;
+        }
+
+        /* 不足一个编程单元的部分以 0xFF 补齐 */
+        write_data = 0xFFFFFFFFFFFFFFFF;
+        memcpy(&write_data, &buf[byte_step], (size - byte_step) < byte_num ? (size - byte_step) : byte_num);
+
+        if (HAL_FLASH_Program(type_program, addr, write_data) == HAL_OK)
         {
             /* Check the written value */
-            if (*(uint32_t *)addr != *(uint32_t *)(data + i))
+            if (memcmp((const void *)addr, &write_data, byte_num) != 0)
             {
                 /* Flash content doesn't match SRAM content */
                 status = -1;
                 break;
             }
-            /* Increment FLASH destination address */
-            addr += sizeof(uint32_t);
         }
         else
         {
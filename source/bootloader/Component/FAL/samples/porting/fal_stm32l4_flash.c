@@ -29,7 +29,7 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.1.0
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -75,9 +75,57 @@ int read(long offset, uint8_t *buf, size_t size)
 }
 
 
+/**
+ * @brief  获取 flash 的编程能力
+ * @note   按双字编程，快速编程一次写入一行，所在的页须为擦除状态
+ * @retval flash 的编程能力
+ */
+const struct BSP_FLASH_CAPS *caps(void)
+{
+    static const struct BSP_FLASH_CAPS flash_caps = 
+    {
+        .min_unit   = sizeof(uint64_t),
+        .burst_unit = 32 * sizeof(uint64_t),
+        .mode       = BSP_FLASH_PROGRAM_FAST_ROW,
+    };
+
+    return &flash_caps;
+}
+
+
+/**
+ * @brief  获取 flash 的异步擦写接口
+ * @note   bootloader 与固件分区位于同一 bank ，擦写期间 CPU 从 flash 取指会停顿，按阻塞方式擦写。
+ *         若 bootloader 在 RAM 中运行或固件分区位于另一个 bank ，可由 flash 就绪中断或忙标志实现
+ * @retval NULL: 不支持异步擦写
+ */
+const struct BSP_FLASH_ASYNC *async(void)
+{
+    return NULL;
+}
+
+
+/**
+ * @brief  获取 flash 的 sector 布局
+ * @note   STM32L4 按 FLASH_PAGE_SIZE 的页擦除，没有块擦除。整片擦除会擦掉 bootloader ，不使用
+ * @retval flash 的 sector 布局
+ */
+const struct BSP_FLASH_GEOMETRY *geometry(void)
+{
+    static const struct BSP_FLASH_GEOMETRY flash_geometry = 
+    {
+        .addr       = FLASH_BASE,
+        .region_num = 1,
+        .region     = { {FLASH_PAGE_SIZE, ONCHIP_FLASH_SIZE / FLASH_PAGE_SIZE} },
+    };
+
+    return &flash_geometry;
+}
+
+
 /**
  * @brief  向 flash 写入数据
- * @note   传入的 buff 至少是 flash 最小写入 byte 的整数倍，否则会发生数组溢出
+ * @note   按行（ 32 个双字）对齐的数据以快速编程写入，其余按双字写入，不足一个双字的部分以 0xFF 补齐
  * @param[in]  offset: 偏移地址 
  * @param[in]  buf: 数据池
  * @param[in]  size: 数据长度，单位 byte
@@ -108,35 +156,46 @@ int write(long offset, const uint8_t *buf, size_t size)
     __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_PGSERR);
     
 #if 1
-    uint8_t  is_mod = size % sizeof(uint32_t);
-    size_t   data_len = size / sizeof(uint32_t);
-    uint32_t *data = (uint32_t *)buf;
-    
-    if (is_mod)
-        data_len += 2;
+    size_t   byte_step = 0;
+    uint16_t byte_num = 0;
+    uint32_t type_program = 0;
+    uint64_t write_data = 0;
+    const uint8_t *src = NULL;
+    const struct BSP_FLASH_CAPS *flash_caps = caps();
     
     FAL_PRINTF("write addr: 0x%.8X , size: %d\r\n", addr, size);
     
-    for (uint32_t i = 0; 
-         (i < data_len / 2) && (addr <= (end_addr - 8)); 
-         i++)
+    for (byte_step = 0; byte_step < size; byte_step += byte_num, addr += byte_num)
     {
+        /* 按行对齐且剩余数据足够一行时快速编程，每行结束后清除 FSTPG 以便之后按双字编程 */
+        if ((addr % flash_caps->burst_unit) == 0 && (size - byte_step) >= flash_caps->burst_unit)
+        {
+            byte_num     = flash_caps->burst_unit;
+            type_program = FLASH_TYPEPROGRAM_FAST_AND_LAST;
+            src          = &buf[byte_step];
+            write_data   = (uint32_t)src;
+        }
+        /* 其余按双字编程，不足一个双字的部分以 0xFF 补齐 */
+        else
+        {
+            byte_num     = sizeof(uint64_t);
+            type_program = FLASH_TYPEPROGRAM_DOUBLEWORD;
+            src          = (const uint8_t *)&write_data;
+            write_data   = 0xFFFFFFFFFFFFFFFF;
+            memcpy(&write_data, &buf[byte_step], (size - byte_step) < byte_num ? (size - byte_step) : byte_num);
+        }
         
-        /* Device voltage range supposed to be [2.7V to 3.6V], the operation will
-           be done by word */ 
-        ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, *((uint64_t *)(data + 2*i)));
+        ret = HAL_FLASH_Program(type_program, addr, write_data);
         if (ret == HAL_OK)      
         {
             /* Check the written value */
-            if (*(uint64_t *)addr != *(uint64_t *)(data + 2*i))
+            if (memcmp((const void *)addr, src, byte_num) != 0)
             {
                 /* Flash content doesn't match SRAM content */
                 FAL_PRINTF("ERROR: write data != read data\r\n");
                 status = -1;
                 break;
             }
-            /* Increment FLASH addr address */
-            addr += 8;
         }
         else
         {
@@ -0,0 +1,289 @@
+/**
+ * \file            protocol_frame.c
+ * \brief           incremental YModem frame parser
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.0
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "protocol_frame.h"
+
+#if (ENABLE_FRAME_PARSER)
+
+/* Private variables ---------------------------------------------------------*/
+#if (ENABLE_BAUD_NEGOTIATION)
+static const uint8_t            _probe_frame[YMODEM_PROBE_LEN] = YMODEM_PROBE_FRAME;
+#endif
+
+
+/* Private function prototypes -----------------------------------------------*/
+static bool                 _Frame_Start            (struct PF_PARSER *pf, const uint8_t *data, uint16_t len);
+static bool                 _Frame_Update           (struct PF_PARSER *pf, const uint8_t *data, uint16_t end);
+static bool                 _Frame_Verify           (struct PF_PARSER *pf, const uint8_t *data);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  初始化帧解析器
+ * @note   
+ * @param[in]  pf: 帧解析器
+ * @param[in]  accept: 可识别的帧， PF_ACCEPT_* 的组合，之后可直接修改 pf->accept
+ * @retval None
+ */
+void PF_Init(struct PF_PARSER *pf, uint8_t accept)
+{
+    pf->accept = accept;
+    PF_Reset(pf);
+}
+
+
+/**
+ * @brief  丢弃正在解析的帧
+ * @note   接收缓存被清空时调用，不影响 accept 和 is_crc_ok
+ * @param[in]  pf: 帧解析器
+ * @retval None
+ */
+void PF_Reset(struct PF_PARSER *pf)
+{
+    pf->header    = 0;
+    pf->pos       = 0;
+    pf->frame_len = 0;
+    pf->crc_start = 0;
+    pf->crc_end   = 0;
+    pf->crc       = 0;
+}
+
+
+/**
+ * @brief  解析接收缓存头部的帧
+ * @note   1. 只处理上次调用之后新增的数据，数据帧的校验值随接收逐段计算，最后一个校验字节到达时即可判断帧的正误
+ *         2. 校验错误的帧仍作为 PF_RESULT_FRAME 返回，由协议析构层按协议应答 NAK 或取消传输
+ *         3. 返回 PF_RESULT_FRAME 或 PF_RESULT_GARBAGE 后，解析器已复位，使用者移除 out_len 个字节后再继续调用
+ * @param[in]  pf: 帧解析器
+ * @param[in]  data: 接收缓存的头部
+ * @param[in]  len: 接收缓存中的数据长度
+ * @param[out] out_len: 帧或需要丢弃的数据的长度
+ * @retval PF_RESULT
+ */
+PF_RESULT PF_Parse(struct PF_PARSER *pf, const uint8_t *data, uint16_t len, uint16_t *out_len)
+{
+    uint16_t end;
+
+    if (len == 0)
+        return PF_RESULT_NONE;
+
+    if (pf->frame_len == 0)
+    {
+        if (_Frame_Start(pf, data, len) == false)
+            goto __garbage;
+
+        /* 波特率请求的帧长由 num 决定，等待下一个字节 */
+        if (pf->frame_len == 0)
+            return PF_RESULT_NONE;
+    }
+
+    end = (len < pf->frame_len) ? len : pf->frame_len;
+    if (end > pf->pos)
+    {
+        if (_Frame_Update(pf, data, end) == false)
+            goto __garbage;
+        pf->pos = end;
+    }
+
+    if (pf->pos < pf->frame_len)
+        return PF_RESULT_NONE;
+
+    pf->is_crc_ok = _Frame_Verify(pf, data);
+    *out_len = pf->frame_len;
+    PF_Reset(pf);
+    return PF_RESULT_FRAME;
+
+__garbage:
+    PF_Reset(pf);
+    *out_len = 1;
+    return PF_RESULT_GARBAGE;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  按帧头确定帧长和校验范围
+ * @note   波特率请求还未收到 num 时， pf->frame_len 保持为 0
+ * @param[in]  pf: 帧解析器
+ * @param[in]  data: 接收缓存的头部
+ * @param[in]  len: 接收缓存中的数据长度
+ * @retval true: 是帧头 | false: 不是帧头
+ */
+static bool _Frame_Start(struct PF_PARSER *pf, const uint8_t *data, uint16_t len)
+{
+    uint16_t data_len;
+
+    switch (data[0])
+    {
+        case YMODEM_SOH: data_len = YMODEM_SOH_DATA_LEN;    break;
+        case YMODEM_STX: data_len = YMODEM_STX_DATA_LEN;    break;
+    #if (ENABLE_YMODEM_EXT_FRAME)
+        case YMODEM_STX_EXT:
+        {
+            if ((pf->accept & PF_ACCEPT_EXT) == 0)
+                return false;
+
+            pf->header    = YMODEM_STX_EXT;
+            pf->frame_len = YMODEM_EXT_FRAME_LEN;
+            pf->crc_start = 3;
+            pf->crc_end   = 3 + YMODEM_EXT_DATA_LEN;
+            pf->crc       = CRC32_INIT_VALUE;
+            return true;
+        }
+    #endif
+    #if (ENABLE_BAUD_NEGOTIATION)
+        case YMODEM_BAUD:
+        {
+            if ((pf->accept & PF_ACCEPT_BAUD) == 0)
+                return false;
+
+            if (len < 2)
+                return true;
+
+            if (data[1] == 0 || data[1] > YMODEM_BAUD_MAX_NUM)
+                return false;
+
+            pf->header    = YMODEM_BAUD;
+            pf->frame_len = YMODEM_BAUD_REQ_LEN(data[1]);
+            pf->crc_start = 1;
+            pf->crc_end   = 2 + 4 * data[1];
+            return true;
+        }
+        case YMODEM_PROBE:
+        {
+            if ((pf->accept & PF_ACCEPT_PROBE) == 0)
+                return false;
+
+            pf->header    = YMODEM_PROBE;
+            pf->frame_len = YMODEM_PROBE_LEN;
+            return true;
+        }
+    #endif
+        case YMODEM_EOT:
+        case YMODEM_CAN:
+        {
+            if ((pf->accept & PF_ACCEPT_YMODEM) == 0)
+                return false;
+
+            /* 连续的 CAN 视为一帧 */
+            pf->header    = data[0];
+            pf->frame_len = 1;
+            while (data[0] == YMODEM_CAN && pf->frame_len < len && data[pf->frame_len] == YMODEM_CAN)
+                pf->frame_len++;
+            return true;
+        }
+        default: return false;
+    }
+
+    if ((pf->accept & PF_ACCEPT_YMODEM) == 0)
+        return false;
+
+    pf->header    = data[0];
+    pf->frame_len = YMODEM_FRAME_FIXED_LEN + data_len;
+    pf->crc_start = 3;
+    pf->crc_end   = 3 + data_len;
+    return true;
+}
+
+
+/**
+ * @brief  解析新增的数据
+ * @note   数据帧收到正反序列号时检查是否相符，探测帧逐字节比对，校验范围内的数据累加至校验值
+ * @param[in]  pf: 帧解析器
+ * @param[in]  data: 接收缓存的头部
+ * @param[in]  end: 本次解析的结束位置，不超过帧长
+ * @retval true: 正常 | false: 不是帧，应丢弃帧头
+ */
+static bool _Frame_Update(struct PF_PARSER *pf, const uint8_t *data, uint16_t end)
+{
+    uint16_t start;
+
+#if (ENABLE_BAUD_NEGOTIATION)
+    if (pf->header == YMODEM_PROBE)
+        return (memcmp(&data[pf->pos], &_probe_frame[pf->pos], end - pf->pos) == 0);
+#endif
+
+    /* 数据帧的帧头可能是乱码中的一个字节，以正反序列号尽早排除 */
+    if (pf->crc_start == 3 && pf->pos < 3 && end >= 3)
+    {
+        if (data[2] != (uint8_t)~data[1])
+            return false;
+    }
+
+    start = (pf->pos > pf->crc_start) ? pf->pos : pf->crc_start;
+    if (end > pf->crc_end)
+        end = pf->crc_end;
+    if (end <= start)
+        return true;
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+    if (pf->header == YMODEM_STX_EXT)
+    {
+        pf->crc = CRC32_StepCalc(pf->crc, &data[start], end - start);
+        return true;
+    }
+#endif
+    pf->crc = CRC16_XModemStep((uint16_t)pf->crc, &data[start], end - start);
+    return true;
+}
+
+
+/**
+ * @brief  比对帧尾的校验值
+ * @note   EOT 、 CAN 和探测帧没有校验值
+ * @param[in]  pf: 帧解析器
+ * @param[in]  data: 接收缓存的头部，帧已完整
+ * @retval true: 正确 | false: 错误
+ */
+static bool _Frame_Verify(struct PF_PARSER *pf, const uint8_t *data)
+{
+    const uint8_t *raw = &data[pf->crc_end];
+
+    if (pf->crc_end == 0)
+        return true;
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+    if (pf->header == YMODEM_STX_EXT)
+    {
+        uint32_t raw_crc = ((uint32_t)raw[0] << 24) | ((uint32_t)raw[1] << 16) | ((uint32_t)raw[2] << 8) | raw[3];
+        return ((pf->crc ^ 0xFFFFFFFF) == raw_crc);
+    }
+#endif
+    return ((uint16_t)pf->crc == ((raw[0] << 8) | raw[1]));
+}
+
+#endif  /* #if (ENABLE_FRAME_PARSER) */
@@ -47,6 +47,16 @@
  * v1.6     2023-12-10     Dino         1. 改名为 bootloader
  *                                      2. 可移植部分代码分至 bootloader_port.c
  *                                      3. 删除 _fw_update_info.status
+ * v1.7     2026-10-18                  1. 增加执行流程切换的回调 Bootloader_ExeFlowCallback
+ *                                      2. 增加各执行流程和固件操作的耗时统计（ ENABLE_PERF_STATS ）
+ * v1.8     2026-10-18                  1. 增加固件写入的后台队列（ ENABLE_WRITE_BEHIND ），固件分包暂存后即应答主机
+ * v1.9     2026-10-18                  1. 增加固件解压的耗时统计项
+ * v1.10    2026-10-18                  1. 增加差分固件包还原的耗时统计项
+ * v1.11    2026-10-18                  1. 增加断点续传（ ENABLE_RESUME_TRANSFER ），主机请求时按进度记录跳过擦除和已写入的数据
+ * v1.12    2026-10-18                  1. 增加 APP 分区的增量写入（ ENABLE_INCREMENTAL_UPDATE ），只擦除和写入有差异的块
+ * v1.13    2026-10-18                  1. 增加接收时的逐块擦除（ ENABLE_ERASE_AHEAD ），擦除与接收固件包并行进行
+ *                                      2. 增加 Bootloader_PrepareFirmware ，收到文件信息时按文件大小预先擦除 download 分区
+ * v1.14    2026-10-18                  1. 增加 flash 的异步擦写（ ENABLE_ASYNC_FLASH ），擦写未完成时各流程下次循环再次执行
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -77,6 +87,40 @@ static const char *_part_name;                          /* 记录当前操作的
 static uint8_t *_firmware_data;
 static uint32_t _firmware_data_len;
 static struct FIRMWARE_UPDATE_INFO  _fw_update_info;    /* 固件更新的信息记录 */
+#if (ENABLE_WRITE_BEHIND)
+static uint8_t      _wb_block[WRITE_BEHIND_BLOCK_NUM][FPK_LEAST_HANDLE_BYTE];   /* 后台写入队列的块 */
+static uint16_t     _wb_len[WRITE_BEHIND_BLOCK_NUM];    /* 各块已暂存的数据量，单位 byte */
+static uint8_t      _wb_fill;                           /* 正在暂存固件分包的块 */
+static uint8_t      _wb_count;                          /* 已暂存完毕、等待写入 flash 的块数 */
+static bool         _wb_is_flush;                       /* 已收到 EOT ，队列全部写入后再应答 */
+static FM_ERR_CODE  _wb_err;                            /* 后台写入的错误代码，在下一次应答时取消传输 */
+#endif
+#if (ENABLE_RESUME_TRANSFER)
+static uint32_t     _resume_offset;                     /* 断点续传的位置，即已写入的包体数据量，单位 byte */
+#endif
+#if (ENABLE_ERASE_AHEAD && USING_PART_PROJECT > ONE_PART_PROJECT)
+static uint32_t     _prepare_size;                      /* 主机预告的固件包大小，由 _EraseAhead_Process 预先擦除 download 分区 */
+#endif
+#if (ENABLE_PERF_STATS)
+struct PERF_STATS perf_stats;                           /* 耗时统计 */
+
+const char *const perf_func_name[PERF_FUNC_NUM] =      /* 统计项的名称 */
+{
+    [PERF_FM_IS_EMPTY]             = "FM_IsEmpty",
+    [PERF_FM_ERASE_FIRMWARE]       = "FM_EraseFirmware",
+    [PERF_FM_WRITE_SUB_PKG]        = "FM_WriteSubPackage",
+    [PERF_FM_VERIFY_FIRMWARE]      = "FM_VerifyFirmware",
+    [PERF_FM_UPDATE_TO_APP]        = "FM_UpdateToAPP",
+    [PERF_FM_ERASE_APP_BY_COMPARE] = "FM_EraseAPPByCompare",
+    [PERF_FM_ERASE_AHEAD]          = "FM_EraseAhead",
+    [PERF_FLASH_WRITE]             = "FlashWrite",
+    [PERF_AES_DECRYPT]             = "AES_Decrypt",
+    [PERF_DECOMPRESS]              = "Decompress",
+    [PERF_DELTA_PATCH]             = "DeltaPatch",
+    [PERF_CRC32]                   = "CRC32",
+    [PERF_FLASH_ASYNC_WAIT]        = "FlashAsyncWait",
+};
+#endif
 
 
 /* Extern function prototypes ------------------------------------------------*/
@@ -95,12 +139,23 @@ static uint8_t      _Firmware_Check             (void);
 static void         _Firmware_CheckAndHandle    (void);
 static FM_ERR_CODE  _Firmware_AutoUpdate        (const char *part_name);
 #endif
+#if (ENABLE_WRITE_BEHIND)
+static bool         _WriteBehind_Push           (uint8_t *data, uint16_t len);
+static void         _WriteBehind_Commit         (void);
+static void         _WriteBehind_Process        (void);
+static void         _WriteBehind_Reset          (void);
+#endif
+#if (ENABLE_ERASE_AHEAD)
+static void         _EraseAhead_Process         (void);
+#endif
 #if (USING_IS_NEED_UPDATE_PROJECT == USING_APP_SET_FLAG_UPDATE) \
 ||  defined(USING_CUSTOM_UPDATE_FLAG)
 /* WEAK 函数 */
 uint64_t            Bootloader_GetUpdateFlag    (void);
 void                Bootloader_SetUpdateFlag    (uint64_t flag);
 #endif
+/* WEAK 函数 */
+void                Bootloader_ExeFlowCallback  (BOOT_EXE_FLOW old_flow, BOOT_EXE_FLOW new_flow);
 
 
 /* Constructor ---------------------------------------------------------------*/
@@ -154,6 +209,12 @@ void Bootloader_Init(void)
     BSP_Printf("perf_counter version: V%d.%d.%d\r\n", __PERF_COUNTER_VER_MAJOR__, __PERF_COUNTER_VER_MINOR__, __PERF_COUNTER_VER_REVISE__);
 #endif
 
+#if (ENABLE_PERF_STATS)
+    /* SysTick 已被 HAL 库使用 */
+    init_cycle_counter(true);
+    perf_stats.flow_start = get_system_ticks();
+#endif
+
     FM_Init();
     Bootloader_Port_Init();
 }
@@ -169,6 +230,16 @@ void Bootloader_Loop(void)
     /* 主机数据处理函数 */
     Bootloader_Port_HostDataProcess();
 
+#if (ENABLE_ASYNC_FLASH)
+    /* 推进排队的 flash 擦写 */
+    FA_Process();
+#endif
+
+#if (ENABLE_WRITE_BEHIND)
+    /* 将队列中暂存完毕的块写入 flash */
+    _WriteBehind_Process();
+#endif
+
     /* 应用执行流程状态机 */
     switch (_fw_update_info.exe_flow)
     {
@@ -191,7 +262,12 @@ void Bootloader_Loop(void)
         case EXE_FLOW_JUMP_TO_APP:
         {
             if (FM_CheckFirmwareIntegrity(APP_ADDRESS) == FM_ERR_OK)
+            {
+            #if (ENABLE_PERF_STATS)
+                Bootloader_PrintPerfStats();
+            #endif
                 _JumpToAPP();
+            }
             else
                 _SetExeFlow(EXE_FLOW_NEED_HOST_SEND_FIRMWARE);
             break;
@@ -203,6 +279,16 @@ void Bootloader_Loop(void)
             struct FPK_HEAD *p_fpk_head = (struct FPK_HEAD *)_firmware_data;
             
             _fw_update_info.cmd_exe_err_code = PP_ERR_OK;
+        #if (ENABLE_WRITE_BEHIND)
+            _WriteBehind_Reset();
+        #endif
+        #if (ENABLE_RESUME_TRANSFER)
+            _resume_offset = 0;
+        #endif
+        #if (ENABLE_ERASE_AHEAD && USING_PART_PROJECT > ONE_PART_PROJECT)
+            /* 已收到固件包头，按固件包头擦除 */
+            _prepare_size = 0;
+        #endif
 
         #if (USING_PART_PROJECT > ONE_PART_PROJECT)
             /* 取出固件包头中的分区名 */
@@ -299,13 +385,37 @@ void Bootloader_Loop(void)
         /* 单分区: 擦除 APP 固件。多分区: 将需要放入固件的分区擦除 */
         case EXE_FLOW_ERASE_OLD_FIRMWARE:
         {
+        #if (USING_PART_PROJECT > ONE_PART_PROJECT)
+            _part_name = FM_GetPartName();
+
+            #if (IS_ENABLE_RESUME_TRANSFER)
+            /* 主机请求断点续传，且分区的进度记录与本固件包一致时，从记录的位置继续接收，不再擦除分区和写入固件包头 */
+            if (PP_IsResumeMode()
+            &&  FM_ResumeFirmware(_part_name, &_resume_offset) == FM_ERR_OK)
+            {
+                _SetExeFlow(EXE_FLOW_WRITE_FIRMWARE_HEAD_DONE);
+                _fw_update_info.cmd_exe_result = PP_RESULT_OK;
+                break;
+            }
+            #endif
+        #endif
+
+        #if (ENABLE_ERASE_AHEAD)
+            /* 不在此处擦除，接收固件包时写入前擦除写入位置所在的块，其余的块在等待主机数据时擦除 */
+            #if (USING_PART_PROJECT == ONE_PART_PROJECT)
+            _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_EraseFirmwareAhead(APP_PART_NAME, 0);
+            #else
+            _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_EraseFirmwareAhead(_part_name, 0);
+            #endif
+        #elif (USING_PART_PROJECT == ONE_PART_PROJECT)
             /* 判断分区是否为空 */
-        #if (USING_PART_PROJECT == ONE_PART_PROJECT)
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_IsEmpty(APP_PART_NAME);
         #else
-            _part_name = FM_GetPartName();
+            /* 判断分区是否为空 */
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_IsEmpty(_part_name);
         #endif
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
             #if (USING_PART_PROJECT == ONE_PART_PROJECT)
@@ -329,6 +439,8 @@ void Bootloader_Loop(void)
         #else
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_EraseFirmware(_part_name);
         #endif
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
             #if (USING_PART_PROJECT == ONE_PART_PROJECT)
@@ -353,6 +465,8 @@ void Bootloader_Loop(void)
                                                                     _part_name, 
                                                                     _firmware_data, 
                                                                     FPK_HEAD_SIZE);
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
                 _SetExeFlow(EXE_FLOW_WRITE_FIRMWARE_HEAD_DONE);
@@ -376,6 +490,24 @@ void Bootloader_Loop(void)
         /* 将固件分包写入分区中 */
         case EXE_FLOW_WRITE_NEW_FIRMWARE:
         {
+        #if (ENABLE_WRITE_BEHIND)
+            /* 之前暂存的块写入失败，取消传输 */
+            if (_wb_err != FM_ERR_OK)
+            {
+                _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)_wb_err;
+                _SetExeFlow(EXE_FLOW_FAILED);
+                _fw_update_info.cmd_exe_result = PP_RESULT_CANCEL;
+                break;
+            }
+
+            /* 队列已满时不应答，等待最早的块写入 flash 后再暂存 */
+            if (_WriteBehind_Push(_firmware_data, _firmware_data_len))
+            {
+                _SetExeFlow(EXE_FLOW_WRITE_NEW_FIRMWARE_DONE);
+                _fw_update_info.cmd_exe_result = PP_RESULT_OK;
+            }
+            break;
+        #else
         #if (USING_PART_PROJECT == ONE_PART_PROJECT)
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_WriteFirmwareSubPackage(
                                                                     APP_PART_NAME, 
@@ -387,6 +519,8 @@ void Bootloader_Loop(void)
                                                                     _firmware_data, 
                                                                     _firmware_data_len);
         #endif
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
                 _SetExeFlow(EXE_FLOW_WRITE_NEW_FIRMWARE_DONE);
@@ -398,6 +532,7 @@ void Bootloader_Loop(void)
                 _fw_update_info.cmd_exe_result = PP_RESULT_CANCEL;
             }
             break;
+        #endif  /* #if (ENABLE_WRITE_BEHIND) */
         }
         /* 固件已接收完毕。此时将分区首地址的 4 个字节写入 */
         case EXE_FLOW_UPDATE_FIRMWARE:
@@ -449,6 +584,8 @@ void Bootloader_Loop(void)
             /* 校验固件 */
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_VerifyFirmware(_part_name, FM_GetPackageCRC32(), false);
         #endif
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
             #if (USING_PART_PROJECT == ONE_PART_PROJECT)
@@ -490,8 +627,14 @@ void Bootloader_Loop(void)
         case EXE_FLOW_ERASE_APP:
         {
             _fw_update_info.step = STEP_ERASE_APP;
+        #if (IS_ENABLE_INCREMENTAL_UPDATE)
+            /* 与 APP 分区的现有数据逐块比较，只擦除有差异的块，之后的 FM_UpdateToAPP 只写入这些块 */
+            _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_EraseAPPByCompare(_part_name);
+        #else
             /* 判断 APP 分区是否为空 */
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_IsEmpty(APP_PART_NAME);
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
                 _fw_update_info.total_progress = 40;
@@ -507,6 +650,9 @@ void Bootloader_Loop(void)
             
             /* 为空时才擦除分区 */
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_EraseFirmware(APP_PART_NAME);
+        #endif
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
                 _fw_update_info.total_progress = 40;
@@ -526,6 +672,8 @@ void Bootloader_Loop(void)
             _fw_update_info.step = STEP_UPDATE_TO_APP;
             
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_UpdateToAPP(_part_name);   
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
                 _fw_update_info.total_progress = 60;
@@ -545,6 +693,8 @@ void Bootloader_Loop(void)
             _fw_update_info.step = STEP_VERIFY_APP;
             /* 因此时 APP 分区的首地址数据仍未写入，因此需要让 FM_VerifyFirmware 自动填充以进行校验 */
             _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), true);
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code != FM_ERR_OK)
             {
                 _SetExeFlow(EXE_FLOW_FAILED);
@@ -557,6 +707,8 @@ void Bootloader_Loop(void)
             {
                 /* 判断 download 分区是否为空 */
                 _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_IsEmpty(DOWNLOAD_PART_NAME);
+                if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                    break;   /* flash 的擦写尚未完成，再次执行本流程 */
                 if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
                 {
                     _fw_update_info.total_progress = 80;
@@ -572,6 +724,8 @@ void Bootloader_Loop(void)
                 
                 /* 为空时才擦除分区 */
                 _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_EraseFirmware(DOWNLOAD_PART_NAME);
+                if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                    break;   /* flash 的擦写尚未完成，再次执行本流程 */
                 if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
                 {
                     _fw_update_info.total_progress = 80;
@@ -634,6 +788,8 @@ void Bootloader_Loop(void)
             #endif
             }
                 
+            if (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY)
+                break;   /* flash 的擦写尚未完成，再次执行本流程 */
             if (_fw_update_info.cmd_exe_err_code == FM_ERR_OK)
             {
                 _fw_update_info.total_progress = 100;
@@ -652,7 +808,12 @@ void Bootloader_Loop(void)
         case EXE_FLOW_JUMP_TO_APP:
         {
             if (FM_CheckFirmwareIntegrity(APP_ADDRESS) == FM_ERR_OK)
+            {
+            #if (ENABLE_PERF_STATS)
+                Bootloader_PrintPerfStats();
+            #endif
                 _JumpToAPP();
+            }
             else
                 _SetExeFlow(EXE_FLOW_NEED_HOST_SEND_FIRMWARE);
             break;
@@ -705,6 +866,13 @@ void Bootloader_Loop(void)
         case EXE_FLOW_FAILED:
         {
             Bootloader_Port_Reset();
+        #if (ENABLE_WRITE_BEHIND)
+            _WriteBehind_Reset();
+        #endif
+        #if (ENABLE_ASYNC_FLASH)
+            /* 等待执行中的一步完成，丢弃其余排队的擦写 */
+            FA_Reset();
+        #endif
             _fw_update_info.is_recovery = false;
             _fw_update_info.step        = STEP_VERIFY_FIRMWARE;
             _SetExeFlow(EXE_FLOW_NOTHING);
@@ -712,6 +880,11 @@ void Bootloader_Loop(void)
         }
         default: break;
     }
+
+#if (ENABLE_ERASE_AHEAD)
+    /* 等待主机数据时逐块擦除分区 */
+    _EraseAhead_Process();
+#endif
 }
 
 
@@ -757,6 +930,9 @@ void Bootloader_SetCommStatus(COMM_STATUS status, uint8_t *data, uint16_t data_l
         }
         case COMM_STATUS_CANCEL:
         {
+        #if (ENABLE_WRITE_BEHIND)
+            _WriteBehind_Reset();
+        #endif
             _fw_update_info.cmd_exe_result = PP_RESULT_OK;
             _SetExeFlow(EXE_FLOW_FIND_RUNNING_FIRMWARE);
             break;
@@ -768,8 +944,32 @@ void Bootloader_SetCommStatus(COMM_STATUS status, uint8_t *data, uint16_t data_l
             BSP_Printf("%s: timeout!!!\r\n", __func__);
             break;
         }
-        case COMM_STATUS_FILE_INFO:
+    #if (ENABLE_WRITE_BEHIND)
+        /* 队列中的块全部写入 flash 后才应答 EOT ，写入失败时可在应答中取消传输 */
         case COMM_STATUS_START_UPDATE:
+        {
+            _wb_is_flush = true;
+            break;
+        }
+    #else
+        case COMM_STATUS_START_UPDATE:
+    #endif
+    #if (ENABLE_ERASE_AHEAD && USING_PART_PROJECT > ONE_PART_PROJECT)
+        /* data 为 "文件名\0文件大小" ，按文件大小预先擦除 download 分区。断点续传时保留分区的数据 */
+        case COMM_STATUS_FILE_INFO:
+        {
+        #if (IS_ENABLE_RESUME_TRANSFER)
+            if (data && PP_IsResumeMode() == false)
+        #else
+            if (data)
+        #endif
+                Bootloader_PrepareFirmware(atol((char *)&data[strlen((char *)data) + 1]));
+            _fw_update_info.cmd_exe_result = PP_RESULT_OK;
+            break;
+        }
+    #else
+        case COMM_STATUS_FILE_INFO:
+    #endif
         case COMM_STATUS_UNKNOWN:
         {
             _fw_update_info.cmd_exe_result = PP_RESULT_OK;
@@ -826,6 +1026,21 @@ void Bootloader_SetUpdateFlag(uint64_t flag)
 }
 #endif
 
+/**
+ * @brief  执行流程切换时的回调
+ * @note   1. 流程发生变化时调用，可用于统计各流程的耗时，由使用者按需重新实现
+ *         2. 可能在 main 之前被调用（ _SystemStart ）
+ * @param[in]  old_flow: 切换前的流程
+ * @param[in]  new_flow: 切换后的流程
+ * @retval None
+ */
+__WEAK
+void Bootloader_ExeFlowCallback(BOOT_EXE_FLOW old_flow, BOOT_EXE_FLOW new_flow)
+{
+    (void)old_flow;
+    (void)new_flow;
+}
+
 /**
  * @brief  获取与主机数据传输的执行结果
  * @note   
@@ -846,6 +1061,40 @@ PP_CMD_ERR_CODE Bootloader_GetExeErrCode(void)
     return _fw_update_info.cmd_exe_err_code;
 }
 
+#if (ENABLE_RESUME_TRANSFER)
+/**
+ * @brief  获取断点续传的位置
+ * @note   固件包头处理完毕后有效，没有续传时为 0
+ * @retval 已写入的包体数据量，单位 byte
+ */
+uint32_t Bootloader_GetResumeOffset(void)
+{
+    return _resume_offset;
+}
+#endif
+
+#if (ENABLE_ERASE_AHEAD && USING_PART_PROJECT > ONE_PART_PROJECT)
+/**
+ * @brief  预告即将下发的固件包大小
+ * @note   1. 收到固件包头之前预先擦除 download 分区，如 APP 跳转至 bootloader 前已知固件包的大小时调用
+ *         2. 只记录大小，在等待固件包的流程中由 Bootloader_Loop 擦除
+ * @param[in]  size: 固件包的大小，单位 byte
+ * @retval true: 成功 | false: 正在更新固件，不能预先擦除
+ */
+bool Bootloader_PrepareFirmware(uint32_t size)
+{
+    if (_fw_update_info.exe_flow == EXE_FLOW_NOTHING
+    ||  _fw_update_info.exe_flow == EXE_FLOW_NEED_HOST_SEND_FIRMWARE
+    ||  _fw_update_info.exe_flow == EXE_FLOW_FIND_RUNNING_FIRMWARE
+    ||  _fw_update_info.exe_flow == EXE_FLOW_WAIT_FIRMWARE)
+    {
+        _prepare_size = size;
+        return true;
+    }
+    return false;
+}
+#endif
+
 /**
  * @brief  固件写入时的回调函数
  * @note   
@@ -863,6 +1112,62 @@ void Firmware_OperateCallback(uint16_t progress)
 }
 
 
+#if (ENABLE_ASYNC_FLASH)
+/**
+ * @brief  等待 flash 擦写队列时的回调函数
+ * @note   队列已满或读取的数据尚未写入时由 flash_async.c 反复调用
+ * @retval None
+ */
+void Flash_AsyncWaitCallback(void)
+{
+    /* 处理主机的数据，防止阻塞 */
+    Bootloader_Port_HostDataProcess();
+}
+#endif
+
+
+#if (ENABLE_PERF_STATS)
+/**
+ * @brief  获取耗时统计
+ * @note   可整块回传给主机，时间单位为 perf_counter 的 tick
+ * @retval 耗时统计块
+ */
+const struct PERF_STATS * Bootloader_GetPerfStats(void)
+{
+    return &perf_stats;
+}
+
+
+/**
+ * @brief  打印耗时统计
+ * @note   经 BSP_Printf 输出至调试串口或 RTT ，跳转至 APP 前会自动调用一次
+ * @retval None
+ */
+void Bootloader_PrintPerfStats(void)
+{
+    BSP_Printf("[ perf stats ] count / total us / max us\r\n");
+
+    for (uint8_t i = 0; i < PERF_FLOW_MAX; i++)
+    {
+        const struct PERF_ITEM *item = &perf_stats.flow[i];
+
+        if (item->count)
+            BSP_Printf("flow %2d: %u / %u / %u\r\n", i, item->count,
+                       (uint32_t)perfc_convert_ticks_to_us(item->total), (uint32_t)perfc_convert_ticks_to_us(item->max));
+    }
+
+    for (uint8_t i = 0; i < PERF_FUNC_NUM; i++)
+    {
+        const struct PERF_ITEM *item = &perf_stats.func[i];
+
+        if (item->count)
+            BSP_Printf("%s: %u / %u / %u\r\n", perf_func_name[i], item->count,
+                       (uint32_t)perfc_convert_ticks_to_us(item->total), (uint32_t)perfc_convert_ticks_to_us(item->max));
+    }
+}
+#endif
+
+
 /* Private functions ---------------------------------------------------------*/
 #if (USING_PART_PROJECT > ONE_PART_PROJECT)
 /**
@@ -875,6 +1180,8 @@ static FM_ERR_CODE  _Firmware_AutoUpdate(const char *part_name)
 {
     static uint8_t value = 0;
     FM_ERR_CODE  result = FM_ERR_OK;
+
+    /* 启用 ENABLE_ASYNC_FLASH 时 flash 的擦写排队执行，以下各步骤返回 FM_ERR_BUSY 时再次调用直至完成 */
     
     /* 禁止接收主机的指令 */
     PP_Config(PP_CONFIG_ENABLE_RECV_CMD, &value);
@@ -888,23 +1195,45 @@ static FM_ERR_CODE  _Firmware_AutoUpdate(const char *part_name)
     }
     
     /* 校验固件正确性 */
-    result = FM_VerifyFirmware(part_name, FM_GetPackageCRC32(), false);
+    do
+    {
+        result = FM_VerifyFirmware(part_name, FM_GetPackageCRC32(), false);
+    } while (result == FM_ERR_BUSY);
     if (result != FM_ERR_OK)
     {
         BSP_Printf("%s: err: %d\r\n", __func__, __LINE__);
         return result;
     }
     
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    /* 只擦除与新固件有差异的块 */
+    result = FM_EraseAPPByCompare(part_name);
+    if (result != FM_ERR_OK)
+    {
+        BSP_Printf("%s: err: %d\r\n", __func__, __LINE__);
+        return result;
+    }
+#else
     /* 检测 APP 分区是否为空，不为空时擦除分区 */
-    result = FM_IsEmpty(APP_PART_NAME);
+    do
+    {
+        result = FM_IsEmpty(APP_PART_NAME);
+    } while (result == FM_ERR_BUSY);
     if (result != FM_ERR_OK)
     {
         BSP_Printf("%s: app is not empty\r\n", __func__);
-        result = FM_EraseFirmware(APP_PART_NAME);
+        do
+        {
+            result = FM_EraseFirmware(APP_PART_NAME);
+        } while (result == FM_ERR_BUSY);
     }
+#endif
     
     /* 将固件更新至 APP 分区 */
-    result = FM_UpdateToAPP(part_name);
+    do
+    {
+        result = FM_UpdateToAPP(part_name);
+    } while (result == FM_ERR_BUSY);
     if (result != FM_ERR_OK)
     {
         BSP_Printf("%s: err: %d\r\n", __func__, __LINE__);
@@ -912,7 +1241,10 @@ static FM_ERR_CODE  _Firmware_AutoUpdate(const char *part_name)
     }
     
     /* 校验 APP 分区的固件 */
-    result = FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), true);
+    do
+    {
+        result = FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), true);
+    } while (result == FM_ERR_BUSY);
     if (result != FM_ERR_OK)
     {
         BSP_Printf("%s: err: %d\r\n", __func__, __LINE__);
@@ -930,7 +1262,10 @@ static FM_ERR_CODE  _Firmware_AutoUpdate(const char *part_name)
     
 #if (USING_AUTO_UPDATE_PROJECT == ERASE_DOWNLOAD_PART_PROJECT)
     /* 擦除 download 分区的方案，需直接擦除 */
-    result = FM_EraseFirmware(part_name);
+    do
+    {
+        result = FM_EraseFirmware(part_name);
+    } while (result == FM_ERR_BUSY);
 #endif
     
     if (result != FM_ERR_OK)
@@ -1022,7 +1357,10 @@ __check_app:
         #endif
             
             /* 校验 APP 固件 */
-            _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), false);
+            do
+            {
+                _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), false);
+            } while (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY);
         #if (USING_APP_SAFETY_CHECK_PROJECT == AUTO_UPDATE_APP || \
              USING_APP_SAFETY_CHECK_PROJECT == CHECK_UNLESS_EMPTY)
             /* 启用 APP 固件检查的自动更新方案，则跳转至检查 download 分区固件 */
@@ -1067,7 +1405,10 @@ __check_app:
             #endif
                 
                 /* 校验 APP 固件 */
-                _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), false);
+                do
+                {
+                    _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)FM_VerifyFirmware(APP_PART_NAME, FM_GetRawCRC32(), false);
+                } while (_fw_update_info.cmd_exe_err_code == FM_ERR_BUSY);
 
             #if (USING_APP_SAFETY_CHECK_PROJECT == AUTO_UPDATE_APP || \
                  USING_APP_SAFETY_CHECK_PROJECT == CHECK_UNLESS_EMPTY)
@@ -1221,6 +1562,11 @@ static uint8_t _Firmware_Check(void)
  */
 static void _JumpToAPP(void)
 {
+#if (ENABLE_ASYNC_FLASH)
+    /* 跳转或复位前，排队的擦写须全部完成 */
+    FA_Sync(NULL);
+#endif
+
 #if (USING_IS_NEED_UPDATE_PROJECT == USING_APP_SET_FLAG_UPDATE) \
 ||  defined(USING_CUSTOM_UPDATE_FLAG)
     /* 第二次进入，跳转至 APP */
@@ -1254,8 +1600,191 @@ static void _JumpToAPP(void)
  */
 static void _SetExeFlow(BOOT_EXE_FLOW flow)
 {
+    BOOT_EXE_FLOW old_flow = _fw_update_info.exe_flow;
+
     _fw_update_info.exe_flow = flow;
+
+    if (old_flow != flow)
+    {
+    #if (ENABLE_PERF_STATS)
+        /* 累计离开的流程的耗时 */
+        int64_t now = get_system_ticks();
+
+        if (old_flow < PERF_FLOW_MAX)
+            Perf_Stats_Add(&perf_stats.flow[old_flow], now - perf_stats.flow_start);
+        perf_stats.flow_start = now;
+    #endif
+        Bootloader_ExeFlowCallback(old_flow, flow);
+    }
+}
+
+
+#if (ENABLE_WRITE_BEHIND)
+/**
+ * @brief  将固件分包暂存至后台写入队列
+ * @note   多个固件分包合并为一块，块满时交给 _WriteBehind_Process 写入 flash
+ * @param[in]  data: 固件分包
+ * @param[in]  len: 固件分包大小，单位 byte
+ * @retval true: 已暂存 | false: 队列已满，需稍后重试
+ */
+static bool _WriteBehind_Push(uint8_t *data, uint16_t len)
+{
+    if (_wb_count >= WRITE_BEHIND_BLOCK_NUM)
+        return false;
+
+    /* 当前块剩余的空间不足，提前结束该块 */
+    if (_wb_len[_wb_fill] + len > FPK_LEAST_HANDLE_BYTE)
+    {
+        _WriteBehind_Commit();
+        if (_wb_count >= WRITE_BEHIND_BLOCK_NUM)
+            return false;
+    }
+
+    memcpy(&_wb_block[_wb_fill][_wb_len[_wb_fill]], data, len);
+    _wb_len[_wb_fill] += len;
+
+    if (_wb_len[_wb_fill] == FPK_LEAST_HANDLE_BYTE)
+        _WriteBehind_Commit();
+
+    return true;
+}
+
+
+/**
+ * @brief  结束正在暂存的块，使其进入等待写入的状态
+ * @note   
+ * @retval None
+ */
+static void _WriteBehind_Commit(void)
+{
+    _wb_count++;
+    _wb_fill = (_wb_fill + 1) % WRITE_BEHIND_BLOCK_NUM;
+}
+
+
+/**
+ * @brief  后台写入队列的处理
+ * @note   1. 每次调用最多写入一个块，写入期间 Firmware_OperateCallback 仍会处理主机数据
+ *         2. 写入失败时停止写入并记录错误，由下一个数据帧或 EOT 的应答取消传输
+ *         3. 收到 EOT 后，将未满的块也写入 flash ，队列清空后再应答
+ * @retval None
+ */
+static void _WriteBehind_Process(void)
+{
+    if (_wb_count && _wb_err == FM_ERR_OK)
+    {
+        uint8_t     index = (_wb_fill + WRITE_BEHIND_BLOCK_NUM - _wb_count) % WRITE_BEHIND_BLOCK_NUM;
+        FM_ERR_CODE err;
+
+    #if (USING_PART_PROJECT == ONE_PART_PROJECT)
+        err = FM_WriteFirmwareSubPackage(APP_PART_NAME, &_wb_block[index][0], _wb_len[index]);
+    #else
+        err = FM_WriteFirmwareSubPackage(_part_name, &_wb_block[index][0], _wb_len[index]);
+    #endif
+
+        /* 写入期间主机取消了传输，队列已复位 */
+        if (_wb_count == 0)
+            return;
+
+        /* 擦写队列的空间不足，保留该块，下次再写入 */
+        if (err == FM_ERR_BUSY)
+            return;
+
+        if (err != FM_ERR_OK)
+        {
+            BSP_Printf("%s: write error (%d), cancel at next reply.\r\n", __func__, err);
+            _wb_err = err;
+        }
+        else
+        {
+            _wb_len[index] = 0;
+            _wb_count--;
+        }
+    }
+
+    if (_wb_is_flush == false)
+        return;
+
+    if (_wb_err == FM_ERR_OK)
+    {
+        if (_wb_count < WRITE_BEHIND_BLOCK_NUM && _wb_len[_wb_fill])
+            _WriteBehind_Commit();
+
+        if (_wb_count)
+            return;
+
+        _wb_is_flush = false;
+        _fw_update_info.cmd_exe_result = PP_RESULT_OK;
+    }
+    else
+    {
+        _wb_is_flush = false;
+        _fw_update_info.cmd_exe_err_code = (PP_CMD_ERR_CODE)_wb_err;
+        _SetExeFlow(EXE_FLOW_FAILED);
+        _fw_update_info.cmd_exe_result = PP_RESULT_CANCEL;
+    }
+}
+
+
+/**
+ * @brief  复位后台写入队列
+ * @note   丢弃未写入的块
+ * @retval None
+ */
+static void _WriteBehind_Reset(void)
+{
+    for (uint8_t i = 0; i < WRITE_BEHIND_BLOCK_NUM; i++)
+        _wb_len[i] = 0;
+
+    _wb_fill     = 0;
+    _wb_count    = 0;
+    _wb_is_flush = false;
+    _wb_err      = FM_ERR_OK;
 }
+#endif
+
+
+#if (ENABLE_ERASE_AHEAD)
+/**
+ * @brief  接收固件包时的后台擦除
+ * @note   1. 只在等待主机数据的流程中擦除，每次调用最多擦除一个块
+ *         2. 擦除前先处理主机的数据，使应答先发出，擦除与主机发送下一个数据帧并行进行
+ *         3. 后台写入队列中有等待写入的块时先写入，不擦除
+ *         4. 主机预告了固件包大小时，在等待固件包头时按该大小预先擦除 download 分区
+ * @retval None
+ */
+static void _EraseAhead_Process(void)
+{
+    Bootloader_Port_HostDataProcess();
+
+    switch (_fw_update_info.exe_flow)
+    {
+        case EXE_FLOW_WAIT_FIRMWARE:
+        {
+        #if (USING_PART_PROJECT > ONE_PART_PROJECT)
+            if (_prepare_size)
+            {
+                FM_EraseFirmwareAhead(DOWNLOAD_PART_NAME, _prepare_size);
+                _prepare_size = 0;
+            }
+        #endif
+            break;
+        }
+        case EXE_FLOW_ERASE_OLD_FIRMWARE_DONE:
+        case EXE_FLOW_WRITE_FIRMWARE_HEAD_DONE:
+        case EXE_FLOW_WRITE_NEW_FIRMWARE_DONE:
+            break;
+        default: return;
+    }
+
+#if (ENABLE_WRITE_BEHIND)
+    if (_wb_count || _wb_is_flush)
+        return;
+#endif
+
+    FM_EraseAheadProcess();
+}
+#endif
 
 
 /**
@@ -46,6 +46,15 @@
  * v1.5     2023-05-04     Dino         1. 修复在 YModem 协议下，进入需要主机下发固件包的流程时需要主动上发字符 'C' 的问题
  * v1.6     2023-12-10     Dino         1. 改名为 bootloader
  *                                      2. 可移植部分代码分至 bootloader_port.c
+ * v1.7     2026-10-18                  1. 增加耗时统计的接口
+ * v1.8     2026-10-18                  1. 增加滑动窗口协议的头文件和配置检查
+ * v1.9     2026-10-18                  1. 增加 YModem 扩展数据帧的配置检查
+ * v1.10    2026-10-18                  1. 增加固件写入后台队列的配置检查
+ * v1.11    2026-10-18                  1. 增加解压组件的配置检查
+ * v1.12    2026-10-18                  1. 增加 APP 分区写入检查方案的配置检查
+ * v1.13    2026-10-18                  1. 增加 Bootloader_PrepareFirmware 的声明
+ * v1.14    2026-10-18                  1. 增加擦除状态记录区的配置检查
+ * v1.15    2026-10-18                  1. 增加异步 flash 操作缓存的配置检查
  */
 
 #ifndef __BOOTLOADER_H__
@@ -54,6 +63,7 @@
 #include "bootloader_define.h"
 #include "firmware_manage.h"
 #include "protocol_parser.h"
+#include "protocol_window.h"
 #include "data_transfer.h"
 
 
@@ -150,6 +160,13 @@ struct FIRMWARE_UPDATE_INFO
 
 void Bootloader_Init(void);
 void Bootloader_Loop(void);
+#if (ENABLE_ERASE_AHEAD && USING_PART_PROJECT > ONE_PART_PROJECT)
+bool Bootloader_PrepareFirmware(uint32_t size);
+#endif
+#if (ENABLE_PERF_STATS)
+const struct PERF_STATS * Bootloader_GetPerfStats(void);
+void Bootloader_PrintPerfStats(void);
+#endif
 
 
 /* 一些配置参数的错误检查 */
@@ -194,6 +211,40 @@ void Bootloader_Loop(void);
 #error "The FACTORY_NO_FIRMWARE_SOLUTION option is out of range."
 #endif
 
+#if (ENABLE_WINDOW_PROTOCOL)
+    #if (WINDOW_PROTOCOL_FRAME_NUM < 1 || WINDOW_PROTOCOL_FRAME_NUM > 32)
+    #error "The WINDOW_PROTOCOL_FRAME_NUM option is out of range."
+    #endif
+#endif
+
+#if (ENABLE_YMODEM_EXT_FRAME)
+    #if (YMODEM_EXT_DATA_LEN < 1024 || (YMODEM_EXT_DATA_LEN % 1024) || (FPK_LEAST_HANDLE_BYTE % YMODEM_EXT_DATA_LEN))
+    #error "The YMODEM_EXT_DATA_LEN option is out of range."
+    #endif
+#endif
+
+#if (ENABLE_WRITE_BEHIND)
+    #if (WRITE_BEHIND_BLOCK_NUM < 2 || WRITE_BEHIND_BLOCK_NUM > 255)
+    #error "The WRITE_BEHIND_BLOCK_NUM option is out of range."
+    #endif
+#endif
+
+#if (ENABLE_DECOMPRESS)
+    #if (DECOMPRESS_WINDOW_BITS < 8 || DECOMPRESS_WINDOW_BITS > 12)
+    #error "The DECOMPRESS_WINDOW_BITS option is out of range."
+    #endif
+#endif
+
+#if (USING_APP_WRITE_CHECK_PROJECT < APP_WRITE_CHECK_NONE || USING_APP_WRITE_CHECK_PROJECT > APP_WRITE_CHECK_FULL)
+#error "The USING_APP_WRITE_CHECK_PROJECT option is out of range."
+#endif
+
+#if (USING_APP_WRITE_CHECK_PROJECT == APP_WRITE_CHECK_SAMPLE)
+    #if (APP_WRITE_CHECK_SAMPLE_NUM < 2)
+    #error "The APP_WRITE_CHECK_SAMPLE_NUM option is out of range."
+    #endif
+#endif
+
 #ifndef WAIT_HOST_DATA_MAX_TIME
 #error "The WAIT_HOST_DATA_MAX_TIME undefined."
 #endif
@@ -289,6 +340,28 @@ void Bootloader_Loop(void);
     #endif
 #endif  /* #if (USING_PART_PROJECT == ONE_PART_PROJECT) */
 
+#if (ENABLE_ERASE_STATE)
+    #if (ERASE_STATE_SIZE == 0)
+    #error "The ERASE_STATE_SIZE cannot be 0."
+    #endif
+    /* 记录区位于片内 flash 末尾，不能与片内的分区重叠 */
+    #if (BOOTLOADER_SIZE + APP_PART_SIZE + ERASE_STATE_SIZE                                                                    \
+         + (USING_PART_PROJECT > ONE_PART_PROJECT    && DOWNLOAD_PART_LOCATION == STORE_IN_ONCHIP_FLASH) * DOWNLOAD_PART_SIZE  \
+         + (USING_PART_PROJECT > DOUBLE_PART_PROJECT && FACTORY_PART_LOCATION  == STORE_IN_ONCHIP_FLASH) * FACTORY_PART_SIZE)  \
+         > ONCHIP_FLASH_SIZE
+    #error "ERASE_STATE_SIZE overlaps the partitions in onchip flash."
+    #endif
+#endif
+
+#if (ENABLE_ASYNC_FLASH)
+    #if ((ASYNC_FLASH_BUFF_SIZE % 1024) != 0)
+    #error "The ASYNC_FLASH_BUFF_SIZE must be a multiple of 1024."
+    #endif
+    #if (ASYNC_FLASH_BUFF_SIZE < 4096)
+    #error "The ASYNC_FLASH_BUFF_SIZE cannot be less than 4096."
+    #endif
+#endif
+
 #endif  /* __BOOTLOADER_H__ */
 
 
@@ -33,6 +33,11 @@
 #define AUTO_UPDATE_APP                     2
 #define DO_NOT_DO_ANYTHING                  3
 
+/* USING_APP_WRITE_CHECK_PROJECT */
+#define APP_WRITE_CHECK_NONE                0
+#define APP_WRITE_CHECK_SAMPLE              1
+#define APP_WRITE_CHECK_FULL                2
+
 /* DOWNLOAD_PART_LOCATION */
 /* FACTORY_PART_LOCATION */
 #define STORE_IN_ONCHIP_FLASH               0
@@ -45,10 +50,12 @@
 #define APP_PART_NAME                       "app"
 #define DOWNLOAD_PART_NAME                  "download"
 #define FACTORY_PART_NAME                   "factory"
+#define ERASE_STATE_PART_NAME               "state"
 
 #define ONCHIP_FLASH_END_ADDRESS            ((uint32_t)(FLASH_BASE + ONCHIP_FLASH_SIZE))            /* 片内 flash 末地址 */
 #define APP_ADDRESS                         ((uint32_t)(FLASH_BASE + BOOTLOADER_SIZE))              /* APP 分区起始地址 */
 #define DOWNLOAD_ADDRESS                    ((uint32_t)(APP_ADDRESS + APP_PART_SIZE))               /* download 分区起始地址 */
 #define FACTORY_ADDRESS                     ((uint32_t)(DOWNLOAD_ADDRESS + DOWNLOAD_PART_SIZE))     /* factory 分区起始地址 */
+#define ERASE_STATE_ADDRESS                 ((uint32_t)(ONCHIP_FLASH_END_ADDRESS - ERASE_STATE_SIZE)) /* 擦除状态记录区起始地址 */
 
 #endif
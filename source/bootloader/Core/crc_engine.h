@@ -0,0 +1,89 @@
+/**
+ * \file            crc_engine.h
+ * \brief           table-driven CRC16-XMODEM and CRC32 with slicing and hardware backend
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.0
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ */
+
+#ifndef __CRC_ENGINE_H__
+#define __CRC_ENGINE_H__
+
+#include <stdint.h>
+
+/* 未经 common.h 包含时（如主机的基准测试工具）才包含配置文件，便于单独编译 */
+#ifndef CRC_SLICE_NUM
+#include "bootloader_config.h"
+#endif
+
+/**
+ * 数据帧的 CRC16 和固件包的 CRC32 均在传输和校验的热路径上，本模块以 ROM 中的常量表查表计算：
+ *    - CRC16-XMODEM: 多项式 0x1021 ，初值 0 ，不反转，与 crcLib.c 的 crc16_xmodem 结果一致
+ *    - CRC32: 多项式 0x04C11DB7 ，初值和结果异或值均为 0xFFFFFFFF ，输入输出反转，与 zlib 的 crc32 结果一致
+ *    - CRC_SLICE_NUM 为 4 或 8 时，先逐字节处理至 4 字节对齐，再按字读取，每次查表处理 4 或 8 byte ，
+ *      常量表为 CRC_SLICE_NUM 行 256 项，CRC32 占 CRC_SLICE_NUM KByte ， CRC16 占其一半
+ *    - ENABLE_CRC32_HARDWARE 为 1 时， CRC32 对齐的整字交由 STM32 的 CRC 外设计算，首尾不足一个字的部分仍查表计算
+ * 按字读取的数据视为小端（ Cortex-M 与 x86 均为小端）。
+ */
+
+#define CRC16_POLYNOMIAL                0x1021
+#define CRC32_POLYNOMIAL                0x04C11DB7
+#define CRC32_INIT_VALUE                0xFFFFFFFF
+
+#ifndef ENABLE_CRC32_HARDWARE
+#define ENABLE_CRC32_HARDWARE           0
+#endif
+
+#if (CRC_SLICE_NUM != 1 && CRC_SLICE_NUM != 4 && CRC_SLICE_NUM != 8)
+#error "CRC_SLICE_NUM must be 1, 4 or 8"
+#endif
+
+
+void        CRC_Init            (void);
+uint16_t    CRC16_XModem        (const uint8_t *data, uint32_t len);
+uint16_t    CRC16_XModemStep    (uint16_t crc, const uint8_t *data, uint32_t len);
+uint32_t    CRC32_Calc          (const uint8_t *data, uint32_t len);
+uint32_t    CRC32_StepCalc      (uint32_t crc, const uint8_t *data, uint32_t len);
+
+/* 各查表方式的实现，由 CRC16_XModemStep 和 CRC32_StepCalc 按 CRC_SLICE_NUM 选用，也供基准测试对比 */
+uint16_t    CRC16_Slice1        (uint16_t crc, const uint8_t *data, uint32_t len);
+uint32_t    CRC32_Slice1        (uint32_t crc, const uint8_t *data, uint32_t len);
+#if (CRC_SLICE_NUM >= 4)
+uint16_t    CRC16_Slice4        (uint16_t crc, const uint8_t *data, uint32_t len);
+uint32_t    CRC32_Slice4        (uint32_t crc, const uint8_t *data, uint32_t len);
+#endif
+#if (CRC_SLICE_NUM >= 8)
+uint16_t    CRC16_Slice8        (uint16_t crc, const uint8_t *data, uint32_t len);
+uint32_t    CRC32_Slice8        (uint32_t crc, const uint8_t *data, uint32_t len);
+#endif
+
+
+#endif
@@ -38,34 +38,347 @@
  * v1.4     2023-12-10     Dino         1. 合并 utils.c 到 firmware_manage.c 中
  *                                      2. 将固件头数据的值和掩码修改为可配置宏
  *                                      3. 修复写固件版本时没有进行 flash 写对齐的问题
+ * v1.5     2026-10-18                  1. 增加基于 perf_counter 的耗时统计（ ENABLE_PERF_STATS ）
+ * v1.6     2026-10-18                  1. 暂存主机下发的固件分包前检查是否超出暂存区，分包可大于 1024 byte
+ * v1.7     2026-10-18                  1. 主机下发至 APP 分区的固件分包不再暂存至 _fpk_min_handle_buff ，就地解密后直接写入
+ * v1.8     2026-10-18                  1. 增加固件包的流式解压（ ENABLE_DECOMPRESS ），写入 APP 分区时边解压边写入
+ *                                      2. 固件更新进度改为按已处理的固件包数据量计算
+ * v1.9     2026-10-18                  1. 增加差分固件包的还原（ ENABLE_DELTA_UPDATE ），接收时还原并写入 download/factory 分区
+ *                                      2. 每次暂存固件包头时初始化 AES
+ * v1.10    2026-10-18                  1. 增加断点续传（ ENABLE_RESUME_TRANSFER ），写入 download 分区时在分区末尾记录进度
+ * v1.11    2026-10-18                  1. 增加 APP 分区的增量写入（ ENABLE_INCREMENTAL_UPDATE ），先比较再只擦写有差异的块
+ * v1.12    2026-10-18                  1. CRC32 改由 crc_engine.c 以 ROM 中的常量表计算，不再于初始化时生成计算表
+ * v1.13    2026-10-18                  1. 增加接收时的包体 CRC32 累加（ ENABLE_STREAM_VERIFY ），接收完成后不再读出整个固件包校验
+ * v1.14    2026-10-18                  1. 更新至 APP 分区时同时累加源固件的 CRC32 ，校验 APP 时不再读出整个 APP 分区
+ *                                      2. 增加 APP 分区写入后的检查（ USING_APP_WRITE_CHECK_PROJECT ），读回刚写入的数据比较
+ * v1.15    2026-10-18                  1. 擦除和判空只处理固件包占用的范围和分区末尾的记录，不再处理整个分区
+ *                                      2. 记录各分区可能有数据的范围，已是擦除状态的范围不再擦除
+ * v1.16    2026-10-18                  1. 增加接收时的逐块擦除（ ENABLE_ERASE_AHEAD ），写入前才擦除写入位置所在的块，其余的块在等待主机数据时擦除
+ *                                      2. 检查擦除状态时可指定读取的缓存
+ * v1.17    2026-10-18                  1. 增加各分区擦除状态的记录（ ENABLE_ERASE_STATE ），启动后按记录判空和擦除，无须读取整个分区
+ * v1.18    2026-10-18                  1. 初始化时检查片内 flash 的编程能力，写入单位不是 burst_unit 的整数倍时给出警告
+ * v1.19    2026-10-18                  1. 增加异步的 flash 擦写（ ENABLE_ASYNC_FLASH ），擦写排队后即返回，未完成时返回 FM_ERR_BUSY
+ *                                      2. 更新至 APP 分区改为每次调用处理一个块，写入检查改在写入完成后执行
+ * v1.20    2026-10-18                  1. 初始化时按 flash 的 sector 布局检查分区的放置，会放大擦除时间或连带擦除其他数据时给出警告
+ *                                      2. 接收时的逐块擦除按擦除计划对齐到实际的 sector 或块
+ *                                      3. 修改 download 分区的固件版本时按分区首个 sector 的实际尺寸处理，大于缓存时经固件之后的空闲 sector 分块中转
+ *                                      4. 校验固件包头时确认固件之后留有中转的空闲 sector ，放不下中转 sector 的 download 分区编译时报错
  */
 
 
 /* Includes ------------------------------------------------------------------*/
 #include "firmware_manage.h"
 
-#if (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH &&    \
-     SPI_FLASH_ERASE_GRANULARITY > FPK_LEAST_HANDLE_BYTE)
-#error "SPI flash erase granularity oversize than _fpk_min_handle_buff array"
+/* 分区对象见 flash_async.h 。启用 ENABLE_ASYNC_FLASH 时擦写排队执行，读取前等待重叠的擦写完成 */
+#if (ENABLE_ASYNC_FLASH)
+    #define FLASH_PART_READ     FA_Read
+    #define FLASH_PART_WRITE    FA_Write
+    #define FLASH_PART_ERASE    FA_Erase
+#else
+    #define FLASH_PART_READ     FA_RAW_READ
+    #define FLASH_PART_WRITE    FA_RAW_WRITE
+    #define FLASH_PART_ERASE    FA_RAW_ERASE
+#endif
+
+/* 擦除粒度大于 _fpk_min_handle_buff 时，修改固件版本需经固件之后的空闲 sector 中转， download 分区至少需放下两个 sector */
+#if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT && USING_PART_PROJECT > ONE_PART_PROJECT)
+    #if (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH &&    \
+         SPI_FLASH_ERASE_GRANULARITY > FPK_LEAST_HANDLE_BYTE && DOWNLOAD_PART_SIZE < 2 * SPI_FLASH_ERASE_GRANULARITY)
+    #error "download part has no room to relay the first SPI flash sector when modifying the firmware version"
+    #endif
+
+    #if (DOWNLOAD_PART_LOCATION == STORE_IN_ONCHIP_FLASH &&    \
+         ONCHIP_FLASH_ERASE_GRANULARITY > FPK_LEAST_HANDLE_BYTE && DOWNLOAD_PART_SIZE < 2 * ONCHIP_FLASH_ERASE_GRANULARITY)
+    #error "download part has no room to relay the first onchip flash sector when modifying the firmware version"
+    #endif
 #endif
 
-#if (DOWNLOAD_PART_LOCATION == STORE_IN_ONCHIP_FLASH &&    \
-     ONCHIP_FLASH_ERASE_GRANULARITY > FPK_LEAST_HANDLE_BYTE)
-#error "onchip flash erase granularity oversize than _fpk_min_handle_buff array"
+#if (ENABLE_DECOMPRESS)
+    #define LZ_WINDOW_SIZE      (1 << DECOMPRESS_WINDOW_BITS)
+    #define LZ_WINDOW_MASK      (LZ_WINDOW_SIZE - 1)
 #endif
 
-#if (IS_ENABLE_SPI_FLASH)
-    #define FLASH_OBJECT        fal_partition
-    #define GET_FLASH_OBJECT    fal_partition_find
-    #define FLASH_PART_READ     fal_partition_read
-    #define FLASH_PART_WRITE    fal_partition_write
-    #define FLASH_PART_ERASE    fal_partition_erase
-#else
-    #define FLASH_OBJECT        BSP_FLASH
-    #define GET_FLASH_OBJECT    BSP_Flash_GetHandle
-    #define FLASH_PART_READ     BSP_Flash_Read
-    #define FLASH_PART_WRITE    BSP_Flash_Write
-    #define FLASH_PART_ERASE    BSP_Flash_Erase
+/* 单分区方案接收时 APP 分区已擦除，无法读取基础固件 */
+#define IS_ENABLE_DELTA_UPDATE  (ENABLE_DELTA_UPDATE && USING_PART_PROJECT > ONE_PART_PROJECT)
+
+#if (IS_ENABLE_DELTA_UPDATE)
+    #define PATCH_HEAD_SIZE     8                               /* 补丁头：基础固件的大小和 CRC32 */
+    #define PATCH_CTRL_SIZE     12                              /* 控制字： diff 长度、 extra 长度和基础固件的偏移 */
+    #define PATCH_CACHE_SIZE    (FPK_LEAST_HANDLE_BYTE / 2)     /* _fpk_min_handle_buff 前半为基础固件的缓存，后半为写入 flash 的缓存 */
+#endif
+
+#if (IS_ENABLE_RESUME_TRANSFER)
+    #define JOURNAL_MAGIC       0x4C4E524A                      /* 进度记录的标识 "JRNL" */
+    #define JOURNAL_DONE_OFFSET 0xFFFFFFFF                      /* 固件包已接收完毕，不能再续传 */
+    #define JOURNAL_RECORD_SIZE 32                              /* 需为 ONCHIP_FLASH_ONCE_WRITE_BYTE 的整数倍 */
+    #define JOURNAL_RECORD_NUM  (RESUME_JOURNAL_SIZE / JOURNAL_RECORD_SIZE)
+
+    #if (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH &&    \
+         (RESUME_JOURNAL_SIZE % SPI_FLASH_ERASE_GRANULARITY))
+    #error "RESUME_JOURNAL_SIZE is not a multiple of SPI flash erase granularity"
+    #endif
+
+    /* ONCHIP_FLASH_ERASE_GRANULARITY 仅在 MODIFY_DOWNLOAD_PART_PROJECT 时给出，其余情况需自行保证 */
+    #if (DOWNLOAD_PART_LOCATION == STORE_IN_ONCHIP_FLASH && defined(ONCHIP_FLASH_ERASE_GRANULARITY))
+    #if (RESUME_JOURNAL_SIZE % ONCHIP_FLASH_ERASE_GRANULARITY)
+    #error "RESUME_JOURNAL_SIZE is not a multiple of onchip flash erase granularity"
+    #endif
+    #endif
+
+    #if (JOURNAL_RECORD_SIZE % ONCHIP_FLASH_ONCE_WRITE_BYTE)
+    #error "JOURNAL_RECORD_SIZE is not a multiple of ONCHIP_FLASH_ONCE_WRITE_BYTE"
+    #endif
+#endif
+
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+    #define WRITE_CHECK_SIZE    256                             /* 每次读回 APP 分区用于比较的数据量 */
+#endif
+
+/* 按需擦除的对齐单位。 sector 更大时（如 STM32F4 ）由移植接口擦除所在的整个 sector ，逐块擦除按 sector 布局对齐到整个 sector */
+#define ERASE_ALIGN_SIZE        FPK_LEAST_HANDLE_BYTE
+#define ERASE_ALIGN_UP(x)       (((x) + ERASE_ALIGN_SIZE - 1) / ERASE_ALIGN_SIZE * ERASE_ALIGN_SIZE)
+#define ERASE_PART_NUM          3                               /* APP 、 download 和 factory 分区 */
+
+#if (ENABLE_ERASE_AHEAD)
+    #define ERASE_AHEAD_READ_SIZE   256                         /* 每次读取分区用于检查擦除状态的数据量 */
+#endif
+
+#if (ENABLE_ERASE_STATE)
+    #define ERASE_STATE_MAGIC       0x54535245                  /* 擦除状态记录的标识 "ERST" */
+    #define ERASE_STATE_RECORD_SIZE 32                          /* 需为 ONCHIP_FLASH_ONCE_WRITE_BYTE 的整数倍 */
+    #define ERASE_STATE_RECORD_NUM  (ERASE_STATE_SIZE / ERASE_STATE_RECORD_SIZE)
+
+    #if (defined(ONCHIP_FLASH_ERASE_GRANULARITY) && (ERASE_STATE_SIZE % ONCHIP_FLASH_ERASE_GRANULARITY))
+    #error "ERASE_STATE_SIZE is not a multiple of onchip flash erase granularity"
+    #endif
+
+    #if (ERASE_STATE_RECORD_SIZE % ONCHIP_FLASH_ONCE_WRITE_BYTE)
+    #error "ERASE_STATE_RECORD_SIZE is not a multiple of ONCHIP_FLASH_ONCE_WRITE_BYTE"
+    #endif
+
+    #if (ERASE_STATE_RECORD_NUM <= ERASE_PART_NUM)
+    #error "ERASE_STATE_SIZE is too small"
+    #endif
+#endif
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    #define INCR_UNIT_NUM       (APP_PART_SIZE / INCREMENTAL_ERASE_UNIT)
+    #define INCR_COMPARE_SIZE   256                             /* 每次读取 APP 分区用于比较的数据量 */
+    #define INCR_IS_DIRTY(unit)     (_incr.dirty[(unit) / 8] &  (1 << ((unit) % 8)))
+    #define INCR_SET_DIRTY(unit)    (_incr.dirty[(unit) / 8] |= (1 << ((unit) % 8)))
+
+    #if (APP_PART_SIZE % INCREMENTAL_ERASE_UNIT)
+    #error "APP_PART_SIZE is not a multiple of INCREMENTAL_ERASE_UNIT"
+    #endif
+
+    #if (INCREMENTAL_ERASE_UNIT % ONCHIP_FLASH_ONCE_WRITE_BYTE)
+    #error "INCREMENTAL_ERASE_UNIT is not a multiple of ONCHIP_FLASH_ONCE_WRITE_BYTE"
+    #endif
+#endif
+
+
+/* Private typedef -----------------------------------------------------------*/
+#if (ENABLE_DECOMPRESS)
+/**
+ * LZSS 位流（与 heatshrink 相同），按 MSB 在前读取：
+ *    - 1 + 8 bit 字面量
+ *    - 0 + index_bits 的回溯距离（值 + 1） + count_bits 的长度（值 + 1）
+ */
+typedef enum
+{
+    LZ_STATE_TAG = 0x00,                                        /* 读取标志位 */
+    LZ_STATE_LITERAL,                                           /* 读取字面量 */
+    LZ_STATE_INDEX,                                             /* 读取回溯距离 */
+    LZ_STATE_COUNT,                                             /* 读取回溯长度 */
+
+} LZ_STATE;
+
+struct LZ_DECODER
+{
+    LZ_STATE state;                                             /* 解码的状态 */
+    uint8_t  bit_num;                                           /* bit_buff 中未读取的位数 */
+    uint16_t index;                                             /* 回溯距离 */
+    uint32_t bit_buff;                                          /* 输入数据的位缓存 */
+    uint32_t out_size;                                          /* 已解压的数据量，单位 byte */
+};
+#endif
+
+#if (IS_ENABLE_DELTA_UPDATE)
+/**
+ * 补丁（与 bsdiff 的结构相同），多字节数据均为小端：
+ *    - 补丁头： base_size (4) | base_crc (4)
+ *    - 之后重复： diff_len (4) | extra_len (4) | seek (4 ，有符号) | diff (diff_len) | extra (extra_len)
+ *      diff 与基础固件的数据逐字节相加， extra 直接输出，之后基础固件的读取位置偏移 seek
+ */
+typedef enum
+{
+    PATCH_STATE_HEAD = 0x00,                                    /* 读取补丁头 */
+    PATCH_STATE_CTRL,                                           /* 读取控制字 */
+    PATCH_STATE_DIFF,                                           /* 读取 diff 数据 */
+    PATCH_STATE_EXTRA,                                          /* 读取 extra 数据 */
+
+} PATCH_STATE;
+
+struct PATCH_DECODER
+{
+    PATCH_STATE state;                                          /* 还原的状态 */
+    uint8_t  field_len;                                         /* field 中已读取的字节数 */
+    uint8_t  field[PATCH_CTRL_SIZE];                            /* 补丁头或控制字 */
+    uint16_t cache_len;                                         /* 基础固件缓存的数据量，单位 byte */
+    uint16_t out_len;                                           /* 写入 flash 缓存的数据量，单位 byte */
+    uint32_t diff_len;                                          /* 剩余的 diff 数据量，单位 byte */
+    uint32_t extra_len;                                         /* 剩余的 extra 数据量，单位 byte */
+    int32_t  seek;                                              /* 基础固件读取位置的偏移 */
+    uint32_t base_size;                                         /* 基础固件的大小，单位 byte */
+    uint32_t base_posit;                                        /* 基础固件的读取位置 */
+    uint32_t cache_posit;                                       /* 基础固件缓存对应的位置 */
+    uint32_t out_size;                                          /* 已还原的数据量，单位 byte */
+    const struct FLASH_OBJECT *base_part;                       /* 基础固件所在的 APP 分区 */
+};
+#endif
+
+#if (IS_ENABLE_RESUME_TRANSFER)
+/**
+ * 断点续传的进度记录，追加写在 download 分区末尾的 RESUME_JOURNAL_SIZE byte 中，以最后一条有效的记录为准，写满后擦除重写。
+ * 固件包在 download 分区中原样存放，因此只需记录已写入的数据量，续传前以 body_crc 校验已写入的数据
+ */
+struct JOURNAL_RECORD
+{
+    uint32_t magic;                                             /* JOURNAL_MAGIC */
+    uint32_t head_crc;                                          /* 固件包头的 CRC32 ，用于识别同一个固件包 */
+    uint32_t offset;                                            /* 已写入 flash 的包体数据量，单位 byte */
+    uint32_t body_crc;                                          /* 已写入的包体数据的 CRC32 中间值（未取反） */
+    uint32_t reserved[3];
+    uint32_t record_crc;                                        /* 本记录的 CRC32 */
+};
+
+struct JOURNAL
+{
+    bool     is_enable;                                         /* 本次写入是否记录进度 */
+    uint16_t slot;                                              /* 下一条记录的位置 */
+    uint32_t offset;                                            /* 已写入 flash 的包体数据量，单位 byte */
+    uint32_t body_crc;                                          /* 已写入的包体数据的 CRC32 中间值 */
+};
+#endif
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+/**
+ * 增量写入 APP 分区的阶段， _Write_Flash 按此处理写入 APP 分区的数据。
+ * APP 分区按 INCREMENTAL_ERASE_UNIT 分块，先将固件包完整地处理一遍用于比较，再处理一遍只写入有差异的块
+ */
+typedef enum
+{
+    INCR_MODE_NONE = 0x00,                                      /* 全部写入 */
+    INCR_MODE_COMPARE,                                          /* 只与 APP 分区的数据比较，标记有差异的块 */
+    INCR_MODE_WRITE,                                            /* 只写入有差异的块 */
+
+} INCR_MODE;
+
+struct INCREMENTAL
+{
+    INCR_MODE mode;
+    uint8_t   dirty[(INCR_UNIT_NUM + 7) / 8];                   /* 各块是否有差异，按位记录 */
+    uint8_t   buff[INCR_COMPARE_SIZE];                          /* 读取 APP 分区数据的缓存 */
+};
+#endif
+
+#if (ENABLE_STREAM_VERIFY)
+/**
+ * 主机下发的固件包写入分区时累加的包体 CRC32 。写入须从分区首地址开始按顺序进行，
+ * 只累加 [body_addr, body_addr + body_size) 范围内的数据，与 _VerifyFirmware 读取的范围一致
+ */
+struct STREAM_VERIFY
+{
+    const struct FLASH_OBJECT *part;                            /* 写入的分区，为 NULL 时无效 */
+    bool     is_done;                                           /* 是否已写入完毕 */
+    uint32_t body_addr;                                         /* 包体在分区中的相对地址 */
+    uint32_t body_size;                                         /* 包体的数据量，单位 byte */
+    uint32_t next_addr;                                         /* 下一次写入的相对地址 */
+    uint32_t body_crc;                                          /* 已写入的包体数据的 CRC32 中间值 */
+    #if (STREAM_VERIFY_READ_BACK)
+    uint32_t last_addr;                                         /* 最后一次写入的相对地址 */
+    uint32_t last_size;                                         /* 最后一次写入的数据量，单位 byte */
+    uint32_t last_crc;                                          /* 最后一次写入的数据的 CRC32 */
+    #endif
+};
+#endif
+
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+/**
+ * 写入 APP 分区后的检查，读回刚写入的数据与 RAM 中的数据比较
+ */
+struct WRITE_CHECK
+{
+    const struct FLASH_OBJECT *part;                            /* 需要检查的分区，为 NULL 时不检查 */
+    uint32_t count;                                             /* 已写入的次数，用于抽样 */
+    uint8_t  buff[WRITE_CHECK_SIZE];                            /* 读回数据的缓存 */
+};
+#endif
+
+/**
+ * 分区中可能有数据的范围，用于按需擦除。固件总是从分区首地址开始写入，因此由本次启动后写入的长度和
+ * 之前遗留的数据范围表示，不确定时按有数据处理。启动时遗留的范围为 [0, limit) ， limit 之后的记录每次都检查
+ */
+struct ERASE_EXTENT
+{
+    const struct FLASH_OBJECT *part;                            /* 分区对象，为 NULL 时未初始化 */
+    uint32_t limit;                                             /* 固件可使用的范围，之后为分区末尾的记录 */
+    uint32_t written;                                           /* 从首地址开始写入的长度，单位 byte */
+    uint32_t stale_begin;                                       /* 遗留数据的起始相对地址 */
+    uint32_t stale_end;                                         /* 遗留数据的结束相对地址，不大于 stale_begin 时无遗留数据 */
+};
+
+#if (ENABLE_ERASE_AHEAD)
+/**
+ * 接收固件包时逐块擦除的范围。 [next, end) 尚未擦除，仍记录在分区的遗留数据中，
+ * 写入前先擦除写入位置所在的块，其余的块在等待主机数据时由 FM_EraseAheadProcess 逐块擦除
+ */
+struct ERASE_AHEAD
+{
+    struct ERASE_EXTENT *extent;                                /* 擦除的分区，为 NULL 时无须擦除 */
+    bool     is_tail;                                           /* 分区末尾的记录是否尚未擦除 */
+    uint32_t next;                                              /* 下一个块的相对地址 */
+    uint32_t end;                                               /* 擦除范围的结束相对地址 */
+    uint8_t  buff[ERASE_AHEAD_READ_SIZE];                       /* 检查擦除状态的缓存， _fpk_min_handle_buff 可能存有待写入的数据 */
+};
+#endif
+
+#if (ENABLE_ERASE_STATE)
+/**
+ * 擦除状态的记录，追加写在片内 flash 末尾的 ERASE_STATE_SIZE byte 中，各分区以最后一条有效的记录为准，写满后擦除并重写各分区最后的记录。
+ * 分区的 [begin, end) 之外为擦除状态，写入前先记录写入位置至分区末尾有数据，因此复位或掉电时记录只会多于实际有数据的范围
+ */
+struct ERASE_STATE_RECORD
+{
+    uint32_t magic;                                             /* ERASE_STATE_MAGIC */
+    uint32_t index;                                             /* 分区在 _extent 中的序号 */
+    uint32_t begin;                                             /* 可能有数据的起始相对地址 */
+    uint32_t end;                                               /* 可能有数据的结束相对地址，不大于 begin 时为擦除状态 */
+    uint32_t is_writing;                                        /* 写入尚未结束，写入结束或擦除后按实际的范围重新记录 */
+    uint32_t reserved[2];
+    uint32_t record_crc;                                        /* 本记录的 CRC32 */
+};
+
+struct ERASE_STATE
+{
+    const struct FLASH_OBJECT *part;                            /* 记录区对象，为 NULL 时不记录 */
+    const struct FLASH_OBJECT *parts[ERASE_PART_NUM];           /* 与 _extent 对应的各分区对象 */
+    uint16_t slot;                                              /* 下一条记录的位置 */
+    struct ERASE_STATE_RECORD record[ERASE_PART_NUM];           /* 各分区最后的记录， magic 不为 ERASE_STATE_MAGIC 时 [0, limit) 均按有数据处理 */
+};
+#endif
+
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+/**
+ * 更新至 APP 分区的进度。启用 ENABLE_ASYNC_FLASH 时每次调用只处理一个块，之后返回 FM_ERR_BUSY ，
+ * 使 flash 擦写期间 bootloader 仍可处理主机数据，再次调用时从记录的位置继续
+ */
+struct UPDATE_TO_APP
+{
+    const struct FLASH_OBJECT *part;                            /* 固件包所在的分区，为 NULL 时尚未开始 */
+    bool     is_decrypt;                                        /* 固件包是否加密 */
+    uint32_t read_posit;                                        /* 下一次读取的包体相对地址 */
+};
 #endif
 
 
@@ -73,16 +386,43 @@
 static bool     _is_start_write;                                /* 固件开始写入的标志位 */
 static uint16_t _update_progress;                               /* 固件更新的进度， 10000 制 */
 static uint16_t _update_progress_step_num;                      /* 固件更新进度的步进单位 */
-static uint16_t _storage_data_size;                             /* 固件包写入时记录暂存的固件分包大小，单位 byte */
 static uint32_t _write_part_addr;                               /* 固件包写入时记录写入 flash 的相对地址 */
-static uint16_t _write_last_pkg_size;                           /* 固件包写入时最后一个分包的大小，单位 byte */
-static uint32_t _crc_tab[256];                                  /* CRC 计算表 */
+static uint32_t _handle_size;                                   /* 已处理的固件包数据量，用于计算更新进度 */
 static uint8_t  _fw_first_bytes[ONCHIP_FLASH_ONCE_WRITE_BYTE];  /* 固件包的前几个字节 */
 static uint8_t  _fpk_min_handle_buff[FPK_LEAST_HANDLE_BYTE];    /* fpk 固件最小处理单位的缓存区，多次使用以降低系统资源开销 */
 static struct FPK_HEAD  _fpk_head;                              /* 用于存放 fpk 固件包头 */
 #if (ENABLE_DECRYPT)
 static struct AES_ctx  _aes_ctx;                                /* AES 对象 */
 #endif
+#if (ENABLE_DECOMPRESS)
+static struct LZ_DECODER _lz;                                   /* 解压的状态 */
+static uint8_t  _lz_window[LZ_WINDOW_SIZE];                     /* 解压窗口，同时作为写入 flash 的缓存 */
+#endif
+#if (IS_ENABLE_DELTA_UPDATE)
+static struct PATCH_DECODER _patch;                             /* 差分还原的状态 */
+#endif
+#if (IS_ENABLE_RESUME_TRANSFER)
+static struct JOURNAL _journal;                                 /* 断点续传的进度 */
+#endif
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+static struct INCREMENTAL _incr;                                /* 增量写入的状态 */
+#endif
+#if (ENABLE_STREAM_VERIFY)
+static struct STREAM_VERIFY _stream;                            /* 接收时累加的包体 CRC32 */
+#endif
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+static struct WRITE_CHECK _write_check;                         /* APP 分区的写入检查 */
+#endif
+static struct ERASE_EXTENT _extent[ERASE_PART_NUM];             /* 各分区可能有数据的范围 */
+#if (ENABLE_ERASE_AHEAD)
+static struct ERASE_AHEAD _ahead;                               /* 接收时逐块擦除的范围 */
+#endif
+#if (ENABLE_ERASE_STATE)
+static struct ERASE_STATE _state;                               /* 各分区的擦除状态记录 */
+#endif
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+static struct UPDATE_TO_APP _update;                            /* 更新至 APP 分区的进度 */
+#endif
 #if (IS_ENABLE_SPI_FLASH == 0)
 static struct BSP_FLASH _flash_app_part;                        /* APP 分区 */
     #if (USING_PART_PROJECT > ONE_PART_PROJECT)
@@ -91,6 +431,9 @@ static struct BSP_FLASH _flash_app_part;                        /* APP 分区 */
         static struct BSP_FLASH _flash_factory_part;            /* factory 分区 */
         #endif
     #endif
+    #if (ENABLE_ERASE_STATE)
+    static struct BSP_FLASH _flash_state_part;                  /* 擦除状态的记录区 */
+    #endif
 #endif
 #if (USING_AUTO_UPDATE_PROJECT == VERSION_WRITE_TO_APP)
 /* APP 版本的记录地址，确保该地址在 flash 上是写对齐的 */
@@ -103,7 +446,6 @@ extern void Firmware_OperateCallback(uint16_t progress);
 
 
 /* Private function prototypes -----------------------------------------------*/
-static void         _CRC32_Init                 (uint32_t poly);
 static uint32_t     _CRC32_Calc                 (uint8_t *buf, uint32_t len);
 static uint32_t     _CRC32_StepCalc             (uint32_t crc_init, uint8_t *buf, uint32_t len);
 static FM_ERR_CODE  _Write_FirmwareSubPackage   (const struct FLASH_OBJECT *part, 
@@ -111,7 +453,94 @@ static FM_ERR_CODE  _Write_FirmwareSubPackage   (const struct FLASH_OBJECT *part
                                                  uint16_t pkg_size, 
                                                  bool     is_decrypt,
                                                  FM_FIRMWARE_WRITE_DIR  write_dir);
+static FM_ERR_CODE  _Write_Flash                (const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size);
 static void         _Reset_Write                (void);
+static FM_ERR_CODE  _Check_Compress             (void);
+static FM_ERR_CODE  _Check_Delta                (void);
+static void         _Check_FlashCaps            (void);
+static void         _Check_FlashLayout          (void);
+#if (ENABLE_DECOMPRESS)
+static bool         _Decompress_IsDone          (void);
+static FM_ERR_CODE  _Decompress_Write           (const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size);
+static FM_ERR_CODE  _Decompress_Output          (const struct FLASH_OBJECT *part, uint8_t byte);
+#endif
+#if (IS_ENABLE_DELTA_UPDATE)
+static void         _Delta_ConvertHead          (struct FPK_HEAD *head);
+static FM_ERR_CODE  _Patch_Write                (const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size);
+static FM_ERR_CODE  _Patch_CheckBase            (uint32_t base_crc);
+static FM_ERR_CODE  _Patch_ReadBase             (uint8_t *byte);
+static FM_ERR_CODE  _Patch_Output               (const struct FLASH_OBJECT *part, uint8_t byte);
+static void         _Patch_NextState            (void);
+#endif
+#if (IS_ENABLE_RESUME_TRANSFER)
+static FM_ERR_CODE  _Journal_Write              (const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size);
+static FM_ERR_CODE  _Journal_Load               (const struct FLASH_OBJECT *part, struct JOURNAL_RECORD *record, uint16_t *slot);
+static FM_ERR_CODE  _Journal_Append             (const struct FLASH_OBJECT *part, uint32_t offset);
+static FM_ERR_CODE  _Journal_VerifyBody         (const struct FLASH_OBJECT *part, uint32_t size, uint32_t body_crc);
+static FM_ERR_CODE  _Journal_EraseTail          (const struct FLASH_OBJECT *part, uint32_t addr);
+#endif
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+static FM_ERR_CODE  _EraseAPPByCompare          (const char *from_part_name);
+static FM_ERR_CODE  _Incr_Compare               (const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size);
+static int          _Incr_Write                 (const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size);
+static FM_ERR_CODE  _Incr_CheckTail             (const struct FLASH_OBJECT *part, uint32_t addr);
+static FM_ERR_CODE  _Incr_EraseDirty            (const struct FLASH_OBJECT *part);
+#endif
+#if (ENABLE_STREAM_VERIFY)
+static void         _Stream_Start               (const struct FLASH_OBJECT *part, bool is_app_part);
+static void         _Stream_Update              (const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size);
+static bool         _Stream_GetBodyCRC          (const struct FLASH_OBJECT *part, uint32_t body_addr, uint32_t body_size, uint32_t *body_crc);
+#endif
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+static FM_ERR_CODE  _Write_Check                (const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size);
+    #if (ENABLE_ASYNC_FLASH)
+    static int      _Write_CheckDone            (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t crc);
+    #endif
+#endif
+static struct ERASE_EXTENT * _Extent_Get        (const struct FLASH_OBJECT *part, const char *part_name);
+static uint32_t     _Extent_GetNeed             (const struct ERASE_EXTENT *extent, uint32_t size);
+static void         _Extent_Write               (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+static void         _Extent_Clean               (struct ERASE_EXTENT *extent, uint32_t size);
+static bool         _Extent_GetDirty            (const struct ERASE_EXTENT *extent, uint32_t need, uint32_t *addr, uint32_t *size);
+static const struct BSP_FLASH_GEOMETRY * _Erase_GetGeometry (const struct FLASH_OBJECT *part, uint32_t *base);
+static FM_ERR_CODE  _IsErased                   (const struct FLASH_OBJECT *part, 
+                                                 uint32_t addr, 
+                                                 uint32_t size, 
+                                                 uint8_t  *buff, 
+                                                 uint32_t buff_size);
+#if (ENABLE_ERASE_AHEAD)
+static uint32_t     _Erase_GetStep              (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t end);
+static FM_ERR_CODE  _Ahead_Step                 (bool is_tail);
+static FM_ERR_CODE  _Ahead_Ensure               (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+static void         _Ahead_Cancel               (const struct FLASH_OBJECT *part);
+#endif
+#if (ENABLE_ERASE_STATE)
+static void         _State_Load                 (void);
+static FM_ERR_CODE  _State_Append               (uint8_t index, uint32_t begin, uint32_t end, bool is_writing);
+static FM_ERR_CODE  _State_Write                (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+static void         _State_Save                 (const struct FLASH_OBJECT *part);
+#endif
+#if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT)
+static FM_ERR_CODE  _Version_GetRelay           (const struct FLASH_OBJECT *part, 
+                                                 const struct ERASE_EXTENT *extent, 
+                                                 uint32_t need, 
+                                                 uint32_t *head_size, 
+                                                 uint32_t *relay, 
+                                                 uint32_t *relay_size);
+static void         _Version_Patch              (uint8_t *buf);
+static FM_ERR_CODE  _Version_Erase              (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+static FM_ERR_CODE  _Version_Copy               (const struct FLASH_OBJECT *part, uint32_t dst, uint32_t src, uint32_t size);
+#endif
+#if (ENABLE_ASYNC_FLASH)
+static FM_ERR_CODE  _Async_Result               (const struct FLASH_OBJECT *part);
+static void         _Async_Discard              (FA_OP op, const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+#endif
+static FM_ERR_CODE  _IsEmpty                    (const char *part_name);
+static FM_ERR_CODE  _VerifyFirmware             (const char *part_name, uint32_t crc32, bool is_auto_fill);
+static FM_ERR_CODE  _EraseFirmware              (const char *part_name);
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+static FM_ERR_CODE  _UpdateToAPP                (const char *from_part_name);
+#endif
 
 
 /* Exported functions ---------------------------------------------------------*/
@@ -122,7 +551,7 @@ static void         _Reset_Write                (void);
  */
 void FM_Init(void)
 {
-    _CRC32_Init(CRC32_POLYNOMIAL);
+    CRC_Init();
     
 #if (IS_ENABLE_SPI_FLASH)
     /* FAL 初始化 */
@@ -136,6 +565,9 @@ void FM_Init(void)
         BSP_Flash_Init(&_flash_factory_part, FACTORY_PART_NAME, FACTORY_ADDRESS, FACTORY_PART_SIZE);
         #endif
     #endif
+    #if (ENABLE_ERASE_STATE)
+    BSP_Flash_Init(&_flash_state_part, ERASE_STATE_PART_NAME, ERASE_STATE_ADDRESS, ERASE_STATE_SIZE);
+    #endif
     
     BSP_Printf("app addr: 0x%.8X\r\n", _flash_app_part.addr);
     #if (USING_PART_PROJECT > ONE_PART_PROJECT)
@@ -146,6 +578,18 @@ void FM_Init(void)
     #endif
 #endif
 
+    _Check_FlashCaps();
+
+#if (ENABLE_ASYNC_FLASH)
+    FA_Init(_Async_Discard);
+#endif
+
+#if (ENABLE_ERASE_STATE)
+    _State_Load();
+#endif
+
+    _Check_FlashLayout();
+
 #if (ENABLE_DECRYPT)
     AES_init_ctx_iv(&_aes_ctx, (uint8_t *)AES256_KEY, (uint8_t *)AES256_IV);
 #endif
@@ -168,55 +612,50 @@ inline bool FM_IsEncrypt(void)
 }
 
 
+/**
+ * @brief  固件包是否有压缩
+ * @note   调用前需确保 _fpk_head 已经读入了数据
+ * @retval false: 无压缩 | true: 压缩
+ */
+inline bool FM_IsCompress(void)
+{
+    /* 读取压缩选项 */
+    if (_fpk_head.config[2] & 0x01)
+        return true;
+    return false;
+}
+
+
+/**
+ * @brief  是否为差分固件包
+ * @note   调用前需确保 _fpk_head 已经读入了数据
+ * @retval false: 完整的固件包 | true: 差分固件包
+ */
+inline bool FM_IsDelta(void)
+{
+    /* 读取差分选项 */
+    if (_fpk_head.config[2] & 0x02)
+        return true;
+    return false;
+}
+
+
 /**
  * @brief  检测某个分区是否为空
- * @note   FM_ERR_OK: 分区数据空
+ * @note   1. FM_ERR_OK: 分区数据空
+ *         2. 只检测 _fpk_head 对应的固件占用的范围和分区末尾的记录，调用前需确保 _fpk_head 已经读入了数据
  * @param[in]  part_name: 分区名
  * @retval FM_ERR_CODE
  */
 FM_ERR_CODE  FM_IsEmpty(const char *part_name)
 {
-    int read_len = 0;
-    uint16_t need_read_size = FPK_LEAST_HANDLE_BYTE;
-    uint32_t *p_data = (uint32_t *)_fpk_min_handle_buff;
-    uint32_t read_posit = 0;
-    
-    ASSERT(part_name != NULL);
-        
-    const struct FLASH_OBJECT *part = NULL;
-    
-    part = GET_FLASH_OBJECT(part_name);
-    if (part == NULL)
-    {
-        BSP_Printf("%s: %s not found.\r\n", __func__, part_name);
-        return FM_ERR_NO_THIS_PART;
-    }
-    
-    for (read_posit = 0; read_posit < part->len; )
-    {
-        if ((part->len - read_posit) < FPK_LEAST_HANDLE_BYTE)
-            need_read_size = part->len - read_posit;
+    FM_ERR_CODE result;
 
-        read_len = FLASH_PART_READ(part, read_posit, _fpk_min_handle_buff, need_read_size);
-        if (read_len < 0)
-        {
-            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
-            return FM_ERR_READ_IS_EMPTY_ERR;
-        }
-        
-        for (uint16_t i = 0; i < (FPK_LEAST_HANDLE_BYTE / sizeof(p_data)); i++)
-        {
-            if (p_data[i] != 0xFFFFFFFF)
-            {
-                BSP_Printf("%s: %s part no empty\r\n", __func__, part_name);
-                return FM_ERR_FLASH_NO_EMPTY;
-            }
-        }
-        read_posit += read_len;
-    }
-    
-    BSP_Printf("%s: %s part empty\r\n", __func__, part_name);
-    return FM_ERR_OK;
+    PERF_STATS_BEGIN(PERF_FM_IS_EMPTY);
+    result = _IsEmpty(part_name);
+    PERF_STATS_END(PERF_FM_IS_EMPTY);
+
+    return result;
 }
 
 
@@ -244,7 +683,8 @@ inline uint32_t FM_GetRawCRC32(void)
 
 /**
  * @brief  暂存固件包头
- * @note   会同时校验固件包头
+ * @note   1. 会同时校验固件包头
+ *         2. 修改固件版本需要中转首个 sector 时，固件之后没有足够的空闲 sector 则返回 FM_ERR_FIRMWARE_OVERSIZE
  * @param[in]  part_name: 分区名
  * @param[in]  data: 数据
  * @retval FM_ERR_CODE
@@ -270,6 +710,14 @@ FM_ERR_CODE  FM_StorageFirmwareHead(const char *part_name, uint8_t *data)
     }
 #endif
 
+    /* 若固件包压缩，检查是否有解压组件以及解压窗口是否足够 */
+    if (_Check_Compress() != FM_ERR_OK)
+        return FM_ERR_NO_DECOMPRESS_COMPONENT;
+
+    /* 若为差分固件包，检查是否能还原 */
+    if (_Check_Delta() != FM_ERR_OK)
+        return FM_ERR_NO_DELTA_COMPONENT;
+
     part = GET_FLASH_OBJECT(part_name);
     if (part == NULL)
     {
@@ -285,6 +733,29 @@ FM_ERR_CODE  FM_StorageFirmwareHead(const char *part_name, uint8_t *data)
     ||  (_fpk_head.raw_size > part->len))
         return FM_ERR_FIRMWARE_OVERSIZE;
 
+    /* 差分固件包还原后存放的是完整的固件包 */
+    if (FM_IsDelta() && (_fpk_head.raw_size + FPK_HEAD_SIZE > part->len))
+        return FM_ERR_FIRMWARE_OVERSIZE;
+
+#if (IS_ENABLE_RESUME_TRANSFER)
+    /* download 分区末尾存放进度记录 */
+    if (strncmp(part_name, DOWNLOAD_PART_NAME, MAX_NAME_LEN) == 0
+    &&  ((FM_IsDelta() ? _fpk_head.raw_size : _fpk_head.pkg_size) + FPK_HEAD_SIZE > part->len - RESUME_JOURNAL_SIZE))
+        return FM_ERR_FIRMWARE_OVERSIZE;
+#endif
+
+#if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT)
+    /* 更新版本信息时需要中转首个 sector 的分区，在擦写前确认固件之后留有中转的空闲 sector */
+    if (strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) != 0)
+    {
+        struct ERASE_EXTENT *extent = _Extent_Get(part, part_name);
+        uint32_t head_size, relay, relay_size;
+
+        if (_Version_GetRelay(part, extent, _Extent_GetNeed(extent, 0), &head_size, &relay, &relay_size) != FM_ERR_OK)
+            return FM_ERR_FIRMWARE_OVERSIZE;
+    }
+#endif
+
     /* 校验固件包头数据的正确性 */
     head_crc = _CRC32_Calc(p_fpk_head, FPK_HEAD_SIZE - 4);
     if (head_crc != _fpk_head.head_crc)
@@ -306,12 +777,18 @@ FM_ERR_CODE  FM_StorageFirmwareHead(const char *part_name, uint8_t *data)
     BSP_Printf("pkg_crc: %.8X\r\n", _fpk_head.pkg_crc);
     BSP_Printf("head_crc: %.8X\r\n", _fpk_head.head_crc);
     
-    /* 计算固件更新进度的最小单位，降低过程计算量，无更新进度需求可删除 */
+    /* 计算固件更新进度的最小单位，降低过程计算量，无更新进度需求可删除。压缩时按固件包的大小计算 */
     _update_progress_step_num  = _fpk_head.pkg_size / FPK_LEAST_HANDLE_BYTE;
     _update_progress_step_num += _fpk_head.pkg_size % FPK_LEAST_HANDLE_BYTE;
     _update_progress_step_num  = 10000 / _update_progress_step_num;
     BSP_Printf("%s: progress unit: %d\r\n", __func__, _update_progress_step_num);
 
+#if (ENABLE_DECRYPT)
+    /* 单分区方案和差分固件包在接收时解密，每次接收固件包都需要对 AES 进行初始化 */
+    if (FM_IsEncrypt())
+        AES_init_ctx_iv(&_aes_ctx, (uint8_t *)AES256_KEY, (uint8_t *)AES256_IV);
+#endif
+
     return FM_ERR_OK;
 }
 
@@ -326,137 +803,152 @@ FM_ERR_CODE  FM_StorageFirmwareHead(const char *part_name, uint8_t *data)
  */
 FM_ERR_CODE  FM_VerifyFirmware(const char *part_name, uint32_t crc32, bool is_auto_fill)
 {
-    int      read_len = 0;
-    bool     is_app_part = false;
-    uint32_t pkg_size = 0;
-    uint32_t body_crc = 0xFFFFFFFF;
-    uint32_t read_posit = 0;
-    uint32_t read_posit_temp = 0;
-    uint16_t need_read_size = FPK_LEAST_HANDLE_BYTE;
-#if (USING_PART_PROJECT > ONE_PART_PROJECT)
-    bool is_first = false;
+    FM_ERR_CODE result;
+
+    PERF_STATS_BEGIN(PERF_FM_VERIFY_FIRMWARE);
+    result = _VerifyFirmware(part_name, crc32, is_auto_fill);
+    PERF_STATS_END(PERF_FM_VERIFY_FIRMWARE);
+
+    return result;
+}
+
+
+/**
+ * @brief  擦除某个分区的固件
+ * @note   只擦除 _fpk_head 对应的固件占用的范围中可能有数据的部分和分区末尾的记录，调用前需确保 _fpk_head 已经读入了数据
+ * @param[in]  part_name: 分区名称
+ * @retval FM_ERR_CODE
+ */
+FM_ERR_CODE  FM_EraseFirmware(const char *part_name)
+{
+    FM_ERR_CODE result;
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    /* APP 分区已擦除，之后需全部写入 */
+    if (strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) == 0)
+        _incr.mode = INCR_MODE_NONE;
 #endif
-    const struct FLASH_OBJECT *part = NULL;
-    
+
+    PERF_STATS_BEGIN(PERF_FM_ERASE_FIRMWARE);
+    result = _EraseFirmware(part_name);
+    PERF_STATS_END(PERF_FM_ERASE_FIRMWARE);
+
+    return result;
+}
+
+
+#if (ENABLE_ERASE_AHEAD)
+/**
+ * @brief  在接收固件包时擦除某个分区的固件
+ * @note   1. 只记录需擦除的范围，写入前擦除写入位置所在的块，其余的块由 FM_EraseAheadProcess 在等待主机数据时擦除
+ *         2. size 为 0 时按 _fpk_head 对应的固件，调用前需确保 _fpk_head 已经读入了数据
+ *         3. size 不为 0 时为主机预告的固件包大小，用于收到固件包头之前预先擦除。
+ *            分区中有未接收完毕的进度记录时不擦除，保留给断点续传
+ *         4. 擦除范围与 FM_EraseFirmware 相同，按 ERASE_ALIGN_SIZE 分块。移植文件提供 sector 布局时按擦除计划对齐到实际的
+ *            sector 或块，否则 flash 的擦除粒度不能大于 ERASE_ALIGN_SIZE
+ * @param[in]  part_name: 分区名称
+ * @param[in]  size: 固件包的大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+FM_ERR_CODE  FM_EraseFirmwareAhead(const char *part_name, uint32_t size)
+{
     ASSERT(part_name != NULL);
 
-#if (ENABLE_DECRYPT == 0)
-    /* 若固件包加密，检查是否有解密组件 */
-    if (FM_IsEncrypt())
-    {
-        BSP_Printf("%s: no decrypt component\r\n", __func__);
-        return FM_ERR_NO_DECRYPT_COMPONENT;
-    }
-#endif
+    uint32_t addr = 0;
+    uint32_t len  = 0;
+    uint32_t need = 0;
+    struct ERASE_EXTENT *extent = NULL;
+    const struct FLASH_OBJECT *part = NULL;
 
-    if (strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) == 0)
-        is_app_part = true;
-     
     part = GET_FLASH_OBJECT(part_name);
     if (part == NULL)
     {
-        BSP_Printf("%s: not found.\r\n", __func__);
+        BSP_Printf("%s: not found %s part.\r\n", __func__, part_name);
         return FM_ERR_NO_THIS_PART;
     }
 
-    BSP_Printf("fpk size: %d byte\r\n", FPK_HEAD_SIZE);
-    for (uint8_t i = 0; i < 6; i++)
+#if (IS_ENABLE_RESUME_TRANSFER)
+    if (size && strncmp(part_name, DOWNLOAD_PART_NAME, MAX_NAME_LEN) == 0)
     {
-        uint8_t *p = (uint8_t *)&_fpk_head;
-        for (uint8_t j = 0; j < FPK_HEAD_SIZE / 6; j++)
-            BSP_Printf("%.2X ", p[(i * (FPK_HEAD_SIZE / 6)) + j]);
-        BSP_Printf("\r\n");
+        uint16_t slot = 0;
+        struct JOURNAL_RECORD record = {0};
+
+        if (_Journal_Load(part, &record, &slot) == FM_ERR_OK
+        &&  record.offset != 0
+        &&  record.offset != JOURNAL_DONE_OFFSET)
+        {
+            BSP_Printf("%s: %s part has journal, keep it\r\n", __func__, part_name);
+            return FM_ERR_OK;
+        }
     }
-    BSP_Printf("%s: part name %s\r\n", __func__, part_name);
-    
-    if (is_app_part)
-        pkg_size = _fpk_head.raw_size;
-    else
-        pkg_size = _fpk_head.pkg_size;
-    BSP_Printf("pkg_size %d\r\n", pkg_size);
-    
-    /* 校验固件包体的数据正确性 */
-    for (; read_posit < pkg_size; )
-    {
-        /* 剩余的数据数小于最小处理单位时，按剩余字节数处理 */
-        if ((pkg_size - read_posit) < FPK_LEAST_HANDLE_BYTE)
-            need_read_size = pkg_size - read_posit;
-        
-        /* 非 APP 分区，需要偏移包头的地址才是包体 */
-        if (is_app_part)
-            read_posit_temp = read_posit;
-        else
-            read_posit_temp = read_posit + FPK_HEAD_SIZE;
+#endif
 
-        read_len = FLASH_PART_READ(part, read_posit_temp, &_fpk_min_handle_buff[0], need_read_size);
-        if (read_len < 0)
-        {
-            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
-            return FM_ERR_VERIFY_READ_ERR;
-        }
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    /* APP 分区将被擦除，之后需全部写入 */
+    if (strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) == 0)
+        _incr.mode = INCR_MODE_NONE;
+#endif
 
-    #if (USING_PART_PROJECT > ONE_PART_PROJECT)
-        if (is_auto_fill)
-        {
-            if (is_first == false)
-            {
-                is_first = true;
-                BSP_Printf("_fw_first_bytes: ");
-                for (uint8_t i = 0; i < ONCHIP_FLASH_ONCE_WRITE_BYTE; i++)
-                {
-                    _fpk_min_handle_buff[i] = _fw_first_bytes[i];
-                    BSP_Printf("%.2X ", _fw_first_bytes[i]);
-                }
-                BSP_Printf("\r\n");
-            }
-        }
-    #endif
+#if (ENABLE_STREAM_VERIFY)
+    /* 分区将被擦除，累加的 CRC32 不再对应分区中的数据 */
+    if (part == _stream.part)
+        _stream.part = NULL;
+#endif
 
-        body_crc = _CRC32_StepCalc(body_crc, &_fpk_min_handle_buff[0], read_len);
-        read_posit += read_len;
-    }
-    body_crc ^= 0xFFFFFFFF;
-    
-    if (body_crc != crc32)
+    extent = _Extent_Get(part, part_name);
+    need   = _Extent_GetNeed(extent, size);
+
+    /* 擦除范围之外的已写入数据并入遗留的数据，擦除范围本身在擦除前仍按遗留的数据处理 */
+    if (_Extent_GetDirty(extent, need, &addr, &len) == false)
+        addr = len = 0;
+    _Extent_Clean(extent, need);
+    if (len)
     {
-        BSP_Printf("%s: body crc verify failed. (%.8X - %.8X)\r\n", __func__, crc32, body_crc);
-        if (is_app_part)
-            return FM_ERR_RAW_BODY_VERIFY_ERR;
-        else
-            return FM_ERR_PKG_BODY_VERIFY_ERR;
+        if (extent->stale_begin >= extent->stale_end)
+            extent->stale_end = addr + len;
+        extent->stale_begin = addr;
     }
-    
+
+    _ahead.extent  = extent;
+    _ahead.next    = addr;
+    _ahead.end     = addr + len;
+    _ahead.is_tail = (extent->limit < part->len);
+    BSP_Printf("%s: %s part erase ahead 0x%.8X ~ 0x%.8X\r\n", __func__, part_name, addr, addr + len);
+
     return FM_ERR_OK;
 }
 
 
 /**
- * @brief  擦除某个分区的固件
- * @note   
- * @param[in]  part_name: 分区名称
+ * @brief  接收固件包时的后台擦除
+ * @note   1. 每次调用最多擦除一个块，应在等待主机数据时调用，擦除期间 Firmware_OperateCallback 仍会处理主机数据
+ *         2. 失败时保留未擦除的范围，由写入前的擦除返回错误
  * @retval FM_ERR_CODE
  */
-FM_ERR_CODE  FM_EraseFirmware(const char *part_name)
+FM_ERR_CODE  FM_EraseAheadProcess(void)
 {
-    ASSERT(part_name != NULL);
+    FM_ERR_CODE result = FM_ERR_OK;
 
-    const struct FLASH_OBJECT *part = NULL;
-    
-    part = GET_FLASH_OBJECT(part_name);
-    if (part == NULL)
-    {
-        BSP_Printf("%s: not found %s part.\r\n", __func__, part_name);
-        return FM_ERR_NO_THIS_PART;
-    }
-    
-    if (FLASH_PART_ERASE(part, 0, part->len) < 0)
-    {
-        BSP_Printf("%s: %s part erase failed.\r\n", __func__, part_name);
-        return FM_ERR_ERASE_PART_ERR;
-    }  
-    
-    return FM_ERR_OK;
+    if (_ahead.extent == NULL)
+        return FM_ERR_OK;
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 上一个块尚未擦除完毕时不再排队，以免占满擦写队列 */
+    if (FA_IsBusy(_ahead.extent->part))
+        return FM_ERR_OK;
+#endif
+
+    if (_ahead.next < _ahead.end)
+        result = _Ahead_Step(false);
+    else if (_ahead.is_tail)
+        result = _Ahead_Step(true);
+
+    if (_ahead.next >= _ahead.end && _ahead.is_tail == false)
+        _ahead.extent = NULL;
+
+    return result;
 }
+#endif
 
 
 /**
@@ -478,11 +970,53 @@ FM_ERR_CODE  FM_WriteFirmwareDone(const char *part_name)
         return FM_ERR_NO_THIS_PART;
     }
 
+#if (ENABLE_ERASE_AHEAD)
+    /* 擦除余下的范围和分区末尾的记录，与接收前擦除整个范围的结果一致 */
+    if (_ahead.extent)
+    {
+        FM_ERR_CODE result = _Ahead_Ensure(part, 0, part->len);
+        _Ahead_Cancel(part);
+        if (result != FM_ERR_OK)
+            return result;
+    }
+#endif
+
+#if (ENABLE_ERASE_STATE)
+    if (_State_Write(part, 0, ONCHIP_FLASH_ONCE_WRITE_BYTE) != FM_ERR_OK)
+        return FM_ERR_WRITE_FIRST_ADDR_ERR;
+#endif
+
     if (FLASH_PART_WRITE(part, 0, _fw_first_bytes, ONCHIP_FLASH_ONCE_WRITE_BYTE) < 0)
     {
         BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
         return FM_ERR_WRITE_FIRST_ADDR_ERR;
     }
+    _Extent_Write(part, 0, ONCHIP_FLASH_ONCE_WRITE_BYTE);
+
+#if (IS_ENABLE_RESUME_TRANSFER)
+    /* 固件包已接收完毕，之后不能再续传 */
+    if (_journal.is_enable && _Journal_Append(part, JOURNAL_DONE_OFFSET) != FM_ERR_OK)
+    {
+        BSP_Printf("%s: write journal error (%d).\r\n", __func__, __LINE__);
+        return FM_ERR_WRITE_PART_ERR;
+    }
+#endif
+
+#if (IS_ENABLE_DELTA_UPDATE)
+    /* 差分固件包已还原，之后按还原后的固件包进行校验和更新 */
+    if (FM_IsDelta())
+        _Delta_ConvertHead(&_fpk_head);
+#endif
+
+#if (ENABLE_STREAM_VERIFY)
+    /* 包体已写入完毕，之后校验时直接使用累加的 CRC32 */
+    if (part == _stream.part)
+        _stream.is_done = true;
+#endif
+#if (ENABLE_ERASE_STATE)
+    /* 写入已结束，按实际写入的范围重新记录 */
+    _State_Save(part);
+#endif
     
     _Reset_Write();
     Firmware_OperateCallback(10000);
@@ -493,7 +1027,8 @@ FM_ERR_CODE  FM_WriteFirmwareDone(const char *part_name)
 
 /**
  * @brief  将固件分包按顺序写入分区
- * @note   由于固件包头已经写入，这里写入的是固件包体，需要注意在 flash 的偏移位置
+ * @note   1. 由于固件包头已经写入，这里写入的是固件包体，需要注意在 flash 的偏移位置
+ *         2. 启用 ENABLE_ASYNC_FLASH 时擦写队列的空间不足则不写入并返回 FM_ERR_BUSY ，需以同一数据包再次调用
  * @param[in]  part_name: 分区名称
  * @param[in]  data: 数据包
  * @param[in]  pkg_size: 数据包大小，单位 byte
@@ -513,7 +1048,32 @@ FM_ERR_CODE  FM_WriteFirmwareSubPackage(const char *part_name, uint8_t *data, ui
         BSP_Printf("%s: not found %s part.\r\n", __func__, part_name);
         return FM_ERR_NO_THIS_PART;
     }
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 之前排队的擦写失败时返回错误。队列的空间不足时先不写入，由调用者再次调用 */
+    if (FA_GetStatus(NULL) >= FA_STATUS_ERASE_ERR)
+        return _Async_Result(NULL);
+    if (FA_IsAvailable(pkg_size) == false)
+    {
+        FA_Process();
+        return FM_ERR_BUSY;
+    }
+#endif
     BSP_Printf("%s: %s part\r\n", __func__, part_name);
+
+#if (ENABLE_STREAM_VERIFY)
+    /* 写入首个分包时开始累加包体的 CRC32 */
+    if (_is_start_write == false)
+        _Stream_Start(part, strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) == 0);
+#endif
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+    /* 单分区方案直接写入 APP 分区 */
+    if (_is_start_write == false)
+    {
+        _write_check.part  = (strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) == 0)? part : NULL;
+        _write_check.count = 0;
+    }
+#endif
     
 #if (USING_PART_PROJECT == ONE_PART_PROJECT)
     bool is_decrypt = false;
@@ -523,6 +1083,25 @@ FM_ERR_CODE  FM_WriteFirmwareSubPackage(const char *part_name, uint8_t *data, ui
 
     return _Write_FirmwareSubPackage(part, data, pkg_size, is_decrypt, FM_DIR_HOST_TO_APP); /* 写入前解密 */
 #else
+    #if (IS_ENABLE_DELTA_UPDATE)
+    /* 差分固件包在接收时还原，写入的是还原后的固件包的包头，包体解密、解压后还原 */
+    if (FM_IsDelta())
+    {
+        if (_is_start_write == false)
+        {
+            struct FPK_HEAD head = _fpk_head;
+
+            _Delta_ConvertHead(&head);
+            return _Write_Flash(part, (uint8_t *)&head, FPK_HEAD_SIZE);
+        }
+        return _Write_FirmwareSubPackage(part, data, pkg_size, FM_IsEncrypt(), FM_DIR_HOST_TO_DOWNLOAD);
+    }
+    #endif
+    #if (IS_ENABLE_RESUME_TRANSFER)
+    /* 写入 download 分区时记录进度 */
+    if (strncmp(part_name, DOWNLOAD_PART_NAME, MAX_NAME_LEN) == 0)
+        return _Journal_Write(part, data, pkg_size);
+    #endif
     return _Write_FirmwareSubPackage(part, data, pkg_size, false, FM_DIR_HOST_TO_DOWNLOAD);  /* 写入前不解密 */
 #endif
 }
@@ -536,12 +1115,18 @@ FM_ERR_CODE  FM_WriteFirmwareSubPackage(const char *part_name, uint8_t *data, ui
  */
 FM_ERR_CODE  FM_CheckFirmwareIntegrity(uint32_t addr)
 {
-    uint32_t value = *(volatile uint32_t *)addr;
+    uint32_t value = 0;
     FM_ERR_CODE  fw_integrity = FM_ERR_JUMP_TO_APP_ERR;
 #if (IS_ENABLE_SPI_FLASH)
     uint32_t *data = NULL;
     const struct FLASH_OBJECT *part = NULL;
 #endif
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 直接按地址读取片内 flash ，需等待所有的擦写完成 */
+    FA_Sync(NULL);
+#endif
+    value = *(volatile uint32_t *)addr;
     
     BSP_Printf("0x%.8X address data: 0x%.8X\r\n", addr, value);
     
@@ -772,80 +1357,166 @@ FM_ERR_CODE  FM_ReadFirmwareHead(const char *part_name)
 
 /**
  * @brief  从某个分区将固件包更新至 APP 分区
- * @note   读取 -> 解密 -> 写入
+ * @note   1. 读取 -> 解密 -> 解压 -> 写入
+ *         2. 启用 ENABLE_ASYNC_FLASH 时未完成则返回 FM_ERR_BUSY ，需再次调用直至返回其他值
  * @param[in]  from_part_name: 放置需要更新至 APP 分区的固件包的分区
  * @retval FM_ERR_CODE
  */
 FM_ERR_CODE  FM_UpdateToAPP(const char *from_part_name)
 {
-    ASSERT(from_part_name != NULL);
+    FM_ERR_CODE result;
 
-    int      read_len = 0;
-    bool     is_decrypt = false;
-    uint32_t read_posit = 0;
-    uint32_t write_posit = 0;
-    uint32_t need_read_size = FPK_LEAST_HANDLE_BYTE;
-    FM_ERR_CODE result = FM_ERR_OK;
-    const struct FLASH_OBJECT *app_part = NULL;
-    const struct FLASH_OBJECT *firmware_part = NULL;
-    
-    app_part = GET_FLASH_OBJECT(APP_PART_NAME);
-    if (app_part == NULL)
+    PERF_STATS_BEGIN(PERF_FM_UPDATE_TO_APP);
+    result = _UpdateToAPP(from_part_name);
+    PERF_STATS_END(PERF_FM_UPDATE_TO_APP);
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    /* 比较的结果只用于本次写入 */
+    if (result != FM_ERR_BUSY)
+        _incr.mode = INCR_MODE_NONE;
+#endif
+
+    return result;
+}
+
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+/**
+ * @brief  与 APP 分区的现有数据比较，只擦除有差异的块
+ * @note   1. 调用前需确保 _fpk_head 已经读入了数据
+ *         2. 之后调用 FM_UpdateToAPP 时只写入有差异的块，相同的块保持不变
+ * @param[in]  from_part_name: 放置需要更新至 APP 分区的固件包的分区
+ * @retval FM_ERR_CODE
+ */
+FM_ERR_CODE  FM_EraseAPPByCompare(const char *from_part_name)
+{
+    FM_ERR_CODE result;
+
+    PERF_STATS_BEGIN(PERF_FM_ERASE_APP_BY_COMPARE);
+    result = _EraseAPPByCompare(from_part_name);
+    PERF_STATS_END(PERF_FM_ERASE_APP_BY_COMPARE);
+
+    return result;
+}
+#endif
+
+
+#if (IS_ENABLE_RESUME_TRANSFER)
+/**
+ * @brief  按进度记录恢复固件包的写入
+ * @note   1. 调用前需确保 _fpk_head 已经读入了数据
+ *         2. 进度记录与本固件包一致、分区中的固件包头一致且已写入的包体数据校验通过时，恢复写入的状态，
+ *            之后的 FM_WriteFirmwareSubPackage 从记录的位置继续写入，无需擦除分区和写入固件包头
+ *         3. 返回 FM_ERR_OK 以外的值时，需按新的固件包擦除分区后重新写入
+ * @param[in]   part_name: 分区名称
+ * @param[out]  offset: 续传的位置，即已写入的包体数据量，单位 byte
+ * @retval FM_ERR_CODE
+ */
+FM_ERR_CODE  FM_ResumeFirmware(const char *part_name, uint32_t *offset)
+{
+    ASSERT(part_name != NULL);
+    ASSERT(offset != NULL);
+
+    uint16_t    slot = 0;
+    FM_ERR_CODE result;
+    struct JOURNAL_RECORD record = {0};
+    const struct FLASH_OBJECT *part = NULL;
+
+    *offset = 0;
+
+    /* 差分固件包在接收时还原，无法从中途继续 */
+    if (FM_IsDelta() || strncmp(part_name, DOWNLOAD_PART_NAME, MAX_NAME_LEN) != 0)
+        return FM_ERR_NO_RESUME_JOURNAL;
+
+    part = GET_FLASH_OBJECT(part_name);
+    if (part == NULL)
     {
-        BSP_Printf("%s: not found APP part.\r\n", __func__);
+        BSP_Printf("%s: not found %s part.\r\n", __func__, part_name);
         return FM_ERR_NO_THIS_PART;
     }
-    
-    firmware_part = GET_FLASH_OBJECT(from_part_name);
-    if (firmware_part == NULL)
+
+#if (ENABLE_ERASE_AHEAD)
+    /* 续传时不擦除，之后未写入的数据由 _Journal_EraseTail 处理 */
+    _Ahead_Cancel(part);
+#endif
+
+    result = _Journal_Load(part, &record, &slot);
+    if (result != FM_ERR_OK)
+        return result;
+
+    /* 只写入了固件包头时，与重新接收相同 */
+    if (record.head_crc != _fpk_head.head_crc
+    ||  record.offset   == 0
+    ||  record.offset   == JOURNAL_DONE_OFFSET
+    ||  record.offset   >  part->len - RESUME_JOURNAL_SIZE - FPK_HEAD_SIZE
+    || (record.offset + FPK_HEAD_SIZE) % FPK_LEAST_HANDLE_BYTE)
     {
-        BSP_Printf("%s: not found %s part.\r\n", __func__, from_part_name);
-        return FM_ERR_NO_THIS_PART;
+        BSP_Printf("%s: journal mismatch\r\n", __func__);
+        return FM_ERR_NO_RESUME_JOURNAL;
     }
 
-    _Reset_Write();
-    BSP_Printf("%s: from %s part write to APP\r\n", __func__, from_part_name);
-
-    /* 读取加密选项 */
-    is_decrypt = FM_IsEncrypt();
+    /* 分区中的固件包头需与本固件包一致，首地址的几个字节在接收完毕后才写入，应仍为擦除状态 */
+    if (FLASH_PART_READ(part, 0, _fpk_min_handle_buff, FPK_HEAD_SIZE) < 0)
+    {
+        BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+        return FM_ERR_READ_FLASH_ERR;
+    }
 
-#if (ENABLE_DECRYPT)
-    /* 当有固件包需要刷入 APP 分区时，每次都需要对 AES 进行初始化，存在 AES 库已被其它函数使用的情况 */
-    if (is_decrypt)
-        AES_init_ctx_iv(&_aes_ctx, (uint8_t *)AES256_KEY, (uint8_t *)AES256_IV);
-#endif
+    for (uint8_t i = 0; i < ONCHIP_FLASH_ONCE_WRITE_BYTE; i++)
+    {
+        if (_fpk_min_handle_buff[i] != 0xFF)
+            return FM_ERR_NO_RESUME_JOURNAL;
+    }
 
-    for (write_posit = 0; write_posit < _fpk_head.pkg_size; )
+    if (memcmp(&_fpk_min_handle_buff[ONCHIP_FLASH_ONCE_WRITE_BYTE], 
+               (uint8_t *)&_fpk_head + ONCHIP_FLASH_ONCE_WRITE_BYTE, 
+               FPK_HEAD_SIZE - ONCHIP_FLASH_ONCE_WRITE_BYTE) != 0)
     {
-        if ((_fpk_head.pkg_size - read_posit) < FPK_LEAST_HANDLE_BYTE)
-            need_read_size = _fpk_head.pkg_size - read_posit;
+        BSP_Printf("%s: head mismatch\r\n", __func__);
+        return FM_ERR_NO_RESUME_JOURNAL;
+    }
 
-        read_len = FLASH_PART_READ(firmware_part, (read_posit + FPK_HEAD_SIZE), _fpk_min_handle_buff, need_read_size);
-        if (read_len < 0)
-        {
-            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
-            return FM_ERR_UPDATE_READ_ERR;
-        }
+    /* 校验已写入的包体数据 */
+    result = _Journal_VerifyBody(part, record.offset, record.body_crc);
+    if (result != FM_ERR_OK)
+        return result;
 
-        result = _Write_FirmwareSubPackage(app_part, _fpk_min_handle_buff, read_len, is_decrypt, FM_DIR_DOWNLOAD_TO_APP);
-        if (result)
-        {
-            BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
-            return result;
-        }
+    result = _Journal_EraseTail(part, FPK_HEAD_SIZE + record.offset);
+    if (result != FM_ERR_OK)
+        return result;
+
+    /* 恢复至已写入固件包头和 offset byte 包体的状态 */
+    _Reset_Write();
+    memcpy(_fw_first_bytes, &_fpk_head, ONCHIP_FLASH_ONCE_WRITE_BYTE);
+    _is_start_write    = true;
+    _write_part_addr   = FPK_HEAD_SIZE + record.offset;
+    _handle_size       = FPK_HEAD_SIZE + record.offset;
+    _update_progress   = (_handle_size / FPK_LEAST_HANDLE_BYTE) * _update_progress_step_num;
+    _journal.is_enable = true;
+    _journal.slot      = slot;
+    _journal.offset    = record.offset;
+    _journal.body_crc  = record.body_crc;
+#if (ENABLE_STREAM_VERIFY)
+    /* 已写入的包体数据刚校验过，从记录的 CRC32 中间值继续累加 */
+    _Stream_Start(part, false);
+    _stream.next_addr  = _write_part_addr;
+    _stream.body_crc   = record.body_crc;
+#endif
+
+    *offset = record.offset;
+    BSP_Printf("%s: resume from %d byte\r\n", __func__, record.offset);
 
-        read_posit  += read_len;
-        write_posit += read_len;
-    }
-    
     return FM_ERR_OK;
 }
+#endif
 
 
 #if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT)
 /**
  * @brief  更新固件包中的版本信息
- * @note   
+ * @note   1. 分区首个 sector 不大于 FPK_LEAST_HANDLE_BYTE 时整个读入 _fpk_min_handle_buff ，修改后擦除并写回
+ *         2. sector 更大时（如 STM32F4 的 16/64/128 Kbyte ）经分区中固件之后的空闲 sector 中转：分块复制首个 sector 并修改版本，
+ *            擦除首个 sector 后再分块复制回来。中转的空间在 FM_StorageFirmwareHead 校验固件包头时已确认
  * @param[in]  part_name: 分区名称
  * @retval FM_ERR_CODE
  */
@@ -853,13 +1524,11 @@ FM_ERR_CODE  FM_UpdateFirmwareVersion(const char *part_name)
 {
     ASSERT(part_name != NULL);
 
-#if (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH)
-    const uint32_t earse_unit = SPI_FLASH_ERASE_GRANULARITY;
-#else
-    const uint32_t earse_unit = ONCHIP_FLASH_ERASE_GRANULARITY;
-#endif
-
-    /* 将 download 分区首地址的数据读出，长度为片内 flash 最小擦除粒度 */
+    uint32_t head_size = 0;
+    uint32_t relay = 0;
+    uint32_t relay_size = 0;
+    FM_ERR_CODE result = FM_ERR_OK;
+    struct ERASE_EXTENT *extent = NULL;
     const struct FLASH_OBJECT *part = NULL;
     
     part = GET_FLASH_OBJECT(part_name);
@@ -868,234 +1537,2689 @@ FM_ERR_CODE  FM_UpdateFirmwareVersion(const char *part_name)
         BSP_Printf("%s: not found.\r\n", __func__);
         return FM_ERR_NO_THIS_PART;
     }
-    
-    if (FLASH_PART_READ(part, 0, &_fpk_min_handle_buff[0], earse_unit) < 0)
+
+    /* 读出固件包头，确定固件占用的范围 */
+    if (FLASH_PART_READ(part, 0, (uint8_t *)&_fpk_head, FPK_HEAD_SIZE) < 0)
     {
         BSP_Printf("%s: read error.\r\n", __func__);
         return FM_ERR_UPDATE_VER_READ_ERR;
     }
 
-    /* 修改固件包头中旧版本字段的版本信息为新的固件版本 */
-    struct FPK_HEAD *p_pkg_head = (struct FPK_HEAD *)&_fpk_min_handle_buff[0];
-
-    p_pkg_head->fw_old_ver[0] = p_pkg_head->fw_new_ver[0];
-    p_pkg_head->fw_old_ver[1] = p_pkg_head->fw_new_ver[1];
-    p_pkg_head->fw_old_ver[2] = p_pkg_head->fw_new_ver[2];
-    p_pkg_head->fw_old_ver[3] = p_pkg_head->fw_new_ver[3];
+    extent = _Extent_Get(part, part_name);
+    if (_Version_GetRelay(part, extent, _Extent_GetNeed(extent, 0), &head_size, &relay, &relay_size) != FM_ERR_OK)
+        return FM_ERR_UPDATE_VER_ERASE_ERR;
 
-    /* 将读出数据的区域擦除 */
-    if (FLASH_PART_ERASE(part, 0, earse_unit) < 0)
+    if (relay_size == 0)
     {
-        BSP_Printf("%s: %s part erase failed.\r\n", __func__, part_name);
-        return FM_ERR_UPDATE_VER_ERASE_ERR;
-    }
+        /* 将 download 分区首个 sector 的数据读出，修改固件包头中旧版本字段的版本信息为新的固件版本 */
+        if (FLASH_PART_READ(part, 0, &_fpk_min_handle_buff[0], head_size) < 0)
+        {
+            BSP_Printf("%s: read error.\r\n", __func__);
+            return FM_ERR_UPDATE_VER_READ_ERR;
+        }
+        _Version_Patch(&_fpk_min_handle_buff[0]);
+
+        /* 将读出数据的区域擦除，再将新的数据写入擦除的区域 */
+        result = _Version_Erase(part, 0, head_size);
+        if (result != FM_ERR_OK)
+            return result;
 
-    /* 将新的数据写入擦除的区域 */ 
-    if (FLASH_PART_WRITE(part, 0, &_fpk_min_handle_buff[0], earse_unit) < 0)
+        if (FLASH_PART_WRITE(part, 0, &_fpk_min_handle_buff[0], head_size) < 0)
+        {
+            BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_UPDATE_VER_WRITE_ERR;
+        }
+        _Extent_Write(part, 0, head_size);
+    }
+    else
     {
-        BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
-        return FM_ERR_UPDATE_VER_WRITE_ERR;
+        result = _Version_Erase(part, relay, relay_size);
+        if (result == FM_ERR_OK)
+            result = _Version_Copy(part, relay, 0, head_size);
+        if (result == FM_ERR_OK)
+            result = _Version_Erase(part, 0, head_size);
+        if (result == FM_ERR_OK)
+            result = _Version_Copy(part, 0, relay, head_size);
+        if (result != FM_ERR_OK)
+            return result;
     }
 
-    memcpy((uint8_t *)&_fpk_head, &_fpk_min_handle_buff[0], FPK_HEAD_SIZE);
-    BSP_Printf("fw old ver: V%d.%d.%d.%d\r\n", p_pkg_head->fw_old_ver[0], p_pkg_head->fw_old_ver[1], p_pkg_head->fw_old_ver[2], p_pkg_head->fw_old_ver[3]);
-    BSP_Printf("fw new ver: V%d.%d.%d.%d\r\n", p_pkg_head->fw_new_ver[0], p_pkg_head->fw_new_ver[1], p_pkg_head->fw_new_ver[2], p_pkg_head->fw_new_ver[3]);
+    BSP_Printf("fw old ver: V%d.%d.%d.%d\r\n", _fpk_head.fw_old_ver[0], _fpk_head.fw_old_ver[1], _fpk_head.fw_old_ver[2], _fpk_head.fw_old_ver[3]);
+    BSP_Printf("fw new ver: V%d.%d.%d.%d\r\n", _fpk_head.fw_new_ver[0], _fpk_head.fw_new_ver[1], _fpk_head.fw_new_ver[2], _fpk_head.fw_new_ver[3]);
 
     return FM_ERR_OK;
 }
 
 
-#elif (USING_AUTO_UPDATE_PROJECT == VERSION_WRITE_TO_APP)
 /**
- * @brief  更新固件包中的版本信息
- * @note   
- * @param[in]  part_name: 分区名称
- * @retval FM_ERR_CODE
+ * @brief  获取更新版本信息时中转分区首个 sector 的范围
+ * @note   1. 分区首个 sector 不大于 FPK_LEAST_HANDLE_BYTE 时无须中转， relay_size 为 0
+ *         2. 中转的 sector 从固件占用范围之后的第一个 sector 开始，不能超过分区末尾的记录
+ *         3. 移植文件不提供 sector 布局时按均匀的擦除粒度处理
+ * @param[in]  part: 分区对象
+ * @param[in]  extent: 分区可能有数据的范围
+ * @param[in]  need: 固件占用的长度，单位 byte
+ * @param[out] head_size: 分区首个 sector 的尺寸，单位 byte
+ * @param[out] relay: 中转的相对地址
+ * @param[out] relay_size: 中转需擦除的大小，单位 byte
+ * @retval FM_ERR_OK: 成功 | FM_ERR_FIRMWARE_OVERSIZE: 固件之后没有足够的空闲 sector | FM_ERR_UPDATE_VER_ERASE_ERR: 分区不在 sector 边界
  */
-FM_ERR_CODE  FM_UpdateFirmwareVersion(const char *part_name)
+static FM_ERR_CODE _Version_GetRelay(const struct FLASH_OBJECT *part, 
+                                     const struct ERASE_EXTENT *extent, 
+                                     uint32_t need, 
+                                     uint32_t *head_size, 
+                                     uint32_t *relay, 
+                                     uint32_t *relay_size)
 {
-    const struct FLASH_OBJECT *part = NULL;
+#if (DOWNLOAD_PART_LOCATION == STORE_IN_SPI_FLASH)
+    uint32_t earse_unit = SPI_FLASH_ERASE_GRANULARITY;
+#else
+    uint32_t earse_unit = ONCHIP_FLASH_ERASE_GRANULARITY;
+#endif
 
-    part = GET_FLASH_OBJECT(APP_PART_NAME);
-    if (part == NULL)
+    uint32_t base = 0;
+    uint32_t sector_offset = 0;
+    uint32_t sector_size = 0;
+    struct BSP_FLASH_GEOMETRY uniform;
+    const struct BSP_FLASH_GEOMETRY *geometry = NULL;
+
+    *relay      = 0;
+    *relay_size = 0;
+
+    /* 移植文件不提供 sector 布局时按均匀的擦除粒度，偏移地址从分区首地址算起 */
+    geometry = _Erase_GetGeometry(part, &base);
+    if (geometry == NULL)
     {
-        BSP_Printf("%s: not found APP part.\r\n", __func__);
-        return FM_ERR_NO_THIS_PART;
+        memset(&uniform, 0, sizeof(uniform));
+        uniform.region_num            = 1;
+        uniform.region[0].sector_size = earse_unit;
+        uniform.region[0].sector_num  = (part->len + earse_unit - 1) / earse_unit;
+        geometry = &uniform;
+        base     = 0;
     }
-    
-    if (FLASH_PART_READ(part, _app_ver_addr, (uint8_t *)&_fpk_head.fw_old_ver[0], FPK_VERSION_SIZE) < 0)
+
+    /* 分区首个 sector 的尺寸 */
+    if (BSP_Flash_GetSector(geometry, base, &sector_offset, head_size) < 0 || sector_offset != base)
+    {
+        BSP_Printf("%s: %s part does not start on a sector boundary.\r\n", __func__, part->name);
+        return FM_ERR_UPDATE_VER_ERASE_ERR;
+    }
+
+    if (*head_size <= FPK_LEAST_HANDLE_BYTE)
+        return FM_ERR_OK;
+
+    /* 固件不足一个 sector 时，中转的 sector 也不能与首个 sector 重叠 */
+    if (need < *head_size)
+        need = *head_size;
+    BSP_Flash_GetSector(geometry, base + need - 1, &sector_offset, &sector_size);
+    *relay = sector_offset + sector_size - base;
+
+    if (BSP_Flash_GetSector(geometry, base + *relay + *head_size - 1, &sector_offset, &sector_size) < 0
+    ||  sector_offset + sector_size - base > extent->limit)
+    {
+        BSP_Printf("%s: %s part has no free sectors after the firmware to relay the first sector (%d byte).\r\n", 
+                   __func__, part->name, *head_size);
+        return FM_ERR_FIRMWARE_OVERSIZE;
+    }
+    *relay_size = sector_offset + sector_size - base - *relay;
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  修改固件包头中旧版本字段的版本信息为新的固件版本
+ * @note   修改后的固件包头同时存入 _fpk_head
+ * @param[in]  buf: 从分区首地址读出的数据
+ * @retval None
+ */
+static void _Version_Patch(uint8_t *buf)
+{
+    struct FPK_HEAD *p_pkg_head = (struct FPK_HEAD *)buf;
+
+    p_pkg_head->fw_old_ver[0] = p_pkg_head->fw_new_ver[0];
+    p_pkg_head->fw_old_ver[1] = p_pkg_head->fw_new_ver[1];
+    p_pkg_head->fw_old_ver[2] = p_pkg_head->fw_new_ver[2];
+    p_pkg_head->fw_old_ver[3] = p_pkg_head->fw_new_ver[3];
+
+    memcpy((uint8_t *)&_fpk_head, buf, FPK_HEAD_SIZE);
+}
+
+
+/**
+ * @brief  擦除分区中准备写入的范围
+ * @note   启用 ENABLE_ERASE_STATE 时同时将该范围记录为有数据
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 擦除的大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE _Version_Erase(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    if (FLASH_PART_ERASE(part, addr, size) < 0)
+    {
+        BSP_Printf("%s: %s part erase failed.\r\n", __func__, part->name);
+        return FM_ERR_UPDATE_VER_ERASE_ERR;
+    }
+
+#if (ENABLE_ERASE_STATE)
+    if (_State_Write(part, addr, size) != FM_ERR_OK)
+        return FM_ERR_UPDATE_VER_WRITE_ERR;
+#endif
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  分块复制分区中的数据
+ * @note   经 _fpk_min_handle_buff 每次复制 FPK_LEAST_HANDLE_BYTE ，复制分区首地址的块时修改固件包头中的版本
+ * @param[in]  part: 分区对象
+ * @param[in]  dst: 目标相对地址，需已擦除
+ * @param[in]  src: 源相对地址
+ * @param[in]  size: 复制的大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE _Version_Copy(const struct FLASH_OBJECT *part, uint32_t dst, uint32_t src, uint32_t size)
+{
+    uint32_t len;
+
+    for (uint32_t i = 0; i < size; i += len)
+    {
+        len = (size - i > FPK_LEAST_HANDLE_BYTE)? FPK_LEAST_HANDLE_BYTE : size - i;
+        if (FLASH_PART_READ(part, src + i, &_fpk_min_handle_buff[0], len) < 0)
+        {
+            BSP_Printf("%s: read error.\r\n", __func__);
+            return FM_ERR_UPDATE_VER_READ_ERR;
+        }
+
+        if (src + i == 0)
+            _Version_Patch(&_fpk_min_handle_buff[0]);
+
+        if (FLASH_PART_WRITE(part, dst + i, &_fpk_min_handle_buff[0], len) < 0)
+        {
+            BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_UPDATE_VER_WRITE_ERR;
+        }
+    }
+    _Extent_Write(part, dst, size);
+
+    return FM_ERR_OK;
+}
+
+
+#elif (USING_AUTO_UPDATE_PROJECT == VERSION_WRITE_TO_APP)
+/**
+ * @brief  更新固件包中的版本信息
+ * @note   
+ * @param[in]  part_name: 分区名称
+ * @retval FM_ERR_CODE
+ */
+FM_ERR_CODE  FM_UpdateFirmwareVersion(const char *part_name)
+{
+    const struct FLASH_OBJECT *part = NULL;
+
+    part = GET_FLASH_OBJECT(APP_PART_NAME);
+    if (part == NULL)
+    {
+        BSP_Printf("%s: not found APP part.\r\n", __func__);
+        return FM_ERR_NO_THIS_PART;
+    }
+    
+    if (FLASH_PART_READ(part, _app_ver_addr, (uint8_t *)&_fpk_head.fw_old_ver[0], FPK_VERSION_SIZE) < 0)
+    {
+        BSP_Printf("%s: read error.\r\n", __func__);
+        return FM_ERR_READ_VER_ERR;
+    }
+
+    if (_fpk_head.fw_old_ver[0] != 0xFF
+    ||  _fpk_head.fw_old_ver[1] != 0xFF
+    ||  _fpk_head.fw_old_ver[2] != 0xFF
+    ||  _fpk_head.fw_old_ver[3] != 0xFF)
+    {
+        BSP_Printf("%s: version area no erase.\r\n", __func__);
+        return FM_ERR_VER_AREA_NO_ERASE;
+    }
+
+#if (ONCHIP_FLASH_ONCE_WRITE_BYTE > FPK_VERSION_SIZE)
+    uint8_t version[ONCHIP_FLASH_ONCE_WRITE_BYTE] = {0};
+    memcpy((uint8_t *)&version[0], (uint8_t *)&_fpk_head.fw_new_ver[0], FPK_VERSION_SIZE);
+    
+    if (FLASH_PART_WRITE(part, _app_ver_addr, (uint8_t *)&version[0], sizeof(version)) < 0)
+    {
+        BSP_Printf("%s: write error.\r\n", __func__);
+        return FM_ERR_WRITE_VER_ERR;
+    }
+#else
+    if (FLASH_PART_WRITE(part, _app_ver_addr, (uint8_t *)&_fpk_head.fw_new_ver[0], FPK_VERSION_SIZE) < 0)
+    {
+        BSP_Printf("%s: write error.\r\n", __func__);
+        return FM_ERR_WRITE_VER_ERR;
+    }
+#endif
+
+    return FM_ERR_OK;
+}
+
+#endif /* #if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT) */
+
+#endif /* #if (USING_PART_PROJECT > ONE_PART_PROJECT) */
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  检测某个分区是否为空
+ * @note   1. FM_ERR_OK: 分区数据空
+ *         2. 只检测 _fpk_head 对应的固件占用的范围和分区末尾的记录，调用前需确保 _fpk_head 已经读入了数据
+ * @param[in]  part_name: 分区名
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _IsEmpty(const char *part_name)
+{
+    uint32_t addr = 0;
+    uint32_t size = 0;
+    FM_ERR_CODE result = FM_ERR_OK;
+    struct ERASE_EXTENT *extent = NULL;
+    
+    ASSERT(part_name != NULL);
+        
+    const struct FLASH_OBJECT *part = NULL;
+    
+    part = GET_FLASH_OBJECT(part_name);
+    if (part == NULL)
+    {
+        BSP_Printf("%s: %s not found.\r\n", __func__, part_name);
+        return FM_ERR_NO_THIS_PART;
+    }
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 分区排队的擦写完成后才能按记录的范围判空 */
+    result = _Async_Result(part);
+    if (result != FM_ERR_OK)
+        return result;
+#endif
+    
+#if (ENABLE_ERASE_AHEAD)
+    _Ahead_Cancel(part);
+#endif
+    extent = _Extent_Get(part, part_name);
+
+    /* 只检查固件包占用的范围中可能有数据的部分 */
+    if (_Extent_GetDirty(extent, _Extent_GetNeed(extent, 0), &addr, &size))
+        result = _IsErased(part, addr, size, _fpk_min_handle_buff, FPK_LEAST_HANDLE_BYTE);
+
+    /* 分区末尾的记录 */
+    if (result == FM_ERR_OK && extent->limit < part->len)
+        result = _IsErased(part, extent->limit, part->len - extent->limit, _fpk_min_handle_buff, FPK_LEAST_HANDLE_BYTE);
+
+    if (result == FM_ERR_READ_FLASH_ERR)
+        return FM_ERR_READ_IS_EMPTY_ERR;
+    if (result != FM_ERR_OK)
+    {
+        BSP_Printf("%s: %s part no empty\r\n", __func__, part_name);
+        return result;
+    }
+    
+    _Extent_Clean(extent, _Extent_GetNeed(extent, 0));
+#if (ENABLE_ERASE_STATE)
+    _State_Save(part);
+#endif
+    BSP_Printf("%s: %s part empty\r\n", __func__, part_name);
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  校验已放置在分区的固件包的包体数据的正确性
+ * @note   一般要先校验包头，注意各分区包体的偏移地址有区别
+ * @param[in]  part_name: 分区名称
+ * @param[in]  crc32: 需进行比对的 CRC32 校验值
+ * @param[in]  is_auto_fill: 是否自动填充固件的首地址数据
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _VerifyFirmware(const char *part_name, uint32_t crc32, bool is_auto_fill)
+{
+    int      read_len = 0;
+    bool     is_app_part = false;
+    uint32_t pkg_size = 0;
+    uint32_t body_crc = 0xFFFFFFFF;
+    uint32_t read_posit = 0;
+    uint32_t read_posit_temp = 0;
+    uint16_t need_read_size = FPK_LEAST_HANDLE_BYTE;
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+    bool is_first = false;
+#endif
+    const struct FLASH_OBJECT *part = NULL;
+    
+    ASSERT(part_name != NULL);
+
+#if (ENABLE_DECRYPT == 0)
+    /* 若固件包加密，检查是否有解密组件 */
+    if (FM_IsEncrypt())
+    {
+        BSP_Printf("%s: no decrypt component\r\n", __func__);
+        return FM_ERR_NO_DECRYPT_COMPONENT;
+    }
+#endif
+
+    if (strncmp(part_name, APP_PART_NAME, MAX_NAME_LEN) == 0)
+        is_app_part = true;
+     
+    part = GET_FLASH_OBJECT(part_name);
+    if (part == NULL)
+    {
+        BSP_Printf("%s: not found.\r\n", __func__);
+        return FM_ERR_NO_THIS_PART;
+    }
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 排队的写入和写入检查全部完成后再校验 */
+    {
+        FM_ERR_CODE result = _Async_Result(NULL);
+        if (result != FM_ERR_OK)
+            return result;
+    }
+#endif
+
+    BSP_Printf("fpk size: %d byte\r\n", FPK_HEAD_SIZE);
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        uint8_t *p = (uint8_t *)&_fpk_head;
+        for (uint8_t j = 0; j < FPK_HEAD_SIZE / 6; j++)
+            BSP_Printf("%.2X ", p[(i * (FPK_HEAD_SIZE / 6)) + j]);
+        BSP_Printf("\r\n");
+    }
+    BSP_Printf("%s: part name %s\r\n", __func__, part_name);
+    
+    if (is_app_part)
+        pkg_size = _fpk_head.raw_size;
+    else
+        pkg_size = _fpk_head.pkg_size;
+    BSP_Printf("pkg_size %d\r\n", pkg_size);
+
+#if (ENABLE_STREAM_VERIFY)
+    /* 接收时已累加了包体的 CRC32 ，无须再读取整个固件包 */
+    if (_Stream_GetBodyCRC(part, is_app_part? 0 : FPK_HEAD_SIZE, pkg_size, &body_crc))
+    {
+        BSP_Printf("%s: stream verify\r\n", __func__);
+        read_posit = pkg_size;
+    }
+#endif
+    
+    /* 校验固件包体的数据正确性 */
+    for (; read_posit < pkg_size; )
+    {
+        /* 剩余的数据数小于最小处理单位时，按剩余字节数处理 */
+        if ((pkg_size - read_posit) < FPK_LEAST_HANDLE_BYTE)
+            need_read_size = pkg_size - read_posit;
+        
+        /* 非 APP 分区，需要偏移包头的地址才是包体 */
+        if (is_app_part)
+            read_posit_temp = read_posit;
+        else
+            read_posit_temp = read_posit + FPK_HEAD_SIZE;
+
+        read_len = FLASH_PART_READ(part, read_posit_temp, &_fpk_min_handle_buff[0], need_read_size);
+        if (read_len < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_VERIFY_READ_ERR;
+        }
+
+    #if (USING_PART_PROJECT > ONE_PART_PROJECT)
+        if (is_auto_fill)
+        {
+            if (is_first == false)
+            {
+                is_first = true;
+                BSP_Printf("_fw_first_bytes: ");
+                for (uint8_t i = 0; i < ONCHIP_FLASH_ONCE_WRITE_BYTE; i++)
+                {
+                    _fpk_min_handle_buff[i] = _fw_first_bytes[i];
+                    BSP_Printf("%.2X ", _fw_first_bytes[i]);
+                }
+                BSP_Printf("\r\n");
+            }
+        }
+    #endif
+
+        body_crc = _CRC32_StepCalc(body_crc, &_fpk_min_handle_buff[0], read_len);
+        read_posit += read_len;
+    }
+    body_crc ^= 0xFFFFFFFF;
+    
+    if (body_crc != crc32)
+    {
+        BSP_Printf("%s: body crc verify failed. (%.8X - %.8X)\r\n", __func__, crc32, body_crc);
+        if (is_app_part)
+            return FM_ERR_RAW_BODY_VERIFY_ERR;
+        else
+            return FM_ERR_PKG_BODY_VERIFY_ERR;
+    }
+    
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  擦除某个分区的固件
+ * @note   只擦除 _fpk_head 对应的固件占用的范围中可能有数据的部分和分区末尾的记录，调用前需确保 _fpk_head 已经读入了数据
+ * @param[in]  part_name: 分区名称
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _EraseFirmware(const char *part_name)
+{
+    ASSERT(part_name != NULL);
+
+    uint32_t addr = 0;
+    uint32_t size = 0;
+    uint32_t need = 0;
+    FM_ERR_CODE result = FM_ERR_OK;
+    struct ERASE_EXTENT *extent = NULL;
+    const struct FLASH_OBJECT *part = NULL;
+    
+    part = GET_FLASH_OBJECT(part_name);
+    if (part == NULL)
+    {
+        BSP_Printf("%s: not found %s part.\r\n", __func__, part_name);
+        return FM_ERR_NO_THIS_PART;
+    }
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 上一次调用排队的擦除尚未完成。完成后再次调用时已擦除的范围不再擦除，只检查分区末尾的记录 */
+    result = _Async_Result(part);
+    if (result != FM_ERR_OK)
+        return result;
+#endif
+    
+#if (ENABLE_STREAM_VERIFY)
+    /* 分区已擦除，累加的 CRC32 不再对应分区中的数据 */
+    if (part == _stream.part)
+        _stream.part = NULL;
+#endif
+#if (ENABLE_ERASE_AHEAD)
+    _Ahead_Cancel(part);
+#endif
+    
+    extent = _Extent_Get(part, part_name);
+    need   = _Extent_GetNeed(extent, 0);
+
+    /* 只擦除固件包占用的范围中可能有数据的部分 */
+    if (_Extent_GetDirty(extent, need, &addr, &size))
+    {
+        BSP_Printf("%s: %s part erase 0x%.8X ~ 0x%.8X\r\n", __func__, part_name, addr, addr + size);
+        if (FLASH_PART_ERASE(part, addr, size) < 0)
+        {
+            BSP_Printf("%s: %s part erase failed.\r\n", __func__, part_name);
+            return FM_ERR_ERASE_PART_ERR;
+        }
+    }
+    _Extent_Clean(extent, need);
+
+    /* 分区末尾的记录，已是擦除状态时不再擦除 */
+    if (extent->limit < part->len)
+    {
+        result = _IsErased(part, extent->limit, part->len - extent->limit, _fpk_min_handle_buff, FPK_LEAST_HANDLE_BYTE);
+        if (result == FM_ERR_FLASH_NO_EMPTY)
+        {
+            if (FLASH_PART_ERASE(part, extent->limit, part->len - extent->limit) < 0)
+            {
+                BSP_Printf("%s: %s part erase failed.\r\n", __func__, part_name);
+                return FM_ERR_ERASE_PART_ERR;
+            }
+        }
+        else if (result != FM_ERR_OK)
+            return result;
+    }
+#if (ENABLE_ERASE_STATE)
+    _State_Save(part);
+#endif
+
+#if (ENABLE_ASYNC_FLASH)
+    return _Async_Result(part);
+#else
+    return FM_ERR_OK;
+#endif
+}
+
+
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+/**
+ * @brief  从某个分区将固件包更新至 APP 分区
+ * @note   1. 读取 -> 解密 -> 写入
+ *         2. 启用 ENABLE_ASYNC_FLASH 时每次调用处理一个块，未完成时返回 FM_ERR_BUSY ，需再次调用直至返回其他值
+ * @param[in]  from_part_name: 放置需要更新至 APP 分区的固件包的分区
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _UpdateToAPP(const char *from_part_name)
+{
+    ASSERT(from_part_name != NULL);
+
+    int      read_len = 0;
+    uint32_t need_read_size = FPK_LEAST_HANDLE_BYTE;
+    FM_ERR_CODE result = FM_ERR_OK;
+    const struct FLASH_OBJECT *app_part = NULL;
+    const struct FLASH_OBJECT *firmware_part = NULL;
+    
+    app_part = GET_FLASH_OBJECT(APP_PART_NAME);
+    if (app_part == NULL)
+    {
+        BSP_Printf("%s: not found APP part.\r\n", __func__);
+        return FM_ERR_NO_THIS_PART;
+    }
+    
+    firmware_part = GET_FLASH_OBJECT(from_part_name);
+    if (firmware_part == NULL)
+    {
+        BSP_Printf("%s: not found %s part.\r\n", __func__, from_part_name);
+        return FM_ERR_NO_THIS_PART;
+    }
+
+    /* 首次调用，从头开始更新 */
+    if (_update.part != firmware_part)
+    {
+        _Reset_Write();
+        BSP_Printf("%s: from %s part write to APP\r\n", __func__, from_part_name);
+
+    #if (ENABLE_STREAM_VERIFY)
+        /* 复制的同时累加源固件的 CRC32 ，校验 APP 时无须再读取 APP 分区 */
+        _Stream_Start(app_part, true);
+    #endif
+    #if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+        _write_check.part  = app_part;
+        _write_check.count = 0;
+    #endif
+
+        result = _Check_Compress();
+        if (result)
+            return result;
+
+        /* 读取加密选项 */
+        _update.is_decrypt = FM_IsEncrypt();
+        _update.read_posit = 0;
+        _update.part       = firmware_part;
+
+    #if (ENABLE_DECRYPT)
+        /* 当有固件包需要刷入 APP 分区时，每次都需要对 AES 进行初始化，存在 AES 库已被其它函数使用的情况 */
+        if (_update.is_decrypt)
+            AES_init_ctx_iv(&_aes_ctx, (uint8_t *)AES256_KEY, (uint8_t *)AES256_IV);
+    #endif
+    }
+
+    while (_update.read_posit < _fpk_head.pkg_size)
+    {
+    #if (ENABLE_ASYNC_FLASH)
+        /* 擦写队列的空间不足时先返回，让出时间处理主机数据 */
+        if (FA_IsAvailable(FPK_LEAST_HANDLE_BYTE) == false)
+        {
+            FA_Process();
+            return FM_ERR_BUSY;
+        }
+    #endif
+
+        if ((_fpk_head.pkg_size - _update.read_posit) < FPK_LEAST_HANDLE_BYTE)
+            need_read_size = _fpk_head.pkg_size - _update.read_posit;
+
+        read_len = FLASH_PART_READ(firmware_part, (_update.read_posit + FPK_HEAD_SIZE), _fpk_min_handle_buff, need_read_size);
+        if (read_len < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            _update.part = NULL;
+            return FM_ERR_UPDATE_READ_ERR;
+        }
+
+        result = _Write_FirmwareSubPackage(app_part, _fpk_min_handle_buff, read_len, _update.is_decrypt, FM_DIR_DOWNLOAD_TO_APP);
+        if (result)
+        {
+            BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+            _update.part = NULL;
+            return result;
+        }
+
+        _update.read_posit += read_len;
+
+    #if (ENABLE_ASYNC_FLASH)
+        if (_update.read_posit < _fpk_head.pkg_size)
+            return FM_ERR_BUSY;
+    #endif
+    }
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 等待写入和写入检查全部完成 */
+    result = _Async_Result(NULL);
+    if (result == FM_ERR_BUSY)
+        return result;
+#endif
+    _update.part = NULL;
+    if (result != FM_ERR_OK)
+        return result;
+
+#if (ENABLE_STREAM_VERIFY)
+    if (app_part == _stream.part)
+        _stream.is_done = true;
+#endif
+    
+    return FM_ERR_OK;
+}
+#endif
+
+
+/**
+ * @brief  复位写固件的一些记录信息
+ * @note   
+ * @retval None
+ */
+static void _Reset_Write(void)
+{
+    _is_start_write      = false;   /* 固件开始写入的标志位 */
+    _update_progress     = 0;       /* 固件更新的进度， 10000 制 */
+    _write_part_addr     = 0;       /* 固件包写入时记录写入 flash 的相对地址 */
+    _handle_size         = 0;       /* 已处理的固件包数据量 */
+#if (ENABLE_DECOMPRESS)
+    memset(&_lz, 0, sizeof(_lz));   /* 解压从头开始 */
+#endif
+#if (IS_ENABLE_DELTA_UPDATE)
+    memset(&_patch, 0, sizeof(_patch));   /* 还原从补丁头开始 */
+#endif
+#if (IS_ENABLE_RESUME_TRANSFER)
+    memset(&_journal, 0, sizeof(_journal));   /* 不记录进度，直至写入固件包头 */
+#endif
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+    _update.part         = NULL;    /* 更新至 APP 分区从头开始 */
+#endif
+}
+
+
+/**
+ * @brief  检查是否能解压固件包
+ * @note   打包时的解压窗口不能大于 DECOMPRESS_WINDOW_BITS ，调用前需确保 _fpk_head 已经读入了数据
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Check_Compress(void)
+{
+    if (FM_IsCompress() == false)
+        return FM_ERR_OK;
+
+#if (ENABLE_DECOMPRESS)
+    uint8_t index_bits = _fpk_head.config[3] >> 4;
+    uint8_t count_bits = _fpk_head.config[3] & 0x0F;
+
+    if (index_bits >= 4 && index_bits <= DECOMPRESS_WINDOW_BITS
+    &&  count_bits >= 1 && count_bits <  index_bits)
+        return FM_ERR_OK;
+
+    BSP_Printf("%s: window %d/%d not supported\r\n", __func__, index_bits, count_bits);
+#else
+    BSP_Printf("%s: no decompress component\r\n", __func__);
+#endif
+
+    return FM_ERR_NO_DECOMPRESS_COMPONENT;
+}
+
+
+/**
+ * @brief  检查是否能还原差分固件包
+ * @note   调用前需确保 _fpk_head 已经读入了数据
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Check_Delta(void)
+{
+    if (FM_IsDelta() == false)
+        return FM_ERR_OK;
+
+#if (IS_ENABLE_DELTA_UPDATE)
+    return FM_ERR_OK;
+#else
+    BSP_Printf("%s: no delta component\r\n", __func__);
+    return FM_ERR_NO_DELTA_COMPONENT;
+#endif
+}
+
+
+/**
+ * @brief  检查片内 flash 的编程能力与固件数据的写入单位是否匹配
+ * @note   1. 固件数据按 FPK_LEAST_HANDLE_BYTE 、解压窗口、还原缓存或增量写入的块整块下发给移植文件的 write ，
+ *            均为 burst_unit 的整数倍时，除首个写入单位的开头和固件末尾外都以快速编程的方式写入
+ *         2. 只打印警告，不匹配的部分由移植文件按 min_unit 编程
+ * @retval None
+ */
+static void _Check_FlashCaps(void)
+{
+    uint32_t misalign;
+    const struct BSP_FLASH_CAPS *caps = BSP_Flash_GetCaps();
+
+    BSP_Printf("onchip flash program: %d byte, burst %d byte, mode %d\r\n", caps->min_unit, caps->burst_unit, caps->mode);
+
+    if (ONCHIP_FLASH_ONCE_WRITE_BYTE % caps->min_unit)
+        BSP_Printf("WARNING: ONCHIP_FLASH_ONCE_WRITE_BYTE is not a multiple of %d byte\r\n", caps->min_unit);
+
+    misalign = FPK_LEAST_HANDLE_BYTE % caps->burst_unit;
+#if (ENABLE_DECOMPRESS)
+    misalign |= LZ_WINDOW_SIZE % caps->burst_unit;
+#endif
+#if (IS_ENABLE_DELTA_UPDATE)
+    misalign |= PATCH_CACHE_SIZE % caps->burst_unit;
+#endif
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    misalign |= INCREMENTAL_ERASE_UNIT % caps->burst_unit;
+#endif
+
+    if (misalign)
+        BSP_Printf("WARNING: write unit is not a multiple of %d byte, fast program will be skipped\r\n", caps->burst_unit);
+}
+
+
+/**
+ * @brief  按 flash 的 sector 布局检查分区的放置
+ * @note   1. 分区首尾不在 sector 边界上时，擦除分区会连带擦除相邻的数据
+ *         2. 分区中有大于 ERASE_ALIGN_SIZE 的 sector 时，较小的固件也要擦除整个 sector ，擦除时间成倍放大
+ *         3. 分区末尾的记录与固件共用 sector 时，擦除固件会连带擦除记录
+ *         4. MODIFY_DOWNLOAD_PART_PROJECT 时 download 分区的首个 sector 大于 _fpk_min_handle_buff 的，修改版本需经固件之后的空闲 sector 中转，
+ *            最小的固件也放不下中转的 sector 时报错
+ *         5. 移植文件不提供 sector 布局的 flash 不检查，只打印警告
+ * @retval None
+ */
+static void _Check_FlashLayout(void)
+{
+    uint32_t base, end, posit;
+    uint32_t head_offset, head_size;
+    uint32_t tail_offset, tail_size;
+    uint32_t sector_offset, sector_size, max_size;
+#if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT)
+    uint32_t relay, relay_size;
+#endif
+    struct ERASE_EXTENT *extent;
+    const struct FLASH_OBJECT *part;
+    const struct BSP_FLASH_GEOMETRY *geometry;
+    const char *part_name[] = 
+    {
+        APP_PART_NAME, 
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+        DOWNLOAD_PART_NAME, 
+    #if (USING_PART_PROJECT > DOUBLE_PART_PROJECT)
+        FACTORY_PART_NAME, 
+    #endif
+#endif
+#if (ENABLE_ERASE_STATE)
+        ERASE_STATE_PART_NAME, 
+#endif
+    };
+
+    for (uint8_t i = 0; i < sizeof(part_name) / sizeof(part_name[0]); i++)
+    {
+        part = GET_FLASH_OBJECT(part_name[i]);
+        if (part == NULL || (geometry = _Erase_GetGeometry(part, &base)) == NULL)
+            continue;
+
+        end = base + part->len;
+        if (BSP_Flash_GetSector(geometry, base, &head_offset, &head_size) < 0
+        ||  BSP_Flash_GetSector(geometry, end - 1, &tail_offset, &tail_size) < 0)
+        {
+            BSP_Printf("WARNING: %s part is out of the flash\r\n", part_name[i]);
+            continue;
+        }
+
+        if (head_offset != base || tail_offset + tail_size != end)
+        {
+            BSP_Printf("WARNING: %s part 0x%.8X ~ 0x%.8X is not on sector boundaries, erasing it also erases 0x%.8X ~ 0x%.8X\r\n",
+                       part_name[i], geometry->addr + base, geometry->addr + end, 
+                       geometry->addr + head_offset, geometry->addr + tail_offset + tail_size);
+        }
+
+        max_size = 0;
+        for (posit = head_offset; posit < end; posit = sector_offset + sector_size)
+        {
+            BSP_Flash_GetSector(geometry, posit, &sector_offset, &sector_size);
+            if (sector_size > max_size)
+                max_size = sector_size;
+        }
+        if (max_size > ERASE_ALIGN_SIZE)
+        {
+            BSP_Printf("WARNING: %s part has %d Kbyte sectors, erase time is amplified up to %d times\r\n",
+                       part_name[i], max_size / 1024, max_size / ERASE_ALIGN_SIZE);
+        }
+
+#if (ENABLE_ERASE_STATE)
+        if (strncmp(part_name[i], ERASE_STATE_PART_NAME, MAX_NAME_LEN) == 0)
+            continue;
+#endif
+
+        /* 分区末尾的记录 */
+        extent = _Extent_Get(part, part_name[i]);
+        if (extent->limit < part->len)
+        {
+            BSP_Flash_GetSector(geometry, base + extent->limit, &sector_offset, &sector_size);
+            if (sector_offset < base + extent->limit)
+            {
+                BSP_Printf("WARNING: %s part record at 0x%.8X shares a sector with the firmware, erasing the firmware also erases it\r\n",
+                           part_name[i], geometry->addr + base + extent->limit);
+            }
+        }
+
+#if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT)
+        if (strncmp(part_name[i], DOWNLOAD_PART_NAME, MAX_NAME_LEN) == 0 && head_size > FPK_LEAST_HANDLE_BYTE)
+        {
+            BSP_Printf("WARNING: %s part first sector is %d byte, larger than %d byte, firmware without %d byte of free sectors after it is rejected\r\n",
+                       part_name[i], head_size, FPK_LEAST_HANDLE_BYTE, head_size);
+
+            /* 最小的固件也放不下中转的 sector 时，任何固件都无法修改版本 */
+            if (_Version_GetRelay(part, extent, head_size, &head_size, &relay, &relay_size) != FM_ERR_OK)
+                BSP_Printf("ERROR: %s part has no room to relay the first sector, the firmware version cannot be modified\r\n", part_name[i]);
+        }
+#endif
+    }
+}
+
+
+/**
+ * @brief  将固件分包按顺序写入某个分区
+ * @note   1. 循环调用本函数，无须指定写入地址，函数内部自行记录已写入的大小
+ *         2. 需解密时在 data 上就地解密，主机下发的分包即协议接收缓存中的数据，不再另行暂存
+ *         3. 分包大小须为 flash 最小写入单位的整数倍，解密时还须为 AES 块大小的整数倍
+ *         4. 固件包有压缩且写入 APP 分区时，解密后再解压，写入 download/factory 分区时保持压缩
+ *         5. 差分固件包写入 download/factory 分区时，解密、解压后还原
+ * @param[in]  part: 分区对象
+ * @param[in]  data: 数据
+ * @param[in]  pkg_size: 数据大小，单位 byte
+ * @param[in]  is_decrypt: false: 不解密直接写入 | true: 解密后写入
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Write_FirmwareSubPackage( const struct FLASH_OBJECT *part, 
+                                               uint8_t  *data, 
+                                               uint16_t pkg_size, 
+                                               bool     is_decrypt,
+                                               FM_FIRMWARE_WRITE_DIR  write_dir)
+{
+    FM_ERR_CODE result;
+    uint32_t last_unit = _handle_size / FPK_LEAST_HANDLE_BYTE;
+    bool is_restore = (write_dir != FM_DIR_HOST_TO_DOWNLOAD) || FM_IsDelta();   /* 是否还原为源固件 */
+
+    /* 主机下发的分包可能是 128 、 1024 或扩展数据帧的长度，每帧直接写入，不能跨越写入单位和 AES 块 */
+    if (write_dir == FM_DIR_HOST_TO_APP || is_decrypt)
+    {
+    #if (ENABLE_DECRYPT)
+        if ((pkg_size % ONCHIP_FLASH_ONCE_WRITE_BYTE) || (is_decrypt && (pkg_size % AES_BLOCKLEN)))
+    #else
+        if (pkg_size % ONCHIP_FLASH_ONCE_WRITE_BYTE)
+    #endif
+        {
+            BSP_Printf("%s: sub package size error (%d).\r\n", __func__, pkg_size);
+            _Reset_Write();
+            return FM_ERR_WRITE_PART_ERR;
+        }
+    }
+
+    PERF_STATS_BEGIN(PERF_FM_WRITE_SUB_PKG);
+
+#if (ENABLE_DECRYPT)
+    if (is_decrypt)
+    {
+        PERF_STATS_BEGIN(PERF_AES_DECRYPT);
+        AES_CBC_decrypt_buffer(&_aes_ctx, &data[0], pkg_size);
+        PERF_STATS_END(PERF_AES_DECRYPT);
+    }
+#endif
+
+#if (ENABLE_DECOMPRESS)
+    if (FM_IsCompress() && is_restore)
+    {
+        PERF_STATS_BEGIN(PERF_DECOMPRESS);
+        result = _Decompress_Write(part, data, pkg_size);
+        PERF_STATS_END(PERF_DECOMPRESS);
+    }
+    else
+#endif
+#if (IS_ENABLE_DELTA_UPDATE)
+    if (FM_IsDelta())
+    {
+        PERF_STATS_BEGIN(PERF_DELTA_PATCH);
+        result = _Patch_Write(part, data, pkg_size);
+        PERF_STATS_END(PERF_DELTA_PATCH);
+    }
+    else
+#endif
+    result = _Write_Flash(part, data, pkg_size);
+
+    if (result != FM_ERR_OK)
+    {
+        _Reset_Write();
+        return result;
+    }
+
+    _handle_size += pkg_size;
+
+    /* 进度仍以 FPK_LEAST_HANDLE_BYTE 为单位，按已处理的固件包数据量计算，每越过一个单位或处理完最后一个分包时更新 */
+    if (_handle_size / FPK_LEAST_HANDLE_BYTE != last_unit
+    ||  _handle_size >= _fpk_head.pkg_size)
+    {
+        _update_progress += _update_progress_step_num;
+        Firmware_OperateCallback(_update_progress);
+    }
+
+    PERF_STATS_END(PERF_FM_WRITE_SUB_PKG);
+    
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  将数据按顺序写入某个分区
+ * @note   首次写入时暂存首地址的几个字节数据，等待 FM_WriteFirmwareDone 最后写入
+ * @param[in]  part: 分区对象
+ * @param[in]  data: 数据
+ * @param[in]  size: 数据大小，单位 byte ，首次写入时不能小于 ONCHIP_FLASH_ONCE_WRITE_BYTE
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Write_Flash(const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size)
+{
+    int write_result = 0;
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    /* 增量写入的比较阶段，只与 APP 分区的数据比较，不写入 */
+    if (_incr.mode == INCR_MODE_COMPARE)
+    {
+        FM_ERR_CODE result = _Incr_Compare(part, _write_part_addr, data, size);
+
+        _write_part_addr += size;
+        _is_start_write   = true;
+        return result;
+    }
+#endif
+
+#if (ENABLE_STREAM_VERIFY)
+    _Stream_Update(part, _is_start_write? _write_part_addr : 0, data, size);
+#endif
+
+    /* 保存首地址的几个字节数据，等待最后写入 */
+    if (_is_start_write == false)
+    {   
+        for (uint8_t i = 0; i < ONCHIP_FLASH_ONCE_WRITE_BYTE; i++)
+            _fw_first_bytes[i]  = data[i];
+
+        data             += ONCHIP_FLASH_ONCE_WRITE_BYTE;
+        size             -= ONCHIP_FLASH_ONCE_WRITE_BYTE;
+        _write_part_addr  = ONCHIP_FLASH_ONCE_WRITE_BYTE;
+    }
+
+#if (ENABLE_ERASE_AHEAD)
+    /* 写入位置所在的块尚未擦除时先擦除 */
+    if (_ahead.extent)
+    {
+        FM_ERR_CODE result = _Ahead_Ensure(part, _write_part_addr, size);
+        if (result != FM_ERR_OK)
+            return result;
+    }
+#endif
+#if (ENABLE_ERASE_STATE)
+    /* 先记录写入位置之后有数据，写入期间复位或掉电时不会误判为擦除状态 */
+    if (_State_Write(part, _write_part_addr, size) != FM_ERR_OK)
+        return FM_ERR_WRITE_PART_ERR;
+#endif
+     
+    PERF_STATS_BEGIN(PERF_FLASH_WRITE);
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+    if (_incr.mode == INCR_MODE_WRITE)
+        write_result = _Incr_Write(part, _write_part_addr, data, size);
+    else
+#endif
+    write_result = FLASH_PART_WRITE(part, _write_part_addr, data, size);
+    PERF_STATS_END(PERF_FLASH_WRITE);
+
+    if (write_result < 0)
+    {
+        BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+        return FM_ERR_WRITE_PART_ERR;
+    }
+    _Extent_Write(part, _write_part_addr, size);
+
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+    if (part == _write_check.part)
+    {
+        FM_ERR_CODE result = _Write_Check(part, _write_part_addr, data, size);
+        if (result != FM_ERR_OK)
+            return result;
+    }
+#endif
+
+    _write_part_addr += size;
+    _is_start_write   = true;
+
+    return FM_ERR_OK;
+}
+
+
+#if (ENABLE_DECOMPRESS)
+/**
+ * @brief  解压数据并按顺序写入某个分区
+ * @note   1. 解码状态保存在 _lz 中，压缩数据可任意分段传入
+ *         2. 解压窗口每写满一次即写入 flash ，解压出 raw_size 的数据后将剩余部分补 0xFF 至 flash 最小写入单位后写入
+ *         3. raw_size 之后的数据（ AES 和协议的填充）不作处理
+ *         4. 差分固件包解压出的是补丁，交给 _Patch_Write 还原，还原出 raw_size 的数据后结束
+ * @param[in]  part: 分区对象
+ * @param[in]  data: 压缩数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Decompress_Write(const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size)
+{
+    uint8_t  need_bits;
+    uint16_t value;
+    uint8_t  index_bits = _fpk_head.config[3] >> 4;
+    uint8_t  count_bits = _fpk_head.config[3] & 0x0F;
+    FM_ERR_CODE result;
+
+    for (uint16_t i = 0; i < size && _Decompress_IsDone() == false; i++)
+    {
+        _lz.bit_buff = (_lz.bit_buff << 8) | data[i];
+        _lz.bit_num += 8;
+
+        for (;;)
+        {
+            switch (_lz.state)
+            {
+                case LZ_STATE_LITERAL:  need_bits = 8;           break;
+                case LZ_STATE_INDEX:    need_bits = index_bits;  break;
+                case LZ_STATE_COUNT:    need_bits = count_bits;  break;
+                default:                need_bits = 1;           break;
+            }
+
+            if (_lz.bit_num < need_bits || _Decompress_IsDone())
+                break;
+
+            _lz.bit_num -= need_bits;
+            value = (_lz.bit_buff >> _lz.bit_num) & ((1 << need_bits) - 1);
+
+            switch (_lz.state)
+            {
+                case LZ_STATE_TAG:
+                    _lz.state = value ? LZ_STATE_LITERAL : LZ_STATE_INDEX;
+                    break;
+
+                case LZ_STATE_LITERAL:
+                    result = _Decompress_Output(part, (uint8_t)value);
+                    if (result)
+                        return result;
+                    _lz.state = LZ_STATE_TAG;
+                    break;
+
+                case LZ_STATE_INDEX:
+                    /* 回溯距离不能超出已解压的数据 */
+                    _lz.index = value + 1;
+                    if (_lz.index > _lz.out_size)
+                    {
+                        BSP_Printf("%s: index error (%d - %d).\r\n", __func__, _lz.index, _lz.out_size);
+                        return FM_ERR_DECOMPRESS_ERR;
+                    }
+                    _lz.state = LZ_STATE_COUNT;
+                    break;
+
+                case LZ_STATE_COUNT:
+                    for (uint16_t n = 0; n <= value && _Decompress_IsDone() == false; n++)
+                    {
+                        result = _Decompress_Output(part, _lz_window[(_lz.out_size - _lz.index) & LZ_WINDOW_MASK]);
+                        if (result)
+                            return result;
+                    }
+                    _lz.state = LZ_STATE_TAG;
+                    break;
+            }
+        }
+    }
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  输出一个解压后的字节
+ * @note   解压窗口写满或已解压出 raw_size 的数据时写入 flash
+ * @param[in]  part: 分区对象
+ * @param[in]  byte: 解压后的数据
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Decompress_Output(const struct FLASH_OBJECT *part, uint8_t byte)
+{
+    uint16_t posit = _lz.out_size & LZ_WINDOW_MASK;
+    uint16_t write_size;
+
+    _lz_window[posit++] = byte;
+    _lz.out_size++;
+
+#if (IS_ENABLE_DELTA_UPDATE)
+    if (FM_IsDelta())
+        return _Patch_Write(part, &byte, 1);
+#endif
+
+    if (posit == LZ_WINDOW_SIZE)
+        return _Write_Flash(part, _lz_window, LZ_WINDOW_SIZE);
+
+    if (_lz.out_size < _fpk_head.raw_size)
+        return FM_ERR_OK;
+
+    /* 最后不足一个窗口的数据，补 0xFF 至 flash 最小写入单位 */
+    write_size = (posit + ONCHIP_FLASH_ONCE_WRITE_BYTE - 1) / ONCHIP_FLASH_ONCE_WRITE_BYTE * ONCHIP_FLASH_ONCE_WRITE_BYTE;
+    memset(&_lz_window[posit], 0xFF, write_size - posit);
+
+    return _Write_Flash(part, _lz_window, write_size);
+}
+
+
+/**
+ * @brief  是否已解压完毕
+ * @note   差分固件包以还原出 raw_size 的数据为准
+ * @retval false: 未完成 | true: 已完成
+ */
+static bool  _Decompress_IsDone(void)
+{
+#if (IS_ENABLE_DELTA_UPDATE)
+    if (FM_IsDelta())
+        return (_patch.out_size >= _fpk_head.raw_size);
+#endif
+    return (_lz.out_size >= _fpk_head.raw_size);
+}
+#endif
+
+
+#if (IS_ENABLE_DELTA_UPDATE)
+/**
+ * @brief  将差分固件包的包头转换为还原后的固件包的包头
+ * @note   还原后的固件包不加密、不压缩，包体即源固件
+ * @param[in,out]  head: 固件包头
+ * @retval None
+ */
+static void _Delta_ConvertHead(struct FPK_HEAD *head)
+{
+    head->config[1] = 0x00;
+    head->config[2] = 0x00;
+    head->config[3] = 0x00;
+    head->pkg_size  = head->raw_size;
+    head->pkg_crc   = head->raw_crc;
+    head->head_crc  = _CRC32_Calc((uint8_t *)head, FPK_HEAD_SIZE - 4);
+}
+
+
+/**
+ * @brief  按补丁还原固件并按顺序写入某个分区
+ * @note   1. 还原状态保存在 _patch 中，补丁可任意分段传入
+ *         2. 读取完补丁头即校验 APP 分区的基础固件
+ *         3. 还原出 raw_size 的数据后，之后的数据（ AES 和协议的填充）不作处理
+ * @param[in]  part: 分区对象
+ * @param[in]  data: 补丁数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Patch_Write(const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size)
+{
+    uint8_t  base;
+    uint8_t  *field = _patch.field;
+    FM_ERR_CODE result;
+
+    for (uint16_t i = 0; i < size && _patch.out_size < _fpk_head.raw_size; i++)
+    {
+        switch (_patch.state)
+        {
+            case PATCH_STATE_HEAD:
+            {
+                field[_patch.field_len++] = data[i];
+                if (_patch.field_len < PATCH_HEAD_SIZE)
+                    break;
+
+                _patch.field_len = 0;
+                _patch.base_size = field[0] | (field[1] << 8) | (field[2] << 16) | ((uint32_t)field[3] << 24);
+                result = _Patch_CheckBase(field[4] | (field[5] << 8) | (field[6] << 16) | ((uint32_t)field[7] << 24));
+                if (result)
+                    return result;
+                _patch.state = PATCH_STATE_CTRL;
+                break;
+            }
+            case PATCH_STATE_CTRL:
+            {
+                field[_patch.field_len++] = data[i];
+                if (_patch.field_len < PATCH_CTRL_SIZE)
+                    break;
+
+                _patch.field_len = 0;
+                _patch.diff_len  = field[0] | (field[1] << 8) | (field[2] << 16)  | ((uint32_t)field[3] << 24);
+                _patch.extra_len = field[4] | (field[5] << 8) | (field[6] << 16)  | ((uint32_t)field[7] << 24);
+                _patch.seek      = (int32_t)(field[8] | (field[9] << 8) | (field[10] << 16) | ((uint32_t)field[11] << 24));
+                _Patch_NextState();
+                break;
+            }
+            case PATCH_STATE_DIFF:
+            {
+                result = _Patch_ReadBase(&base);
+                if (result == FM_ERR_OK)
+                    result = _Patch_Output(part, base + data[i]);
+                if (result)
+                    return result;
+                _patch.diff_len--;
+                _Patch_NextState();
+                break;
+            }
+            case PATCH_STATE_EXTRA:
+            {
+                result = _Patch_Output(part, data[i]);
+                if (result)
+                    return result;
+                _patch.extra_len--;
+                _Patch_NextState();
+                break;
+            }
+        }
+    }
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  校验 APP 分区的基础固件
+ * @note   使用 _fpk_min_handle_buff 的前半作为读取缓存
+ * @param[in]  base_crc: 补丁头记录的基础固件的 CRC32 值
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Patch_CheckBase(uint32_t base_crc)
+{
+    int      read_len;
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t need_read_size;
+
+    _patch.base_part = GET_FLASH_OBJECT(APP_PART_NAME);
+    if (_patch.base_part == NULL)
+    {
+        BSP_Printf("%s: not found APP part.\r\n", __func__);
+        return FM_ERR_NO_THIS_PART;
+    }
+
+    if (_patch.base_size > _patch.base_part->len)
+    {
+        BSP_Printf("%s: base size error (%d).\r\n", __func__, _patch.base_size);
+        return FM_ERR_DELTA_BASE_ERR;
+    }
+
+    for (uint32_t posit = 0; posit < _patch.base_size; posit += read_len)
+    {
+        need_read_size = _patch.base_size - posit;
+        if (need_read_size > PATCH_CACHE_SIZE)
+            need_read_size = PATCH_CACHE_SIZE;
+
+        read_len = FLASH_PART_READ(_patch.base_part, posit, _fpk_min_handle_buff, need_read_size);
+        if (read_len <= 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+        crc = _CRC32_StepCalc(crc, _fpk_min_handle_buff, read_len);
+    }
+    crc ^= 0xFFFFFFFF;
+
+    if (crc != base_crc)
+    {
+        BSP_Printf("%s: base crc verify failed. (%.8X - %.8X)\r\n", __func__, base_crc, crc);
+        return FM_ERR_DELTA_BASE_ERR;
+    }
+
+    _patch.cache_len = 0;
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  读取基础固件的一个字节
+ * @note   读取位置不在缓存内时，从读取位置开始重新读取一个缓存的数据
+ * @param[out]  byte: 读取到的数据
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Patch_ReadBase(uint8_t *byte)
+{
+    int      read_len;
+    uint32_t need_read_size;
+
+    if (_patch.base_posit >= _patch.base_size)
+    {
+        BSP_Printf("%s: base posit error (%d).\r\n", __func__, _patch.base_posit);
+        return FM_ERR_DELTA_PATCH_ERR;
+    }
+
+    if (_patch.base_posit <  _patch.cache_posit
+    ||  _patch.base_posit >= _patch.cache_posit + _patch.cache_len)
+    {
+        need_read_size = _patch.base_size - _patch.base_posit;
+        if (need_read_size > PATCH_CACHE_SIZE)
+            need_read_size = PATCH_CACHE_SIZE;
+
+        read_len = FLASH_PART_READ(_patch.base_part, _patch.base_posit, _fpk_min_handle_buff, need_read_size);
+        if (read_len <= 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+        _patch.cache_posit = _patch.base_posit;
+        _patch.cache_len   = read_len;
+    }
+
+    *byte = _fpk_min_handle_buff[_patch.base_posit - _patch.cache_posit];
+    _patch.base_posit++;
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  输出一个还原后的字节
+ * @note   使用 _fpk_min_handle_buff 的后半作为写入缓存，缓存写满或已还原出 raw_size 的数据时写入 flash
+ * @param[in]  part: 分区对象
+ * @param[in]  byte: 还原后的数据
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Patch_Output(const struct FLASH_OBJECT *part, uint8_t byte)
+{
+    uint8_t  *out_buff = &_fpk_min_handle_buff[PATCH_CACHE_SIZE];
+    uint16_t write_size;
+
+    out_buff[_patch.out_len++] = byte;
+    _patch.out_size++;
+
+    if (_patch.out_len < PATCH_CACHE_SIZE && _patch.out_size < _fpk_head.raw_size)
+        return FM_ERR_OK;
+
+    /* 最后不足一个缓存的数据，补 0xFF 至 flash 最小写入单位 */
+    write_size = (_patch.out_len + ONCHIP_FLASH_ONCE_WRITE_BYTE - 1) / ONCHIP_FLASH_ONCE_WRITE_BYTE * ONCHIP_FLASH_ONCE_WRITE_BYTE;
+    memset(&out_buff[_patch.out_len], 0xFF, write_size - _patch.out_len);
+    _patch.out_len = 0;
+
+    return _Write_Flash(part, out_buff, write_size);
+}
+
+
+/**
+ * @brief  diff 或 extra 数据读取完毕时切换至下一个状态
+ * @note   一组数据全部读取完毕时，基础固件的读取位置偏移 seek
+ * @retval None
+ */
+static void _Patch_NextState(void)
+{
+    if (_patch.diff_len)
+        _patch.state = PATCH_STATE_DIFF;
+    else if (_patch.extra_len)
+        _patch.state = PATCH_STATE_EXTRA;
+    else
+    {
+        _patch.base_posit += _patch.seek;
+        _patch.state       = PATCH_STATE_CTRL;
+    }
+}
+#endif
+
+
+#if (IS_ENABLE_RESUME_TRANSFER)
+/**
+ * @brief  将固件包写入 download 分区并记录进度
+ * @note   固件包头写入后开始记录，之后写入位置每越过分区内一个 FPK_LEAST_HANDLE_BYTE 对齐的地址，追加一条该地址的记录，
+ *         续传时擦除该地址之后的数据不会影响之前的数据。调用前分区已擦除或为空，进度记录的区域也为空
+ * @param[in]  part: 分区对象
+ * @param[in]  data: 数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Journal_Write(const struct FLASH_OBJECT *part, uint8_t *data, uint16_t size)
+{
+    FM_ERR_CODE result;
+    bool     is_head = (_is_start_write == false);
+    uint32_t start   = FPK_HEAD_SIZE + _journal.offset;
+    uint32_t align   = (start + size) / FPK_LEAST_HANDLE_BYTE * FPK_LEAST_HANDLE_BYTE;
+
+    result = _Write_FirmwareSubPackage(part, data, size, false, FM_DIR_HOST_TO_DOWNLOAD);
+    if (result != FM_ERR_OK)
+        return result;
+
+    /* 固件包头，从空的进度记录开始 */
+    if (is_head)
+    {
+        _journal.is_enable = true;
+        _journal.slot      = 0;
+        _journal.offset    = 0;
+        _journal.body_crc  = 0xFFFFFFFF;
+        return _Journal_Append(part, 0);
+    }
+
+    if (_journal.is_enable == false)
+        return FM_ERR_OK;
+
+    /* 没有越过对齐的地址 */
+    if (align <= start)
+    {
+        _journal.body_crc = _CRC32_StepCalc(_journal.body_crc, data, size);
+        _journal.offset  += size;
+        return FM_ERR_OK;
+    }
+
+    /* 在对齐的地址处拆分，记录该地址之前的包体数据量和 CRC32 中间值 */
+    _journal.body_crc = _CRC32_StepCalc(_journal.body_crc, data, align - start);
+    _journal.offset  += align - start;
+
+    result = _Journal_Append(part, _journal.offset);
+    if (result != FM_ERR_OK)
+    {
+        _Reset_Write();
+        return result;
+    }
+
+    _journal.body_crc = _CRC32_StepCalc(_journal.body_crc, &data[align - start], start + size - align);
+    _journal.offset  += start + size - align;
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  读取最后一条有效的进度记录
+ * @note   写入中途掉电的记录校验不通过，跳过
+ * @param[in]   part: 分区对象
+ * @param[out]  record: 最后一条有效的记录
+ * @param[out]  slot: 下一条记录的位置
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Journal_Load(const struct FLASH_OBJECT *part, struct JOURNAL_RECORD *record, uint16_t *slot)
+{
+    uint8_t     i;
+    uint32_t    addr   = part->len - RESUME_JOURNAL_SIZE;
+    FM_ERR_CODE result = FM_ERR_NO_RESUME_JOURNAL;
+    struct JOURNAL_RECORD temp;
+
+    for (*slot = 0; *slot < JOURNAL_RECORD_NUM; (*slot)++)
+    {
+        if (FLASH_PART_READ(part, addr + *slot * JOURNAL_RECORD_SIZE, (uint8_t *)&temp, JOURNAL_RECORD_SIZE) < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+
+        /* 未写入的位置，其后的位置也未写入 */
+        for (i = 0; i < JOURNAL_RECORD_SIZE && ((uint8_t *)&temp)[i] == 0xFF; i++);
+        if (i == JOURNAL_RECORD_SIZE)
+            break;
+
+        if (temp.magic == JOURNAL_MAGIC
+        &&  temp.record_crc == _CRC32_Calc((uint8_t *)&temp, JOURNAL_RECORD_SIZE - 4))
+        {
+            *record = temp;
+            result  = FM_ERR_OK;
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * @brief  追加一条进度记录
+ * @note   写满后擦除进度记录的区域，从头开始记录
+ * @param[in]  part: 分区对象
+ * @param[in]  offset: 已写入 flash 的包体数据量，单位 byte ， JOURNAL_DONE_OFFSET: 已接收完毕
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Journal_Append(const struct FLASH_OBJECT *part, uint32_t offset)
+{
+    uint32_t addr = part->len - RESUME_JOURNAL_SIZE;
+    struct JOURNAL_RECORD record;
+
+#if (ENABLE_ERASE_AHEAD)
+    /* 进度记录的区域尚未擦除时先擦除 */
+    if (_Ahead_Ensure(part, addr, RESUME_JOURNAL_SIZE) != FM_ERR_OK)
+        return FM_ERR_ERASE_PART_ERR;
+#endif
+
+    if (_journal.slot >= JOURNAL_RECORD_NUM)
+    {
+        if (FLASH_PART_ERASE(part, addr, RESUME_JOURNAL_SIZE) < 0)
+        {
+            BSP_Printf("%s: erase error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_ERASE_PART_ERR;
+        }
+        _journal.slot = 0;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.magic      = JOURNAL_MAGIC;
+    record.head_crc   = _fpk_head.head_crc;
+    record.offset     = offset;
+    record.body_crc   = _journal.body_crc;
+    record.record_crc = _CRC32_Calc((uint8_t *)&record, JOURNAL_RECORD_SIZE - 4);
+
+    if (FLASH_PART_WRITE(part, addr + _journal.slot * JOURNAL_RECORD_SIZE, (uint8_t *)&record, JOURNAL_RECORD_SIZE) < 0)
+    {
+        BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+        return FM_ERR_WRITE_PART_ERR;
+    }
+    _journal.slot++;
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  校验已写入 flash 的包体数据
+ * @note   与进度记录中的 CRC32 中间值比对
+ * @param[in]  part: 分区对象
+ * @param[in]  size: 已写入的包体数据量，单位 byte
+ * @param[in]  body_crc: 进度记录中的 CRC32 中间值
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Journal_VerifyBody(const struct FLASH_OBJECT *part, uint32_t size, uint32_t body_crc)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t read_size;
+
+    for (uint32_t posit = 0; posit < size; posit += read_size)
+    {
+        read_size = (size - posit) < FPK_LEAST_HANDLE_BYTE ? (size - posit) : FPK_LEAST_HANDLE_BYTE;
+
+        if (FLASH_PART_READ(part, FPK_HEAD_SIZE + posit, _fpk_min_handle_buff, read_size) < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+        crc = _CRC32_StepCalc(crc, _fpk_min_handle_buff, read_size);
+    }
+
+    if (crc != body_crc)
+    {
+        BSP_Printf("%s: body crc verify failed. (%.8X - %.8X)\r\n", __func__, body_crc, crc);
+        return FM_ERR_NO_RESUME_JOURNAL;
+    }
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  擦除进度记录位置之后已写入的数据
+ * @note   传输中断前，进度记录位置之后可能已写入部分数据，从该位置开始逐个 FPK_LEAST_HANDLE_BYTE 检查，
+ *         擦除非空的区域，遇到空的区域即停止（数据是连续写入的）
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 进度记录的位置在分区内的地址，为 FPK_LEAST_HANDLE_BYTE 的整数倍
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Journal_EraseTail(const struct FLASH_OBJECT *part, uint32_t addr)
+{
+    uint32_t i;
+
+    for (; addr + FPK_LEAST_HANDLE_BYTE <= part->len - RESUME_JOURNAL_SIZE; addr += FPK_LEAST_HANDLE_BYTE)
+    {
+        if (FLASH_PART_READ(part, addr, _fpk_min_handle_buff, FPK_LEAST_HANDLE_BYTE) < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+
+        for (i = 0; i < FPK_LEAST_HANDLE_BYTE && _fpk_min_handle_buff[i] == 0xFF; i++);
+        if (i == FPK_LEAST_HANDLE_BYTE)
+            break;
+
+        if (FLASH_PART_ERASE(part, addr, FPK_LEAST_HANDLE_BYTE) < 0)
+        {
+            BSP_Printf("%s: erase error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_ERASE_PART_ERR;
+        }
+    }
+
+    return FM_ERR_OK;
+}
+#endif
+
+
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+/**
+ * @brief  与 APP 分区的现有数据比较，只擦除有差异的块
+ * @note   1. 按 INCREMENTAL_ERASE_UNIT 分块，将固件包完整地读取、解密、解压一遍，与 APP 分区逐块比较，
+ *            固件之后至分区末尾的数据需为擦除状态
+ *         2. 首地址数据在校验通过后才最后写入，因此首个块总是视为有差异，更新中途掉电时 APP 分区不会被视为完整
+ *         3. 有差异的块若已是擦除状态则不再擦除
+ * @param[in]  from_part_name: 放置需要更新至 APP 分区的固件包的分区
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _EraseAPPByCompare(const char *from_part_name)
+{
+    FM_ERR_CODE result;
+    const struct FLASH_OBJECT *app_part = NULL;
+
+    ASSERT(from_part_name != NULL);
+
+    app_part = GET_FLASH_OBJECT(APP_PART_NAME);
+    if (app_part == NULL)
+    {
+        BSP_Printf("%s: not found APP part.\r\n", __func__);
+        return FM_ERR_NO_THIS_PART;
+    }
+
+    memset(&_incr, 0, sizeof(_incr));
+
+    /* 比较阶段不写入，启用 ENABLE_ASYNC_FLASH 时也一次比较完毕 */
+    _incr.mode = INCR_MODE_COMPARE;
+    do
+    {
+        result = _UpdateToAPP(from_part_name);
+    } while (result == FM_ERR_BUSY);
+    _incr.mode = INCR_MODE_NONE;
+    if (result != FM_ERR_OK)
+        return result;
+
+    INCR_SET_DIRTY(0);
+
+    result = _Incr_CheckTail(app_part, _write_part_addr);
+    if (result != FM_ERR_OK)
+        return result;
+
+    result = _Incr_EraseDirty(app_part);
+    if (result != FM_ERR_OK)
+        return result;
+
+    _incr.mode = INCR_MODE_WRITE;
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  将写入 APP 分区的数据与分区的现有数据比较
+ * @note   数据不一致的块标记为有差异，已有差异的块不再读取
+ * @param[in]  part: APP 分区对象
+ * @param[in]  addr: 数据写入的相对地址
+ * @param[in]  data: 数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Incr_Compare(const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size)
+{
+    uint32_t unit;
+    uint32_t len;
+    uint32_t read_size;
+
+    if (addr + size > APP_PART_SIZE)
+    {
+        BSP_Printf("%s: firmware oversize (%d).\r\n", __func__, __LINE__);
+        return FM_ERR_WRITE_PART_ERR;
+    }
+
+    for (; size; addr += len, data += len, size -= len)
+    {
+        /* 每次比较至块末尾 */
+        unit = addr / INCREMENTAL_ERASE_UNIT;
+        len  = INCREMENTAL_ERASE_UNIT - (addr % INCREMENTAL_ERASE_UNIT);
+        if (len > size)
+            len = size;
+
+        if (INCR_IS_DIRTY(unit))
+            continue;
+
+        for (uint32_t posit = 0; posit < len; posit += read_size)
+        {
+            read_size = len - posit;
+            if (read_size > INCR_COMPARE_SIZE)
+                read_size = INCR_COMPARE_SIZE;
+
+            if (FLASH_PART_READ(part, addr + posit, _incr.buff, read_size) < 0)
+            {
+                BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+                return FM_ERR_READ_FLASH_ERR;
+            }
+
+            if (memcmp(_incr.buff, &data[posit], read_size))
+            {
+                INCR_SET_DIRTY(unit);
+                break;
+            }
+        }
+    }
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  只将有差异的块中的数据写入 APP 分区
+ * @note   
+ * @param[in]  part: APP 分区对象
+ * @param[in]  addr: 数据写入的相对地址
+ * @param[in]  data: 数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval 与 FLASH_PART_WRITE 相同， < 0 为写入失败
+ */
+static int  _Incr_Write(const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size)
+{
+    int      result = size;
+    uint32_t len;
+
+    for (; size; addr += len, data += len, size -= len)
+    {
+        len = INCREMENTAL_ERASE_UNIT - (addr % INCREMENTAL_ERASE_UNIT);
+        if (len > size)
+            len = size;
+
+        if (INCR_IS_DIRTY(addr / INCREMENTAL_ERASE_UNIT)
+        &&  FLASH_PART_WRITE(part, addr, data, len) < 0)
+            return -1;
+    }
+
+    return result;
+}
+
+
+/**
+ * @brief  检查固件之后的数据是否为擦除状态
+ * @note   全部擦除时固件之后的数据（含 VERSION_WRITE_TO_APP 记录的版本）均为擦除状态，增量写入也需如此，非擦除状态的块标记为有差异
+ * @param[in]  part: APP 分区对象
+ * @param[in]  addr: 固件末尾的相对地址
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Incr_CheckTail(const struct FLASH_OBJECT *part, uint32_t addr)
+{
+    uint32_t unit;
+    uint32_t end;
+    FM_ERR_CODE result;
+
+    for (; addr < APP_PART_SIZE; addr = end)
+    {
+        unit = addr / INCREMENTAL_ERASE_UNIT;
+        end  = (unit + 1) * INCREMENTAL_ERASE_UNIT;
+
+        if (INCR_IS_DIRTY(unit))
+            continue;
+
+        result = _IsErased(part, addr, end - addr, _fpk_min_handle_buff, FPK_LEAST_HANDLE_BYTE);
+        if (result == FM_ERR_FLASH_NO_EMPTY)
+            INCR_SET_DIRTY(unit);
+        else if (result != FM_ERR_OK)
+            return result;
+    }
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  擦除有差异的块
+ * @note   从首个块开始擦除，已是擦除状态的块跳过
+ * @param[in]  part: APP 分区对象
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Incr_EraseDirty(const struct FLASH_OBJECT *part)
+{
+    uint32_t dirty_num = 0;
+    uint32_t erase_num = 0;
+    FM_ERR_CODE result;
+
+    for (uint32_t unit = 0; unit < INCR_UNIT_NUM; unit++)
+    {
+        if (INCR_IS_DIRTY(unit) == 0)
+            continue;
+
+        dirty_num++;
+        result = _IsErased(part, unit * INCREMENTAL_ERASE_UNIT, INCREMENTAL_ERASE_UNIT, _fpk_min_handle_buff, FPK_LEAST_HANDLE_BYTE);
+        if (result == FM_ERR_OK)
+            continue;
+        else if (result != FM_ERR_FLASH_NO_EMPTY)
+            return result;
+
+        if (FLASH_PART_ERASE(part, unit * INCREMENTAL_ERASE_UNIT, INCREMENTAL_ERASE_UNIT) < 0)
+        {
+            BSP_Printf("%s: erase error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_ERASE_PART_ERR;
+        }
+        erase_num++;
+    }
+
+    BSP_Printf("%s: %d/%d units changed, %d erased\r\n", __func__, dirty_num, INCR_UNIT_NUM, erase_num);
+
+    return FM_ERR_OK;
+}
+#endif
+
+
+#if (ENABLE_STREAM_VERIFY)
+/**
+ * @brief  开始累加主机下发的固件包的包体 CRC32
+ * @note   包体的范围与 _VerifyFirmware 一致，差分固件包按还原后的固件包计算，调用前需确保 _fpk_head 已经读入了数据
+ * @param[in]  part: 分区对象
+ * @param[in]  is_app_part: 是否直接写入 APP 分区（写入的是源固件）
+ * @retval None
+ */
+static void _Stream_Start(const struct FLASH_OBJECT *part, bool is_app_part)
+{
+    memset(&_stream, 0, sizeof(_stream));
+    _stream.part      = part;
+    _stream.body_crc  = CRC32_INIT_VALUE;
+
+    if (is_app_part)
+    {
+        _stream.body_addr = 0;
+        _stream.body_size = _fpk_head.raw_size;
+    }
+    else
+    {
+        _stream.body_addr = FPK_HEAD_SIZE;
+        _stream.body_size = FM_IsDelta()? _fpk_head.raw_size : _fpk_head.pkg_size;
+    }
+}
+
+
+/**
+ * @brief  累加写入的数据中属于包体部分的 CRC32
+ * @note   在数据写入 flash 前调用，data 中含暂存的首地址数据，写入不连续时本次接收改为读取整个固件包校验
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 写入的相对地址
+ * @param[in]  data: 数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval None
+ */
+static void _Stream_Update(const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size)
+{
+    uint32_t begin = addr;
+    uint32_t end   = addr + size;
+
+    if (part != _stream.part)
+        return;
+
+    if (_stream.is_done || addr != _stream.next_addr)
+    {
+        BSP_Printf("%s: out of order (0x%.8X)\r\n", __func__, addr);
+        _stream.part = NULL;
+        return;
+    }
+    _stream.next_addr = end;
+
+#if (STREAM_VERIFY_READ_BACK)
+    _stream.last_addr = addr;
+    _stream.last_size = size;
+    _stream.last_crc  = _CRC32_Calc(data, size);
+#endif
+
+    /* 去掉包头和包体之后的填充 */
+    if (begin < _stream.body_addr)
+        begin = _stream.body_addr;
+    if (end > _stream.body_addr + _stream.body_size)
+        end = _stream.body_addr + _stream.body_size;
+
+    if (begin < end)
+        _stream.body_crc = _CRC32_StepCalc(_stream.body_crc, &data[begin - addr], end - begin);
+}
+
+
+/**
+ * @brief  获取接收时累加的包体 CRC32
+ * @note   STREAM_VERIFY_READ_BACK 为 1 时，先读回最后一次写入的数据，与写入时的 CRC32 比较
+ * @param[in]  part: 分区对象
+ * @param[in]  body_addr: 包体在分区中的相对地址
+ * @param[in]  body_size: 包体的数据量，单位 byte
+ * @param[out] body_crc: 包体的 CRC32 中间值（未取反）
+ * @retval true: 已获取 | false: 未完整累加该分区的包体或读回的数据不一致，需读取整个固件包校验
+ */
+static bool _Stream_GetBodyCRC(const struct FLASH_OBJECT *part, uint32_t body_addr, uint32_t body_size, uint32_t *body_crc)
+{
+    if (part != _stream.part
+    ||  _stream.is_done == false
+    ||  _stream.body_addr != body_addr
+    ||  _stream.body_size != body_size
+    ||  _stream.next_addr < body_addr + body_size)
+        return false;
+
+#if (STREAM_VERIFY_READ_BACK)
+    int      read_len  = 0;
+    uint32_t read_crc  = CRC32_INIT_VALUE;
+    uint32_t read_size = 0;
+
+    for (uint32_t posit = 0; posit < _stream.last_size; posit += read_len)
+    {
+        read_size = _stream.last_size - posit;
+        if (read_size > FPK_LEAST_HANDLE_BYTE)
+            read_size = FPK_LEAST_HANDLE_BYTE;
+
+        read_len = FLASH_PART_READ(part, _stream.last_addr + posit, &_fpk_min_handle_buff[0], read_size);
+        if (read_len <= 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return false;
+        }
+        read_crc = _CRC32_StepCalc(read_crc, &_fpk_min_handle_buff[0], read_len);
+    }
+
+    if ((read_crc ^ 0xFFFFFFFF) != _stream.last_crc)
+    {
+        BSP_Printf("%s: read back verify failed. (%.8X - %.8X)\r\n", __func__, _stream.last_crc, read_crc ^ 0xFFFFFFFF);
+        return false;
+    }
+#endif
+
+    *body_crc = _stream.body_crc;
+
+    return true;
+}
+#endif
+
+
+#if (USING_APP_WRITE_CHECK_PROJECT != APP_WRITE_CHECK_NONE)
+/**
+ * @brief  读回刚写入 APP 分区的数据，与 RAM 中的数据比较
+ * @note   APP_WRITE_CHECK_SAMPLE 时从首次写入开始，每 APP_WRITE_CHECK_SAMPLE_NUM 次写入检查一次
+ * @param[in]  part: APP 分区对象
+ * @param[in]  addr: 数据写入的相对地址
+ * @param[in]  data: 刚写入的数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Write_Check(const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *data, uint16_t size)
+{
+    uint32_t read_size;
+
+#if (USING_APP_WRITE_CHECK_PROJECT == APP_WRITE_CHECK_SAMPLE)
+    if ((_write_check.count++ % APP_WRITE_CHECK_SAMPLE_NUM) != 0)
+        return FM_ERR_OK;
+#endif
+
+#if (ENABLE_ASYNC_FLASH)
+    /* 数据尚在擦写队列中，写入完成后再读回，与写入前的 CRC32 比较 */
+    (void)read_size;
+    if (FA_Callback(part, addr, size, _CRC32_Calc(data, size), _Write_CheckDone) < 0)
+        return FM_ERR_WRITE_PART_ERR;
+
+    return FM_ERR_OK;
+#endif
+
+    for (uint32_t posit = 0; posit < size; posit += read_size)
+    {
+        read_size = size - posit;
+        if (read_size > WRITE_CHECK_SIZE)
+            read_size = WRITE_CHECK_SIZE;
+
+        if (FLASH_PART_READ(part, addr + posit, _write_check.buff, read_size) < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+
+        if (memcmp(_write_check.buff, &data[posit], read_size))
+        {
+            BSP_Printf("%s: mismatch at 0x%.8X\r\n", __func__, addr + posit);
+            return FM_ERR_WRITE_PART_ERR;
+        }
+    }
+
+    return FM_ERR_OK;
+}
+
+
+#if (ENABLE_ASYNC_FLASH)
+/**
+ * @brief  写入完成后读回 APP 分区的数据，与写入前的 CRC32 比较
+ * @note   由 flash_async.c 在排在其前面的擦写全部完成后调用
+ * @param[in]  part: APP 分区对象
+ * @param[in]  addr: 数据写入的相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @param[in]  crc: 写入前的数据的 CRC32
+ * @retval -1: 读取失败或数据不一致。 0: 一致
+ */
+static int _Write_CheckDone(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t crc)
+{
+    uint32_t read_size;
+    uint32_t read_crc = CRC32_INIT_VALUE;
+
+    for (uint32_t posit = 0; posit < size; posit += read_size)
+    {
+        read_size = size - posit;
+        if (read_size > WRITE_CHECK_SIZE)
+            read_size = WRITE_CHECK_SIZE;
+
+        if (FLASH_PART_READ(part, addr + posit, _write_check.buff, read_size) < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return -1;
+        }
+        read_crc = _CRC32_StepCalc(read_crc, _write_check.buff, read_size);
+    }
+
+    if ((read_crc ^ 0xFFFFFFFF) != crc)
+    {
+        BSP_Printf("%s: mismatch at 0x%.8X ~ 0x%.8X\r\n", __func__, addr, addr + size);
+        return -1;
+    }
+
+    return 0;
+}
+#endif
+#endif
+
+
+/**
+ * @brief  获取分区可能有数据的范围
+ * @note   首次获取时不确定分区中的数据， [0, limit) 均按遗留的数据处理
+ * @param[in]  part: 分区对象
+ * @param[in]  part_name: 分区名称
+ * @retval 分区可能有数据的范围
+ */
+static struct ERASE_EXTENT * _Extent_Get(const struct FLASH_OBJECT *part, const char *part_name)
+{
+    struct ERASE_EXTENT *extent = &_extent[0];
+
+    if (strncmp(part_name, DOWNLOAD_PART_NAME, MAX_NAME_LEN) == 0)
+        extent = &_extent[1];
+    else if (strncmp(part_name, FACTORY_PART_NAME, MAX_NAME_LEN) == 0)
+        extent = &_extent[2];
+
+    if (extent->part == part)
+        return extent;
+
+    extent->part  = part;
+    extent->limit = part->len;
+#if (USING_AUTO_UPDATE_PROJECT == VERSION_WRITE_TO_APP)
+    /* APP 分区末尾记录的固件版本 */
+    if (extent == &_extent[0])
+        extent->limit = _app_ver_addr / ERASE_ALIGN_SIZE * ERASE_ALIGN_SIZE;
+#endif
+#if (IS_ENABLE_RESUME_TRANSFER)
+    /* download 分区末尾的进度记录 */
+    if (extent == &_extent[1])
+        extent->limit = part->len - RESUME_JOURNAL_SIZE;
+#endif
+    extent->written     = 0;
+    extent->stale_begin = 0;
+    extent->stale_end   = extent->limit;
+#if (ENABLE_ERASE_STATE)
+    /* 按擦除状态的记录，只有记录的范围可能有数据 */
+    struct ERASE_STATE_RECORD *record = &_state.record[extent - _extent];
+    if (_state.parts[extent - _extent] == part && record->magic == ERASE_STATE_MAGIC)
+    {
+        extent->stale_begin = record->begin;
+        extent->stale_end   = (record->end < extent->limit)? record->end : extent->limit;
+    }
+#endif
+
+    return extent;
+}
+
+
+/**
+ * @brief  获取固件在分区中占用的范围
+ * @note   1. size 为 0 时取 _fpk_head 中固件包和源固件较大的一个
+ *         2. 加上固件包头和最后一个数据帧的协议填充（不超过 FPK_LEAST_HANDLE_BYTE ），按 ERASE_ALIGN_SIZE 对齐，不超过分区末尾的记录
+ * @param[in]  extent: 分区可能有数据的范围
+ * @param[in]  size: 固件的大小，单位 byte
+ * @retval 从分区首地址开始的长度，单位 byte
+ */
+static uint32_t _Extent_GetNeed(const struct ERASE_EXTENT *extent, uint32_t size)
+{
+    if (size == 0)
+        size = (_fpk_head.pkg_size > _fpk_head.raw_size)? _fpk_head.pkg_size : _fpk_head.raw_size;
+
+    if (size >= extent->limit)
+        return extent->limit;
+
+    size = ERASE_ALIGN_UP(size + FPK_HEAD_SIZE + FPK_LEAST_HANDLE_BYTE);
+
+    return (size < extent->limit)? size : extent->limit;
+}
+
+
+/**
+ * @brief  记录写入分区的范围
+ * @note   未获取过范围的分区不需要记录，其 [0, limit) 均按有数据处理
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 写入的相对地址
+ * @param[in]  size: 写入的数据量，单位 byte
+ * @retval None
+ */
+static void _Extent_Write(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    for (uint8_t i = 0; i < ERASE_PART_NUM; i++)
     {
-        BSP_Printf("%s: read error.\r\n", __func__);
-        return FM_ERR_READ_VER_ERR;
+        if (_extent[i].part == part && _extent[i].written < addr + size)
+            _extent[i].written = addr + size;
     }
+}
 
-    if (_fpk_head.fw_old_ver[0] != 0xFF
-    ||  _fpk_head.fw_old_ver[1] != 0xFF
-    ||  _fpk_head.fw_old_ver[2] != 0xFF
-    ||  _fpk_head.fw_old_ver[3] != 0xFF)
+
+/**
+ * @brief  记录分区的 [0, size) 已是擦除状态
+ * @note   超出该范围的已写入数据并入遗留的数据
+ * @param[in]  extent: 分区可能有数据的范围
+ * @param[in]  size: 从分区首地址开始的长度，单位 byte
+ * @retval None
+ */
+static void _Extent_Clean(struct ERASE_EXTENT *extent, uint32_t size)
+{
+    if (extent->written > size)
     {
-        BSP_Printf("%s: version area no erase.\r\n", __func__);
-        return FM_ERR_VER_AREA_NO_ERASE;
+        if (extent->stale_begin >= extent->stale_end)
+        {
+            extent->stale_begin = size;
+            extent->stale_end   = extent->written;
+        }
+        else if (extent->stale_end < extent->written)
+            extent->stale_end = extent->written;
     }
+    extent->written = 0;
 
-#if (ONCHIP_FLASH_ONCE_WRITE_BYTE > FPK_VERSION_SIZE)
-    uint8_t version[ONCHIP_FLASH_ONCE_WRITE_BYTE] = {0};
-    memcpy((uint8_t *)&version[0], (uint8_t *)&_fpk_head.fw_new_ver[0], FPK_VERSION_SIZE);
-    
-    if (FLASH_PART_WRITE(part, _app_ver_addr, (uint8_t *)&version[0], sizeof(version)) < 0)
+    if (extent->stale_begin < size)
+        extent->stale_begin = size;
+}
+
+
+/**
+ * @brief  获取 [0, need) 中可能有数据的范围
+ * @note   按 ERASE_ALIGN_SIZE 对齐，不超过分区末尾的记录
+ * @param[in]  extent: 分区可能有数据的范围
+ * @param[in]  need: 从分区首地址开始的长度，单位 byte
+ * @param[out] addr: 范围的相对地址
+ * @param[out] size: 范围的长度，单位 byte
+ * @retval false: 已是擦除状态 | true: 可能有数据
+ */
+static bool _Extent_GetDirty(const struct ERASE_EXTENT *extent, uint32_t need, uint32_t *addr, uint32_t *size)
+{
+    uint32_t begin = need;
+    uint32_t end   = 0;
+
+    if (extent->written)
     {
-        BSP_Printf("%s: write error.\r\n", __func__);
-        return FM_ERR_WRITE_VER_ERR;
+        begin = 0;
+        end   = (extent->written < need)? extent->written : need;
     }
-#else
-    if (FLASH_PART_WRITE(part, _app_ver_addr, (uint8_t *)&_fpk_head.fw_new_ver[0], FPK_VERSION_SIZE) < 0)
+
+    if (extent->stale_begin < extent->stale_end && extent->stale_begin < need)
     {
-        BSP_Printf("%s: write error.\r\n", __func__);
-        return FM_ERR_WRITE_VER_ERR;
+        if (extent->stale_begin < begin)
+            begin = extent->stale_begin;
+        if (extent->stale_end > end)
+            end = (extent->stale_end < need)? extent->stale_end : need;
     }
+
+    if (begin >= end)
+        return false;
+
+    *addr = begin / ERASE_ALIGN_SIZE * ERASE_ALIGN_SIZE;
+    end   = ERASE_ALIGN_UP(end);
+    *size = ((end < extent->limit)? end : extent->limit) - *addr;
+
+    return true;
+}
+
+
+/**
+ * @brief  获取分区所在 flash 的 sector 布局
+ * @note   
+ * @param[in]   part: 分区对象
+ * @param[out]  base: 分区首地址在 flash 中的偏移地址
+ * @retval flash 的 sector 布局，移植文件不提供时为 NULL
+ */
+static const struct BSP_FLASH_GEOMETRY * _Erase_GetGeometry(const struct FLASH_OBJECT *part, uint32_t *base)
+{
+    const struct BSP_FLASH_GEOMETRY *geometry = NULL;
+
+#if (IS_ENABLE_SPI_FLASH)
+    const struct fal_flash_dev *dev = fal_flash_device_find(part->flash_name);
+
+    geometry = BSP_Flash_GetGeometry(part->flash_name);
+    if (geometry == NULL || dev == NULL)
+        return NULL;
+    *base = dev->addr + part->offset - geometry->addr;
+#else
+    geometry = BSP_Flash_GetGeometry(NULL);
+    if (geometry == NULL)
+        return NULL;
+    *base = part->addr - geometry->addr;
 #endif
 
-    return FM_ERR_OK;
+    return geometry;
 }
 
-#endif /* #if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT) */
 
-#endif /* #if (USING_PART_PROJECT > ONE_PART_PROJECT) */
+#if (ENABLE_ERASE_AHEAD)
+/**
+ * @brief  获取从 addr 开始的一次擦除的长度
+ * @note   1. 按 flash 的擦除计划延伸至 addr 所在的 sector 或块的末尾，不小于 ERASE_ALIGN_SIZE ，不超过 end
+ *         2. 移植文件不提供 sector 布局时为 ERASE_ALIGN_SIZE
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 擦除的相对地址
+ * @param[in]  end: 擦除范围的相对结束地址（不含）
+ * @retval 擦除的长度，单位 byte
+ */
+static uint32_t _Erase_GetStep(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t end)
+{
+    uint32_t base = 0;
+    uint32_t step_end = addr + ERASE_ALIGN_SIZE;
+    struct BSP_FLASH_ERASE_STEP step;
+    const struct BSP_FLASH_GEOMETRY *geometry = _Erase_GetGeometry(part, &base);
+
+    if (geometry && BSP_Flash_PlanErase(geometry, base + addr, base + end, &step) == 0
+    &&  step.offset + step.size - base > step_end)
+    {
+        step_end = step.offset + step.size - base;
+    }
+
+    return ((step_end < end)? step_end : end) - addr;
+}
+#endif
 
 
-/* Private functions ---------------------------------------------------------*/
 /**
- * @brief  复位写固件的一些记录信息
+ * @brief  检查分区的某段数据是否为擦除状态
  * @note   
- * @retval None
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @param[in]  buff: 读取数据的缓存
+ * @param[in]  buff_size: 缓存的大小，单位 byte
+ * @retval FM_ERR_OK: 擦除状态 | FM_ERR_FLASH_NO_EMPTY: 非擦除状态 | 其他: 读取错误
  */
-static void _Reset_Write(void)
+static FM_ERR_CODE  _IsErased(const struct FLASH_OBJECT *part, 
+                              uint32_t addr, 
+                              uint32_t size, 
+                              uint8_t  *buff, 
+                              uint32_t buff_size)
 {
-    _is_start_write      = false;   /* 固件开始写入的标志位 */
-    _update_progress     = 0;       /* 固件更新的进度， 10000 制 */
-    _storage_data_size   = 0;       /* 固件包写入时记录暂存的固件分包大小，单位 byte */
-    _write_part_addr     = 0;       /* 固件包写入时记录写入 flash 的相对地址 */
-    _write_last_pkg_size = 0;       /* 固件包写入时最后一个分包的大小，单位 byte */
+    uint32_t read_size;
+
+    for (; size; addr += read_size, size -= read_size)
+    {
+        read_size = (size > buff_size)? buff_size : size;
+
+        if (FLASH_PART_READ(part, addr, buff, read_size) < 0)
+        {
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_READ_FLASH_ERR;
+        }
+
+        for (uint32_t i = 0; i < read_size; i++)
+        {
+            if (buff[i] != 0xFF)
+                return FM_ERR_FLASH_NO_EMPTY;
+        }
+    }
+
+    return FM_ERR_OK;
 }
 
 
+#if (ENABLE_ERASE_AHEAD)
 /**
- * @brief  将固件分包按顺序写入某个分区
- * @note   循环调用本函数，无须指定写入地址，函数内部自行记录已写入的大小
- * @param[in]  part: 分区对象
- * @param[in]  data: 数据
- * @param[in]  pkg_size: 数据大小，单位 byte
- * @param[in]  is_decrypt: false: 不解密直接写入 | true: 解密后写入
+ * @brief  擦除 _ahead 中的下一个块
+ * @note   1. 已是擦除状态时不再擦除，擦除后从遗留的数据中移除
+ *         2. 块按擦除计划对齐到实际的 sector 或块，大于 ERASE_ALIGN_SIZE 的 sector 只擦除一次
+ * @param[in]  is_tail: false: 下一个块 | true: 分区末尾的记录
  * @retval FM_ERR_CODE
  */
-static FM_ERR_CODE  _Write_FirmwareSubPackage( const struct FLASH_OBJECT *part, 
-                                               uint8_t  *data, 
-                                               uint16_t pkg_size, 
-                                               bool     is_decrypt,
-                                               FM_FIRMWARE_WRITE_DIR  write_dir)
+static FM_ERR_CODE  _Ahead_Step(bool is_tail)
 {
-    uint8_t *fw_4096byte_buff = data;
+    uint32_t addr;
+    uint32_t size;
+    FM_ERR_CODE result;
+    struct ERASE_EXTENT *extent = _ahead.extent;
 
-    /* 主机直接下发的固件分包不满 FPK_LEAST_HANDLE_BYTE 个字节，需要先暂存至满足后再写入 */
-    if (write_dir == FM_DIR_HOST_TO_APP)
+    if (is_tail)
+    {
+        addr = extent->limit;
+        size = extent->part->len - extent->limit;
+    }
+    else
     {
-        fw_4096byte_buff = &_fpk_min_handle_buff[0];
+        addr = _ahead.next;
+        size = _Erase_GetStep(extent->part, addr, _ahead.end);
+    }
 
-        /* 判断是否是最后一个包 */
-        if (_storage_data_size == 0)
+    PERF_STATS_BEGIN(PERF_FM_ERASE_AHEAD);
+    result = _IsErased(extent->part, addr, size, _ahead.buff, ERASE_AHEAD_READ_SIZE);
+    if (result == FM_ERR_FLASH_NO_EMPTY)
+    {
+        result = FM_ERR_OK;
+        if (FLASH_PART_ERASE(extent->part, addr, size) < 0)
         {
-            if (_fpk_head.pkg_size - _write_part_addr < FPK_LEAST_HANDLE_BYTE)
-            {
-                /* 最后一个固件分包的标志 */
-                _write_last_pkg_size = _fpk_head.pkg_size - _write_part_addr;
-            }
+            BSP_Printf("%s: erase error (%d).\r\n", __func__, __LINE__);
+            result = FM_ERR_ERASE_PART_ERR;
         }
-        
-        /* 小于最小处理单位时，暂存 */
-        if (_storage_data_size < FPK_LEAST_HANDLE_BYTE)
+    }
+    PERF_STATS_END(PERF_FM_ERASE_AHEAD);
+
+    if (result != FM_ERR_OK)
+        return result;
+
+    if (is_tail)
+        _ahead.is_tail = false;
+    else
+    {
+        _ahead.next += size;
+        if (extent->stale_begin < _ahead.next)
+            extent->stale_begin = _ahead.next;
+    }
+
+    return FM_ERR_OK;
+}
+
+
+/**
+ * @brief  确保分区的某段范围已擦除
+ * @note   按顺序擦除至该范围的结束地址，不是 _ahead 中的分区时无须处理
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _Ahead_Ensure(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    uint32_t    end    = addr + size;
+    FM_ERR_CODE result = FM_ERR_OK;
+
+    if (_ahead.extent == NULL || _ahead.extent->part != part)
+        return FM_ERR_OK;
+
+    /* 分区末尾的记录 */
+    if (_ahead.is_tail && end > _ahead.extent->limit)
+        result = _Ahead_Step(true);
+
+    /* 按顺序擦除至写入范围的结束地址，只写入分区末尾的记录时无须擦除之前的块 */
+    if (end > _ahead.extent->limit)
+        end = _ahead.extent->limit;
+
+    while (result == FM_ERR_OK && addr < end && _ahead.next < _ahead.end && _ahead.next < end)
+        result = _Ahead_Step(false);
+
+    return result;
+}
+
+
+/**
+ * @brief  停止擦除某个分区
+ * @note   未擦除的范围仍记录在遗留的数据中
+ * @param[in]  part: 分区对象
+ * @retval None
+ */
+static void _Ahead_Cancel(const struct FLASH_OBJECT *part)
+{
+    if (_ahead.extent && _ahead.extent->part == part)
+        _ahead.extent = NULL;
+}
+#endif
+
+#if (ENABLE_ERASE_STATE)
+/**
+ * @brief  读取各分区的擦除状态记录
+ * @note   1. 以各分区最后一条有效的记录为准，没有记录的分区 [0, limit) 均按有数据处理
+ *         2. 有未结束的写入或不完整的记录时为写入期间复位或掉电，启用 ENABLE_ERASE_STATE_VERIFY 时本次启动不使用记录
+ * @retval None
+ */
+static void _State_Load(void)
+{
+    uint8_t  i;
+    bool     is_reset = false;
+    struct ERASE_STATE_RECORD temp;
+
+    memset(&_state, 0, sizeof(_state));
+
+    _state.parts[0] = GET_FLASH_OBJECT(APP_PART_NAME);
+#if (USING_PART_PROJECT > ONE_PART_PROJECT)
+    _state.parts[1] = GET_FLASH_OBJECT(DOWNLOAD_PART_NAME);
+    #if (USING_PART_PROJECT > DOUBLE_PART_PROJECT)
+    _state.parts[2] = GET_FLASH_OBJECT(FACTORY_PART_NAME);
+    #endif
+#endif
+
+    _state.part = GET_FLASH_OBJECT(ERASE_STATE_PART_NAME);
+    if (_state.part == NULL)
+    {
+        BSP_Printf("%s: not found %s part.\r\n", __func__, ERASE_STATE_PART_NAME);
+        return;
+    }
+
+    for (_state.slot = 0; _state.slot < ERASE_STATE_RECORD_NUM; _state.slot++)
+    {
+        if (FLASH_PART_READ(_state.part, _state.slot * ERASE_STATE_RECORD_SIZE, (uint8_t *)&temp, ERASE_STATE_RECORD_SIZE) < 0)
         {
-            memcpy(&fw_4096byte_buff[_storage_data_size], data, pkg_size);
-            _storage_data_size += pkg_size;
-            
-            if (_write_last_pkg_size)
-            {
-                if (_storage_data_size < _write_last_pkg_size)
-                    return FM_ERR_OK;
-            }   
-            else if (_storage_data_size < FPK_LEAST_HANDLE_BYTE)
-                return FM_ERR_OK;
+            BSP_Printf("%s: read error (%d).\r\n", __func__, __LINE__);
+            _state.part = NULL;
+            memset(_state.record, 0, sizeof(_state.record));
+            return;
         }
+
+        /* 未写入的位置，其后的位置也未写入 */
+        for (i = 0; i < ERASE_STATE_RECORD_SIZE && ((uint8_t *)&temp)[i] == 0xFF; i++);
+        if (i == ERASE_STATE_RECORD_SIZE)
+            break;
+
+        if (temp.magic == ERASE_STATE_MAGIC
+        &&  temp.index < ERASE_PART_NUM
+        &&  temp.record_crc == _CRC32_Calc((uint8_t *)&temp, ERASE_STATE_RECORD_SIZE - 4))
+            _state.record[temp.index] = temp;
+        else
+            is_reset = true;
     }
-    /* 从 download 或 factory 更新至 APP ，因可以直接读取 FPK_LEAST_HANDLE_BYTE 个字节，所以无须暂存 */
-    else
-        _storage_data_size = pkg_size;
 
-#if (ENABLE_DECRYPT)
-    if (is_decrypt)
-        AES_CBC_decrypt_buffer(&_aes_ctx, &fw_4096byte_buff[0], _storage_data_size);
+    for (i = 0; i < ERASE_PART_NUM; i++)
+    {
+        if (_state.record[i].magic == ERASE_STATE_MAGIC && _state.record[i].is_writing)
+            is_reset = true;
+    }
+
+#if (ENABLE_ERASE_STATE_VERIFY)
+    if (is_reset)
+    {
+        BSP_Printf("%s: unfinished write found, check the partitions again\r\n", __func__);
+        memset(_state.record, 0, sizeof(_state.record));
+    }
+#else
+    (void)is_reset;
 #endif
+}
 
-    /* 保存首地址的几个字节数据，等待最后写入 */
-    if (_is_start_write == false)
-    {   
-        for (uint8_t i = 0; i < ONCHIP_FLASH_ONCE_WRITE_BYTE; i++)
-            _fw_first_bytes[i]  = fw_4096byte_buff[i];
 
-        fw_4096byte_buff   += ONCHIP_FLASH_ONCE_WRITE_BYTE;
-        _storage_data_size -= ONCHIP_FLASH_ONCE_WRITE_BYTE;
-        _write_part_addr    = ONCHIP_FLASH_ONCE_WRITE_BYTE;
+/**
+ * @brief  追加一条擦除状态记录
+ * @note   写满后擦除记录区，从头重写各分区最后的记录
+ * @param[in]  index: 分区在 _extent 中的序号
+ * @param[in]  begin: 可能有数据的起始相对地址
+ * @param[in]  end: 可能有数据的结束相对地址
+ * @param[in]  is_writing: 写入是否尚未结束
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _State_Append(uint8_t index, uint32_t begin, uint32_t end, bool is_writing)
+{
+    uint8_t i;
+    struct ERASE_STATE_RECORD *record = &_state.record[index];
+
+    memset(record, 0, sizeof(struct ERASE_STATE_RECORD));
+    record->magic      = ERASE_STATE_MAGIC;
+    record->index      = index;
+    record->begin      = begin;
+    record->end        = end;
+    record->is_writing = is_writing;
+    record->record_crc = _CRC32_Calc((uint8_t *)record, ERASE_STATE_RECORD_SIZE - 4);
+
+    if (_state.slot < ERASE_STATE_RECORD_NUM)
+    {
+        if (FLASH_PART_WRITE(_state.part, _state.slot * ERASE_STATE_RECORD_SIZE, (uint8_t *)record, ERASE_STATE_RECORD_SIZE) < 0)
+        {
+            BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_WRITE_PART_ERR;
+        }
+        _state.slot++;
+        return FM_ERR_OK;
     }
-     
-    if (FLASH_PART_WRITE(part, _write_part_addr, fw_4096byte_buff, _storage_data_size) < 0)
+
+    /* 擦除后至重写完毕前复位时没有记录，各分区均按有数据处理 */
+    if (FLASH_PART_ERASE(_state.part, 0, ERASE_STATE_SIZE) < 0)
     {
-        BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
-        _Reset_Write();
-        return FM_ERR_WRITE_PART_ERR;
+        BSP_Printf("%s: erase error (%d).\r\n", __func__, __LINE__);
+        return FM_ERR_ERASE_PART_ERR;
     }
 
-    _write_part_addr  += _storage_data_size;
-    _storage_data_size = 0;
-    _is_start_write    = true;
+    for (_state.slot = 0, i = 0; i < ERASE_PART_NUM; i++)
+    {
+        if (_state.record[i].magic != ERASE_STATE_MAGIC)
+            continue;
+
+        if (FLASH_PART_WRITE(_state.part, _state.slot * ERASE_STATE_RECORD_SIZE, (uint8_t *)&_state.record[i], ERASE_STATE_RECORD_SIZE) < 0)
+        {
+            BSP_Printf("%s: write error (%d).\r\n", __func__, __LINE__);
+            return FM_ERR_WRITE_PART_ERR;
+        }
+        _state.slot++;
+    }
 
-    _update_progress += _update_progress_step_num;
-    Firmware_OperateCallback(_update_progress);
-    
     return FM_ERR_OK;
 }
 
 
 /**
- * @brief  CRC32 计算表初始化
- * @note   
- * @param[in]  poly: 多项式
+ * @brief  写入分区前记录写入位置之后有数据
+ * @note   写入位置已在记录的范围内时不再记录，否则记录写入位置至分区末尾，一次写入过程一般只追加一条记录
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 写入的相对地址
+ * @param[in]  size: 写入的数据量，单位 byte
+ * @retval FM_ERR_CODE
+ */
+static FM_ERR_CODE  _State_Write(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    uint8_t  i;
+    uint32_t begin;
+    struct ERASE_STATE_RECORD *record;
+
+    if (_state.part == NULL)
+        return FM_ERR_OK;
+
+    for (i = 0; i < ERASE_PART_NUM && _state.parts[i] != part; i++);
+    if (i == ERASE_PART_NUM)
+        return FM_ERR_OK;
+
+    /* 没有记录时 [0, limit) 均按有数据处理，分区末尾的记录每次都检查 */
+    record = &_state.record[i];
+    if (record->magic != ERASE_STATE_MAGIC)
+        return FM_ERR_OK;
+    if (record->begin < record->end && record->begin <= addr && addr + size <= record->end)
+        return FM_ERR_OK;
+
+    begin = addr / ERASE_ALIGN_SIZE * ERASE_ALIGN_SIZE;
+    if (record->begin < record->end && record->begin < begin)
+        begin = record->begin;
+
+    return _State_Append(i, begin, part->len, true);
+}
+
+
+/**
+ * @brief  按分区可能有数据的范围重新记录
+ * @note   在擦除、检查为空或写入结束后调用。未获取过范围的分区保持记录的范围，记录相同时不再追加
+ * @param[in]  part: 分区对象
  * @retval None
  */
-static void _CRC32_Init(uint32_t poly)
+static void _State_Save(const struct FLASH_OBJECT *part)
 {
-    uint32_t i, j, c;
-    uint32_t var = 0;
+    uint8_t  i;
+    uint32_t addr = 0;
+    uint32_t size = 0;
+    struct ERASE_STATE_RECORD *record;
+
+    if (_state.part == NULL)
+        return;
 
-    for (i = 0; i < 32; i++)
+    for (i = 0; i < ERASE_PART_NUM && _state.parts[i] != part; i++);
+    if (i == ERASE_PART_NUM)
+        return;
+
+    record = &_state.record[i];
+    if (_extent[i].part == part)
+    {
+        if (_Extent_GetDirty(&_extent[i], _extent[i].limit, &addr, &size) == false)
+            addr = size = 0;
+    }
+    else if (record->magic == ERASE_STATE_MAGIC)
     {
-        if (poly & 0x00000001)
-            var |= 1 << (32 - 1 - i);
+        addr = record->begin;
+        size = (record->end > record->begin)? record->end - record->begin : 0;
+    }
+    else
+        return;
+
+    if (record->magic == ERASE_STATE_MAGIC
+    &&  record->is_writing == false
+    &&  record->begin == addr
+    &&  record->end   == addr + size)
+        return;
+
+    if (_State_Append(i, addr, addr + size, false) != FM_ERR_OK)
+        BSP_Printf("%s: save erase state failed.\r\n", __func__);
+}
+#endif
+
+#if (ENABLE_ASYNC_FLASH)
+/**
+ * @brief  获取排队的擦写的结果
+ * @note   失败时其余的擦写已丢弃，复位队列后重新记录各分区的擦除状态，返回的错误由调用者按原有的流程处理
+ * @param[in]  part: 分区对象，为 NULL 时为所有分区
+ * @retval FM_ERR_OK: 已全部完成。 FM_ERR_BUSY: 尚未完成，需再次调用。其他: 擦写失败
+ */
+static FM_ERR_CODE  _Async_Result(const struct FLASH_OBJECT *part)
+{
+    FA_STATUS status;
+
+    FA_Process();
+    status = FA_GetStatus(part);
+    if (status == FA_STATUS_IDLE)
+        return FM_ERR_OK;
+    if (status == FA_STATUS_BUSY)
+        return FM_ERR_BUSY;
 
-        poly >>= 1;
+    BSP_Printf("%s: flash %s failed.\r\n", __func__, (status == FA_STATUS_ERASE_ERR)? "erase" : "write");
+    FA_Reset();
+
+#if (ENABLE_ERASE_STATE)
+    /* 丢弃的擦除使记录与分区中的数据不一致，按丢弃后的范围重新记录 */
+    for (uint8_t i = 0; i < ERASE_PART_NUM; i++)
+    {
+        if (_extent[i].part == NULL)
+            continue;
+        _state.record[i].is_writing = true;
+        _State_Save(_extent[i].part);
     }
+#endif
+
+    return (status == FA_STATUS_ERASE_ERR)? FM_ERR_ERASE_PART_ERR : FM_ERR_WRITE_PART_ERR;
+}
+
+
+/**
+ * @brief  擦写失败后，逐个处理被丢弃的擦写
+ * @note   1. 被丢弃的擦除范围不再是擦除状态，分区均按有数据处理
+ *         2. 丢弃的写入不影响数据范围的记录，记录只会多于实际有数据的范围
+ *         3. 丢弃了记录区的写入时，下次记录前擦除并重写记录区
+ * @param[in]  op: 被丢弃的操作
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval None
+ */
+static void _Async_Discard(FA_OP op, const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    (void)addr;
+    (void)size;
 
-    for (i = 0; i < 256; i++)
+    if (op == FA_OP_ERASE)
     {
-        c = i;
-        for (j = 0; j < 8; j++)
+        for (uint8_t i = 0; i < ERASE_PART_NUM; i++)
         {
-            if (c & 0x00000001)
-                c = var ^ (c >> 1);
-            else
-                c >>= 1;
+            if (_extent[i].part != part)
+                continue;
+            _extent[i].written     = 0;
+            _extent[i].stale_begin = 0;
+            _extent[i].stale_end   = _extent[i].limit;
         }
-        _crc_tab[i] = c;
+    #if (ENABLE_ERASE_AHEAD)
+        _Ahead_Cancel(part);
+    #endif
     }
+
+#if (ENABLE_ERASE_STATE)
+    if (part == _state.part)
+        _state.slot = ERASE_STATE_RECORD_NUM;
+#endif
 }
+#endif
 
 
 /**
@@ -1107,9 +4231,7 @@ static void _CRC32_Init(uint32_t poly)
  */
 static uint32_t _CRC32_Calc(uint8_t *buf, uint32_t len)
 {
-    uint32_t crc_init = 0xFFFFFFFF;
-
-    return (_CRC32_StepCalc(crc_init, buf, len) ^ 0xFFFFFFFF);
+    return (_CRC32_StepCalc(CRC32_INIT_VALUE, buf, len) ^ 0xFFFFFFFF);
 }
 
 
@@ -1123,13 +4245,11 @@ static uint32_t _CRC32_Calc(uint8_t *buf, uint32_t len)
  */
 static uint32_t _CRC32_StepCalc(uint32_t crc_init, uint8_t *buf, uint32_t len)
 {
-    uint8_t index;
+    PERF_STATS_BEGIN(PERF_CRC32);
 
-    for (uint32_t i = 0; i < len; i++)
-    {
-        index = (uint8_t)(crc_init ^ buf[i]);
-        crc_init = (crc_init >> 8) ^ _crc_tab[index];
-    }
+    crc_init = CRC32_StepCalc(crc_init, buf, len);
+
+    PERF_STATS_END(PERF_CRC32);
 
     return crc_init;
 }
@@ -29,18 +29,29 @@
  * This file is part of mOTA - The Over-The-Air technology component for MCU.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.2
+ * Version:         v1.0.3
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-23     Dino         the first version
  * 2022-12-07     Dino         修复 STM32L4 写入 flash 的最小单位问题
  * 2022-12-10     Dino         增加对 SPI flash 的支持
+ * 2026-10-18                  引入 perf_stats.h 的耗时统计
+ * 2026-10-18                  增加固件包压缩的选项和错误代码
+ * 2026-10-18                  增加差分固件包的选项和错误代码
+ * 2026-10-18                  增加断点续传的接口和错误代码
+ * 2026-10-18                  增加增量写入 APP 分区的接口
+ * 2026-10-18                  CRC 计算移至 crc_engine.c
+ * 2026-10-18                  增加接收时逐块擦除的接口
+ * 2026-10-18                  flash 的擦写改由 flash_async.c 排队执行，增加 FM_ERR_BUSY
  */
 
 #ifndef __FIRMWARE_MANAGE_H__
 #define __FIRMWARE_MANAGE_H__
 
 #include "bsp_common.h"
+#include "perf_stats.h"
+#include "crc_engine.h"
+#include "flash_async.h"
 
 /* fpk: Firmware Package */
 #define FPK_LEAST_HANDLE_BYTE           4096
@@ -50,7 +61,11 @@
 #define FPK_HEAD_SIZE                   sizeof(struct FPK_HEAD)
 #define FPK_IDENTIFIER                  0x006B7066
 
-#define CRC32_POLYNOMIAL                0x04C11DB7
+/* 断点续传的进度记录放在 download 分区，单分区方案没有 download 分区 */
+#define IS_ENABLE_RESUME_TRANSFER       (ENABLE_RESUME_TRANSFER && USING_PART_PROJECT > ONE_PART_PROJECT)
+
+/* 增量写入比较的是 download/factory 分区中的固件包，单分区方案直接写入 APP 分区 */
+#define IS_ENABLE_INCREMENTAL_UPDATE    (ENABLE_INCREMENTAL_UPDATE && USING_PART_PROJECT > ONE_PART_PROJECT)
 
 /* 固件操作的错误代码 */
 typedef enum 
@@ -82,6 +97,13 @@ typedef enum
     FM_ERR_WRITE_VER_ERR                = 0x1D,             /* 固件的版本写入 APP 分区失败 */
     FM_ERR_VER_AREA_NO_ERASE            = 0x1E,             /* APP 分区的固件版本区域没有擦除 */
     FM_ERR_READ_FLASH_ERR               = 0x1F,             /* 读取 flash 错误 */
+    FM_ERR_NO_DECOMPRESS_COMPONENT      = 0x20,             /* 从机没有解压组件或解压窗口不足，无法解压 */
+    FM_ERR_DECOMPRESS_ERR               = 0x21,             /* 固件解压失败 */
+    FM_ERR_NO_DELTA_COMPONENT           = 0x22,             /* 从机没有差分组件或为单分区方案，无法还原差分固件包 */
+    FM_ERR_DELTA_BASE_ERR               = 0x23,             /* 差分固件包的基础固件与 APP 分区的固件不一致 */
+    FM_ERR_DELTA_PATCH_ERR              = 0x24,             /* 差分固件包还原失败 */
+    FM_ERR_NO_RESUME_JOURNAL            = 0x25,             /* 没有与固件包一致的进度记录或已写入的数据校验失败，无法续传 */
+    FM_ERR_BUSY                         = 0x26,             /* flash 的擦写尚未完成，需再次调用 */
 
 } FM_ERR_CODE;
 
@@ -116,6 +138,8 @@ FPK_HEAD
 
 void            FM_Init                     (void);
 bool            FM_IsEncrypt                (void);
+bool            FM_IsCompress               (void);
+bool            FM_IsDelta                  (void);
 FM_ERR_CODE     FM_IsEmpty                  (const char *part_name);
 char *          FM_GetNewFirmwareVersion    (void);
 uint32_t        FM_GetRawCRC32              (void);
@@ -125,6 +149,10 @@ FM_ERR_CODE     FM_EraseFirmware            (const char *part_name);
 FM_ERR_CODE     FM_WriteFirmwareDone        (const char *part_name);
 FM_ERR_CODE     FM_WriteFirmwareSubPackage  (const char *part_name, uint8_t *data, uint16_t pkg_size);
 FM_ERR_CODE     FM_CheckFirmwareIntegrity   (uint32_t addr);
+#if (ENABLE_ERASE_AHEAD)
+FM_ERR_CODE     FM_EraseFirmwareAhead       (const char *part_name, uint32_t size);
+FM_ERR_CODE     FM_EraseAheadProcess        (void);
+#endif
 
 #if (USING_PART_PROJECT > ONE_PART_PROJECT)
 uint8_t         FM_IsNeedAutoUpdate         (void);
@@ -133,6 +161,12 @@ char *          FM_GetOldFirmwareVersion    (void);
 uint32_t        FM_GetPackageCRC32          (void);
 FM_ERR_CODE     FM_ReadFirmwareHead         (const char *part_name);
 FM_ERR_CODE     FM_UpdateToAPP              (const char *from_part_name);
+#if (IS_ENABLE_INCREMENTAL_UPDATE)
+FM_ERR_CODE     FM_EraseAPPByCompare        (const char *from_part_name);
+#endif
+#if (IS_ENABLE_RESUME_TRANSFER)
+FM_ERR_CODE     FM_ResumeFirmware           (const char *part_name, uint32_t *offset);
+#endif
 #if (USING_AUTO_UPDATE_PROJECT == MODIFY_DOWNLOAD_PART_PROJECT ||   \
      USING_AUTO_UPDATE_PROJECT == VERSION_WRITE_TO_APP)
 FM_ERR_CODE     FM_UpdateFirmwareVersion    (const char *part_name);
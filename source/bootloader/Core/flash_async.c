@@ -0,0 +1,689 @@
+/**
+ * \file            flash_async.c
+ * \brief           asynchronous flash erase and program queue
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.0
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "flash_async.h"
+
+#if (ENABLE_ASYNC_FLASH)
+
+/* Private define ------------------------------------------------------------*/
+#if (IS_ENABLE_SPI_FLASH)
+    #define FA_DEV_NUM          4                               /* 按 FAL 的 flash 设备名区分 */
+#else
+    #define FA_DEV_NUM          1                               /* 只有片内 flash */
+#endif
+
+#define FA_JOB_AT(index)        (&_fa.job[(_fa.job_head + (index)) % FA_JOB_NUM])
+
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * flash 设备，同一设备的擦写不能同时进行
+ */
+struct FA_DEVICE
+{
+    const char *name;                                           /* FAL 的 flash 设备名，未启用 SPI flash 时为 NULL */
+    const struct BSP_FLASH_ASYNC *ops;                          /* 异步操作接口，为 NULL 时按阻塞方式操作 */
+};
+
+/**
+ * 一个排队的擦写或回调。擦写按移植文件的能力分多步完成，每步启动后由 busy 查询是否完成
+ */
+struct FA_JOB
+{
+    FA_OP    op;
+    const struct FLASH_OBJECT *part;                            /* 分区对象 */
+    const struct FA_DEVICE    *dev;                             /* 分区所在的 flash 设备 */
+    uint32_t addr;                                              /* 分区内的相对地址 */
+    uint32_t offset;                                            /* flash 设备内的偏移地址，即移植文件操作接口的 offset */
+    uint32_t size;                                              /* 数据量，单位 byte */
+    uint32_t done;                                              /* 已完成的数据量，单位 byte */
+    uint32_t step;                                              /* 已启动、尚未完成的数据量，单位 byte */
+    uint32_t buff_posit;                                        /* 写入的数据在缓存中的位置 */
+    uint32_t buff_cost;                                         /* 占用的缓存，含缓存末尾跳过的部分，单位 byte */
+    uint32_t value;                                             /* 回调的参数 */
+    FA_CALLBACK callback;
+};
+
+struct FLASH_ASYNC
+{
+    bool       is_processing;                                   /* FA_Process 正在执行，回调中不能等待队列 */
+    FA_STATUS  err;                                             /* 失败的状态，为 FA_STATUS_IDLE 时没有失败 */
+    uint8_t    job_head;                                        /* 最早提交的擦写的位置 */
+    uint8_t    job_num;                                         /* 未完成的擦写数量 */
+    uint32_t   buff_fill;                                       /* 缓存下一次存放数据的位置 */
+    uint32_t   buff_used;                                       /* 缓存已占用的数据量，单位 byte */
+    FA_DISCARD discard;                                         /* 丢弃擦写时的通知 */
+    struct FA_DEVICE dev[FA_DEV_NUM];
+    struct FA_JOB    job[FA_JOB_NUM];
+    uint8_t    buff[ASYNC_FLASH_BUFF_SIZE];                     /* 写入数据的缓存，按提交的顺序循环使用 */
+};
+
+
+/* Private variables ---------------------------------------------------------*/
+static struct FLASH_ASYNC _fa;
+
+
+/* Extern function prototypes ------------------------------------------------*/
+extern void Flash_AsyncWaitCallback(void);
+
+
+/* Private function prototypes -----------------------------------------------*/
+static struct FA_DEVICE * _FA_GetDevice     (const struct FLASH_OBJECT *part);
+static uint32_t         _FA_GetOffset       (const struct FLASH_OBJECT *part, uint32_t addr);
+static uint32_t         _FA_GetSkip         (uint32_t buff_size);
+static bool             _FA_IsFull          (uint32_t buff_size);
+static bool             _FA_IsOverlap       (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+static struct FA_JOB *  _FA_Push            (FA_OP op, const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t buff_size);
+static uint8_t *        _FA_Append          (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+static void             _FA_Pop             (void);
+static int              _FA_Start           (struct FA_JOB *job);
+static void             _FA_Fail            (struct FA_JOB *job);
+static void             _FA_Discard         (void);
+static void             _FA_Wait            (void);
+
+
+/* Exported functions ---------------------------------------------------------*/
+/**
+ * @brief  初始化接口
+ * @note   需在 flash 的分区初始化之后调用
+ * @param[in]  discard: 失败后丢弃未完成的擦写时的通知，可为 NULL
+ * @retval None
+ */
+void FA_Init(FA_DISCARD discard)
+{
+    memset(&_fa, 0, sizeof(_fa));
+    _fa.discard = discard;
+
+#if (IS_ENABLE_SPI_FLASH == 0)
+    _fa.dev[0].ops = BSP_Flash_GetAsync(NULL);
+#endif
+}
+
+
+/**
+ * @brief  读取分区
+ * @note   先等待与读取范围重叠的擦写完成。在回调中读取时，排在前面的擦写均已完成，无须等待
+ * @param[in]   part: 分区对象
+ * @param[in]   addr: 相对地址
+ * @param[out]  buf: 数据缓存
+ * @param[in]   size: 数据大小，单位 byte
+ * @retval 与 FA_RAW_READ 相同， < 0 为读取失败
+ */
+int FA_Read(const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *buf, uint32_t size)
+{
+    ASSERT(part != NULL);
+
+    if (_fa.is_processing == false && _FA_IsOverlap(part, addr, size))
+    {
+        PERF_STATS_BEGIN(PERF_FLASH_ASYNC_WAIT);
+        while (_FA_IsOverlap(part, addr, size))
+            _FA_Wait();
+        PERF_STATS_END(PERF_FLASH_ASYNC_WAIT);
+    }
+
+    return FA_RAW_READ(part, addr, buf, size);
+}
+
+
+/**
+ * @brief  提交分区的写入
+ * @note   数据复制到缓存后即返回，与上一个写入连续时合并
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  buf: 数据
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval -1: 失败，或之前的擦写失败尚未复位。其他: 提交的数据量，单位 byte
+ */
+int FA_Write(const struct FLASH_OBJECT *part, uint32_t addr, const uint8_t *buf, uint32_t size)
+{
+    uint32_t len;
+    uint8_t  *dest;
+    struct FA_JOB *job;
+
+    ASSERT(part != NULL);
+
+    for (uint32_t posit = 0; posit < size; posit += len)
+    {
+        len = FA_CHUNK_SIZE - ((addr + posit) % FA_CHUNK_SIZE);
+        if (len > size - posit)
+            len = size - posit;
+
+        dest = _FA_Append(part, addr + posit, len);
+        if (dest == NULL)
+        {
+            job = _FA_Push(FA_OP_WRITE, part, addr + posit, len, len);
+            if (job == NULL)
+                return -1;
+            dest = &_fa.buff[job->buff_posit];
+        }
+        memcpy(dest, &buf[posit], len);
+    }
+
+    FA_Process();
+
+    return size;
+}
+
+
+/**
+ * @brief  提交分区的擦除
+ * @note   擦除的范围与 FA_RAW_ERASE 相同，由移植文件按 sector 擦除
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 擦除的大小，单位 byte
+ * @retval -1: 失败，或之前的擦写失败尚未复位。其他: 提交的数据量，单位 byte
+ */
+int FA_Erase(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    ASSERT(part != NULL);
+
+    if (_FA_Push(FA_OP_ERASE, part, addr, size, 0) == NULL)
+        return -1;
+
+    FA_Process();
+
+    return size;
+}
+
+
+/**
+ * @brief  提交一个回调
+ * @note   排在其前面的擦写全部完成后执行，回调中可以 FA_Read ，不能提交擦写
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 回调的参数，相对地址
+ * @param[in]  size: 回调的参数，数据大小
+ * @param[in]  value: 回调的参数
+ * @param[in]  callback: 回调函数，返回 < 0 时按写入失败处理
+ * @retval -1: 失败，或之前的擦写失败尚未复位。 0: 成功
+ */
+int FA_Callback(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t value, FA_CALLBACK callback)
+{
+    struct FA_JOB *job;
+
+    ASSERT(part != NULL);
+    ASSERT(callback != NULL);
+
+    job = _FA_Push(FA_OP_CALL, part, addr, size, 0);
+    if (job == NULL)
+        return -1;
+
+    job->value    = value;
+    job->callback = callback;
+    FA_Process();
+
+    return 0;
+}
+
+
+/**
+ * @brief  推进队列中的擦写
+ * @note   1. 应被不间断调用，每次调用直至最早的擦写正忙或队列为空时返回
+ *         2. 没有异步接口的 flash 在本函数中按阻塞方式执行
+ * @retval None
+ */
+void FA_Process(void)
+{
+    int ret;
+    struct FA_JOB *job;
+
+    if (_fa.is_processing)
+        return;
+    _fa.is_processing = true;
+
+    while (_fa.job_num)
+    {
+        job = FA_JOB_AT(0);
+
+        if (job->op == FA_OP_CALL)
+        {
+            if (job->callback(job->part, job->addr, job->size, job->value) < 0)
+            {
+                _FA_Fail(job);
+                break;
+            }
+            _FA_Pop();
+            continue;
+        }
+
+        /* 上一步是否完成 */
+        if (job->step)
+        {
+            ret = job->dev->ops? job->dev->ops->busy() : 0;
+            if (ret > 0)
+                break;
+            if (ret < 0)
+            {
+                _FA_Fail(job);
+                break;
+            }
+            job->done += job->step;
+            job->step  = 0;
+        }
+
+        if (job->done >= job->size)
+        {
+            _FA_Pop();
+            continue;
+        }
+
+        ret = _FA_Start(job);
+        if (ret <= 0)
+        {
+            _FA_Fail(job);
+            break;
+        }
+        job->step = ret;
+    }
+
+    _fa.is_processing = false;
+}
+
+
+/**
+ * @brief  等待分区的擦写全部完成
+ * @note   等待期间调用 Flash_AsyncWaitCallback 处理主机数据
+ * @param[in]  part: 分区对象，为 NULL 时等待所有分区
+ * @retval None
+ */
+void FA_Sync(const struct FLASH_OBJECT *part)
+{
+    if (_fa.is_processing || FA_IsBusy(part) == false)
+        return;
+
+    PERF_STATS_BEGIN(PERF_FLASH_ASYNC_WAIT);
+    while (FA_IsBusy(part))
+        _FA_Wait();
+    PERF_STATS_END(PERF_FLASH_ASYNC_WAIT);
+}
+
+
+/**
+ * @brief  复位队列
+ * @note   等待已启动的一步完成后，丢弃其余的擦写并清除失败的状态
+ * @retval None
+ */
+void FA_Reset(void)
+{
+    struct FA_JOB *job = FA_JOB_AT(0);
+
+    if (_fa.is_processing)
+        return;
+
+    /* flash 的擦写启动后不能中途停止 */
+    if (_fa.job_num && job->step && job->dev->ops)
+    {
+        while (job->dev->ops->busy() > 0)
+            Flash_AsyncWaitCallback();
+        job->step = 0;
+    }
+
+    _FA_Discard();
+    _fa.err = FA_STATUS_IDLE;
+}
+
+
+/**
+ * @brief  分区是否有未完成的擦写
+ * @note
+ * @param[in]  part: 分区对象，为 NULL 时检查所有分区
+ * @retval true: 有未完成的擦写
+ */
+bool FA_IsBusy(const struct FLASH_OBJECT *part)
+{
+    for (uint8_t i = 0; i < _fa.job_num; i++)
+    {
+        if (part == NULL || FA_JOB_AT(i)->part == part)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief  队列是否可以再提交一段数据而无须等待
+ * @note   按数据拆分后的写入、写入后的回调和写入前的擦除估算，解压等数据量会增大的写入仍可能等待
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval true: 可以提交
+ */
+bool FA_IsAvailable(uint32_t size)
+{
+    return (_fa.job_num + (size / FA_CHUNK_SIZE) + 4 <= FA_JOB_NUM
+        &&  _fa.buff_used + size + FA_CHUNK_SIZE <= ASYNC_FLASH_BUFF_SIZE);
+}
+
+
+/**
+ * @brief  获取分区擦写的状态
+ * @note   失败的状态优先，直至 FA_Reset 才清除
+ * @param[in]  part: 分区对象，为 NULL 时检查所有分区
+ * @retval FA_STATUS
+ */
+FA_STATUS FA_GetStatus(const struct FLASH_OBJECT *part)
+{
+    if (_fa.err != FA_STATUS_IDLE)
+        return _fa.err;
+
+    return FA_IsBusy(part)? FA_STATUS_BUSY : FA_STATUS_IDLE;
+}
+
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  获取分区所在的 flash 设备
+ * @note   启用 SPI flash 时按 FAL 的 flash 设备名区分，首次使用时获取其异步接口
+ * @param[in]  part: 分区对象
+ * @retval flash 设备，超过 FA_DEV_NUM 时为 NULL
+ */
+static struct FA_DEVICE * _FA_GetDevice(const struct FLASH_OBJECT *part)
+{
+#if (IS_ENABLE_SPI_FLASH)
+    uint8_t i;
+
+    for (i = 0; i < FA_DEV_NUM && _fa.dev[i].name; i++)
+    {
+        if (strncmp(_fa.dev[i].name, part->flash_name, FAL_DEV_NAME_MAX) == 0)
+            return &_fa.dev[i];
+    }
+
+    if (i == FA_DEV_NUM)
+    {
+        BSP_Printf("%s: too many flash devices (%s)\r\n", __func__, part->flash_name);
+        return NULL;
+    }
+
+    _fa.dev[i].name = part->flash_name;
+    _fa.dev[i].ops  = BSP_Flash_GetAsync(part->flash_name);
+
+    return &_fa.dev[i];
+#else
+    (void)part;
+    return &_fa.dev[0];
+#endif
+}
+
+
+/**
+ * @brief  获取分区内的相对地址在 flash 设备内的偏移地址
+ * @note   与分区操作接口传给移植文件的 offset 一致
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @retval 偏移地址
+ */
+static uint32_t _FA_GetOffset(const struct FLASH_OBJECT *part, uint32_t addr)
+{
+#if (IS_ENABLE_SPI_FLASH)
+    return part->offset + addr;
+#else
+    return part->addr + addr;
+#endif
+}
+
+
+/**
+ * @brief  获取存放数据时缓存末尾需跳过的数据量
+ * @note   一次写入的数据在缓存中连续存放，缓存末尾不足时从缓存首地址开始存放
+ * @param[in]  buff_size: 存放的数据量，单位 byte
+ * @retval 跳过的数据量，单位 byte
+ */
+static uint32_t _FA_GetSkip(uint32_t buff_size)
+{
+    if (buff_size && _fa.buff_fill + buff_size > ASYNC_FLASH_BUFF_SIZE)
+        return ASYNC_FLASH_BUFF_SIZE - _fa.buff_fill;
+
+    return 0;
+}
+
+
+/**
+ * @brief  队列或缓存是否已满
+ * @note
+ * @param[in]  buff_size: 需存放的数据量，单位 byte
+ * @retval true: 已满
+ */
+static bool _FA_IsFull(uint32_t buff_size)
+{
+    return (_fa.job_num >= FA_JOB_NUM
+        ||  _fa.buff_used + _FA_GetSkip(buff_size) + buff_size > ASYNC_FLASH_BUFF_SIZE);
+}
+
+
+/**
+ * @brief  是否有与某段范围重叠的未完成的擦写
+ * @note   按 flash 设备内的偏移地址比较，回调不占用范围
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval true: 有重叠
+ */
+static bool _FA_IsOverlap(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    struct FA_JOB *job;
+    const struct FA_DEVICE *dev = _FA_GetDevice(part);
+    uint32_t begin = _FA_GetOffset(part, addr);
+    uint32_t end   = begin + size;
+
+    for (uint8_t i = 0; i < _fa.job_num; i++)
+    {
+        job = FA_JOB_AT(i);
+        if (job->op != FA_OP_CALL
+        &&  job->dev == dev
+        &&  job->offset + job->done < end
+        &&  job->offset + job->size > begin)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief  在队列末尾添加一个擦写或回调
+ * @note   队列或缓存已满时等待，在回调中或失败后不等待
+ * @param[in]  op: 操作
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @param[in]  buff_size: 占用缓存的数据量，单位 byte
+ * @retval 添加的擦写，失败时为 NULL
+ */
+static struct FA_JOB * _FA_Push(FA_OP op, const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t buff_size)
+{
+    uint32_t skip;
+    struct FA_JOB *job;
+    const struct FA_DEVICE *dev = _FA_GetDevice(part);
+
+    if (dev == NULL)
+        return NULL;
+
+    if (_FA_IsFull(buff_size) && _fa.is_processing == false)
+    {
+        PERF_STATS_BEGIN(PERF_FLASH_ASYNC_WAIT);
+        while (_FA_IsFull(buff_size) && _fa.err == FA_STATUS_IDLE)
+            _FA_Wait();
+        PERF_STATS_END(PERF_FLASH_ASYNC_WAIT);
+    }
+
+    if (_fa.err != FA_STATUS_IDLE || _FA_IsFull(buff_size))
+        return NULL;
+
+    skip = _FA_GetSkip(buff_size);
+    job  = FA_JOB_AT(_fa.job_num);
+    memset(job, 0, sizeof(struct FA_JOB));
+    job->op         = op;
+    job->part       = part;
+    job->dev        = dev;
+    job->addr       = addr;
+    job->offset     = _FA_GetOffset(part, addr);
+    job->size       = size;
+    job->buff_posit = (_fa.buff_fill + skip) % ASYNC_FLASH_BUFF_SIZE;
+    job->buff_cost  = skip + buff_size;
+
+    if (buff_size)
+        _fa.buff_fill = job->buff_posit + buff_size;
+    _fa.buff_used += job->buff_cost;
+    _fa.job_num++;
+
+    return job;
+}
+
+
+/**
+ * @brief  将写入合并到队列末尾的写入
+ * @note   同一分区、地址连续、不跨越 FA_CHUNK_SIZE 且缓存连续时才合并
+ * @param[in]  part: 分区对象
+ * @param[in]  addr: 相对地址
+ * @param[in]  size: 数据大小，单位 byte
+ * @retval 数据在缓存中的存放位置，不能合并时为 NULL
+ */
+static uint8_t * _FA_Append(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size)
+{
+    uint8_t *dest;
+    struct FA_JOB *job;
+
+    if (_fa.job_num == 0 || _fa.err != FA_STATUS_IDLE)
+        return NULL;
+
+    job = FA_JOB_AT(_fa.job_num - 1);
+    if (job->op   != FA_OP_WRITE
+    ||  job->part != part
+    ||  job->addr + job->size != addr
+    ||  (addr % FA_CHUNK_SIZE) == 0
+    ||  job->buff_posit + job->size != _fa.buff_fill
+    ||  _fa.buff_fill + size > ASYNC_FLASH_BUFF_SIZE
+    ||  _fa.buff_used + size > ASYNC_FLASH_BUFF_SIZE)
+        return NULL;
+
+    dest = &_fa.buff[_fa.buff_fill];
+    job->size      += size;
+    job->buff_cost += size;
+    _fa.buff_fill  += size;
+    _fa.buff_used  += size;
+
+    return dest;
+}
+
+
+/**
+ * @brief  移除最早提交的擦写
+ * @note   释放其占用的缓存，队列为空时缓存从头开始使用
+ * @retval None
+ */
+static void _FA_Pop(void)
+{
+    struct FA_JOB *job = FA_JOB_AT(0);
+
+    _fa.buff_used -= job->buff_cost;
+    _fa.job_head   = (_fa.job_head + 1) % FA_JOB_NUM;
+    _fa.job_num--;
+
+    if (_fa.job_num == 0)
+        _fa.buff_fill = 0;
+}
+
+
+/**
+ * @brief  启动擦写的下一步
+ * @note   有异步接口时启动一个 sector 的擦除或一页的编程，否则按阻塞方式完成剩余的部分
+ * @param[in]  job: 擦写
+ * @retval <= 0: 失败。其他: 本步的数据量，单位 byte
+ */
+static int _FA_Start(struct FA_JOB *job)
+{
+    uint32_t size = job->size - job->done;
+    const struct BSP_FLASH_ASYNC *ops = job->dev->ops;
+
+    if (job->op == FA_OP_ERASE)
+    {
+        if (ops)
+            return ops->erase_start(job->offset + job->done, size);
+        return (FA_RAW_ERASE(job->part, job->addr + job->done, size) < 0)? -1 : (int)size;
+    }
+
+    if (ops)
+        return ops->write_start(job->offset + job->done, &_fa.buff[job->buff_posit + job->done], size);
+    return (FA_RAW_WRITE(job->part, job->addr + job->done, &_fa.buff[job->buff_posit + job->done], size) < 0)? -1 : (int)size;
+}
+
+
+/**
+ * @brief  擦写失败的处理
+ * @note   记录失败的状态，丢弃其余的擦写
+ * @param[in]  job: 失败的擦写
+ * @retval None
+ */
+static void _FA_Fail(struct FA_JOB *job)
+{
+    BSP_Printf("%s: %s failed at 0x%.8X\r\n", __func__, (job->op == FA_OP_ERASE)? "erase" : "write", job->addr + job->done);
+
+    _fa.err   = (job->op == FA_OP_ERASE)? FA_STATUS_ERASE_ERR : FA_STATUS_WRITE_ERR;
+    job->step = 0;
+    _FA_Discard();
+}
+
+
+/**
+ * @brief  丢弃队列中所有的擦写
+ * @note   逐个通知调用者，未完成的擦写按整个范围通知
+ * @retval None
+ */
+static void _FA_Discard(void)
+{
+    struct FA_JOB *job;
+
+    while (_fa.job_num)
+    {
+        job = FA_JOB_AT(0);
+        if (_fa.discard)
+            _fa.discard(job->op, job->part, job->addr, job->size);
+        _FA_Pop();
+    }
+}
+
+
+/**
+ * @brief  等待队列推进
+ * @note   推进一次后处理主机数据
+ * @retval None
+ */
+static void _FA_Wait(void)
+{
+    FA_Process();
+    Flash_AsyncWaitCallback();
+}
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * \file            flash_async.h
+ * \brief           asynchronous flash erase and program queue
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Version:         v1.0.0
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18                  the first version
+ */
+
+#ifndef __FLASH_ASYNC_H__
+#define __FLASH_ASYNC_H__
+
+#include "bsp_common.h"
+#include "perf_stats.h"
+
+/* 分区对象和阻塞的分区操作接口，启用 SPI flash 时经 FAL 操作 */
+#if (IS_ENABLE_SPI_FLASH)
+    #define FLASH_OBJECT        fal_partition
+    #define GET_FLASH_OBJECT    fal_partition_find
+    #define FA_RAW_READ         fal_partition_read
+    #define FA_RAW_WRITE        fal_partition_write
+    #define FA_RAW_ERASE        fal_partition_erase
+#else
+    #define FLASH_OBJECT        BSP_FLASH
+    #define GET_FLASH_OBJECT    BSP_Flash_GetHandle
+    #define FA_RAW_READ         BSP_Flash_Read
+    #define FA_RAW_WRITE        BSP_Flash_Write
+    #define FA_RAW_ERASE        BSP_Flash_Erase
+#endif
+
+
+#if (ENABLE_ASYNC_FLASH)
+/**
+ * flash 的擦除和写入按提交的顺序排队执行，提交后即返回，由 FA_Process 在主循环中推进：
+ *    - 写入的数据复制到 ASYNC_FLASH_BUFF_SIZE 的缓存中，提交后调用者的数据可立即复用。按 FA_CHUNK_SIZE 对齐拆分，
+ *      与上一个写入连续时合并
+ *    - 移植文件以 BSP_Flash_GetAsync 提供异步接口的 flash （ SFUD 的 SPI flash ，以及由 flash 就绪中断或忙标志驱动的片内 flash ），
+ *      每次启动一个 sector 的擦除或一页的编程，忙期间即返回；没有异步接口的 flash 每次按阻塞方式执行一步
+ *    - 读取时只等待与读取范围重叠的擦写完成，因此读到的总是提交顺序下的最新数据
+ *    - FA_Callback 提交的回调在排在其前面的擦写全部完成后执行，可用于写入后的检查，返回 < 0 时按写入失败处理
+ *    - 任一步骤失败后丢弃其余的擦写，经 FA_Init 登记的 discard 回调通知调用者，之后的提交均返回失败，直至 FA_Reset
+ * 队列满时提交会等待，等待期间调用 Flash_AsyncWaitCallback 处理主机数据。
+ */
+
+#define FA_JOB_NUM                      32                              /* 队列中最多的擦写数量 */
+#define FA_CHUNK_SIZE                   (ASYNC_FLASH_BUFF_SIZE / 4)     /* 一次写入占用缓存的上限，单位 byte */
+
+/* 队列的状态 */
+typedef enum
+{
+    FA_STATUS_IDLE = 0x00,                                      /* 没有未完成的擦写 */
+    FA_STATUS_BUSY,                                             /* 有未完成的擦写 */
+    FA_STATUS_ERASE_ERR,                                        /* 擦除失败，其余的擦写已丢弃 */
+    FA_STATUS_WRITE_ERR,                                        /* 写入或写入后的回调失败，其余的擦写已丢弃 */
+
+} FA_STATUS;
+
+/* 排队的操作 */
+typedef enum
+{
+    FA_OP_ERASE = 0x00,
+    FA_OP_WRITE,
+    FA_OP_CALL,
+
+} FA_OP;
+
+/* 排在其前面的擦写完成后执行的回调，返回 < 0 时按写入失败处理 */
+typedef int  (*FA_CALLBACK)(const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t value);
+
+/* 失败后丢弃未完成的擦写时，逐个通知调用者 */
+typedef void (*FA_DISCARD)(FA_OP op, const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+
+
+void        FA_Init         (FA_DISCARD discard);
+int         FA_Read         (const struct FLASH_OBJECT *part, uint32_t addr, uint8_t *buf, uint32_t size);
+int         FA_Write        (const struct FLASH_OBJECT *part, uint32_t addr, const uint8_t *buf, uint32_t size);
+int         FA_Erase        (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size);
+int         FA_Callback     (const struct FLASH_OBJECT *part, uint32_t addr, uint32_t size, uint32_t value, FA_CALLBACK callback);
+void        FA_Process      (void);
+void        FA_Sync         (const struct FLASH_OBJECT *part);
+void        FA_Reset        (void);
+bool        FA_IsBusy       (const struct FLASH_OBJECT *part);
+bool        FA_IsAvailable  (uint32_t size);
+FA_STATUS   FA_GetStatus    (const struct FLASH_OBJECT *part);
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * \file            perf_stats.h
+ * \brief           per-stage cycle accounting based on perf_counter
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of mOTA - The Over-The-Air technology component for MCU.
+ *
+ * Change Logs:
+ * Version  Date           Author       Notes
+ * v1.0     2026-10-18                  the first version
+ * v1.1     2026-10-18                  增加 PERF_DECOMPRESS 统计项
+ * v1.2     2026-10-18                  增加 PERF_DELTA_PATCH 统计项
+ * v1.3     2026-10-18                  增加 PERF_FM_ERASE_APP_BY_COMPARE 统计项
+ * v1.4     2026-10-18                  增加 PERF_FM_ERASE_AHEAD 统计项
+ * v1.5     2026-10-18                  增加 PERF_FLASH_ASYNC_WAIT 统计项
+ */
+
+#ifndef __PERF_STATS_H__
+#define __PERF_STATS_H__
+
+#include "bsp_common.h"
+
+/**
+ * 启用 ENABLE_PERF_STATS 后，bootloader 累计各执行流程和耗时较大的固件操作的耗时，用于定位升级慢的原因：
+ *    - 等待数据的流程（ WAIT_FIRMWARE 、 *_DONE ）耗时多，则瓶颈在通讯
+ *    - FLASH_WRITE 、 FM_ERASE_FIRMWARE 耗时多，则瓶颈在 flash
+ *    - AES_DECRYPT 、 DECOMPRESS 、 CRC32 耗时多，则瓶颈在计算
+ * 时间单位为 perf_counter 的 tick （即内核时钟周期），可用 perfc_convert_ticks_to_us 换算。
+ * 未启用时所有宏为空，不占用任何资源。
+ */
+
+#define PERF_FLOW_MAX                   32          /* 不小于 BOOT_EXE_FLOW 的成员数 */
+
+/* 统计耗时的固件操作 */
+typedef enum
+{
+    PERF_FM_IS_EMPTY = 0x00,                        /* FM_IsEmpty */
+    PERF_FM_ERASE_FIRMWARE,                         /* FM_EraseFirmware */
+    PERF_FM_WRITE_SUB_PKG,                          /* _Write_FirmwareSubPackage ，包含解密和写入 flash */
+    PERF_FM_VERIFY_FIRMWARE,                        /* FM_VerifyFirmware ，包含读取 flash 和 CRC32 */
+    PERF_FM_UPDATE_TO_APP,                          /* FM_UpdateToAPP */
+    PERF_FM_ERASE_APP_BY_COMPARE,                   /* FM_EraseAPPByCompare ，包含比较时的解密、解压和擦除 */
+    PERF_FM_ERASE_AHEAD,                            /* 接收时逐块擦除，包含检查擦除状态 */
+    PERF_FLASH_WRITE,                               /* 固件分包写入 flash */
+    PERF_AES_DECRYPT,                               /* AES_CBC_decrypt_buffer */
+    PERF_DECOMPRESS,                                /* 固件解压，包含解压后写入 flash ，差分固件包还包含还原 */
+    PERF_DELTA_PATCH,                               /* 未压缩的差分固件包的还原，包含读取基础固件和写入 flash */
+    PERF_CRC32,                                     /* _CRC32_StepCalc */
+    PERF_FLASH_ASYNC_WAIT,                          /* 等待排队的 flash 擦写完成，包含等待期间处理主机数据 */
+    PERF_FUNC_NUM,
+
+} PERF_FUNC_ID;
+
+/* 一项统计 */
+struct PERF_ITEM
+{
+    uint32_t    count;                              /* 次数 */
+    uint32_t    max;                                /* 单次最大耗时，单位 tick */
+    uint64_t    total;                              /* 累计耗时，单位 tick */
+};
+
+/* 统计块，可经调试串口或 RTT 打印，也可整块回传给主机 */
+struct PERF_STATS
+{
+    int64_t             flow_start;                 /* 进入当前执行流程的时刻，单位 tick */
+    struct PERF_ITEM    flow[PERF_FLOW_MAX];        /* 按 BOOT_EXE_FLOW 索引，每次离开该流程时累计 */
+    struct PERF_ITEM    func[PERF_FUNC_NUM];        /* 按 PERF_FUNC_ID 索引 */
+};
+
+
+#if (ENABLE_PERF_STATS)
+extern struct PERF_STATS perf_stats;
+extern const char *const perf_func_name[PERF_FUNC_NUM];
+
+/**
+ * @brief  累计一次耗时
+ * @note   
+ * @param[in]  item: 统计项
+ * @param[in]  ticks: 本次耗时，单位 tick
+ * @retval None
+ */
+__STATIC_INLINE
+void Perf_Stats_Add(struct PERF_ITEM *item, int64_t ticks)
+{
+    if (ticks < 0)
+        ticks = 0;
+
+    item->count++;
+    item->total += (uint64_t)ticks;
+    if ((uint64_t)ticks > item->max)
+        item->max = ((uint64_t)ticks > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)ticks;
+}
+
+/* 成对使用，同一作用域内可嵌套不同 id 的统计 */
+#define PERF_STATS_BEGIN(id)            int64_t _perf_start_##id = get_system_ticks()
+#define PERF_STATS_END(id)              Perf_Stats_Add(&perf_stats.func[id], get_system_ticks() - _perf_start_##id)
+
+#else
+#define PERF_STATS_BEGIN(id)
+#define PERF_STATS_END(id)
+#endif
+
+#endif
@@ -15,12 +15,14 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     serial_port.cpp \
+    slide_window.cpp \
     ymodem.cpp
 
 HEADERS += \
     crc.h \
     mainwindow.h \
     serial_port.h \
+    slide_window.h \
     ymodem.h
 
 FORMS += \
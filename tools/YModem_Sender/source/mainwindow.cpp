@@ -69,6 +69,11 @@ MainWindow::MainWindow(QWidget *parent)
     connect(&_ymodem, &YModem::receive, this, &MainWindow::YModemReceive);
     connect(&_ymodem, &YModem::progressCallback, this, &MainWindow::sendFileProgress);
     connect(&_ymodem, &YModem::resultCallback, this, &MainWindow::sendFileFinished);
+    connect(&_ymodem, &YModem::setBaudRate, &_serial_port, &Serial_Port::setBaudRate);
+    connect(&_slide_window, &SlideWindow::send, this, &MainWindow::YModemSend);
+    connect(&_slide_window, &SlideWindow::receive, this, &MainWindow::YModemReceive);
+    connect(&_slide_window, &SlideWindow::progressCallback, this, &MainWindow::sendFileProgress);
+    connect(&_slide_window, &SlideWindow::resultCallback, this, &MainWindow::sendFileFinished);
 }
 
 
@@ -219,6 +224,8 @@ void MainWindow::sendFileFinished(YMODEM_ERR err_code)
     ui->pbOpenSerial->setEnabled(true);
     ui->pbOpenFiles->setEnabled(true);
     ui->pbSendFiles->setEnabled(true);
+    ui->cbWindow->setEnabled(true);
+    ui->cbBaud->setEnabled(true);
 
     if (err_code == YMODEM_ERR_OK)
     {
@@ -354,9 +361,18 @@ void MainWindow::on_pbSendFiles_clicked()
     ui->pbOpenSerial->setEnabled(false);
     ui->pbOpenFiles->setEnabled(false);
     ui->pbSendFiles->setEnabled(false);
+    ui->cbWindow->setEnabled(false);
+    ui->cbBaud->setEnabled(false);
 
-    /* 按YModem协议发送 */
-    YMODEM_ERR err = _ymodem.sendFile(ui->leFilePath->text());
+    /* YModem 可在第 0 个包之前协商更高的波特率，bootloader 需使能 ENABLE_BAUD_NEGOTIATION */
+    _ymodem.setBaudNegotiation(ui->cbBaud->isChecked(), _serial_config.baud_rate);
+
+    /* 按滑动窗口协议或YModem协议发送，bootloader 需使能 ENABLE_WINDOW_PROTOCOL 才支持前者 */
+    YMODEM_ERR err;
+    if (ui->cbWindow->isChecked())
+        err = _slide_window.sendFile(ui->leFilePath->text());
+    else
+        err = _ymodem.sendFile(ui->leFilePath->text());
     if (err != YMODEM_ERR_OK)
         qDebug()<<"error: on_pbOpenFiles_clicked: "<<err;
 }
@@ -40,6 +40,7 @@
 #include <QLabel>
 #include "serial_port.h"
 #include "ymodem.h"
+#include "slide_window.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -59,6 +60,7 @@ private:
     QLabel *_labVersion;
 
     YModem _ymodem;
+    SlideWindow _slide_window;
     Serial_Port _serial_port;
 
     bool _is_serial_open = false;
@@ -29,7 +29,7 @@
  * This file is part of YModem_Sender.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.1.0
  */
 
 
@@ -176,6 +176,22 @@ qint64 Serial_Port::write(const char *data, qint64 len)
 }
 
 
+/**
+ * @brief 切换已打开串口的波特率
+ * @note 等待已写入的数据发送完毕后再切换
+ * @param baud_rate 波特率
+ * @return true：成功。false：失败
+ */
+bool Serial_Port::setBaudRate(qint32 baud_rate)
+{
+    if (_serial_port->isOpen() == false)
+        return false;
+
+    _serial_port->flush();
+    return _serial_port->setBaudRate(baud_rate);
+}
+
+
 /**
  * @brief 读取已打开串口设备的全部缓存数据
  * @return 串口数据
@@ -29,7 +29,7 @@
  * This file is part of YModem_Sender.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.1.0
  */
 
 
@@ -73,6 +73,7 @@ public:
                                               .flow_ctrl = QSerialPort::NoFlowControl});
     void close();
     qint64 write(const char *data = nullptr, qint64 len = 0);
+    bool setBaudRate(qint32 baud_rate);
     QByteArray readAll();
 
 signals:
@@ -0,0 +1,445 @@
+/**
+ * \file            slide_window.cpp
+ * \brief           YModem_Sender
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of YModem_Sender.
+ *
+ * Version:         v1.0.0
+ */
+
+#include "slide_window.h"
+#include "crc.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+
+/**
+ * @brief 构造函数
+ */
+SlideWindow::SlideWindow()
+{
+    sendStop();
+
+    connect(&_send_timer, &QTimer::timeout, this, &SlideWindow::sendFileHandler);
+    connect(&_recv_timer, &QTimer::timeout, this, &SlideWindow::receiveDataTimeout);
+}
+
+
+/**
+ * @brief 发送文件
+ * @param file_path 文件所在的路径
+ * @return 执行结果
+ */
+YMODEM_ERR SlideWindow::sendFile(QString file_path)
+{
+    assert(file_path != "");
+
+    QFile file(file_path);
+    QFileInfo file_info(file_path);
+
+    if (file.exists() == false)
+        return YMODEM_ERR_FILE_NO_EXIST;
+
+    if (file.open(QIODevice::ReadOnly) == false)
+        return YMODEM_ERR_OPEN_FILE_ERR;
+
+    /* 将文件读入数组，最后一个未足 WINDOW_DATA_MAX_LEN 的帧全部填充为0x1A */
+    _file_data = file.readAll();
+    if (_file_data.size() != file.size())
+    {
+        _file_data.clear();
+        return YMODEM_ERR_READ_FILE_ERR;
+    }
+    if (_file_data.size() % WINDOW_DATA_MAX_LEN)
+        _file_data.append(WINDOW_DATA_MAX_LEN - (_file_data.size() % WINDOW_DATA_MAX_LEN), (char)YMODEM_FILL_BYTE);
+
+    /* 暂存文件名和文件大小 */
+    memset(_file_size_str, 0, sizeof(_file_size_str));
+    snprintf(_file_size_str, sizeof(_file_size_str), "%lld", file.size());
+    qDebug()<<"file size: "<<_file_size_str;
+
+    memset(_file_name, 0, sizeof(_file_name));
+    strncpy(_file_name, file_info.fileName().toLatin1(), WINDOW_INFO_LEN - strlen(_file_size_str) - 2);
+    qDebug()<<"file name: "<<_file_name;
+
+    /* 开始发送文件 */
+    _total     = _file_data.size() / WINDOW_DATA_MAX_LEN;
+    _send_step = WINDOW_STEP_WAIT_HANDSHAKE;
+    _recv_stream.clear();
+    _send_timer.start(1);
+    _recv_timer.start(YMODEM_RECV_DATA_MAX_TIME);
+
+    file.close();
+
+    return YMODEM_ERR_OK;
+}
+
+
+/**
+ * @brief 停止发送
+ */
+void SlideWindow::sendStop()
+{
+    _send_timer.stop();
+    _recv_timer.stop();
+
+    _total      = 0;
+    _base       = 0;
+    _next       = 0;
+    _window     = 1;
+    _err_count  = 0;
+    _send_step  = WINDOW_STEP_NONE;
+    _acked.clear();
+    _file_data.clear();
+    _recv_stream.clear();
+}
+
+
+/*********************************** private function ***********************************/
+/**
+ * @brief 发送文件的循环处理函数
+ */
+void SlideWindow::sendFileHandler()
+{
+    uint8_t  type;
+    uint16_t seq;
+    uint16_t len;
+    uint8_t  payload[16];
+    size_t   recv_len = emit receive(&_recv_buff[0], sizeof(_recv_buff), 0);
+
+    if (recv_len)
+    {
+        _recv_stream.append((const char *)&_recv_buff[0], recv_len);
+        _recv_timer.start(YMODEM_RECV_DATA_MAX_TIME);
+    }
+
+    /* 从机以'C'或'G'握手后发送文件信息 */
+    if (_send_step == WINDOW_STEP_WAIT_HANDSHAKE)
+    {
+        if (_recv_stream.contains(YMODEM_C) || _recv_stream.contains(YMODEM_G))
+        {
+            _recv_stream.clear();
+            sendFileInfo();
+
+            _err_count = 0;
+            _reply_timer.start();
+            _send_step = WINDOW_STEP_WAIT_READY;
+            emit progressCallback(YMODEM_STAGE_WAIT_C, 0);
+        }
+        return;
+    }
+
+    /* 任何应答都说明从机仍在处理，推迟超时重发 */
+    while (parseReply(&type, &seq, payload, &len))
+    {
+        _err_count = 0;
+        _reply_timer.start();
+        replyProcess(type, seq, payload, len);
+
+        if (_send_step == WINDOW_STEP_NONE)
+            return;
+    }
+
+    switch ((uint8_t)_send_step)
+    {
+        /* 发送 START 后等待 READY */
+        case WINDOW_STEP_WAIT_READY:
+        {
+            if (_reply_timer.elapsed() < WINDOW_REPLY_MAX_TIME)
+                break;
+
+            if (++_err_count == WINDOW_ERR_MAX_TIME)
+            {
+                sendFinished(YMODEM_ERR_RECV_DATA_TIMEOUT);
+                break;
+            }
+            sendFileInfo();
+            _reply_timer.start();
+            break;
+        }
+        /* 按窗口发送文件内容 */
+        case WINDOW_STEP_SEND_DATA:
+        {
+            /* 窗口未满，继续发送新的帧 */
+            while (_next < _total && _next - _base < _window)
+                sendData(_next++);
+
+            /* 全部确认，结束传输 */
+            if (_base >= _total)
+            {
+                sendFrame(WINDOW_TYPE_END, _total);
+                _reply_timer.start();
+                _send_step = WINDOW_STEP_WAIT_FINISH;
+                break;
+            }
+
+            /* 超时没有任何应答，重发最早未确认的帧 */
+            if (_reply_timer.elapsed() >= WINDOW_RTO_TIME)
+            {
+                uint32_t i = _base;
+
+                if (++_err_count == WINDOW_ERR_MAX_TIME)
+                {
+                    sendFinished(YMODEM_ERR_RECV_DATA_TIMEOUT);
+                    break;
+                }
+                while (i < _next && _acked[i])
+                    i++;
+                if (i < _next)
+                    sendData(i);
+                _reply_timer.start();
+            }
+            break;
+        }
+        /* 发送 END 后等待 FINISH */
+        case WINDOW_STEP_WAIT_FINISH:
+        {
+            if (_reply_timer.elapsed() < WINDOW_REPLY_MAX_TIME)
+                break;
+
+            if (++_err_count == WINDOW_ERR_MAX_TIME)
+            {
+                sendFinished(YMODEM_ERR_RECV_DATA_TIMEOUT);
+                break;
+            }
+            sendFrame(WINDOW_TYPE_END, _total);
+            _reply_timer.start();
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief 处理从机的一个应答
+ * @param type 帧类型
+ * @param seq 序号
+ * @param payload 数据
+ * @param len 数据长度
+ */
+void SlideWindow::replyProcess(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len)
+{
+    if (type == WINDOW_TYPE_ABORT)
+    {
+        sendFinished(YMODEM_ERR_SLAVER_REPLY_ERR);
+        return;
+    }
+
+    switch ((uint8_t)_send_step)
+    {
+        case WINDOW_STEP_WAIT_READY:
+        {
+            if (type != WINDOW_TYPE_READY || len < 3)
+                break;
+
+            /* 取从机和本机窗口的较小值 */
+            _window = payload[0];
+            if (_window > WINDOW_MAX_FRAME_NUM)
+                _window = WINDOW_MAX_FRAME_NUM;
+            if (_window == 0)
+                _window = 1;
+            qDebug()<<"window: "<<_window;
+
+            _base = 0;
+            _next = 0;
+            _acked.fill(false, _total);
+            _send_step = WINDOW_STEP_SEND_DATA;
+            break;
+        }
+        case WINDOW_STEP_SEND_DATA:
+        {
+            /* 16 bit 序号按 _base 展开 */
+            uint32_t n = _base + (uint16_t)(seq - (uint16_t)_base);
+
+            if (type == WINDOW_TYPE_ACK && n <= _next)
+            {
+                uint32_t sack = 0;
+
+                while (_base < n)
+                    _acked[_base++] = true;
+
+                /* 选择确认的位图， bit i 对应 n + 1 + i */
+                if (len >= 4)
+                    sack = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+                for (uint32_t i = 0; i < 32 && n + 1 + i < _next; i++)
+                {
+                    if (sack & (1UL << i))
+                        _acked[n + 1 + i] = true;
+                }
+
+                if (_total)
+                    emit progressCallback(YMODEM_STAGE_SEND_FILE, 100 * _base / _total);
+            }
+            /* 只重发从机请求的帧 */
+            else if (type == WINDOW_TYPE_NAK && n < _next && _acked[n] == false)
+            {
+                qDebug()<<"NAK: "<<n;
+                sendData(n);
+            }
+            break;
+        }
+        case WINDOW_STEP_WAIT_FINISH:
+        {
+            if (type == WINDOW_TYPE_FINISH)
+            {
+                emit progressCallback(YMODEM_STAGE_SEND_FINISHED, 100);
+                sendFinished(YMODEM_ERR_OK);
+            }
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief 从接收的数据中取出一个应答帧
+ * @param type 帧类型
+ * @param seq 序号
+ * @param payload 数据，至少 16 byte
+ * @param len 数据长度
+ * @return true: 取出一帧 | false: 没有完整的帧
+ */
+bool SlideWindow::parseReply(uint8_t *type, uint16_t *seq, uint8_t *payload, uint16_t *len)
+{
+    while (_recv_stream.size())
+    {
+        const uint8_t *data = (const uint8_t *)_recv_stream.constData();
+        int sof = _recv_stream.indexOf((char)WINDOW_SOF);
+
+        /* 丢弃帧头前的数据（如残留的'C'） */
+        if (sof < 0)
+        {
+            _recv_stream.clear();
+            break;
+        }
+        if (sof)
+        {
+            _recv_stream.remove(0, sof);
+            continue;
+        }
+
+        if (_recv_stream.size() < WINDOW_HEAD_LEN)
+            break;
+
+        uint16_t data_len = data[4] | (data[5] << 8);
+        if (data_len > 16)
+        {
+            _recv_stream.remove(0, 1);
+            continue;
+        }
+        if (_recv_stream.size() < WINDOW_FIXED_LEN + data_len)
+            break;
+
+        uint16_t crc16 = CRC::crc16_xmodem((uint8_t *)&data[1], WINDOW_HEAD_LEN - 1 + data_len);
+        if (crc16 != (data[WINDOW_HEAD_LEN + data_len] | (data[WINDOW_HEAD_LEN + data_len + 1] << 8)))
+        {
+            _recv_stream.remove(0, 1);
+            continue;
+        }
+
+        *type = data[1];
+        *seq  = data[2] | (data[3] << 8);
+        *len  = data_len;
+        memcpy(payload, &data[WINDOW_HEAD_LEN], data_len);
+        _recv_stream.remove(0, WINDOW_FIXED_LEN + data_len);
+
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief 发送文件信息
+ * @note 与 YModem 的第 0 帧相同
+ */
+void SlideWindow::sendFileInfo()
+{
+    uint8_t info[WINDOW_INFO_LEN] = {0};
+
+    memcpy(&info[0], _file_name, strlen(_file_name));
+    memcpy(&info[strlen(_file_name) + 1], _file_size_str, strlen(_file_size_str));
+    sendFrame(WINDOW_TYPE_START, 0, info, sizeof(info));
+}
+
+
+/**
+ * @brief 发送一帧
+ * @param type 帧类型
+ * @param seq 序号
+ * @param payload 数据
+ * @param len 数据长度
+ */
+void SlideWindow::sendFrame(WINDOW_TYPE type, uint16_t seq, const uint8_t *payload, uint16_t len)
+{
+    _send_buff[0] = WINDOW_SOF;
+    _send_buff[1] = type;
+    _send_buff[2] = seq;
+    _send_buff[3] = seq >> 8;
+    _send_buff[4] = len;
+    _send_buff[5] = len >> 8;
+    if (len)
+        memcpy(&_send_buff[WINDOW_HEAD_LEN], payload, len);
+
+    uint16_t crc16 = CRC::crc16_xmodem(&_send_buff[1], WINDOW_HEAD_LEN - 1 + len);
+    _send_buff[WINDOW_HEAD_LEN + len]     = crc16;
+    _send_buff[WINDOW_HEAD_LEN + len + 1] = crc16 >> 8;
+
+    emit send(&_send_buff[0], WINDOW_FIXED_LEN + len, (60 * 1000));
+}
+
+
+/**
+ * @brief 发送一个数据帧
+ * @param seq 数据帧的序号，从 0 开始
+ */
+void SlideWindow::sendData(uint32_t seq)
+{
+    sendFrame(WINDOW_TYPE_DATA, seq, (const uint8_t *)&_file_data.constData()[seq * WINDOW_DATA_MAX_LEN], WINDOW_DATA_MAX_LEN);
+}
+
+
+/**
+ * @brief 结束发送并通知结果
+ * @param err_code 发送文件的结果代码
+ */
+void SlideWindow::sendFinished(YMODEM_ERR err_code)
+{
+    sendStop();
+    emit resultCallback(err_code);
+}
+
+
+/**
+ * @brief 超时未收到数据的处理函数
+ */
+void SlideWindow::receiveDataTimeout()
+{
+    sendFinished(YMODEM_ERR_RECV_DATA_TIMEOUT);
+}
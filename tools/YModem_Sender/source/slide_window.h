@@ -0,0 +1,136 @@
+/**
+ * \file            slide_window.h
+ * \brief           YModem_Sender
+ */
+
+/*
+ * Copyright (c) 2026 mOTA contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of YModem_Sender.
+ *
+ * Version:         v1.0.0
+ */
+
+#ifndef SLIDE_WINDOW_H
+#define SLIDE_WINDOW_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QVector>
+#include "ymodem.h"
+
+/**
+ * 滑动窗口协议的发送器，帧结构与 bootloader 的 protocol_window.h 相同：
+ *    | SOF | type | seq (2) | len (2) | payload (len) | crc16 (2) |
+ * 与 YModem 类使用相同的信号，可直接替换。
+ */
+
+#define WINDOW_REPLY_MAX_TIME           3000        /* START 、 END 等待应答的超时时间，单位 ms */
+#define WINDOW_RTO_TIME                 1000        /* 数据帧没有任何应答时的重发超时，单位 ms */
+#define WINDOW_ERR_MAX_TIME             10
+
+#define WINDOW_SOF                      0xA5
+#define WINDOW_HEAD_LEN                 6
+#define WINDOW_FIXED_LEN                8
+#define WINDOW_DATA_MAX_LEN             1024
+#define WINDOW_INFO_LEN                 128
+#define WINDOW_MAX_FRAME_NUM            32
+#define WINDOW_RECV_MAX_LEN             4096
+
+/* 帧类型 */
+enum WINDOW_TYPE
+{
+    WINDOW_TYPE_START  = 0x01,
+    WINDOW_TYPE_DATA   = 0x02,
+    WINDOW_TYPE_END    = 0x03,
+    WINDOW_TYPE_ACK    = 0x06,
+    WINDOW_TYPE_NAK    = 0x15,
+    WINDOW_TYPE_ABORT  = 0x18,
+    WINDOW_TYPE_READY  = 0x81,
+    WINDOW_TYPE_FINISH = 0x83,
+};
+
+/* 用于程序记录的流程状态机 */
+enum WINDOW_SEND_STEP
+{
+    WINDOW_STEP_NONE,
+    WINDOW_STEP_WAIT_HANDSHAKE,         /* 等待从机的'C'或'G' */
+    WINDOW_STEP_WAIT_READY,             /* 发送 START 后等待 READY */
+    WINDOW_STEP_SEND_DATA,              /* 按窗口发送文件内容 */
+    WINDOW_STEP_WAIT_FINISH,            /* 发送 END 后等待 FINISH */
+};
+
+/* 类本体 */
+class SlideWindow : public QObject
+{
+    Q_OBJECT
+
+public:
+    SlideWindow();
+
+    YMODEM_ERR  sendFile    (QString file_path);
+    void        sendStop    ();
+
+signals:
+    /* 发送数据 */
+    void send(uint8_t *data, size_t size, uint16_t timeout);
+    /* 接收数据 */
+    size_t receive(uint8_t *data, size_t need_size, uint16_t timeout);
+    /* 发送文件进度的通知 */
+    void progressCallback(YMODEM_SEND_STAGE stage, uint8_t progress);
+    /* 发送文件完成的通知 */
+    void resultCallback(YMODEM_ERR err_code);
+
+private:
+    QByteArray              _file_data;
+    char                    _file_size_str[WINDOW_INFO_LEN];
+    char                    _file_name[WINDOW_INFO_LEN];
+    uint8_t                 _send_buff[WINDOW_FIXED_LEN + WINDOW_DATA_MAX_LEN];
+    uint8_t                 _recv_buff[WINDOW_RECV_MAX_LEN];
+    QByteArray              _recv_stream;                   /* 未解析的应答数据 */
+
+    WINDOW_SEND_STEP        _send_step = WINDOW_STEP_NONE;
+    uint32_t                _total;                         /* 数据帧总数 */
+    uint32_t                _base;                          /* 最早未确认的帧 */
+    uint32_t                _next;                          /* 下一个新发送的帧 */
+    uint32_t                _window;                        /* 实际的窗口大小 */
+    QVector<bool>           _acked;                         /* 各数据帧是否已确认 */
+    uint8_t                 _err_count;
+
+    QTimer                  _send_timer;
+    QTimer                  _recv_timer;
+    QElapsedTimer           _reply_timer;                   /* 距最近一次应答的时间 */
+
+    void sendFileHandler();
+    void replyProcess(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len);
+    bool parseReply(uint8_t *type, uint16_t *seq, uint8_t *payload, uint16_t *len);
+    void sendFileInfo();
+    void sendFrame(WINDOW_TYPE type, uint16_t seq, const uint8_t *payload = nullptr, uint16_t len = 0);
+    void sendData(uint32_t seq);
+    void sendFinished(YMODEM_ERR err_code);
+    void receiveDataTimeout();
+};
+
+#endif // SLIDE_WINDOW_H
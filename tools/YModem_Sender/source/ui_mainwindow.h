@@ -12,6 +12,7 @@
 #include <QtCore/QVariant>
 #include <QtGui/QIcon>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QCheckBox>
 #include <QtWidgets/QComboBox>
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QGroupBox>
@@ -57,6 +58,8 @@ public:
     QGridLayout *gridLayout_4;
     QProgressBar *progressBar;
     QSpacerItem *horizontalSpacer_3;
+    QCheckBox *cbWindow;
+    QCheckBox *cbBaud;
     QPushButton *pbSendFiles;
     QMenuBar *menubar;
     QStatusBar *statusbar;
@@ -193,10 +196,20 @@ public:
 
         gridLayout_4->addItem(horizontalSpacer_3, 0, 1, 1, 1);
 
+        cbWindow = new QCheckBox(groupBox_3);
+        cbWindow->setObjectName(QString::fromUtf8("cbWindow"));
+
+        gridLayout_4->addWidget(cbWindow, 0, 2, 1, 1);
+
+        cbBaud = new QCheckBox(groupBox_3);
+        cbBaud->setObjectName(QString::fromUtf8("cbBaud"));
+
+        gridLayout_4->addWidget(cbBaud, 0, 3, 1, 1);
+
         pbSendFiles = new QPushButton(groupBox_3);
         pbSendFiles->setObjectName(QString::fromUtf8("pbSendFiles"));
 
-        gridLayout_4->addWidget(pbSendFiles, 0, 2, 1, 1);
+        gridLayout_4->addWidget(pbSendFiles, 0, 4, 1, 1);
 
 
         gridLayout_7->addLayout(gridLayout_4, 0, 0, 1, 1);
@@ -234,6 +247,8 @@ public:
         pbOpenFiles->setText(QCoreApplication::translate("MainWindow", "\351\200\211\346\213\251\346\226\207\344\273\266", nullptr));
         labFileSize->setText(QCoreApplication::translate("MainWindow", "xxx.xx kB", nullptr));
         groupBox_3->setTitle(QCoreApplication::translate("MainWindow", "3. \345\217\221\351\200\201\346\226\207\344\273\266", nullptr));
+        cbWindow->setText(QCoreApplication::translate("MainWindow", "\346\273\221\345\212\250\347\252\227\345\217\243", nullptr));
+        cbBaud->setText(QCoreApplication::translate("MainWindow", "\345\215\217\345\225\206\346\263\242\347\211\271\347\216\207", nullptr));
         pbSendFiles->setText(QCoreApplication::translate("MainWindow", "\345\274\200\345\247\213\345\217\221\351\200\201", nullptr));
     } // retranslateUi
 
@@ -29,7 +29,7 @@
  * This file is part of YModem_Sender.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.3.0
  */
 
 #include "ymodem.h"
@@ -76,16 +76,12 @@ YMODEM_ERR YModem::sendFile(QString file_path)
         return YMODEM_ERR_OPEN_FILE_ERR;
 
     /* 暂存文件源数据 */
+    /* 最后一个包需补齐，按 STX 包还是扩展数据包补齐要等从机握手后才能确定，因此按较大的扩展数据包预留 */
     QDataStream file_stream(&file);
-    int add_byte_num = 0;
+    int add_byte_num = YMODEM_EXT_DATA_MAX_LEN;
     int size = file.size();
     if (size % YMODEM_STX_DATA_MAX_LEN)
-    {
-        add_byte_num = YMODEM_STX_DATA_MAX_LEN - (size % YMODEM_STX_DATA_MAX_LEN);
-        size += add_byte_num;
-        qDebug()<<"add byte num: "<<add_byte_num;
-        qDebug()<<"need send size: "<<size;
-    }
+        size += YMODEM_STX_DATA_MAX_LEN - (size % YMODEM_STX_DATA_MAX_LEN);
 
     /* 将文件读入数组 */
     _file_raw_data = new char[file.size() + add_byte_num];
@@ -97,9 +93,8 @@ YMODEM_ERR YModem::sendFile(QString file_path)
         return YMODEM_ERR_READ_FILE_ERR;
     }
 
-    /* 最后一个未足YMODEM_STX_DATA_MAX_LEN的包的数据全部填充为0x1A */
-    if (add_byte_num)
-        memset((uint8_t *)&_file_raw_data[file.size()], YMODEM_FILL_BYTE, add_byte_num);
+    /* 最后一个未足一包的数据全部填充为0x1A */
+    memset((uint8_t *)&_file_raw_data[file.size()], YMODEM_FILL_BYTE, add_byte_num);
 
     /* 暂存文件名和文件大小 */
     memset(_file_size_str, 0, sizeof(_file_size_str));
@@ -112,11 +107,13 @@ YMODEM_ERR YModem::sendFile(QString file_path)
     qDebug()<<"file size: "<<_file_size_str<<" ("<<len<<")";
 
     memset(_file_name, 0, sizeof(_file_name));
-    strncpy(_file_name, file_info.fileName().toLatin1(), YMODEM_FILE_NAME_MAX_LEN - len - 1);
+    /* 文件大小之后还需附加扩展数据包和断点续传的请求 */
+    strncpy(_file_name, file_info.fileName().toLatin1(), YMODEM_FILE_NAME_MAX_LEN - len - 1 - 24);
     qDebug()<<"file name: "<<_file_name;
 
     /* 开始发送文件 */
     _send_step = YMODEM_STEP_SEND_FILE_INFO;
+    _file_size = file.size();
     _need_send_size = size;
     _send_timer.start(1);
     _recv_timer.start(YMODEM_RECV_DATA_MAX_TIME);
@@ -140,6 +137,18 @@ void YModem::sendStop()
     _sended_size    = 0;
     _need_send_size = 0;
     _send_step      = YMODEM_STEP_NONE;
+    _is_g_mode      = false;
+    _is_ext_mode    = false;
+    _resume_len     = 0;
+    _baud_request   = 0;
+    _baud_start     = 0;
+    _baud_len       = 0;
+    /* 协商过波特率，恢复串口原来的波特率 */
+    if (_baud_current)
+    {
+        _baud_current = 0;
+        emit setBaudRate(_baud_origin);
+    }
     if (_file_raw_data)
     {
         delete []_file_raw_data;
@@ -148,6 +157,19 @@ void YModem::sendStop()
 }
 
 
+/**
+ * @brief 设置是否协商波特率
+ * @note 在 sendFile 之前调用
+ * @param enable 是否在第一个包之前请求更高的波特率
+ * @param baud_rate 串口当前的波特率，只请求高于该值的波特率
+ */
+void YModem::setBaudNegotiation(bool enable, qint32 baud_rate)
+{
+    _is_baud_enable = enable;
+    _baud_origin    = baud_rate;
+}
+
+
 /*********************************** private function ***********************************/
 /**
  * @brief 发送文件的循环处理函数
@@ -156,7 +178,38 @@ void YModem::sendFileHandler()
 {
     static uint8_t err_count;
 
-    if (emit receive(&_recv_buff[0], 0, (60 * 1000)) != 0)
+    /* YModem-G 连续发送期间不等待从机应答 */
+    if (_send_step == YMODEM_STEP_STREAM_FILE)
+    {
+        streamFileHandler();
+        return;
+    }
+
+    /* 从机不支持波特率协商时没有应答，以原波特率发送文件信息 */
+    if (_send_step == YMODEM_STEP_WAIT_BAUD && _baud_wait.elapsed() >= YMODEM_BAUD_WAIT_TIME)
+    {
+        _is_baud_enable = false;
+        sendFileInfo();
+        _send_step = YMODEM_STEP_WAIT_FIRST_PKG_ACK;
+        return;
+    }
+
+    /* 没有收到探测帧的回送，恢复原波特率 */
+    if (_send_step == YMODEM_STEP_WAIT_PROBE && _baud_wait.elapsed() >= YMODEM_PROBE_WAIT_TIME)
+    {
+        baudFallback();
+        return;
+    }
+
+    /* 从机不支持断点续传时没有续传位置的应答，从头发送 */
+    if (_send_step == YMODEM_STEP_WAIT_RESUME && _resume_wait.elapsed() >= YMODEM_RESUME_WAIT_TIME)
+    {
+        resumeFileData(0);
+        return;
+    }
+
+    size_t recv_len = emit receive(&_recv_buff[0], 0, (60 * 1000));
+    if (recv_len != 0)
     {
         _recv_timer.start(YMODEM_RECV_DATA_MAX_TIME);
 
@@ -165,19 +218,41 @@ void YModem::sendFileHandler()
             /* 发送文件信息 */
             case YMODEM_STEP_SEND_FILE_INFO:
             {
-                if (_recv_buff[0] == YMODEM_C)
+                if (_recv_buff[0] == YMODEM_C || _recv_buff[0] == YMODEM_G)
                 {
-                    err_count = 0;
+                    err_count  = 0;
+                    _is_g_mode = (_recv_buff[0] == YMODEM_G);
+                    emit progressCallback(YMODEM_STAGE_WAIT_C, 0);
+
+                    /* 第一个包之前先协商波特率 */
+                    if (sendBaudRequest())
+                    {
+                        _send_step = YMODEM_STEP_WAIT_BAUD;
+                        break;
+                    }
                     sendFileInfo();
                     _send_step = YMODEM_STEP_WAIT_FIRST_PKG_ACK;
-                    emit progressCallback(YMODEM_STAGE_WAIT_C, 0);
                 }
                 break;
             }
+            /* 发送波特率请求后等待应答 */
+            case YMODEM_STEP_WAIT_BAUD:
+            {
+                baudProcess(&_recv_buff[0], recv_len);
+                break;
+            }
+            /* 切换波特率并发送探测帧后等待回送 */
+            case YMODEM_STEP_WAIT_PROBE:
+            {
+                probeProcess(&_recv_buff[0], recv_len);
+                break;
+            }
             /* 发送完第一个SOH包后等待ACK */
             case YMODEM_STEP_WAIT_FIRST_PKG_ACK:
             {
-                if (_recv_buff[0] == YMODEM_ACK)
+                /* YModem-G 的第一个包只回复'G'，从机接受扩展数据包时为'E' */
+                if (_recv_buff[0] == YMODEM_ACK
+                ||  (_is_g_mode && (_recv_buff[0] == YMODEM_G || _recv_buff[0] == YMODEM_E)))
                 {
                     err_count  = 0;
                     _send_step = YMODEM_STEP_SEND_FILE_FIRST;
@@ -200,16 +275,25 @@ void YModem::sendFileHandler()
             case YMODEM_STEP_SEND_FILE_FIRST:
                  _YMODEM_STEP_SEND_FILE_FIRST:
             {
-                if (_recv_buff[0] == YMODEM_C ||
-                    (_recv_buff[0] == YMODEM_ACK && _recv_buff[1] == YMODEM_C))
+                /* 从机接受扩展数据包时以'E'代替'C'或'G' */
+                if (_recv_buff[0] == YMODEM_C || _recv_buff[0] == YMODEM_E ||
+                    (_recv_buff[0] == YMODEM_ACK && (_recv_buff[1] == YMODEM_C || _recv_buff[1] == YMODEM_E)) ||
+                    (_is_g_mode && _recv_buff[0] == YMODEM_G))
                 {
                     err_count = 0;
+                    startFileData((_recv_buff[0] == YMODEM_ACK) ? _recv_buff[1] : _recv_buff[0]);
                     ++_pkt_num;
-                    sendFileData((uint8_t *)&_file_raw_data[_sended_size], YMODEM_STX_SIZE);
+                    sendFileData((uint8_t *)&_file_raw_data[_sended_size], fileDataType());
                     _send_step = YMODEM_STEP_SEND_FILE;
                 }
                 break;
             }
+            /* 第一个数据包的ACK之后等待续传位置 */
+            case YMODEM_STEP_WAIT_RESUME:
+            {
+                resumeProcess(&_recv_buff[0], recv_len);
+                break;
+            }
             /* 发送文件内容 */
             case YMODEM_STEP_SEND_FILE:
             {
@@ -217,8 +301,32 @@ void YModem::sendFileHandler()
                 {
                     err_count = 0;
                     ++_pkt_num;
-                    _sended_size += YMODEM_STX_DATA_MAX_LEN;
+
+                    /* 第一个数据包（固件包头）的ACK之后是续传位置，可能与ACK一起收到 */
+                    if (_sended_size == 0)
+                    {
+                        _resume_len = 0;
+                        _resume_wait.start();
+                        _send_step  = YMODEM_STEP_WAIT_RESUME;
+                        resumeProcess(&_recv_buff[1], recv_len - 1);
+                        break;
+                    }
+
+                    _sended_size += (fileDataType() == YMODEM_EXT_SIZE) ? YMODEM_EXT_DATA_MAX_LEN : YMODEM_STX_DATA_MAX_LEN;
                     emit progressCallback(YMODEM_STAGE_SEND_FILE, 100 * _sended_size / _need_send_size);
+
+                    /* YModem-G 的从机只应答第一个数据包（固件包头，会擦除分区），其余数据包连续发送 */
+                    if (_is_g_mode && _sended_size < _need_send_size)
+                    {
+                        _send_step = YMODEM_STEP_STREAM_FILE;
+                        break;
+                    }
+                }
+                else if (_recv_buff[0] == YMODEM_CAN)
+                {
+                    sendStop();
+                    emit resultCallback(YMODEM_ERR_SLAVER_REPLY_ERR);
+                    break;
                 }
                 else
                 {
@@ -232,7 +340,7 @@ void YModem::sendFileHandler()
 
                 /* 分包发送文件 */
                 if (_sended_size < _need_send_size)
-                    sendFileData((uint8_t *)&_file_raw_data[_sended_size], YMODEM_STX_SIZE);
+                    sendFileData((uint8_t *)&_file_raw_data[_sended_size], fileDataType());
                 else
                 {
                     sendPackage(YMODEM_EOT);
@@ -292,7 +400,9 @@ void YModem::sendFileHandler()
                  _YMODEM_STEP_SEND_NULL_PKG:
             {
                 if (_recv_buff[0] == YMODEM_C ||
-                    (_recv_buff[0] == YMODEM_ACK && _recv_buff[1] == YMODEM_C))
+                    (_recv_buff[0] == YMODEM_ACK && _recv_buff[1] == YMODEM_C) ||
+                    (_is_g_mode && (_recv_buff[0] == YMODEM_G ||
+                                   (_recv_buff[0] == YMODEM_ACK && _recv_buff[1] == YMODEM_G))))
                 {
                     /* 发一个空的SOH包 */
                     err_count = 0;
@@ -332,16 +442,287 @@ void YModem::sendFileHandler()
 }
 
 
+/**
+ * @brief YModem-G 连续发送文件内容
+ * @note 每次定时器超时发送一个数据包，不等待从机应答，收到 CAN 即停止发送
+ */
+void YModem::streamFileHandler()
+{
+    uint8_t recv_buff[YMODEM_RECV_MAX_LEN];
+
+    /* YModem-G 没有重传机制，从机出错时会发送 CAN */
+    if (emit receive(&recv_buff[0], 0, 0) != 0 && recv_buff[0] == YMODEM_CAN)
+    {
+        sendStop();
+        emit resultCallback(YMODEM_ERR_SLAVER_REPLY_ERR);
+        return;
+    }
+    _recv_timer.start(YMODEM_RECV_DATA_MAX_TIME);
+
+    sendFileData((uint8_t *)&_file_raw_data[_sended_size], fileDataType());
+    ++_pkt_num;
+    _sended_size += (fileDataType() == YMODEM_EXT_SIZE) ? YMODEM_EXT_DATA_MAX_LEN : YMODEM_STX_DATA_MAX_LEN;
+    emit progressCallback(YMODEM_STAGE_SEND_FILE, 100 * _sended_size / _need_send_size);
+
+    /* 发送完毕，按 YModem 结束传输 */
+    if (_sended_size >= _need_send_size)
+    {
+        sendPackage(YMODEM_EOT);
+        _send_step = YMODEM_STEP_WAIT_EOT_NAK;
+    }
+}
+
+
+/**
+ * @brief 从机握手后开始发送文件内容
+ * @param handshake 从机在第一个包之后的握手字符，'E'表示接受扩展数据包
+ */
+void YModem::startFileData(uint8_t handshake)
+{
+    _is_ext_mode = (handshake == YMODEM_E);
+
+    /* 固件包头所在的第一个数据包固定为STX包，其余按扩展数据包补齐 */
+    if (_is_ext_mode && _file_size > YMODEM_STX_DATA_MAX_LEN)
+    {
+        size_t body_size = _file_size - YMODEM_STX_DATA_MAX_LEN;
+        _need_send_size = YMODEM_STX_DATA_MAX_LEN
+                        + (body_size + YMODEM_EXT_DATA_MAX_LEN - 1) / YMODEM_EXT_DATA_MAX_LEN * YMODEM_EXT_DATA_MAX_LEN;
+    }
+    qDebug()<<"ext mode: "<<_is_ext_mode<<", need send size: "<<_need_send_size;
+}
+
+
+/**
+ * @brief 处理从机应答的续传位置
+ * @param data 收到的数据
+ * @param len 收到的数据长度
+ */
+void YModem::resumeProcess(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len && _resume_len < YMODEM_RESUME_REPLY_LEN; i++)
+    {
+        /* 跳过续传应答之前的字符 */
+        if (_resume_len == 0 && data[i] != YMODEM_R)
+            continue;
+        _resume_buff[_resume_len++] = data[i];
+    }
+
+    if (_resume_len < YMODEM_RESUME_REPLY_LEN)
+        return;
+
+    uint16_t crc16  = CRC::crc16_xmodem(&_resume_buff[1], 4);
+    size_t   offset = ((uint32_t)_resume_buff[1] << 24) | ((uint32_t)_resume_buff[2] << 16)
+                    | ((uint32_t)_resume_buff[3] << 8)  |  (uint32_t)_resume_buff[4];
+
+    /* 从机已按续传位置准备接收，应答有误时不能从头发送 */
+    if (crc16 != (((uint16_t)_resume_buff[5] << 8) | _resume_buff[6])
+    ||  YMODEM_STX_DATA_MAX_LEN + offset > _file_size)
+    {
+        sendStop();
+        emit resultCallback(YMODEM_ERR_SLAVER_REPLY_ERR);
+        return;
+    }
+
+    qDebug()<<"resume offset: "<<offset;
+    resumeFileData(offset);
+}
+
+
+/**
+ * @brief 从续传位置继续发送文件内容
+ * @param offset 从机已写入的包体长度，跳过第一个数据包之后的这部分数据，0表示从头发送
+ */
+void YModem::resumeFileData(size_t offset)
+{
+    size_t pkg_size = _is_ext_mode ? YMODEM_EXT_DATA_MAX_LEN : YMODEM_STX_DATA_MAX_LEN;
+
+    /* 余下的数据按数据包补齐 */
+    _sended_size    = YMODEM_STX_DATA_MAX_LEN + offset;
+    _need_send_size = _sended_size;
+    if (_file_size > _sended_size)
+        _need_send_size += (_file_size - _sended_size + pkg_size - 1) / pkg_size * pkg_size;
+    emit progressCallback(YMODEM_STAGE_SEND_FILE, 100 * _sended_size / _need_send_size);
+
+    if (_sended_size >= _need_send_size)
+    {
+        sendPackage(YMODEM_EOT);
+        _send_step = YMODEM_STEP_WAIT_EOT_NAK;
+    }
+    /* YModem-G 的从机只应答第一个数据包，其余数据包连续发送 */
+    else if (_is_g_mode)
+        _send_step = YMODEM_STEP_STREAM_FILE;
+    else
+    {
+        sendFileData((uint8_t *)&_file_raw_data[_sended_size], fileDataType());
+        _send_step = YMODEM_STEP_SEND_FILE;
+    }
+}
+
+
+/**
+ * @brief 发送波特率请求
+ * @note 按优先顺序列出 YMODEM_BAUD_LIST 中剩余的、高于原波特率的波特率
+ * @return true：已发送。false：不协商或没有可请求的波特率
+ */
+bool YModem::sendBaudRequest()
+{
+    const qint32 baud_list[] = YMODEM_BAUD_LIST;
+    uint8_t num = 0;
+
+    if (_is_baud_enable == false)
+        return false;
+
+    for (int i = _baud_start; i < (int)(sizeof(baud_list) / sizeof(baud_list[0])) && num < YMODEM_BAUD_MAX_NUM; i++)
+    {
+        if (baud_list[i] <= _baud_origin)
+            continue;
+        _send_buff[2 + 4 * num]     = baud_list[i] >> 24;
+        _send_buff[2 + 4 * num + 1] = baud_list[i] >> 16;
+        _send_buff[2 + 4 * num + 2] = baud_list[i] >> 8;
+        _send_buff[2 + 4 * num + 3] = baud_list[i];
+        num++;
+    }
+    if (num == 0)
+        return false;
+
+    _send_buff[0] = YMODEM_B;
+    _send_buff[1] = num;
+    uint16_t crc16 = CRC::crc16_xmodem(&_send_buff[1], 1 + 4 * num);
+    _send_buff[2 + 4 * num] = crc16 >> 8;
+    _send_buff[3 + 4 * num] = crc16;
+
+    _baud_len = 0;
+    _baud_wait.start();
+    emit send(&_send_buff[0], 4 + 4 * num, (60 * 1000));
+
+    return true;
+}
+
+
+/**
+ * @brief 处理从机的波特率应答
+ * @note 应答有误、为0或与原波特率相同时以原波特率发送文件信息，否则切换波特率并发送探测帧
+ * @param data 收到的数据
+ * @param len 收到的数据长度
+ */
+void YModem::baudProcess(const uint8_t *data, size_t len)
+{
+    const uint8_t probe[YMODEM_PROBE_LEN] = YMODEM_PROBE_FRAME;
+
+    for (size_t i = 0; i < len && _baud_len < YMODEM_BAUD_REPLY_LEN; i++)
+    {
+        /* 跳过应答之前的握手字符 */
+        if (_baud_len == 0 && data[i] != YMODEM_B)
+            continue;
+        _baud_buff[_baud_len++] = data[i];
+    }
+
+    if (_baud_len < YMODEM_BAUD_REPLY_LEN)
+        return;
+
+    uint16_t crc16 = CRC::crc16_xmodem(&_baud_buff[1], 4);
+    qint32   baud  = ((uint32_t)_baud_buff[1] << 24) | ((uint32_t)_baud_buff[2] << 16)
+                   | ((uint32_t)_baud_buff[3] << 8)  |  (uint32_t)_baud_buff[4];
+    qDebug()<<"baud rate reply: "<<baud;
+
+    if (crc16 != (((uint16_t)_baud_buff[5] << 8) | _baud_buff[6])
+    ||  baud == 0 || baud == _baud_origin)
+    {
+        _is_baud_enable = false;
+        sendFileInfo();
+        _send_step = YMODEM_STEP_WAIT_FIRST_PKG_ACK;
+        return;
+    }
+
+    /* 从机应答后即切换，双方切换后发送探测帧 */
+    _baud_request = baud;
+    emit setBaudRate(baud);
+
+    memcpy(&_send_buff[0], probe, YMODEM_PROBE_LEN);
+    _baud_len = 0;
+    _baud_wait.start();
+    _send_step = YMODEM_STEP_WAIT_PROBE;
+    emit send(&_send_buff[0], YMODEM_PROBE_LEN, (60 * 1000));
+}
+
+
+/**
+ * @brief 处理从机回送的探测帧
+ * @note 切换过程中可能收到乱码，滑动比较最近收到的数据，收到原样的回送后以新波特率发送文件信息
+ * @param data 收到的数据
+ * @param len 收到的数据长度
+ */
+void YModem::probeProcess(const uint8_t *data, size_t len)
+{
+    const uint8_t probe[YMODEM_PROBE_LEN] = YMODEM_PROBE_FRAME;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (_baud_len == YMODEM_PROBE_LEN)
+        {
+            memmove(&_baud_buff[0], &_baud_buff[1], YMODEM_PROBE_LEN - 1);
+            _baud_len--;
+        }
+        _baud_buff[_baud_len++] = data[i];
+
+        if (_baud_len == YMODEM_PROBE_LEN && memcmp(_baud_buff, probe, YMODEM_PROBE_LEN) == 0)
+        {
+            qDebug()<<"baud rate switched: "<<_baud_request;
+            _baud_current = _baud_request;
+            sendFileInfo();
+            _send_step = YMODEM_STEP_WAIT_FIRST_PKG_ACK;
+            return;
+        }
+    }
+}
+
+
+/**
+ * @brief 探测失败，恢复原波特率
+ * @note 从机超时后同样恢复并重新发送握手字符，届时再请求优先级更低的波特率
+ */
+void YModem::baudFallback()
+{
+    const qint32 baud_list[] = YMODEM_BAUD_LIST;
+
+    qDebug()<<"baud rate probe failed: "<<_baud_request;
+    emit setBaudRate(_baud_origin);
+
+    for (int i = 0; i < (int)(sizeof(baud_list) / sizeof(baud_list[0])); i++)
+    {
+        if (baud_list[i] == _baud_request)
+            _baud_start = i + 1;
+    }
+    _baud_request = 0;
+    _send_step    = YMODEM_STEP_SEND_FILE_INFO;
+}
+
+
+/**
+ * @brief 获取下一个要发送的文件数据包的类型
+ * @return 扩展数据包或STX包
+ */
+YMODEM_SIZE_TYPE YModem::fileDataType()
+{
+    if (_is_ext_mode && _sended_size)
+        return YMODEM_EXT_SIZE;
+    return YMODEM_STX_SIZE;
+}
+
+
 /**
  * @brief 发送文件信息
+ * @note 文件大小之后附加扩展数据包和断点续传的请求，以空格分隔，从机不支持时会忽略
  */
 void YModem::sendFileInfo()
 {
     uint8_t *buff = new uint8_t[YMODEM_STX_DATA_MAX_LEN];
+    int posit = strlen(_file_name) + 1 + strlen(_file_size_str) + 1;
 
     memset(buff, 0, YMODEM_STX_DATA_MAX_LEN);
     memcpy(&buff[0], _file_name, strlen(_file_name));
     memcpy(&buff[strlen(_file_name) + 1], _file_size_str, strlen(_file_size_str));
+    snprintf((char *)&buff[posit], YMODEM_SOH_DATA_MAX_LEN - posit, YMODEM_EXT_TAG "%d " YMODEM_RESUME_TAG, YMODEM_EXT_DATA_MAX_LEN);
     sendPackage(YMODEM_SOH, buff);
 
     delete[] buff;
@@ -360,6 +741,9 @@ void YModem::sendFileData(uint8_t *data, YMODEM_SIZE_TYPE size_type)
 
     else if (size_type == YMODEM_STX_SIZE)
         sendPackage(YMODEM_STX, data);
+
+    else if (size_type == YMODEM_EXT_SIZE)
+        sendPackage(YMODEM_STX_EXT, data);
 }
 
 
@@ -399,6 +783,21 @@ void YModem::sendPackage(YMODEM_HEADER header, uint8_t *data)
         _send_buff[pkg_len - 2] = crc16 >> 8;
         _send_buff[pkg_len - 1] = crc16;
     }
+    /* 扩展数据包以CRC32校验，高字节在前 */
+    else if (header == YMODEM_STX_EXT)
+    {
+        pkg_len = YMODEM_EXT_MAX_LEN;
+        _send_buff[0] = header;
+        _send_buff[1] = _pkt_num;
+        _send_buff[2] = ~_pkt_num;
+        memcpy(&_send_buff[3], data, YMODEM_EXT_DATA_MAX_LEN);
+        uint32_t crc32 = CRC::crc32(&_send_buff[3], YMODEM_EXT_DATA_MAX_LEN);
+        qDebug() << "CRC32: " << QString::asprintf("%.8X", crc32);
+        _send_buff[pkg_len - 4] = crc32 >> 24;
+        _send_buff[pkg_len - 3] = crc32 >> 16;
+        _send_buff[pkg_len - 2] = crc32 >> 8;
+        _send_buff[pkg_len - 1] = crc32;
+    }
     else
     {
         _send_buff[0] = header;
@@ -29,7 +29,7 @@
  * This file is part of YModem_Sender.
  *
  * Author:          Dino Haw <347341799@qq.com>
- * Version:         v1.0.0
+ * Version:         v1.3.0
  */
 
 #ifndef YMODEM_H
@@ -37,12 +37,13 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
 
 #define YMODEM_RECV_DATA_MAX_TIME       (15 * 1000)
 #define YMODEM_ERR_MAX_TIME             5
 
 /* 宏定义 */
-#define YMODEM_RECV_MAX_LEN             8
+#define YMODEM_RECV_MAX_LEN             16
 #define YMODEM_FIXED_LEN                5
 #define YMODEM_SOH_DATA_MAX_LEN         128
 #define YMODEM_STX_DATA_MAX_LEN         1024
@@ -50,6 +51,20 @@
 #define YMODEM_FILE_NAME_MAX_LEN        YMODEM_SOH_DATA_MAX_LEN
 #define YMODEM_SOH_MAX_LEN              (YMODEM_FIXED_LEN + YMODEM_SOH_DATA_MAX_LEN)
 #define YMODEM_STX_MAX_LEN              (YMODEM_FIXED_LEN + YMODEM_STX_DATA_MAX_LEN)
+#define YMODEM_EXT_FIXED_LEN            7
+#define YMODEM_EXT_DATA_MAX_LEN         4096        /* 扩展数据帧的数据长度，需与 bootloader 的 YMODEM_EXT_DATA_LEN 一致 */
+#define YMODEM_EXT_MAX_LEN              (YMODEM_EXT_FIXED_LEN + YMODEM_EXT_DATA_MAX_LEN)
+#define YMODEM_EXT_TAG                  "EXT="
+#define YMODEM_RESUME_TAG               "RESUME"
+#define YMODEM_RESUME_REPLY_LEN         7           /* 'R' 、续传位置 (4) 、 CRC16 (2) ，均为高字节在前 */
+#define YMODEM_RESUME_WAIT_TIME         1000        /* 等待续传位置的时间，超时视为从机不支持断点续传，单位 ms */
+#define YMODEM_BAUD_LIST                {2000000, 1500000, 921600, 460800, 230400}  /* 按优先顺序请求的波特率 */
+#define YMODEM_BAUD_MAX_NUM             8           /* 一次请求的最大波特率数量，与 bootloader 的 YMODEM_BAUD_MAX_NUM 一致 */
+#define YMODEM_BAUD_REPLY_LEN           7           /* 'B' 、波特率 (4) 、 CRC16 (2) ，均为高字节在前 */
+#define YMODEM_BAUD_WAIT_TIME           1000        /* 等待波特率应答的时间，超时视为从机不支持，单位 ms */
+#define YMODEM_PROBE_LEN                9
+#define YMODEM_PROBE_FRAME              {'P', 0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC}
+#define YMODEM_PROBE_WAIT_TIME          500         /* 等待探测帧回送的时间，从机按断帧间隔取出探测帧，单位 ms */
 #define YMODEM_FILL_BYTE                0x1A
 
 /* 提供给用户的YModem发送文件的阶段 */
@@ -66,6 +81,7 @@ enum YMODEM_SIZE_TYPE
 {
     YMODEM_SOH_SIZE = 0x01,             /* SOH包 */
     YMODEM_STX_SIZE = 0x02,             /* STX包 */
+    YMODEM_EXT_SIZE = 0x03,             /* 扩展数据包 */
 };
 
 /* 错误代码 */
@@ -86,9 +102,13 @@ enum YMOEDM_SEND_STEP
 {
     YMODEM_STEP_NONE,
     YMODEM_STEP_SEND_FILE_INFO,         /* 发送文件信息 */
+    YMODEM_STEP_WAIT_BAUD,              /* 发送波特率请求后等待应答 */
+    YMODEM_STEP_WAIT_PROBE,             /* 切换波特率并发送探测帧后等待回送 */
     YMODEM_STEP_WAIT_FIRST_PKG_ACK,     /* 发送完第一个SOH包后等待ACK */
     YMODEM_STEP_SEND_FILE_FIRST,        /* 首次发送文件内容 */
+    YMODEM_STEP_WAIT_RESUME,            /* 第一个数据包的ACK之后等待续传位置 */
     YMODEM_STEP_SEND_FILE,              /* 发送文件内容 */
+    YMODEM_STEP_STREAM_FILE,            /* YModem-G 连续发送文件内容 */
     YMODEM_STEP_WAIT_EOT_NAK,           /* 等待第一个EOT的NAK回复 */
     YMODEM_STEP_WAIT_EOT_ACK,           /* 等待第二个EOT的ACK回复 */
     YMODEM_STEP_SEND_NULL_PKG,          /* 发送一个空包 */
@@ -100,11 +120,17 @@ enum YMODEM_HEADER
 {
     YMODEM_SOH = 0x01,
     YMODEM_STX = 0x02,
+    YMODEM_STX_EXT = 0x03,
     YMODEM_EOT = 0x04,
     YMODEM_ACK = 0x06,
     YMODEM_NAK = 0x15,
     YMODEM_CAN = 0x18,
     YMODEM_C   = 'C',
+    YMODEM_G   = 'G',
+    YMODEM_E   = 'E',
+    YMODEM_R   = 'R',
+    YMODEM_B   = 'B',
+    YMODEM_P   = 'P',
 };
 
 /* 类本体 */
@@ -117,6 +143,7 @@ public:
 
     YMODEM_ERR  sendFile    (QString file_path);
     void        sendStop    ();
+    void        setBaudNegotiation(bool enable, qint32 baud_rate);
 
 signals:
     /* 发送数据 */
@@ -127,18 +154,34 @@ signals:
     void progressCallback(YMODEM_SEND_STAGE stage, uint8_t progress);
     /* 发送文件完成的通知 */
     void resultCallback(YMODEM_ERR err_code);
+    /* 切换串口的波特率 */
+    void setBaudRate(qint32 baud_rate);
 
 private:
     char                   *_file_raw_data = nullptr;
     uint8_t                 _pkt_num;
     size_t                  _sended_size;
     size_t                  _need_send_size;
+    size_t                  _file_size;
     char                    _file_size_str[YMODEM_FILE_SIZE_MAX_LEN];
     char                    _file_name[YMODEM_FILE_NAME_MAX_LEN];
-    uint8_t                 _send_buff[YMODEM_STX_MAX_LEN];
+    uint8_t                 _send_buff[YMODEM_EXT_MAX_LEN];
     uint8_t                 _recv_buff[YMODEM_RECV_MAX_LEN];
 
     YMOEDM_SEND_STEP        _send_step = YMODEM_STEP_NONE;
+    bool                    _is_g_mode = false;     /* 从机以'G'握手，按YModem-G发送 */
+    bool                    _is_ext_mode = false;   /* 从机在第一个包后以'E'握手，按扩展数据包发送文件内容 */
+    uint8_t                 _resume_buff[YMODEM_RESUME_REPLY_LEN];
+    uint8_t                 _resume_len = 0;        /* 已收到的续传应答长度 */
+    QElapsedTimer           _resume_wait;           /* 开始等待续传位置的时刻 */
+    bool                    _is_baud_enable = false;    /* 第一个包之前协商波特率 */
+    qint32                  _baud_origin = 0;       /* 串口原来的波特率 */
+    qint32                  _baud_request = 0;      /* 从机应答的波特率，正在探测 */
+    qint32                  _baud_current = 0;      /* 协商后的波特率，0表示未切换 */
+    int                     _baud_start = 0;        /* 下次请求从 YMODEM_BAUD_LIST 的该位置开始 */
+    uint8_t                 _baud_buff[YMODEM_PROBE_LEN];
+    uint8_t                 _baud_len = 0;          /* 已收到的应答或回送长度 */
+    QElapsedTimer           _baud_wait;             /* 开始等待应答或回送的时刻 */
 
     QTimer                  _send_timer;
     QTimer                  _recv_timer;
@@ -147,6 +190,15 @@ private:
     void sendFileData(uint8_t *data, YMODEM_SIZE_TYPE size_type = YMODEM_STX_SIZE);
     void sendFileInfo();
     void sendFileHandler();
+    void startFileData(uint8_t handshake);
+    void resumeProcess(const uint8_t *data, size_t len);
+    void resumeFileData(size_t offset);
+    bool sendBaudRequest();
+    void baudProcess(const uint8_t *data, size_t len);
+    void probeProcess(const uint8_t *data, size_t len);
+    void baudFallback();
+    YMODEM_SIZE_TYPE fileDataType();
+    void streamFileHandler();
     void receiveDataTimeout();
 };
 